@@ -0,0 +1,1363 @@
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include <thread>
+#include <stdexcept>
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <Utils/File/FileUtils.hpp>
+#include <Utils/File/Logfile.hpp>
+
+#include "Utils/TrajectoryFile.hpp"
+#include "Utils/TrajectoryLoader.hpp"
+#include "Utils/BinLinesFile.hpp"
+#include "Utils/NetCDFConverter.hpp"
+#include "Utils/MappedFile.hpp"
+#include "Utils/HairLoader.hpp"
+#include "Utils/BinaryObjLoader.hpp"
+#include "Utils/PointRendering/PointFileLoader.hpp"
+#include "Utils/SyntheticDatasets.hpp"
+#include "Utils/MeshSerializer.hpp"
+#include "Utils/MeshPreprocessing.hpp"
+#include "Utils/SpatialReordering.hpp"
+#include "Utils/Meshlets.hpp"
+#include "Utils/CameraPath.hpp"
+#include "Utils/ConversionCache.hpp"
+#include "Utils/KDTree.hpp"
+#include "Utils/ComputeNormals.hpp"
+#include "Utils/Unorm16.hpp"
+#include "VoxelRaytracing/VoxelCurveDiscretizer.hpp"
+#include "Performance/ImageMetrics.hpp"
+#include "BenchmarkSuite.hpp"
+#include "BenchmarkReferences.hpp"
+#include "BenchmarkValidation.hpp"
+
+/*
+ * PixelSyncOITBenchmark: Headless benchmark of the CPU data pipeline (loading, conversion, serialization, spatial
+ * data structures, voxelization and image metrics). It neither opens a window nor creates an OpenGL context.
+ * Every stage is repeated --repetitions times for every thread count of --threads.
+ * Synthetic datasets of a given size can be generated with --generate for measuring the throughput of the stages
+ * against the input size without access to the original datasets.
+ */
+
+struct BenchmarkDataset
+{
+    std::string filename;
+    std::string name;
+    TrajectoryType trajectoryType;
+};
+
+/// A synthetic dataset to generate before running the benchmark (see generateSyntheticDataset).
+struct BenchmarkSyntheticDataset
+{
+    SyntheticDatasetType type;
+    uint64_t size;
+    std::string fileEnding;
+};
+
+struct BenchmarkOptions
+{
+    std::vector<BenchmarkDataset> datasets;
+    std::vector<BenchmarkSyntheticDataset> syntheticDatasets;
+    uint64_t seed = 0;
+    uint32_t numPointsPerLine = 128;
+    uint32_t numLineAttributes = 1;
+    bool generateOnly = false;
+    std::vector<int> threadCounts;
+    int numRepetitions = 5;
+    std::string outputDirectory = "BenchmarkResults/";
+    std::string jsonFilename = "benchmark.json";
+    std::string csvFilename = "benchmark.csv";
+    /// Names of the stages to run (all if empty).
+    std::vector<std::string> stages;
+    bool validate = false;
+
+    float lineRadius = 0.001f;
+    int voxelGridResolution = 128;
+    int voxelQuantizationResolution = 8;
+    unsigned int maxNumLinesPerVoxel = 32;
+    int numNearestNeighbors = 8;
+    size_t maxNumKDTreeQueries = 100000;
+    int imageWidth = 1920, imageHeight = 1080;
+    size_t unorm16ArraySize = size_t(1) << 24;
+    SpaceFillingCurve reorderCurve = SPACE_FILLING_CURVE_HILBERT;
+    std::string cameraPathDirectory = "Data/CameraPaths/";
+    int numCullingFrames = 256;
+    float cullingAttributeRangeMin = 0.1f, cullingAttributeRangeMax = 1.0f;
+};
+
+/// Same mapping from the dataset directory to the trajectory type as in PixelSyncApp::loadModel.
+static TrajectoryType getTrajectoryTypeFromFilename(const std::string &filename)
+{
+    if (boost::starts_with(filename, "Data/Trajectories")) {
+        return TRAJECTORY_TYPE_ANEURYSM;
+    } else if (boost::starts_with(filename, "Data/WCB")) {
+        return TRAJECTORY_TYPE_WCB;
+    } else if (boost::starts_with(filename, "Data/Rings")) {
+        return TRAJECTORY_TYPE_RINGS;
+    } else if (boost::starts_with(filename, "Data/UCLA")) {
+        return TRAJECTORY_TYPE_UCLA;
+    } else if (boost::starts_with(filename, "Data/ConvectionRolls/output")) {
+        return TRAJECTORY_TYPE_CONVECTION_ROLLS_NEW;
+    } else if (boost::starts_with(filename, "Data/CFD")) {
+        return TRAJECTORY_TYPE_CFD;
+    } else {
+        return TRAJECTORY_TYPE_CONVECTION_ROLLS;
+    }
+}
+
+static bool parseTrajectoryType(const std::string &name, TrajectoryType &trajectoryType)
+{
+    const char *names[] = { "aneurysm", "wcb", "convection_rolls", "rings", "convection_rolls_new", "cfd", "ucla" };
+    for (int i = 0; i < 7; i++) {
+        if (name == names[i]) {
+            trajectoryType = TrajectoryType(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::string getDatasetName(const std::string &filename)
+{
+    size_t slashPosition = filename.find_last_of("/\\");
+    std::string name = slashPosition == std::string::npos ? filename : filename.substr(slashPosition + 1);
+    size_t dotPosition = name.find_last_of('.');
+    return dotPosition == std::string::npos ? name : name.substr(0, dotPosition);
+}
+
+static void printUsage()
+{
+    std::cout << "Usage: PixelSyncOITBenchmark [options]\n"
+              << "  --dataset <file>          Trajectory file (.obj, .nc or .binlines) or mesh file (.hair, .bobj or\n"
+              << "                            cosmic web .dat). Can be used multiple times.\n"
+              << "  --type <type>             Trajectory type of the last dataset (aneurysm, wcb, convection_rolls,\n"
+              << "                            rings, convection_rolls_new, cfd, ucla). Default: from the path.\n"
+              << "  --repetitions <n>         Number of repetitions of every stage (default: 5).\n"
+              << "  --threads <n1,n2,...>     Thread counts to sweep (default: number of hardware threads).\n"
+              << "  --stages <s1,s2,...>      Only run the passed stages (default: all).\n"
+              << "  --output-directory <dir>  Directory for the results and intermediate files.\n"
+              << "  --json <file>             JSON output file name (default: benchmark.json).\n"
+              << "  --csv <file>              CSV output file name (default: benchmark.csv).\n"
+              << "  --line-radius <r>         Tube radius for the triangle mesh conversion (default: 0.001).\n"
+              << "  --voxel-resolution <n>    Voxel grid resolution (default: 128).\n"
+              << "  --image-size <w>x<h>      Size of the synthetic images for the image metrics (default: 1920x1080).\n"
+              << "  --unorm16-size <n>        Number of values of the synthetic unorm16 arrays (default: 16777216).\n"
+              << "  --reorder-curve <curve>   Space-filling curve of the reorder stages (morton, hilbert; default:\n"
+              << "                            hilbert).\n"
+              << "  --camera-paths <dir>      Directory of the camera paths (<dataset>.binpath) of the meshlet\n"
+              << "                            culling stages (default: Data/CameraPaths/; circle path if missing).\n"
+              << "  --culling-frames <n>      Number of frames along the camera path culled per repetition (default:\n"
+              << "                            256).\n"
+              << "  --culling-attribute-range <min>:<max>\n"
+              << "                            Attribute range of the meshlet culling stages (default: 0.1:1).\n"
+              << "  --validate                Check the optimized kernels against reference implementations.\n"
+              << "  --generate <type>:<size>[:<ending>]\n"
+              << "                            Generate a synthetic dataset in the output directory and benchmark it.\n"
+              << "                            Types: helices, random_walks (size: points, ending .binlines or .obj),\n"
+              << "                            hair (points), points (points), triangle_mesh (triangles).\n"
+              << "  --seed <n>                Seed of the synthetic datasets and the shuffle stages (default: 0).\n"
+              << "  --points-per-line <n>     Points per synthetic line or hair strand (default: 128).\n"
+              << "  --line-attributes <n>     Attributes per point of synthetic .binlines files (default: 1).\n"
+              << "  --generate-only           Only generate the synthetic datasets.\n"
+              << "Stages: load_trajectories, write_binlines, read_binlines, write_binlines_compressed,\n"
+              << "        read_binlines_compressed, compute_importance_criteria,\n"
+              << "        compute_importance_criteria_reference, convert_netcdf (.nc files), convert_line_mesh,\n"
+              << "        preprocess_line_mesh, preprocess_line_mesh_reference, shuffle_line_order,\n"
+              << "        load_line_mesh_all_attributes, load_line_mesh_selected_attribute,\n"
+              << "        load_line_attribute_on_demand,\n"
+              << "        reorder_line_mesh, append_line_mesh_attribute, reconvert_line_mesh_attribute,\n"
+              << "        convert_triangle_mesh, conversion_cache_hit, reorder_triangle_mesh,\n"
+              << "        build_line_meshlets, cull_line_meshlets, build_triangle_meshlets, cull_triangle_meshlets,\n"
+              << "        read_mesh, write_mesh,\n"
+              << "        shuffle_triangles, convert_mesh (mesh files), kdtree_build, kdtree_knn, compute_normals,\n"
+              << "        compute_normals_reference,\n"
+              << "        voxelize, voxel_save, voxel_load,\n"
+              << "        image_mse, image_luminance, image_ssim, image_ssim_box, image_msssim, image_block_ssim,\n"
+              << "        image_difference_map, unorm16_pack, unorm16_pack_reference, unorm16_unpack,\n"
+              << "        unorm16_unpack_reference" << std::endl;
+}
+
+static bool parseOptions(int argc, char *argv[], BenchmarkOptions &options)
+{
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        std::string value = hasValue ? argv[i + 1] : "";
+
+        if (option == "--help" || option == "-h") {
+            return false;
+        } else if (option == "--validate") {
+            options.validate = true;
+            continue;
+        } else if (option == "--generate-only") {
+            options.generateOnly = true;
+            continue;
+        } else if (!hasValue) {
+            std::cerr << "Missing value for option " << option << std::endl;
+            return false;
+        }
+
+        i++;
+        if (option == "--dataset") {
+            options.datasets.push_back(BenchmarkDataset{value, getDatasetName(value),
+                                                        getTrajectoryTypeFromFilename(value)});
+        } else if (option == "--type") {
+            if (options.datasets.empty() || !parseTrajectoryType(value, options.datasets.back().trajectoryType)) {
+                std::cerr << "Invalid use of --type " << value << std::endl;
+                return false;
+            }
+        } else if (option == "--repetitions") {
+            options.numRepetitions = std::max(std::atoi(value.c_str()), 1);
+        } else if (option == "--threads" || option == "--stages") {
+            std::vector<std::string> parts;
+            boost::algorithm::split(parts, value, boost::is_any_of(","), boost::token_compress_on);
+            for (const std::string &part : parts) {
+                if (part.empty()) {
+                    continue;
+                }
+                if (option == "--threads") {
+                    options.threadCounts.push_back(std::max(std::atoi(part.c_str()), 1));
+                } else {
+                    options.stages.push_back(part);
+                }
+            }
+        } else if (option == "--output-directory") {
+            options.outputDirectory = value;
+            if (!options.outputDirectory.empty() && options.outputDirectory.back() != '/') {
+                options.outputDirectory += "/";
+            }
+        } else if (option == "--json") {
+            options.jsonFilename = value;
+        } else if (option == "--csv") {
+            options.csvFilename = value;
+        } else if (option == "--line-radius") {
+            options.lineRadius = float(std::atof(value.c_str()));
+        } else if (option == "--voxel-resolution") {
+            options.voxelGridResolution = std::max(std::atoi(value.c_str()), 1);
+        } else if (option == "--image-size") {
+            if (sscanf(value.c_str(), "%dx%d", &options.imageWidth, &options.imageHeight) != 2
+                    || options.imageWidth <= 0 || options.imageHeight <= 0) {
+                std::cerr << "Invalid image size " << value << std::endl;
+                return false;
+            }
+        } else if (option == "--unorm16-size") {
+            // Parsed as a floating point number to allow for e.g. 1e8.
+            double size = std::atof(value.c_str());
+            if (size < 1.0) {
+                std::cerr << "Invalid unorm16 array size " << value << std::endl;
+                return false;
+            }
+            options.unorm16ArraySize = size_t(size);
+        } else if (option == "--reorder-curve") {
+            if (value == "morton") {
+                options.reorderCurve = SPACE_FILLING_CURVE_MORTON;
+            } else if (value == "hilbert") {
+                options.reorderCurve = SPACE_FILLING_CURVE_HILBERT;
+            } else {
+                std::cerr << "Invalid space-filling curve " << value << std::endl;
+                return false;
+            }
+        } else if (option == "--camera-paths") {
+            options.cameraPathDirectory = value;
+            if (!options.cameraPathDirectory.empty() && options.cameraPathDirectory.back() != '/') {
+                options.cameraPathDirectory += "/";
+            }
+        } else if (option == "--culling-frames") {
+            options.numCullingFrames = std::max(std::atoi(value.c_str()), 1);
+        } else if (option == "--culling-attribute-range") {
+            if (sscanf(value.c_str(), "%f:%f", &options.cullingAttributeRangeMin,
+                    &options.cullingAttributeRangeMax) != 2) {
+                std::cerr << "Invalid attribute range " << value << std::endl;
+                return false;
+            }
+        } else if (option == "--generate") {
+            std::vector<std::string> parts;
+            boost::algorithm::split(parts, value, boost::is_any_of(":"));
+            BenchmarkSyntheticDataset syntheticDataset;
+            // The size is parsed as a floating point number to allow for e.g. 1e8.
+            double size = parts.size() >= 2 ? std::atof(parts.at(1).c_str()) : 0.0;
+            if (parts.size() < 2 || parts.size() > 3 || !parseSyntheticDatasetType(parts.at(0), syntheticDataset.type)
+                    || size < 1.0) {
+                std::cerr << "Invalid synthetic dataset " << value << std::endl;
+                return false;
+            }
+            syntheticDataset.size = uint64_t(size + 0.5);
+            syntheticDataset.fileEnding = parts.size() == 3 ? parts.at(2)
+                    : getSyntheticDatasetDefaultExtension(syntheticDataset.type);
+            options.syntheticDatasets.push_back(syntheticDataset);
+        } else if (option == "--seed") {
+            options.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (option == "--points-per-line") {
+            options.numPointsPerLine = uint32_t(std::max(std::atoi(value.c_str()), 2));
+        } else if (option == "--line-attributes") {
+            options.numLineAttributes = uint32_t(std::max(std::atoi(value.c_str()), 1));
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return false;
+        }
+    }
+
+    if (options.threadCounts.empty()) {
+        options.threadCounts.push_back(std::max(int(std::thread::hardware_concurrency()), 1));
+    }
+    return true;
+}
+
+static bool isStageEnabled(const BenchmarkOptions &options, const std::string &stage)
+{
+    return options.stages.empty() || std::find(options.stages.begin(), options.stages.end(), stage)
+            != options.stages.end();
+}
+
+/// Copies the vertex positions and indices of the first submesh. @return False if the mesh has no positions.
+static bool getTriangleMeshData(const BinaryMesh &mesh, std::vector<glm::vec3> &vertices,
+        std::vector<uint32_t> &indices)
+{
+    if (mesh.submeshes.empty()) {
+        return false;
+    }
+    const BinarySubMesh &submesh = mesh.submeshes.front();
+    for (const BinaryMeshAttribute &attribute : submesh.attributes) {
+        if (attribute.name == "vertexPosition" && attribute.attributeFormat == sgl::ATTRIB_FLOAT
+                && attribute.numComponents == 3) {
+            vertices.resize(attribute.data.size() / sizeof(glm::vec3));
+            memcpy(&vertices.front(), &attribute.data.front(), vertices.size() * sizeof(glm::vec3));
+            indices = submesh.indices;
+            return !vertices.empty();
+        }
+    }
+    return false;
+}
+
+/// Runs the stages working on a .binmesh file (read_mesh, write_mesh, shuffle_triangles, kdtree_build, kdtree_knn,
+/// compute_normals, compute_normals_reference).
+static void benchmarkMesh(BenchmarkSuite &suite, const BenchmarkOptions &options, const std::string &name,
+        const std::string &meshFilename, int numThreads)
+{
+    const std::string meshCopyFilename = meshFilename.substr(0, meshFilename.find_last_of('.')) + "_copy.binmesh";
+
+    BinaryMesh mesh;
+    if (isStageEnabled(options, "read_mesh")) {
+        suite.runStage("read_mesh", name, numThreads, [&]() {
+            mesh = BinaryMesh();
+            return readMesh3D(meshFilename, mesh) && !mesh.submeshes.empty();
+        });
+    } else if (!readMesh3D(meshFilename, mesh)) {
+        return;
+    }
+
+    if (isStageEnabled(options, "write_mesh")) {
+        suite.runStage("write_mesh", name, numThreads, [&]() {
+            return writeMesh3D(meshCopyFilename, mesh);
+        });
+    }
+
+    std::vector<glm::vec3> vertices;
+    std::vector<uint32_t> indices;
+    if (!getTriangleMeshData(mesh, vertices, indices)) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in benchmarkMesh: The mesh of \""
+                + name + "\" has no vertex positions.");
+    } else {
+        suite.setCounter("read_mesh", name, "numVertices", double(vertices.size()));
+        suite.setCounter("read_mesh", name, "numIndices", double(indices.size()));
+
+        KDTree kdTree;
+        if (isStageEnabled(options, "kdtree_build")) {
+            suite.runStage("kdtree_build", name, numThreads, [&]() {
+                kdTree.build(vertices);
+                return true;
+            });
+        } else if (isStageEnabled(options, "kdtree_knn")) {
+            kdTree.build(vertices);
+        }
+        if (isStageEnabled(options, "kdtree_knn")) {
+            // Every n-th vertex is used as a query point.
+            size_t stride = std::max(vertices.size() / options.maxNumKDTreeQueries, size_t(1));
+            std::vector<glm::vec3> queryPoints;
+            for (size_t i = 0; i < vertices.size(); i += stride) {
+                queryPoints.push_back(vertices.at(i));
+            }
+            std::vector<int> neighborIndices;
+            std::vector<float> neighborDistances;
+            suite.runStage("kdtree_knn", name, numThreads, [&]() {
+                kdTree.findKNearestPointsBatch(
+                        queryPoints, options.numNearestNeighbors, neighborIndices, neighborDistances);
+                return true;
+            });
+            suite.setCounter("kdtree_knn", name, "numQueries", double(queryPoints.size()));
+        }
+
+        if (isStageEnabled(options, "shuffle_triangles") && !indices.empty()) {
+            std::vector<uint32_t> shuffledIndices;
+            suite.runStage("shuffle_triangles", name, numThreads, [&]() {
+                shuffledIndices = shuffleIndicesTriangles(indices.data(), indices.size(), options.seed);
+                return shuffledIndices.size() == indices.size();
+            });
+        }
+
+        // The reference collects the ring-1 neighbors of the curvature in vectors allocated per vertex.
+        const char *normalStageNames[] = { "compute_normals", "compute_normals_reference" };
+        for (int reference = 0; reference < 2; reference++) {
+            if (!isStageEnabled(options, normalStageNames[reference]) || indices.empty()) {
+                continue;
+            }
+            std::vector<glm::vec3> normals;
+            std::vector<float> curvatures;
+            suite.runStage(normalStageNames[reference], name, numThreads, [&]() {
+                if (reference) {
+                    computeNormalsReference(vertices, indices, normals, curvatures);
+                } else {
+                    computeNormals(vertices, indices, normals, curvatures);
+                }
+                return normals.size() == vertices.size();
+            });
+        }
+    }
+}
+
+/**
+ * Runs the CPU part of parseMesh3D on a line mesh (i.e., the time to the first frame without the GPU upload) with the
+ * fused preprocessing and the previous serial multi-pass preprocessing. Programmable fetch in AoS mode is used, as it
+ * needs the most preprocessing.
+ */
+static void benchmarkMeshPreprocessing(BenchmarkSuite &suite, const BenchmarkOptions &options, const std::string &name,
+        const std::string &meshFilename, int numThreads)
+{
+    MeshPreprocessingSettings settings;
+    settings.useProgrammableFetch = true;
+    settings.programmableFetchUseAoS = true;
+    const char *stageNames[] = { "preprocess_line_mesh", "preprocess_line_mesh_reference" };
+    for (int reference = 0; reference < 2; reference++) {
+        if (!isStageEnabled(options, stageNames[reference])) {
+            continue;
+        }
+        size_t numVertices = 0;
+        suite.runStage(stageNames[reference], name, numThreads, [&]() {
+            MappedBinaryMesh mesh;
+            if (!mesh.open(meshFilename)) {
+                return false;
+            }
+            numVertices = 0;
+            for (const BinarySubMeshView &submesh : mesh.submeshes) {
+                PreprocessedSubmesh preprocessedSubmesh;
+                if (reference) {
+                    preprocessSubmeshReference(submesh, settings, preprocessedSubmesh);
+                } else {
+                    preprocessSubmesh(submesh, settings, preprocessedSubmesh);
+                }
+                if (!preprocessedSubmesh.linePointData.empty()) {
+                    numVertices += preprocessedSubmesh.linePointData.front().size();
+                }
+            }
+            return true;
+        });
+        suite.setCounter(stageNames[reference], name, "numVertices", double(numVertices));
+    }
+
+    if (isStageEnabled(options, "shuffle_line_order")) {
+        MappedBinaryMesh mesh;
+        if (!mesh.open(meshFilename) || mesh.submeshes.empty()) {
+            return;
+        }
+        const BinarySubMeshView &submesh = mesh.submeshes.front();
+        std::vector<uint32_t> shuffledIndices;
+        suite.runStage("shuffle_line_order", name, numThreads, [&]() {
+            shuffledIndices = shuffleLineOrder(submesh.indices, submesh.numIndices, options.seed);
+            return shuffledIndices.size() == submesh.numIndices;
+        });
+        suite.setCounter("shuffle_line_order", name, "numIndices", double(submesh.numIndices));
+    }
+}
+
+/// Bytes of the file the views of the mesh reference, i.e., the data read from disk when the mesh is used.
+static size_t getMappedMeshSize(const MappedBinaryMesh &mesh)
+{
+    size_t numBytes = 0;
+    for (const BinarySubMeshView &submesh : mesh.submeshes) {
+        numBytes += submesh.numIndices * sizeof(uint32_t);
+        for (const BinaryMeshAttributeView &attribute : submesh.attributes) {
+            numBytes += attribute.dataSize;
+        }
+    }
+    return numBytes;
+}
+
+static size_t getPreprocessedSubmeshSize(const PreprocessedSubmesh &preprocessedSubmesh)
+{
+    size_t numBytes = preprocessedSubmesh.indices.size() * sizeof(uint32_t);
+    for (const ImportanceCriterionAttribute &attribute : preprocessedSubmesh.importanceCriterionAttributes) {
+        numBytes += attribute.attributes.size() * sizeof(float);
+    }
+    for (const std::vector<glm::vec4> &attribute : preprocessedSubmesh.vec4Attributes) {
+        numBytes += attribute.size() * sizeof(glm::vec4);
+    }
+    for (const std::vector<LinePointData> &linePointData : preprocessedSubmesh.linePointData) {
+        numBytes += linePointData.size() * sizeof(LinePointData);
+    }
+    return numBytes;
+}
+
+/**
+ * Loads a line mesh like parseMesh3D (CPU part, programmable fetch in AoS mode) with all importance criteria and with
+ * only the displayed one (see selectImportanceCriterion), and loads a second importance criterion on demand.
+ * The counters store the bytes read from the file and the bytes of the preprocessed data in memory.
+ */
+static void benchmarkSelectiveLoading(BenchmarkSuite &suite, const BenchmarkOptions &options, const std::string &name,
+        const std::string &meshFilename, int numThreads)
+{
+    MeshPreprocessingSettings settings;
+    settings.useProgrammableFetch = true;
+    settings.programmableFetchUseAoS = true;
+
+    BinaryMeshTableOfContents tableOfContents;
+    BinaryMeshSelection selection;
+    std::vector<std::string> unselectedAttributeNames;
+    if (!readBinaryMeshTableOfContents(meshFilename, tableOfContents)) {
+        return;
+    }
+    selectImportanceCriterion(tableOfContents, 0, selection, unselectedAttributeNames);
+    const double numImportanceCriteria = double(unselectedAttributeNames.size() + 1);
+
+    const char *stageNames[] = { "load_line_mesh_all_attributes", "load_line_mesh_selected_attribute" };
+    for (int selective = 0; selective < 2; selective++) {
+        if (!isStageEnabled(options, stageNames[selective])) {
+            continue;
+        }
+        size_t numBytesRead = 0, numBytesPreprocessed = 0;
+        suite.runStage(stageNames[selective], name, numThreads, [&]() {
+            MappedBinaryMesh mesh;
+            if (selective) {
+                BinaryMeshTableOfContents currentTableOfContents;
+                std::vector<std::string> currentUnselectedAttributeNames;
+                if (!readBinaryMeshTableOfContents(meshFilename, currentTableOfContents)) {
+                    return false;
+                }
+                selectImportanceCriterion(currentTableOfContents, 0, selection, currentUnselectedAttributeNames);
+            }
+            if (!mesh.open(meshFilename, selective ? selection : BinaryMeshSelection())) {
+                return false;
+            }
+            mesh.prefetch();
+            numBytesRead = getMappedMeshSize(mesh);
+            numBytesPreprocessed = 0;
+            for (const BinarySubMeshView &submesh : mesh.submeshes) {
+                PreprocessedSubmesh preprocessedSubmesh;
+                preprocessSubmesh(submesh, settings, preprocessedSubmesh);
+                numBytesPreprocessed += getPreprocessedSubmeshSize(preprocessedSubmesh);
+            }
+            return true;
+        });
+        suite.setCounter(stageNames[selective], name, "numImportanceCriteria", numImportanceCriteria);
+        suite.setCounter(stageNames[selective], name, "readMiB", double(numBytesRead) / (1024.0 * 1024.0));
+        suite.setCounter(stageNames[selective], name, "preprocessedMiB",
+                double(numBytesPreprocessed) / (1024.0 * 1024.0));
+    }
+
+    if (isStageEnabled(options, "load_line_attribute_on_demand") && !unselectedAttributeNames.empty()) {
+        size_t numBytesRead = 0, numBytesPreprocessed = 0;
+        suite.runStage("load_line_attribute_on_demand", name, numThreads, [&]() {
+            MappedBinaryMesh mesh;
+            std::vector<PreprocessedSubmesh> preprocessedSubmeshes;
+            if (!preprocessSelectedAttributes(meshFilename, { unselectedAttributeNames.front() }, settings, mesh,
+                    preprocessedSubmeshes)) {
+                return false;
+            }
+            numBytesRead = getMappedMeshSize(mesh);
+            numBytesPreprocessed = 0;
+            for (const PreprocessedSubmesh &preprocessedSubmesh : preprocessedSubmeshes) {
+                numBytesPreprocessed += getPreprocessedSubmeshSize(preprocessedSubmesh);
+            }
+            return true;
+        });
+        suite.setCounter("load_line_attribute_on_demand", name, "readMiB", double(numBytesRead) / (1024.0 * 1024.0));
+        suite.setCounter("load_line_attribute_on_demand", name, "preprocessedMiB",
+                double(numBytesPreprocessed) / (1024.0 * 1024.0));
+    }
+}
+
+/**
+ * Sets the simulated cache statistics (see simulateMeshCaches) of the first submesh of the mesh converted without and
+ * with spatial reordering as counters of the passed stage.
+ */
+static void setSpatialReorderCounters(BenchmarkSuite &suite, const std::string &stage, const std::string &name,
+        const std::string &meshFilename, const std::string &reorderedMeshFilename)
+{
+    const char *suffixes[] = { "Before", "After" };
+    const std::string filenames[] = { meshFilename, reorderedMeshFilename };
+    for (int i = 0; i < 2; i++) {
+        MappedBinaryMesh mesh;
+        if (!mesh.open(filenames[i]) || mesh.submeshes.empty()) {
+            return;
+        }
+        const BinarySubMeshView &submesh = mesh.submeshes.front();
+        for (const BinaryMeshAttributeView &attribute : submesh.attributes) {
+            if (attribute.name != "vertexPosition") {
+                continue;
+            }
+            size_t primitiveSize = submesh.vertexMode == sgl::VERTEX_MODE_LINES ? 2 : 3;
+            MeshCacheStatistics statistics = simulateMeshCaches(submesh.indices, submesh.numIndices, primitiveSize,
+                    (const glm::vec3*)attribute.data, attribute.dataSize / sizeof(glm::vec3));
+            suite.setCounter(stage, name, std::string() + "acmr" + suffixes[i], statistics.averageCacheMissRatio);
+            suite.setCounter(stage, name, std::string() + "fetchMissRatio" + suffixes[i],
+                    statistics.vertexFetchMissRatio);
+            suite.setCounter(stage, name, std::string() + "spatialMissRatio" + suffixes[i],
+                    statistics.spatialMissRatio);
+        }
+        if (i == 1) {
+            suite.setCounter(stage, name, "binmeshFlags", double(mesh.getFlags()));
+        }
+    }
+}
+
+/**
+ * Loads the camera path PixelSyncApp stores for the dataset (<camera path directory>/<dataset name>.binpath). If there
+ * is none, the circle path around the bounding box PixelSyncApp creates for new datasets is used.
+ */
+static void loadBenchmarkCameraPath(const BenchmarkOptions &options, const BenchmarkDataset &dataset,
+        sgl::AABB3 boundingBox, CameraPath &cameraPath)
+{
+    const std::string cameraPathFilename = options.cameraPathDirectory + dataset.name + ".binpath";
+    if (sgl::FileUtils::get()->exists(cameraPathFilename) && cameraPath.fromBinaryFile(cameraPathFilename)) {
+        return;
+    }
+    std::string modelFilenamePure = dataset.filename.substr(0, dataset.filename.find_last_of('.'));
+    cameraPath.fromCirclePath(boundingBox, modelFilenamePure);
+}
+
+/**
+ * Builds the meshlets of a line or tube mesh (build_<meshType>_meshlets) and culls them for the frames along the
+ * camera path of the dataset (cull_<meshType>_meshlets). The camera uses the projection of PixelSyncApp.
+ */
+static void benchmarkMeshlets(BenchmarkSuite &suite, const BenchmarkOptions &options,
+        const BenchmarkDataset &dataset, const std::string &meshType, const std::string &meshFilename,
+        int numThreads)
+{
+    const std::string &name = dataset.name;
+    const std::string buildStage = "build_" + meshType + "_meshlets";
+    const std::string cullStage = "cull_" + meshType + "_meshlets";
+    const std::string meshletFilename = meshFilename.substr(0, meshFilename.find_last_of('.')) + "_meshlets.binmesh";
+    if (isStageEnabled(options, buildStage)) {
+        bool success = suite.runStage(buildStage, name, numThreads, [&]() {
+            return convertBinaryMeshToMeshlets(meshFilename, meshletFilename);
+        });
+        if (!success) {
+            return;
+        }
+    } else if (!isStageEnabled(options, cullStage) || (!sgl::FileUtils::get()->exists(meshletFilename)
+            && !convertBinaryMeshToMeshlets(meshFilename, meshletFilename))) {
+        return;
+    }
+
+    MappedBinaryMesh mesh;
+    if (!mesh.open(meshletFilename) || mesh.submeshes.empty() || mesh.submeshes.front().numMeshlets == 0) {
+        return;
+    }
+    const BinarySubMeshView &submesh = mesh.submeshes.front();
+    const BinaryMeshMeshlet *meshlets = submesh.meshlets;
+    const size_t numMeshlets = submesh.numMeshlets;
+    if (isStageEnabled(options, buildStage)) {
+        suite.setCounter(buildStage, name, "numMeshlets", double(numMeshlets));
+        suite.setCounter(buildStage, name, "primitivesPerMeshlet", double(submesh.numIndices)
+                / double(numMeshlets * (submesh.vertexMode == sgl::VERTEX_MODE_LINES ? 2 : 3)));
+    }
+    if (!isStageEnabled(options, cullStage)) {
+        return;
+    }
+
+    sgl::AABB3 boundingBox;
+    for (size_t i = 0; i < numMeshlets; i++) {
+        boundingBox.combine(meshlets[i].aabbMin);
+        boundingBox.combine(meshlets[i].aabbMax);
+    }
+    CameraPath cameraPath;
+    loadBenchmarkCameraPath(options, dataset, boundingBox, cameraPath);
+
+    // Same projection as PixelSyncApp.
+    const float fovy = atanf(1.0f / 2.0f) * 2.0f;
+    glm::mat4 projectionMatrix = glm::perspective(
+            fovy, float(options.imageWidth) / float(options.imageHeight), 0.01f, 100.0f);
+    const size_t numFrames = size_t(options.numCullingFrames);
+    std::vector<glm::mat4> viewProjectionMatrices(numFrames);
+    std::vector<glm::vec3> cameraPositions(numFrames);
+    for (size_t frame = 0; frame < numFrames; frame++) {
+        cameraPath.update(cameraPath.getEndTime() * float(frame) / float(numFrames));
+        const glm::mat4 &viewMatrix = cameraPath.getViewMatrix();
+        viewProjectionMatrices.at(frame) = projectionMatrix * viewMatrix;
+        // The view matrix is a rotation followed by a translation, i.e., the position is -R^T * t.
+        glm::vec3 translation(viewMatrix[3][0], viewMatrix[3][1], viewMatrix[3][2]);
+        for (int i = 0; i < 3; i++) {
+            cameraPositions.at(frame)[i] = -(viewMatrix[i][0] * translation.x + viewMatrix[i][1] * translation.y
+                    + viewMatrix[i][2] * translation.z);
+        }
+    }
+
+    MeshletCullingSettings settings;
+    settings.frustumCulling = true;
+    settings.attributeRangeCulling = true;
+    settings.attributeRangeMin = options.cullingAttributeRangeMin;
+    settings.attributeRangeMax = options.cullingAttributeRangeMax;
+    settings.backfaceCulling = submesh.vertexMode == sgl::VERTEX_MODE_TRIANGLES;
+    MeshletCullingStatistics totalStatistics;
+    size_t numDrawRanges = 0, numVisibleIndices = 0;
+    std::vector<MeshletDrawRange> drawRanges;
+    bool success = suite.runStage(cullStage, name, numThreads, [&]() {
+        totalStatistics = MeshletCullingStatistics();
+        numDrawRanges = 0;
+        numVisibleIndices = 0;
+        for (size_t frame = 0; frame < numFrames; frame++) {
+            MeshletCullingStatistics statistics;
+            cullMeshlets(meshlets, numMeshlets, viewProjectionMatrices.at(frame), cameraPositions.at(frame),
+                    settings, drawRanges, &statistics);
+            totalStatistics.numVisible += statistics.numVisible;
+            totalStatistics.numAttributeCulled += statistics.numAttributeCulled;
+            totalStatistics.numFrustumCulled += statistics.numFrustumCulled;
+            totalStatistics.numBackfaceCulled += statistics.numBackfaceCulled;
+            numDrawRanges += drawRanges.size();
+            for (const MeshletDrawRange &drawRange : drawRanges) {
+                numVisibleIndices += drawRange.indexCount;
+            }
+        }
+        return true;
+    });
+    if (!success) {
+        return;
+    }
+
+    double minTimeMS = DBL_MAX;
+    for (const BenchmarkSample &sample : suite.getSamples()) {
+        if (sample.stage == cullStage && sample.dataset == name && sample.numThreads == numThreads) {
+            minTimeMS = std::min(minTimeMS, sample.timeMS);
+        }
+    }
+    const double numTests = double(numMeshlets) * double(numFrames);
+    suite.setCounter(cullStage, name, "numMeshlets", double(numMeshlets));
+    suite.setCounter(cullStage, name, "numFrames", double(numFrames));
+    suite.setCounter(cullStage, name, "meshletsPerSecond", numTests / std::max(minTimeMS * 1e-3, 1e-9));
+    suite.setCounter(cullStage, name, "visibleRatio", double(totalStatistics.numVisible) / numTests);
+    suite.setCounter(cullStage, name, "attributeCulledRatio", double(totalStatistics.numAttributeCulled) / numTests);
+    suite.setCounter(cullStage, name, "frustumCulledRatio", double(totalStatistics.numFrustumCulled) / numTests);
+    suite.setCounter(cullStage, name, "backfaceCulledRatio", double(totalStatistics.numBackfaceCulled) / numTests);
+    suite.setCounter(cullStage, name, "visibleIndexRatio",
+            double(numVisibleIndices) / (double(submesh.numIndices) * double(numFrames)));
+    suite.setCounter(cullStage, name, "drawRangesPerFrame", double(numDrawRanges) / double(numFrames));
+}
+
+/// Hair, point and binary OBJ datasets are converted directly to a .binmesh file.
+static bool isMeshDatasetFile(const std::string &filename)
+{
+    std::string lowerCaseFilename = boost::to_lower_copy(filename);
+    return boost::ends_with(lowerCaseFilename, ".hair") || boost::ends_with(lowerCaseFilename, ".bobj")
+            || boost::ends_with(lowerCaseFilename, ".dat");
+}
+
+static bool convertMeshDataset(const std::string &filename, const std::string &meshFilename)
+{
+    std::string lowerCaseFilename = boost::to_lower_copy(filename);
+    if (boost::ends_with(lowerCaseFilename, ".hair")) {
+        return convertHairDataToBinaryTriangleMesh(filename, meshFilename);
+    } else if (boost::ends_with(lowerCaseFilename, ".bobj")) {
+        return convertBinaryObjMeshToBinmesh(filename, meshFilename);
+    } else {
+        // The point data set importers report errors using exceptions.
+        try {
+            return convertPointDataSetToBinmesh(filename, meshFilename);
+        } catch (const std::exception &exception) {
+            sgl::Logfile::get()->writeError(std::string() + "Error in convertMeshDataset: " + exception.what());
+            return false;
+        }
+    }
+}
+
+static void benchmarkMeshDataset(BenchmarkSuite &suite, const BenchmarkOptions &options,
+        const BenchmarkDataset &dataset, int numThreads)
+{
+    const std::string &name = dataset.name;
+    const std::string meshFilename = options.outputDirectory + name + ".binmesh";
+
+    if (isStageEnabled(options, "convert_mesh")) {
+        bool success = suite.runStage("convert_mesh", name, numThreads, [&]() {
+            return convertMeshDataset(dataset.filename, meshFilename);
+        });
+        if (!success) {
+            return;
+        }
+    } else if (!sgl::FileUtils::get()->exists(meshFilename)) {
+        if (!convertMeshDataset(dataset.filename, meshFilename)) {
+            return;
+        }
+    }
+
+    benchmarkMesh(suite, options, name, meshFilename, numThreads);
+}
+
+/// Writes and reads the dataset as uncompressed and compressed version 2 .binlines file.
+static void benchmarkBinLines(BenchmarkSuite &suite, const BenchmarkOptions &options,
+        const BenchmarkDataset &dataset, int numThreads)
+{
+    const std::string &name = dataset.name;
+    TrajectorySet trajectories;
+    for (int compressed = 0; compressed < 2; compressed++) {
+        const std::string stageSuffix = compressed ? "_compressed" : "";
+        const std::string writeStage = "write_binlines" + stageSuffix;
+        const std::string readStage = "read_binlines" + stageSuffix;
+        const std::string binLinesFilename = options.outputDirectory + name + stageSuffix + "_v2.binlines";
+        if (!isStageEnabled(options, writeStage) && !isStageEnabled(options, readStage)) {
+            continue;
+        }
+        if (trajectories.empty()) {
+            trajectories = loadTrajectorySetFromFile(dataset.filename, dataset.trajectoryType);
+            if (trajectories.empty()) {
+                return;
+            }
+        }
+
+        BinLinesWriteSettings settings;
+        settings.compressed = compressed != 0;
+        if (isStageEnabled(options, writeStage)) {
+            bool success = suite.runStage(writeStage, name, numThreads, [&]() {
+                return writeBinLinesFile(binLinesFilename, trajectories, {}, settings);
+            });
+            MappedFile mappedFile;
+            if (success && mappedFile.open(binLinesFilename)) {
+                suite.setCounter(writeStage, name, "fileSizeMiB", double(mappedFile.getSize()) / (1024.0 * 1024.0));
+            }
+        } else if (!writeBinLinesFile(binLinesFilename, trajectories, {}, settings)) {
+            continue;
+        }
+
+        if (isStageEnabled(options, readStage)) {
+            suite.runStage(readStage, name, numThreads, [&]() {
+                TrajectorySet loadedTrajectories;
+                return readBinLinesFile(binLinesFilename, loadedTrajectories)
+                        && loadedTrajectories.getNumPoints() == trajectories.getNumPoints();
+            });
+        }
+    }
+}
+
+/**
+ * Computes all importance criteria (except for the attribute of the file) with the previous per-line functions and
+ * with the kernels used by ImportanceCriterionRegistry. Before, the loaders computed the criteria of a trajectory type
+ * eagerly; now only the requested ones are computed.
+ */
+static void benchmarkImportanceCriteria(BenchmarkSuite &suite, const BenchmarkOptions &options,
+        const BenchmarkDataset &dataset, int numThreads)
+{
+    const std::string &name = dataset.name;
+    const std::string referenceStage = "compute_importance_criteria_reference";
+    const std::string kernelStage = "compute_importance_criteria";
+    if (!isStageEnabled(options, referenceStage) && !isStageEnabled(options, kernelStage)) {
+        return;
+    }
+    TrajectorySet trajectories = loadTrajectorySetFromFile(dataset.filename, dataset.trajectoryType);
+    if (trajectories.empty()) {
+        return;
+    }
+    if (trajectories.getNumAttributes() == 0) {
+        trajectories.attributes.push_back(std::vector<float>(trajectories.getNumPoints(), 0.0f));
+    }
+
+    const int NUM_KERNELS = NUM_IMPORTANCE_CRITERION_KERNELS;
+    std::vector<float> values(trajectories.getNumPoints());
+    if (isStageEnabled(options, referenceStage)) {
+        suite.runStage(referenceStage, name, numThreads, [&]() {
+            for (int kernelIndex = 1; kernelIndex < NUM_KERNELS; kernelIndex++) {
+                #pragma omp parallel for schedule(dynamic, 256)
+                for (size_t lineIndex = 0; lineIndex < trajectories.getNumTrajectories(); lineIndex++) {
+                    if (trajectories.getNumPoints(lineIndex) >= 2) {
+                        computeImportanceCriterionReference(ImportanceCriterionKernel(kernelIndex),
+                                trajectories.getPositions(lineIndex), trajectories.getAttribute(lineIndex, 0),
+                                values.data() + trajectories.lineOffsets[lineIndex]);
+                    }
+                }
+            }
+            return true;
+        });
+        suite.setCounter(referenceStage, name, "numKernels", double(NUM_KERNELS - 1));
+    }
+    if (isStageEnabled(options, kernelStage)) {
+        suite.runStage(kernelStage, name, numThreads, [&]() {
+            for (int kernelIndex = 1; kernelIndex < NUM_KERNELS; kernelIndex++) {
+                computeImportanceCriterion(ImportanceCriterionKernel(kernelIndex), trajectories, values.data());
+            }
+            return true;
+        });
+        suite.setCounter(kernelStage, name, "numKernels", double(NUM_KERNELS - 1));
+    }
+}
+
+/// @return The size of the file in bytes (0 if it can't be opened).
+static size_t getFileSize(const std::string &filename)
+{
+    MappedFile mappedFile;
+    return mappedFile.open(filename) ? mappedFile.getSize() : 0;
+}
+
+static bool copyFile(const std::string &sourceFilename, const std::string &destinationFilename)
+{
+    MappedFile sourceFile;
+    if (!sourceFile.open(sourceFilename)) {
+        return false;
+    }
+    FILE *file = fopen(destinationFilename.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool success = fwrite(sourceFile.getData(), 1, sourceFile.getSize(), file) == sourceFile.getSize();
+    return fclose(file) == 0 && success;
+}
+
+/**
+ * Displaying another importance criterion of a line mesh: Appending the criterion to the mesh converted for the first
+ * criterion compared to converting the mesh again with both criteria (as before the criteria were appended).
+ */
+static void benchmarkAttributeAppend(BenchmarkSuite &suite, const BenchmarkOptions &options,
+        const BenchmarkDataset &dataset, int numThreads)
+{
+    const std::string &name = dataset.name;
+    const std::string appendStage = "append_line_mesh_attribute";
+    const std::string reconvertStage = "reconvert_line_mesh_attribute";
+    const int numCriteria = getNumImportanceCriteria(dataset.trajectoryType);
+    if ((!isStageEnabled(options, appendStage) && !isStageEnabled(options, reconvertStage)) || numCriteria < 2) {
+        return;
+    }
+    const std::string convertedFilename = options.outputDirectory + name + "_lines_criterion0.binmesh";
+    const std::string meshFilename = options.outputDirectory + name + "_lines_appended.binmesh";
+    const std::vector<int> convertedCriteria = { 0 };
+    const std::vector<int> appendedCriteria = { numCriteria - 1 };
+    if (!convertTrajectoryDataToBinaryLineMesh(dataset.trajectoryType, dataset.filename, convertedFilename,
+            SpatialReorderSettings(), nullptr, convertedCriteria)) {
+        return;
+    }
+
+    if (isStageEnabled(options, appendStage)) {
+        bool success = suite.runStage(appendStage, name, numThreads, [&]() {
+            return appendImportanceCriteriaToBinaryMesh(
+                    dataset.trajectoryType, dataset.filename, meshFilename, appendedCriteria);
+        }, [&]() {
+            copyFile(convertedFilename, meshFilename);
+        });
+        if (success) {
+            suite.setCounter(appendStage, name, "fileGrowthMiB",
+                    (double(getFileSize(meshFilename)) - double(getFileSize(convertedFilename))) / (1024.0 * 1024.0));
+        }
+    }
+    if (isStageEnabled(options, reconvertStage)) {
+        suite.runStage(reconvertStage, name, numThreads, [&]() {
+            return convertTrajectoryDataToBinaryLineMesh(dataset.trajectoryType, dataset.filename, meshFilename,
+                    SpatialReorderSettings(), nullptr, { convertedCriteria.front(), appendedCriteria.front() });
+        });
+    }
+}
+
+static void benchmarkDataset(BenchmarkSuite &suite, const BenchmarkOptions &options,
+        const BenchmarkDataset &dataset, int numThreads)
+{
+    const std::string &name = dataset.name;
+    const std::string lineMeshFilename = options.outputDirectory + name + "_lines.binmesh";
+    const std::string triangleMeshFilename = options.outputDirectory + name + "_tubes.binmesh";
+    const std::string voxelGridFilename = options.outputDirectory + name + ".voxel";
+
+    if (isStageEnabled(options, "load_trajectories")) {
+        Trajectories trajectories;
+        bool success = suite.runStage("load_trajectories", name, numThreads, [&]() {
+            trajectories = loadTrajectoriesFromFile(dataset.filename, dataset.trajectoryType);
+            return !trajectories.empty();
+        });
+        if (!success) {
+            return;
+        }
+        size_t numPoints = 0;
+        for (const Trajectory &trajectory : trajectories) {
+            numPoints += trajectory.positions.size();
+        }
+        suite.setCounter("load_trajectories", name, "numLines", double(trajectories.size()));
+        suite.setCounter("load_trajectories", name, "numPoints", double(numPoints));
+    }
+
+    benchmarkBinLines(suite, options, dataset, numThreads);
+    benchmarkImportanceCriteria(suite, options, dataset, numThreads);
+
+    if (boost::ends_with(boost::to_lower_copy(dataset.filename), ".nc")
+            && isStageEnabled(options, "convert_netcdf")) {
+        NetCdfReadStatistics statistics;
+        bool success = suite.runStage("convert_netcdf", name, numThreads, [&]() {
+            NetCdfReadSettings settings;
+            settings.numWorkerThreads = size_t(numThreads);
+            return convertNetCdfFileToBinLines(
+                    dataset.filename, options.outputDirectory + name + "_netcdf.binlines", settings, &statistics);
+        });
+        if (success) {
+            suite.setCounter("convert_netcdf", name, "numChunks", double(statistics.numChunks));
+            suite.setCounter("convert_netcdf", name, "throughputMBs", statistics.throughputMBs);
+            suite.setCounter("convert_netcdf", name, "peakRSSMiB", statistics.peakResidentSetSizeMiB);
+        }
+    }
+
+    if (isStageEnabled(options, "convert_line_mesh")) {
+        suite.runStage("convert_line_mesh", name, numThreads, [&]() {
+            return convertTrajectoryDataToBinaryLineMesh(dataset.trajectoryType, dataset.filename, lineMeshFilename);
+        });
+    }
+    if (isStageEnabled(options, "preprocess_line_mesh") || isStageEnabled(options, "preprocess_line_mesh_reference")
+            || isStageEnabled(options, "shuffle_line_order")) {
+        if (!isStageEnabled(options, "convert_line_mesh") && !sgl::FileUtils::get()->exists(lineMeshFilename)) {
+            convertTrajectoryDataToBinaryLineMesh(dataset.trajectoryType, dataset.filename, lineMeshFilename);
+        }
+        benchmarkMeshPreprocessing(suite, options, name, lineMeshFilename, numThreads);
+    }
+    if (isStageEnabled(options, "load_line_mesh_all_attributes")
+            || isStageEnabled(options, "load_line_mesh_selected_attribute")
+            || isStageEnabled(options, "load_line_attribute_on_demand")) {
+        if (!isStageEnabled(options, "convert_line_mesh") && !sgl::FileUtils::get()->exists(lineMeshFilename)) {
+            convertTrajectoryDataToBinaryLineMesh(dataset.trajectoryType, dataset.filename, lineMeshFilename);
+        }
+        benchmarkSelectiveLoading(suite, options, name, lineMeshFilename, numThreads);
+    }
+    if (isStageEnabled(options, "reorder_line_mesh")) {
+        if (!isStageEnabled(options, "convert_line_mesh") && !sgl::FileUtils::get()->exists(lineMeshFilename)) {
+            convertTrajectoryDataToBinaryLineMesh(dataset.trajectoryType, dataset.filename, lineMeshFilename);
+        }
+        const std::string reorderedFilename = options.outputDirectory + name + "_lines_reordered.binmesh";
+        SpatialReorderSettings reorderSettings;
+        reorderSettings.curve = options.reorderCurve;
+        bool success = suite.runStage("reorder_line_mesh", name, numThreads, [&]() {
+            return convertTrajectoryDataToBinaryLineMesh(
+                    dataset.trajectoryType, dataset.filename, reorderedFilename, reorderSettings);
+        });
+        if (success) {
+            setSpatialReorderCounters(suite, "reorder_line_mesh", name, lineMeshFilename, reorderedFilename);
+        }
+    }
+
+    benchmarkAttributeAppend(suite, options, dataset, numThreads);
+
+    // The following stages work on the tube mesh.
+    if (isStageEnabled(options, "convert_triangle_mesh")) {
+        suite.runStage("convert_triangle_mesh", name, numThreads, [&]() {
+            return convertTrajectoryDataToBinaryTriangleMesh(
+                    dataset.trajectoryType, dataset.filename, triangleMeshFilename, options.lineRadius);
+        });
+    } else if (!sgl::FileUtils::get()->exists(triangleMeshFilename)) {
+        convertTrajectoryDataToBinaryTriangleMesh(
+                dataset.trajectoryType, dataset.filename, triangleMeshFilename, options.lineRadius);
+    }
+
+    if (isStageEnabled(options, "conversion_cache_hit")) {
+        // Lookup of the tube mesh in a conversion cache, where it was already converted with the same parameters
+        ConversionCache cache(options.outputDirectory + "ConversionCache/");
+        ConversionCacheKey key("trajectories_triangle_mesh", ".binmesh");
+        key.addSourceFile(dataset.filename);
+        key.addParameter("trajectoryType", int(dataset.trajectoryType));
+        key.addParameter("lineRadius", options.lineRadius);
+        key.addParameter("numCircleSegments", NUM_CIRCLE_SEGMENTS);
+        auto convert = [&](const std::string &outputFilename) {
+            return convertTrajectoryDataToBinaryTriangleMesh(
+                    dataset.trajectoryType, dataset.filename, outputFilename, options.lineRadius);
+        };
+        if (!cache.getArtifact(key, convert).empty()) {
+            cache.resetStatistics();
+            bool success = suite.runStage("conversion_cache_hit", name, numThreads, [&]() {
+                return !cache.getArtifact(key, convert).empty();
+            });
+            ConversionCacheStatistics statistics = cache.getStatistics();
+            if (success && statistics.numHits > 0) {
+                suite.setCounter("conversion_cache_hit", name, "hitRate", statistics.getHitRate());
+                suite.setCounter("conversion_cache_hit", name, "artifactMiB",
+                        double(statistics.bytesSaved) / double(statistics.numHits) / (1024.0 * 1024.0));
+                suite.setCounter("conversion_cache_hit", name, "conversionTimeSavedMS",
+                        statistics.conversionTimeSavedMS / double(statistics.numHits));
+            }
+        }
+    }
+
+    if (isStageEnabled(options, "reorder_triangle_mesh")) {
+        const std::string reorderedFilename = options.outputDirectory + name + "_tubes_reordered.binmesh";
+        SpatialReorderSettings reorderSettings;
+        reorderSettings.curve = options.reorderCurve;
+        reorderSettings.optimizeVertexCache = true;
+        bool success = suite.runStage("reorder_triangle_mesh", name, numThreads, [&]() {
+            return convertTrajectoryDataToBinaryTriangleMesh(dataset.trajectoryType, dataset.filename,
+                    reorderedFilename, options.lineRadius, reorderSettings);
+        });
+        if (success) {
+            setSpatialReorderCounters(suite, "reorder_triangle_mesh", name, triangleMeshFilename, reorderedFilename);
+        }
+    }
+
+    benchmarkMesh(suite, options, name, triangleMeshFilename, numThreads);
+
+    if ((isStageEnabled(options, "build_line_meshlets") || isStageEnabled(options, "cull_line_meshlets"))
+            && !sgl::FileUtils::get()->exists(lineMeshFilename)) {
+        convertTrajectoryDataToBinaryLineMesh(dataset.trajectoryType, dataset.filename, lineMeshFilename);
+    }
+    benchmarkMeshlets(suite, options, dataset, "line", lineMeshFilename, numThreads);
+    benchmarkMeshlets(suite, options, dataset, "triangle", triangleMeshFilename, numThreads);
+
+    VoxelGridDataCompressed voxelGrid;
+    if (isStageEnabled(options, "voxelize") || isStageEnabled(options, "voxel_save")) {
+        bool success = suite.runStage("voxelize", name, numThreads, [&]() {
+            VoxelCurveDiscretizer discretizer(glm::ivec3(options.voxelGridResolution),
+                    glm::ivec3(options.voxelQuantizationResolution));
+            std::vector<float> attributes;
+            float maxAttribute = 0.0f;
+            voxelGrid = discretizer.createFromTrajectoryDataset(dataset.filename, dataset.trajectoryType,
+                    attributes, maxAttribute, options.maxNumLinesPerVoxel, false);
+            return !voxelGrid.voxelLineListOffsets.empty();
+        });
+        if (success) {
+            suite.setCounter("voxelize", name, "numLineSegments", double(voxelGrid.lineSegments.size()));
+        }
+    }
+    if (!voxelGrid.voxelLineListOffsets.empty() && isStageEnabled(options, "voxel_save")) {
+        suite.runStage("voxel_save", name, numThreads, [&]() {
+            saveToFile(voxelGridFilename, voxelGrid);
+            return true;
+        });
+    }
+    if (isStageEnabled(options, "voxel_load") && sgl::FileUtils::get()->exists(voxelGridFilename)) {
+        suite.runStage("voxel_load", name, numThreads, [&]() {
+            VoxelGridDataCompressed loadedVoxelGrid;
+            loadFromFile(voxelGridFilename, loadedVoxelGrid);
+            return !loadedVoxelGrid.voxelLineListOffsets.empty();
+        });
+    }
+}
+
+static void benchmarkImageMetrics(BenchmarkSuite &suite, const BenchmarkOptions &options, int numThreads)
+{
+    const int width = options.imageWidth, height = options.imageHeight;
+    const std::string name = "synthetic_" + std::to_string(width) + "x" + std::to_string(height);
+    std::vector<uint8_t> expectedImage, observedImage;
+    createSyntheticImagePair(width, height, expectedImage, observedImage);
+    ImageViewRGBA8 expectedView(expectedImage.data(), width, height);
+    ImageViewRGBA8 observedView(observedImage.data(), width, height);
+
+    if (isStageEnabled(options, "image_mse")) {
+        suite.runStage("image_mse", name, numThreads, [&]() {
+            double mse = computeMSE(expectedView, observedView);
+            return computePSNR(mse, 255.0) > 0.0;
+        });
+    }
+
+    GrayscaleImage expected, observed;
+    computeLuminance(expectedView, expected);
+    computeLuminance(observedView, observed);
+    if (isStageEnabled(options, "image_luminance")) {
+        suite.runStage("image_luminance", name, numThreads, [&]() {
+            computeLuminance(expectedView, expected);
+            computeLuminance(observedView, observed);
+            return true;
+        });
+    }
+
+    SSIMSettings gaussianSettings;
+    SSIMSettings boxSettings;
+    boxSettings.windowType = SSIM_WINDOW_BOX;
+    if (isStageEnabled(options, "image_ssim")) {
+        suite.runStage("image_ssim", name, numThreads, [&]() {
+            return computeSSIM(expected, observed, gaussianSettings) > 0.0;
+        });
+    }
+    if (isStageEnabled(options, "image_ssim_box")) {
+        suite.runStage("image_ssim_box", name, numThreads, [&]() {
+            return computeSSIM(expected, observed, boxSettings) > 0.0;
+        });
+    }
+    if (isStageEnabled(options, "image_msssim")) {
+        suite.runStage("image_msssim", name, numThreads, [&]() {
+            return computeMSSSIM(expected, observed, gaussianSettings) > 0.0;
+        });
+    }
+    if (isStageEnabled(options, "image_block_ssim")) {
+        GrayscaleImage ssimMap;
+        suite.runStage("image_block_ssim", name, numThreads, [&]() {
+            computeBlockSSIMMap(expected, observed, 16, ssimMap, gaussianSettings);
+            return true;
+        });
+    }
+    if (isStageEnabled(options, "image_difference_map")) {
+        std::vector<uint8_t> differenceMap;
+        suite.runStage("image_difference_map", name, numThreads, [&]() {
+            computeDifferenceMap(expectedView, observedView, DIFFERENCE_MAP_RGB_NORMALIZED, differenceMap);
+            return true;
+        });
+    }
+}
+
+/**
+ * Compares the unorm16 kernels (packUnorm16/unpackUnorm16, as used for the importance criteria of .binmesh files) with
+ * the previous implementations on a synthetic array of smoothly varying values with noise.
+ */
+static void benchmarkUnorm16(BenchmarkSuite &suite, const BenchmarkOptions &options, int numThreads)
+{
+    const size_t numValues = options.unorm16ArraySize;
+    const std::string name = "synthetic_" + std::to_string(numValues);
+    if (!isStageEnabled(options, "unorm16_pack") && !isStageEnabled(options, "unorm16_pack_reference")
+            && !isStageEnabled(options, "unorm16_unpack") && !isStageEnabled(options, "unorm16_unpack_reference")) {
+        return;
+    }
+
+    std::vector<float> values(numValues);
+    #pragma omp parallel for
+    for (size_t i = 0; i < numValues; i++) {
+        uint32_t hash = uint32_t(i) * 2654435761u;
+        values[i] = std::sin(float(i % 100000) * 1e-4f) * 10.0f + float(hash >> 8) * 1e-7f;
+    }
+    std::vector<uint16_t> codes(numValues);
+    std::vector<float> unpackedValues(numValues);
+    Unorm16Statistics statistics;
+    statistics.histogram.resize(256);
+
+    if (isStageEnabled(options, "unorm16_pack")) {
+        suite.runStage("unorm16_pack", name, numThreads, [&]() {
+            packUnorm16(values.data(), numValues, codes.data(), UNORM16_ROUND_NEAREST, &statistics);
+            return statistics.minValue < statistics.maxValue;
+        });
+        suite.setCounter("unorm16_pack", name, "numValues", double(numValues));
+    }
+    if (isStageEnabled(options, "unorm16_pack_reference")) {
+        suite.runStage("unorm16_pack_reference", name, numThreads, [&]() {
+            packUnorm16ArrayReference(values, codes);
+            return true;
+        });
+        suite.setCounter("unorm16_pack_reference", name, "numValues", double(numValues));
+    }
+
+    packUnorm16(values.data(), numValues, codes.data());
+    if (isStageEnabled(options, "unorm16_unpack")) {
+        suite.runStage("unorm16_unpack", name, numThreads, [&]() {
+            unpackUnorm16(codes.data(), numValues, unpackedValues.data(), &statistics);
+            return statistics.minValue < statistics.maxValue;
+        });
+        suite.setCounter("unorm16_unpack", name, "numValues", double(numValues));
+    }
+    if (isStageEnabled(options, "unorm16_unpack_reference")) {
+        suite.runStage("unorm16_unpack_reference", name, numThreads, [&]() {
+            // Like parseMesh3D before the kernels: Unpack, then compute the range in a second pass.
+            unpackUnorm16ArrayReference(codes.data(), numValues, unpackedValues);
+            float minValue = FLT_MAX, maxValue = -FLT_MAX;
+            #pragma omp parallel for reduction(min:minValue) reduction(max:maxValue)
+            for (size_t i = 0; i < numValues; i++) {
+                minValue = std::min(minValue, unpackedValues[i]);
+                maxValue = std::max(maxValue, unpackedValues[i]);
+            }
+            return minValue < maxValue;
+        });
+        suite.setCounter("unorm16_unpack_reference", name, "numValues", double(numValues));
+    }
+}
+
+/**
+ * Generates the synthetic datasets (using all hardware threads) and adds them to the datasets to benchmark.
+ * The sizes are stored as counters of the stage "generate", such that the stage times can be related to them.
+ */
+static bool generateSyntheticDatasets(BenchmarkSuite &suite, BenchmarkOptions &options)
+{
+    for (const BenchmarkSyntheticDataset &syntheticDataset : options.syntheticDatasets) {
+        SyntheticDatasetSettings settings;
+        settings.type = syntheticDataset.type;
+        settings.seed = options.seed;
+        settings.size = syntheticDataset.size;
+        settings.numPointsPerLine = options.numPointsPerLine;
+        settings.numAttributes = options.numLineAttributes;
+
+        std::string filename = options.outputDirectory + "synthetic_" + SYNTHETIC_DATASET_TYPE_NAMES[settings.type]
+                + "_" + std::to_string(settings.size) + "_seed" + std::to_string(settings.seed)
+                + syntheticDataset.fileEnding;
+        SyntheticDatasetStatistics statistics;
+        if (!generateSyntheticDataset(filename, settings, &statistics)) {
+            std::cerr << "Couldn't generate the synthetic dataset " << filename << std::endl;
+            return false;
+        }
+
+        // Like for the rings dataset, the line positions are only normalized to the unit cube.
+        BenchmarkDataset dataset{filename, getDatasetName(filename), TRAJECTORY_TYPE_RINGS};
+        suite.setCounter("generate", dataset.name, "numPrimitives", double(statistics.numPrimitives));
+        suite.setCounter("generate", dataset.name, "numLines", double(statistics.numLines));
+        suite.setCounter("generate", dataset.name, "fileSizeMiB", double(statistics.fileSize) / (1024.0 * 1024.0));
+        options.datasets.push_back(dataset);
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    BenchmarkOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    sgl::FileUtils::get()->initialize("pixel-sync-oit-benchmark", argc, argv);
+    sgl::FileUtils::get()->ensureDirectoryExists(options.outputDirectory);
+    sgl::Logfile::get()->createLogfile((options.outputDirectory + "Logfile.html").c_str(), "PixelSyncOITBenchmark");
+
+    BenchmarkSuite suite(options.numRepetitions);
+    if (!generateSyntheticDatasets(suite, options)) {
+        return 1;
+    }
+    if (options.generateOnly) {
+        return suite.writeJson(options.outputDirectory + options.jsonFilename, options.threadCounts) ? 0 : 1;
+    }
+
+    for (int numThreads : options.threadCounts) {
+        BenchmarkSuite::setNumThreads(numThreads);
+        for (const BenchmarkDataset &dataset : options.datasets) {
+            if (isMeshDatasetFile(dataset.filename)) {
+                benchmarkMeshDataset(suite, options, dataset, numThreads);
+            } else {
+                benchmarkDataset(suite, options, dataset, numThreads);
+            }
+        }
+        benchmarkImageMetrics(suite, options, numThreads);
+        benchmarkUnorm16(suite, options, numThreads);
+    }
+
+    if (options.validate) {
+        validateKDTree(suite, options.threadCounts);
+        validateComputeNormals(suite, options.threadCounts);
+        validateImageMetrics(suite, options.threadCounts);
+        validateFrameTimeStatistics(suite, options.threadCounts);
+        validateBinLinesFile(suite, options.threadCounts, options.outputDirectory);
+        validateBinaryMeshReader(suite, options.outputDirectory);
+        validateUnorm16(suite, options.threadCounts);
+        validateMeshPreprocessing(suite, options.threadCounts);
+        validateShuffle(suite, options.threadCounts);
+        validateSpatialReordering(suite, options.threadCounts);
+        validateMeshlets(suite, options.threadCounts, options.outputDirectory);
+        validateConversionCache(suite, options.threadCounts, options.outputDirectory);
+        validateSelectiveLoading(suite, options.threadCounts, options.outputDirectory);
+        validateImportanceCriteria(suite, options.threadCounts, options.outputDirectory);
+        validateBinaryMeshAppend(suite, options.threadCounts, options.outputDirectory);
+        validateTubeRenderData(suite, options.threadCounts);
+        validateVoxelAO(suite, options.threadCounts);
+        validateErrorMetricPipeline(suite, options.threadCounts);
+        validateNumberParser(suite);
+        validateObjLoader(suite, options.threadCounts, options.outputDirectory);
+        validateVoxelizer(suite, options.threadCounts, options.outputDirectory);
+        validateNetCdfLoader(suite, options.threadCounts, options.outputDirectory);
+    }
+
+    bool success = suite.writeJson(options.outputDirectory + options.jsonFilename, options.threadCounts);
+    success = suite.writeCsv(options.outputDirectory + options.csvFilename) && success;
+    std::cout << "Wrote " << suite.getSamples().size() << " samples to " << options.outputDirectory
+              << options.jsonFilename << " and " << options.csvFilename << std::endl;
+
+    if (!suite.allValidationsPassed()) {
+        std::cerr << "Some validation checks failed." << std::endl;
+        return 2;
+    }
+    return success ? 0 : 1;
+}
@@ -0,0 +1,784 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cfloat>
+
+#include <glm/glm.hpp>
+#include <netcdf.h>
+#include <Utils/Convert.hpp>
+#include <Utils/Events/Stream/Stream.hpp>
+#include <Utils/File/Logfile.hpp>
+
+#include "Utils/ImportanceCriteria.hpp"
+#include "BenchmarkReferences.hpp"
+
+bool writeMesh3DVersion4Reference(const std::string &filename, const BinaryMesh &mesh)
+{
+    FILE *file = fopen(filename.c_str(), "wb");
+    if (file == NULL) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in writeMesh3DVersion4Reference: File \""
+                + filename + "\" could not be opened.");
+        return false;
+    }
+
+    sgl::BinaryWriteStream stream;
+    stream.write((uint32_t)MESH_FORMAT_VERSION_LEGACY);
+    stream.write((uint32_t)mesh.submeshes.size());
+
+    for (const BinarySubMesh &submesh : mesh.submeshes) {
+        stream.write(submesh.material);
+        stream.write((uint32_t)submesh.vertexMode);
+        stream.writeArray(submesh.indices);
+
+        // Write attributes
+        stream.write((uint32_t)submesh.attributes.size());
+        for (const BinaryMeshAttribute &attribute : submesh.attributes) {
+            stream.write(attribute.name);
+            stream.write((uint32_t)attribute.attributeFormat);
+            stream.write((uint32_t)attribute.numComponents);
+            stream.writeArray(attribute.data);
+        }
+
+        // Write uniforms
+        stream.write((uint32_t)submesh.uniforms.size());
+        for (const BinaryMeshUniform &uniform : submesh.uniforms) {
+            stream.write(uniform.name);
+            stream.write((uint32_t)uniform.attributeFormat);
+            stream.write((uint32_t)uniform.numComponents);
+            stream.writeArray(uniform.data);
+        }
+    }
+
+    bool success = fwrite((const void*)stream.getBuffer(), 1, stream.getSize(), file) == stream.getSize();
+    return fclose(file) == 0 && success;
+}
+
+void computeNormalsReference(const std::vector<glm::vec3> &vertices, const std::vector<uint32_t> &indices,
+        std::vector<glm::vec3> &normals, std::vector<float> &attributes)
+{
+    std::vector<std::vector<uint32_t>> indexMap;
+    indexMap.resize(vertices.size());
+    for (size_t j = 0; j < indices.size(); j++) {
+        indexMap[indices.at(j)].push_back(uint32_t(j / 3));
+    }
+
+    std::vector<glm::vec3> faceNormals(indices.size() / 3);
+    for (size_t f = 0; f < faceNormals.size(); ++f) {
+        size_t vertIndex = f * 3;
+        size_t i1 = indices.at(vertIndex), i2 = indices.at(vertIndex+1), i3 = indices.at(vertIndex+2);
+        faceNormals[f] = glm::cross(vertices.at(i3) - vertices.at(i1), vertices.at(i2) - vertices.at(i1));
+    }
+
+    normals.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        glm::vec3 normal(0.0f, 0.0f, 0.0f);
+        int numTrianglesSharedBy = 0;
+        for (uint32_t face : indexMap[i]) {
+            normal += faceNormals[face];
+            numTrianglesSharedBy++;
+        }
+        if (numTrianglesSharedBy == 0) {
+            sgl::Logfile::get()->writeError("Error in computeNormalsReference: numTrianglesSharedBy == 0");
+            exit(1);
+        }
+        normal /= (float)numTrianglesSharedBy;
+        normals[i] = glm::normalize(normal);
+    }
+
+    attributes.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        const glm::vec3 &n0 = normals[i];
+        const glm::vec3 &p0 = vertices[i];
+
+        std::vector<uint32_t> ring1Vertices;
+        for (uint32_t face : indexMap[i]) {
+            size_t vertIndex = size_t(face) * 3;
+            std::vector<uint32_t> idx = { indices[vertIndex], indices[vertIndex+1], indices[vertIndex+2] };
+            for (int j = 0; j < 3; ++j) {
+                uint32_t vID = idx[j];
+                if (vID != i && std::find(ring1Vertices.begin(), ring1Vertices.end(), vID) == ring1Vertices.end()) {
+                    ring1Vertices.push_back(vID);
+                }
+            }
+        }
+
+        std::vector<float> ring1Curvatures(ring1Vertices.size(), 0);
+        for (size_t v = 0; v < ring1Vertices.size(); ++v) {
+            const glm::vec3 n = normals[ring1Vertices[v]] - n0;
+            const glm::vec3 p = vertices[ring1Vertices[v]] - p0;
+            ring1Curvatures[v] = glm::dot(n, p) / glm::dot(p, p);
+        }
+
+        double totalCurvature = 0;
+        double totalAngle = 0;
+        for (size_t e = 0; e + 1 < ring1Vertices.size(); ++e) {
+            glm::vec3 edge0 = vertices[ring1Vertices[e]] - p0;
+            glm::vec3 edge1 = vertices[ring1Vertices[e + 1]] - p0;
+            glm::vec3 product = glm::cross(edge0, edge1);
+            double sineValue = glm::length(product) / (glm::length(edge0) * glm::length(edge1));
+            double angle = std::asin(std::min(1.0, sineValue));
+            totalAngle += angle;
+            totalCurvature += angle * (ring1Curvatures[e] + ring1Curvatures[e + 1]);
+        }
+        attributes[i] = totalAngle > 0.0 ? float(totalCurvature / (2 * totalAngle)) : 0.0f;
+    }
+}
+
+void preprocessSubmeshReference(const BinarySubMeshView &submesh, const MeshPreprocessingSettings &settings,
+        PreprocessedSubmesh &preprocessedSubmesh)
+{
+    preprocessedSubmesh = PreprocessedSubmesh();
+    const bool useProgrammableFetch = settings.useProgrammableFetch;
+    const bool programmableFetchUseAoS = settings.programmableFetchUseAoS;
+
+    if (submesh.numIndices > 0 && !useProgrammableFetch && settings.shuffleData) {
+        if (submesh.vertexMode == sgl::VERTEX_MODE_LINES) {
+            preprocessedSubmesh.indices = shuffleLineOrder(submesh.indices, submesh.numIndices, settings.shuffleSeed);
+        } else if (submesh.vertexMode == sgl::VERTEX_MODE_TRIANGLES) {
+            preprocessedSubmesh.indices = shuffleIndicesTriangles(
+                    submesh.indices, submesh.numIndices, settings.shuffleSeed);
+        }
+    }
+    if (submesh.numIndices > 0 && useProgrammableFetch) {
+        // Modify indices
+        std::vector<uint32_t> fetchIndices;
+        fetchIndices.reserve(submesh.numIndices*3);
+        // Iterate over all line segments
+        for (size_t i = 0; i < submesh.numIndices; i += 2) {
+            uint32_t base0 = submesh.indices[i]*2;
+            uint32_t base1 = submesh.indices[i+1]*2;
+            // 0,2,3,0,3,1
+            fetchIndices.push_back(base0);
+            fetchIndices.push_back(base1);
+            fetchIndices.push_back(base1+1);
+            fetchIndices.push_back(base0);
+            fetchIndices.push_back(base1+1);
+            fetchIndices.push_back(base0+1);
+        }
+        preprocessedSubmesh.indices = fetchIndices;
+    }
+
+    // For programmableFetchUseAoS
+    std::vector<glm::vec3> vertexPositionData;
+    std::vector<std::vector<float>> vertexAttributeData;
+    std::vector<glm::vec3> vertexTangentData;
+    preprocessedSubmesh.vec4Attributes.resize(submesh.attributes.size());
+
+    for (size_t j = 0; j < submesh.attributes.size(); j++) {
+        const BinaryMeshAttributeView &meshAttribute = submesh.attributes.at(j);
+
+        if (meshAttribute.numComponents == 1) {
+            ImportanceCriterionAttribute importanceCriterionAttribute;
+            importanceCriterionAttribute.name = meshAttribute.name;
+
+            // Copy values to mesh renderer data structure
+            const uint16_t *attributeValuesUnorm = (const uint16_t*)meshAttribute.data;
+            size_t numAttributeValues = meshAttribute.dataSize / sizeof(uint16_t);
+            unpackUnorm16Array(attributeValuesUnorm, numAttributeValues, importanceCriterionAttribute.attributes);
+
+            // Compute minimum and maximum value
+            float minValue = FLT_MAX, maxValue = 0.0f;
+            for (size_t k = 0; k < numAttributeValues; k++) {
+                minValue = std::min(minValue, importanceCriterionAttribute.attributes[k]);
+                maxValue = std::max(maxValue, importanceCriterionAttribute.attributes[k]);
+            }
+            importanceCriterionAttribute.minAttribute = minValue;
+            importanceCriterionAttribute.maxAttribute = maxValue;
+
+            preprocessedSubmesh.importanceCriterionAttributes.push_back(importanceCriterionAttribute);
+
+            if (useProgrammableFetch && programmableFetchUseAoS) {
+                int attributeIndex = sgl::fromString<int>(meshAttribute.name.substr(15));
+                if (attributeIndex >= int(vertexAttributeData.size())) {
+                    vertexAttributeData.resize(attributeIndex+1);
+                }
+                vertexAttributeData.at(attributeIndex).resize(numAttributeValues);
+                for (size_t k = 0; k < numAttributeValues; k++) {
+                    vertexAttributeData.at(attributeIndex).at(k) = importanceCriterionAttribute.attributes[k];
+                }
+            }
+        }
+
+        if (meshAttribute.numComponents == 3 && (useProgrammableFetch && !programmableFetchUseAoS)) {
+            // vec3 problematic in std430 struct
+            const glm::vec3 *attributeValues = (const glm::vec3*)meshAttribute.data;
+            size_t numAttributeValues = meshAttribute.dataSize / sizeof(glm::vec3);
+            std::vector<glm::vec4> vec4AttributeValues;
+            vec4AttributeValues.reserve(numAttributeValues);
+            for (size_t i = 0; i < numAttributeValues; i++) {
+                glm::vec3 vec3Value = attributeValues[i];
+                vec4AttributeValues.push_back(glm::vec4(vec3Value.x, vec3Value.y, vec3Value.z, 1.0f));
+            }
+            preprocessedSubmesh.vec4Attributes.at(j) = vec4AttributeValues;
+        }
+
+        if (useProgrammableFetch && programmableFetchUseAoS) {
+            if (meshAttribute.name == "vertexPosition") {
+                const glm::vec3 *attributeValues = (const glm::vec3*)meshAttribute.data;
+                size_t numAttributeValues = meshAttribute.dataSize / sizeof(glm::vec3);
+                vertexPositionData.reserve(numAttributeValues);
+                for (size_t i = 0; i < numAttributeValues; i++) {
+                    vertexPositionData.push_back(attributeValues[i]);
+                }
+            } else if (meshAttribute.name == "vertexLineTangent") {
+                const glm::vec3 *attributeValues = (const glm::vec3*)meshAttribute.data;
+                size_t numAttributeValues = meshAttribute.dataSize / sizeof(glm::vec3);
+                vertexTangentData.reserve(numAttributeValues);
+                for (size_t i = 0; i < numAttributeValues; i++) {
+                    vertexTangentData.push_back(attributeValues[i]);
+                }
+            }
+        }
+
+        if (meshAttribute.name == "vertexPosition" && meshAttribute.dataSize > 0) {
+            std::vector<glm::vec3> vertices;
+            vertices.resize(meshAttribute.dataSize / sizeof(glm::vec3));
+            memcpy(&vertices.front(), meshAttribute.data, meshAttribute.dataSize);
+            preprocessedSubmesh.hasBoundingBox = true;
+            preprocessedSubmesh.boundingBox = computeAABB(vertices);
+        }
+    }
+
+    if (useProgrammableFetch && programmableFetchUseAoS) {
+        for (size_t attributeIndex = 0; attributeIndex < vertexAttributeData.size(); attributeIndex++) {
+            std::vector<LinePointData> linePointData;
+            linePointData.resize(vertexPositionData.size());
+
+            for (size_t i = 0; i < vertexPositionData.size(); i++) {
+                linePointData.at(i).vertexPosition = vertexPositionData.at(i);
+                linePointData.at(i).vertexAttribute = vertexAttributeData.at(attributeIndex).at(i);
+                linePointData.at(i).vertexTangent = vertexTangentData.at(i);
+                linePointData.at(i).padding = 0.0f;
+            }
+
+            preprocessedSubmesh.linePointData.push_back(linePointData);
+        }
+    }
+}
+
+void packUnorm16ArrayReference(const std::vector<float> &floatVector, std::vector<uint16_t> &unormVector)
+{
+    float minValue = FLT_MAX;
+    float maxValue = -FLT_MAX;
+    #pragma omp parallel for reduction(min:minValue) reduction(max:maxValue)
+    for (size_t i = 0; i < floatVector.size(); i++) {
+        minValue = std::min(minValue, floatVector.at(i));
+        maxValue = std::max(maxValue, floatVector.at(i));
+    }
+
+    unormVector.resize(floatVector.size());
+    #pragma omp parallel for
+    for (size_t i = 0; i < unormVector.size(); i++) {
+        unormVector.at(i) = glm::round(glm::clamp((floatVector.at(i) - minValue) / (maxValue - minValue),
+                                                  0.0f, 1.0f) * 65535.0f);
+    }
+}
+
+void unpackUnorm16ArrayReference(const uint16_t *unormVector, size_t vectorSize, std::vector<float> &floatVector)
+{
+    floatVector.resize(vectorSize);
+    #pragma omp parallel for
+    for (size_t i = 0; i < vectorSize; i++) {
+        floatVector.at(i) = unormVector[i]/65535.0;
+    }
+}
+
+void computeImportanceCriterionReference(
+        ImportanceCriterionKernel kernel, ArrayView<const glm::vec3> linePositions,
+        ArrayView<const float> lineAttributes, float *values)
+{
+    std::vector<glm::vec3> vertexPositions = linePositions.toVector();
+    std::vector<float> vertexAttributes = lineAttributes.toVector();
+    std::vector<float> criterion;
+    if (kernel == IMPORTANCE_CRITERION_KERNEL_ATTRIBUTE) {
+        criterion = vertexAttributes;
+    } else if (kernel == IMPORTANCE_CRITERION_KERNEL_CURVATURE) {
+        criterion = computeCurvature(vertexPositions);
+    } else if (kernel == IMPORTANCE_CRITERION_KERNEL_SEGMENT_LENGTH) {
+        criterion = computeSegmentLengths(vertexPositions);
+    }
+    std::copy(criterion.begin(), criterion.end(), values);
+}
+
+TrajectorySet loadTrajectorySetFromObjReference(const std::string &filename, TrajectoryType trajectoryType)
+{
+    bool isConvectionRolls = trajectoryType == TRAJECTORY_TYPE_CONVECTION_ROLLS_NEW;
+    TrajectorySet trajectories;
+    trajectories.clear(1);
+
+    std::vector<glm::vec3> globalLineVertices;
+    std::vector<float> globalLineVertexAttributes;
+
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (!file) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in loadTrajectorySetFromObjReference: File \""
+                + filename + "\" does not exist.");
+        return trajectories;
+    }
+    fseek(file, 0, SEEK_END);
+    size_t length = size_t(ftell(file));
+    fseek(file, 0, SEEK_SET);
+    std::vector<char> fileBuffer(length);
+    if (length > 0 && fread(fileBuffer.data(), 1, length, file) != length) {
+        fileBuffer.clear();
+    }
+    fclose(file);
+    length = fileBuffer.size();
+    std::string lineBuffer;
+    std::string numberString;
+
+    for (size_t charPtr = 0; charPtr < length; ) {
+        while (charPtr < length) {
+            char currentChar = fileBuffer[charPtr];
+            if (currentChar == '\n' || currentChar == '\r') {
+                charPtr++;
+                break;
+            }
+            lineBuffer.push_back(currentChar);
+            charPtr++;
+        }
+
+        if (lineBuffer.size() == 0) {
+            continue;
+        }
+
+        char command = lineBuffer.at(0);
+        char command2 = ' ';
+        if (lineBuffer.size() > 1) {
+            command2 = lineBuffer.at(1);
+        }
+        const char *arguments = lineBuffer.c_str() + std::min(lineBuffer.size(), size_t(2));
+
+        if (command == 'v' && command2 == 't') {
+            // Path line vertex attribute
+            float attr = 0.0f;
+            sscanf(arguments, "%f", &attr);
+            globalLineVertexAttributes.push_back(attr);
+        } else if (command == 'v' && command2 != 'n') {
+            // Path line vertex position
+            glm::vec3 position(0.0f);
+            if (isConvectionRolls) {
+                sscanf(arguments, "%f %f %f", &position.x, &position.z, &position.y);
+            } else {
+                sscanf(arguments, "%f %f %f", &position.x, &position.y, &position.z);
+            }
+            globalLineVertices.push_back(position);
+        } else if (command == 'l') {
+            // Get indices of current path line
+            std::vector<uint32_t> currentLineIndices;
+            for (size_t linePtr = 2; linePtr < lineBuffer.size(); linePtr++) {
+                char currentChar = lineBuffer.at(linePtr);
+                bool isWhitespace = currentChar == ' ' || currentChar == '\t';
+                if (isWhitespace && numberString.size() != 0) {
+                    currentLineIndices.push_back(atoi(numberString.c_str()) - 1);
+                    numberString.clear();
+                } else if (!isWhitespace) {
+                    numberString.push_back(currentChar);
+                }
+            }
+            if (numberString.size() != 0) {
+                currentLineIndices.push_back(atoi(numberString.c_str()) - 1);
+                numberString.clear();
+            }
+
+            Trajectory trajectory;
+            trajectory.attributes.resize(1);
+            for (size_t i = 0; i < currentLineIndices.size(); i++) {
+                uint32_t vertexIndex = currentLineIndices.at(i);
+                if (vertexIndex >= globalLineVertices.size() || vertexIndex >= globalLineVertexAttributes.size()) {
+                    continue;
+                }
+                glm::vec3 pos = globalLineVertices.at(vertexIndex);
+
+                // Remove invalid line points (used in many scientific datasets to indicate invalid lines).
+                const float MAX_VAL = 1e10f;
+                if (std::fabs(pos.x) > MAX_VAL || std::fabs(pos.y) > MAX_VAL || std::fabs(pos.z) > MAX_VAL) {
+                    continue;
+                }
+
+                trajectory.positions.push_back(pos);
+                trajectory.attributes.at(0).push_back(globalLineVertexAttributes.at(vertexIndex));
+            }
+            trajectories.addTrajectory(trajectory);
+        }
+
+        lineBuffer.clear();
+    }
+
+    computeTrajectoryAttributes(trajectoryType, trajectories);
+    return trajectories;
+}
+
+TrajectorySet loadNetCdfFileReference(const std::string &filename)
+{
+    int ncid;
+    if (nc_open(filename.c_str(), NC_NOWRITE, &ncid) != NC_NOERR) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in loadNetCdfFileReference: File \"" + filename
+                + "\" couldn't be opened.");
+        return TrajectorySet();
+    }
+
+    int timeDimId, trajectoryDimId, latVarId, lonVarId, pressureVarId;
+    size_t timeDim = 0, trajectoryDim = 0;
+    bool success = nc_inq_dimid(ncid, "time", &timeDimId) == NC_NOERR
+            && nc_inq_dimlen(ncid, timeDimId, &timeDim) == NC_NOERR
+            && nc_inq_dimid(ncid, "trajectory", &trajectoryDimId) == NC_NOERR
+            && nc_inq_dimlen(ncid, trajectoryDimId, &trajectoryDim) == NC_NOERR
+            && nc_inq_varid(ncid, "lat", &latVarId) == NC_NOERR && nc_inq_varid(ncid, "lon", &lonVarId) == NC_NOERR
+            && nc_inq_varid(ncid, "pressure", &pressureVarId) == NC_NOERR;
+    std::vector<float> lat(trajectoryDim * timeDim), lon(trajectoryDim * timeDim), pressure(trajectoryDim * timeDim);
+    size_t startp[] = {0, 0, 0};
+    size_t countp[] = {1, trajectoryDim, timeDim};
+    success = success && nc_get_vara_float(ncid, latVarId, startp, countp, lat.data()) == NC_NOERR
+            && nc_get_vara_float(ncid, lonVarId, startp, countp, lon.data()) == NC_NOERR
+            && nc_get_vara_float(ncid, pressureVarId, startp, countp, pressure.data()) == NC_NOERR;
+    nc_close(ncid);
+    if (!success) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in loadNetCdfFileReference: Could not load file \""
+                + filename + "\".");
+        return TrajectorySet();
+    }
+
+    // convertLatLonToCartesian
+    float minPressure = FLT_MAX;
+    float maxPressure = -FLT_MAX;
+    for (size_t idx = 0; idx < trajectoryDim*timeDim; idx++) {
+        if (pressure[idx] > 0.0f) {
+            minPressure = std::min(minPressure, pressure[idx]);
+        }
+        maxPressure = std::max(maxPressure, pressure[idx]);
+    }
+    float logMinPressure = log(minPressure);
+    float logMaxPressure = log(maxPressure);
+
+    Trajectories trajectories;
+    for (size_t trajectoryIndex = 0; trajectoryIndex < trajectoryDim; trajectoryIndex++) {
+        Trajectory trajectory;
+        trajectory.attributes.resize(1);
+        std::vector<glm::vec3> &cartesianCoords = trajectory.positions;
+        std::vector<float> &pressureAttr = trajectory.attributes.at(0);
+        for (size_t i = 0; i < timeDim; i++) {
+            size_t index = i + trajectoryIndex*timeDim;
+            float pressureAtIdx = pressure[index];
+            if (pressureAtIdx <= 0.0f) {
+                continue;
+            }
+            float normalizedLogPressure = (log(pressureAtIdx) - logMaxPressure) / (logMinPressure - logMaxPressure);
+            cartesianCoords.push_back(glm::vec3(lat[index]/100.0f, normalizedLogPressure, lon[index]/100.0f));
+            pressureAttr.push_back(pressureAtIdx);
+        }
+
+        if (!trajectory.positions.empty()) {
+            trajectories.push_back(trajectory);
+        }
+    }
+    return TrajectorySet::fromTrajectories(trajectories);
+}
+
+
+/*
+ * Serial port of DiscretizeLines.glsl.
+ */
+struct VoxelizationReferenceState
+{
+    glm::ivec3 gridResolution, quantizationResolution;
+    unsigned int maxNumLinesPerVoxel;
+    std::vector<uint32_t> numSegments;
+    std::vector<std::vector<LineSegmentCompressed>> lineSegments;
+};
+
+static bool rayBoxPlaneIntersectionReference(float rayOriginX, float rayDirectionX, float lowerX, float upperX,
+        float &tNear, float &tFar)
+{
+    if (std::abs(rayDirectionX) < 0.001f) {
+        // Ray is parallel to the x planes
+        if (rayOriginX < lowerX || rayOriginX > upperX) {
+            return false;
+        }
+    } else {
+        // Not parallel to the x planes. Compute the intersection distance to the planes.
+        float t0 = (lowerX - rayOriginX) / rayDirectionX;
+        float t1 = (upperX - rayOriginX) / rayDirectionX;
+        if (t0 > t1) {
+            std::swap(t0, t1);
+        }
+        if (t0 > tNear) {
+            tNear = t0;
+        }
+        if (t1 < tFar) {
+            tFar = t1;
+        }
+        if (tNear > tFar || tFar < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int rayBoxIntersectionReference(const glm::vec3 &rayOrigin, const glm::vec3 &rayDirection,
+        const glm::vec3 &lower, const glm::vec3 &upper, float &tNear, float &tFar)
+{
+    tNear = -1e7f;
+    tFar = 1e7f;
+    for (int i = 0; i < 3; i++) {
+        if (!rayBoxPlaneIntersectionReference(rayOrigin[i], rayDirection[i], lower[i], upper[i], tNear, tFar)) {
+            return 0;
+        }
+    }
+    return (tNear >= 0.0f && tNear <= 1.0f ? 1 : 0) + (tFar >= 0.0f && tFar <= 1.0f ? 1 : 0);
+}
+
+static uint32_t quantizePointReference(const glm::vec3 &v, int faceIndex, const glm::ivec3 &quantizationResolution)
+{
+    // Dimensions spanning the x, y or z face.
+    int dimension0 = faceIndex <= 1 ? 1 : 0;
+    int dimension1 = faceIndex <= 3 ? 2 : 1;
+    int qv0 = glm::clamp(int(std::floor(v[dimension0] * quantizationResolution[dimension0])),
+            0, quantizationResolution[dimension0] - 1);
+    int qv1 = glm::clamp(int(std::floor(v[dimension1] * quantizationResolution[dimension1])),
+            0, quantizationResolution[dimension1] - 1);
+    return uint32_t(qv0 + qv1 * quantizationResolution.x);
+}
+
+static int computeFaceIndexReference(const glm::vec3 &v, const glm::ivec3 &voxelIndex)
+{
+    for (int i = 0; i < 3; i++) {
+        if (std::abs(v[i] - float(voxelIndex[i])) < 0.00001f) {
+            return 2*i;
+        }
+        if (std::abs(v[i] - float(voxelIndex[i] + 1)) < 0.00001f) {
+            return 2*i+1;
+        }
+    }
+    return 0;
+}
+
+static void addLineSegmentReference(const glm::ivec3 &voxelIndex, const LineSegment &lineSegment,
+        VoxelizationReferenceState &state)
+{
+    // compressLineSegment
+    int faceIndex1 = computeFaceIndexReference(lineSegment.v1, voxelIndex);
+    int faceIndex2 = computeFaceIndexReference(lineSegment.v2, voxelIndex);
+    uint32_t facePositionQuantized1 = quantizePointReference(
+            lineSegment.v1 - glm::vec3(voxelIndex), faceIndex1, state.quantizationResolution);
+    uint32_t facePositionQuantized2 = quantizePointReference(
+            lineSegment.v2 - glm::vec3(voxelIndex), faceIndex2, state.quantizationResolution);
+    uint32_t attr1Unorm = uint32_t(glm::clamp(std::round(lineSegment.a1*255.0f), 0.0f, 255.0f));
+    uint32_t attr2Unorm = uint32_t(glm::clamp(std::round(lineSegment.a2*255.0f), 0.0f, 255.0f));
+    int c = 0;
+    for (int x = state.quantizationResolution.x; x > 1; x /= 2) {
+        c += 2;
+    }
+    LineSegmentCompressed lineSegmentCompressed;
+    lineSegmentCompressed.linePosition = uint32_t(faceIndex1) | uint32_t(faceIndex2) << 3
+            | facePositionQuantized1 << 6 | facePositionQuantized2 << (6 + c);
+    lineSegmentCompressed.attributes = 0;
+    if (c > 12) {
+        lineSegmentCompressed.attributes |= facePositionQuantized2 >> (c - (6 + 2*c - 32));
+    }
+    lineSegmentCompressed.attributes |= (lineSegment.lineID & 31u) << 11 | attr1Unorm << 16 | attr2Unorm << 24;
+
+    // The slots of the voxel are assigned by an atomic counter.
+    uint32_t voxelIndex1D = uint32_t(voxelIndex.x + voxelIndex.y*state.gridResolution.x
+            + voxelIndex.z*state.gridResolution.x*state.gridResolution.y);
+    uint32_t segmentPosition = state.numSegments.at(voxelIndex1D)++;
+    if (segmentPosition < state.maxNumLinesPerVoxel) {
+        state.lineSegments.at(voxelIndex1D).push_back(lineSegmentCompressed);
+    } else {
+        state.numSegments.at(voxelIndex1D) = state.maxNumLinesPerVoxel;
+    }
+}
+
+static void traverseVoxelGridReference(uint32_t lineID, const glm::vec3 &startPoint, float startAttribute,
+        const glm::vec3 &endPoint, float endAttribute, glm::ivec3 &currentVoxel, int &currentVoxelNumIntersections,
+        glm::vec3 &currentVoxelIntersection, float &currentVoxelIntersectionAttribute, bool &noIntersectionForLineYet,
+        VoxelizationReferenceState &state)
+{
+    glm::ivec3 endVoxel = glm::ivec3(endPoint);
+    glm::ivec3 step, voxelIndex;
+    glm::vec3 tMax, tDelta;
+    for (int i = 0; i < 3; i++) {
+        step[i] = int(glm::sign(endPoint[i] - startPoint[i]));
+        tDelta[i] = step[i] != 0 ? std::min(float(step[i]) / (endPoint[i] - startPoint[i]), 1e7f) : 1e7f;
+        tMax[i] = step[i] > 0 ? tDelta[i] * (1.0f - glm::fract(startPoint[i])) : tDelta[i] * glm::fract(startPoint[i]);
+        voxelIndex[i] = int(startPoint[i]);
+    }
+    if (step == glm::ivec3(0)) {
+        return;
+    }
+
+    glm::vec3 rayDirection = endPoint - startPoint;
+    LineSegment lineSegment;
+    while (glm::all(glm::greaterThanEqual(voxelIndex, glm::ivec3(0)))
+            && glm::all(glm::lessThan(voxelIndex, state.gridResolution))) {
+        float tNear, tFar;
+        int numIntersectionsNew = rayBoxIntersectionReference(startPoint, rayDirection,
+                glm::vec3(voxelIndex), glm::vec3(voxelIndex) + glm::vec3(1.0f), tNear, tFar);
+
+        if (numIntersectionsNew > 0 && noIntersectionForLineYet) {
+            noIntersectionForLineYet = false;
+            continue;
+        }
+
+        if (numIntersectionsNew == 2 || (numIntersectionsNew == 1 && currentVoxelNumIntersections == 1
+                && currentVoxel == voxelIndex)) {
+            lineSegment.lineID = lineID;
+            if (numIntersectionsNew == 2) {
+                lineSegment.v1 = startPoint + tNear * (endPoint - startPoint);
+                lineSegment.a1 = startAttribute + tNear * (endAttribute - startAttribute);
+            } else {
+                lineSegment.v1 = currentVoxelIntersection;
+                lineSegment.a1 = currentVoxelIntersectionAttribute;
+            }
+            lineSegment.v2 = startPoint + tFar * (endPoint - startPoint);
+            lineSegment.a2 = startAttribute + tFar * (endAttribute - startAttribute);
+            addLineSegmentReference(voxelIndex, lineSegment, state);
+            currentVoxelNumIntersections = 0;
+        } else if (numIntersectionsNew == 1) {
+            currentVoxel = voxelIndex;
+            currentVoxelIntersection = startPoint + tNear * (endPoint - startPoint);
+            currentVoxelIntersectionAttribute = startAttribute + tNear * (endAttribute - startAttribute);
+            currentVoxelNumIntersections = 1;
+        }
+
+        if (voxelIndex == endVoxel) {
+            break;
+        }
+
+        if (tMax.x < tMax.y) {
+            if (tMax.x < tMax.z) {
+                voxelIndex.x += step.x;
+                tMax.x += tDelta.x;
+            } else {
+                voxelIndex.z += step.z;
+                tMax.z += tDelta.z;
+            }
+        } else {
+            if (tMax.y < tMax.z) {
+                voxelIndex.y += step.y;
+                tMax.y += tDelta.y;
+            } else {
+                voxelIndex.z += step.z;
+                tMax.z += tDelta.z;
+            }
+        }
+    }
+}
+
+/// Port of decompressLine in VoxelData.glsl.
+static LineSegment decompressLineReference(const glm::vec3 &voxelPosition, const LineSegmentCompressed &compressedLine,
+        const glm::ivec3 &quantizationResolution)
+{
+    uint32_t c = 0;
+    for (int x = quantizationResolution.x; x > 1; x /= 2) {
+        c += 2;
+    }
+    const uint32_t bitmaskQuantizedPos = uint32_t(quantizationResolution.x*quantizationResolution.x - 1);
+    uint32_t faceIndices[2] = { compressedLine.linePosition & 0x7u, (compressedLine.linePosition >> 3) & 0x7u };
+    uint32_t quantizedPos1D[2] = {
+            (compressedLine.linePosition >> 6) & bitmaskQuantizedPos,
+            (compressedLine.linePosition >> (6 + c)) & bitmaskQuantizedPos };
+    if (c > 12) {
+        quantizedPos1D[1] |= (compressedLine.attributes << (c - (6 + 2*c - 32))) & bitmaskQuantizedPos;
+    }
+
+    glm::vec3 points[2];
+    for (int i = 0; i < 2; i++) {
+        // getQuantizedPositionOffset
+        glm::vec2 quantizedFacePosition = glm::vec2(
+                float(quantizedPos1D[i] % uint32_t(quantizationResolution.x)),
+                float(quantizedPos1D[i] / uint32_t(quantizationResolution.x))) / float(quantizationResolution.x);
+        float face0or1 = float(faceIndices[i] % 2);
+        glm::vec3 offset;
+        if (faceIndices[i] <= 1) {
+            offset = glm::vec3(face0or1, quantizedFacePosition.x, quantizedFacePosition.y);
+        } else if (faceIndices[i] <= 3) {
+            offset = glm::vec3(quantizedFacePosition.x, face0or1, quantizedFacePosition.y);
+        } else {
+            offset = glm::vec3(quantizedFacePosition.x, quantizedFacePosition.y, face0or1);
+        }
+        points[i] = voxelPosition + offset;
+    }
+
+    LineSegment decompressedLine;
+    decompressedLine.v1 = points[0];
+    decompressedLine.v2 = points[1];
+    decompressedLine.a1 = float((compressedLine.attributes >> 16) & 0xFFu) / 255.0f;
+    decompressedLine.a2 = float((compressedLine.attributes >> 24) & 0xFFu) / 255.0f;
+    decompressedLine.lineID = (compressedLine.attributes >> 11) & 31u;
+    return decompressedLine;
+}
+
+VoxelGridDataCompressed createVoxelGridReference(const std::vector<Curve> &curves, const glm::ivec3 &gridResolution,
+        const glm::ivec3 &quantizationResolution, unsigned int maxNumLinesPerVoxel)
+{
+    const uint32_t gridSize1D = uint32_t(gridResolution.x * gridResolution.y * gridResolution.z);
+    VoxelizationReferenceState state;
+    state.gridResolution = gridResolution;
+    state.quantizationResolution = quantizationResolution;
+    state.maxNumLinesPerVoxel = maxNumLinesPerVoxel;
+    state.numSegments.resize(gridSize1D, 0);
+    state.lineSegments.resize(gridSize1D);
+
+    // DiscretizeLines.glsl, one invocation per line.
+    for (size_t lineNumber = 0; lineNumber < curves.size(); lineNumber++) {
+        const std::vector<glm::vec3> &linePoints = curves.at(lineNumber).points;
+        const std::vector<float> &lineAttributes = curves.at(lineNumber).attributes;
+        glm::ivec3 currentVoxel(-1, -1, -1);
+        int currentVoxelNumIntersections = 0;
+        glm::vec3 currentVoxelIntersection(1e6f, 1e6f, 1e6f);
+        float currentVoxelIntersectionAttribute = 0.0f;
+        bool noIntersectionForLineYet = true;
+        for (size_t i = 0; i + 1 < linePoints.size(); i++) {
+            const glm::vec3 &p1 = linePoints.at(i);
+            const glm::vec3 &p2 = linePoints.at(i + 1);
+            const float MAX_VAL = 1e10f;
+            if (std::abs(p1.x) > MAX_VAL || std::abs(p1.y) > MAX_VAL || std::abs(p1.z) > MAX_VAL
+                    || std::abs(p2.x) > MAX_VAL || std::abs(p2.y) > MAX_VAL || std::abs(p2.z) > MAX_VAL) {
+                continue;
+            }
+            if (glm::length(p2 - p1) < 0.0001f) {
+                continue;
+            }
+            traverseVoxelGridReference(uint32_t(lineNumber), p1, lineAttributes.at(i), p2, lineAttributes.at(i + 1),
+                    currentVoxel, currentVoxelNumIntersections, currentVoxelIntersection,
+                    currentVoxelIntersectionAttribute, noIntersectionForLineYet, state);
+        }
+    }
+
+    // Reduction of the buffers (prefix sum over the number of segments per voxel).
+    VoxelGridDataCompressed data;
+    data.gridResolution = gridResolution;
+    data.quantizationResolution = quantizationResolution;
+    data.dataType = 0;
+    data.voxelLineListOffsets.resize(gridSize1D);
+    data.numLinesInVoxel.resize(gridSize1D);
+    for (uint32_t i = 0; i < gridSize1D; i++) {
+        data.voxelLineListOffsets.at(i) = uint32_t(data.lineSegments.size());
+        data.numLinesInVoxel.at(i) = std::min(state.numSegments.at(i), uint32_t(maxNumLinesPerVoxel));
+        data.lineSegments.insert(data.lineSegments.end(), state.lineSegments.at(i).begin(),
+                state.lineSegments.at(i).end());
+    }
+
+    // ComputeDensity.glsl
+    data.voxelDensities.resize(gridSize1D);
+    for (uint32_t i = 0; i < gridSize1D; i++) {
+        glm::vec3 voxelPosition(i % gridResolution.x, (i / gridResolution.x) % gridResolution.y,
+                i / (gridResolution.x * gridResolution.y));
+        float density = 0.0f;
+        for (uint32_t j = 0; j < data.numLinesInVoxel.at(i); j++) {
+            LineSegment lineSegment = decompressLineReference(
+                    voxelPosition, state.lineSegments.at(i).at(j), quantizationResolution);
+            float lineLength = glm::length(lineSegment.v2 - lineSegment.v1);
+            density += lineLength * (opacityMapping(lineSegment.a1, 1.0f) + opacityMapping(lineSegment.a2, 1.0f))
+                    / 2.0f;
+        }
+        data.voxelDensities.at(i) = density;
+    }
+
+    data.voxelAOFactors.resize(gridSize1D);
+    generateVoxelAOFactorsFromDensity(data.voxelDensities, data.voxelAOFactors, gridResolution, false);
+    return data;
+}
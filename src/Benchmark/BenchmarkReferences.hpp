@@ -0,0 +1,75 @@
+#ifndef PIXELSYNCOIT_BENCHMARKREFERENCES_HPP
+#define PIXELSYNCOIT_BENCHMARKREFERENCES_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "Utils/MeshSerializer.hpp"
+#include "Utils/MeshPreprocessing.hpp"
+#include "Utils/ImportanceCriteria.hpp"
+#include "Utils/TrajectorySet.hpp"
+#include "VoxelRaytracing/VoxelData.hpp"
+
+/*
+ * The previous implementations of optimized parts of the data pipeline. They are the baselines of the benchmark stages
+ * and the references of the validation checks (see BenchmarkValidation.hpp).
+ */
+
+/**
+ * The writeMesh3D used before BinaryMeshStreamWriter. The mesh is serialized sequentially to memory using
+ * sgl::BinaryWriteStream and written as a format version 4 file (meshlets are not supported by the format).
+ * @return False if the file couldn't be written.
+ */
+bool writeMesh3DVersion4Reference(const std::string &filename, const BinaryMesh &mesh);
+
+/**
+ * The computeNormals used before the vertex-triangle adjacency (see MeshAdjacency.hpp). The triangles of each vertex
+ * are collected in a vector per vertex (serially, the original parallel loop was a data race), and the ring-1
+ * neighbors are collected per vertex in newly allocated vectors with std::find. The fixes of the sine of the edge
+ * angles and of vertices without neighbors are applied, i.e., the results are bitwise equal to computeNormals.
+ */
+void computeNormalsReference(const std::vector<glm::vec3> &vertices, const std::vector<uint32_t> &indices,
+        std::vector<glm::vec3> &normals, std::vector<float> &attributes);
+
+/// The serial multi-pass preprocessing parseMesh3D used before preprocessSubmesh.
+void preprocessSubmeshReference(const BinarySubMeshView &submesh, const MeshPreprocessingSettings &settings,
+        PreprocessedSubmesh &preprocessedSubmesh);
+
+/// The implementations of packUnorm16Array and unpackUnorm16Array before the unorm16 kernels (see Unorm16.hpp).
+void packUnorm16ArrayReference(const std::vector<float> &floatVector, std::vector<uint16_t> &unormVector);
+void unpackUnorm16ArrayReference(const uint16_t *unormVector, size_t vectorSize, std::vector<float> &floatVector);
+
+/**
+ * The per-line implementation the importance criterion kernels replaced (e.g. computeCurvature with its checked element
+ * accesses), see computeImportanceCriterion.
+ */
+void computeImportanceCriterionReference(
+        ImportanceCriterionKernel kernel, ArrayView<const glm::vec3> linePositions,
+        ArrayView<const float> lineAttributes, float *values);
+
+/**
+ * The serial .obj line loader used before the chunked loadTrajectorySetFromObj. It reads the file line by line into
+ * std::string objects and parses the records with sscanf and atoi. Unlike the original loader, line indices of missing
+ * vertices are skipped instead of throwing std::out_of_range.
+ */
+TrajectorySet loadTrajectorySetFromObjReference(const std::string &filename, TrajectoryType trajectoryType);
+
+/**
+ * The loadNetCdfFile used before loadNetCdfFileChunked. It reads lat, lon and pressure of all trajectories at once and
+ * converts them serially to Cartesian coordinates. Returns an empty set if the file couldn't be opened.
+ */
+TrajectorySet loadNetCdfFileReference(const std::string &filename);
+
+/**
+ * A serial emulation of the GPU voxelization (DiscretizeLines.glsl, ComputeDensity.glsl and decompressLine in
+ * VoxelData.glsl) for lines in voxel grid space. The invocations of DiscretizeLines.glsl are executed in line order,
+ * i.e., the segments of a voxel are stored in the order of the atomic counter of this one valid GPU schedule.
+ * Unlike ComputeDensity.glsl, the density sums up min(numSegments, maxNumLinesPerVoxel) segments (the shader uses max)
+ * and uses opacityMapping instead of the linearly filtered transfer function texture.
+ * The AO factors are computed with generateVoxelAOFactorsFromDensity like after the GPU density pass.
+ */
+VoxelGridDataCompressed createVoxelGridReference(const std::vector<Curve> &curves, const glm::ivec3 &gridResolution,
+        const glm::ivec3 &quantizationResolution, unsigned int maxNumLinesPerVoxel);
+
+#endif //PIXELSYNCOIT_BENCHMARKREFERENCES_HPP
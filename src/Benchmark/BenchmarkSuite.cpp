@@ -0,0 +1,237 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <Utils/File/Logfile.hpp>
+
+#include "Performance/CsvWriter.hpp"
+#include "Performance/FrameTimeStatistics.hpp"
+#include "BenchmarkSuite.hpp"
+
+static std::string escapeJsonString(const std::string &s)
+{
+    std::string escaped;
+    escaped.reserve(s.size() + 2);
+    for (char c : s) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20u) {
+                    char buffer[8];
+                    snprintf(buffer, sizeof(buffer), "\\u%04x", (unsigned int)(unsigned char)c);
+                    escaped += buffer;
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return "\"" + escaped + "\"";
+}
+
+/// JSON has no representation for infinity or NaN (e.g. the PSNR of identical images).
+static std::string jsonNumber(double value)
+{
+    if (!std::isfinite(value)) {
+        return "null";
+    }
+    std::ostringstream stream;
+    stream.precision(9);
+    stream << value;
+    return stream.str();
+}
+
+BenchmarkSuite::BenchmarkSuite(int numRepetitions) : numRepetitions(std::max(numRepetitions, 1))
+{
+}
+
+bool BenchmarkSuite::runStage(const std::string &stage, const std::string &dataset, int numThreads,
+        const std::function<bool()> &stageFunction, const std::function<void()> &setupFunction)
+{
+    sgl::Logfile::get()->writeInfo(std::string() + "Benchmark: Running stage \"" + stage + "\" on \"" + dataset
+            + "\" with " + std::to_string(numThreads) + " thread(s)...");
+    for (int repetition = 0; repetition < numRepetitions; repetition++) {
+        if (setupFunction) {
+            setupFunction();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        bool success = stageFunction();
+        auto end = std::chrono::steady_clock::now();
+        if (!success) {
+            sgl::Logfile::get()->writeError(std::string() + "Error in BenchmarkSuite::runStage: Stage \"" + stage
+                    + "\" failed on \"" + dataset + "\".");
+            return false;
+        }
+
+        BenchmarkSample sample;
+        sample.stage = stage;
+        sample.dataset = dataset;
+        sample.numThreads = numThreads;
+        sample.repetition = repetition;
+        sample.timeMS = std::chrono::duration<double, std::milli>(end - start).count();
+        samples.push_back(sample);
+    }
+    return true;
+}
+
+void BenchmarkSuite::setCounter(
+        const std::string &stage, const std::string &dataset, const std::string &name, double value)
+{
+    for (BenchmarkCounter &counter : counters) {
+        if (counter.stage == stage && counter.dataset == dataset && counter.name == name) {
+            counter.value = value;
+            return;
+        }
+    }
+    counters.push_back(BenchmarkCounter{stage, dataset, name, value});
+}
+
+void BenchmarkSuite::addValidationResult(const std::string &name, bool passed, const std::string &details)
+{
+    if (passed) {
+        sgl::Logfile::get()->writeInfo(std::string() + "Validation \"" + name + "\" passed: " + details);
+    } else {
+        sgl::Logfile::get()->writeError(std::string() + "Validation \"" + name + "\" FAILED: " + details);
+    }
+    validationResults.push_back(BenchmarkValidationResult{name, passed, details});
+}
+
+bool BenchmarkSuite::allValidationsPassed() const
+{
+    for (const BenchmarkValidationResult &result : validationResults) {
+        if (!result.passed) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BenchmarkSuite::writeJson(const std::string &filename, const std::vector<int> &threadCounts) const
+{
+    std::ofstream file(filename.c_str());
+    if (!file.is_open()) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in BenchmarkSuite::writeJson: Couldn't open file \""
+                + filename + "\".");
+        return false;
+    }
+
+    file << "{\n";
+    file << "  \"numRepetitions\": " << numRepetitions << ",\n";
+    file << "  \"numHardwareThreads\": " << std::thread::hardware_concurrency() << ",\n";
+    file << "  \"threadCounts\": [";
+    for (size_t i = 0; i < threadCounts.size(); i++) {
+        file << (i == 0 ? "" : ", ") << threadCounts.at(i);
+    }
+    file << "],\n";
+
+    // Group the samples by (stage, dataset, number of threads) in the order in which the stages were run.
+    file << "  \"stages\": [";
+    std::vector<bool> processed(samples.size(), false);
+    bool firstGroup = true;
+    for (size_t i = 0; i < samples.size(); i++) {
+        if (processed.at(i)) {
+            continue;
+        }
+        const BenchmarkSample &groupSample = samples.at(i);
+        std::vector<double> times;
+        for (size_t j = i; j < samples.size(); j++) {
+            const BenchmarkSample &sample = samples.at(j);
+            if (sample.stage == groupSample.stage && sample.dataset == groupSample.dataset
+                    && sample.numThreads == groupSample.numThreads) {
+                times.push_back(sample.timeMS);
+                processed.at(j) = true;
+            }
+        }
+
+        std::vector<double> sortedTimes = times;
+        std::sort(sortedTimes.begin(), sortedTimes.end());
+        double mean = 0.0;
+        for (double time : times) {
+            mean += time;
+        }
+        mean /= double(times.size());
+        double squaredDifferenceSum = 0.0;
+        for (double time : times) {
+            squaredDifferenceSum += (time - mean) * (time - mean);
+        }
+        double standardDeviation = times.size() > 1 ? std::sqrt(squaredDifferenceSum / double(times.size() - 1)) : 0.0;
+
+        file << (firstGroup ? "\n" : ",\n");
+        firstGroup = false;
+        file << "    {\n";
+        file << "      \"stage\": " << escapeJsonString(groupSample.stage) << ",\n";
+        file << "      \"dataset\": " << escapeJsonString(groupSample.dataset) << ",\n";
+        file << "      \"numThreads\": " << groupSample.numThreads << ",\n";
+        file << "      \"minMS\": " << jsonNumber(sortedTimes.front()) << ",\n";
+        file << "      \"medianMS\": " << jsonNumber(FrameTimeStatistics::computeQuantile(sortedTimes, 0.5)) << ",\n";
+        file << "      \"meanMS\": " << jsonNumber(mean) << ",\n";
+        file << "      \"maxMS\": " << jsonNumber(sortedTimes.back()) << ",\n";
+        file << "      \"standardDeviationMS\": " << jsonNumber(standardDeviation) << ",\n";
+        file << "      \"timesMS\": [";
+        for (size_t j = 0; j < times.size(); j++) {
+            file << (j == 0 ? "" : ", ") << jsonNumber(times.at(j));
+        }
+        file << "]\n";
+        file << "    }";
+    }
+    file << (firstGroup ? "],\n" : "\n  ],\n");
+
+    file << "  \"counters\": [";
+    for (size_t i = 0; i < counters.size(); i++) {
+        const BenchmarkCounter &counter = counters.at(i);
+        file << (i == 0 ? "\n" : ",\n");
+        file << "    {\"stage\": " << escapeJsonString(counter.stage)
+             << ", \"dataset\": " << escapeJsonString(counter.dataset)
+             << ", \"name\": " << escapeJsonString(counter.name)
+             << ", \"value\": " << jsonNumber(counter.value) << "}";
+    }
+    file << (counters.empty() ? "],\n" : "\n  ],\n");
+
+    file << "  \"validation\": [";
+    for (size_t i = 0; i < validationResults.size(); i++) {
+        const BenchmarkValidationResult &result = validationResults.at(i);
+        file << (i == 0 ? "\n" : ",\n");
+        file << "    {\"name\": " << escapeJsonString(result.name)
+             << ", \"passed\": " << (result.passed ? "true" : "false")
+             << ", \"details\": " << escapeJsonString(result.details) << "}";
+    }
+    file << (validationResults.empty() ? "]\n" : "\n  ]\n");
+    file << "}\n";
+
+    return file.good();
+}
+
+bool BenchmarkSuite::writeCsv(const std::string &filename) const
+{
+    CsvWriter writer;
+    if (!writer.open(filename)) {
+        return false;
+    }
+
+    writer.writeRow({"Stage", "Dataset", "Threads", "Repetition", "Time (ms)"});
+    for (const BenchmarkSample &sample : samples) {
+        writer.writeRow({sample.stage, sample.dataset, std::to_string(sample.numThreads),
+                         std::to_string(sample.repetition), jsonNumber(sample.timeMS)});
+    }
+    writer.close();
+    return true;
+}
+
+void BenchmarkSuite::setNumThreads(int numThreads)
+{
+#ifdef _OPENMP
+    omp_set_num_threads(std::max(numThreads, 1));
+#endif
+}
@@ -0,0 +1,74 @@
+#ifndef PIXELSYNCOIT_BENCHMARKSUITE_HPP
+#define PIXELSYNCOIT_BENCHMARKSUITE_HPP
+
+#include <string>
+#include <vector>
+#include <functional>
+
+/// The time of one repetition of a stage.
+struct BenchmarkSample
+{
+    std::string stage;
+    std::string dataset;
+    int numThreads;
+    int repetition;
+    double timeMS;
+};
+
+/// A value describing the size of the processed data of a stage (e.g. the number of points or bytes).
+struct BenchmarkCounter
+{
+    std::string stage;
+    std::string dataset;
+    std::string name;
+    double value;
+};
+
+struct BenchmarkValidationResult
+{
+    std::string name;
+    bool passed;
+    std::string details;
+};
+
+/**
+ * Times the stages of the data pipeline and collects the results of the validation checks.
+ * The samples are written as CSV (one row per repetition) and together with the per-stage summary (min, median,
+ * mean, max, standard deviation), the counters and the validation results as JSON.
+ */
+class BenchmarkSuite
+{
+public:
+    explicit BenchmarkSuite(int numRepetitions = 5);
+
+    /**
+     * Runs the stage function numRepetitions times and records the wall-clock time of each run.
+     * @param setupFunction If set, it is called before every repetition and is not included in the measured time.
+     * @return False if the stage function returned false in any repetition (the failed run is not recorded).
+     */
+    bool runStage(const std::string &stage, const std::string &dataset, int numThreads,
+            const std::function<bool()> &stageFunction, const std::function<void()> &setupFunction = nullptr);
+    /// Replaces the value of the counter if it was already added for this stage and dataset.
+    void setCounter(const std::string &stage, const std::string &dataset, const std::string &name, double value);
+    void addValidationResult(const std::string &name, bool passed, const std::string &details);
+
+    inline int getNumRepetitions() const { return numRepetitions; }
+    inline const std::vector<BenchmarkSample> &getSamples() const { return samples; }
+    inline const std::vector<BenchmarkValidationResult> &getValidationResults() const { return validationResults; }
+    bool allValidationsPassed() const;
+
+    /// @param threadCounts The swept thread counts (stored in the JSON file for reference).
+    bool writeJson(const std::string &filename, const std::vector<int> &threadCounts) const;
+    bool writeCsv(const std::string &filename) const;
+
+    /// Sets the number of OpenMP threads used by the following stages.
+    static void setNumThreads(int numThreads);
+
+private:
+    int numRepetitions;
+    std::vector<BenchmarkSample> samples;
+    std::vector<BenchmarkCounter> counters;
+    std::vector<BenchmarkValidationResult> validationResults;
+};
+
+#endif //PIXELSYNCOIT_BENCHMARKSUITE_HPP
@@ -0,0 +1,1901 @@
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <atomic>
+#include <thread>
+#include <utility>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Utils/ComputeNormals.hpp"
+#include "Utils/BinLinesFile.hpp"
+#include "Utils/Unorm16.hpp"
+#include "Utils/MeshPreprocessing.hpp"
+#include "Utils/RandomPermutation.hpp"
+#include "Utils/SpatialReordering.hpp"
+#include "Utils/Meshlets.hpp"
+#include "Utils/ConversionCache.hpp"
+#include "Utils/ParallelAlgorithms.hpp"
+#include "Utils/ImportanceCriteria.hpp"
+#include "Utils/TrajectoryFile.hpp"
+#include "Utils/TrajectoryLoader.hpp"
+#include "Utils/SyntheticDatasets.hpp"
+#include "Performance/FrameTimeStatistics.hpp"
+#include "BenchmarkReferences.hpp"
+#include "ValidationUtils.hpp"
+#include "BenchmarkValidation.hpp"
+
+void validateComputeNormals(BenchmarkSuite &suite, const std::vector<int> &threadCounts)
+{
+    // Height field y = f(x, z) on [0, 1]^2 triangulated such that all face normals point to +y.
+    const int GRID_SIZE = 256;
+    std::vector<glm::vec3> vertices;
+    std::vector<glm::vec3> analyticNormals;
+    std::vector<uint32_t> indices;
+    vertices.reserve(GRID_SIZE * GRID_SIZE);
+    for (int z = 0; z < GRID_SIZE; z++) {
+        for (int x = 0; x < GRID_SIZE; x++) {
+            float u = float(x) / float(GRID_SIZE - 1), v = float(z) / float(GRID_SIZE - 1);
+            float height = 0.1f * std::sin(6.0f * u) * std::cos(4.0f * v);
+            glm::vec3 gradient(0.6f * std::cos(6.0f * u) * std::cos(4.0f * v), 0.0f,
+                    -0.4f * std::sin(6.0f * u) * std::sin(4.0f * v));
+            vertices.push_back(glm::vec3(u, height, v));
+            analyticNormals.push_back(glm::normalize(glm::vec3(-gradient.x, 1.0f, -gradient.z)));
+        }
+    }
+    for (int z = 0; z < GRID_SIZE - 1; z++) {
+        for (int x = 0; x < GRID_SIZE - 1; x++) {
+            uint32_t i00 = uint32_t(z * GRID_SIZE + x), i10 = i00 + 1u;
+            uint32_t i01 = i00 + uint32_t(GRID_SIZE), i11 = i01 + 1u;
+            indices.insert(indices.end(), { i00, i10, i01, i10, i11, i01 });
+        }
+    }
+
+    bool passed = true;
+    double maxLengthError = 0.0, minCosine = 1.0;
+    std::vector<glm::vec3> firstNormals;
+    std::vector<float> firstCurvatures;
+    for (int numThreads : threadCounts) {
+        BenchmarkSuite::setNumThreads(numThreads);
+        std::vector<glm::vec3> normals;
+        std::vector<float> curvatures;
+        computeNormals(vertices, indices, normals, curvatures);
+
+        if (firstNormals.empty()) {
+            firstNormals = normals;
+            firstCurvatures = curvatures;
+            for (size_t i = 0; i < normals.size(); i++) {
+                maxLengthError = std::max(maxLengthError, std::abs(double(glm::length(normals[i])) - 1.0));
+                minCosine = std::min(minCosine, double(glm::dot(normals[i], analyticNormals[i])));
+            }
+        } else if (normals != firstNormals || curvatures != firstCurvatures) {
+            passed = false;
+        }
+    }
+    // The vertex normals are area-weighted averages of the face normals, i.e., only approximately analytic.
+    passed = passed && maxLengthError < 1e-5 && minCosine > 0.99;
+
+    // The height field and a fan, whose center is shared by more triangles than the linear search of the ring-1
+    // neighbors handles, give the same results as the previous implementation. The ring of the fan is numbered in a
+    // permuted order, i.e., the neighbors of the center aren't discovered in ascending order.
+    const int NUM_FAN_TRIANGLES = 100;
+    std::vector<glm::vec3> fanVertices(NUM_FAN_TRIANGLES + 1, glm::vec3(0.0f));
+    std::vector<uint32_t> fanIndices;
+    for (int k = 0; k < NUM_FAN_TRIANGLES; k++) {
+        float angle = 2.0f * float(M_PI) * float(k) / float(NUM_FAN_TRIANGLES);
+        uint32_t vID = uint32_t(k * 37 % NUM_FAN_TRIANGLES + 1);
+        uint32_t nextVID = uint32_t((k + 1) % NUM_FAN_TRIANGLES * 37 % NUM_FAN_TRIANGLES + 1);
+        fanVertices.at(vID) = glm::vec3(std::cos(angle), 0.1f * std::sin(5.0f * angle), std::sin(angle));
+        fanIndices.insert(fanIndices.end(), { 0u, vID, nextVID });
+    }
+    bool referenceEqual = true;
+    for (int meshIdx = 0; meshIdx < 2; meshIdx++) {
+        const std::vector<glm::vec3> &meshVertices = meshIdx == 0 ? vertices : fanVertices;
+        const std::vector<uint32_t> &meshIndices = meshIdx == 0 ? indices : fanIndices;
+        std::vector<glm::vec3> normals, referenceNormals;
+        std::vector<float> curvatures, referenceCurvatures;
+        computeNormals(meshVertices, meshIndices, normals, curvatures);
+        computeNormalsReference(meshVertices, meshIndices, referenceNormals, referenceCurvatures);
+        referenceEqual = referenceEqual && isBitwiseEqual(normals, referenceNormals)
+                && isBitwiseEqual(curvatures, referenceCurvatures);
+    }
+    passed = passed && referenceEqual;
+
+    suite.addValidationResult("computeNormals", passed, std::string() + "Height field with "
+            + std::to_string(vertices.size()) + " vertices, max. length error " + toStringPrecise(maxLengthError)
+            + ", min. cosine to analytic normal " + toStringPrecise(minCosine)
+            + ", fan with " + std::to_string(NUM_FAN_TRIANGLES) + " triangles compared to the previous implementation"
+            + (passed ? "" : ", results differ or deviate"));
+}
+
+
+void validateFrameTimeStatistics(BenchmarkSuite &suite, const std::vector<int> &threadCounts)
+{
+    // Exponentially decaying warm-up (shader compilation, caches) followed by stationary noise around 10 ms.
+    std::mt19937 generator(3);
+    std::normal_distribution<double> noise(0.0, 0.2);
+    std::vector<double> frameTimes;
+    for (int i = 0; i < 2000; i++) {
+        frameTimes.push_back(10.0 + 20.0 * std::exp(-double(i) / 10.0) + noise(generator));
+    }
+
+    bool passed = true;
+    FrameTimeSummary firstSummary;
+    size_t firstNumFrames = 0;
+    for (size_t t = 0; t < threadCounts.size(); t++) {
+        BenchmarkSuite::setNumThreads(threadCounts.at(t));
+        FrameTimeStatistics statistics;
+        size_t numFrames = 0;
+        for (double frameTime : frameTimes) {
+            statistics.addFrameTime(frameTime);
+            numFrames++;
+            if (statistics.hasConverged()) {
+                break;
+            }
+        }
+        FrameTimeSummary summary = statistics.computeSummary();
+        if (t == 0) {
+            firstSummary = summary;
+            firstNumFrames = numFrames;
+            // The warm-up ends when the window medians differ by less than 5%, i.e., some decay remains.
+            passed = statistics.hasConverged() && summary.numWarmUpFrames > 0
+                    && std::abs(summary.median - 10.0) < 0.2
+                    && summary.confidenceIntervalLower <= summary.median
+                    && summary.median <= summary.confidenceIntervalUpper;
+        } else if (numFrames != firstNumFrames || summary.median != firstSummary.median
+                || summary.confidenceIntervalLower != firstSummary.confidenceIntervalLower
+                || summary.confidenceIntervalUpper != firstSummary.confidenceIntervalUpper) {
+            passed = false;
+        }
+    }
+
+    suite.addValidationResult("FrameTimeStatistics", passed, std::string() + "Warm-up "
+            + std::to_string(firstSummary.numWarmUpFrames) + " frames, stopped after "
+            + std::to_string(firstNumFrames) + " frames, median " + toStringPrecise(firstSummary.median)
+            + " ms, CI [" + toStringPrecise(firstSummary.confidenceIntervalLower) + ", "
+            + toStringPrecise(firstSummary.confidenceIntervalUpper) + "]");
+}
+
+
+void validateBinLinesFile(BenchmarkSuite &suite, const std::vector<int> &threadCounts, const std::string &directory)
+{
+    // Random walks with varying lengths (including empty lines), such that lines span multiple compression blocks.
+    const size_t NUM_LINES = 300;
+    std::mt19937 generator(11);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> lengthDistribution(0, 400);
+    TrajectorySet trajectories;
+    trajectories.clear(2);
+    for (size_t lineIndex = 0; lineIndex < NUM_LINES; lineIndex++) {
+        Trajectory trajectory;
+        trajectory.attributes.resize(2);
+        glm::vec3 position(distribution(generator), distribution(generator), distribution(generator));
+        int numPoints = lineIndex % 50 == 7 ? 0 : lengthDistribution(generator);
+        for (int i = 0; i < numPoints; i++) {
+            position += 0.01f * glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+            trajectory.positions.push_back(position);
+            trajectory.attributes.at(0).push_back(float(i));
+            trajectory.attributes.at(1).push_back(100.0f * distribution(generator));
+        }
+        trajectories.addTrajectory(trajectory);
+    }
+
+    const std::string filenameVersion1 = directory + "validation_v1.binlines";
+    const std::string filenameVersion2 = directory + "validation_v2.binlines";
+    const std::string filenameCompressed = directory + "validation_v2_compressed.binlines";
+    BinLinesWriteSettings compressedSettings;
+    compressedSettings.compressed = true;
+    compressedSettings.blockSize = 1000;
+
+    // The first half of the lines is written in a separate call to test appending to a version 1 file.
+    TrajectorySet firstHalf, secondHalf;
+    for (size_t lineIndex = 0; lineIndex < NUM_LINES; lineIndex++) {
+        ArrayView<const float> attribute0 = trajectories.getAttribute(lineIndex, 0);
+        ArrayView<const float> attribute1 = trajectories.getAttribute(lineIndex, 1);
+        (lineIndex < NUM_LINES / 2 ? firstHalf : secondHalf).addTrajectory(
+                trajectories.getPositions(lineIndex), { attribute0, attribute1 });
+    }
+    BinLinesStreamWriter streamWriter;
+    bool passed = streamWriter.open(filenameVersion1) && streamWriter.writeTrajectories(firstHalf)
+            && streamWriter.writeTrajectories(secondHalf) && streamWriter.finish()
+            && convertBinLinesFileToVersion2(filenameVersion1, filenameVersion2)
+            && writeBinLinesFile(filenameCompressed, trajectories, { "index", "random" }, compressedSettings);
+
+    // Maximum error: Half a quantization step (plus the rounding of the dequantized value to float).
+    sgl::AABB3 boundingBox = trajectories.computeBoundingBox();
+    float maxExtent = glm::max(boundingBox.getDimensions().x,
+            glm::max(boundingBox.getDimensions().y, boundingBox.getDimensions().z));
+    double maxPositionError = 0.5 * maxExtent / double((1u << compressedSettings.positionQuantizationBits) - 1u)
+            + 2.0 * FLT_EPSILON;
+    double maxAttributeError = 0.5 / double((1u << compressedSettings.attributeQuantizationBits) - 1u)
+            + 2.0 * FLT_EPSILON;
+    float attributeRanges[2];
+    for (size_t attributeIndex = 0; attributeIndex < 2; attributeIndex++) {
+        float minValue = 0.0f, maxValue = 0.0f;
+        trajectories.computeAttributeRange(attributeIndex, minValue, maxValue);
+        attributeRanges[attributeIndex] = maxValue - minValue;
+    }
+
+    double maxPositionErrorCompressed = 0.0, maxAttributeErrorCompressed = 0.0;
+    TrajectorySet firstCompressed;
+    for (size_t t = 0; t < threadCounts.size() && passed; t++) {
+        BenchmarkSuite::setNumThreads(threadCounts.at(t));
+        TrajectorySet version1, version2, compressed;
+        passed = readBinLinesFile(filenameVersion1, version1) && readBinLinesFile(filenameVersion2, version2)
+                && readBinLinesFile(filenameCompressed, compressed);
+        passed = passed && isTrajectorySetEqual(version1, trajectories) && isTrajectorySetEqual(version2, trajectories)
+                && compressed.lineOffsets == trajectories.lineOffsets;
+        if (!passed) {
+            break;
+        }
+        if (t == 0) {
+            firstCompressed = compressed;
+            for (size_t i = 0; i < trajectories.getNumPoints(); i++) {
+                glm::vec3 diff = glm::abs(compressed.positions[i] - trajectories.positions[i]);
+                maxPositionErrorCompressed = std::max(maxPositionErrorCompressed,
+                        double(glm::max(diff.x, glm::max(diff.y, diff.z))));
+                for (size_t attributeIndex = 0; attributeIndex < 2; attributeIndex++) {
+                    float error = std::abs(compressed.attributes[attributeIndex][i]
+                            - trajectories.attributes[attributeIndex][i]);
+                    maxAttributeErrorCompressed = std::max(maxAttributeErrorCompressed,
+                            double(error / attributeRanges[attributeIndex]));
+                }
+            }
+        } else if (!isTrajectorySetEqual(compressed, firstCompressed)) {
+            passed = false;
+        }
+    }
+    passed = passed && maxPositionErrorCompressed <= maxPositionError
+            && maxAttributeErrorCompressed <= maxAttributeError;
+
+    // Random access to single lines (zero-copy for uncompressed files).
+    MappedBinLines uncompressedFile, compressedFile;
+    passed = passed && uncompressedFile.open(filenameVersion2) && compressedFile.open(filenameCompressed)
+            && uncompressedFile.getAttributeNames().at(0) == "attribute0"
+            && compressedFile.getAttributeNames().at(1) == "random";
+    std::vector<glm::vec3> linePositions;
+    std::vector<std::vector<float>> lineAttributes;
+    for (size_t lineIndex = 0; lineIndex < NUM_LINES && passed; lineIndex++) {
+        ArrayView<const glm::vec3> positions = uncompressedFile.getPositions(lineIndex);
+        ArrayView<const glm::vec3> expectedPositions = trajectories.getPositions(lineIndex);
+        passed = positions.size() == expectedPositions.size()
+                && std::equal(positions.begin(), positions.end(), expectedPositions.begin());
+        passed = passed && compressedFile.readLine(lineIndex, linePositions, lineAttributes)
+                && std::equal(linePositions.begin(), linePositions.end(),
+                        firstCompressed.getPositions(lineIndex).begin())
+                && std::equal(lineAttributes.at(1).begin(), lineAttributes.at(1).end(),
+                        firstCompressed.getAttribute(lineIndex, 1).begin());
+    }
+    uncompressedFile.close();
+    compressedFile.close();
+    remove(filenameVersion1.c_str());
+    remove(filenameVersion2.c_str());
+    remove(filenameCompressed.c_str());
+
+    suite.addValidationResult("BinLinesFile", passed, std::to_string(NUM_LINES) + " lines with "
+            + std::to_string(trajectories.getNumPoints()) + " points, compressed max. position error "
+            + toStringPrecise(maxPositionErrorCompressed) + " (bound " + toStringPrecise(maxPositionError)
+            + "), max. relative attribute error " + toStringPrecise(maxAttributeErrorCompressed) + " (bound "
+            + toStringPrecise(maxAttributeError) + ")");
+}
+
+
+void validateUnorm16(BenchmarkSuite &suite, const std::vector<int> &threadCounts)
+{
+    // Exhaustive: All codes need to survive the round trip code -> float -> code.
+    const size_t NUM_CODES = 65536;
+    std::vector<uint16_t> allCodes(NUM_CODES);
+    for (size_t i = 0; i < NUM_CODES; i++) {
+        allCodes[i] = uint16_t(i);
+    }
+    std::vector<float> unpackedValues(NUM_CODES), referenceValues;
+    unpackUnorm16(allCodes.data(), NUM_CODES, unpackedValues.data());
+    unpackUnorm16ArrayReference(allCodes.data(), NUM_CODES, referenceValues);
+    size_t numUnpackMismatches = 0;
+    for (size_t i = 0; i < NUM_CODES; i++) {
+        if (memcmp(&unpackedValues[i], &referenceValues[i], sizeof(float)) != 0) {
+            numUnpackMismatches++;
+        }
+    }
+
+    const Unorm16Rounding roundingModes[] = { UNORM16_ROUND_NEAREST, UNORM16_ROUND_NEAREST_EVEN, UNORM16_ROUND_TRUNCATE };
+    size_t numRoundTripErrors = 0;
+    std::vector<uint16_t> packedCodes(NUM_CODES);
+    for (Unorm16Rounding rounding : roundingModes) {
+        packUnorm16(unpackedValues.data(), NUM_CODES, 0.0f, 1.0f, packedCodes.data(), rounding);
+        for (size_t i = 0; i < NUM_CODES; i++) {
+            // Truncation may give the next smaller code if code / 65535 was rounded down.
+            int difference = int(allCodes[i]) - int(packedCodes[i]);
+            if (rounding == UNORM16_ROUND_TRUNCATE ? (difference < 0 || difference > 1) : difference != 0) {
+                numRoundTripErrors++;
+            }
+        }
+    }
+
+    // Random values including ties, clamped values and NaN; the histogram and range are compared with a brute force
+    // computation and all results need to be independent of the number of threads.
+    const size_t NUM_VALUES = 1000003;
+    const size_t NUM_BINS = 100;
+    std::mt19937 generator(17);
+    std::uniform_real_distribution<float> valueDistribution(-3.0f, 5.0f);
+    std::vector<float> values(NUM_VALUES);
+    for (size_t i = 0; i < NUM_VALUES; i++) {
+        values[i] = valueDistribution(generator);
+    }
+    values[0] = -3.0f;
+    values[1] = 5.0f;
+    values[12] = std::nanf("");
+    for (size_t i = 100; i < 200; i++) {
+        values[i] = -3.0f + 8.0f * (float(i) + 0.5f) / 65535.0f;
+    }
+
+    std::vector<uint16_t> referenceCodes;
+    std::vector<float> valuesWithoutNaN = values;
+    valuesWithoutNaN[12] = 0.0f;
+    packUnorm16ArrayReference(valuesWithoutNaN, referenceCodes);
+
+    bool passed = numUnpackMismatches == 0 && numRoundTripErrors == 0;
+    size_t numPackMismatches = 0;
+    std::vector<uint16_t> firstCodes;
+    Unorm16Statistics firstPackStatistics, firstUnpackStatistics;
+    std::vector<float> firstUnpackedValues;
+    for (size_t t = 0; t < threadCounts.size(); t++) {
+        BenchmarkSuite::setNumThreads(threadCounts.at(t));
+        std::vector<uint16_t> codes(NUM_VALUES);
+        Unorm16Statistics packStatistics;
+        packStatistics.histogram.resize(NUM_BINS);
+        packUnorm16(values.data(), NUM_VALUES, codes.data(), UNORM16_ROUND_NEAREST, &packStatistics);
+
+        std::vector<float> unpacked(NUM_VALUES);
+        Unorm16Statistics unpackStatistics;
+        unpackStatistics.histogram.resize(NUM_BINS);
+        unpackUnorm16(codes.data(), NUM_VALUES, unpacked.data(), &unpackStatistics);
+
+        if (t == 0) {
+            firstCodes = codes;
+            firstPackStatistics = packStatistics;
+            firstUnpackStatistics = unpackStatistics;
+            firstUnpackedValues = unpacked;
+
+            for (size_t i = 0; i < NUM_VALUES; i++) {
+                if (i != 12 && codes[i] != referenceCodes[i]) {
+                    numPackMismatches++;
+                }
+            }
+            std::vector<uint64_t> histogram(NUM_BINS, 0);
+            float minValue = FLT_MAX, maxValue = -FLT_MAX;
+            for (size_t i = 0; i < NUM_VALUES; i++) {
+                histogram[size_t(codes[i]) * NUM_BINS / NUM_CODES]++;
+                minValue = std::min(minValue, unpacked[i]);
+                maxValue = std::max(maxValue, unpacked[i]);
+            }
+            passed = passed && numPackMismatches == 0 && codes[12] == 0
+                    && packStatistics.minValue == -3.0f && packStatistics.maxValue == 5.0f
+                    && packStatistics.histogram == histogram && unpackStatistics.histogram == histogram
+                    && unpackStatistics.minValue == minValue && unpackStatistics.maxValue == maxValue
+                    && minValue == 0.0f && maxValue == 1.0f;
+        } else if (codes != firstCodes || packStatistics.histogram != firstPackStatistics.histogram
+                || packStatistics.minValue != firstPackStatistics.minValue
+                || packStatistics.maxValue != firstPackStatistics.maxValue
+                || unpacked != firstUnpackedValues || unpackStatistics.histogram != firstUnpackStatistics.histogram
+                || unpackStatistics.minValue != firstUnpackStatistics.minValue
+                || unpackStatistics.maxValue != firstUnpackStatistics.maxValue) {
+            passed = false;
+        }
+    }
+
+    suite.addValidationResult("Unorm16", passed, std::to_string(numUnpackMismatches)
+            + " unpack mismatches and " + std::to_string(numRoundTripErrors) + " round trip errors over all "
+            + std::to_string(NUM_CODES) + " codes, " + std::to_string(numPackMismatches)
+            + " pack mismatches on " + std::to_string(NUM_VALUES) + " random values");
+}
+
+
+static bool isPreprocessedSubmeshEqual(const PreprocessedSubmesh &a, const PreprocessedSubmesh &b)
+{
+    if (a.indices != b.indices || a.vec4Attributes != b.vec4Attributes
+            || a.importanceCriterionAttributes.size() != b.importanceCriterionAttributes.size()
+            || a.linePointData.size() != b.linePointData.size() || a.hasBoundingBox != b.hasBoundingBox
+            || a.boundingBox.getMinimum() != b.boundingBox.getMinimum()
+            || a.boundingBox.getMaximum() != b.boundingBox.getMaximum()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.importanceCriterionAttributes.size(); i++) {
+        const ImportanceCriterionAttribute &attributeA = a.importanceCriterionAttributes.at(i);
+        const ImportanceCriterionAttribute &attributeB = b.importanceCriterionAttributes.at(i);
+        if (attributeA.name != attributeB.name || attributeA.attributes != attributeB.attributes
+                || attributeA.minAttribute != attributeB.minAttribute
+                || attributeA.maxAttribute != attributeB.maxAttribute) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < a.linePointData.size(); i++) {
+        const std::vector<LinePointData> &dataA = a.linePointData.at(i), &dataB = b.linePointData.at(i);
+        if (dataA.size() != dataB.size()
+                || (!dataA.empty() && memcmp(dataA.data(), dataB.data(), dataA.size() * sizeof(LinePointData)) != 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void validateMeshPreprocessing(BenchmarkSuite &suite, const std::vector<int> &threadCounts)
+{
+    // A line mesh with the attributes of the converted trajectory datasets (see convertTrajectoryDataToBinaryLineMesh).
+    const size_t NUM_LINES = 200;
+    std::mt19937 generator(23);
+    std::uniform_int_distribution<int> numPointsDistribution(2, 300);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    std::vector<glm::vec3> positions, tangents;
+    std::vector<uint16_t> attribute0, attribute1;
+    std::vector<uint32_t> lineIndices;
+    for (size_t lineIndex = 0; lineIndex < NUM_LINES; lineIndex++) {
+        int numPoints = numPointsDistribution(generator);
+        glm::vec3 position(distribution(generator), distribution(generator), distribution(generator));
+        for (int i = 0; i < numPoints; i++) {
+            if (i > 0) {
+                lineIndices.push_back(uint32_t(positions.size() - 1));
+                lineIndices.push_back(uint32_t(positions.size()));
+            }
+            glm::vec3 tangent = glm::normalize(glm::vec3(1.0f, distribution(generator), distribution(generator)));
+            position += tangent * 0.01f;
+            positions.push_back(position);
+            tangents.push_back(tangent);
+            attribute0.push_back(uint16_t(generator() & 0xFFFFu));
+            attribute1.push_back(uint16_t(1000u + (generator() % 20000u)));
+        }
+    }
+    // Triangle mesh: The line vertices are connected to (degenerate) triangles.
+    std::vector<uint32_t> triangleIndices;
+    for (size_t i = 0; i + 2 < positions.size(); i++) {
+        triangleIndices.push_back(uint32_t(i));
+        triangleIndices.push_back(uint32_t(i + 1));
+        triangleIndices.push_back(uint32_t(i + 2));
+    }
+
+    BinarySubMeshView submesh;
+    submesh.vertexMode = sgl::VERTEX_MODE_LINES;
+    submesh.indices = lineIndices.data();
+    submesh.numIndices = lineIndices.size();
+    const char *attributeNames[] = { "vertexPosition", "vertexLineTangent", "vertexAttribute0", "vertexAttribute1" };
+    const void *attributeData[] = { positions.data(), tangents.data(), attribute0.data(), attribute1.data() };
+    size_t attributeDataSizes[] = { positions.size() * sizeof(glm::vec3), tangents.size() * sizeof(glm::vec3),
+            attribute0.size() * sizeof(uint16_t), attribute1.size() * sizeof(uint16_t) };
+    for (int i = 0; i < 4; i++) {
+        BinaryMeshAttributeView attribute;
+        attribute.name = attributeNames[i];
+        attribute.attributeFormat = i < 2 ? sgl::ATTRIB_FLOAT : sgl::ATTRIB_UNSIGNED_SHORT;
+        attribute.numComponents = i < 2 ? 3 : 1;
+        attribute.data = (const uint8_t*)attributeData[i];
+        attribute.dataSize = attributeDataSizes[i];
+        submesh.attributes.push_back(attribute);
+    }
+    BinarySubMeshView triangleSubmesh = submesh;
+    triangleSubmesh.vertexMode = sgl::VERTEX_MODE_TRIANGLES;
+    triangleSubmesh.indices = triangleIndices.data();
+    triangleSubmesh.numIndices = triangleIndices.size();
+
+    // Plain, shuffled lines, shuffled triangles, programmable fetch (AoS) and programmable fetch (SoA).
+    const int NUM_MODES = 5;
+    const char *modeNames[] = { "plain", "shuffled lines", "shuffled triangles", "fetch AoS", "fetch SoA" };
+    bool passed = true;
+    std::string failedModes;
+    for (int mode = 0; mode < NUM_MODES; mode++) {
+        MeshPreprocessingSettings settings;
+        settings.shuffleData = mode == 1 || mode == 2;
+        settings.shuffleSeed = 17;
+        settings.useProgrammableFetch = mode >= 3;
+        settings.programmableFetchUseAoS = mode == 3;
+        const BinarySubMeshView &modeSubmesh = mode == 2 ? triangleSubmesh : submesh;
+
+        PreprocessedSubmesh reference;
+        preprocessSubmeshReference(modeSubmesh, settings, reference);
+        bool modePassed = true;
+        for (size_t t = 0; t < threadCounts.size(); t++) {
+            BenchmarkSuite::setNumThreads(threadCounts.at(t));
+            PreprocessedSubmesh preprocessedSubmesh;
+            preprocessSubmesh(modeSubmesh, settings, preprocessedSubmesh);
+            modePassed = modePassed && isPreprocessedSubmeshEqual(preprocessedSubmesh, reference);
+        }
+        if (!modePassed) {
+            failedModes += failedModes.empty() ? "" : ", ";
+            failedModes += modeNames[mode];
+            passed = false;
+        }
+    }
+
+    suite.addValidationResult("MeshPreprocessing", passed, std::to_string(NUM_LINES) + " lines with "
+            + std::to_string(positions.size()) + " points, " + std::to_string(NUM_MODES) + " modes"
+            + (failedModes.empty() ? std::string() : ", mismatches: " + failedModes));
+}
+
+
+void validateShuffle(BenchmarkSuite &suite, const std::vector<int> &threadCounts)
+{
+    // Bijection for sizes around powers of four (cycle walking) and degenerate sizes.
+    bool passed = true;
+    const uint64_t sizes[] = { 0, 1, 2, 3, 4, 5, 15, 16, 17, 1000, 65535, 65536, 65537, 1000003 };
+    for (uint64_t size : sizes) {
+        RandomPermutation permutation(size, 42);
+        std::vector<uint8_t> isUsed(size, 0);
+        for (uint64_t i = 0; i < size; i++) {
+            uint64_t index = permutation(i);
+            if (index >= size || isUsed[index]) {
+                passed = false;
+                break;
+            }
+            isUsed[index] = 1;
+        }
+    }
+    bool isBijection = passed;
+
+    // Uniformity: Position of element 0 in permutations of 8 elements over many seeds (chi-squared, 7 degrees of
+    // freedom; 24.3 is the 0.999 quantile).
+    const int NUM_SEEDS = 40000;
+    std::vector<int> positionCounts(8, 0);
+    for (int seed = 0; seed < NUM_SEEDS; seed++) {
+        RandomPermutation permutation(8, uint64_t(seed));
+        for (int i = 0; i < 8; i++) {
+            if (permutation(uint64_t(i)) == 0) {
+                positionCounts.at(i)++;
+            }
+        }
+    }
+    double chiSquared = 0.0;
+    for (int count : positionCounts) {
+        double expected = double(NUM_SEEDS) / 8.0;
+        chiSquared += (double(count) - expected) * (double(count) - expected) / expected;
+    }
+    passed = passed && chiSquared < 24.3;
+
+    // Lines of different lengths: Every line needs to appear exactly once with its segments in order.
+    std::mt19937 generator(5);
+    std::uniform_int_distribution<int> numSegmentsDistribution(1, 50);
+    std::vector<uint32_t> lineIndices, triangleIndices;
+    uint32_t vertexIndex = 0;
+    const size_t NUM_LINES = 20000;
+    for (size_t lineIndex = 0; lineIndex < NUM_LINES; lineIndex++) {
+        int numSegments = numSegmentsDistribution(generator);
+        for (int i = 0; i < numSegments; i++) {
+            lineIndices.push_back(vertexIndex + uint32_t(i));
+            lineIndices.push_back(vertexIndex + uint32_t(i) + 1u);
+        }
+        vertexIndex += uint32_t(numSegments) + 1u;
+    }
+    for (uint32_t i = 0; i < 300000; i++) {
+        triangleIndices.push_back(i);
+        triangleIndices.push_back(i + 1000000u);
+        triangleIndices.push_back(i + 2000000u);
+    }
+
+    std::vector<uint32_t> firstLineOrder, firstTriangles, firstSegments;
+    for (size_t t = 0; t < threadCounts.size(); t++) {
+        BenchmarkSuite::setNumThreads(threadCounts.at(t));
+        std::vector<uint32_t> lineOrder = shuffleLineOrder(lineIndices.data(), lineIndices.size(), 7);
+        std::vector<uint32_t> triangles = shuffleIndicesTriangles(triangleIndices.data(), triangleIndices.size(), 7);
+        std::vector<uint32_t> segments = shuffleIndicesLines(lineIndices.data(), lineIndices.size(), 7);
+        if (t == 0) {
+            firstLineOrder = lineOrder;
+            firstTriangles = triangles;
+            firstSegments = segments;
+        } else if (lineOrder != firstLineOrder || triangles != firstTriangles || segments != firstSegments) {
+            passed = false;
+        }
+    }
+
+    // The lines start at vertices not referenced by the previous segment; their segments need to be consecutive.
+    size_t numShuffledLines = 0;
+    std::vector<uint8_t> isLineUsed(vertexIndex, 0);
+    bool linesIntact = firstLineOrder.size() == lineIndices.size();
+    for (size_t i = 0; linesIntact && i < firstLineOrder.size(); i += 2) {
+        bool isLineStart = i == 0 || firstLineOrder[i] != firstLineOrder[i - 1];
+        if (isLineStart) {
+            linesIntact = !isLineUsed[firstLineOrder[i]];
+            isLineUsed[firstLineOrder[i]] = 1;
+            numShuffledLines++;
+        }
+        linesIntact = linesIntact && firstLineOrder[i + 1] == firstLineOrder[i] + 1u;
+    }
+    linesIntact = linesIntact && numShuffledLines == NUM_LINES && firstLineOrder != lineIndices;
+
+    std::vector<uint32_t> sortedTriangles = firstTriangles, sortedSegments = firstSegments;
+    std::sort(sortedTriangles.begin(), sortedTriangles.end());
+    std::sort(sortedSegments.begin(), sortedSegments.end());
+    std::vector<uint32_t> expectedTriangles = triangleIndices, expectedSegments = lineIndices;
+    std::sort(expectedTriangles.begin(), expectedTriangles.end());
+    std::sort(expectedSegments.begin(), expectedSegments.end());
+    bool primitivesIntact = sortedTriangles == expectedTriangles && sortedSegments == expectedSegments
+            && firstTriangles != triangleIndices;
+    for (size_t i = 0; primitivesIntact && i < firstTriangles.size(); i += 3) {
+        primitivesIntact = firstTriangles[i + 1] == firstTriangles[i] + 1000000u
+                && firstTriangles[i + 2] == firstTriangles[i] + 2000000u;
+    }
+    passed = passed && linesIntact && primitivesIntact
+            && shuffleLineOrder(lineIndices.data(), lineIndices.size(), 8) != firstLineOrder;
+
+    suite.addValidationResult("Shuffle", passed, std::string() + "Bijection: " + (isBijection ? "yes" : "no")
+            + ", chi-squared " + toStringPrecise(chiSquared) + ", lines intact: " + (linesIntact ? "yes" : "no")
+            + ", primitives intact: " + (primitivesIntact ? "yes" : "no"));
+}
+
+void validateSpatialReordering(BenchmarkSuite &suite, const std::vector<int> &threadCounts)
+{
+    // The first 8^3 cells of the Hilbert curve fill the cube [0, 8)^3 and consecutive cells are neighbors.
+    const uint32_t CUBE_SIZE = 8;
+    std::vector<glm::uvec3> hilbertCells(CUBE_SIZE * CUBE_SIZE * CUBE_SIZE, glm::uvec3(0xFFFFFFFFu));
+    bool hilbertValid = true;
+    for (uint32_t z = 0; z < CUBE_SIZE; z++) {
+        for (uint32_t y = 0; y < CUBE_SIZE; y++) {
+            for (uint32_t x = 0; x < CUBE_SIZE; x++) {
+                uint64_t code = computeHilbertCode(x, y, z);
+                if (code >= hilbertCells.size() || hilbertCells[code].x != 0xFFFFFFFFu) {
+                    hilbertValid = false;
+                    continue;
+                }
+                hilbertCells[code] = glm::uvec3(x, y, z);
+            }
+        }
+    }
+    for (size_t i = 1; hilbertValid && i < hilbertCells.size(); i++) {
+        glm::ivec3 diff = glm::abs(glm::ivec3(hilbertCells[i]) - glm::ivec3(hilbertCells[i - 1]));
+        hilbertValid = diff.x + diff.y + diff.z == 1;
+    }
+
+    // Morton codes against a bitwise loop and the 64-bit radix sort against std::stable_sort.
+    std::mt19937_64 generator(11);
+    bool mortonValid = true;
+    for (int i = 0; i < 1000; i++) {
+        uint32_t x = uint32_t(generator()) & 0x1FFFFFu, y = uint32_t(generator()) & 0x1FFFFFu;
+        uint32_t z = uint32_t(generator()) & 0x1FFFFFu;
+        uint64_t expectedCode = 0;
+        for (uint32_t bit = 0; bit < 21; bit++) {
+            expectedCode |= uint64_t((x >> bit) & 1u) << (3u * bit + 2u);
+            expectedCode |= uint64_t((y >> bit) & 1u) << (3u * bit + 1u);
+            expectedCode |= uint64_t((z >> bit) & 1u) << (3u * bit);
+        }
+        mortonValid = mortonValid && computeMortonCode(x, y, z) == expectedCode;
+    }
+    typedef std::pair<uint64_t, uint32_t> KeyValuePair;
+    std::vector<KeyValuePair> pairs(200000);
+    for (size_t i = 0; i < pairs.size(); i++) {
+        // Few distinct high bits, such that the stability is tested.
+        pairs[i] = KeyValuePair((generator() & 0x7FFF000000000000ull) | (generator() & 0xFFull), uint32_t(i));
+    }
+    std::vector<KeyValuePair> expectedPairs = pairs;
+    std::stable_sort(expectedPairs.begin(), expectedPairs.end(), [](const KeyValuePair &a, const KeyValuePair &b) {
+        return a.first < b.first;
+    });
+    bool radixSortValid = true;
+    for (size_t t = 0; t < threadCounts.size(); t++) {
+        BenchmarkSuite::setNumThreads(threadCounts.at(t));
+        std::vector<KeyValuePair> sortedPairs = pairs;
+        parallelRadixSort(sortedPairs, [](const KeyValuePair &pair) { return pair.first; }, 0x7FFF0000000000FFull);
+        radixSortValid = radixSortValid && sortedPairs == expectedPairs;
+    }
+
+    // Grid mesh consisting of tiles of 8x4 quads. The tiles are drawn in random order and the triangles of each tile
+    // are shuffled, too.
+    const uint32_t GRID_SIZE = 256, TILE_WIDTH = 8, TILE_HEIGHT = 4;
+    const size_t TILE_NUM_INDICES = TILE_WIDTH * TILE_HEIGHT * 6;
+    std::vector<glm::vec3> vertices;
+    for (uint32_t y = 0; y <= GRID_SIZE; y++) {
+        for (uint32_t x = 0; x <= GRID_SIZE; x++) {
+            vertices.push_back(glm::vec3(float(x), float(y), 0.0f));
+        }
+    }
+    std::vector<uint32_t> gridIndices;
+    for (uint32_t tileY = 0; tileY < GRID_SIZE; tileY += TILE_HEIGHT) {
+        for (uint32_t tileX = 0; tileX < GRID_SIZE; tileX += TILE_WIDTH) {
+            for (uint32_t y = tileY; y < tileY + TILE_HEIGHT; y++) {
+                for (uint32_t x = tileX; x < tileX + TILE_WIDTH; x++) {
+                    uint32_t i0 = y * (GRID_SIZE + 1) + x, i1 = i0 + 1, i2 = i0 + GRID_SIZE + 1, i3 = i2 + 1;
+                    const uint32_t quadIndices[] = { i0, i1, i2, i1, i3, i2 };
+                    gridIndices.insert(gridIndices.end(), quadIndices, quadIndices + 6);
+                }
+            }
+        }
+    }
+    const size_t numClusters = gridIndices.size() / TILE_NUM_INDICES;
+    RandomPermutation clusterPermutation(numClusters, 3);
+    std::vector<uint32_t> indices;
+    std::vector<size_t> clusterOffsets;
+    for (size_t c = 0; c < numClusters; c++) {
+        clusterOffsets.push_back(indices.size());
+        std::vector<uint32_t> tileIndices = shuffleIndicesTriangles(
+                &gridIndices[clusterPermutation(c) * TILE_NUM_INDICES], TILE_NUM_INDICES, c);
+        indices.insert(indices.end(), tileIndices.begin(), tileIndices.end());
+    }
+
+    SpatialReorderSettings settings;
+    settings.curve = SPACE_FILLING_CURVE_HILBERT;
+    settings.optimizeVertexCache = true;
+    std::vector<uint32_t> firstIndices, firstVertexOrder;
+    bool threadIndependent = true;
+    for (size_t t = 0; t < threadCounts.size(); t++) {
+        BenchmarkSuite::setNumThreads(threadCounts.at(t));
+        std::vector<uint32_t> reorderedIndices = indices, vertexOrder;
+        reorderMeshClusters(reorderedIndices, 3, clusterOffsets, vertices.data(), vertices.size(), settings,
+                vertexOrder);
+        if (t == 0) {
+            firstIndices = reorderedIndices;
+            firstVertexOrder = vertexOrder;
+        } else if (reorderedIndices != firstIndices || vertexOrder != firstVertexOrder) {
+            threadIndependent = false;
+        }
+    }
+
+    // All triangles (with their winding order) need to be kept when mapped back to the old vertex indices.
+    std::vector<uint32_t> sortedVertexOrder = firstVertexOrder;
+    std::sort(sortedVertexOrder.begin(), sortedVertexOrder.end());
+    bool primitivesIntact = firstIndices.size() == indices.size() && sortedVertexOrder.size() == vertices.size();
+    for (size_t v = 0; primitivesIntact && v < sortedVertexOrder.size(); v++) {
+        primitivesIntact = sortedVertexOrder[v] == uint32_t(v);
+    }
+    if (primitivesIntact) {
+        typedef std::pair<uint32_t, std::pair<uint32_t, uint32_t>> Triangle;
+        std::vector<Triangle> expectedTriangles, triangles;
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            expectedTriangles.push_back(Triangle(indices[i], std::make_pair(indices[i + 1], indices[i + 2])));
+            triangles.push_back(Triangle(firstVertexOrder[firstIndices[i]], std::make_pair(
+                    firstVertexOrder[firstIndices[i + 1]], firstVertexOrder[firstIndices[i + 2]])));
+        }
+        std::sort(expectedTriangles.begin(), expectedTriangles.end());
+        std::sort(triangles.begin(), triangles.end());
+        primitivesIntact = triangles == expectedTriangles;
+    }
+
+    std::vector<glm::vec3> reorderedVertices = vertices;
+    reorderVertexData(reorderedVertices, firstVertexOrder);
+    MeshCacheStatistics before = simulateMeshCaches(indices.data(), indices.size(), 3, vertices.data(),
+            vertices.size());
+    MeshCacheStatistics after = simulateMeshCaches(firstIndices.data(), firstIndices.size(), 3,
+            reorderedVertices.data(), reorderedVertices.size());
+    bool cacheMissesReduced = after.averageCacheMissRatio < before.averageCacheMissRatio
+            && after.vertexFetchMissRatio < before.vertexFetchMissRatio
+            && after.spatialMissRatio < before.spatialMissRatio;
+
+    // Vertex cache optimization of one cluster of randomly ordered triangles (the optimum of a grid is about 0.5).
+    std::vector<uint32_t> clusterIndices(gridIndices.begin(), gridIndices.begin() + 3 * 2 * 32 * GRID_SIZE);
+    std::vector<uint32_t> shuffledClusterIndices = shuffleIndicesTriangles(
+            clusterIndices.data(), clusterIndices.size(), 5);
+    double acmrShuffled = simulateMeshCaches(shuffledClusterIndices.data(), shuffledClusterIndices.size(), 3,
+            vertices.data(), vertices.size()).averageCacheMissRatio;
+    optimizeVertexCacheOrder(shuffledClusterIndices.data(), shuffledClusterIndices.size(), 32);
+    double acmrOptimized = simulateMeshCaches(shuffledClusterIndices.data(), shuffledClusterIndices.size(), 3,
+            vertices.data(), vertices.size()).averageCacheMissRatio;
+    bool vertexCacheOptimized = acmrOptimized < 0.8 && acmrOptimized < acmrShuffled;
+
+    bool passed = hilbertValid && mortonValid && radixSortValid && threadIndependent && primitivesIntact
+            && cacheMissesReduced && vertexCacheOptimized;
+    suite.addValidationResult("Spatial reordering", passed, std::string()
+            + "Hilbert curve: " + (hilbertValid ? "yes" : "no") + ", radix sort: " + (radixSortValid ? "yes" : "no")
+            + ", primitives intact: " + (primitivesIntact ? "yes" : "no")
+            + ", ACMR " + toStringPrecise(before.averageCacheMissRatio) + " -> "
+            + toStringPrecise(after.averageCacheMissRatio) + ", fetch miss ratio "
+            + toStringPrecise(before.vertexFetchMissRatio) + " -> " + toStringPrecise(after.vertexFetchMissRatio)
+            + ", spatial miss ratio " + toStringPrecise(before.spatialMissRatio) + " -> "
+            + toStringPrecise(after.spatialMissRatio) + ", shuffled cluster ACMR " + toStringPrecise(acmrShuffled)
+            + " -> " + toStringPrecise(acmrOptimized));
+}
+
+
+/**
+ * Checks the meshlets of a line or triangle submesh with the attribute "vertexAttribute0" and culls them for random
+ * cameras looking at the mesh. Every primitive with a vertex inside of the view frustum, a vertex attribute inside of
+ * the attribute range and (triangles) facing the camera needs to be part of a draw range.
+ * @return The names of the failed checks (empty if all checks passed).
+ */
+static std::string checkMeshlets(const BinarySubMeshView &submesh, const std::vector<int> &threadCounts,
+        std::vector<uint32_t> &meshletIndices, std::vector<BinaryMeshMeshlet> &meshlets,
+        MeshletCullingStatistics &totalStatistics)
+{
+    const size_t primitiveSize = submesh.vertexMode == sgl::VERTEX_MODE_LINES ? 2 : 3;
+    const glm::vec3 *positions = (const glm::vec3*)submesh.attributes.at(0).data;
+    const uint16_t *attribute = (const uint16_t*)submesh.attributes.at(1).data;
+    MeshletSettings settings;
+    std::string failedChecks;
+    auto addFailedCheck = [&failedChecks](const std::string &check) {
+        failedChecks += (failedChecks.empty() ? "" : ", ") + check;
+    };
+
+    bool threadIndependent = true;
+    for (size_t t = 0; t < threadCounts.size(); t++) {
+        BenchmarkSuite::setNumThreads(threadCounts.at(t));
+        std::vector<uint32_t> currentIndices;
+        std::vector<BinaryMeshMeshlet> currentMeshlets;
+        buildMeshlets(submesh, settings, currentIndices, currentMeshlets);
+        if (t == 0) {
+            meshletIndices = currentIndices;
+            meshlets = currentMeshlets;
+        } else if (currentIndices != meshletIndices || currentMeshlets.size() != meshlets.size()
+                || memcmp(currentMeshlets.data(), meshlets.data(), meshlets.size() * sizeof(BinaryMeshMeshlet)) != 0) {
+            threadIndependent = false;
+        }
+    }
+    if (!threadIndependent) {
+        addFailedCheck("thread independence");
+    }
+
+    // The meshlets need to cover the index buffer in order, respect the size limits and keep all primitives.
+    bool partitionValid = meshletIndices.size() == submesh.numIndices;
+    size_t indexOffset = 0;
+    for (const BinaryMeshMeshlet &meshlet : meshlets) {
+        std::vector<uint32_t> meshletVertices(
+                meshletIndices.begin() + meshlet.indexOffset, meshletIndices.begin() + meshlet.indexOffset
+                + std::min(size_t(meshlet.indexCount), meshletIndices.size() - meshlet.indexOffset));
+        std::sort(meshletVertices.begin(), meshletVertices.end());
+        size_t numUniqueVertices = size_t(std::unique(meshletVertices.begin(), meshletVertices.end())
+                - meshletVertices.begin());
+        partitionValid = partitionValid && meshlet.indexOffset == indexOffset && meshlet.indexCount > 0
+                && meshlet.indexCount % primitiveSize == 0
+                && meshlet.indexCount / primitiveSize <= settings.maxPrimitives
+                && numUniqueVertices <= settings.maxVertices;
+        indexOffset += meshlet.indexCount;
+    }
+    partitionValid = partitionValid && indexOffset == meshletIndices.size();
+    if (partitionValid) {
+        typedef std::pair<uint32_t, std::pair<uint32_t, uint32_t>> Primitive;
+        std::vector<Primitive> expectedPrimitives, primitives;
+        for (size_t i = 0; i < submesh.numIndices; i += primitiveSize) {
+            expectedPrimitives.push_back(Primitive(submesh.indices[i], std::make_pair(submesh.indices[i + 1],
+                    primitiveSize == 3 ? submesh.indices[i + 2] : 0u)));
+            primitives.push_back(Primitive(meshletIndices[i], std::make_pair(meshletIndices[i + 1],
+                    primitiveSize == 3 ? meshletIndices[i + 2] : 0u)));
+        }
+        std::sort(expectedPrimitives.begin(), expectedPrimitives.end());
+        std::sort(primitives.begin(), primitives.end());
+        partitionValid = primitives == expectedPrimitives;
+    }
+    if (!partitionValid) {
+        addFailedCheck("partition");
+        return failedChecks;
+    }
+
+    // All vertices, attribute values and triangle normals need to lie inside of the bounds.
+    bool boundsValid = true;
+    for (const BinaryMeshMeshlet &meshlet : meshlets) {
+        glm::vec3 center(meshlet.boundingSphere.x, meshlet.boundingSphere.y, meshlet.boundingSphere.z);
+        glm::vec3 axis(meshlet.normalCone.x, meshlet.normalCone.y, meshlet.normalCone.z);
+        float minCosAngle = std::sqrt(std::max(1.0f - meshlet.normalCone.w * meshlet.normalCone.w, 0.0f));
+        for (uint32_t i = meshlet.indexOffset; i < meshlet.indexOffset + meshlet.indexCount; i++) {
+            const glm::vec3 &position = positions[meshletIndices[i]];
+            float value = float(attribute[meshletIndices[i]]) / 65535.0f;
+            boundsValid = boundsValid && glm::all(glm::greaterThanEqual(position, meshlet.aabbMin))
+                    && glm::all(glm::greaterThanEqual(meshlet.aabbMax, position))
+                    && glm::length(position - center) <= meshlet.boundingSphere.w * 1.0001f + 1e-6f
+                    && value >= meshlet.attributeMin && value <= meshlet.attributeMax;
+            if (primitiveSize == 3 && meshlet.normalCone.w < 1.0f && (i - meshlet.indexOffset) % 3 == 0) {
+                const uint32_t *triangle = &meshletIndices[i];
+                glm::vec3 normal = glm::cross(positions[triangle[1]] - positions[triangle[0]],
+                        positions[triangle[2]] - positions[triangle[0]]);
+                float normalLength = glm::length(normal);
+                boundsValid = boundsValid
+                        && (normalLength == 0.0f || glm::dot(axis, normal / normalLength) >= minCosAngle - 1e-4f);
+            }
+        }
+    }
+    if (!boundsValid) {
+        addFailedCheck("bounds");
+    }
+
+    glm::vec3 aabbMin(FLT_MAX), aabbMax(-FLT_MAX);
+    for (const BinaryMeshMeshlet &meshlet : meshlets) {
+        aabbMin = glm::min(aabbMin, meshlet.aabbMin);
+        aabbMax = glm::max(aabbMax, meshlet.aabbMax);
+    }
+    const glm::vec3 sceneCenter = (aabbMin + aabbMax) * 0.5f;
+    const float sceneExtent = glm::length(aabbMax - aabbMin);
+
+    MeshletCullingSettings cullingSettings;
+    cullingSettings.frustumCulling = true;
+    cullingSettings.backfaceCulling = primitiveSize == 3;
+    cullingSettings.attributeRangeCulling = true;
+    cullingSettings.attributeRangeMin = 0.3f;
+    cullingSettings.attributeRangeMax = 1.0f;
+    const glm::mat4 projectionMatrix = glm::perspective(atanf(1.0f / 2.0f) * 2.0f, 16.0f / 9.0f, 0.01f, 100.0f);
+    std::mt19937 generator(29);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> distanceDistribution(0.2f, 1.5f);
+    bool cullingThreadIndependent = true, cullingConservative = true, drawRangesCompact = true;
+    const int NUM_CAMERAS = 100;
+    for (int cameraIndex = 0; cameraIndex < NUM_CAMERAS; cameraIndex++) {
+        glm::vec3 direction(distribution(generator), distribution(generator), distribution(generator));
+        glm::vec3 cameraPosition = sceneCenter
+                + glm::normalize(direction) * distanceDistribution(generator) * sceneExtent;
+        glm::vec3 target = sceneCenter + 0.3f * sceneExtent * glm::vec3(
+                distribution(generator), distribution(generator), distribution(generator));
+        glm::mat4 viewProjectionMatrix = projectionMatrix
+                * glm::lookAt(cameraPosition, target, glm::vec3(0.0f, 1.0f, 0.0f));
+
+        std::vector<MeshletDrawRange> drawRanges;
+        for (size_t t = 0; t < threadCounts.size(); t++) {
+            BenchmarkSuite::setNumThreads(threadCounts.at(t));
+            std::vector<MeshletDrawRange> currentDrawRanges;
+            MeshletCullingStatistics statistics;
+            cullMeshlets(meshlets.data(), meshlets.size(), viewProjectionMatrix, cameraPosition, cullingSettings,
+                    currentDrawRanges, &statistics);
+            if (t == 0) {
+                drawRanges = currentDrawRanges;
+                totalStatistics.numVisible += statistics.numVisible;
+                totalStatistics.numAttributeCulled += statistics.numAttributeCulled;
+                totalStatistics.numFrustumCulled += statistics.numFrustumCulled;
+                totalStatistics.numBackfaceCulled += statistics.numBackfaceCulled;
+            } else if (currentDrawRanges.size() != drawRanges.size() || (!drawRanges.empty() && memcmp(
+                    currentDrawRanges.data(), drawRanges.data(), drawRanges.size() * sizeof(MeshletDrawRange)) != 0)) {
+                cullingThreadIndependent = false;
+            }
+        }
+
+        // The draw ranges need to be sorted, disjoint and merged.
+        std::vector<uint8_t> drawn(meshletIndices.size(), 0);
+        for (size_t i = 0; i < drawRanges.size(); i++) {
+            const MeshletDrawRange &drawRange = drawRanges.at(i);
+            drawRangesCompact = drawRangesCompact && drawRange.indexCount > 0
+                    && size_t(drawRange.firstIndex) + drawRange.indexCount <= meshletIndices.size()
+                    && (i == 0 || drawRanges.at(i - 1).firstIndex + drawRanges.at(i - 1).indexCount
+                            < drawRange.firstIndex);
+            if (drawRangesCompact) {
+                std::fill(drawn.begin() + drawRange.firstIndex,
+                        drawn.begin() + drawRange.firstIndex + drawRange.indexCount, uint8_t(1));
+            }
+        }
+
+        for (size_t i = 0; i < meshletIndices.size() && cullingConservative; i += primitiveSize) {
+            const uint32_t *primitive = &meshletIndices[i];
+            bool insideFrustum = false, insideAttributeRange = false;
+            for (size_t j = 0; j < primitiveSize; j++) {
+                glm::vec4 clipPosition = viewProjectionMatrix * glm::vec4(positions[primitive[j]], 1.0f);
+                float w = clipPosition.w * 0.999f;
+                insideFrustum = insideFrustum || (clipPosition.w > 0.0f && std::abs(clipPosition.x) <= w
+                        && std::abs(clipPosition.y) <= w && std::abs(clipPosition.z) <= w);
+                insideAttributeRange = insideAttributeRange
+                        || float(attribute[primitive[j]]) / 65535.0f >= cullingSettings.attributeRangeMin + 1e-4f;
+            }
+            bool frontFacing = true;
+            if (primitiveSize == 3) {
+                glm::vec3 normal = glm::cross(positions[primitive[1]] - positions[primitive[0]],
+                        positions[primitive[2]] - positions[primitive[0]]);
+                glm::vec3 viewVector = cameraPosition - positions[primitive[0]];
+                frontFacing = glm::dot(normal, viewVector) > 1e-3f * glm::length(normal) * glm::length(viewVector);
+            }
+            if (insideFrustum && insideAttributeRange && frontFacing && !drawn[i]) {
+                cullingConservative = false;
+            }
+        }
+    }
+    if (!cullingThreadIndependent) {
+        addFailedCheck("culling thread independence");
+    }
+    if (!drawRangesCompact) {
+        addFailedCheck("draw ranges");
+    }
+    if (!cullingConservative) {
+        addFailedCheck("visible primitive culled");
+    }
+    return failedChecks;
+}
+
+void validateMeshlets(BenchmarkSuite &suite, const std::vector<int> &threadCounts, const std::string &directory)
+{
+    // Helical tubes (rings of eight vertices, counter-clockwise seen from the outside) and their center lines. The
+    // attribute increases from tube to tube, so parts of the mesh are outside of the attribute range of the culling.
+    const int NUM_TUBES = 100, NUM_RINGS = 60, NUM_RING_VERTICES = 8;
+    const float TUBE_RADIUS = 0.01f;
+    std::mt19937 generator(19);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    std::vector<glm::vec3> tubePositions, linePositions;
+    std::vector<uint16_t> tubeAttribute, lineAttribute;
+    std::vector<uint32_t> tubeIndices, lineIndices;
+    for (int tube = 0; tube < NUM_TUBES; tube++) {
+        glm::vec3 start(distribution(generator), distribution(generator), distribution(generator));
+        float phase = 3.0f * distribution(generator), frequency = 4.0f + 2.0f * distribution(generator);
+        uint32_t firstTubeVertex = uint32_t(tubePositions.size()), firstLineVertex = uint32_t(linePositions.size());
+        for (int ring = 0; ring < NUM_RINGS; ring++) {
+            float t = float(ring) / float(NUM_RINGS - 1);
+            glm::vec3 center = start + glm::vec3(0.1f * std::cos(frequency * t + phase),
+                    0.1f * std::sin(frequency * t + phase), 0.5f * t);
+            glm::vec3 tangent = glm::normalize(glm::vec3(-0.1f * frequency * std::sin(frequency * t + phase),
+                    0.1f * frequency * std::cos(frequency * t + phase), 0.5f));
+            glm::vec3 normal = glm::normalize(glm::cross(tangent, glm::vec3(1.0f, 0.0f, 0.0f)));
+            glm::vec3 binormal = glm::cross(tangent, normal);
+            uint16_t value = uint16_t((tube * 65535 / NUM_TUBES + ring * 100) % 65536);
+            for (int k = 0; k < NUM_RING_VERTICES; k++) {
+                float angle = float(k) / float(NUM_RING_VERTICES) * 6.2831853f;
+                tubePositions.push_back(center + TUBE_RADIUS * (std::cos(angle) * normal + std::sin(angle) * binormal));
+                tubeAttribute.push_back(value);
+            }
+            linePositions.push_back(center);
+            lineAttribute.push_back(value);
+            if (ring == 0) {
+                continue;
+            }
+            lineIndices.push_back(firstLineVertex + uint32_t(ring - 1));
+            lineIndices.push_back(firstLineVertex + uint32_t(ring));
+            for (int k = 0; k < NUM_RING_VERTICES; k++) {
+                uint32_t i00 = firstTubeVertex + uint32_t((ring - 1) * NUM_RING_VERTICES + k);
+                uint32_t i01 = firstTubeVertex + uint32_t((ring - 1) * NUM_RING_VERTICES + (k + 1) % NUM_RING_VERTICES);
+                uint32_t i10 = i00 + NUM_RING_VERTICES, i11 = i01 + NUM_RING_VERTICES;
+                uint32_t quadIndices[] = { i00, i01, i10, i01, i11, i10 };
+                for (int q = 0; q < 6; q += 3) {
+                    // Counter-clockwise seen from the outside, i.e., the normal points away from the center line.
+                    glm::vec3 faceNormal = glm::cross(tubePositions[quadIndices[q + 1]] - tubePositions[quadIndices[q]],
+                            tubePositions[quadIndices[q + 2]] - tubePositions[quadIndices[q]]);
+                    if (glm::dot(faceNormal, tubePositions[quadIndices[q]] - center) < 0.0f) {
+                        std::swap(quadIndices[q + 1], quadIndices[q + 2]);
+                    }
+                }
+                tubeIndices.insert(tubeIndices.end(), quadIndices, quadIndices + 6);
+            }
+        }
+    }
+
+    BinaryMesh tubeMesh, lineMesh;
+    tubeMesh.submeshes.resize(1);
+    lineMesh.submeshes.resize(1);
+    BinaryMesh *meshes[] = { &tubeMesh, &lineMesh };
+    const std::vector<glm::vec3> *meshPositions[] = { &tubePositions, &linePositions };
+    const std::vector<uint16_t> *meshAttributes[] = { &tubeAttribute, &lineAttribute };
+    for (int i = 0; i < 2; i++) {
+        BinarySubMesh &submesh = meshes[i]->submeshes.front();
+        submesh.vertexMode = i == 0 ? sgl::VERTEX_MODE_TRIANGLES : sgl::VERTEX_MODE_LINES;
+        submesh.indices = i == 0 ? tubeIndices : lineIndices;
+        submesh.attributes.resize(2);
+        submesh.attributes.at(0).name = "vertexPosition";
+        submesh.attributes.at(0).attributeFormat = sgl::ATTRIB_FLOAT;
+        submesh.attributes.at(0).numComponents = 3;
+        const uint8_t *positionData = (const uint8_t*)meshPositions[i]->data();
+        submesh.attributes.at(0).data.assign(
+                positionData, positionData + meshPositions[i]->size() * sizeof(glm::vec3));
+        submesh.attributes.at(1).name = "vertexAttribute0";
+        submesh.attributes.at(1).attributeFormat = sgl::ATTRIB_UNSIGNED_SHORT;
+        submesh.attributes.at(1).numComponents = 1;
+        const uint8_t *attributeData = (const uint8_t*)meshAttributes[i]->data();
+        submesh.attributes.at(1).data.assign(
+                attributeData, attributeData + meshAttributes[i]->size() * sizeof(uint16_t));
+    }
+
+    // The tube mesh is loaded through the conversion step, i.e., the round trip through a .binmesh file is tested.
+    const std::string inputFilename = directory + "validation_meshlets_input.binmesh";
+    const std::string outputFilename = directory + "validation_meshlets.binmesh";
+    bool roundTripValid = writeMesh3D(inputFilename, tubeMesh)
+            && convertBinaryMeshToMeshlets(inputFilename, outputFilename);
+    MappedBinaryMesh convertedMesh;
+    roundTripValid = roundTripValid && convertedMesh.open(outputFilename, true)
+            && convertedMesh.submeshes.size() == 1 && convertedMesh.submeshes.front().attributes.size() == 2;
+
+    std::string details;
+    bool passed = true;
+    const char *meshNames[] = { "tubes", "lines" };
+    for (int i = 0; i < 2; i++) {
+        MappedBinaryMesh mappedMesh;
+        bool meshValid = i == 0 ? roundTripValid : writeMesh3D(inputFilename, lineMesh)
+                && mappedMesh.open(inputFilename) && mappedMesh.submeshes.size() == 1
+                && mappedMesh.submeshes.front().attributes.size() == 2;
+        if (!meshValid) {
+            passed = false;
+            details += std::string(i == 0 ? "" : "; ") + meshNames[i] + ": round trip failed";
+            continue;
+        }
+        const BinarySubMeshView &submesh = i == 0 ? convertedMesh.submeshes.front() : mappedMesh.submeshes.front();
+
+        std::vector<uint32_t> meshletIndices;
+        std::vector<BinaryMeshMeshlet> meshlets;
+        MeshletCullingStatistics statistics;
+        std::string failedChecks = checkMeshlets(submesh, threadCounts, meshletIndices, meshlets, statistics);
+        if (i == 0) {
+            // The file already stores the meshlets and the index buffer in meshlet order, so building them again
+            // needs to reproduce both.
+            const BinarySubMeshView &storedSubmesh = convertedMesh.submeshes.front();
+            bool storedMeshletsEqual = storedSubmesh.numMeshlets == meshlets.size() && memcmp(storedSubmesh.meshlets,
+                    meshlets.data(), meshlets.size() * sizeof(BinaryMeshMeshlet)) == 0
+                    && std::equal(meshletIndices.begin(), meshletIndices.end(), storedSubmesh.indices);
+            if (!storedMeshletsEqual) {
+                failedChecks += std::string(failedChecks.empty() ? "" : ", ") + "stored meshlets";
+            }
+        }
+        // Every test needs to cull something for the random cameras (backface culling only for triangles).
+        if (statistics.numFrustumCulled == 0 || statistics.numAttributeCulled == 0
+                || (i == 0 && statistics.numBackfaceCulled == 0)) {
+            failedChecks += std::string(failedChecks.empty() ? "" : ", ") + "no meshlets culled";
+        }
+
+        size_t numCones = 0;
+        for (const BinaryMeshMeshlet &meshlet : meshlets) {
+            numCones += meshlet.normalCone.w < 1.0f ? 1 : 0;
+        }
+        const double numTests = double(std::max(statistics.numVisible + statistics.numAttributeCulled
+                + statistics.numFrustumCulled + statistics.numBackfaceCulled, size_t(1)));
+        details += std::string(i == 0 ? "" : "; ") + meshNames[i] + ": " + std::to_string(meshlets.size())
+                + " meshlets (" + std::to_string(numCones) + " with normal cone), culled: attribute "
+                + toStringPrecise(double(statistics.numAttributeCulled) / numTests) + ", frustum "
+                + toStringPrecise(double(statistics.numFrustumCulled) / numTests) + ", backface "
+                + toStringPrecise(double(statistics.numBackfaceCulled) / numTests)
+                + (failedChecks.empty() ? std::string() : ", failed: " + failedChecks);
+        passed = passed && failedChecks.empty();
+    }
+    convertedMesh.close();
+    remove(inputFilename.c_str());
+    remove(outputFilename.c_str());
+
+    suite.addValidationResult("Meshlets", passed, details);
+}
+
+
+/// Writes numBytes bytes with the passed value (the content of the synthetic artifacts and source files).
+static bool writeFilledFile(const std::string &filename, size_t numBytes, uint8_t value)
+{
+    std::vector<uint8_t> data(numBytes, value);
+    FILE *file = fopen(filename.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool success = fwrite(data.data(), 1, data.size(), file) == data.size();
+    return fclose(file) == 0 && success;
+}
+
+/// @return True if the file has the passed size and every byte has the passed value.
+static bool checkFilledFile(const std::string &filename, size_t numBytes, uint8_t value)
+{
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    std::vector<uint8_t> data(numBytes + 1);
+    size_t numBytesRead = fread(data.data(), 1, data.size(), file);
+    fclose(file);
+    return numBytesRead == numBytes && std::all_of(data.begin(), data.begin() + numBytes, [value](uint8_t byte) {
+        return byte == value;
+    });
+}
+
+void validateConversionCache(BenchmarkSuite &suite, const std::vector<int> &threadCounts, const std::string &directory)
+{
+    const size_t ARTIFACT_SIZE = 64 * 1024;
+    const std::string cacheDirectory = directory + "validation_conversion_cache/";
+    const std::string sourceFilename = directory + "validation_conversion_cache_source.bin";
+    ValidationChecks checks;
+
+    // The artifacts are filled with the tag of the key, so the returned file can be checked for every key.
+    std::atomic<int> numConversions(0);
+    auto getArtifact = [&](ConversionCache &cache, const std::string &artifactType, float lineRadius, uint8_t tag) {
+        ConversionCacheKey key(artifactType, ".bin");
+        key.addSourceFile(sourceFilename);
+        key.addParameter("lineRadius", lineRadius);
+        key.addParameter("tag", int(tag));
+        std::string artifactFilename = cache.getArtifact(key, [&](const std::string &outputFilename) {
+            numConversions++;
+            return writeFilledFile(outputFilename, ARTIFACT_SIZE, tag);
+        });
+        return checkFilledFile(artifactFilename, ARTIFACT_SIZE, tag) ? artifactFilename : std::string();
+    };
+
+    writeFilledFile(sourceFilename, 1024 * 1024, 1);
+    ConversionCacheStatistics statistics;
+    size_t numEvictions = 0;
+    {
+        ConversionCache cache(cacheDirectory);
+        cache.clear();
+
+        // Hits and misses
+        std::string artifactFilename = getArtifact(cache, "mesh", 0.001f, 1);
+        checks.check(!artifactFilename.empty() && numConversions == 1, "miss");
+        checks.check(getArtifact(cache, "mesh", 0.001f, 1) == artifactFilename && numConversions == 1, "hit");
+        ConversionCache otherCache(cacheDirectory);
+        checks.check(getArtifact(otherCache, "mesh", 0.001f, 1) == artifactFilename && numConversions == 1, "manifest");
+
+        // Every parameter and the content of the source file is part of the key
+        checks.check(getArtifact(cache, "mesh", std::nextafter(0.001f, 1.0f), 1) != artifactFilename
+                && numConversions == 2, "float parameter");
+        checks.check(getArtifact(cache, "voxel_grid", 0.001f, 1) != artifactFilename && numConversions == 3, "type");
+        writeFilledFile(sourceFilename, 1024 * 1024 + 1, 1);
+        checks.check(getArtifact(cache, "mesh", 0.001f, 1) != artifactFilename && numConversions == 4,
+                "source changed");
+        writeFilledFile(sourceFilename, 1024 * 1024, 1);
+        checks.check(getArtifact(cache, "mesh", 0.001f, 1) == artifactFilename && numConversions == 4,
+                "source restored");
+
+        // Failed conversions don't create entries
+        ConversionCacheKey failingKey("failing", ".bin");
+        failingKey.addSourceFile(sourceFilename);
+        checks.check(cache.getArtifact(failingKey, [](const std::string&) { return true; }).empty(), "missing output");
+        checks.check(cache.getArtifact(failingKey, [](const std::string &outputFilename) {
+            writeFilledFile(outputFilename, 1024, 1);
+            return false;
+        }).empty(), "failed conversion");
+        ConversionCacheKey missingSourceKey("mesh", ".bin");
+        missingSourceKey.addSourceFile(directory + "validation_conversion_cache_missing.bin");
+        checks.check(cache.getArtifact(missingSourceKey, [](const std::string&) { return true; }).empty(),
+                "missing source");
+
+        // LRU eviction: Budget of three artifacts, the least recently used artifact is evicted first
+        cache.clear();
+        cache.setSizeBudget(3 * ARTIFACT_SIZE);
+        std::string artifactA = getArtifact(cache, "lru", 0.0f, 10);
+        std::string artifactB = getArtifact(cache, "lru", 0.0f, 11);
+        std::string artifactC = getArtifact(cache, "lru", 0.0f, 12);
+        getArtifact(cache, "lru", 0.0f, 10);
+        std::string artifactD = getArtifact(cache, "lru", 0.0f, 13);
+        checks.check(checkFilledFile(artifactA, ARTIFACT_SIZE, 10) && !checkFilledFile(artifactB, ARTIFACT_SIZE, 11)
+                && checkFilledFile(artifactC, ARTIFACT_SIZE, 12) && checkFilledFile(artifactD, ARTIFACT_SIZE, 13)
+                && cache.getTotalSize() == 3 * ARTIFACT_SIZE, "LRU eviction");
+        statistics = cache.getStatistics();
+        numEvictions = statistics.numEvictions;
+    }
+
+    // Concurrent writers: Every thread uses its own cache object (like separate processes) and requests the same
+    // artifacts in a different order. Every artifact needs to be converted exactly once.
+    const int NUM_KEYS = 8;
+    const int numThreads = std::max(4, *std::max_element(threadCounts.begin(), threadCounts.end()));
+    {
+        ConversionCache cache(cacheDirectory);
+        cache.clear();
+    }
+    numConversions = 0;
+    std::atomic<int> numInvalidArtifacts(0);
+    std::vector<std::thread> threads;
+    for (int threadIdx = 0; threadIdx < numThreads; threadIdx++) {
+        threads.push_back(std::thread([&, threadIdx]() {
+            ConversionCache cache(cacheDirectory);
+            for (int i = 0; i < NUM_KEYS; i++) {
+                uint8_t tag = uint8_t(20 + (i + threadIdx) % NUM_KEYS);
+                if (getArtifact(cache, "concurrent", 0.0f, tag).empty()) {
+                    numInvalidArtifacts++;
+                }
+            }
+        }));
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    ConversionCache cache(cacheDirectory);
+    checks.check(numConversions == NUM_KEYS && numInvalidArtifacts == 0
+            && cache.getTotalSize() == uint64_t(NUM_KEYS) * ARTIFACT_SIZE, "concurrent writers");
+    cache.clear();
+    const char *cacheFilenames[] = { "manifest.txt", "manifest.lock", "conversion.lock" };
+    for (const char *cacheFilename : cacheFilenames) {
+        remove((cacheDirectory + cacheFilename).c_str());
+    }
+    remove(cacheDirectory.c_str());
+    remove(sourceFilename.c_str());
+
+    // Statistics of the first cache object: 3 hits and 9 misses (one failed conversion)
+    checks.check(statistics.numHits == 3 && statistics.numMisses == 10 && statistics.numFailedConversions == 2
+            && statistics.bytesSaved == 3 * ARTIFACT_SIZE, "statistics");
+
+    std::string details = std::string() + "Hit rate " + toStringPrecise(statistics.getHitRate()) + ", "
+            + std::to_string(numEvictions) + " evictions, " + std::to_string(numThreads) + " concurrent writers";
+    checks.report(suite, "Conversion cache", details);
+}
+
+
+/// @return True if the attribute with the passed name has the same content in both submeshes.
+static bool isAttributeViewEqual(const BinarySubMeshView &a, const BinarySubMeshView &b, const std::string &name)
+{
+    auto findAttribute = [&name](const BinarySubMeshView &submesh) -> const BinaryMeshAttributeView* {
+        for (const BinaryMeshAttributeView &attribute : submesh.attributes) {
+            if (attribute.name == name) {
+                return &attribute;
+            }
+        }
+        return nullptr;
+    };
+    const BinaryMeshAttributeView *attributeA = findAttribute(a), *attributeB = findAttribute(b);
+    return attributeA && attributeB && attributeA->dataSize == attributeB->dataSize
+            && attributeA->numComponents == attributeB->numComponents
+            && memcmp(attributeA->data, attributeB->data, attributeA->dataSize) == 0;
+}
+
+void validateSelectiveLoading(BenchmarkSuite &suite, const std::vector<int> &threadCounts,
+        const std::string &directory)
+{
+    // Two line submeshes with positions, tangents and four importance criteria.
+    const int NUM_SUBMESHES = 2, NUM_LINE_ATTRIBUTES = 4;
+    const size_t NUM_LINES = 100, NUM_LINE_POINTS = 50;
+    const std::string filename = directory + "validation_selective_loading.binmesh";
+    ValidationChecks checks;
+
+    std::mt19937 generator(29);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    BinaryMesh binaryMesh;
+    binaryMesh.submeshes.resize(NUM_SUBMESHES);
+    for (BinarySubMesh &submesh : binaryMesh.submeshes) {
+        std::vector<glm::vec3> positions, tangents;
+        std::vector<std::vector<uint16_t>> lineAttributes(NUM_LINE_ATTRIBUTES);
+        submesh.vertexMode = sgl::VERTEX_MODE_LINES;
+        for (size_t lineIndex = 0; lineIndex < NUM_LINES; lineIndex++) {
+            glm::vec3 position(distribution(generator), distribution(generator), distribution(generator));
+            for (size_t i = 0; i < NUM_LINE_POINTS; i++) {
+                if (i > 0) {
+                    submesh.indices.push_back(uint32_t(positions.size() - 1));
+                    submesh.indices.push_back(uint32_t(positions.size()));
+                }
+                glm::vec3 tangent = glm::normalize(glm::vec3(1.0f, distribution(generator), distribution(generator)));
+                position += tangent * 0.01f;
+                positions.push_back(position);
+                tangents.push_back(tangent);
+                for (std::vector<uint16_t> &lineAttribute : lineAttributes) {
+                    lineAttribute.push_back(uint16_t(generator() & 0xFFFFu));
+                }
+            }
+        }
+        auto addAttribute = [&submesh](const std::string &name, sgl::VertexAttributeFormat attributeFormat,
+                uint32_t numComponents, const void *data, size_t dataSize) {
+            BinaryMeshAttribute attribute;
+            attribute.name = name;
+            attribute.attributeFormat = attributeFormat;
+            attribute.numComponents = numComponents;
+            attribute.data.assign((const uint8_t*)data, (const uint8_t*)data + dataSize);
+            submesh.attributes.push_back(attribute);
+        };
+        addAttribute("vertexPosition", sgl::ATTRIB_FLOAT, 3, positions.data(), positions.size() * sizeof(glm::vec3));
+        addAttribute("vertexLineTangent", sgl::ATTRIB_FLOAT, 3, tangents.data(), tangents.size() * sizeof(glm::vec3));
+        for (int i = 0; i < NUM_LINE_ATTRIBUTES; i++) {
+            addAttribute("vertexAttribute" + std::to_string(i), sgl::ATTRIB_UNSIGNED_SHORT, 1,
+                    lineAttributes.at(i).data(), lineAttributes.at(i).size() * sizeof(uint16_t));
+        }
+    }
+    checks.check(writeMesh3D(filename, binaryMesh), "write");
+
+    // Table of contents
+    BinaryMeshTableOfContents tableOfContents;
+    bool hasTableOfContents = readBinaryMeshTableOfContents(filename, tableOfContents);
+    size_t numAttributeSections = 0;
+    for (const BinaryMeshSectionInfo &sectionInfo : tableOfContents.sections) {
+        numAttributeSections += sectionInfo.sectionType == BINMESH_SECTION_ATTRIBUTE ? 1 : 0;
+    }
+    checks.check(hasTableOfContents && tableOfContents.numSubmeshes == uint32_t(NUM_SUBMESHES)
+            && numAttributeSections == size_t(NUM_SUBMESHES * (NUM_LINE_ATTRIBUTES + 2)), "table of contents");
+
+    // Selection of a submesh and an attribute
+    MappedBinaryMesh fullMesh, selectedMesh;
+    bool fullMeshOpen = fullMesh.open(filename, true);
+    BinaryMeshSelection selection;
+    selection.submeshIndices = { 1 };
+    selection.attributeNames = { "vertexAttribute2" };
+    selection.loadIndices = false;
+    checks.check(fullMeshOpen && selectedMesh.open(filename, selection, true) && selectedMesh.submeshes.size() == 1
+            && selectedMesh.submeshes.front().attributes.size() == 1
+            && selectedMesh.submeshes.front().numIndices == 0
+            && isAttributeViewEqual(selectedMesh.submeshes.front(), fullMesh.submeshes.at(1), "vertexAttribute2"),
+            "selection");
+    selectedMesh.close();
+
+    // Selection of the importance criterion 1 for parseMesh3D
+    std::vector<std::string> unselectedAttributeNames;
+    selectImportanceCriterion(tableOfContents, 1, selection, unselectedAttributeNames);
+    std::vector<std::string> expectedSelection = { "vertexPosition", "vertexLineTangent", "vertexAttribute1" };
+    std::vector<std::string> expectedUnselected = { "vertexAttribute0", "vertexAttribute2", "vertexAttribute3" };
+    checks.check(selection.attributeNames == expectedSelection && unselectedAttributeNames == expectedUnselected,
+            "importance criterion selection");
+
+    // The selectively and the on demand loaded data must match the data of the full load in all rendering modes.
+    bool preprocessingPassed = fullMeshOpen;
+    for (int mode = 0; mode < 3 && fullMeshOpen; mode++) {
+        MeshPreprocessingSettings settings;
+        settings.useProgrammableFetch = mode >= 1;
+        settings.programmableFetchUseAoS = mode == 1;
+        for (size_t t = 0; t < threadCounts.size(); t++) {
+            BenchmarkSuite::setNumThreads(threadCounts.at(t));
+            std::vector<PreprocessedSubmesh> onDemandSubmeshes;
+            MappedBinaryMesh onDemandMesh;
+            bool onDemandLoaded = preprocessSelectedAttributes(
+                    filename, { "vertexAttribute3" }, settings, onDemandMesh, onDemandSubmeshes);
+            preprocessingPassed = preprocessingPassed && onDemandLoaded && selectedMesh.open(filename, selection)
+                    && selectedMesh.submeshes.size() == fullMesh.submeshes.size()
+                    && onDemandSubmeshes.size() == fullMesh.submeshes.size();
+            for (size_t i = 0; i < fullMesh.submeshes.size() && preprocessingPassed; i++) {
+                PreprocessedSubmesh full, selected;
+                preprocessSubmesh(fullMesh.submeshes.at(i), settings, full);
+                preprocessSubmesh(selectedMesh.submeshes.at(i), settings, selected);
+                const PreprocessedSubmesh &onDemand = onDemandSubmeshes.at(i);
+                const ImportanceCriterionAttribute &full1 = full.importanceCriterionAttributes.at(1);
+                const ImportanceCriterionAttribute &full3 = full.importanceCriterionAttributes.at(3);
+                preprocessingPassed = selected.indices == full.indices
+                        && selected.importanceCriterionAttributes.size() == 1
+                        && selected.importanceCriterionAttributes.front().attributes == full1.attributes
+                        && selected.importanceCriterionAttributes.front().minAttribute == full1.minAttribute
+                        && selected.importanceCriterionAttributes.front().maxAttribute == full1.maxAttribute
+                        && onDemand.importanceCriterionAttributes.size() == 1
+                        && onDemand.importanceCriterionAttributes.front().attributes == full3.attributes
+                        && onDemand.importanceCriterionAttributes.front().maxAttribute == full3.maxAttribute;
+                if (mode == 1) {
+                    // The AoS data of the loaded attributes matches, the other attribute indices have no data.
+                    preprocessingPassed = preprocessingPassed && selected.linePointData.size() == 2
+                            && selected.linePointData.at(0).empty()
+                            && onDemand.linePointData.size() == 4 && onDemand.linePointData.at(2).empty()
+                            && selected.linePointData.at(1).size() == full.linePointData.at(1).size()
+                            && memcmp(selected.linePointData.at(1).data(), full.linePointData.at(1).data(),
+                                    full.linePointData.at(1).size() * sizeof(LinePointData)) == 0
+                            && onDemand.linePointData.at(3).size() == full.linePointData.at(3).size()
+                            && memcmp(onDemand.linePointData.at(3).data(), full.linePointData.at(3).data(),
+                                    full.linePointData.at(3).size() * sizeof(LinePointData)) == 0;
+                }
+            }
+            selectedMesh.close();
+        }
+    }
+    checks.check(preprocessingPassed, "preprocessing");
+
+    // Bytes of the file referenced by the selected mesh compared to the full mesh
+    size_t numBytesFull = 0, numBytesSelected = 0;
+    selectedMesh.open(filename, selection);
+    for (int i = 0; i < 2; i++) {
+        const MappedBinaryMesh &mesh = i == 0 ? fullMesh : selectedMesh;
+        size_t &numBytes = i == 0 ? numBytesFull : numBytesSelected;
+        for (const BinarySubMeshView &submesh : mesh.submeshes) {
+            numBytes += submesh.numIndices * sizeof(uint32_t);
+            for (const BinaryMeshAttributeView &attribute : submesh.attributes) {
+                numBytes += attribute.dataSize;
+            }
+        }
+    }
+    selectedMesh.close();
+    fullMesh.close();
+    remove(filename.c_str());
+
+    std::string details = std::string() + "Selected importance criterion: "
+            + toStringPrecise(double(numBytesSelected) / double(std::max(numBytesFull, size_t(1))))
+            + " of the data of the full load";
+    checks.report(suite, "Selective loading", details);
+}
+
+
+template<size_t N>
+static int getNumDisplayNames(const char *const (&)[N])
+{
+    return int(N);
+}
+
+void validateImportanceCriteria(BenchmarkSuite &suite, const std::vector<int> &threadCounts,
+        const std::string &directory)
+{
+    // Random walks with a varying number of points (including lines without segments). Some lines repeat points, such
+    // that the curvature kernel needs to skip degenerate segments.
+    const size_t NUM_LINES = 300;
+    std::mt19937 generator(31);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> lengthDistribution(0, 400);
+    TrajectorySet trajectories;
+    trajectories.clear(1);
+    for (size_t lineIndex = 0; lineIndex < NUM_LINES; lineIndex++) {
+        Trajectory trajectory;
+        trajectory.attributes.resize(1);
+        glm::vec3 position(distribution(generator), distribution(generator), distribution(generator));
+        int numPoints = lineIndex % 50 == 7 ? int(lineIndex % 3) : lengthDistribution(generator);
+        for (int i = 0; i < numPoints; i++) {
+            if (lineIndex % 10 != 3 || i % 17 != 5) {
+                position += 0.01f * glm::vec3(
+                        distribution(generator), distribution(generator), distribution(generator));
+            }
+            trajectory.positions.push_back(position);
+            trajectory.attributes.at(0).push_back(distribution(generator));
+        }
+        trajectories.addTrajectory(trajectory);
+    }
+    ValidationChecks checks;
+
+    // The kernels must match the per-line functions and must not depend on the number of threads.
+    const int NUM_KERNELS = NUM_IMPORTANCE_CRITERION_KERNELS;
+    double maxError = 0.0;
+    for (int kernelIndex = 0; kernelIndex < NUM_KERNELS; kernelIndex++) {
+        ImportanceCriterionKernel kernel = ImportanceCriterionKernel(kernelIndex);
+        // Lines without segments only have values for the attribute of the file.
+        std::vector<float> expected(trajectories.getNumPoints(), 0.0f);
+        if (kernel == IMPORTANCE_CRITERION_KERNEL_ATTRIBUTE) {
+            expected = trajectories.attributes.front();
+        }
+        for (size_t lineIndex = 0; lineIndex < NUM_LINES; lineIndex++) {
+            if (trajectories.getNumPoints(lineIndex) >= 2) {
+                computeImportanceCriterionReference(kernel, trajectories.getPositions(lineIndex),
+                        trajectories.getAttribute(lineIndex, 0), &expected[trajectories.lineOffsets[lineIndex]]);
+            }
+        }
+        std::vector<float> firstValues;
+        bool passed = true;
+        for (size_t t = 0; t < threadCounts.size(); t++) {
+            BenchmarkSuite::setNumThreads(threadCounts.at(t));
+            std::vector<float> values(trajectories.getNumPoints(), -1.0f);
+            computeImportanceCriterion(kernel, trajectories, values.data());
+            if (t == 0) {
+                firstValues = values;
+            } else {
+                passed = passed && values == firstValues;
+            }
+        }
+        for (size_t i = 0; i < expected.size(); i++) {
+            maxError = std::max(maxError, double(std::abs(firstValues[i] - expected[i])));
+            passed = passed && !std::isnan(firstValues[i]);
+        }
+        checks.check(passed, IMPORTANCE_CRITERION_KERNEL_NAMES[kernelIndex]);
+    }
+    checks.check(maxError <= 1e-6, "kernel error");
+
+    // The registry computes each criterion once, and only on request.
+    const TrajectoryType trajectoryType = TRAJECTORY_TYPE_CONVECTION_ROLLS;
+    std::vector<float> segmentLengths(trajectories.getNumPoints());
+    computeImportanceCriterion(IMPORTANCE_CRITERION_KERNEL_SEGMENT_LENGTH, trajectories, segmentLengths.data());
+    ImportanceCriterionRegistry registry(trajectoryType, trajectories);
+    const std::vector<float> *criterion = registry.getCriterion(2);
+    checks.check(criterion && *criterion == segmentLengths && registry.getCriterion(2) == criterion
+            && registry.getNumComputations() == 1 && registry.isComputed(2) && !registry.isComputed(0)
+            && !registry.isComputed(1) && !registry.getCriterion(registry.getNumCriteria()), "registry");
+
+    // Requested criteria in the requested order (also twice).
+    TrajectorySet requested = trajectories;
+    checks.check(computeTrajectoryAttributes(trajectoryType, requested, { 2, 0, 2 })
+            && requested.getNumAttributes() == 3 && requested.attributes.at(0) == segmentLengths
+            && requested.attributes.at(1) == trajectories.attributes.at(0)
+            && requested.attributes.at(2) == segmentLengths, "requested criteria");
+    requested = trajectories;
+    checks.check(!computeTrajectoryAttributes(trajectoryType, requested, { 3 }), "invalid criterion");
+
+    // Each importance criterion listed in the user interface has a kernel.
+    checks.check(getNumImportanceCriteria(TRAJECTORY_TYPE_ANEURYSM)
+                    == getNumDisplayNames(IMPORTANCE_CRITERION_ANEURYSM_DISPLAYNAMES)
+            && getNumImportanceCriteria(TRAJECTORY_TYPE_WCB)
+                    == getNumDisplayNames(IMPORTANCE_CRITERION_WCB_DISPLAYNAMES)
+            && getNumImportanceCriteria(TRAJECTORY_TYPE_CONVECTION_ROLLS)
+                    == getNumDisplayNames(IMPORTANCE_CRITERION_CONVECTION_ROLLS_DISPLAYNAMES)
+            && getNumImportanceCriteria(TRAJECTORY_TYPE_CFD)
+                    == getNumDisplayNames(IMPORTANCE_CRITERION_CFD_DISPLAYNAMES), "display names");
+
+    // The line mesh conversion only stores the requested criteria.
+    const std::string binLinesFilename = directory + "validation_importance_criteria.binlines";
+    const std::string meshFilename = directory + "validation_importance_criteria.binmesh";
+    TrajectorySet longLines;
+    for (size_t lineIndex = 0; lineIndex < NUM_LINES; lineIndex++) {
+        if (trajectories.getNumPoints(lineIndex) >= 2) {
+            longLines.addTrajectory(trajectories.getPositions(lineIndex), { trajectories.getAttribute(lineIndex, 0) });
+        }
+    }
+    BinaryMeshTableOfContents tableOfContents;
+    std::vector<std::string> criterionNames;
+    if (writeBinLinesFile(binLinesFilename, longLines, {}, BinLinesWriteSettings())
+            && convertTrajectoryDataToBinaryLineMesh(trajectoryType, binLinesFilename, meshFilename,
+                    SpatialReorderSettings(), nullptr, { 2 })) {
+        if (readBinaryMeshTableOfContents(meshFilename, tableOfContents)) {
+            for (const BinaryMeshSectionInfo &sectionInfo : tableOfContents.sections) {
+                if (sectionInfo.sectionType == BINMESH_SECTION_ATTRIBUTE && sectionInfo.numComponents == 1) {
+                    criterionNames.push_back(sectionInfo.name);
+                }
+            }
+        }
+    }
+    checks.check(criterionNames == std::vector<std::string>{ "vertexAttribute2" }, "conversion");
+
+    // The criteria are computed on the positions as stored in the file, i.e., before the rings are normalized.
+    std::vector<float> storedSegmentLengths(longLines.getNumPoints());
+    computeImportanceCriterion(IMPORTANCE_CRITERION_KERNEL_SEGMENT_LENGTH, longLines, storedSegmentLengths.data());
+    TrajectorySet normalizedLines = loadTrajectorySetFromFile(binLinesFilename, TRAJECTORY_TYPE_RINGS, { 2 });
+    checks.check(normalizedLines.getNumAttributes() == 1 && normalizedLines.attributes.at(0) == storedSegmentLengths
+            && normalizedLines.positions != longLines.positions, "unnormalized positions");
+    remove(binLinesFilename.c_str());
+    remove(meshFilename.c_str());
+
+    std::string details = std::to_string(NUM_KERNELS) + " kernels on " + std::to_string(trajectories.getNumPoints())
+            + " points, max. error " + toStringPrecise(maxError);
+    checks.report(suite, "Importance criteria", details);
+}
+
+
+/// @return The content of the file (empty if it can't be read).
+static uint64_t alignToSections(uint64_t size)
+{
+    return (size + BINMESH_SECTION_ALIGNMENT - 1) / BINMESH_SECTION_ALIGNMENT * BINMESH_SECTION_ALIGNMENT;
+}
+
+/// @return The size of the section table of the .binmesh file content (including the alignment padding).
+static uint64_t getAlignedSectionTableSize(const std::vector<uint8_t> &content)
+{
+    BinaryMeshFileHeader header;
+    memcpy(&header, content.data(), sizeof(BinaryMeshFileHeader));
+    return alignToSections(header.sectionTableSize);
+}
+
+/**
+ * @return The number of bytes of the .binmesh file content neither the header nor the section table refers to. The
+ * alignment padding behind the sections and the section table counts as part of them.
+ */
+static uint64_t getNumUnreachableBytes(const std::vector<uint8_t> &content)
+{
+    BinaryMeshFileHeader header;
+    memcpy(&header, content.data(), sizeof(BinaryMeshFileHeader));
+    uint64_t numReachableBytes = alignToSections(sizeof(BinaryMeshFileHeader)) + getAlignedSectionTableSize(content);
+    for (uint32_t i = 0; i < header.numSections; i++) {
+        BinaryMeshSectionEntry entry;
+        memcpy(&entry, content.data() + header.sectionTableOffset + i * sizeof(BinaryMeshSectionEntry),
+                sizeof(BinaryMeshSectionEntry));
+        numReachableBytes += alignToSections(entry.dataSize);
+    }
+    return alignToSections(content.size()) - numReachableBytes;
+}
+
+/// @return The names of the vertex attributes of the first submesh in the order of the section table.
+static std::vector<std::string> getAttributeNames(const std::string &filename)
+{
+    std::vector<std::string> attributeNames;
+    BinaryMeshTableOfContents tableOfContents;
+    if (readBinaryMeshTableOfContents(filename, tableOfContents)) {
+        for (const BinaryMeshSectionInfo &sectionInfo : tableOfContents.sections) {
+            if (sectionInfo.sectionType == BINMESH_SECTION_ATTRIBUTE && sectionInfo.submeshIndex == 0) {
+                attributeNames.push_back(sectionInfo.name);
+            }
+        }
+    }
+    return attributeNames;
+}
+
+/// @return True if both files can be opened (verifying all checksums) and store the same attribute.
+static bool isAttributeEqual(const std::string &filenameA, const std::string &filenameB, const std::string &name)
+{
+    MappedBinaryMesh meshA, meshB;
+    return meshA.open(filenameA, true) && meshB.open(filenameB, true) && !meshA.submeshes.empty()
+            && !meshB.submeshes.empty() && isAttributeViewEqual(meshA.submeshes.front(), meshB.submeshes.front(), name);
+}
+
+void validateBinaryMeshAppend(BenchmarkSuite &suite, const std::vector<int> &threadCounts,
+        const std::string &directory)
+{
+    // Random walks with degenerate segments, invalid points and lines with less than two (valid) points, i.e., lines
+    // and line points the converters skip.
+    const size_t NUM_LINES = 200;
+    std::mt19937 generator(47);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> lengthDistribution(0, 200);
+    TrajectorySet trajectories;
+    trajectories.clear(1);
+    for (size_t lineIndex = 0; lineIndex < NUM_LINES; lineIndex++) {
+        Trajectory trajectory;
+        trajectory.attributes.resize(1);
+        glm::vec3 position(distribution(generator), distribution(generator), distribution(generator));
+        int numPoints = lineIndex % 40 == 9 ? int(lineIndex % 3) : lengthDistribution(generator);
+        for (int i = 0; i < numPoints; i++) {
+            if (lineIndex % 10 != 3 || i % 13 != 5) {
+                position += 0.01f * glm::vec3(
+                        distribution(generator), distribution(generator), distribution(generator));
+            }
+            bool isInvalid = lineIndex % 25 == 11 && i % 7 == 2;
+            trajectory.positions.push_back(isInvalid ? glm::vec3(1e11f) : position);
+            trajectory.attributes.at(0).push_back(distribution(generator));
+        }
+        trajectories.addTrajectory(trajectory);
+    }
+    // The same lines without the first one (i.e., with a different vertex layout).
+    TrajectorySet otherTrajectories;
+    for (size_t lineIndex = 1; lineIndex < NUM_LINES; lineIndex++) {
+        otherTrajectories.addTrajectory(
+                trajectories.getPositions(lineIndex), { trajectories.getAttribute(lineIndex, 0) });
+    }
+
+    ValidationChecks checks;
+
+    const TrajectoryType trajectoryType = TRAJECTORY_TYPE_CONVECTION_ROLLS;
+    const float lineRadius = 0.002f;
+    const std::string binLinesFilename = directory + "validation_append.binlines";
+    const std::string otherBinLinesFilename = directory + "validation_append_other.binlines";
+    const std::string convertedFilename = directory + "validation_append_converted.binmesh";
+    const std::string appendedFilename = directory + "validation_append_appended.binmesh";
+    const std::string expectedFilename = directory + "validation_append_expected.binmesh";
+    const std::string meshletFilename = directory + "validation_append_meshlets.binmesh";
+    const std::string expectedMeshletFilename = directory + "validation_append_meshlets_expected.binmesh";
+    if (!writeBinLinesFile(binLinesFilename, trajectories, {}, BinLinesWriteSettings())
+            || !writeBinLinesFile(otherBinLinesFilename, otherTrajectories, {}, BinLinesWriteSettings())) {
+        suite.addValidationResult("Binary mesh append", false, "could not write the trajectories");
+        return;
+    }
+
+    // Line mesh: Appending two criteria to the mesh converted for the first one must result in the same attributes
+    // as converting the mesh with all three criteria. Nothing stored before is modified except for the header.
+    size_t numBytesAppended = 0;
+    checks.check(convertTrajectoryDataToBinaryLineMesh(trajectoryType, binLinesFilename, convertedFilename,
+            SpatialReorderSettings(), nullptr, { 0 })
+            && convertTrajectoryDataToBinaryLineMesh(trajectoryType, binLinesFilename, expectedFilename,
+                    SpatialReorderSettings(), nullptr, { 0, 1, 2 }), "conversion");
+    const std::vector<uint8_t> convertedContent = readFileContent(convertedFilename);
+    std::vector<uint8_t> firstAppendedContent;
+    for (size_t t = 0; t < threadCounts.size(); t++) {
+        BenchmarkSuite::setNumThreads(threadCounts.at(t));
+        writeFileContent(appendedFilename, convertedContent);
+        bool appended = appendImportanceCriteriaToBinaryMesh(
+                trajectoryType, binLinesFilename, appendedFilename, { 2, 1 });
+        std::vector<uint8_t> appendedContent = readFileContent(appendedFilename);
+        if (t == 0) {
+            checks.check(appended, "line append");
+            firstAppendedContent = appendedContent;
+        } else {
+            checks.check(appended && appendedContent == firstAppendedContent, "thread count");
+        }
+    }
+    checks.check(getAttributeNames(appendedFilename) == std::vector<std::string>{
+            "vertexPosition", "vertexLineNormal", "vertexLineTangent", "vertexAttribute0", "vertexAttribute2",
+            "vertexAttribute1" }, "table of contents");
+    checks.check(isAttributeEqual(appendedFilename, expectedFilename, "vertexAttribute1")
+            && isAttributeEqual(appendedFilename, expectedFilename, "vertexAttribute2")
+            && isAttributeEqual(appendedFilename, expectedFilename, "vertexPosition"), "line attributes");
+    checks.check(convertedContent.size() > sizeof(BinaryMeshFileHeader)
+            && firstAppendedContent.size() > convertedContent.size()
+            && std::equal(convertedContent.begin() + sizeof(BinaryMeshFileHeader), convertedContent.end(),
+                    firstAppendedContent.begin() + sizeof(BinaryMeshFileHeader)), "unchanged sections");
+    numBytesAppended = firstAppendedContent.size() - convertedContent.size();
+    checks.check(appendImportanceCriteriaToBinaryMesh(trajectoryType, binLinesFilename, appendedFilename, { 1 })
+            && readFileContent(appendedFilename) == firstAppendedContent, "stored criteria skipped");
+
+    // The replaced section tables stay behind as the only unreachable bytes of the file (one per append).
+    writeFileContent(appendedFilename, convertedContent);
+    bool appendedTwice = appendImportanceCriteriaToBinaryMesh(
+            trajectoryType, binLinesFilename, appendedFilename, { 2 });
+    const std::vector<uint8_t> onceAppendedContent = readFileContent(appendedFilename);
+    appendedTwice = appendedTwice && appendImportanceCriteriaToBinaryMesh(
+            trajectoryType, binLinesFilename, appendedFilename, { 1 });
+    const std::vector<uint8_t> twiceAppendedContent = readFileContent(appendedFilename);
+    checks.check(appendedTwice && getNumUnreachableBytes(convertedContent) == 0
+            && getNumUnreachableBytes(onceAppendedContent) == getAlignedSectionTableSize(convertedContent)
+            && getNumUnreachableBytes(twiceAppendedContent) == getAlignedSectionTableSize(convertedContent)
+                    + getAlignedSectionTableSize(onceAppendedContent)
+            && isAttributeEqual(appendedFilename, expectedFilename, "vertexAttribute1")
+            && isAttributeEqual(appendedFilename, expectedFilename, "vertexAttribute2"), "file growth");
+
+    // The layout of the mesh doesn't match other trajectories, and the file must stay unchanged.
+    writeFileContent(appendedFilename, convertedContent);
+    checks.check(!appendImportanceCriteriaToBinaryMesh(trajectoryType, otherBinLinesFilename, appendedFilename, { 1 })
+            && readFileContent(appendedFilename) == convertedContent, "mismatched trajectories");
+    BinaryMeshAttributeView attribute;
+    attribute.name = "vertexAttribute1";
+    attribute.attributeFormat = sgl::ATTRIB_UNSIGNED_SHORT;
+    attribute.numComponents = 1;
+    std::vector<uint16_t> tooShort(10, 0);
+    attribute.data = (const uint8_t*)tooShort.data();
+    attribute.dataSize = tooShort.size() * sizeof(uint16_t);
+    BinaryMeshAppendedAttribute appendedAttribute;
+    appendedAttribute.submeshIndex = 0;
+    appendedAttribute.attribute = attribute;
+    checks.check(!appendBinaryMeshAttributes(appendedFilename, { appendedAttribute })
+            && readFileContent(appendedFilename) == convertedContent, "vertex count");
+
+    // Without vertex positions, the number of vertices can't be checked (not even for an empty attribute).
+    BinaryMesh positionlessMesh;
+    positionlessMesh.submeshes.resize(1);
+    positionlessMesh.submeshes.front().vertexMode = sgl::VERTEX_MODE_POINTS;
+    positionlessMesh.submeshes.front().attributes.resize(1);
+    BinaryMeshAttribute &positionlessAttribute = positionlessMesh.submeshes.front().attributes.front();
+    positionlessAttribute.name = "vertexAttribute0";
+    positionlessAttribute.attributeFormat = sgl::ATTRIB_UNSIGNED_SHORT;
+    positionlessAttribute.numComponents = 1;
+    positionlessAttribute.data.resize(attribute.dataSize);
+    appendedAttribute.attribute.dataSize = 0;
+    bool positionlessWritten = writeMesh3D(appendedFilename, positionlessMesh);
+    const std::vector<uint8_t> positionlessContent = readFileContent(appendedFilename);
+    checks.check(positionlessWritten && !appendBinaryMeshAttributes(appendedFilename, { appendedAttribute })
+            && readFileContent(appendedFilename) == positionlessContent, "missing vertex positions");
+
+    // Spatially reordered line mesh (the vertex order is reproduced from the header flags).
+    SpatialReorderSettings reorderSettings;
+    reorderSettings.curve = SPACE_FILLING_CURVE_HILBERT;
+    convertTrajectoryDataToBinaryLineMesh(trajectoryType, binLinesFilename, appendedFilename,
+            reorderSettings, nullptr, { 0 });
+    convertTrajectoryDataToBinaryLineMesh(trajectoryType, binLinesFilename, expectedFilename,
+            reorderSettings, nullptr, { 0, 2 });
+    checks.check(appendImportanceCriteriaToBinaryMesh(trajectoryType, binLinesFilename, appendedFilename, { 2 })
+            && isAttributeEqual(appendedFilename, expectedFilename, "vertexAttribute2"), "reordered lines");
+
+    // Tube mesh with and without meshlets. Reordered tube meshes are rejected.
+    convertTrajectoryDataToBinaryTriangleMesh(trajectoryType, binLinesFilename, appendedFilename, lineRadius,
+            SpatialReorderSettings(), nullptr, { 0 });
+    convertTrajectoryDataToBinaryTriangleMesh(trajectoryType, binLinesFilename, expectedFilename, lineRadius,
+            SpatialReorderSettings(), nullptr, { 0, 1 });
+    convertBinaryMeshToMeshlets(appendedFilename, meshletFilename);
+    convertBinaryMeshToMeshlets(expectedFilename, expectedMeshletFilename);
+    checks.check(appendImportanceCriteriaToBinaryMesh(trajectoryType, binLinesFilename, appendedFilename, { 1 })
+            && isAttributeEqual(appendedFilename, expectedFilename, "vertexAttribute1"), "tube attributes");
+    checks.check(appendImportanceCriteriaToBinaryMesh(trajectoryType, binLinesFilename, meshletFilename, { 1 })
+            && isAttributeEqual(meshletFilename, expectedMeshletFilename, "vertexAttribute1"), "meshlets");
+    convertTrajectoryDataToBinaryTriangleMesh(trajectoryType, binLinesFilename, appendedFilename, lineRadius,
+            reorderSettings, nullptr, { 0 });
+    checks.check(!appendImportanceCriteriaToBinaryMesh(trajectoryType, binLinesFilename, appendedFilename, { 1 }),
+            "reordered tubes");
+
+    // Artifacts of a conversion cache are appended to in place, and the manifest records the new size.
+    ConversionCache cache(directory + "ValidationAppendCache/");
+    cache.clear();
+    ConversionCacheKey key("trajectories_line_mesh", ".binmesh");
+    key.addSourceFile(binLinesFilename);
+    std::string artifactPath = cache.getArtifact(key, [&](const std::string &outputFilename) {
+        return convertTrajectoryDataToBinaryLineMesh(trajectoryType, binLinesFilename, outputFilename,
+                SpatialReorderSettings(), nullptr, { 0 });
+    });
+    checks.check(!artifactPath.empty() && cache.updateArtifact(artifactPath, [&](const std::string &artifactFilename) {
+        return appendImportanceCriteriaToBinaryMesh(trajectoryType, binLinesFilename, artifactFilename, { 1 });
+    }) && cache.getTotalSize() == readFileContent(artifactPath).size()
+            && getAttributeNames(artifactPath).back() == "vertexAttribute1", "cache update");
+    cache.clear();
+
+    const std::string filenames[] = { binLinesFilename, otherBinLinesFilename, convertedFilename, appendedFilename,
+            expectedFilename, meshletFilename, expectedMeshletFilename };
+    for (const std::string &filename : filenames) {
+        remove(filename.c_str());
+    }
+
+    std::string details = std::to_string(trajectories.getNumPoints()) + " points, "
+            + std::to_string(numBytesAppended) + " bytes appended";
+    checks.report(suite, "Binary mesh append", details);
+}
+
+
+void validateTubeRenderData(BenchmarkSuite &suite, const std::vector<int> &threadCounts)
+{
+    // Random walks (like hair strands) with colors, including lines with less than two points, closed lines, lines with
+    // repeated points and lines with only one tube node.
+    const size_t NUM_LINES = 2000;
+    std::mt19937 generator(11);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> lengthDistribution(2, 60);
+    std::vector<std::vector<glm::vec3>> linesPoints(NUM_LINES);
+    std::vector<std::vector<uint32_t>> linesColors(NUM_LINES);
+    for (size_t lineIndex = 0; lineIndex < NUM_LINES; lineIndex++) {
+        std::vector<glm::vec3> &points = linesPoints.at(lineIndex);
+        glm::vec3 position(distribution(generator), distribution(generator), distribution(generator));
+        int numPoints = lineIndex % 50 == 7 ? int(lineIndex % 3) : lengthDistribution(generator);
+        for (int i = 0; i < numPoints; i++) {
+            if (lineIndex % 10 != 3 || i % 5 != 2) {
+                position += 0.01f * glm::vec3(
+                        distribution(generator), distribution(generator), distribution(generator));
+            }
+            if (lineIndex % 50 == 21) {
+                // Only one tube node
+                position = points.empty() ? position : points.front();
+            }
+            points.push_back(position);
+            linesColors.at(lineIndex).push_back(uint32_t(generator()));
+        }
+        if (lineIndex % 50 == 13 && numPoints > 2) {
+            points.back() = points.front();
+        }
+    }
+    std::vector<ArrayView<const glm::vec3>> linesCenters(linesPoints.begin(), linesPoints.end());
+    std::vector<ArrayView<const uint32_t>> linesAttributes(linesColors.begin(), linesColors.end());
+    initializeCircleData(NUM_CIRCLE_SEGMENTS, 0.001f);
+
+    // Serial reference: The tubes of the lines are created one after another and appended to the global arrays (like
+    // the previous hair conversion loop).
+    BenchmarkSuite::setNumThreads(1);
+    std::vector<glm::vec3> expectedVertices, expectedNormals;
+    std::vector<uint32_t> expectedColors, expectedIndices;
+    for (size_t lineIndex = 0; lineIndex < NUM_LINES; lineIndex++) {
+        std::vector<glm::vec3> localVertices, localNormals;
+        std::vector<uint32_t> localColors, localIndices;
+        createTubeRenderData<uint32_t>({ linesCenters.at(lineIndex) }, { linesAttributes.at(lineIndex) },
+                localVertices, localNormals, localColors, localIndices);
+        for (uint32_t index : localIndices) {
+            expectedIndices.push_back(index + uint32_t(expectedVertices.size()));
+        }
+        expectedVertices.insert(expectedVertices.end(), localVertices.begin(), localVertices.end());
+        expectedNormals.insert(expectedNormals.end(), localNormals.begin(), localNormals.end());
+        expectedColors.insert(expectedColors.end(), localColors.begin(), localColors.end());
+    }
+
+    ValidationChecks checks;
+    for (int numThreads : threadCounts) {
+        BenchmarkSuite::setNumThreads(numThreads);
+        std::vector<glm::vec3> vertices, normals;
+        std::vector<uint32_t> colors, indices;
+        createTubeRenderData(linesCenters, linesAttributes, vertices, normals, colors, indices);
+        checks.check(isBitwiseEqual(vertices, expectedVertices) && isBitwiseEqual(normals, expectedNormals)
+                && isBitwiseEqual(colors, expectedColors) && isBitwiseEqual(indices, expectedIndices),
+                std::to_string(numThreads) + " threads");
+        // Without attributes, only the attributes are missing.
+        std::vector<uint32_t> noColors;
+        createTubeRenderData(linesCenters, std::vector<ArrayView<const uint32_t>>(), vertices, normals, noColors,
+                indices);
+        checks.check(noColors.empty() && isBitwiseEqual(vertices, expectedVertices)
+                && isBitwiseEqual(indices, expectedIndices),
+                std::to_string(numThreads) + " threads without attributes");
+    }
+
+    std::string details = std::to_string(NUM_LINES) + " lines, " + std::to_string(expectedVertices.size())
+            + " vertices, " + std::to_string(expectedIndices.size() / 3) + " triangles";
+    checks.report(suite, "Tube render data", details);
+}
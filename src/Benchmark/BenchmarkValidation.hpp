@@ -0,0 +1,87 @@
+#ifndef PIXELSYNCOIT_BENCHMARKVALIDATION_HPP
+#define PIXELSYNCOIT_BENCHMARKVALIDATION_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "BenchmarkSuite.hpp"
+
+/*
+ * Checks of the optimized CPU kernels against simple reference implementations on synthetic data.
+ * Kernels that promise results independent of the number of threads are run with all passed thread counts and the
+ * results are compared bitwise. The results are added to the suite (see BenchmarkSuite::addValidationResult).
+ * The checks of larger components are implemented in Validation<Component>.cpp, the others in BenchmarkValidation.cpp.
+ */
+
+/// Creates a smooth RGBA8 test image and a copy of it with deterministic Gaussian noise (also used by the benchmark).
+void createSyntheticImagePair(int width, int height, std::vector<uint8_t> &expected, std::vector<uint8_t> &observed);
+
+/// Compares the k-nearest neighbor, radius, rectangle and closest point queries of KDTree with a brute-force search on
+/// random points and on points snapped to a grid.
+void validateKDTree(BenchmarkSuite &suite, const std::vector<int> &threadCounts);
+/// Checks computeNormals on a height field mesh (unit length, orientation, independence of the thread count).
+void validateComputeNormals(BenchmarkSuite &suite, const std::vector<int> &threadCounts);
+/// Compares computeSSIM with computeSSIMReference for both window types, and MSE, PSNR, luminance, SSIM maps,
+/// MS-SSIM and difference maps on RGBA8 and float buffers with naive implementations.
+void validateImageMetrics(BenchmarkSuite &suite, const std::vector<int> &threadCounts);
+/// Checks the warm-up detection and the early stopping of FrameTimeStatistics on a synthetic timing series.
+void validateFrameTimeStatistics(BenchmarkSuite &suite, const std::vector<int> &threadCounts);
+/// Round trip of random lines through version 1 and (compressed) version 2 .binlines files in the passed directory.
+void validateBinLinesFile(BenchmarkSuite &suite, const std::vector<int> &threadCounts, const std::string &directory);
+/// Round trip of a mesh through version 5 and version 4 .binmesh files in the passed directory (readMesh3D and
+/// selective loading with MappedBinaryMesh), and rejection of a corrupt section and section table.
+void validateBinaryMeshReader(BenchmarkSuite &suite, const std::string &directory);
+/// Exhaustive round trip of all 65536 unorm16 codes and comparison of the unorm16 kernels with the previous functions.
+void validateUnorm16(BenchmarkSuite &suite, const std::vector<int> &threadCounts);
+/// Compares preprocessSubmesh with the previous serial preprocessing of parseMesh3D for all rendering modes.
+void validateMeshPreprocessing(BenchmarkSuite &suite, const std::vector<int> &threadCounts);
+/// Checks that RandomPermutation is a bijection, the shuffle functions keep all primitives (and lines) intact and the
+/// results only depend on the seed.
+void validateShuffle(BenchmarkSuite &suite, const std::vector<int> &threadCounts);
+/// Checks the space-filling curves (Hilbert curve locality, 64-bit radix sort) and that reorderMeshClusters keeps all
+/// primitives intact and reduces the simulated cache misses of a grid mesh with shuffled clusters.
+void validateSpatialReordering(BenchmarkSuite &suite, const std::vector<int> &threadCounts);
+/// Checks the meshlets of a tube and a line mesh (partition, bounds, round trip through a .binmesh file in the passed
+/// directory) and that cullMeshlets never culls a visible primitive for random cameras.
+void validateMeshlets(BenchmarkSuite &suite, const std::vector<int> &threadCounts, const std::string &directory);
+
+/// Checks the keys (parameters, source content), hits and misses, LRU eviction and concurrent writers of a
+/// ConversionCache in a subdirectory of the passed directory.
+void validateConversionCache(BenchmarkSuite &suite, const std::vector<int> &threadCounts, const std::string &directory);
+/// Checks the table of contents and the selective loading of a .binmesh file in the passed directory (the selected and
+/// on demand loaded importance criteria must match the full load in all rendering modes).
+void validateSelectiveLoading(BenchmarkSuite &suite, const std::vector<int> &threadCounts,
+        const std::string &directory);
+
+/// Compares the importance criterion kernels with the previous per-line functions and checks that the registry and
+/// the line mesh conversion (in the passed directory) only compute the requested criteria.
+void validateImportanceCriteria(BenchmarkSuite &suite, const std::vector<int> &threadCounts,
+        const std::string &directory);
+/// Appends importance criteria to line and tube meshes in the passed directory and compares them with the meshes
+/// converted with all criteria (including mismatched trajectories, reordered meshes and meshlets).
+void validateBinaryMeshAppend(BenchmarkSuite &suite, const std::vector<int> &threadCounts,
+        const std::string &directory);
+/// Compares the parallel createTubeRenderData with the tubes of the lines created one after another (bitwise, for all
+/// thread counts).
+void validateTubeRenderData(BenchmarkSuite &suite, const std::vector<int> &threadCounts);
+/// Compares the separable Gaussian and the running-sum box blur of the voxel AO with the brute-force 3D convolution
+/// (max. absolute difference 1e-5).
+void validateVoxelAO(BenchmarkSuite &suite, const std::vector<int> &threadCounts);
+/// Feeds synthetic frames of reference and non-reference states into ErrorMetricPipeline (the thread counts are used
+/// as numbers of workers) and compares the returned states with metrics computed serially.
+void validateErrorMetricPipeline(BenchmarkSuite &suite, const std::vector<int> &threadCounts);
+/// Compares parseFloat and parseInt with strtof and strtol (bitwise values and consumed characters) on random and
+/// special strings that are not null-terminated.
+void validateNumberParser(BenchmarkSuite &suite);
+/// Compares the chunked loadTrajectorySetFromObj with the serial sscanf loader on a synthetic file with edge cases.
+void validateObjLoader(BenchmarkSuite &suite, const std::vector<int> &threadCounts, const std::string &directory);
+/// Compares the segments, densities and AO factors of the CPU voxelization (also with a small maximum number of lines
+/// per voxel) bitwise with a serial emulation of the GPU shaders, and checks that they are independent of the thread
+/// count.
+void validateVoxelizer(BenchmarkSuite &suite, const std::vector<int> &threadCounts, const std::string &directory);
+/// Writes a synthetic trajectory NetCDF file to the passed directory and compares the chunked loading on the worker
+/// pool (the thread counts are used as numbers of workers) and the .binlines conversion with the whole-file loader.
+void validateNetCdfLoader(BenchmarkSuite &suite, const std::vector<int> &threadCounts, const std::string &directory);
+
+#endif //PIXELSYNCOIT_BENCHMARKVALIDATION_HPP
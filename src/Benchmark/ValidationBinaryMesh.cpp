@@ -0,0 +1,215 @@
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+#include "Utils/MeshSerializer.hpp"
+#include "BenchmarkReferences.hpp"
+#include "ValidationUtils.hpp"
+#include "BenchmarkValidation.hpp"
+
+template<typename T>
+static void setAttributeData(BinaryMeshAttribute &attribute, const std::string &name,
+        sgl::VertexAttributeFormat attributeFormat, uint32_t numComponents, const std::vector<T> &values)
+{
+    attribute.name = name;
+    attribute.attributeFormat = attributeFormat;
+    attribute.numComponents = numComponents;
+    attribute.data.resize(values.size() * sizeof(T));
+    memcpy(attribute.data.data(), values.data(), attribute.data.size());
+}
+
+/// Two submeshes with different vertex modes, numbers of vertices, attributes and uniforms.
+static BinaryMesh createValidationMesh()
+{
+    std::mt19937 generator(23);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    BinaryMesh mesh;
+    mesh.submeshes.resize(2);
+    for (size_t submeshIdx = 0; submeshIdx < mesh.submeshes.size(); submeshIdx++) {
+        BinarySubMesh &submesh = mesh.submeshes.at(submeshIdx);
+        const size_t numVertices = submeshIdx == 0 ? 999 : 1537;
+        submesh.vertexMode = submeshIdx == 0 ? sgl::VERTEX_MODE_TRIANGLES : sgl::VERTEX_MODE_LINES;
+        submesh.material.diffuseColor = glm::vec3(0.25f * float(submeshIdx + 1));
+        submesh.material.opacity = 0.5f;
+        for (size_t i = 0; i + 3 <= numVertices; i++) {
+            submesh.indices.push_back(uint32_t(i));
+            submesh.indices.push_back(uint32_t(i + 1 + submeshIdx));
+        }
+
+        std::vector<glm::vec3> positions(numVertices), normals(numVertices);
+        std::vector<float> attributes(numVertices);
+        for (size_t i = 0; i < numVertices; i++) {
+            positions.at(i) = glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+            normals.at(i) = glm::normalize(positions.at(i) + glm::vec3(0.0f, 2.0f, 0.0f));
+            attributes.at(i) = distribution(generator);
+        }
+        submesh.attributes.resize(3);
+        setAttributeData(submesh.attributes.at(0), "vertexPosition", sgl::ATTRIB_FLOAT, 3, positions);
+        setAttributeData(submesh.attributes.at(1), "vertexNormal", sgl::ATTRIB_FLOAT, 3, normals);
+        setAttributeData(submesh.attributes.at(2), "vertexAttribute0", sgl::ATTRIB_FLOAT, 1, attributes);
+
+        submesh.uniforms.resize(1);
+        BinaryMeshUniform &uniform = submesh.uniforms.front();
+        uniform.name = "maxVorticity";
+        uniform.attributeFormat = sgl::ATTRIB_FLOAT;
+        uniform.numComponents = 1;
+        const float maxVorticity = 3.5f + float(submeshIdx);
+        uniform.data.resize(sizeof(float));
+        memcpy(uniform.data.data(), &maxVorticity, sizeof(float));
+    }
+    return mesh;
+}
+
+template<typename Attribute>
+static bool isAttributeEqual(const Attribute &a, const Attribute &b)
+{
+    return a.name == b.name && a.attributeFormat == b.attributeFormat && a.numComponents == b.numComponents
+            && a.data == b.data;
+}
+
+static bool isBinaryMeshEqual(const BinaryMesh &a, const BinaryMesh &b)
+{
+    if (a.submeshes.size() != b.submeshes.size()) {
+        return false;
+    }
+    for (size_t submeshIdx = 0; submeshIdx < a.submeshes.size(); submeshIdx++) {
+        const BinarySubMesh &submeshA = a.submeshes.at(submeshIdx);
+        const BinarySubMesh &submeshB = b.submeshes.at(submeshIdx);
+        if (memcmp(&submeshA.material, &submeshB.material, sizeof(ObjMaterial)) != 0
+                || submeshA.vertexMode != submeshB.vertexMode || submeshA.indices != submeshB.indices
+                || submeshA.attributes.size() != submeshB.attributes.size()
+                || submeshA.uniforms.size() != submeshB.uniforms.size()
+                || !isBitwiseEqual(submeshA.meshlets, submeshB.meshlets)) {
+            return false;
+        }
+        for (size_t i = 0; i < submeshA.attributes.size(); i++) {
+            if (!isAttributeEqual(submeshA.attributes.at(i), submeshB.attributes.at(i))) {
+                return false;
+            }
+        }
+        for (size_t i = 0; i < submeshA.uniforms.size(); i++) {
+            if (!isAttributeEqual(submeshA.uniforms.at(i), submeshB.uniforms.at(i))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool isAttributeViewEqual(const BinaryMeshAttributeView &a, const BinaryMeshAttributeView &b)
+{
+    return a.name == b.name && a.attributeFormat == b.attributeFormat && a.numComponents == b.numComponents
+            && a.dataSize == b.dataSize && (a.dataSize == 0 || memcmp(a.data, b.data, a.dataSize) == 0);
+}
+
+/// @return True if the selected parts of a version 4 and a version 5 file are exposed equally.
+static bool isSubmeshViewEqual(const BinarySubMeshView &a, const BinarySubMeshView &b)
+{
+    if (memcmp(&a.material, &b.material, sizeof(ObjMaterial)) != 0 || a.vertexMode != b.vertexMode
+            || a.numIndices != b.numIndices || a.attributes.size() != b.attributes.size()
+            || a.uniforms.size() != b.uniforms.size()
+            || (a.numIndices > 0 && memcmp(a.indices, b.indices, a.numIndices * sizeof(uint32_t)) != 0)) {
+        return false;
+    }
+    for (size_t i = 0; i < a.attributes.size(); i++) {
+        if (!isAttributeViewEqual(a.attributes.at(i), b.attributes.at(i))) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < a.uniforms.size(); i++) {
+        if (!isAttributeViewEqual(a.uniforms.at(i), b.uniforms.at(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void validateBinaryMeshReader(BenchmarkSuite &suite, const std::string &directory)
+{
+    const std::string filename = directory + "validation_reader.binmesh";
+    const std::string legacyFilename = directory + "validation_reader_v4.binmesh";
+    const std::string corruptFilename = directory + "validation_reader_corrupt.binmesh";
+    const BinaryMesh mesh = createValidationMesh();
+    ValidationChecks checks;
+
+    // Round trip through both format versions.
+    BinaryMesh readMesh;
+    MappedBinaryMesh mappedMesh, legacyMappedMesh;
+    bool written = checks.check(writeMesh3D(filename, mesh), "write");
+    checks.check(written && readMesh3D(filename, readMesh) && isBinaryMeshEqual(readMesh, mesh)
+            && mappedMesh.open(filename, true) && mappedMesh.getFormatVersion() == MESH_FORMAT_VERSION,
+            "version 5 round trip");
+    bool legacyWritten = checks.check(writeMesh3DVersion4Reference(legacyFilename, mesh), "write version 4");
+    readMesh = BinaryMesh();
+    checks.check(legacyWritten && readMesh3D(legacyFilename, readMesh) && isBinaryMeshEqual(readMesh, mesh)
+            && legacyMappedMesh.open(legacyFilename, true)
+            && legacyMappedMesh.getFormatVersion() == MESH_FORMAT_VERSION_LEGACY, "version 4 round trip");
+    BinaryMeshTableOfContents tableOfContents;
+    checks.check(!readBinaryMeshTableOfContents(legacyFilename, tableOfContents), "version 4 table of contents");
+
+    // The selection is applied to version 4 files after reading them completely, i.e., the same parts are exposed.
+    BinaryMeshSelection selection;
+    selection.submeshIndices = { 1 };
+    selection.attributeNames = { "vertexAttribute0", "vertexPosition" };
+    selection.loadIndices = false;
+    MappedBinaryMesh selectedMesh, legacySelectedMesh;
+    bool selectionOpened = selectedMesh.open(filename, selection, true)
+            && legacySelectedMesh.open(legacyFilename, selection, true);
+    checks.check(selectionOpened && selectedMesh.submeshes.size() == 1 && legacySelectedMesh.submeshes.size() == 1
+            && selectedMesh.submeshes.front().numIndices == 0
+            && selectedMesh.submeshes.front().attributes.size() == 2
+            && selectedMesh.submeshes.front().attributes.front().name == "vertexPosition"
+            && isSubmeshViewEqual(selectedMesh.submeshes.front(), legacySelectedMesh.submeshes.front()),
+            "version 4 selection");
+
+    // A flipped byte in the data of the attribute "vertexNormal" of the first submesh.
+    std::vector<uint8_t> content = readFileContent(filename);
+    size_t corruptOffset = 0;
+    if (mappedMesh.isOpen() && mappedMesh.submeshes.size() == 2
+            && mappedMesh.submeshes.front().attributes.size() == 3) {
+        const BinaryMeshAttributeView &attribute = mappedMesh.submeshes.front().attributes.at(1);
+        corruptOffset = size_t(attribute.data - mappedMesh.getMappedFile()->getData()) + attribute.dataSize / 2;
+    }
+    mappedMesh.close();
+    bool corruptWritten = corruptOffset != 0 && corruptOffset < content.size();
+    if (corruptWritten) {
+        content.at(corruptOffset) ^= 0x10u;
+        corruptWritten = writeFileContent(corruptFilename, content);
+    }
+    checks.check(corruptWritten, "write corrupt file");
+
+    // The corruption is detected whenever the section is verified, and sections that are not selected aren't read.
+    readMesh = BinaryMesh();
+    MappedBinaryMesh corruptMesh;
+    checks.check(corruptWritten && !readMesh3D(corruptFilename, readMesh) && readMesh.submeshes.empty()
+            && !corruptMesh.open(corruptFilename, true) && !corruptMesh.isOpen(), "corrupt section rejected");
+    BinaryMeshSelection otherSubmeshSelection;
+    otherSubmeshSelection.submeshIndices = { 1 };
+    checks.check(corruptWritten && corruptMesh.open(corruptFilename, otherSubmeshSelection, true),
+            "unselected corrupt section ignored");
+    corruptMesh.close();
+    checks.check(corruptWritten && corruptMesh.open(corruptFilename, false), "unverified open");
+    corruptMesh.close();
+
+    // The section table is always verified.
+    if (corruptWritten) {
+        content.at(corruptOffset) ^= 0x10u;
+        BinaryMeshFileHeader header;
+        memcpy(&header, content.data(), sizeof(BinaryMeshFileHeader));
+        content.at(header.sectionTableOffset + header.sectionTableSize - 1) ^= 0x01u;
+        corruptWritten = writeFileContent(corruptFilename, content);
+    }
+    checks.check(corruptWritten && !corruptMesh.open(corruptFilename, false)
+            && !readBinaryMeshTableOfContents(corruptFilename, tableOfContents), "corrupt section table rejected");
+
+    legacyMappedMesh.close();
+    selectedMesh.close();
+    legacySelectedMesh.close();
+    remove(filename.c_str());
+    remove(legacyFilename.c_str());
+    remove(corruptFilename.c_str());
+
+    checks.report(suite, "Binary mesh reader", std::to_string(mesh.submeshes.size())
+            + " submeshes written as version 5 and version 4 files and read with readMesh3D and MappedBinaryMesh, "
+            + "corrupt section and section table");
+}
@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <map>
+
+#include <glm/glm.hpp>
+
+#include "Performance/ReferenceMetric.hpp"
+#include "Performance/ErrorMetricPipeline.hpp"
+#include "ValidationUtils.hpp"
+#include "BenchmarkValidation.hpp"
+
+/// Returns a copy of the RGBA8 image with all color values shifted by the passed offset (clamped to [0,255]).
+static sgl::BitmapPtr createShiftedBitmap(int width, int height, const std::vector<uint8_t> &pixels, int offset)
+{
+    sgl::BitmapPtr bitmap(new sgl::Bitmap);
+    bitmap->allocate(width, height, 32);
+    uint8_t *bitmapPixels = bitmap->getPixels();
+    for (size_t i = 0; i < pixels.size(); i++) {
+        bitmapPixels[i] = i % 4 == 3 ? pixels[i] : uint8_t(glm::clamp(int(pixels[i]) + offset, 0, 255));
+    }
+    return bitmap;
+}
+
+static bool isFrameErrorMetricsEqual(const FrameErrorMetrics &a, const FrameErrorMetrics &b)
+{
+    return a.frameNumber == b.frameNumber && a.mse == b.mse && a.rmse == b.rmse && a.psnr == b.psnr
+            && a.ssim == b.ssim;
+}
+
+void validateErrorMetricPipeline(BenchmarkSuite &suite, const std::vector<int> &threadCounts)
+{
+    // The frames are shifted in brightness by their number, such that frames can't be mixed up unnoticed.
+    const int WIDTH = 64, HEIGHT = 48;
+    const uint32_t NUM_FRAMES = 12;
+    std::vector<uint8_t> clearPixels, noisyPixels;
+    createSyntheticImagePair(WIDTH, HEIGHT, clearPixels, noisyPixels);
+
+    struct ValidationState {
+        std::string name;
+        bool isReference;
+        const std::vector<uint8_t> *pixels;
+        int brightnessOffset;
+        std::vector<uint32_t> frameNumbers;
+        std::vector<sgl::BitmapPtr> frames;
+    };
+    std::vector<ValidationState> states(5);
+    states.at(0).name = "Depth peeling 1";
+    states.at(0).isReference = true;
+    states.at(0).pixels = &clearPixels;
+    states.at(0).brightnessOffset = 0;
+    states.at(1).name = "Noisy, reversed frame order";
+    states.at(1).isReference = false;
+    states.at(1).pixels = &noisyPixels;
+    states.at(1).brightnessOffset = 1;
+    states.at(2).name = "Same as reference";
+    states.at(2).isReference = false;
+    states.at(2).pixels = &clearPixels;
+    states.at(2).brightnessOffset = 0;
+    states.at(3).name = "Depth peeling 2";
+    states.at(3).isReference = true;
+    states.at(3).pixels = &noisyPixels;
+    states.at(3).brightnessOffset = 0;
+    states.at(4).name = "Frames without reference";
+    states.at(4).isReference = false;
+    states.at(4).pixels = &clearPixels;
+    states.at(4).brightnessOffset = 4;
+    for (uint32_t frameNumber = 1; frameNumber <= NUM_FRAMES; frameNumber++) {
+        states.at(0).frameNumbers.push_back(frameNumber);
+        states.at(1).frameNumbers.push_back(NUM_FRAMES + 1 - frameNumber);
+        states.at(2).frameNumbers.push_back(frameNumber);
+        if (frameNumber <= NUM_FRAMES / 2) {
+            states.at(3).frameNumbers.push_back(frameNumber);
+        }
+        states.at(4).frameNumbers.push_back(frameNumber);
+    }
+    for (ValidationState &state : states) {
+        for (uint32_t frameNumber : state.frameNumbers) {
+            int offset = int(frameNumber) + state.brightnessOffset;
+            state.frames.push_back(createShiftedBitmap(WIDTH, HEIGHT, *state.pixels, offset));
+        }
+    }
+
+    // The expected metrics are computed serially on the main thread.
+    std::vector<StateErrorMetrics> expectedStates(states.size());
+    std::map<uint32_t, sgl::BitmapPtr> referenceFrames;
+    for (size_t stateIdx = 0; stateIdx < states.size(); stateIdx++) {
+        const ValidationState &state = states.at(stateIdx);
+        expectedStates.at(stateIdx).stateName = state.name;
+        if (state.isReference) {
+            referenceFrames.clear();
+        }
+        for (size_t i = 0; i < state.frames.size(); i++) {
+            const uint32_t frameNumber = state.frameNumbers.at(i);
+            if (state.isReference) {
+                referenceFrames[frameNumber] = state.frames.at(i);
+                continue;
+            }
+            auto it = referenceFrames.find(frameNumber);
+            if (it == referenceFrames.end()) {
+                continue;
+            }
+            FrameErrorMetrics frameMetrics;
+            frameMetrics.frameNumber = frameNumber;
+            frameMetrics.mse = mse(it->second, state.frames.at(i));
+            frameMetrics.rmse = rmse(it->second, state.frames.at(i));
+            frameMetrics.psnr = psnr(it->second, state.frames.at(i));
+            frameMetrics.ssim = ssim(it->second, state.frames.at(i));
+            expectedStates.at(stateIdx).frames.push_back(frameMetrics);
+        }
+        std::sort(expectedStates.at(stateIdx).frames.begin(), expectedStates.at(stateIdx).frames.end(),
+                [](const FrameErrorMetrics &a, const FrameErrorMetrics &b) { return a.frameNumber < b.frameNumber; });
+    }
+
+    // The thread counts are used as the numbers of workers. At most two frames may be pending at a time.
+    ValidationChecks checks;
+    bool statesEqual = true, orderCorrect = true;
+    for (size_t t = 0; t < threadCounts.size(); t++) {
+        ErrorMetricPipeline pipeline(size_t(threadCounts.at(t)), 2);
+        std::vector<StateErrorMetrics> poppedStates;
+        for (size_t stateIdx = 0; stateIdx < states.size(); stateIdx++) {
+            const ValidationState &state = states.at(stateIdx);
+            pipeline.beginState(state.name, state.isReference);
+            for (size_t i = 0; i < state.frames.size(); i++) {
+                pipeline.addFrame(state.frameNumbers.at(i), state.frames.at(i));
+            }
+            StateErrorMetrics stateMetrics;
+            if (stateIdx == 0 && pipeline.popFinishedState(stateMetrics)) {
+                // A state must not be returned before endState was called.
+                orderCorrect = false;
+            }
+            pipeline.endState();
+            while (pipeline.popFinishedState(stateMetrics)) {
+                poppedStates.push_back(stateMetrics);
+            }
+        }
+        pipeline.waitForAll();
+        StateErrorMetrics stateMetrics;
+        while (pipeline.popFinishedState(stateMetrics)) {
+            poppedStates.push_back(stateMetrics);
+        }
+
+        if (poppedStates.size() != expectedStates.size()) {
+            orderCorrect = false;
+            continue;
+        }
+        for (size_t stateIdx = 0; stateIdx < expectedStates.size(); stateIdx++) {
+            const StateErrorMetrics &popped = poppedStates.at(stateIdx);
+            const StateErrorMetrics &expected = expectedStates.at(stateIdx);
+            if (popped.stateName != expected.stateName) {
+                orderCorrect = false;
+            }
+            if (popped.frames.size() != expected.frames.size()) {
+                statesEqual = false;
+                continue;
+            }
+            for (size_t i = 0; i < expected.frames.size(); i++) {
+                statesEqual = statesEqual && isFrameErrorMetricsEqual(popped.frames.at(i), expected.frames.at(i));
+            }
+        }
+    }
+    checks.check(orderCorrect, "state order");
+    checks.check(statesEqual, "metrics");
+    // Sanity checks of the expected metrics themselves (identical frames, frames without reference).
+    checks.check(expectedStates.at(1).frames.size() == NUM_FRAMES
+            && expectedStates.at(4).frames.size() == NUM_FRAMES / 2 && expectedStates.at(2).frames.at(0).mse == 0.0 && expectedStates.at(2).frames.at(0).ssim == 1.0
+            && expectedStates.at(1).frames.at(0).mse > 0.0, "serial reference");
+
+    std::string details = std::to_string(states.size()) + " states with up to " + std::to_string(NUM_FRAMES)
+            + " frames, max. 2 pending frames, SSIM of the noisy state "
+            + toStringPrecise(expectedStates.at(1).frames.at(0).ssim);
+    checks.report(suite, "Error metric pipeline", details);
+}
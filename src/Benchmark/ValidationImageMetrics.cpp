@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include <glm/glm.hpp>
+
+#include "Performance/ImageMetrics.hpp"
+#include "ValidationUtils.hpp"
+#include "BenchmarkValidation.hpp"
+
+void createSyntheticImagePair(int width, int height, std::vector<uint8_t> &expected, std::vector<uint8_t> &observed)
+{
+    std::mt19937 generator(17);
+    std::normal_distribution<float> noise(0.0f, 6.0f);
+    expected.resize(size_t(width) * size_t(height) * 4);
+    observed.resize(expected.size());
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            size_t offset = (size_t(y) * size_t(width) + size_t(x)) * 4;
+            float u = float(x) / float(width), v = float(y) / float(height);
+            float pattern = 0.5f + 0.5f * std::sin(40.0f * u * v + 10.0f * u);
+            float values[3] = { 255.0f * u, 255.0f * pattern, 255.0f * (1.0f - v) };
+            for (int c = 0; c < 3; c++) {
+                expected[offset + c] = uint8_t(values[c]);
+                observed[offset + c] = uint8_t(glm::clamp(values[c] + noise(generator), 0.0f, 255.0f));
+            }
+            expected[offset + 3] = 255;
+            observed[offset + 3] = 255;
+        }
+    }
+}
+
+void validateImageMetrics(BenchmarkSuite &suite, const std::vector<int> &threadCounts)
+{
+    // Small enough for the O(r^2) reference implementation.
+    const int WIDTH = 173, HEIGHT = 91;
+    std::vector<uint8_t> expectedImage, observedImage;
+    createSyntheticImagePair(WIDTH, HEIGHT, expectedImage, observedImage);
+    GrayscaleImage expected, observed;
+    computeLuminance(ImageViewRGBA8(expectedImage.data(), WIDTH, HEIGHT), expected);
+    computeLuminance(ImageViewRGBA8(observedImage.data(), WIDTH, HEIGHT), observed);
+
+    SSIMWindowType windowTypes[] = { SSIM_WINDOW_GAUSSIAN, SSIM_WINDOW_BOX };
+    const char *windowTypeNames[] = { "Gaussian", "box" };
+    for (int windowTypeIdx = 0; windowTypeIdx < 2; windowTypeIdx++) {
+        SSIMSettings settings;
+        settings.windowType = windowTypes[windowTypeIdx];
+        double reference = computeSSIMReference(expected, observed, settings);
+
+        bool passed = true;
+        double firstSSIM = 0.0;
+        forEachThreadCount(threadCounts, [&](size_t t) {
+            double ssim = computeSSIM(expected, observed, settings);
+            if (t == 0) {
+                firstSSIM = ssim;
+            } else if (ssim != firstSSIM) {
+                passed = false;
+            }
+        });
+        double error = std::abs(firstSSIM - reference);
+        passed = passed && error < 1e-5;
+
+        suite.addValidationResult(std::string() + "SSIM (" + windowTypeNames[windowTypeIdx] + " window)", passed,
+                std::string() + "SSIM " + toStringPrecise(firstSSIM) + ", reference " + toStringPrecise(reference)
+                + ", abs. error " + toStringPrecise(error));
+    }
+
+    // The remaining metrics are compared with naive loops, and all outputs must be bitwise equal for all thread counts.
+    const size_t numValues = expectedImage.size();
+    std::vector<float> expectedImageFloat(numValues), observedImageFloat(numValues);
+    uint64_t squaredErrorSum = 0;
+    double squaredErrorSumFloat = 0.0;
+    std::vector<uint8_t> expectedDifferenceMap(numValues);
+    for (size_t i = 0; i < numValues; i++) {
+        expectedImageFloat[i] = float(expectedImage[i]) / 255.0f;
+        observedImageFloat[i] = float(observedImage[i]) / 255.0f;
+        int diff = int(expectedImage[i]) - int(observedImage[i]);
+        squaredErrorSum += uint64_t(diff * diff);
+        double diffFloat = double(expectedImageFloat[i]) - double(observedImageFloat[i]);
+        squaredErrorSumFloat += diffFloat * diffFloat;
+        expectedDifferenceMap[i] = i % 4 == 3 ? uint8_t(255) : uint8_t(std::abs(diff));
+    }
+    const double referenceMSE = double(squaredErrorSum) / double(numValues);
+    const double referenceMSEFloat = squaredErrorSumFloat / double(numValues);
+
+    // A block of blockSize^2 pixels is one box window of radius (blockSize - 1) / 2.
+    const int BLOCK_SIZE = 9;
+    SSIMSettings gaussianSettings, boxSettings;
+    boxSettings.windowType = SSIM_WINDOW_BOX;
+    boxSettings.windowRadius = (BLOCK_SIZE - 1) / 2;
+    GrayscaleImage referenceSSIMMap, referenceBoxSSIMMap;
+    computeSSIMReference(expected, observed, gaussianSettings, &referenceSSIMMap);
+    computeSSIMReference(expected, observed, boxSettings, &referenceBoxSSIMMap);
+
+    ValidationChecks checks;
+    double firstMSE = 0.0, firstMSEFloat = 0.0, firstMSSSIM = 0.0;
+    float maxSSIMMapError = 0.0f, maxBlockSSIMError = 0.0f, maxLuminanceError = 0.0f;
+    std::vector<float> firstSSIMMap, firstBlockSSIMMap;
+    std::vector<uint8_t> firstDifferenceMaps;
+    bool threadIndependent = true;
+    forEachThreadCount(threadCounts, [&](size_t t) {
+        ImageViewFloat expectedView(expectedImageFloat.data(), WIDTH, HEIGHT);
+        ImageViewFloat observedView(observedImageFloat.data(), WIDTH, HEIGHT);
+        double mse = computeMSE(ImageViewRGBA8(expectedImage.data(), WIDTH, HEIGHT),
+                ImageViewRGBA8(observedImage.data(), WIDTH, HEIGHT));
+        double mseFloat = computeMSE(expectedView, observedView);
+        GrayscaleImage luminanceFloat;
+        computeLuminance(expectedView, luminanceFloat);
+        GrayscaleImage ssimMap, blockSSIMMap;
+        computeSSIM(expected, observed, gaussianSettings, &ssimMap);
+        computeBlockSSIMMap(expected, observed, BLOCK_SIZE, blockSSIMMap, boxSettings);
+        double msssim = computeMSSSIM(expected, observed);
+        std::vector<uint8_t> differenceMaps;
+        for (int mode = DIFFERENCE_MAP_RGB_DIFF; mode <= DIFFERENCE_MAP_NORM_BLACK; mode++) {
+            std::vector<uint8_t> differenceMap;
+            computeDifferenceMap(ImageViewRGBA8(expectedImage.data(), WIDTH, HEIGHT),
+                    ImageViewRGBA8(observedImage.data(), WIDTH, HEIGHT), DifferenceMapMode(mode), differenceMap);
+            if (mode == DIFFERENCE_MAP_RGB_DIFF) {
+                checks.check(differenceMap == expectedDifferenceMap, "difference map");
+            }
+            differenceMaps.insert(differenceMaps.end(), differenceMap.begin(), differenceMap.end());
+        }
+
+        if (t == 0) {
+            firstMSE = mse;
+            firstMSEFloat = mseFloat;
+            firstMSSSIM = msssim;
+            firstSSIMMap = ssimMap.values;
+            firstBlockSSIMMap = blockSSIMMap.values;
+            firstDifferenceMaps = differenceMaps;
+            for (size_t i = 0; i < expected.values.size(); i++) {
+                maxLuminanceError = std::max(
+                        maxLuminanceError, std::abs(luminanceFloat.values[i] - expected.values[i]));
+            }
+            if (ssimMap.width != referenceSSIMMap.width || ssimMap.height != referenceSSIMMap.height) {
+                maxSSIMMapError = std::numeric_limits<float>::infinity();
+            } else {
+                for (size_t i = 0; i < ssimMap.values.size(); i++) {
+                    maxSSIMMapError = std::max(
+                            maxSSIMMapError, std::abs(ssimMap.values[i] - referenceSSIMMap.values[i]));
+                }
+            }
+            if (blockSSIMMap.width != WIDTH / BLOCK_SIZE || blockSSIMMap.height != HEIGHT / BLOCK_SIZE) {
+                maxBlockSSIMError = std::numeric_limits<float>::infinity();
+            } else {
+                for (int y = 0; y < blockSSIMMap.height; y++) {
+                    for (int x = 0; x < blockSSIMMap.width; x++) {
+                        float referenceValue = referenceBoxSSIMMap.at(x * BLOCK_SIZE, y * BLOCK_SIZE);
+                        maxBlockSSIMError = std::max(
+                                maxBlockSSIMError, std::abs(blockSSIMMap.at(x, y) - referenceValue));
+                    }
+                }
+            }
+        } else if (mse != firstMSE || mseFloat != firstMSEFloat || msssim != firstMSSSIM
+                || !isBitwiseEqual(ssimMap.values, firstSSIMMap)
+                || !isBitwiseEqual(blockSSIMMap.values, firstBlockSSIMMap)
+                || !isBitwiseEqual(differenceMaps, firstDifferenceMaps)) {
+            threadIndependent = false;
+        }
+    });
+
+    double selfMSSSIM = computeMSSSIM(expected, expected);
+    double psnr = computePSNR(firstMSE, 255.0);
+    checks.check(firstMSE == referenceMSE, "MSE");
+    checks.check(std::abs(firstMSEFloat - referenceMSEFloat) <= 1e-12 * referenceMSEFloat, "MSE (float)");
+    checks.check(std::abs(computePSNR(firstMSEFloat, 1.0) - psnr) <= 1e-4 && std::isinf(computePSNR(0.0, 255.0)),
+            "PSNR");
+    checks.check(maxLuminanceError <= 1e-3f, "luminance (float)");
+    checks.check(maxSSIMMapError <= 1e-5f, "SSIM map");
+    checks.check(maxBlockSSIMError <= 1e-5f, "block SSIM map");
+    checks.check(std::abs(selfMSSSIM - 1.0) <= 1e-9 && firstMSSSIM > 0.0 && firstMSSSIM < 1.0, "MS-SSIM");
+    checks.check(threadIndependent, "thread independence");
+
+    std::string details = std::string() + "MSE " + toStringPrecise(firstMSE) + ", PSNR " + toStringPrecise(psnr)
+            + " dB, MS-SSIM " + toStringPrecise(firstMSSSIM) + ", max. SSIM map error "
+            + toStringPrecise(maxSSIMMapError) + ", max. block SSIM error " + toStringPrecise(maxBlockSSIMError);
+    checks.report(suite, "Image metrics", details);
+}
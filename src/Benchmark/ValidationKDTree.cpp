@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <utility>
+
+#include "Utils/KDTree.hpp"
+#include "ValidationUtils.hpp"
+#include "BenchmarkValidation.hpp"
+
+static inline float distanceSquared(const glm::vec3 &a, const glm::vec3 &b)
+{
+    glm::vec3 diff = a - b;
+    return glm::dot(diff, diff);
+}
+
+/// Compares all query types of the k-d tree with a brute-force search (bitwise for all thread counts).
+static size_t checkKDTree(const std::vector<glm::vec3> &points, const std::vector<glm::vec3> &queryPoints,
+        const std::vector<int> &threadCounts)
+{
+    const size_t NUM_POINTS = points.size();
+    const size_t NUM_QUERIES = queryPoints.size();
+    const int K = 8;
+    // Multiples of 1/64, so the grid points below also lie exactly on the query borders.
+    const float RADIUS = 3.0f / 64.0f;
+    const float MAX_DISTANCE_CLOSE_POINT = 2.0f / 64.0f;
+    const glm::vec3 RECTANGLE_EXTENT(3.0f / 64.0f, 4.0f / 64.0f, 1.0f / 64.0f);
+
+    // Brute force: Sort by (squared distance, index) like KDTree::findKNearestPoints.
+    std::vector<int> referenceKNN(NUM_QUERIES * K);
+    std::vector<float> referenceDistances(NUM_QUERIES * K);
+    std::vector<std::vector<int>> referenceRadius(NUM_QUERIES);
+    std::vector<std::vector<int>> referenceRectangle(NUM_QUERIES);
+    std::vector<int> referenceClosePoint(NUM_QUERIES, -1);
+    std::vector<std::pair<float, int>> candidates(NUM_POINTS);
+    for (size_t q = 0; q < NUM_QUERIES; q++) {
+        Rectangle rect;
+        rect.min = queryPoints[q] - RECTANGLE_EXTENT;
+        rect.max = queryPoints[q] + RECTANGLE_EXTENT;
+        for (size_t i = 0; i < NUM_POINTS; i++) {
+            candidates[i] = std::make_pair(distanceSquared(points[i], queryPoints[q]), int(i));
+            if (candidates[i].first <= RADIUS * RADIUS) {
+                referenceRadius[q].push_back(int(i));
+            }
+            if (rect.contains(points[i])) {
+                referenceRectangle[q].push_back(int(i));
+            }
+        }
+        std::partial_sort(candidates.begin(), candidates.begin() + K, candidates.end());
+        for (int j = 0; j < K; j++) {
+            referenceKNN[q * K + j] = candidates[j].second;
+            referenceDistances[q * K + j] = std::sqrt(candidates[j].first);
+        }
+        if (candidates[0].first < MAX_DISTANCE_CLOSE_POINT * MAX_DISTANCE_CLOSE_POINT) {
+            referenceClosePoint[q] = candidates[0].second;
+        }
+    }
+
+    size_t numMismatches = 0;
+    std::vector<Point> firstTreeOrder;
+    forEachThreadCount(threadCounts, [&](size_t t) {
+        KDTree kdTree;
+        kdTree.build(points);
+
+        // The tree layout must not depend on the number of threads.
+        std::vector<Point> treeOrder = kdTree.getPoints();
+        if (firstTreeOrder.empty()) {
+            firstTreeOrder = treeOrder;
+        } else {
+            for (size_t i = 0; i < treeOrder.size(); i++) {
+                if (treeOrder[i].index != firstTreeOrder[i].index) {
+                    numMismatches++;
+                    break;
+                }
+            }
+        }
+
+        std::vector<int> indices;
+        std::vector<float> distances;
+        kdTree.findKNearestPointsBatch(queryPoints, K, indices, distances);
+        if (indices != referenceKNN || !isBitwiseEqual(distances, referenceDistances)) {
+            numMismatches++;
+        }
+
+        std::vector<size_t> offsets;
+        std::vector<int> radiusIndices;
+        kdTree.findPointsInRadiusBatch(queryPoints, RADIUS, offsets, radiusIndices);
+        for (size_t q = 0; q < NUM_QUERIES; q++) {
+            std::vector<int> found(radiusIndices.begin() + offsets[q], radiusIndices.begin() + offsets[q + 1]);
+            std::sort(found.begin(), found.end());
+            if (found != referenceRadius[q]) {
+                numMismatches++;
+            }
+        }
+
+        // The single queries are serial, so they are only compared once.
+        if (t != 0) {
+            return;
+        }
+        for (size_t q = 0; q < NUM_QUERIES; q++) {
+            std::vector<int> found;
+            kdTree.findKNearestPoints(queryPoints[q], K, found);
+            if (!std::equal(found.begin(), found.end(), referenceKNN.begin() + q * K) || found.size() != size_t(K)) {
+                numMismatches++;
+            }
+
+            kdTree.findPointsInRadius(queryPoints[q], RADIUS, found);
+            std::sort(found.begin(), found.end());
+            if (found != referenceRadius[q]) {
+                numMismatches++;
+            }
+
+            Rectangle rect;
+            rect.min = queryPoints[q] - RECTANGLE_EXTENT;
+            rect.max = queryPoints[q] + RECTANGLE_EXTENT;
+            kdTree.findPointsInRectangle(rect, found);
+            std::sort(found.begin(), found.end());
+            if (found != referenceRectangle[q]) {
+                numMismatches++;
+            }
+
+            const Point *closePoint = kdTree.findCloseIndexedPoint(queryPoints[q], MAX_DISTANCE_CLOSE_POINT);
+            if ((closePoint ? closePoint->index : -1) != referenceClosePoint[q]) {
+                numMismatches++;
+            }
+        }
+    });
+    return numMismatches;
+}
+
+void validateKDTree(BenchmarkSuite &suite, const std::vector<int> &threadCounts)
+{
+    const size_t NUM_POINTS = 20000;
+    const size_t NUM_QUERIES = 500;
+
+    // Uniformly distributed points with some exact duplicates to test the ordering of ties.
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+    std::vector<glm::vec3> points(NUM_POINTS);
+    for (size_t i = 0; i < NUM_POINTS; i++) {
+        if (i % 100 == 99) {
+            points[i] = points[i - 1];
+        } else {
+            points[i] = glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+        }
+    }
+    std::vector<glm::vec3> queryPoints(NUM_QUERIES);
+    for (size_t i = 0; i < NUM_QUERIES; i++) {
+        queryPoints[i] = glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+    }
+    size_t numMismatches = checkKDTree(points, queryPoints, threadCounts);
+
+    // Points and queries snapped to a grid with a spacing of 1/32, i.e., many points with equal distances and
+    // coordinates equal to the splitting planes and the rectangle borders.
+    std::vector<glm::vec3> gridPoints(points.size()), gridQueryPoints(queryPoints.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        gridPoints[i] = glm::floor(points[i] * 32.0f) / 32.0f;
+    }
+    for (size_t i = 0; i < queryPoints.size(); i++) {
+        gridQueryPoints[i] = glm::floor(queryPoints[i] * 64.0f) / 64.0f;
+    }
+    numMismatches += checkKDTree(gridPoints, gridQueryPoints, threadCounts);
+
+    suite.addValidationResult("KDTree", numMismatches == 0, std::to_string(NUM_QUERIES)
+            + " k-NN (k = 8), radius, rectangle and closest point queries on " + std::to_string(NUM_POINTS)
+            + " random and grid points, " + std::to_string(numMismatches) + " mismatches compared to brute force");
+}
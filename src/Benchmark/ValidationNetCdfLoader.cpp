@@ -0,0 +1,134 @@
+#include <cstdio>
+#include <random>
+
+#include <netcdf.h>
+
+#include "Utils/ImportanceCriteria.hpp"
+#include "Utils/BinLinesFile.hpp"
+#include "Utils/NetCDFConverter.hpp"
+#include "BenchmarkReferences.hpp"
+#include "ValidationUtils.hpp"
+#include "BenchmarkValidation.hpp"
+
+/// Writes a trajectory file with the layout of the WCB files: lat, lon and pressure with the dimensions (ensemble,
+/// trajectory, time). Missing values are stored as -999e9 like in the original data.
+static bool writeNetCdfTrajectoryFile(const std::string &filename, size_t numTrajectories, size_t numTimeSteps,
+        uint32_t seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> latLonDistribution(-9000.0f, 9000.0f);
+    std::uniform_real_distribution<float> pressureDistribution(100.0f, 1050.0f);
+    std::uniform_int_distribution<int> missingDistribution(0, 9);
+    const size_t numValues = numTrajectories * numTimeSteps;
+    std::vector<float> lat(numValues), lon(numValues), pressure(numValues);
+    for (size_t trajectoryIdx = 0; trajectoryIdx < numTrajectories; trajectoryIdx++) {
+        for (size_t i = 0; i < numTimeSteps; i++) {
+            size_t idx = trajectoryIdx * numTimeSteps + i;
+            lat[idx] = latLonDistribution(generator);
+            lon[idx] = latLonDistribution(generator);
+            pressure[idx] = pressureDistribution(generator);
+            // Single missing points, trajectories without valid points and trajectories with only one valid point.
+            bool isMissing = missingDistribution(generator) == 0 || trajectoryIdx % 7 == 3
+                    || (trajectoryIdx % 50 == 11 && i != numTimeSteps / 2);
+            if (isMissing) {
+                pressure[idx] = -999.0e9f;
+            }
+        }
+    }
+
+    int ncid, ensembleDimId, trajectoryDimId, timeDimId, latVarId, lonVarId, pressureVarId;
+    if (nc_create(filename.c_str(), NC_CLOBBER, &ncid) != NC_NOERR) {
+        return false;
+    }
+    bool success = nc_def_dim(ncid, "ensemble", 1, &ensembleDimId) == NC_NOERR
+            && nc_def_dim(ncid, "trajectory", numTrajectories, &trajectoryDimId) == NC_NOERR
+            && nc_def_dim(ncid, "time", numTimeSteps, &timeDimId) == NC_NOERR;
+    int dimIds[] = { ensembleDimId, trajectoryDimId, timeDimId };
+    success = success && nc_def_var(ncid, "lat", NC_FLOAT, 3, dimIds, &latVarId) == NC_NOERR
+            && nc_def_var(ncid, "lon", NC_FLOAT, 3, dimIds, &lonVarId) == NC_NOERR
+            && nc_def_var(ncid, "pressure", NC_FLOAT, 3, dimIds, &pressureVarId) == NC_NOERR
+            && nc_enddef(ncid) == NC_NOERR;
+    size_t startp[] = {0, 0, 0};
+    size_t countp[] = {1, numTrajectories, numTimeSteps};
+    success = success && nc_put_vara_float(ncid, latVarId, startp, countp, lat.data()) == NC_NOERR
+            && nc_put_vara_float(ncid, lonVarId, startp, countp, lon.data()) == NC_NOERR
+            && nc_put_vara_float(ncid, pressureVarId, startp, countp, pressure.data()) == NC_NOERR;
+    return nc_close(ncid) == NC_NOERR && success;
+}
+
+void validateNetCdfLoader(BenchmarkSuite &suite, const std::vector<int> &threadCounts, const std::string &directory)
+{
+    // 48 time steps take 576 bytes per trajectory, i.e., a chunk of 1 MiB holds 1820 of the 6000 trajectories.
+    const std::string filename = directory + "validation_trajectories.nc";
+    const std::string binLinesFilename = directory + "validation_trajectories_netcdf.binlines";
+    const size_t numTrajectories = 6000, numTimeSteps = 48;
+    const size_t numTrajectoriesPerChunk = 1024 * 1024 / (numTimeSteps * 3 * sizeof(float));
+    const size_t expectedNumChunks = (numTrajectories + numTrajectoriesPerChunk - 1) / numTrajectoriesPerChunk;
+    if (!writeNetCdfTrajectoryFile(filename, numTrajectories, numTimeSteps, 17)) {
+        suite.addValidationResult("NetCDF loader", false, "Could not write \"" + filename + "\"");
+        return;
+    }
+
+    ValidationChecks checks;
+    TrajectorySet expected = loadNetCdfFileReference(filename);
+    TrajectorySet expectedWithAttributes = expected;
+    computeTrajectoryAttributes(TRAJECTORY_TYPE_WCB, expectedWithAttributes);
+
+    // Multiple chunks with the thread counts as numbers of workers, and one chunk converted by a single worker.
+    bool chunkedPassed = true, attributesPassed = true, binLinesPassed = true, statisticsPassed = true;
+    forEachThreadCount(threadCounts, [&](size_t t) {
+        NetCdfReadSettings settings;
+        settings.chunkSizeMiB = 1;
+        settings.numWorkerThreads = size_t(threadCounts.at(t));
+        NetCdfReadStatistics statistics;
+        TrajectorySet trajectories;
+        chunkedPassed = chunkedPassed && loadNetCdfFile(filename, trajectories, settings, &statistics)
+                && isTrajectorySetEqual(trajectories, expected);
+        statisticsPassed = statisticsPassed && statistics.numChunks == expectedNumChunks
+                && statistics.numTrajectories == expected.getNumTrajectories()
+                && statistics.numPoints == expected.getNumPoints()
+                && statistics.bytesRead == 4 * numTrajectories * numTimeSteps * sizeof(float);
+
+        settings.computeAttributes = true;
+        attributesPassed = attributesPassed && loadNetCdfFile(filename, trajectories, settings)
+                && isTrajectorySetEqual(trajectories, expectedWithAttributes);
+
+        TrajectorySet trajectoriesBinLines;
+        binLinesPassed = binLinesPassed && convertNetCdfFileToBinLines(filename, binLinesFilename, settings)
+                && readBinLinesFile(binLinesFilename, trajectoriesBinLines)
+                && isTrajectorySetEqual(trajectoriesBinLines, expectedWithAttributes);
+    });
+    checks.check(chunkedPassed, "chunked");
+    checks.check(statisticsPassed, "statistics");
+    checks.check(attributesPassed, "attributes");
+    checks.check(binLinesPassed, "binlines");
+
+    NetCdfReadSettings singleChunkSettings;
+    singleChunkSettings.numWorkerThreads = 1;
+    TrajectorySet singleChunk;
+    checks.check(loadNetCdfFile(filename, singleChunk, singleChunkSettings)
+            && isTrajectorySetEqual(singleChunk, expected), "single chunk");
+    checks.check(isTrajectorySetEqual(TrajectorySet::fromTrajectories(loadNetCdfFile(filename)), expected),
+            "Trajectories");
+
+    // A consumer returning false stops the loading, and missing files are reported as errors.
+    NetCdfReadSettings abortSettings;
+    abortSettings.chunkSizeMiB = 1;
+    abortSettings.numWorkerThreads = 2;
+    size_t numConsumedChunks = 0;
+    bool aborted = !loadNetCdfFileChunked(filename, abortSettings, [&numConsumedChunks](TrajectorySet&) {
+        numConsumedChunks++;
+        return false;
+    });
+    checks.check(aborted && numConsumedChunks == 1, "consumer abort");
+    TrajectorySet missingFile;
+    checks.check(!loadNetCdfFile(directory + "validation_missing.nc", missingFile) && missingFile.empty(),
+            "missing file");
+    remove(filename.c_str());
+    remove(binLinesFilename.c_str());
+
+    std::string details = std::to_string(expected.getNumTrajectories()) + " trajectories with "
+            + std::to_string(expected.getNumPoints()) + " points in " + std::to_string(expectedNumChunks)
+            + " chunks compared to the whole-file loader";
+    checks.report(suite, "NetCDF loader", details);
+}
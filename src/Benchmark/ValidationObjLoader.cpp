@@ -0,0 +1,196 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#include "Utils/NumberParser.hpp"
+#include "Utils/SyntheticDatasets.hpp"
+#include "Utils/TrajectoryFile.hpp"
+#include "BenchmarkReferences.hpp"
+#include "ValidationUtils.hpp"
+#include "BenchmarkValidation.hpp"
+
+/// Appends a random decimal number like "-12.5e+3" (possibly without digits or with a dangling exponent).
+static void appendRandomDecimalNumber(std::mt19937 &generator, std::string &str)
+{
+    std::uniform_int_distribution<int> digitDistribution(0, 9);
+    std::uniform_int_distribution<int> smallDistribution(0, 12);
+    const char *signs[] = { "", "", "-", "+" };
+    str += signs[smallDistribution(generator) % 4];
+    int numIntegerDigits = smallDistribution(generator) % 8 == 0 ? 20 : smallDistribution(generator);
+    for (int i = 0; i < numIntegerDigits; i++) {
+        str += char('0' + digitDistribution(generator));
+    }
+    if (smallDistribution(generator) % 2 == 0) {
+        str += '.';
+        int numFractionalDigits = smallDistribution(generator);
+        for (int i = 0; i < numFractionalDigits; i++) {
+            str += char('0' + digitDistribution(generator));
+        }
+    }
+    if (smallDistribution(generator) % 3 == 0) {
+        str += smallDistribution(generator) % 2 == 0 ? "e" : "E";
+        str += signs[smallDistribution(generator) % 4];
+        int exponent = std::uniform_int_distribution<int>(0, 50)(generator);
+        if (exponent != 0) {
+            str += std::to_string(exponent);
+        }
+    }
+}
+
+void validateNumberParser(BenchmarkSuite &suite)
+{
+    // Special values, rounding ties of float (2^24 + 1, the midpoint above 1), denormals, overflow, hexadecimal floats
+    // and strings without a number.
+    std::vector<std::string> floatStrings = {
+            "0", "-0", "+0.0", ".5", "5.", ".", "-", "+.e3", "1e", "1e+", "1e-x", "inf", "-Infinity", "nan", "-nan",
+            "0x1.8p3", "0X.1P-2", "16777217", "1.000000059604644775390625", "1.0000000596046448",
+            "3.4028235e38", "3.4028236e38", "1e39", "-1e39", "1.17549435e-38", "1e-40", "1.4e-45", "7e-46", "1e-50",
+            "123456789012345678901234567890", "0.000000000000000000000000000001", "1e22", "1e23", "4.7e-23", "abc",
+            "", "\t 42", "  -0.25\t", "1,5", "2.5f", "9007199254740993", "1e100000", "1e-100000"
+    };
+    std::mt19937 generator(29);
+    for (int i = 0; i < 200000; i++) {
+        std::string str;
+        int numBlanks = int(generator() % 4);
+        for (int j = 0; j < numBlanks; j++) {
+            str += j % 2 == 0 ? ' ' : '\t';
+        }
+        appendRandomDecimalNumber(generator, str);
+        const char *suffixes[] = { "", " 1.5", "\n", "\r\n", "x", "e", "e+", "5" };
+        str += suffixes[generator() % 8];
+        floatStrings.push_back(str);
+    }
+    // Random bit patterns (including denormals, infinities and NaNs) printed with different precisions.
+    for (int i = 0; i < 100000; i++) {
+        uint32_t bits = uint32_t(generator());
+        float value;
+        memcpy(&value, &bits, sizeof(float));
+        const char *formats[] = { "%.9g", "%.6g", "%.3e", "%a", "%.12f" };
+        char buffer[128];
+        snprintf(buffer, sizeof(buffer), formats[i % 5], double(value));
+        floatStrings.push_back(buffer);
+    }
+
+    // The numbers are followed by a digit that is not part of the range, i.e., parsing must stop at the range end.
+    size_t numFloatMismatches = 0;
+    std::string firstMismatch;
+    for (const std::string &str : floatStrings) {
+        char *referenceEnd = nullptr;
+        float referenceValue = strtof(str.c_str(), &referenceEnd);
+        std::string buffer = str + "7";
+        float value = 0.0f;
+        const char *parseEnd = parseFloat(buffer.data(), buffer.data() + str.size(), value);
+        bool equal;
+        if (referenceEnd == str.c_str()) {
+            equal = parseEnd == nullptr;
+        } else {
+            equal = parseEnd != nullptr && parseEnd - buffer.data() == referenceEnd - str.c_str()
+                    && memcmp(&value, &referenceValue, sizeof(float)) == 0;
+        }
+        if (!equal) {
+            if (numFloatMismatches == 0) {
+                firstMismatch = str;
+            }
+            numFloatMismatches++;
+        }
+    }
+
+    std::vector<std::string> intStrings = { "0", "-0", "+7", "-", "+", "x", "", " \t12 3", "--1", "+-1", "2147483647",
+            "-2147483648", "0012", "3.5", "12e3" };
+    for (int i = 0; i < 100000; i++) {
+        std::string str = i % 2 == 0 ? " " : "";
+        int value = std::uniform_int_distribution<int>(-1000000000, 1000000000)(generator);
+        str += (value >= 0 && i % 3 == 0 ? "+" : "") + std::to_string(value);
+        str += i % 4 == 0 ? " 5" : "";
+        intStrings.push_back(str);
+    }
+    size_t numIntMismatches = 0;
+    for (const std::string &str : intStrings) {
+        char *referenceEnd = nullptr;
+        long referenceValue = strtol(str.c_str(), &referenceEnd, 10);
+        std::string buffer = str + "7";
+        int value = 0;
+        const char *parseEnd = parseInt(buffer.data(), buffer.data() + str.size(), value);
+        bool equal;
+        if (referenceEnd == str.c_str()) {
+            equal = parseEnd == nullptr;
+        } else {
+            equal = parseEnd != nullptr && parseEnd - buffer.data() == referenceEnd - str.c_str()
+                    && long(value) == referenceValue;
+        }
+        if (!equal) {
+            if (numFloatMismatches + numIntMismatches == 0) {
+                firstMismatch = str;
+            }
+            numIntMismatches++;
+        }
+    }
+
+    std::string details = std::to_string(numFloatMismatches) + " parseFloat mismatches on "
+            + std::to_string(floatStrings.size()) + " strings and " + std::to_string(numIntMismatches)
+            + " parseInt mismatches on " + std::to_string(intStrings.size()) + " strings compared to strtof/strtol";
+    if (!firstMismatch.empty()) {
+        details += ", first mismatch: \"" + firstMismatch + "\"";
+    }
+    suite.addValidationResult("Number parser", numFloatMismatches == 0 && numIntMismatches == 0, details);
+}
+
+void validateObjLoader(BenchmarkSuite &suite, const std::vector<int> &threadCounts, const std::string &directory)
+{
+    // A file of several MiB is split into multiple chunks (see loadTrajectorySetFromObj).
+    const std::string filename = directory + "validation_lines.obj";
+    SyntheticDatasetSettings settings;
+    settings.type = SYNTHETIC_DATASET_RANDOM_WALKS;
+    settings.seed = 5;
+    settings.size = 131072;
+    settings.numPointsPerLine = 128;
+    SyntheticDatasetStatistics statistics;
+    bool fileWritten = generateSyntheticDataset(filename, settings, &statistics);
+
+    // Edge cases at the end of the file: CRLF line breaks, tabs, exponents, numbers the fast path of parseFloat
+    // can't handle, invalid points, normals, comments, a missing vertex and no line break at the end.
+    std::string n[5];
+    for (int i = 0; i < 5; i++) {
+        n[i] = std::to_string(statistics.numPrimitives + uint64_t(i) + 1);
+    }
+    std::string edgeCases = std::string()
+            + "# Edge cases\r\ng edge\r\n"
+            + "v\t-1.5e-3  +2.25\t3\r\nvt 1e-40\r\n"
+            + "v 1e11 0 0\r\nvt -0\r\n"
+            + "v .5 5. -0.0e+0\nvt 123456789012345678901234\n"
+            + "v 0x1p-2 7 inf\nvt 16777217\n"
+            + "v 1 2\nvt 0x10\n"
+            + "vn 0 0 1\n\n"
+            + "l " + n[0] + " " + n[1] + "\t" + n[2] + " " + n[4] + "\r\n"
+            + "l " + n[3] + " 999999999 " + n[0] + "\r\n"
+            + "l " + n[4] + " " + n[2];
+    FILE *file = fopen(filename.c_str(), "ab");
+    fileWritten = fileWritten && file && fwrite(edgeCases.data(), 1, edgeCases.size(), file) == edgeCases.size();
+    if (file) {
+        fclose(file);
+    }
+    if (!fileWritten) {
+        suite.addValidationResult("Obj loader", false, "Could not write \"" + filename + "\"");
+        return;
+    }
+
+    ValidationChecks checks;
+    const TrajectoryType trajectoryTypes[] = { TRAJECTORY_TYPE_ANEURYSM, TRAJECTORY_TYPE_CONVECTION_ROLLS_NEW };
+    const char *trajectoryTypeNames[] = { "aneurysm", "convection_rolls" };
+    size_t numLines = 0, numPoints = 0;
+    for (int typeIdx = 0; typeIdx < 2; typeIdx++) {
+        TrajectorySet expected = loadTrajectorySetFromObjReference(filename, trajectoryTypes[typeIdx]);
+        numLines = expected.getNumTrajectories();
+        numPoints = expected.getNumPoints();
+        bool passed = true;
+        forEachThreadCount(threadCounts, [&](size_t) {
+            TrajectorySet trajectories = loadTrajectorySetFromObj(filename, trajectoryTypes[typeIdx]);
+            passed = passed && isTrajectorySetEqual(trajectories, expected);
+        });
+        checks.check(passed, trajectoryTypeNames[typeIdx]);
+    }
+
+    checks.report(suite, "Obj loader", std::to_string(numLines) + " lines with " + std::to_string(numPoints)
+            + " points compared to the serial sscanf loader");
+}
@@ -0,0 +1,55 @@
+#include <cstdio>
+
+#include "Utils/MappedFile.hpp"
+#include "Utils/TrajectorySet.hpp"
+#include "ValidationUtils.hpp"
+
+std::string toStringPrecise(double value)
+{
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.3g", value);
+    return buffer;
+}
+
+bool isTrajectorySetEqual(const TrajectorySet &a, const TrajectorySet &b)
+{
+    return a.lineOffsets == b.lineOffsets && a.positions == b.positions && a.attributes == b.attributes;
+}
+
+std::vector<uint8_t> readFileContent(const std::string &filename)
+{
+    MappedFile mappedFile;
+    if (!mappedFile.open(filename)) {
+        return std::vector<uint8_t>();
+    }
+    return std::vector<uint8_t>(mappedFile.getData(), mappedFile.getData() + mappedFile.getSize());
+}
+
+bool writeFileContent(const std::string &filename, const std::vector<uint8_t> &content)
+{
+    FILE *file = fopen(filename.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool success = fwrite(content.data(), 1, content.size(), file) == content.size();
+    return fclose(file) == 0 && success;
+}
+
+bool ValidationChecks::check(bool condition, const std::string &name)
+{
+    if (!condition) {
+        failedChecks.push_back(name);
+    }
+    return condition;
+}
+
+void ValidationChecks::report(BenchmarkSuite &suite, const std::string &validationName, std::string details) const
+{
+    if (!failedChecks.empty()) {
+        details += ", failed:";
+        for (const std::string &failedCheck : failedChecks) {
+            details += " " + failedCheck;
+        }
+    }
+    suite.addValidationResult(validationName, failedChecks.empty(), details);
+}
@@ -0,0 +1,66 @@
+#ifndef PIXELSYNCOIT_VALIDATIONUTILS_HPP
+#define PIXELSYNCOIT_VALIDATIONUTILS_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#include "BenchmarkSuite.hpp"
+
+struct TrajectorySet;
+
+/*
+ * Scaffolding shared by the validation checks (see BenchmarkValidation.hpp), which are implemented in
+ * BenchmarkValidation.cpp and in one Validation<Component>.cpp file per larger component.
+ */
+
+/// Formats the value with three significant digits for the details of a validation result.
+std::string toStringPrecise(double value);
+
+/// @return True if both arrays have the same size and the same bytes.
+template<typename T>
+bool isBitwiseEqual(const std::vector<T> &a, const std::vector<T> &b)
+{
+    return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+/// @return True if the line offsets, positions and attributes of both sets are equal.
+bool isTrajectorySetEqual(const TrajectorySet &a, const TrajectorySet &b);
+
+/// @return The content of the file (empty if the file couldn't be read).
+std::vector<uint8_t> readFileContent(const std::string &filename);
+/// @return False if the file couldn't be written.
+bool writeFileContent(const std::string &filename, const std::vector<uint8_t> &content);
+
+/**
+ * Sets the number of threads to each of the thread counts (see BenchmarkSuite::setNumThreads) and calls
+ * function(t) afterwards, where t is the index of the thread count.
+ */
+template<typename Function>
+void forEachThreadCount(const std::vector<int> &threadCounts, Function function)
+{
+    for (size_t t = 0; t < threadCounts.size(); t++) {
+        BenchmarkSuite::setNumThreads(threadCounts.at(t));
+        function(t);
+    }
+}
+
+/**
+ * Collects the names of the failed checks of a validation. The validation passes if no check failed, and the names
+ * of the failed checks are appended to the details of the result ("<details>, failed: <name> <name> ...").
+ */
+class ValidationChecks
+{
+public:
+    /// Records the check as failed if condition is false. @return condition.
+    bool check(bool condition, const std::string &name);
+    inline bool passed() const { return failedChecks.empty(); }
+    /// Adds the result of the validation to the suite (see BenchmarkSuite::addValidationResult).
+    void report(BenchmarkSuite &suite, const std::string &validationName, std::string details) const;
+
+private:
+    std::vector<std::string> failedChecks;
+};
+
+#endif //PIXELSYNCOIT_VALIDATIONUTILS_HPP
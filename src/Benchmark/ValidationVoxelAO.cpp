@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "VoxelRaytracing/VoxelData.hpp"
+#include "ValidationUtils.hpp"
+#include "BenchmarkValidation.hpp"
+
+/// The previous brute-force AO blur (with the corrected read index): Each voxel is convolved with the 3D kernel.
+static void filterVoxelDensitiesReference(const std::vector<float> &voxelDensities, std::vector<float> &filtered,
+        glm::ivec3 size, int filterRadius, AOFilterType filterType)
+{
+    const int filterSize = 2 * filterRadius + 1;
+    std::vector<float> blurKernel(filterSize * filterSize * filterSize);
+    if (filterType == AO_FILTER_BOX) {
+        generateBoxBlurKernel(blurKernel.data(), filterSize);
+    } else {
+        generateGaussianBlurKernel(blurKernel.data(), filterSize, float(std::max(filterRadius, 1)));
+    }
+
+    filtered.resize(voxelDensities.size());
+    for (int gz = 0; gz < size.z; gz++) {
+        for (int gy = 0; gy < size.y; gy++) {
+            for (int gx = 0; gx < size.x; gx++) {
+                double value = 0.0;
+                for (int offsetZ = -filterRadius; offsetZ <= filterRadius; offsetZ++) {
+                    for (int offsetY = -filterRadius; offsetY <= filterRadius; offsetY++) {
+                        for (int offsetX = -filterRadius; offsetX <= filterRadius; offsetX++) {
+                            int readX = gx + offsetX, readY = gy + offsetY, readZ = gz + offsetZ;
+                            if (readX < 0 || readY < 0 || readZ < 0
+                                    || readX >= size.x || readY >= size.y || readZ >= size.z) {
+                                continue;
+                            }
+                            int filterIdx = ((offsetZ + filterRadius) * filterSize + offsetY + filterRadius)
+                                    * filterSize + offsetX + filterRadius;
+                            int readIdx = (readZ * size.y + readY) * size.x + readX;
+                            value += double(voxelDensities[readIdx]) * double(blurKernel[filterIdx]);
+                        }
+                    }
+                }
+                filtered[(gz * size.y + gy) * size.x + gx] = float(value);
+            }
+        }
+    }
+}
+
+void validateVoxelAO(BenchmarkSuite &suite, const std::vector<int> &threadCounts)
+{
+    // Non-cubic grid (the previous read index was only correct for size.x == size.y) with sparse line densities.
+    const glm::ivec3 size(37, 29, 23);
+    std::mt19937 generator(9);
+    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+    std::vector<float> voxelDensities(size_t(size.x) * size_t(size.y) * size_t(size.z));
+    for (float &density : voxelDensities) {
+        float random = distribution(generator);
+        density = random < 0.7f ? 0.0f : random;
+    }
+
+    ValidationChecks checks;
+    double maxError = 0.0;
+    const int FILTER_RADII[] = { 1, 3, 5 };
+    const AOFilterType FILTER_TYPES[] = { AO_FILTER_GAUSSIAN, AO_FILTER_BOX };
+    for (AOFilterType filterType : FILTER_TYPES) {
+        for (int filterRadius : FILTER_RADII) {
+            std::vector<float> expected;
+            filterVoxelDensitiesReference(voxelDensities, expected, size, filterRadius, filterType);
+            std::vector<float> firstFiltered;
+            bool passed = true;
+            forEachThreadCount(threadCounts, [&](size_t t) {
+                std::vector<float> filtered;
+                filterVoxelDensities(voxelDensities, filtered, size, filterRadius, filterType);
+                if (t == 0) {
+                    firstFiltered = filtered;
+                } else {
+                    passed = passed && isBitwiseEqual(filtered, firstFiltered);
+                }
+            });
+            double error = 0.0;
+            for (size_t i = 0; i < expected.size(); i++) {
+                error = std::max(error, double(std::abs(firstFiltered[i] - expected[i])));
+            }
+            maxError = std::max(maxError, error);
+            checks.check(passed && error <= 1e-5, std::string(filterType == AO_FILTER_BOX ? "box" : "gaussian")
+                    + std::to_string(filterRadius));
+        }
+    }
+
+    std::string details = "Grid " + std::to_string(size.x) + "x" + std::to_string(size.y) + "x"
+            + std::to_string(size.z) + ", radii 1, 3, 5, max. error " + toStringPrecise(maxError)
+            + " compared to the brute-force 3D convolution";
+    checks.report(suite, "Voxel AO", details);
+}
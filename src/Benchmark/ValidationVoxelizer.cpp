@@ -0,0 +1,103 @@
+#include "Utils/SyntheticDatasets.hpp"
+#include "Utils/TrajectoryFile.hpp"
+#include "VoxelRaytracing/VoxelData.hpp"
+#include "VoxelRaytracing/VoxelCurveDiscretizer.hpp"
+#include "BenchmarkReferences.hpp"
+#include "ValidationUtils.hpp"
+#include "BenchmarkValidation.hpp"
+
+void validateVoxelizer(BenchmarkSuite &suite, const std::vector<int> &threadCounts, const std::string &directory)
+{
+    const std::string filename = directory + "validation_voxelizer.binlines";
+    SyntheticDatasetSettings settings;
+    settings.type = SYNTHETIC_DATASET_RANDOM_WALKS;
+    settings.seed = 13;
+    settings.size = 400 * 64;
+    settings.numPointsPerLine = 64;
+    if (!generateSyntheticDataset(filename, settings)) {
+        suite.addValidationResult("Voxelizer", false, "Could not write \"" + filename + "\"");
+        return;
+    }
+
+    // A large maximum number of lines per voxel keeps all segments, a small one tests the truncation.
+    const unsigned int maxNumLinesPerVoxelValues[] = { 4096, 2 };
+    ValidationChecks checks;
+    std::vector<Curve> curves;
+    size_t numVoxelMismatches = 0, numSegments = 0, numOccupiedVoxels = 0;
+    glm::ivec3 gridResolution(0);
+    for (unsigned int maxNumLinesPerVoxel : maxNumLinesPerVoxelValues) {
+        VoxelGridDataCompressed firstData;
+        bool threadIndependent = true;
+        forEachThreadCount(threadCounts, [&](size_t t) {
+            VoxelCurveDiscretizer discretizer(glm::ivec3(64), glm::ivec3(8));
+            std::vector<float> attributes;
+            float maxVorticity = 0.0f;
+            VoxelGridDataCompressed data = discretizer.createFromTrajectoryDataset(
+                    filename, TRAJECTORY_TYPE_ANEURYSM, attributes, maxVorticity, maxNumLinesPerVoxel, false);
+            if (t == 0) {
+                firstData = data;
+            } else if (!isBitwiseEqual(data.voxelLineListOffsets, firstData.voxelLineListOffsets)
+                    || !isBitwiseEqual(data.numLinesInVoxel, firstData.numLinesInVoxel)
+                    || !isBitwiseEqual(data.lineSegments, firstData.lineSegments)
+                    || !isBitwiseEqual(data.voxelDensities, firstData.voxelDensities)
+                    || !isBitwiseEqual(data.voxelAOFactors, firstData.voxelAOFactors)) {
+                threadIndependent = false;
+            }
+        });
+        const std::string suffix = " (max. " + std::to_string(maxNumLinesPerVoxel) + ")";
+        checks.check(threadIndependent, "thread independence" + suffix);
+
+        // The reference uses the lines in voxel grid space (transformed like by the voxelizer).
+        if (curves.empty()) {
+            gridResolution = firstData.gridResolution;
+            Trajectories trajectories = loadTrajectoriesFromFile(filename, TRAJECTORY_TYPE_ANEURYSM);
+            curves.resize(trajectories.size());
+            for (size_t lineIdx = 0; lineIdx < trajectories.size(); lineIdx++) {
+                for (const glm::vec3 &position : trajectories.at(lineIdx).positions) {
+                    curves.at(lineIdx).points.push_back(
+                            sgl::transformPoint(firstData.worldToVoxelGridMatrix, position));
+                }
+                curves.at(lineIdx).attributes = trajectories.at(lineIdx).attributes.at(0);
+            }
+        }
+
+        // All stored segments (positions, line IDs and attributes), the densities and the AO factors of all voxels,
+        // including the voxels of the lines clipped at the grid boundary, need to match the GPU emulation bitwise.
+        VoxelGridDataCompressed referenceData = createVoxelGridReference(
+                curves, gridResolution, firstData.quantizationResolution, maxNumLinesPerVoxel);
+        checks.check(isBitwiseEqual(firstData.voxelLineListOffsets, referenceData.voxelLineListOffsets)
+                && isBitwiseEqual(firstData.numLinesInVoxel, referenceData.numLinesInVoxel), "segment counts" + suffix);
+        checks.check(isBitwiseEqual(firstData.lineSegments, referenceData.lineSegments), "segments" + suffix);
+        checks.check(isBitwiseEqual(firstData.voxelDensities, referenceData.voxelDensities), "densities" + suffix);
+        checks.check(isBitwiseEqual(firstData.voxelAOFactors, referenceData.voxelAOFactors), "AO factors" + suffix);
+        for (size_t voxelIdx = 0; voxelIdx < referenceData.numLinesInVoxel.size(); voxelIdx++) {
+            uint32_t numLines = referenceData.numLinesInVoxel.at(voxelIdx);
+            bool equal = voxelIdx < firstData.numLinesInVoxel.size()
+                    && firstData.numLinesInVoxel.at(voxelIdx) == numLines
+                    && firstData.voxelDensities.at(voxelIdx) == referenceData.voxelDensities.at(voxelIdx);
+            for (uint32_t i = 0; equal && i < numLines; i++) {
+                const LineSegmentCompressed &segment = firstData.lineSegments.at(
+                        firstData.voxelLineListOffsets.at(voxelIdx) + i);
+                const LineSegmentCompressed &referenceSegment = referenceData.lineSegments.at(
+                        referenceData.voxelLineListOffsets.at(voxelIdx) + i);
+                equal = segment.linePosition == referenceSegment.linePosition
+                        && segment.attributes == referenceSegment.attributes;
+            }
+            if (!equal) {
+                numVoxelMismatches++;
+            }
+        }
+        if (maxNumLinesPerVoxel == maxNumLinesPerVoxelValues[0]) {
+            numSegments = firstData.lineSegments.size();
+            for (uint32_t numLines : firstData.numLinesInVoxel) {
+                numOccupiedVoxels += numLines > 0 ? 1 : 0;
+            }
+        }
+    }
+
+    std::string details = "Grid " + std::to_string(gridResolution.x) + "x" + std::to_string(gridResolution.y) + "x"
+            + std::to_string(gridResolution.z) + ", " + std::to_string(numSegments) + " segments in "
+            + std::to_string(numOccupiedVoxels) + " voxels, " + std::to_string(numVoxelMismatches)
+            + " voxels differing from the serial GPU emulation";
+    checks.report(suite, "Voxelizer", details);
+}
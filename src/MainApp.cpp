@@ -50,6 +50,7 @@
 #include "Utils/PointRendering/PointFileLoader.hpp"
 #include "Utils/TrajectoryLoader.hpp"
 #include "Utils/HairLoader.hpp"
+#include "Utils/ConversionCache.hpp"
 #include "OIT/BufferSizeWatch.hpp"
 #include "OIT/OIT_Dummy.hpp"
 #include "OIT/OIT_KBuffer.hpp"
@@ -192,6 +193,7 @@ PixelSyncApp::PixelSyncApp() : camera(new Camera()), measurer(NULL), videoWriter
                                         [this](const InternalState &newState) { this->setNewState(newState); }, timeCoherence);
         measurer->setInitialFreeMemKilobytes(freeMemKilobytes);
         measurer->resolutionChanged(sceneFramebuffer);
+        measurer->setAdaptiveMeasurement(adaptivePerfMeasurement, FrameTimeStatisticsSettings());
 
         if (mode == RENDER_MODE_OIT_DEPTH_COMPLEXITY) {
             OIT_DepthComplexity *depthComplexityOIT = (OIT_DepthComplexity*)oitRenderer.get();
@@ -463,6 +465,8 @@ void PixelSyncApp::loadModel(const std::string &filename, bool resetCamera)
     if (oitRenderer->isTestingMode()) {
         return;
     }
+    loadModelTimeStampStart = Timer->getTicksMicroseconds();
+    measureTimeToFirstFrame = true;
 
     lineRadius = 0.001;
 
@@ -616,10 +620,10 @@ void PixelSyncApp::loadModel(const std::string &filename, bool resetCamera)
         changeImportanceCriterionType();
     }
 
-    std::string modelFilenameOptimized = modelFilenamePure + ".binmesh";
     // Special mode for line trajectories: Trajectories loaded as line set or as triangle mesh
+    bool isLineMesh = false;
     if (modelType == MODEL_TYPE_TRAJECTORIES && lineRenderingTechnique == LINE_RENDERING_TECHNIQUE_LINES) {
-        modelFilenameOptimized += "_lines";
+        isLineMesh = true;
         if (useBillboardLines) {
             sgl::ShaderManager->addPreprocessorDefine("BILLBOARD_LINES", "");
         }
@@ -632,7 +636,7 @@ void PixelSyncApp::loadModel(const std::string &filename, bool resetCamera)
         useGeometryShader = false;
     }
     if (modelType == MODEL_TYPE_TRAJECTORIES && lineRenderingTechnique == LINE_RENDERING_TECHNIQUE_FETCH) {
-        modelFilenameOptimized += "_lines";
+        isLineMesh = true;
         useProgrammableFetch = true;
         sgl::ShaderManager->addPreprocessorDefine("USE_PROGRAMMABLE_FETCH", "");
         if (programmableFetchUseAoS) {
@@ -645,26 +649,69 @@ void PixelSyncApp::loadModel(const std::string &filename, bool resetCamera)
         sgl::ShaderManager->removePreprocessorDefine("USE_PROGRAMMABLE_FETCH");
     }
 
-    if (!FileUtils::get()->exists(modelFilenameOptimized)) {
+    // The converted mesh is keyed on the content of the source file and all conversion parameters
+    std::string artifactType;
+    if (modelType == MODEL_TYPE_TRIANGLE_MESH_NORMAL) {
+        artifactType = "obj_mesh";
+    } else if (modelType == MODEL_TYPE_TRAJECTORIES) {
+        artifactType = isLineMesh ? "trajectories_line_mesh" : "trajectories_triangle_mesh";
+    } else if (boost::starts_with(modelFilenamePure, "Data/Hair")) {
+        artifactType = "hair_mesh";
+    } else if (boost::starts_with(modelFilenamePure, "Data/IsoSurfaces")) {
+        artifactType = "iso_surface_mesh";
+    } else if (boost::starts_with(modelFilenamePure, "Data/PointDatasets")) {
+        artifactType = "point_dataset";
+    }
+    ConversionCacheKey conversionKey(artifactType, ".binmesh");
+    conversionKey.addSourceFile(filename);
+    // Meshes converted by another version of the converters are converted again
+    conversionKey.addParameter("formatVersion", int(MESH_FORMAT_VERSION));
+    conversionKey.addParameter("converterRevision", MESH_CONVERTER_REVISION);
+    // Only the displayed importance criterion is computed by the conversion. The converted mesh doesn't depend on
+    // the importance criteria, as further criteria are appended to it when they are displayed (see below).
+    std::vector<int> importanceCriteria;
+    if (modelType == MODEL_TYPE_TRAJECTORIES) {
+        if (importanceCriterionIndex < getNumImportanceCriteria(trajectoryType)) {
+            importanceCriteria.push_back(importanceCriterionIndex);
+        }
+
+        // The positions are normalized depending on the trajectory type (see loadTrajectorySetFromFile)
+        conversionKey.addParameter("trajectoryType", int(trajectoryType));
+        if (!isLineMesh) {
+            conversionKey.addParameter("lineRadius", lineRadius);
+            conversionKey.addParameter("numCircleSegments", NUM_CIRCLE_SEGMENTS);
+        }
+    }
+    std::string modelFilenameOptimized = ConversionCache::get()->getArtifact(conversionKey,
+            [&](const std::string &outputFilename) -> bool {
         if (modelType == MODEL_TYPE_TRIANGLE_MESH_NORMAL) {
-            convertObjMeshToBinary(filename, modelFilenameOptimized);
+            return convertObjMeshToBinary(filename, outputFilename);
         } else if (modelType == MODEL_TYPE_TRAJECTORIES) {
-            if (boost::ends_with(modelFilenameOptimized, "_lines")) {
-                convertTrajectoryDataToBinaryLineMesh(trajectoryType, filename, modelFilenameOptimized);
+            if (isLineMesh) {
+                return convertTrajectoryDataToBinaryLineMesh(trajectoryType, filename, outputFilename,
+                        SpatialReorderSettings(), nullptr, importanceCriteria);
             } else {
-                convertTrajectoryDataToBinaryTriangleMesh(trajectoryType, filename,
-                        modelFilenameOptimized, lineRadius);
-//                convertTrajectoryDataToBinaryTriangleMeshGPU(trajectoryType, filename,
-//                        modelFilenameOptimized, lineRadius);
+                return convertTrajectoryDataToBinaryTriangleMesh(trajectoryType, filename, outputFilename,
+                        lineRadius, SpatialReorderSettings(), nullptr, importanceCriteria);
+//                convertTrajectoryDataToBinaryTriangleMeshGPU(trajectoryType, filename, outputFilename, lineRadius);
             }
         } else if (boost::starts_with(modelFilenamePure, "Data/Hair")) {
-            convertHairDataToBinaryTriangleMesh(filename, modelFilenameOptimized);
+            return convertHairDataToBinaryTriangleMesh(filename, outputFilename);
         } else if (boost::starts_with(modelFilenamePure, "Data/IsoSurfaces")) {
-            convertBinaryObjMeshToBinmesh(filename, modelFilenameOptimized);
+            return convertBinaryObjMeshToBinmesh(filename, outputFilename);
         } else if (boost::starts_with(modelFilenamePure, "Data/PointDatasets")) {
-            convertPointDataSetToBinmesh(filename, modelFilenameOptimized);
+            return convertPointDataSetToBinmesh(filename, outputFilename);
         }
+        return false;
+    });
+    if (!importanceCriteria.empty() && !modelFilenameOptimized.empty()) {
+        // The mesh was converted (or appended to) for other criteria before.
+        ConversionCache::get()->updateArtifact(modelFilenameOptimized, [&](const std::string &artifactFilename) {
+            return appendImportanceCriteriaToBinaryMesh(trajectoryType, filename, artifactFilename,
+                    importanceCriteria);
+        });
     }
+    Logfile::get()->writeInfo(ConversionCache::get()->getStatisticsString());
 
     if (boost::starts_with(modelFilenamePure, "Data/IsoSurfaces")) {
         if (cullBackface) {
@@ -681,7 +728,7 @@ void PixelSyncApp::loadModel(const std::string &filename, bool resetCamera)
     if (modelType == MODEL_TYPE_TRIANGLE_MESH_NORMAL) {
         gatherShaderIDs = {"PseudoPhong.Vertex", "PseudoPhong.Fragment"};
     } else if (modelType == MODEL_TYPE_TRAJECTORIES) {
-        if (boost::ends_with(modelFilenameOptimized, "_lines")) {
+        if (isLineMesh) {
             if (!useProgrammableFetch) {
                 gatherShaderIDs = {"PseudoPhongTrajectories.Vertex", "PseudoPhongTrajectories.Geometry",
                                    "PseudoPhongTrajectories.Fragment"};
@@ -702,8 +749,11 @@ void PixelSyncApp::loadModel(const std::string &filename, bool resetCamera)
     updateShaderMode(SHADER_MODE_UPDATE_NEW_MODEL);
 
     if (mode != RENDER_MODE_VOXEL_RAYTRACING_LINES && mode != RENDER_MODE_RAYTRACING) {
+        // Only the displayed importance criterion of trajectories is loaded, the others are loaded on demand.
         transparentObject = parseMesh3D(modelFilenameOptimized, transparencyShader, shuffleGeometry,
-                useProgrammableFetch, programmableFetchUseAoS, lineRadius);
+                useProgrammableFetch, programmableFetchUseAoS, lineRadius, shuffleSeed,
+                modelType == MODEL_TYPE_TRAJECTORIES ? importanceCriterionIndex : -1);
+        pendingImportanceCriterionIndex = -1;
         if (shaderMode == SHADER_MODE_SCIENTIFIC_ATTRIBUTE) {
             recomputeHistogramForMesh();
         }
@@ -728,7 +778,7 @@ void PixelSyncApp::loadModel(const std::string &filename, bool resetCamera)
         }
     } else if (mode == RENDER_MODE_VOXEL_RAYTRACING_LINES) {
         transparentObject = parseMesh3D(modelFilenameOptimized, transparencyShader, shuffleGeometry,
-                useProgrammableFetch, programmableFetchUseAoS);
+                useProgrammableFetch, programmableFetchUseAoS, 0.001f, shuffleSeed);
         boundingBox = transparentObject.boundingBox;
         std::vector<float> lineAttributes;
         OIT_VoxelRaytracing *voxelRaytracer = (OIT_VoxelRaytracing*)oitRenderer.get();
@@ -743,7 +793,7 @@ void PixelSyncApp::loadModel(const std::string &filename, bool resetCamera)
 #ifdef USE_RAYTRACING
     } else if (mode == RENDER_MODE_RAYTRACING) {
         transparentObject = parseMesh3D(modelFilenameOptimized, transparencyShader, shuffleGeometry,
-                useProgrammableFetch, programmableFetchUseAoS);
+                useProgrammableFetch, programmableFetchUseAoS, 0.001f, shuffleSeed);
         boundingBox = transparentObject.boundingBox;
         std::vector<float> lineAttributes;
         OIT_RayTracing *raytracer = (OIT_RayTracing*)oitRenderer.get();
@@ -892,13 +942,49 @@ void PixelSyncApp::changeImportanceCriterionType()
     ShaderManager->addPreprocessorDefine("IMPORTANCE_CRITERION_INDEX", importanceCriterionIndex);
 }
 
+void PixelSyncApp::switchImportanceCriterion(bool waitForLoading)
+{
+    int lastImportanceCriterionIndex = importanceCriterionIndex;
+    changeImportanceCriterionType();
+    if (transparentObject.isLoaded() && modelType == MODEL_TYPE_TRAJECTORIES
+            && importanceCriterionIndex < getNumImportanceCriteria(trajectoryType)
+            && !transparentObject.getImportanceCriterionAttribute(importanceCriterionIndex)) {
+        // The importance criterion wasn't computed yet. loadModel appends it to the converted mesh.
+        loadModel(MODEL_FILENAMES[usedModelIndex], false);
+        return;
+    }
+    if (transparentObject.isLoaded() && !transparentObject.isImportanceCriterionLoaded(importanceCriterionIndex)) {
+        // The importance criterion wasn't loaded by parseMesh3D.
+        if (waitForLoading) {
+            transparentObject.loadImportanceCriterion(importanceCriterionIndex);
+        } else {
+            // Keep displaying the last importance criterion until the new one is uploaded (see update).
+            transparentObject.loadImportanceCriterionAsync(importanceCriterionIndex);
+            pendingImportanceCriterionIndex = importanceCriterionIndex;
+            importanceCriterionIndex = lastImportanceCriterionIndex;
+            ShaderManager->addPreprocessorDefine("IMPORTANCE_CRITERION_INDEX", importanceCriterionIndex);
+            return;
+        }
+    }
+    pendingImportanceCriterionIndex = -1;
+
+    recomputeHistogramForMesh();
+    ShaderManager->invalidateShaderCache();
+    updateShaderMode(SHADER_MODE_UPDATE_EFFECT_CHANGE);
+    transparentObject.setNewShader(transparencyShader);
+    reRender = true;
+}
+
 void PixelSyncApp::recomputeHistogramForMesh()
 {
-    ImportanceCriterionAttribute importanceCriterionAttribute =
-            transparentObject.importanceCriterionAttributes.at(importanceCriterionIndex);
-    minCriterionValue = importanceCriterionAttribute.minAttribute;
-    maxCriterionValue = importanceCriterionAttribute.maxAttribute;
-    transferFunctionWindow.computeHistogram(importanceCriterionAttribute.attributes,
+    ImportanceCriterionAttribute *importanceCriterionAttribute =
+            transparentObject.getImportanceCriterionAttribute(importanceCriterionIndex);
+    if (!importanceCriterionAttribute) {
+        return;
+    }
+    minCriterionValue = importanceCriterionAttribute->minAttribute;
+    maxCriterionValue = importanceCriterionAttribute->maxAttribute;
+    transferFunctionWindow.computeHistogram(importanceCriterionAttribute->attributes,
             minCriterionValue, maxCriterionValue);
 }
 
@@ -1163,8 +1249,10 @@ void PixelSyncApp::setNewState(const InternalState &newState)
         exit(1);
     }
     if (newModelIndex != usedModelIndex || shuffleGeometry != newState.testShuffleGeometry
+            || (newState.testShuffleGeometry && shuffleSeed != newState.shuffleSeed)
             || oldLineRenderingTechnique != lineRenderingTechnique) {
         shuffleGeometry = newState.testShuffleGeometry;
+        shuffleSeed = newState.shuffleSeed;
         loadModel(modelFilename);
     }
     usedModelIndex = newModelIndex;
@@ -1185,12 +1273,8 @@ void PixelSyncApp::setNewState(const InternalState &newState)
             importanceCriterionTypeConvectionRolls
                     = (ImportanceCriterionTypeConvectionRolls)newState.importanceCriterionIndex;
         }
-        changeImportanceCriterionType();
-        recomputeHistogramForMesh();
-        ShaderManager->invalidateShaderCache();
-        updateShaderMode(SHADER_MODE_UPDATE_EFFECT_CHANGE);
-        transparentObject.setNewShader(transparencyShader);
-        reRender = true;
+        // Measurements need the new importance criterion from the first frame on.
+        switchImportanceCriterion(true);
     }
 
     // 4. Set OIT algorithm
@@ -1317,6 +1401,15 @@ void PixelSyncApp::render()
         renderOIT();
         reRender = false;
         Renderer->unbindFBO();
+
+        if (measureTimeToFirstFrame) {
+            // Includes loading, preprocessing and uploading the data and compiling the shaders.
+            glFinish();
+            double timeToFirstFrameMS = double(Timer->getTicksMicroseconds() - loadModelTimeStampStart) * 1e-3;
+            Logfile::get()->writeInfo(std::string() + "Time to first frame for \"" + modelFilenamePure + "\": "
+                    + sgl::toString(timeToFirstFrameMS) + "ms");
+            measureTimeToFirstFrame = false;
+        }
     }
 
     if ((perfMeasurementMode && timeCoherence) || recording)
@@ -1787,12 +1880,7 @@ void PixelSyncApp::renderSceneSettingsGUI()
                 && ImGui::Combo("Importance Criterion", (int*)&importanceCriterionTypeCFD,
                                 IMPORTANCE_CRITERION_CFD_DISPLAYNAMES,
                                 IM_ARRAYSIZE(IMPORTANCE_CRITERION_CFD_DISPLAYNAMES))))) {
-            changeImportanceCriterionType();
-            recomputeHistogramForMesh();
-            ShaderManager->invalidateShaderCache();
-            updateShaderMode(SHADER_MODE_UPDATE_EFFECT_CHANGE);
-            transparentObject.setNewShader(transparencyShader);
-            reRender = true;
+            switchImportanceCriterion(false);
         }
     }
 
@@ -1845,6 +1933,7 @@ void PixelSyncApp::renderSceneSettingsGUI()
     }
     if (ImGui::Button("Shuffle")) {
         shuffleGeometry = true;
+        shuffleSeed++;
         loadModel(MODEL_FILENAMES[usedModelIndex], false);
         reRender = true;
     }
@@ -2027,6 +2116,15 @@ void PixelSyncApp::update(float dt)
 
     recordingTimeLast = recordingTime;
 
+    if (transparentObject.isLoadingImportanceCriteria()) {
+        transparentObject.updateImportanceCriterionLoading();
+        if (pendingImportanceCriterionIndex >= 0
+                && !transparentObject.isImportanceCriterionLoading(pendingImportanceCriterionIndex)) {
+            // The importance criterion selected by the user is uploaded now (or couldn't be loaded).
+            switchImportanceCriterion(true);
+        }
+    }
+
     if (perfMeasurementMode && !measurer->update(recordingTime)) {
         // All modes were tested -> quit
         quit();
@@ -130,6 +130,7 @@ private:
     ShaderMode shaderMode = SHADER_MODE_PSEUDO_PHONG;
     std::string modelFilenamePure;
     bool shuffleGeometry = false; // For testing order dependency of OIT algorithms on triangle order
+    uint64_t shuffleSeed = 0;
     std::list<std::string> gatherShaderIDs;
 
     // Off-screen rendering
@@ -192,8 +193,16 @@ private:
     bool useProgrammableFetch = false;
     bool programmableFetchUseAoS = true; // Array of structs
     void changeImportanceCriterionType();
+    /**
+     * Switches to the importance criterion selected in the UI (or by the performance measurement state). If it isn't
+     * loaded yet, the last one is displayed while the new one is loaded in the background (unless waitForLoading).
+     * If the converted mesh doesn't contain it yet, the criterion is computed and appended to the converted mesh
+     * (see appendImportanceCriteriaToBinaryMesh).
+     */
+    void switchImportanceCriterion(bool waitForLoading);
     void recomputeHistogramForMesh();
-
+    /// Importance criterion loaded in the background that is displayed as soon as it is uploaded (or -1).
+    int pendingImportanceCriterionIndex = -1;
     // Hair rendering
     bool colorArrayMode = false;
 
@@ -205,6 +214,7 @@ private:
     AutoPerfMeasurer *measurer;
     bool perfMeasurementMode = false;
     bool timeCoherence = false;
+    bool adaptivePerfMeasurement = false; // Stop states early once the median frame time is known precisely enough
     InternalState lastState;
     bool firstState = true;
     bool usesNewState = true;
@@ -217,6 +227,9 @@ private:
     const int FRAME_RATE = 60;
     float FRAME_TIME = 1.0f / FRAME_RATE;
     uint64_t recordingTimeStampStart;
+    // Time from the start of loadModel until the first frame showing the model has finished rendering
+    uint64_t loadModelTimeStampStart = 0;
+    bool measureTimeToFirstFrame = false;
     float recordingTime = 0.0f;
     float recordingTimeLast = 0.0f;
 
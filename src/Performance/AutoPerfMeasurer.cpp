@@ -20,7 +20,9 @@ AutoPerfMeasurer::AutoPerfMeasurer(std::vector<InternalState> _states,
         const std::string &_csvFilename, const std::string &_depthComplexityFilename,
         std::function<void(const InternalState&)> _newStateCallback, bool measureTimeCoherence)
        : states(_states), currentStateIndex(0), newStateCallback(_newStateCallback), file(_csvFilename),
-         depthComplexityFile(_depthComplexityFilename), errorMetricFile("error_metrics.csv"), perfFile("performance_list.csv"), timeCoherence(measureTimeCoherence)
+         depthComplexityFile(_depthComplexityFilename), errorMetricFile("error_metrics.csv"), perfFile("performance_list.csv"),
+         statisticsFile("performance_statistics.csv"), histogramFile("frame_time_histograms.csv"),
+         timeCoherence(measureTimeCoherence)
 {
     sgl::FileUtils::get()->ensureDirectoryExists("images/");
 
@@ -31,6 +33,10 @@ AutoPerfMeasurer::AutoPerfMeasurer(std::vector<InternalState> _states,
                                   "Avg Depth Complexity Used", "Avg Depth Complexity All", "Total Number of Fragments"});
     errorMetricFile.writeRow({"Name", "Error measures"});
     perfFile.writeRow({"Name", "Time per frame (ms)"});
+    statisticsFile.writeRow({"Name", "Warm-up Frames", "Samples", "Mean (ms)", "Median (ms)", "P90 (ms)",
+                             "P99 (ms)", "Standard Deviation (ms)", "Median CI Lower (ms)", "Median CI Upper (ms)",
+                             "Stopped Early"});
+    histogramFile.writeRow({"Name", "Bin Width (ms)", "Frame Counts"});
     setPerformanceMeasurer(this);
 
     // Set initial state
@@ -40,11 +46,16 @@ AutoPerfMeasurer::AutoPerfMeasurer(std::vector<InternalState> _states,
 AutoPerfMeasurer::~AutoPerfMeasurer()
 {
     writeCurrentModeData();
+    errorMetricPipeline.endState();
+    errorMetricPipeline.waitForAll();
+    writeFinishedErrorMetricData();
 
     file.close();
     depthComplexityFile.close();
     errorMetricFile.close();
     perfFile.close();
+    statisticsFile.close();
+    histogramFile.close();
     //perfTimeProfileFile.close();
 }
 
@@ -53,8 +64,13 @@ float nextModeCounter = 0.0f;
 const float TIME_PER_MODE = 32.5f; // in seconds
 bool AutoPerfMeasurer::update(float currentTime)
 {
+    writeFinishedErrorMetricData();
+    updateFrameTimeStatistics();
+
     nextModeCounter = currentTime;
-    if (nextModeCounter >= TIME_PER_MODE) {
+    stoppedEarly = adaptiveMeasurement && !timeCoherence && nextModeCounter < TIME_PER_MODE
+            && frameTimeStatistics.hasConverged();
+    if (nextModeCounter >= TIME_PER_MODE || stoppedEarly) {
         nextModeCounter = 0.0f;
         if (currentStateIndex == states.size()-1) {
             return false; // Terminate program
@@ -64,16 +80,55 @@ bool AutoPerfMeasurer::update(float currentTime)
     return true;
 }
 
+void AutoPerfMeasurer::setAdaptiveMeasurement(bool adaptive, const FrameTimeStatisticsSettings &settings)
+{
+    adaptiveMeasurement = adaptive;
+    frameTimeStatistics = FrameTimeStatistics(settings);
+}
+
+void AutoPerfMeasurer::updateFrameTimeStatistics()
+{
+    const auto &frameTimeList = timerGL.getCurrentFrameTimeList();
+    if (frameTimeList.size() < numProcessedFrameTimes) {
+        // The timer has started a new list for the current state.
+        numProcessedFrameTimes = 0;
+    }
+    for (size_t i = numProcessedFrameTimes; i < frameTimeList.size(); i++) {
+        frameTimeStatistics.addFrameTime(double(frameTimeList.at(i).second) * 1e-6);
+    }
+    numProcessedFrameTimes = frameTimeList.size();
+}
+
 void AutoPerfMeasurer::makeScreenshot()
 {
     std::string filename = std::string() + "images/" + currentState.name + ".png";
-    saveScreenshot(filename);
+    sgl::BitmapPtr image = readScreenshot();
+    if (currentState.oitAlgorithm == RENDER_MODE_OIT_DEPTH_PEELING) {
+        referenceImage = image;
+    }
+    errorMetricPipeline.saveImageAsync(image, filename, true);
 }
 
 void AutoPerfMeasurer::makeScreenshot(uint32_t frameNum)
 {
     std::string filename = std::string() + "images/" + currentState.name + "_frame_" + std::to_string(frameNum) + ".png";
-    saveScreenshot(filename);
+    sgl::BitmapPtr image = readScreenshot();
+
+    // Frames used for the error metrics (compared to the frames rendered using depth peeling)
+    const uint32_t MAX_FRAMES = 64;
+    if (timeCoherence && currentState.oitAlgorithm != RENDER_MODE_OIT_DEPTH_COMPLEXITY
+            && frameNum >= 1 && frameNum <= MAX_FRAMES) {
+        std::string differenceMapFilename;
+        if (saveFrameImages) {
+            differenceMapFilename = std::string() + "images/" + currentState.name + " Difference_frame_"
+                    + std::to_string(frameNum) + ".png";
+        }
+        errorMetricPipeline.addFrame(frameNum, image, differenceMapFilename);
+    }
+
+    if (saveFrameImages) {
+        errorMetricPipeline.saveImageAsync(image, filename, true);
+    }
 }
 
 void AutoPerfMeasurer::writeCurrentModeData()
@@ -85,13 +140,10 @@ void AutoPerfMeasurer::writeCurrentModeData()
     perfFile.writeCell(currentState.name);
     file.writeCell(sgl::toString(timeMS));
 
-    // Make screenshot of rendering result with current algorithm
+    // Screenshot of rendering result with current algorithm (saved by makeScreenshot)
     std::string filename = std::string() + "images/" + currentState.name + ".png";
     file.writeCell(filename);
-    sgl::BitmapPtr image(new sgl::Bitmap());
-    image->fromFile(filename.c_str());
     if (currentState.oitAlgorithm == RENDER_MODE_OIT_DEPTH_PEELING) {
-        referenceImage = image;
         stateNameDepthPeeling = currentState.name;
     }
 
@@ -139,6 +191,29 @@ void AutoPerfMeasurer::writeCurrentModeData()
     file.newRow();
     perfFile.newRow();
 
+    // Write the statistics of the frame times after the warm-up phase
+    updateFrameTimeStatistics();
+    FrameTimeSummary summary = frameTimeStatistics.computeSummary();
+    statisticsFile.writeCell(currentState.name);
+    statisticsFile.writeCell(sgl::toString(int(summary.numWarmUpFrames)));
+    statisticsFile.writeCell(sgl::toString(int(summary.numSamples)));
+    statisticsFile.writeCell(sgl::toString(summary.mean));
+    statisticsFile.writeCell(sgl::toString(summary.median));
+    statisticsFile.writeCell(sgl::toString(summary.p90));
+    statisticsFile.writeCell(sgl::toString(summary.p99));
+    statisticsFile.writeCell(sgl::toString(summary.standardDeviation));
+    statisticsFile.writeCell(sgl::toString(summary.confidenceIntervalLower));
+    statisticsFile.writeCell(sgl::toString(summary.confidenceIntervalUpper));
+    statisticsFile.writeCell(stoppedEarly ? "1" : "0");
+    statisticsFile.newRow();
+
+    histogramFile.writeCell(currentState.name);
+    histogramFile.writeCell(sgl::toString(frameTimeStatistics.getSettings().histogramBinWidthMS));
+    for (uint32_t count : frameTimeStatistics.getHistogram()) {
+        histogramFile.writeCell(sgl::toString(int(count)));
+    }
+    histogramFile.newRow();
+
     /*perfTimeProfileFile.writeCell(currentState.name);
     auto performanceProfile = timerGL.getCurrentFrameTimeList();
     for (auto &perfPair : performanceProfile) {
@@ -150,68 +225,29 @@ void AutoPerfMeasurer::writeCurrentModeData()
     perfTimeProfileFile.newRow();*/
 }
 
-void AutoPerfMeasurer::writeCurrentErrorMetricData()
+void AutoPerfMeasurer::writeFinishedErrorMetricData()
 {
-    if (currentState.oitAlgorithm == RENDER_MODE_OIT_DEPTH_PEELING) {
-        stateNameDepthPeeling = currentState.name;
-        return;
-    }
-
-    std::vector<std::string> errorMetrics = { "RMSE", "PSNR", "SSIM" };
-    const uint32_t MAX_FRAMES = 64;
-
-    std::vector<double> rmseValues; rmseValues.reserve(MAX_FRAMES);
-    std::vector<double> psnrValues; psnrValues.reserve(MAX_FRAMES);
-    std::vector<double> ssimValues; ssimValues.reserve(MAX_FRAMES);
-
-    std::vector<std::vector<double>> errorMeasures;
-
-    for (uint32_t f = 1; f <= MAX_FRAMES; ++f)
-    {
-        // reference image
-        std::string filenameGT = std::string() + "images/" + stateNameDepthPeeling + "_frame_" + std::to_string(f) + ".png";
-        sgl::BitmapPtr refImage(new sgl::Bitmap());
-        refImage->fromFile(filenameGT.c_str());
-
-        // output image
-        std::string filename = std::string() + "images/" + currentState.name + "_frame_" + std::to_string(f) + ".png";
-        sgl::BitmapPtr outputImage(new sgl::Bitmap());
-        outputImage->fromFile(filename.c_str());
-
-        // Save normalized difference map
-        std::string differenceMapFilename = std::string() + "images/" + currentState.name + " Difference_frame_" + std::to_string(f) + ".png";
-        sgl::BitmapPtr differenceMap = computeNormalizedDifferenceMap(refImage, outputImage);
-        differenceMap->savePNG(differenceMapFilename.c_str());
-
-//        if (f == 1)
-//        {
-//            errorMetricFile.writeCell(filenameGT);
-//            errorMetricFile.writeCell(filename);
-//        }
-
-        rmseValues.push_back(rmse(refImage, outputImage));
-        psnrValues.push_back(psnr(refImage, outputImage));
-        ssimValues.push_back(ssim(refImage, outputImage));
-//        errorMetricFile.writeCell(sgl::toString(metric));
-    }
-
-    errorMeasures.push_back(rmseValues);
-    errorMeasures.push_back(psnrValues);
-    errorMeasures.push_back(ssimValues);
+    StateErrorMetrics stateMetrics;
+    while (errorMetricPipeline.popFinishedState(stateMetrics)) {
+        if (stateMetrics.frames.empty()) {
+            continue;
+        }
 
+        std::vector<std::string> errorMetrics = { "RMSE", "PSNR", "SSIM" };
+        for (size_t i = 0; i < errorMetrics.size(); ++i)
+        {
+            std::string metricName = errorMetrics[i];
 
-    for (uint32_t i = 0; i < errorMeasures.size(); ++i)
-    {
-        std::string metricName = errorMetrics[i];
+            errorMetricFile.writeCell(stateMetrics.stateName + " (" + metricName + ")");
 
-        errorMetricFile.writeCell(currentState.name + " (" + metricName + ")");
+            for (const FrameErrorMetrics &frameMetrics : stateMetrics.frames)
+            {
+                double value = i == 0 ? frameMetrics.rmse : (i == 1 ? frameMetrics.psnr : frameMetrics.ssim);
+                errorMetricFile.writeCell(sgl::toString(value));
+            }
 
-        for (uint32_t f = 0; f < MAX_FRAMES; ++f)
-        {
-            errorMetricFile.writeCell(sgl::toString(errorMeasures[i][f]));
+            errorMetricFile.newRow();
         }
-
-        errorMetricFile.newRow();
     }
 }
 
@@ -220,18 +256,20 @@ void AutoPerfMeasurer::setNextState(bool first)
     if (!first) {
         if (currentState.oitAlgorithm != RENDER_MODE_OIT_DEPTH_COMPLEXITY)
         {
-            if (timeCoherence) {
-//                writeCurrentErrorMetricData();
-            }
-                writeCurrentModeData();
+            writeCurrentModeData();
         }
 
+        errorMetricPipeline.endState();
         currentStateIndex++;
     }
 
     depthComplexityFrameNumber = 0;
     currentAlgorithmsBufferSizeBytes = 0;
+    frameTimeStatistics.reset();
+    numProcessedFrameTimes = timerGL.getCurrentFrameTimeList().size();
+    stoppedEarly = false;
     currentState = states.at(currentStateIndex);
+    errorMetricPipeline.beginState(currentState.name, currentState.oitAlgorithm == RENDER_MODE_OIT_DEPTH_PEELING);
     sgl::Logfile::get()->writeInfo(std::string() + "New state: " + currentState.name);
     newStateCallback(currentState);
 }
@@ -276,7 +314,7 @@ void AutoPerfMeasurer::setCurrentAlgorithmBufferSizeBytes(size_t numBytes)
     currentAlgorithmsBufferSizeBytes = numBytes;
 }
 
-void AutoPerfMeasurer::saveScreenshot(const std::string &filename)
+sgl::BitmapPtr AutoPerfMeasurer::readScreenshot()
 {
     sgl::Window *window = sgl::AppSettings::get()->getMainWindow();
     int width = window->getWidth();
@@ -286,8 +324,8 @@ void AutoPerfMeasurer::saveScreenshot(const std::string &filename)
     //sgl::Renderer->unbindFBO();
     sgl::BitmapPtr bitmap(new sgl::Bitmap(width, height, 32));
     glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, bitmap->getPixels());
-    bitmap->savePNG(filename.c_str(), true);
     //sgl::Renderer->unbindFBO();
+    return bitmap;
 }
 
 /*#ifndef GL_QUERY_RESOURCE_TYPE_VIDMEM_ALLOC_NV
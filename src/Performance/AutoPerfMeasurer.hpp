@@ -13,6 +13,8 @@
 
 #include "CsvWriter.hpp"
 #include "InternalState.hpp"
+#include "ErrorMetricPipeline.hpp"
+#include "FrameTimeStatistics.hpp"
 
 class AutoPerfMeasurer {
 public:
@@ -35,6 +37,16 @@ public:
 
     void resolutionChanged(sgl::FramebufferObjectPtr _sceneFramebuffer);
 
+    /**
+     * Whether a state is stopped before TIME_PER_MODE once the bootstrap confidence interval of the median frame
+     * time is narrower than the relative width set in the settings. Never used when measuring time coherence
+     * (all frames are needed for the error metrics).
+     */
+    void setAdaptiveMeasurement(bool adaptive, const FrameTimeStatisticsSettings &settings);
+
+    /// Whether the frames used for computing error metrics (and their difference maps) are saved as PNG files.
+    inline void setSaveFrameImages(bool saveImages) { saveFrameImages = saveImages; }
+
     // Called by OIT_DepthComplexity
     void pushDepthComplexityFrame(uint64_t minComplexity, uint64_t maxComplexity, float avgUsed, float avgAll,
             uint64_t totalNumFragments);
@@ -45,13 +57,15 @@ public:
 private:
     /// Write out the performance data of "currentState" to "file".
     void writeCurrentModeData();
-    /// Write out the error metrics of "currentState" to "file".
-    void writeCurrentErrorMetricData();
+    /// Write out the error metrics of all states finished by the error metric pipeline to "errorMetricFile".
+    void writeFinishedErrorMetricData();
+    /// Add the frame times measured since the last call to "frameTimeStatistics".
+    void updateFrameTimeStatistics();
     /// Switch to the next state in "states".
     void setNextState(bool first = false);
 
-    /// Make screenshot of scene rendering framebuffer
-    void saveScreenshot(const std::string &filename);
+    /// Read back the content of the window framebuffer (bottom-up row order).
+    sgl::BitmapPtr readScreenshot();
 
     /// Returns amount of used video memory size in gigabytes
     float getUsedVideoMemorySizeGB();
@@ -71,6 +85,8 @@ private:
     CsvWriter depthComplexityFile;
     CsvWriter errorMetricFile;
     CsvWriter perfFile;
+    CsvWriter statisticsFile;
+    CsvWriter histogramFile;
     size_t depthComplexityFrameNumber = 0;
     size_t currentAlgorithmsBufferSizeBytes = 0;
 
@@ -78,6 +94,16 @@ private:
     sgl::FramebufferObjectPtr sceneFramebuffer;
     sgl::BitmapPtr referenceImage; // Rendered using depth peeling
     std::string stateNameDepthPeeling;
+
+    // Computes the error metrics of the frames (when measuring time coherence) and saves images in the background
+    ErrorMetricPipeline errorMetricPipeline;
+    bool saveFrameImages = true;
+
+    // Statistics of the frame times of the current state
+    FrameTimeStatistics frameTimeStatistics;
+    size_t numProcessedFrameTimes = 0;
+    bool adaptiveMeasurement = false;
+    bool stoppedEarly = false;
 };
 
 
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <thread>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <Utils/File/Logfile.hpp>
+
+#include "ReferenceMetric.hpp"
+#include "ErrorMetricPipeline.hpp"
+
+static size_t getDefaultNumWorkerThreads()
+{
+    return std::max(size_t(std::thread::hardware_concurrency()) / 2, size_t(1));
+}
+
+/// The workers process separate frames in parallel, so the metric kernels themselves run single-threaded.
+static void disableNestedParallelism()
+{
+#ifdef _OPENMP
+    omp_set_num_threads(1);
+#endif
+}
+
+ErrorMetricPipeline::ErrorMetricPipeline(size_t numWorkerThreads, size_t maxNumPendingFrames)
+        : threadPool(numWorkerThreads == 0 ? getDefaultNumWorkerThreads() : numWorkerThreads),
+          maxNumPendingFrames(std::max(maxNumPendingFrames, size_t(1)))
+{
+}
+
+ErrorMetricPipeline::~ErrorMetricPipeline()
+{
+    waitForAll();
+}
+
+void ErrorMetricPipeline::beginState(const std::string &stateName, bool isReferenceState)
+{
+    currentStateIsReference = isReferenceState;
+    if (isReferenceState) {
+        referenceFrames.clear();
+    }
+
+    std::shared_ptr<StateRecord> record(new StateRecord);
+    record->metrics.stateName = stateName;
+    std::lock_guard<std::mutex> lock(mutex);
+    stateRecords.push_back(record);
+}
+
+void ErrorMetricPipeline::addFrame(
+        uint32_t frameNumber, const sgl::BitmapPtr &frame, const std::string &differenceMapFilename)
+{
+    if (currentStateIsReference) {
+        referenceFrames[frameNumber] = frame;
+        return;
+    }
+
+    if (referenceFrames.empty()) {
+        // No reference state was rendered yet.
+        return;
+    }
+    auto it = referenceFrames.find(frameNumber);
+    if (it == referenceFrames.end()) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in ErrorMetricPipeline::addFrame: No reference "
+                + "frame with number " + std::to_string(frameNumber) + ".");
+        return;
+    }
+    sgl::BitmapPtr referenceFrame = it->second;
+
+    std::shared_ptr<StateRecord> record;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        record = stateRecords.back();
+        record->numPendingFrames++;
+    }
+
+    acquireFrameSlot();
+    threadPool.enqueue([this, record, frameNumber, frame, referenceFrame, differenceMapFilename]() {
+        disableNestedParallelism();
+        FrameErrorMetrics frameMetrics;
+        frameMetrics.frameNumber = frameNumber;
+        frameMetrics.mse = mse(referenceFrame, frame);
+        frameMetrics.rmse = rmse(referenceFrame, frame);
+        frameMetrics.psnr = psnr(referenceFrame, frame);
+        frameMetrics.ssim = ssim(referenceFrame, frame);
+
+        if (!differenceMapFilename.empty()) {
+            sgl::BitmapPtr differenceMap = computeNormalizedDifferenceMap(referenceFrame, frame);
+            differenceMap->savePNG(differenceMapFilename.c_str(), true);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            record->metrics.frames.push_back(frameMetrics);
+            record->numPendingFrames--;
+        }
+        releaseFrameSlot();
+    });
+}
+
+void ErrorMetricPipeline::endState()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!stateRecords.empty()) {
+        stateRecords.back()->ended = true;
+    }
+}
+
+void ErrorMetricPipeline::saveImageAsync(const sgl::BitmapPtr &image, const std::string &filename, bool mirror)
+{
+    acquireFrameSlot();
+    threadPool.enqueue([this, image, filename, mirror]() {
+        image->savePNG(filename.c_str(), mirror);
+        releaseFrameSlot();
+    });
+}
+
+bool ErrorMetricPipeline::popFinishedState(StateErrorMetrics &stateMetrics)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stateRecords.empty() || !stateRecords.front()->ended || stateRecords.front()->numPendingFrames != 0) {
+        return false;
+    }
+
+    stateMetrics = stateRecords.front()->metrics;
+    stateRecords.pop_front();
+    std::sort(stateMetrics.frames.begin(), stateMetrics.frames.end(),
+            [](const FrameErrorMetrics &a, const FrameErrorMetrics &b) { return a.frameNumber < b.frameNumber; });
+    return true;
+}
+
+void ErrorMetricPipeline::waitForAll()
+{
+    threadPool.waitForAll();
+}
+
+void ErrorMetricPipeline::acquireFrameSlot()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    frameSlotCondition.wait(lock, [this]() { return numPendingFrames < maxNumPendingFrames; });
+    numPendingFrames++;
+}
+
+void ErrorMetricPipeline::releaseFrameSlot()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        numPendingFrames--;
+    }
+    frameSlotCondition.notify_one();
+}
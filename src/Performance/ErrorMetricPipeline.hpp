@@ -0,0 +1,99 @@
+#ifndef PIXELSYNCOIT_ERRORMETRICPIPELINE_HPP
+#define PIXELSYNCOIT_ERRORMETRICPIPELINE_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+
+#include <Graphics/Texture/Bitmap.hpp>
+
+#include "Utils/ThreadPool.hpp"
+
+/// Error metrics of one frame of a state compared to the same frame of the reference state.
+struct FrameErrorMetrics
+{
+    uint32_t frameNumber;
+    double mse, rmse, psnr, ssim;
+};
+
+struct StateErrorMetrics
+{
+    std::string stateName;
+    /// Sorted by frame number. Empty for reference states and states without frames.
+    std::vector<FrameErrorMetrics> frames;
+};
+
+/**
+ * Computes the error metrics of rendered frames against the frames of a reference state (depth peeling) in
+ * worker threads, i.e., while the next frames or states are rendered. The frames are kept in memory instead of
+ * being written to and re-read from PNG files.
+ * The number of frames waiting for being processed is bounded. If the bound is reached, addFrame blocks until
+ * a worker has finished a frame. The frames of the current reference state are kept until the next reference
+ * state begins.
+ * All functions except for the workers are meant to be called from the main (rendering) thread.
+ */
+class ErrorMetricPipeline
+{
+public:
+    /**
+     * @param numWorkerThreads The number of worker threads. 0 means half the number of hardware threads.
+     * @param maxNumPendingFrames The maximum number of frames (and images to save) waiting for being processed.
+     */
+    explicit ErrorMetricPipeline(size_t numWorkerThreads = 0, size_t maxNumPendingFrames = 32);
+    /// Waits for all pending work.
+    ~ErrorMetricPipeline();
+
+    /// Starts a new state. The frames of a reference state replace the frames of the last reference state.
+    void beginState(const std::string &stateName, bool isReferenceState);
+    /**
+     * Adds a frame of the current state. For non-reference states, the metrics are computed against the reference
+     * frame with the same frame number (frames without a reference frame are skipped).
+     * @param frame The frame as an RGBA8 bitmap (the pipeline takes ownership, i.e., it must not be changed anymore).
+     * @param differenceMapFilename If not empty, the difference map of the frame is saved to this file.
+     */
+    void addFrame(uint32_t frameNumber, const sgl::BitmapPtr &frame, const std::string &differenceMapFilename = "");
+    /// Marks the current state as finished. Its metrics can be retrieved when all of its frames were processed.
+    void endState();
+
+    /// Saves the image as a PNG file in a worker thread (mirror: flip vertically, e.g. for OpenGL read-backs).
+    void saveImageAsync(const sgl::BitmapPtr &image, const std::string &filename, bool mirror);
+
+    /**
+     * Returns the metrics of the oldest finished state if all of its frames were processed (non-blocking).
+     * The states are returned in the order in which they were started.
+     */
+    bool popFinishedState(StateErrorMetrics &stateMetrics);
+    /// Blocks until all frames and images were processed.
+    void waitForAll();
+
+private:
+    struct StateRecord
+    {
+        StateErrorMetrics metrics;
+        size_t numPendingFrames = 0;
+        bool ended = false;
+    };
+
+    /// Blocks until less than maxNumPendingFrames frames are waiting for being processed.
+    void acquireFrameSlot();
+    void releaseFrameSlot();
+
+    ThreadPool threadPool;
+    std::mutex mutex;
+    std::condition_variable frameSlotCondition;
+    size_t maxNumPendingFrames;
+    size_t numPendingFrames = 0;
+
+    // Only accessed by the main thread. The workers hold their own references to the frames.
+    std::map<uint32_t, sgl::BitmapPtr> referenceFrames;
+    bool currentStateIsReference = false;
+
+    /// Records of all states not popped yet (protected by mutex).
+    std::deque<std::shared_ptr<StateRecord>> stateRecords;
+};
+
+#endif //PIXELSYNCOIT_ERRORMETRICPIPELINE_HPP
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "FrameTimeStatistics.hpp"
+
+static double computeMedian(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    return FrameTimeStatistics::computeQuantile(values, 0.5);
+}
+
+FrameTimeStatistics::FrameTimeStatistics(const FrameTimeStatisticsSettings &settings) : settings(settings)
+{
+    reset();
+}
+
+void FrameTimeStatistics::reset()
+{
+    warmUpFinished = false;
+    numWarmUpFrames = 0;
+    warmUpFrames.clear();
+    samples.clear();
+    histogram.assign(std::max(settings.numHistogramBins, size_t(1)), 0);
+    converged = false;
+    numSamplesLastConvergenceCheck = 0;
+}
+
+void FrameTimeStatistics::addFrameTime(double frameTimeMS)
+{
+    if (warmUpFinished) {
+        addSample(frameTimeMS);
+    } else {
+        warmUpFrames.push_back(frameTimeMS);
+        checkWarmUpFinished();
+    }
+}
+
+void FrameTimeStatistics::addSample(double frameTimeMS)
+{
+    samples.push_back(frameTimeMS);
+    size_t binIndex = size_t(std::max(frameTimeMS, 0.0) / settings.histogramBinWidthMS);
+    histogram.at(std::min(binIndex, histogram.size() - 1))++;
+}
+
+void FrameTimeStatistics::checkWarmUpFinished()
+{
+    const size_t windowSize = std::max(settings.warmUpWindowSize, size_t(1));
+    const size_t numFrames = warmUpFrames.size();
+    bool stable = false;
+    if (numFrames >= 2 * windowSize) {
+        double medianPrevious = computeMedian(std::vector<double>(
+                warmUpFrames.end() - 2 * windowSize, warmUpFrames.end() - windowSize));
+        double medianLast = computeMedian(std::vector<double>(warmUpFrames.end() - windowSize, warmUpFrames.end()));
+        stable = std::abs(medianLast - medianPrevious) <= settings.warmUpTolerance * medianPrevious;
+    }
+    if (!stable && numFrames < settings.maxNumWarmUpFrames) {
+        return;
+    }
+
+    // The frames of the two stable windows already belong to the measurement.
+    warmUpFinished = true;
+    size_t numStableFrames = stable ? 2 * windowSize : 0;
+    numWarmUpFrames = numFrames - numStableFrames;
+    for (size_t i = numWarmUpFrames; i < numFrames; i++) {
+        addSample(warmUpFrames[i]);
+    }
+    warmUpFrames.clear();
+    warmUpFrames.shrink_to_fit();
+}
+
+double FrameTimeStatistics::computeQuantile(const std::vector<double> &sortedValues, double quantile)
+{
+    if (sortedValues.empty()) {
+        return 0.0;
+    }
+    double position = quantile * double(sortedValues.size() - 1);
+    size_t lowerIndex = size_t(std::floor(position));
+    size_t upperIndex = std::min(lowerIndex + 1, sortedValues.size() - 1);
+    double t = position - double(lowerIndex);
+    return (1.0 - t) * sortedValues[lowerIndex] + t * sortedValues[upperIndex];
+}
+
+void FrameTimeStatistics::computeMedianConfidenceInterval(const std::vector<double> &values, size_t numResamples,
+        double confidenceLevel, uint64_t seed, double &lower, double &upper)
+{
+    if (values.empty() || numResamples == 0) {
+        lower = upper = 0.0;
+        return;
+    }
+
+    // Every resample uses its own generator, so the result does not depend on the number of threads.
+    const size_t n = values.size();
+    std::vector<double> resampleMedians(numResamples);
+    #pragma omp parallel
+    {
+        std::vector<double> resample(n);
+
+        #pragma omp for
+        for (size_t b = 0; b < numResamples; b++) {
+            std::mt19937_64 generator(seed + b * 0x9E3779B97F4A7C15ull);
+            for (size_t i = 0; i < n; i++) {
+                // Maps the upper 32 bits to [0, n) by a multiply-shift instead of a rejection loop.
+                uint64_t r = generator();
+                resample[i] = values[size_t((uint64_t(r >> 32) * uint64_t(n)) >> 32)];
+            }
+            // Median with linear interpolation between the two middle elements (as computeQuantile).
+            std::nth_element(resample.begin(), resample.begin() + (n - 1) / 2, resample.end());
+            double median = resample[(n - 1) / 2];
+            if (n % 2 == 0) {
+                median = 0.5 * (median + *std::min_element(resample.begin() + n / 2, resample.end()));
+            }
+            resampleMedians[b] = median;
+        }
+    }
+
+    std::sort(resampleMedians.begin(), resampleMedians.end());
+    double alpha = 1.0 - confidenceLevel;
+    lower = computeQuantile(resampleMedians, 0.5 * alpha);
+    upper = computeQuantile(resampleMedians, 1.0 - 0.5 * alpha);
+}
+
+FrameTimeSummary FrameTimeStatistics::computeSummary() const
+{
+    FrameTimeSummary summary;
+    summary.numWarmUpFrames = warmUpFinished ? numWarmUpFrames : warmUpFrames.size();
+    summary.numSamples = samples.size();
+    if (samples.empty()) {
+        return summary;
+    }
+
+    std::vector<double> sortedSamples = samples;
+    std::sort(sortedSamples.begin(), sortedSamples.end());
+    summary.min = sortedSamples.front();
+    summary.max = sortedSamples.back();
+    summary.median = computeQuantile(sortedSamples, 0.5);
+    summary.p90 = computeQuantile(sortedSamples, 0.9);
+    summary.p99 = computeQuantile(sortedSamples, 0.99);
+
+    double sum = 0.0;
+    for (double sample : sortedSamples) {
+        sum += sample;
+    }
+    summary.mean = sum / double(sortedSamples.size());
+    double squaredDifferenceSum = 0.0;
+    for (double sample : sortedSamples) {
+        squaredDifferenceSum += (sample - summary.mean) * (sample - summary.mean);
+    }
+    if (sortedSamples.size() > 1) {
+        summary.standardDeviation = std::sqrt(squaredDifferenceSum / double(sortedSamples.size() - 1));
+    }
+
+    computeMedianConfidenceInterval(samples, settings.numBootstrapResamples, settings.confidenceLevel,
+            settings.bootstrapSeed, summary.confidenceIntervalLower, summary.confidenceIntervalUpper);
+    return summary;
+}
+
+bool FrameTimeStatistics::hasConverged()
+{
+    if (converged) {
+        return true;
+    }
+    if (!warmUpFinished || samples.size() < settings.minNumSamples
+            || samples.size() < numSamplesLastConvergenceCheck + settings.convergenceCheckInterval) {
+        return false;
+    }
+    numSamplesLastConvergenceCheck = samples.size();
+
+    std::vector<double> sortedSamples = samples;
+    std::sort(sortedSamples.begin(), sortedSamples.end());
+    double median = computeQuantile(sortedSamples, 0.5);
+    double lower, upper;
+    computeMedianConfidenceInterval(samples, settings.numBootstrapResamples, settings.confidenceLevel,
+            settings.bootstrapSeed, lower, upper);
+    converged = median > 0.0 && (upper - lower) / median < settings.maxRelativeConfidenceIntervalWidth;
+    return converged;
+}
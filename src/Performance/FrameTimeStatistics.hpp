@@ -0,0 +1,100 @@
+#ifndef PIXELSYNCOIT_FRAMETIMESTATISTICS_HPP
+#define PIXELSYNCOIT_FRAMETIMESTATISTICS_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+struct FrameTimeStatisticsSettings
+{
+    // --- Warm-up detection ---
+    /// Number of frames of the two windows whose medians are compared.
+    size_t warmUpWindowSize = 30;
+    /// The warm-up ends when the medians of the last two windows differ by at most this factor (relative).
+    double warmUpTolerance = 0.05;
+    /// The warm-up ends after at most this number of frames.
+    size_t maxNumWarmUpFrames = 600;
+
+    // --- Histogram ---
+    double histogramBinWidthMS = 0.25;
+    /// Frame times larger than numHistogramBins * histogramBinWidthMS are counted in the last bin.
+    size_t numHistogramBins = 800;
+
+    // --- Bootstrap confidence interval of the median ---
+    size_t numBootstrapResamples = 1000;
+    double confidenceLevel = 0.95;
+    uint64_t bootstrapSeed = 17;
+
+    // --- Early stopping ---
+    /// Converged if (upper - lower bound of the confidence interval) / median is less than this value.
+    double maxRelativeConfidenceIntervalWidth = 0.01;
+    /// Minimum number of samples (after the warm-up) before checking for convergence.
+    size_t minNumSamples = 200;
+    /// The (expensive) bootstrap is only re-evaluated after this number of new samples.
+    size_t convergenceCheckInterval = 50;
+};
+
+struct FrameTimeSummary
+{
+    size_t numWarmUpFrames = 0;
+    size_t numSamples = 0;
+    double mean = 0.0, median = 0.0, p90 = 0.0, p99 = 0.0;
+    double standardDeviation = 0.0;
+    double min = 0.0, max = 0.0;
+    /// Bootstrap confidence interval of the median.
+    double confidenceIntervalLower = 0.0, confidenceIntervalUpper = 0.0;
+};
+
+/**
+ * Collects the frame times of one measured state. Frames until the end of the warm-up phase are discarded.
+ * The end of the warm-up is detected by comparing the medians of the last two windows of frames.
+ * The statistics do not depend on OpenGL, i.e. they can be evaluated on synthetic timing series.
+ */
+class FrameTimeStatistics
+{
+public:
+    explicit FrameTimeStatistics(const FrameTimeStatisticsSettings &settings = FrameTimeStatisticsSettings());
+    void reset();
+
+    /// Adds the time of the next frame (in milliseconds).
+    void addFrameTime(double frameTimeMS);
+
+    inline bool isWarmUpFinished() const { return warmUpFinished; }
+    inline size_t getNumWarmUpFrames() const { return numWarmUpFrames; }
+    inline size_t getNumSamples() const { return samples.size(); }
+    /// The frame times after the warm-up in the order they were added.
+    inline const std::vector<double> &getSamples() const { return samples; }
+    /// Histogram of the frame times after the warm-up.
+    inline const std::vector<uint32_t> &getHistogram() const { return histogram; }
+    inline const FrameTimeStatisticsSettings &getSettings() const { return settings; }
+
+    /// Computes all statistics including the bootstrap confidence interval (deterministic for a fixed seed).
+    FrameTimeSummary computeSummary() const;
+    /**
+     * Returns whether the relative width of the confidence interval of the median dropped below the threshold.
+     * The bootstrap is evaluated at most every convergenceCheckInterval samples.
+     */
+    bool hasConverged();
+
+    /// Quantile of sorted values with linear interpolation between the closest ranks.
+    static double computeQuantile(const std::vector<double> &sortedValues, double quantile);
+    /// Percentile bootstrap confidence interval of the median (resamples are processed in parallel).
+    static void computeMedianConfidenceInterval(const std::vector<double> &values, size_t numResamples,
+            double confidenceLevel, uint64_t seed, double &lower, double &upper);
+
+private:
+    void addSample(double frameTimeMS);
+    void checkWarmUpFinished();
+
+    FrameTimeStatisticsSettings settings;
+    bool warmUpFinished = false;
+    size_t numWarmUpFrames = 0;
+    std::vector<double> warmUpFrames;
+    std::vector<double> samples;
+    std::vector<uint32_t> histogram;
+
+    bool converged = false;
+    size_t numSamplesLastConvergenceCheck = 0;
+};
+
+#endif //PIXELSYNCOIT_FRAMETIMESTATISTICS_HPP
@@ -0,0 +1,678 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <Utils/File/Logfile.hpp>
+
+#include "ImageMetrics.hpp"
+
+/// Number of SSIM map rows processed by one thread at once (the horizontal filter pass is done per band).
+const int SSIM_BAND_HEIGHT = 32;
+/// Number of values summed up per chunk when accumulating floating point errors (fixed for determinism).
+const size_t ERROR_SUM_CHUNK_SIZE = 1 << 16;
+
+static inline float sRGBToLinearRGB(float value)
+{
+    // See https://en.wikipedia.org/wiki/SRGB (same conversion as TransferFunctionWindow::sRGBToLinearRGB).
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+static const std::vector<float> &getSRGBToLinearRGBTable()
+{
+    static const std::vector<float> table = []() {
+        std::vector<float> values(256);
+        for (int i = 0; i < 256; i++) {
+            values[i] = sRGBToLinearRGB(float(i) / 255.0f);
+        }
+        return values;
+    }();
+    return table;
+}
+
+template<typename T>
+static bool checkSameSize(const ImageView<T> &expected, const ImageView<T> &observed, const char *functionName)
+{
+    if (expected.width != observed.width || expected.height != observed.height
+            || expected.channels != observed.channels) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in " + functionName + ": The image sizes differ.");
+        return false;
+    }
+    return true;
+}
+
+static bool checkSameSize(const GrayscaleImage &expected, const GrayscaleImage &observed, const char *functionName)
+{
+    if (expected.width != observed.width || expected.height != observed.height) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in " + functionName + ": The image sizes differ.");
+        return false;
+    }
+    return true;
+}
+
+
+// --- Luminance ---
+
+void computeLuminance(const ImageViewRGBA8 &image, GrayscaleImage &luminance)
+{
+    const std::vector<float> &linearTable = getSRGBToLinearRGBTable();
+    const int numPixels = int(image.getNumPixels());
+    const int channels = image.channels;
+    const int offsetG = channels >= 3 ? 1 : 0, offsetB = channels >= 3 ? 2 : 0;
+    luminance.resize(image.width, image.height);
+
+    #pragma omp parallel for
+    for (int i = 0; i < numPixels; i++) {
+        const uint8_t *pixel = image.data + size_t(i) * channels;
+        luminance.values[i] = 255.0f * (0.2126f * linearTable[pixel[0]] + 0.7152f * linearTable[pixel[offsetG]]
+                + 0.0722f * linearTable[pixel[offsetB]]);
+    }
+}
+
+void computeLuminance(const ImageViewFloat &image, GrayscaleImage &luminance)
+{
+    const int numPixels = int(image.getNumPixels());
+    const int channels = image.channels;
+    const int offsetG = channels >= 3 ? 1 : 0, offsetB = channels >= 3 ? 2 : 0;
+    luminance.resize(image.width, image.height);
+
+    #pragma omp parallel for
+    for (int i = 0; i < numPixels; i++) {
+        const float *pixel = image.data + size_t(i) * channels;
+        luminance.values[i] = 255.0f * (0.2126f * sRGBToLinearRGB(pixel[0])
+                + 0.7152f * sRGBToLinearRGB(pixel[offsetG]) + 0.0722f * sRGBToLinearRGB(pixel[offsetB]));
+    }
+}
+
+
+// --- Pixel-wise error metrics ---
+
+double computeMSE(const ImageViewRGBA8 &expected, const ImageViewRGBA8 &observed)
+{
+    if (!checkSameSize(expected, observed, "computeMSE")) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    const size_t N = expected.getNumValues();
+    if (N == 0) {
+        return 0.0;
+    }
+
+    // Integer sums are exact, i.e. the result does not depend on the order of summation.
+    const uint8_t *expectedValues = expected.data;
+    const uint8_t *observedValues = observed.data;
+    uint64_t sum = 0;
+    #pragma omp parallel for reduction(+: sum)
+    for (size_t chunk = 0; chunk < N; chunk += ERROR_SUM_CHUNK_SIZE) {
+        const size_t chunkEnd = std::min(chunk + ERROR_SUM_CHUNK_SIZE, N);
+        uint32_t chunkSum = 0; // At most 2^16 * 255^2 < 2^32
+        for (size_t i = chunk; i < chunkEnd; i++) {
+            int32_t diff = int32_t(expectedValues[i]) - int32_t(observedValues[i]);
+            chunkSum += uint32_t(diff * diff);
+        }
+        sum += chunkSum;
+    }
+    return double(sum) / double(N);
+}
+
+double computeMSE(const ImageViewFloat &expected, const ImageViewFloat &observed)
+{
+    if (!checkSameSize(expected, observed, "computeMSE")) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    const size_t N = expected.getNumValues();
+    if (N == 0) {
+        return 0.0;
+    }
+
+    // The chunk sums are added up in a fixed order to make the result independent of the number of threads.
+    const size_t numChunks = (N - 1) / ERROR_SUM_CHUNK_SIZE + 1;
+    std::vector<double> chunkSums(numChunks);
+    #pragma omp parallel for
+    for (size_t chunk = 0; chunk < numChunks; chunk++) {
+        const size_t chunkStart = chunk * ERROR_SUM_CHUNK_SIZE;
+        const size_t chunkEnd = std::min(chunkStart + ERROR_SUM_CHUNK_SIZE, N);
+        double chunkSum = 0.0;
+        for (size_t i = chunkStart; i < chunkEnd; i++) {
+            double diff = double(expected.data[i]) - double(observed.data[i]);
+            chunkSum += diff * diff;
+        }
+        chunkSums[chunk] = chunkSum;
+    }
+
+    double sum = 0.0;
+    for (double chunkSum : chunkSums) {
+        sum += chunkSum;
+    }
+    return sum / double(N);
+}
+
+double computeRMSE(const ImageViewRGBA8 &expected, const ImageViewRGBA8 &observed)
+{
+    return std::sqrt(computeMSE(expected, observed));
+}
+
+double computeRMSE(const ImageViewFloat &expected, const ImageViewFloat &observed)
+{
+    return std::sqrt(computeMSE(expected, observed));
+}
+
+double computePSNR(double mse, double peakValue)
+{
+    if (mse <= 0.0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return 10.0 * std::log10(peakValue * peakValue / mse);
+}
+
+
+// --- Structural similarity ---
+
+/// Moments of the two images inside of a window: E[x], E[y], E[x^2], E[y^2], E[xy].
+enum SSIMMoment {
+    MOMENT_X, MOMENT_Y, MOMENT_XX, MOMENT_YY, MOMENT_XY, NUM_SSIM_MOMENTS
+};
+
+/**
+ * Computes the SSIM and the contrast/structure term (used by MS-SSIM) from the weighted moments of a window.
+ */
+static inline void computeSSIMFromMoments(
+        double meanX, double meanY, double meanXX, double meanYY, double meanXY, double c1, double c2,
+        double &ssim, double &contrastStructure)
+{
+    double varianceX = meanXX - meanX * meanX;
+    double varianceY = meanYY - meanY * meanY;
+    double covariance = meanXY - meanX * meanY;
+    contrastStructure = (2.0 * covariance + c2) / (varianceX + varianceY + c2);
+    ssim = (2.0 * meanX * meanY + c1) / (meanX * meanX + meanY * meanY + c1) * contrastStructure;
+}
+
+static std::vector<double> computeGaussianWindowWeights(int radius, double sigma)
+{
+    std::vector<double> weights(2 * radius + 1);
+    double weightSum = 0.0;
+    for (int k = -radius; k <= radius; k++) {
+        weights[k + radius] = std::exp(-double(k * k) / (2.0 * sigma * sigma));
+        weightSum += weights[k + radius];
+    }
+    for (double &weight : weights) {
+        weight /= weightSum;
+    }
+    return weights;
+}
+
+static int getEffectiveWindowRadius(const GrayscaleImage &image, int windowRadius)
+{
+    return std::max(std::min(windowRadius, (std::min(image.width, image.height) - 1) / 2), 0);
+}
+
+/**
+ * Computes the SSIM map with a Gaussian window using separable filtering. The map is processed in bands of rows.
+ * For each band, the horizontally filtered moments of the needed input rows are computed first and are then
+ * filtered vertically. All inner loops run over contiguous rows and can be vectorized.
+ */
+static void computeGaussianSSIM(const GrayscaleImage &X, const GrayscaleImage &Y, const SSIMSettings &settings,
+        int radius, GrayscaleImage *ssimMap, double &meanSSIM, double &meanContrastStructure)
+{
+    const int windowSize = 2 * radius + 1;
+    const int width = X.width;
+    const int mapWidth = X.width - 2 * radius;
+    const int mapHeight = X.height - 2 * radius;
+    const double c1 = (settings.k1 * settings.dynamicRange) * (settings.k1 * settings.dynamicRange);
+    const double c2 = (settings.k2 * settings.dynamicRange) * (settings.k2 * settings.dynamicRange);
+    const std::vector<double> weights = computeGaussianWindowWeights(radius, settings.sigma);
+    if (ssimMap) {
+        ssimMap->resize(mapWidth, mapHeight);
+    }
+
+    const int numBands = (mapHeight - 1) / SSIM_BAND_HEIGHT + 1;
+    std::vector<double> bandSSIMSums(numBands), bandContrastStructureSums(numBands);
+
+    #pragma omp parallel
+    {
+        const int maxNumBandRows = SSIM_BAND_HEIGHT + windowSize - 1;
+        std::vector<double> horizontalMoments(size_t(NUM_SSIM_MOMENTS) * maxNumBandRows * mapWidth);
+        std::vector<double> rowMoments(size_t(NUM_SSIM_MOMENTS) * mapWidth);
+
+        #pragma omp for schedule(dynamic, 1)
+        for (int band = 0; band < numBands; band++) {
+            const int mapRowStart = band * SSIM_BAND_HEIGHT;
+            const int mapRowEnd = std::min(mapRowStart + SSIM_BAND_HEIGHT, mapHeight);
+            const int numBandRows = mapRowEnd - mapRowStart + windowSize - 1;
+            const size_t momentStride = size_t(numBandRows) * mapWidth;
+
+            // 1. Horizontal pass over the input rows of the band.
+            for (int row = 0; row < numBandRows; row++) {
+                const float *rowX = X.values.data() + size_t(mapRowStart + row) * width;
+                const float *rowY = Y.values.data() + size_t(mapRowStart + row) * width;
+                double *moments = horizontalMoments.data() + size_t(row) * mapWidth;
+                double *meanX = moments + MOMENT_X * momentStride;
+                double *meanY = moments + MOMENT_Y * momentStride;
+                double *meanXX = moments + MOMENT_XX * momentStride;
+                double *meanYY = moments + MOMENT_YY * momentStride;
+                double *meanXY = moments + MOMENT_XY * momentStride;
+                for (int x = 0; x < mapWidth; x++) {
+                    meanX[x] = meanY[x] = meanXX[x] = meanYY[x] = meanXY[x] = 0.0;
+                }
+                for (int k = 0; k < windowSize; k++) {
+                    const double weight = weights[k];
+                    const float *shiftedX = rowX + k;
+                    const float *shiftedY = rowY + k;
+                    for (int x = 0; x < mapWidth; x++) {
+                        double valueX = shiftedX[x], valueY = shiftedY[x];
+                        meanX[x] += weight * valueX;
+                        meanY[x] += weight * valueY;
+                        meanXX[x] += weight * valueX * valueX;
+                        meanYY[x] += weight * valueY * valueY;
+                        meanXY[x] += weight * valueX * valueY;
+                    }
+                }
+            }
+
+            // 2. Vertical pass and evaluation of the SSIM formula.
+            double ssimSum = 0.0, contrastStructureSum = 0.0;
+            for (int mapRow = mapRowStart; mapRow < mapRowEnd; mapRow++) {
+                std::fill(rowMoments.begin(), rowMoments.end(), 0.0);
+                for (int k = 0; k < windowSize; k++) {
+                    const double weight = weights[k];
+                    const double *moments = horizontalMoments.data() + size_t(mapRow - mapRowStart + k) * mapWidth;
+                    for (int moment = 0; moment < NUM_SSIM_MOMENTS; moment++) {
+                        const double *inputMoments = moments + moment * momentStride;
+                        double *outputMoments = rowMoments.data() + size_t(moment) * mapWidth;
+                        for (int x = 0; x < mapWidth; x++) {
+                            outputMoments[x] += weight * inputMoments[x];
+                        }
+                    }
+                }
+
+                for (int x = 0; x < mapWidth; x++) {
+                    double ssim, contrastStructure;
+                    computeSSIMFromMoments(
+                            rowMoments[MOMENT_X * mapWidth + x], rowMoments[MOMENT_Y * mapWidth + x],
+                            rowMoments[MOMENT_XX * mapWidth + x], rowMoments[MOMENT_YY * mapWidth + x],
+                            rowMoments[MOMENT_XY * mapWidth + x], c1, c2, ssim, contrastStructure);
+                    ssimSum += ssim;
+                    contrastStructureSum += contrastStructure;
+                    if (ssimMap) {
+                        ssimMap->at(x, mapRow) = float(ssim);
+                    }
+                }
+            }
+            bandSSIMSums[band] = ssimSum;
+            bandContrastStructureSums[band] = contrastStructureSum;
+        }
+    }
+
+    double ssimSum = 0.0, contrastStructureSum = 0.0;
+    for (int band = 0; band < numBands; band++) {
+        ssimSum += bandSSIMSums[band];
+        contrastStructureSum += bandContrastStructureSums[band];
+    }
+    const double numWindows = double(mapWidth) * double(mapHeight);
+    meanSSIM = ssimSum / numWindows;
+    meanContrastStructure = contrastStructureSum / numWindows;
+}
+
+/**
+ * Integral images (summed area tables) of the SSIM moments. Entry (x, y) stores the sum of all values in
+ * [0, x) x [0, y), i.e. the tables have the size (width + 1) x (height + 1).
+ */
+struct SSIMIntegralImages
+{
+    int width, height;
+    std::vector<double> tables[NUM_SSIM_MOMENTS];
+
+    /// Sum of the moment over the rectangle [x0, x1) x [y0, y1).
+    inline double getSum(int moment, int x0, int y0, int x1, int y1) const {
+        const std::vector<double> &table = tables[moment];
+        const size_t stride = size_t(width) + 1;
+        return table[y1 * stride + x1] - table[y0 * stride + x1] - table[y1 * stride + x0] + table[y0 * stride + x0];
+    }
+
+    void build(const GrayscaleImage &X, const GrayscaleImage &Y) {
+        width = X.width;
+        height = X.height;
+        const size_t stride = size_t(width) + 1;
+        for (int moment = 0; moment < NUM_SSIM_MOMENTS; moment++) {
+            tables[moment].resize(stride * (size_t(height) + 1));
+        }
+
+        // 1. Prefix sums of the rows.
+        #pragma omp parallel for
+        for (int y = 0; y <= height; y++) {
+            double rowSums[NUM_SSIM_MOMENTS] = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+            for (int moment = 0; moment < NUM_SSIM_MOMENTS; moment++) {
+                tables[moment][y * stride] = 0.0;
+            }
+            for (int x = 0; x < width; x++) {
+                double valueX = 0.0, valueY = 0.0;
+                if (y > 0) {
+                    valueX = X.at(x, y - 1);
+                    valueY = Y.at(x, y - 1);
+                }
+                rowSums[MOMENT_X] += valueX;
+                rowSums[MOMENT_Y] += valueY;
+                rowSums[MOMENT_XX] += valueX * valueX;
+                rowSums[MOMENT_YY] += valueY * valueY;
+                rowSums[MOMENT_XY] += valueX * valueY;
+                for (int moment = 0; moment < NUM_SSIM_MOMENTS; moment++) {
+                    tables[moment][y * stride + x + 1] = rowSums[moment];
+                }
+            }
+        }
+
+        // 2. Prefix sums of the columns (blocks of columns are processed in parallel).
+        const int COLUMN_BLOCK_SIZE = 256;
+        const int numColumnBlocks = int(stride - 1) / COLUMN_BLOCK_SIZE + 1;
+        #pragma omp parallel for collapse(2)
+        for (int moment = 0; moment < NUM_SSIM_MOMENTS; moment++) {
+            for (int block = 0; block < numColumnBlocks; block++) {
+                double *table = tables[moment].data();
+                const size_t columnStart = size_t(block) * COLUMN_BLOCK_SIZE;
+                const size_t columnEnd = std::min(columnStart + COLUMN_BLOCK_SIZE, stride);
+                for (int y = 1; y <= height; y++) {
+                    double *row = table + y * stride;
+                    const double *previousRow = table + (y - 1) * stride;
+                    for (size_t x = columnStart; x < columnEnd; x++) {
+                        row[x] += previousRow[x];
+                    }
+                }
+            }
+        }
+    }
+
+    /// Computes the SSIM of the window [x0, x1) x [y0, y1) using uniform weights.
+    inline void computeSSIM(int x0, int y0, int x1, int y1, double c1, double c2,
+            double &ssim, double &contrastStructure) const {
+        const double weight = 1.0 / (double(x1 - x0) * double(y1 - y0));
+        computeSSIMFromMoments(
+                getSum(MOMENT_X, x0, y0, x1, y1) * weight, getSum(MOMENT_Y, x0, y0, x1, y1) * weight,
+                getSum(MOMENT_XX, x0, y0, x1, y1) * weight, getSum(MOMENT_YY, x0, y0, x1, y1) * weight,
+                getSum(MOMENT_XY, x0, y0, x1, y1) * weight, c1, c2, ssim, contrastStructure);
+    }
+};
+
+static void computeBoxSSIM(const GrayscaleImage &X, const GrayscaleImage &Y, const SSIMSettings &settings,
+        int radius, GrayscaleImage *ssimMap, double &meanSSIM, double &meanContrastStructure)
+{
+    const int windowSize = 2 * radius + 1;
+    const int mapWidth = X.width - 2 * radius;
+    const int mapHeight = X.height - 2 * radius;
+    const double c1 = (settings.k1 * settings.dynamicRange) * (settings.k1 * settings.dynamicRange);
+    const double c2 = (settings.k2 * settings.dynamicRange) * (settings.k2 * settings.dynamicRange);
+    if (ssimMap) {
+        ssimMap->resize(mapWidth, mapHeight);
+    }
+
+    SSIMIntegralImages integralImages;
+    integralImages.build(X, Y);
+
+    std::vector<double> rowSSIMSums(mapHeight), rowContrastStructureSums(mapHeight);
+    #pragma omp parallel for
+    for (int y = 0; y < mapHeight; y++) {
+        double ssimSum = 0.0, contrastStructureSum = 0.0;
+        for (int x = 0; x < mapWidth; x++) {
+            double ssim, contrastStructure;
+            integralImages.computeSSIM(x, y, x + windowSize, y + windowSize, c1, c2, ssim, contrastStructure);
+            ssimSum += ssim;
+            contrastStructureSum += contrastStructure;
+            if (ssimMap) {
+                ssimMap->at(x, y) = float(ssim);
+            }
+        }
+        rowSSIMSums[y] = ssimSum;
+        rowContrastStructureSums[y] = contrastStructureSum;
+    }
+
+    double ssimSum = 0.0, contrastStructureSum = 0.0;
+    for (int y = 0; y < mapHeight; y++) {
+        ssimSum += rowSSIMSums[y];
+        contrastStructureSum += rowContrastStructureSums[y];
+    }
+    const double numWindows = double(mapWidth) * double(mapHeight);
+    meanSSIM = ssimSum / numWindows;
+    meanContrastStructure = contrastStructureSum / numWindows;
+}
+
+static void computeSSIMAndContrastStructure(const GrayscaleImage &X, const GrayscaleImage &Y,
+        const SSIMSettings &settings, GrayscaleImage *ssimMap, double &meanSSIM, double &meanContrastStructure)
+{
+    const int radius = getEffectiveWindowRadius(X, settings.windowRadius);
+    if (X.width == 0 || X.height == 0) {
+        meanSSIM = meanContrastStructure = 1.0;
+        if (ssimMap) {
+            ssimMap->resize(0, 0);
+        }
+        return;
+    }
+
+    if (settings.windowType == SSIM_WINDOW_BOX) {
+        computeBoxSSIM(X, Y, settings, radius, ssimMap, meanSSIM, meanContrastStructure);
+    } else {
+        computeGaussianSSIM(X, Y, settings, radius, ssimMap, meanSSIM, meanContrastStructure);
+    }
+}
+
+double computeSSIM(const GrayscaleImage &expected, const GrayscaleImage &observed,
+        const SSIMSettings &settings, GrayscaleImage *ssimMap)
+{
+    if (!checkSameSize(expected, observed, "computeSSIM")) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    double meanSSIM, meanContrastStructure;
+    computeSSIMAndContrastStructure(expected, observed, settings, ssimMap, meanSSIM, meanContrastStructure);
+    return meanSSIM;
+}
+
+/// Halves the resolution of the image by averaging 2x2 pixel blocks (an odd last row/column is dropped).
+static void downsampleImage(const GrayscaleImage &input, GrayscaleImage &output)
+{
+    output.resize(input.width / 2, input.height / 2);
+    #pragma omp parallel for
+    for (int y = 0; y < output.height; y++) {
+        const float *row0 = input.values.data() + size_t(2 * y) * input.width;
+        const float *row1 = row0 + input.width;
+        float *outputRow = output.values.data() + size_t(y) * output.width;
+        for (int x = 0; x < output.width; x++) {
+            outputRow[x] = 0.25f * (row0[2 * x] + row0[2 * x + 1] + row1[2 * x] + row1[2 * x + 1]);
+        }
+    }
+}
+
+double computeMSSSIM(const GrayscaleImage &expected, const GrayscaleImage &observed,
+        const SSIMSettings &settings, int numScales)
+{
+    if (!checkSameSize(expected, observed, "computeMSSSIM")) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    // Weights of the scales from the paper of Wang et al.
+    const double SCALE_WEIGHTS[] = { 0.0448, 0.2856, 0.3001, 0.2363, 0.1333 };
+    const int MAX_NUM_SCALES = int(sizeof(SCALE_WEIGHTS) / sizeof(*SCALE_WEIGHTS));
+    numScales = std::max(std::min(numScales, MAX_NUM_SCALES), 1);
+
+    std::vector<double> ssimValues, contrastStructureValues;
+    GrayscaleImage scaledExpected = expected, scaledObserved = observed;
+    GrayscaleImage downsampledExpected, downsampledObserved;
+    const int windowSize = 2 * settings.windowRadius + 1;
+    for (int scale = 0; scale < numScales; scale++) {
+        if (scale > 0 && std::min(scaledExpected.width, scaledExpected.height) < windowSize) {
+            break;
+        }
+        double meanSSIM, meanContrastStructure;
+        computeSSIMAndContrastStructure(
+                scaledExpected, scaledObserved, settings, nullptr, meanSSIM, meanContrastStructure);
+        ssimValues.push_back(meanSSIM);
+        contrastStructureValues.push_back(meanContrastStructure);
+
+        if (scale + 1 < numScales) {
+            downsampleImage(scaledExpected, downsampledExpected);
+            downsampleImage(scaledObserved, downsampledObserved);
+            std::swap(scaledExpected, downsampledExpected);
+            std::swap(scaledObserved, downsampledObserved);
+        }
+    }
+
+    const int numUsedScales = int(ssimValues.size());
+    double weightSum = 0.0;
+    for (int scale = 0; scale < numUsedScales; scale++) {
+        weightSum += SCALE_WEIGHTS[scale];
+    }
+    double msssim = 1.0;
+    for (int scale = 0; scale < numUsedScales; scale++) {
+        double value = scale == numUsedScales - 1 ? ssimValues[scale] : contrastStructureValues[scale];
+        msssim *= std::pow(std::max(value, 0.0), SCALE_WEIGHTS[scale] / weightSum);
+    }
+    return msssim;
+}
+
+void computeBlockSSIMMap(const GrayscaleImage &expected, const GrayscaleImage &observed, int blockSize,
+        GrayscaleImage &ssimMap, const SSIMSettings &settings)
+{
+    if (!checkSameSize(expected, observed, "computeBlockSSIMMap") || blockSize <= 0) {
+        ssimMap.resize(0, 0);
+        return;
+    }
+    const double c1 = (settings.k1 * settings.dynamicRange) * (settings.k1 * settings.dynamicRange);
+    const double c2 = (settings.k2 * settings.dynamicRange) * (settings.k2 * settings.dynamicRange);
+    ssimMap.resize(expected.width / blockSize, expected.height / blockSize);
+
+    SSIMIntegralImages integralImages;
+    integralImages.build(expected, observed);
+
+    #pragma omp parallel for
+    for (int y = 0; y < ssimMap.height; y++) {
+        for (int x = 0; x < ssimMap.width; x++) {
+            double ssim, contrastStructure;
+            integralImages.computeSSIM(x * blockSize, y * blockSize, (x + 1) * blockSize, (y + 1) * blockSize,
+                    c1, c2, ssim, contrastStructure);
+            ssimMap.at(x, y) = float(ssim);
+        }
+    }
+}
+
+double computeSSIMReference(const GrayscaleImage &expected, const GrayscaleImage &observed,
+        const SSIMSettings &settings, GrayscaleImage *ssimMap)
+{
+    if (!checkSameSize(expected, observed, "computeSSIMReference")) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (expected.width == 0 || expected.height == 0) {
+        return 1.0;
+    }
+
+    const int radius = getEffectiveWindowRadius(expected, settings.windowRadius);
+    const int windowSize = 2 * radius + 1;
+    const int mapWidth = expected.width - 2 * radius;
+    const int mapHeight = expected.height - 2 * radius;
+    const double c1 = (settings.k1 * settings.dynamicRange) * (settings.k1 * settings.dynamicRange);
+    const double c2 = (settings.k2 * settings.dynamicRange) * (settings.k2 * settings.dynamicRange);
+    std::vector<double> weights1D(windowSize, 1.0 / windowSize);
+    if (settings.windowType == SSIM_WINDOW_GAUSSIAN) {
+        weights1D = computeGaussianWindowWeights(radius, settings.sigma);
+    }
+    if (ssimMap) {
+        ssimMap->resize(mapWidth, mapHeight);
+    }
+
+    // Uses the two-pass formula for the (co-)variances.
+    double ssimSum = 0.0;
+    for (int y = 0; y < mapHeight; y++) {
+        for (int x = 0; x < mapWidth; x++) {
+            double meanX = 0.0, meanY = 0.0;
+            for (int j = 0; j < windowSize; j++) {
+                for (int i = 0; i < windowSize; i++) {
+                    double weight = weights1D[i] * weights1D[j];
+                    meanX += weight * expected.at(x + i, y + j);
+                    meanY += weight * observed.at(x + i, y + j);
+                }
+            }
+            double varianceX = 0.0, varianceY = 0.0, covariance = 0.0;
+            for (int j = 0; j < windowSize; j++) {
+                for (int i = 0; i < windowSize; i++) {
+                    double weight = weights1D[i] * weights1D[j];
+                    double diffX = expected.at(x + i, y + j) - meanX;
+                    double diffY = observed.at(x + i, y + j) - meanY;
+                    varianceX += weight * diffX * diffX;
+                    varianceY += weight * diffY * diffY;
+                    covariance += weight * diffX * diffY;
+                }
+            }
+            double ssim = ((2.0 * meanX * meanY + c1) * (2.0 * covariance + c2))
+                    / ((meanX * meanX + meanY * meanY + c1) * (varianceX + varianceY + c2));
+            ssimSum += ssim;
+            if (ssimMap) {
+                ssimMap->at(x, y) = float(ssim);
+            }
+        }
+    }
+    return ssimSum / (double(mapWidth) * double(mapHeight));
+}
+
+
+// --- Difference maps ---
+
+void computeDifferenceMap(const ImageViewRGBA8 &expected, const ImageViewRGBA8 &observed,
+        DifferenceMapMode mode, std::vector<uint8_t> &differenceMap)
+{
+    const int numPixels = int(expected.getNumPixels());
+    const int channels = expected.channels;
+    differenceMap.resize(size_t(numPixels) * 4);
+    if (!checkSameSize(expected, observed, "computeDifferenceMap")) {
+        std::fill(differenceMap.begin(), differenceMap.end(), uint8_t(0));
+        return;
+    }
+
+    if (mode == DIFFERENCE_MAP_RGB_DIFF || mode == DIFFERENCE_MAP_RGB_NORMALIZED) {
+        int maxDifferenceRGB = 0;
+        #pragma omp parallel for reduction(max: maxDifferenceRGB)
+        for (int i = 0; i < numPixels; i++) {
+            const uint8_t *expectedPixel = expected.data + size_t(i) * channels;
+            const uint8_t *observedPixel = observed.data + size_t(i) * channels;
+            for (int c = 0; c < 3; c++) {
+                int readChannel = std::min(c, channels - 1);
+                int difference = std::abs(int(expectedPixel[readChannel]) - int(observedPixel[readChannel]));
+                differenceMap[i * 4 + c] = uint8_t(difference);
+                maxDifferenceRGB = std::max(maxDifferenceRGB, difference);
+            }
+            differenceMap[i * 4 + 3] = 255;
+        }
+
+        if (mode == DIFFERENCE_MAP_RGB_NORMALIZED && maxDifferenceRGB >= 1) {
+            const float scaleFactor = 255.0f / float(maxDifferenceRGB);
+            #pragma omp parallel for
+            for (int i = 0; i < numPixels; i++) {
+                for (int c = 0; c < 3; c++) {
+                    differenceMap[i * 4 + c] = uint8_t(float(differenceMap[i * 4 + c]) * scaleFactor);
+                }
+            }
+        }
+        return;
+    }
+
+    // DIFFERENCE_MAP_NORM_WHITE and DIFFERENCE_MAP_NORM_BLACK
+    std::vector<float> normDifferences(numPixels);
+    float maxNormValue = 0.0f;
+    #pragma omp parallel for reduction(max: maxNormValue)
+    for (int i = 0; i < numPixels; i++) {
+        int differenceSum = 0;
+        for (int c = 0; c < channels; c++) {
+            differenceSum += std::abs(int(expected.data[size_t(i) * channels + c])
+                    - int(observed.data[size_t(i) * channels + c]));
+        }
+        normDifferences[i] = std::sqrt(float(differenceSum));
+        maxNormValue = std::max(maxNormValue, normDifferences[i]);
+    }
+
+    const bool whiteIsZero = mode == DIFFERENCE_MAP_NORM_WHITE;
+    #pragma omp parallel for
+    for (int i = 0; i < numPixels; i++) {
+        int pixelValue = whiteIsZero ? 255 : 0;
+        if (maxNormValue >= 1) {
+            float normalizedValue = normDifferences[i] / maxNormValue * 255.0f;
+            pixelValue = whiteIsZero ? int(255.0f - normalizedValue) : int(normalizedValue);
+        }
+        differenceMap[i * 4 + 0] = uint8_t(pixelValue);
+        differenceMap[i * 4 + 1] = uint8_t(pixelValue);
+        differenceMap[i * 4 + 2] = uint8_t(pixelValue);
+        differenceMap[i * 4 + 3] = 255;
+    }
+}
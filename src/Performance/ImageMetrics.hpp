@@ -0,0 +1,148 @@
+#ifndef PIXELSYNCOIT_IMAGEMETRICS_HPP
+#define PIXELSYNCOIT_IMAGEMETRICS_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Image comparison metrics (MSE, PSNR, SSIM, MS-SSIM, difference maps) working on raw pixel buffers.
+ * The functions do not depend on sgl::Bitmap or OpenGL and can thus also be used by headless tools.
+ * All kernels are multi-threaded using OpenMP and the results do not depend on the number of threads.
+ */
+
+/**
+ * Non-owning view of an image with interleaved channels (row-major, no row padding).
+ * RGBA8 images store values in [0,255], float images values in [0,1]. Color values are sRGB encoded.
+ */
+template<typename T>
+struct ImageView
+{
+    ImageView() : data(nullptr), width(0), height(0), channels(0) {}
+    ImageView(const T *data, int width, int height, int channels = 4)
+            : data(data), width(width), height(height), channels(channels) {}
+    inline size_t getNumPixels() const { return size_t(width) * size_t(height); }
+    inline size_t getNumValues() const { return getNumPixels() * size_t(channels); }
+
+    const T *data;
+    int width, height, channels;
+};
+
+typedef ImageView<uint8_t> ImageViewRGBA8;
+typedef ImageView<float> ImageViewFloat;
+
+/// Single-channel image, e.g. luminance values or an SSIM map.
+struct GrayscaleImage
+{
+    GrayscaleImage() : width(0), height(0) {}
+    void resize(int w, int h) { width = w; height = h; values.resize(size_t(w) * size_t(h)); }
+    inline float &at(int x, int y) { return values[size_t(y) * size_t(width) + size_t(x)]; }
+    inline float at(int x, int y) const { return values[size_t(y) * size_t(width) + size_t(x)]; }
+
+    int width, height;
+    std::vector<float> values;
+};
+
+
+// --- Luminance ---
+
+/**
+ * Converts the sRGB colors of the image to linear RGB and computes the luminance
+ * (0.2126 R + 0.7152 G + 0.0722 B) scaled to [0,255]. Images with less than three channels are treated as gray.
+ */
+void computeLuminance(const ImageViewRGBA8 &image, GrayscaleImage &luminance);
+void computeLuminance(const ImageViewFloat &image, GrayscaleImage &luminance);
+
+
+// --- Pixel-wise error metrics ---
+
+/// Mean squared error over all channels (in the value range of the images, i.e. [0,255] or [0,1]).
+double computeMSE(const ImageViewRGBA8 &expected, const ImageViewRGBA8 &observed);
+double computeMSE(const ImageViewFloat &expected, const ImageViewFloat &observed);
+/// Root mean squared error.
+double computeRMSE(const ImageViewRGBA8 &expected, const ImageViewRGBA8 &observed);
+double computeRMSE(const ImageViewFloat &expected, const ImageViewFloat &observed);
+/// Peak signal-to-noise ratio (in dB) for the passed mean squared error. Returns infinity for mse == 0.
+double computePSNR(double mse, double peakValue);
+
+
+// --- Structural similarity ---
+
+enum SSIMWindowType {
+    /// Gaussian window (computed with separable filtering). The standard choice of Wang et al.
+    SSIM_WINDOW_GAUSSIAN,
+    /// Uniform window (computed using integral images, i.e. with constant cost per pixel).
+    SSIM_WINDOW_BOX
+};
+
+struct SSIMSettings
+{
+    SSIMWindowType windowType = SSIM_WINDOW_GAUSSIAN;
+    /// The window has a size of (2*windowRadius+1)^2 pixels.
+    int windowRadius = 5;
+    /// Standard deviation of the Gaussian window.
+    double sigma = 1.5;
+    double k1 = 0.01;
+    double k2 = 0.03;
+    /// Dynamic range of the luminance values.
+    double dynamicRange = 255.0;
+};
+
+/**
+ * Returns the mean structural similarity index (SSIM) of the two luminance images.
+ * The window is only evaluated where it lies completely inside of the images, i.e. the SSIM map has the size
+ * (width - 2*r) x (height - 2*r). The window radius r is reduced for images smaller than the window.
+ *
+ * Wang, Z., Bovik, A. C., Sheikh, H. R., and Simoncelli, E. P. 2004. Image Quality Assessment:
+ * From Error Visibility to Structural Similarity. Trans. Img. Proc. 13, 4 (2004), 600–612.
+ * @param ssimMap If not nullptr, the SSIM value of each window is stored in this image.
+ */
+double computeSSIM(const GrayscaleImage &expected, const GrayscaleImage &observed,
+        const SSIMSettings &settings = SSIMSettings(), GrayscaleImage *ssimMap = nullptr);
+
+/**
+ * Returns the multi-scale structural similarity index (MS-SSIM). The images are downsampled by a factor of two
+ * between the scales. If an image gets smaller than the window, less scales are used (and the weights renormalized).
+ * Negative contrast/structure terms are clamped to zero.
+ *
+ * Wang, Z., Simoncelli, E. P., and Bovik, A. C. 2003. Multiscale structural similarity for image quality assessment.
+ * In The Thirty-Seventh Asilomar Conference on Signals, Systems & Computers, 1398–1402.
+ */
+double computeMSSSIM(const GrayscaleImage &expected, const GrayscaleImage &observed,
+        const SSIMSettings &settings = SSIMSettings(), int numScales = 5);
+
+/**
+ * Computes the SSIM of non-overlapping blocks of blockSize x blockSize pixels (uses integral images).
+ * The size of the map is (width / blockSize) x (height / blockSize).
+ */
+void computeBlockSSIMMap(const GrayscaleImage &expected, const GrayscaleImage &observed, int blockSize,
+        GrayscaleImage &ssimMap, const SSIMSettings &settings = SSIMSettings());
+
+/**
+ * Slow reference implementation of computeSSIM directly evaluating the 2D window of every pixel.
+ * Only used for validating the optimized implementation.
+ */
+double computeSSIMReference(const GrayscaleImage &expected, const GrayscaleImage &observed,
+        const SSIMSettings &settings = SSIMSettings(), GrayscaleImage *ssimMap = nullptr);
+
+
+// --- Difference maps ---
+
+enum DifferenceMapMode {
+    /// Absolute difference of the RGB channels (alpha = 255).
+    DIFFERENCE_MAP_RGB_DIFF,
+    /// Absolute difference of the RGB channels, scaled such that the maximum difference is 255.
+    DIFFERENCE_MAP_RGB_NORMALIZED,
+    /// Gray value sqrt(sum of channel differences) normalized to [0,255], white = no difference.
+    DIFFERENCE_MAP_NORM_WHITE,
+    /// Gray value sqrt(sum of channel differences) normalized to [0,255], black = no difference.
+    DIFFERENCE_MAP_NORM_BLACK
+};
+
+/**
+ * Computes a difference map of the two images as an RGBA8 image with the size of the input images.
+ */
+void computeDifferenceMap(const ImageViewRGBA8 &expected, const ImageViewRGBA8 &observed,
+        DifferenceMapMode mode, std::vector<uint8_t> &differenceMap);
+
+#endif //PIXELSYNCOIT_IMAGEMETRICS_HPP
@@ -315,6 +315,8 @@ void getTestModesTiling(std::vector<InternalState> &states, InternalState state)
 // Quality test: Shuffle geometry randomly
 void getTestModesShuffleGeometry(std::vector<InternalState> &states, InternalState state, int runNumber)
 {
+    // Every run uses a different, but reproducible primitive order.
+    state.shuffleSeed = uint64_t(runNumber);
     state.oitAlgorithm = RENDER_MODE_OIT_MLAB;
     state.name = std::string() + "MLAB " + sgl::toString(8) + " Layers, Shuffled " + sgl::toString(runNumber);
     state.oitAlgorithmSettings.set(std::map<std::string, std::string>{
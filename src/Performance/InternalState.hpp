@@ -7,6 +7,7 @@
 
 #include <string>
 #include <map>
+#include <cstdint>
 #include <Utils/Convert.hpp>
 #include "../Shadows/ShadowTechnique.hpp"
 
@@ -197,7 +198,8 @@ struct InternalState
                && this->useStencilBuffer == rhs.useStencilBuffer
                && this->testNoInvocationInterlock == rhs.testNoInvocationInterlock
                && this->testNoAtomicOperations == rhs.testNoAtomicOperations
-               && this->testShuffleGeometry == rhs.testShuffleGeometry;
+               && this->testShuffleGeometry == rhs.testShuffleGeometry
+               && this->shuffleSeed == rhs.shuffleSeed;
     }
     bool operator!=(const InternalState &rhs) const {
         return !(*this == rhs);
@@ -219,6 +221,7 @@ struct InternalState
     bool testNoInvocationInterlock = false; // Test without pixel sync
     bool testNoAtomicOperations = false; // Test without atomic operations
     bool testShuffleGeometry = false;
+    uint64_t shuffleSeed = 0; // Seed of the primitive order if testShuffleGeometry is set (reproducible runs)
     bool testPixelSyncUnordered = true;
 };
 
@@ -7,22 +7,31 @@
 
 #include <Graphics/Texture/Bitmap.hpp>
 
-/// Returns mean squared error (RMSE)
+#include "ImageMetrics.hpp"
+
+// Wrappers of the functions in ImageMetrics.hpp for sgl::Bitmap objects.
+
+/// Returns mean squared error (MSE)
 double mse(const sgl::BitmapPtr &expected, const sgl::BitmapPtr &observed);
 
 /// Returns root mean squared error (RMSE)
 double rmse(const sgl::BitmapPtr &expected, const sgl::BitmapPtr &observed);
 
 /**
- * Returns the structural similarity index (SSIM).
+ * Returns the mean structural similarity index (SSIM) of the luminance of the images using an 11x11 Gaussian window
+ * (sigma = 1.5).
  *
  * Wang, Z., Bovik, A. C., Sheikh, H. R., and Simoncelli, E. P. 2004. Image Quality Assessment:
  * From Error Visibility to Structural Similarity. Trans. Img. Proc. 13, 4 (2004), 600–612.
  */
 double ssim(const sgl::BitmapPtr &expected, const sgl::BitmapPtr &observed);
 
+/// Returns the multi-scale structural similarity index (MS-SSIM) of the luminance of the images.
+double msssim(const sgl::BitmapPtr &expected, const sgl::BitmapPtr &observed);
+
 /**
  * Returns an structural similarity index (SSIM) difference image for the specified kernel size.
+ * The SSIM is computed for non-overlapping blocks of kernelSize x kernelSize pixels.
  *
  * Wang, Z., Bovik, A. C., Sheikh, H. R., and Simoncelli, E. P. 2004. Image Quality Assessment:
  * From Error Visibility to Structural Similarity. Trans. Img. Proc. 13, 4 (2004), 600–612.
@@ -32,8 +41,8 @@ sgl::BitmapPtr ssimDifferenceImage(const sgl::BitmapPtr &expected, const sgl::Bi
 /// Returns peak signal-to-noise ratio (PSNR, in dB)
 double psnr(const sgl::BitmapPtr &expected, const sgl::BitmapPtr &observed);
 
-/// Computes the difference map between the two passed bitmaps. The map is normalized so that the differences
-/// assume the total interval of [0,255] in the image.
+/// Computes the difference map between the two passed bitmaps (absolute difference of the RGB channels, see
+/// DIFFERENCE_MAP_RGB_DIFF).
 sgl::BitmapPtr computeNormalizedDifferenceMap(const sgl::BitmapPtr &expected, const sgl::BitmapPtr &observed);
 
 #endif //PIXELSYNCOIT_REFERENCEMETRIC_HPP
@@ -137,7 +137,9 @@ void OIT_RayTracing::fromFile(
             //convertTrajectoryDataToBinaryTriangleMesh(trajectoryType, filename, modelFilenameBinmesh, lineRadius);
             convertTrajectoryDataToBinaryTriangleMeshGPU(trajectoryType, filename, modelFilenameBinmesh, lineRadius);
         }
-        readMesh3D(modelFilenameBinmesh, binmesh);
+        if (!readMesh3D(modelFilenameBinmesh, binmesh) || binmesh.submeshes.empty()) {
+            return;
+        }
         BinarySubMesh &submesh = binmesh.submeshes.at(0);
         std::vector<uint32_t> &indices = submesh.indices;
         std::vector<glm::vec3> vertices;
@@ -20,6 +20,7 @@
 #include <Input/Mouse.hpp>
 #include <Graphics/Renderer.hpp>
 #include <Graphics/Texture/TextureManager.hpp>
+#include "VoxelRaytracing/VoxelData.hpp"
 #include "TransferFunctionWindow.hpp"
 
 using namespace tinyxml2;
@@ -49,6 +50,7 @@ TransferFunctionWindow::TransferFunctionWindow()
     }
 
     g_TransferFunctionWindowHandle = this;
+    setOpacityMappingFunction([this](float attr) { return getOpacityAtAttribute(attr); });
 }
 
 bool TransferFunctionWindow::saveFunctionToFile(const std::string &filename)
@@ -0,0 +1,46 @@
+#ifndef PIXELSYNCOIT_ARRAYVIEW_HPP
+#define PIXELSYNCOIT_ARRAYVIEW_HPP
+
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * Non-owning view of a contiguous range of elements (similar to std::span in C++20).
+ * Use ArrayView<const T> for read-only access.
+ */
+template<typename T>
+class ArrayView
+{
+public:
+    typedef typename std::remove_const<T>::type ValueType;
+
+    ArrayView() : ptr(nullptr), numElements(0) {}
+    ArrayView(T *ptr, size_t numElements) : ptr(ptr), numElements(numElements) {}
+    ArrayView(std::vector<ValueType> &vec) : ptr(vec.data()), numElements(vec.size()) {}
+    template<typename U = T, typename = typename std::enable_if<std::is_const<U>::value>::type>
+    ArrayView(const std::vector<ValueType> &vec) : ptr(vec.data()), numElements(vec.size()) {}
+    /// Conversion ArrayView<T> -> ArrayView<const T>.
+    template<typename U, typename = typename std::enable_if<std::is_same<const U, T>::value
+            && !std::is_same<U, T>::value>::type>
+    ArrayView(const ArrayView<U> &other) : ptr(other.data()), numElements(other.size()) {}
+
+    inline T *data() const { return ptr; }
+    inline size_t size() const { return numElements; }
+    inline bool empty() const { return numElements == 0; }
+
+    inline T &operator[](size_t i) const { return ptr[i]; }
+    inline T &front() const { return ptr[0]; }
+    inline T &back() const { return ptr[numElements - 1]; }
+    inline T *begin() const { return ptr; }
+    inline T *end() const { return ptr + numElements; }
+
+    /// @return A copy of the viewed elements.
+    inline std::vector<ValueType> toVector() const { return std::vector<ValueType>(ptr, ptr + numElements); }
+
+private:
+    T *ptr;
+    size_t numElements;
+};
+
+#endif //PIXELSYNCOIT_ARRAYVIEW_HPP
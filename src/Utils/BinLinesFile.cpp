@@ -0,0 +1,922 @@
+#define _FILE_OFFSET_BITS 64
+
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include <chrono>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <Utils/File/Logfile.hpp>
+#include <Utils/Convert.hpp>
+
+#include "BinLinesFile.hpp"
+
+const uint32_t BINLINES_MAGIC_NUMBER = 0x4E4C4942u; // "BILN"
+
+static_assert(sizeof(BinLinesFileHeader) == 128, "The .binlines header must not depend on the compiler.");
+static_assert(sizeof(BinLinesAttributeInfo) == 24, "The .binlines attribute info must not depend on the compiler.");
+
+static inline uint64_t alignSectionOffset(uint64_t offset)
+{
+    return (offset + BINLINES_SECTION_ALIGNMENT - 1) / BINLINES_SECTION_ALIGNMENT * BINLINES_SECTION_ALIGNMENT;
+}
+
+static double getCurrentTimeSeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// @return True if numElements elements of the passed size starting at offset lie within a file of size fileSize.
+static inline bool isRangeInFile(uint64_t offset, uint64_t numElements, uint64_t elementSize, uint64_t fileSize)
+{
+    return numElements <= fileSize / elementSize && offset <= fileSize - numElements * elementSize;
+}
+
+static std::string getDefaultAttributeName(size_t attributeIndex)
+{
+    return std::string() + "attribute" + sgl::toString(int(attributeIndex));
+}
+
+
+// --- Block compression ---
+
+/**
+ * Maps values in [minValue, maxValue] to the integers [0, 2^numBits - 1] (rounded to the nearest level). Values
+ * outside of the range (including infinity and NaN) are clamped.
+ */
+class BinLinesQuantizer
+{
+public:
+    BinLinesQuantizer(float minValue, float maxValue, uint32_t numBits) : minValue(minValue) {
+        maxLevel = uint32_t((uint64_t(1) << numBits) - 1u);
+        double extent = double(maxValue) - double(minValue);
+        scale = extent > 0.0 ? double(maxLevel) / extent : 0.0;
+        inverseScale = extent > 0.0 ? extent / double(maxLevel) : 0.0;
+    }
+    inline uint32_t quantize(float value) const {
+        double level = (double(value) - double(minValue)) * scale + 0.5;
+        if (!(level > 0.0)) {
+            return 0u;
+        }
+        return level >= double(maxLevel) ? maxLevel : uint32_t(level);
+    }
+    inline float dequantize(uint32_t level) const {
+        return float(double(minValue) + double(level) * inverseScale);
+    }
+    inline uint32_t getMaxLevel() const { return maxLevel; }
+
+private:
+    float minValue;
+    double scale, inverseScale;
+    uint32_t maxLevel;
+};
+
+static inline void writeVarint(std::vector<uint8_t> &data, int64_t delta)
+{
+    // Zigzag coding maps small negative and positive deltas to small unsigned numbers.
+    uint64_t value = (uint64_t(delta) << 1) ^ uint64_t(delta >> 63);
+    while (value >= 0x80u) {
+        data.push_back(uint8_t(value) | 0x80u);
+        value >>= 7;
+    }
+    data.push_back(uint8_t(value));
+}
+
+static inline bool readVarint(const uint8_t *&ptr, const uint8_t *end, int64_t &delta)
+{
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (ptr == end) {
+            return false;
+        }
+        uint8_t byte = *(ptr++);
+        value |= uint64_t(byte & 0x7Fu) << shift;
+        if ((byte & 0x80u) == 0) {
+            delta = int64_t(value >> 1) ^ -int64_t(value & 1u);
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @return The index of the (non-empty) line containing the passed point.
+template<class T>
+static inline size_t findLineOfPoint(const T *lineOffsets, size_t numLines, size_t pointIndex)
+{
+    return size_t(std::upper_bound(lineOffsets, lineOffsets + numLines + 1, T(pointIndex)) - lineOffsets) - 1;
+}
+
+/**
+ * Calls callback(pointIndex, isFirstPointOfRun) for the points in [start, end), where a run restarts at the start of
+ * each line and at the start of the block.
+ */
+template<class T, class Callback>
+static inline void forEachBlockPoint(const T *lineOffsets, size_t numLines, size_t start, size_t end,
+        Callback callback)
+{
+    size_t lineIndex = findLineOfPoint(lineOffsets, numLines, start);
+    for (size_t pointIndex = start; pointIndex < end; pointIndex++) {
+        while (size_t(lineOffsets[lineIndex + 1]) <= pointIndex) {
+            lineIndex++;
+        }
+        callback(pointIndex, pointIndex == start || pointIndex == size_t(lineOffsets[lineIndex]));
+    }
+}
+
+static void encodeBlock(const TrajectorySet &trajectories, size_t start, size_t end,
+        const BinLinesQuantizer positionQuantizers[3], const std::vector<BinLinesQuantizer> &attributeQuantizers,
+        std::vector<uint8_t> &data)
+{
+    const size_t numLines = trajectories.getNumTrajectories();
+    data.reserve((end - start) * (3 + attributeQuantizers.size()) * 2);
+
+    int64_t previousPosition[3] = { 0, 0, 0 };
+    forEachBlockPoint(trajectories.lineOffsets.data(), numLines, start, end, [&](size_t pointIndex, bool restart) {
+        const glm::vec3 &position = trajectories.positions[pointIndex];
+        for (int c = 0; c < 3; c++) {
+            int64_t level = int64_t(positionQuantizers[c].quantize(position[c]));
+            writeVarint(data, restart ? level : level - previousPosition[c]);
+            previousPosition[c] = level;
+        }
+    });
+
+    for (size_t attributeIndex = 0; attributeIndex < attributeQuantizers.size(); attributeIndex++) {
+        const BinLinesQuantizer &quantizer = attributeQuantizers.at(attributeIndex);
+        const std::vector<float> &attribute = trajectories.attributes.at(attributeIndex);
+        int64_t previousValue = 0;
+        forEachBlockPoint(trajectories.lineOffsets.data(), numLines, start, end, [&](size_t pointIndex, bool restart) {
+            int64_t level = int64_t(quantizer.quantize(attribute[pointIndex]));
+            writeVarint(data, restart ? level : level - previousValue);
+            previousValue = level;
+        });
+    }
+}
+
+
+// --- Writer ---
+
+bool writeBinLinesFile(const std::string &filename, const TrajectorySet &trajectories,
+        const std::vector<std::string> &attributeNames, const BinLinesWriteSettings &settings)
+{
+    if (settings.compressed && (settings.positionQuantizationBits < 1 || settings.positionQuantizationBits > 30
+            || settings.attributeQuantizationBits < 1 || settings.attributeQuantizationBits > 30
+            || settings.blockSize == 0)) {
+        sgl::Logfile::get()->writeError("Error in writeBinLinesFile: Invalid compression settings.");
+        return false;
+    }
+
+    double startTime = getCurrentTimeSeconds();
+    const size_t numLines = trajectories.getNumTrajectories();
+    const size_t numPoints = trajectories.getNumPoints();
+    const size_t numAttributes = trajectories.getNumAttributes();
+
+    BinLinesFileHeader header;
+    memset(&header, 0, sizeof(BinLinesFileHeader));
+    header.version = BINLINES_FORMAT_VERSION;
+    header.magicNumber = BINLINES_MAGIC_NUMBER;
+    header.numLines = numLines;
+    header.numPoints = numPoints;
+    header.numAttributes = uint32_t(numAttributes);
+    header.flags = settings.compressed ? uint32_t(BINLINES_FLAG_COMPRESSED) : 0u;
+
+    // The bounding box and the attribute ranges only consider finite values, as they define the quantization grid.
+    float minX = FLT_MAX, minY = FLT_MAX, minZ = FLT_MAX;
+    float maxX = -FLT_MAX, maxY = -FLT_MAX, maxZ = -FLT_MAX;
+    #pragma omp parallel for reduction(min:minX,minY,minZ) reduction(max:maxX,maxY,maxZ)
+    for (size_t i = 0; i < numPoints; i++) {
+        const glm::vec3 &position = trajectories.positions[i];
+        if (std::isfinite(position.x) && std::isfinite(position.y) && std::isfinite(position.z)) {
+            minX = std::min(minX, position.x);
+            minY = std::min(minY, position.y);
+            minZ = std::min(minZ, position.z);
+            maxX = std::max(maxX, position.x);
+            maxY = std::max(maxY, position.y);
+            maxZ = std::max(maxZ, position.z);
+        }
+    }
+    if (minX > maxX) {
+        minX = minY = minZ = maxX = maxY = maxZ = 0.0f;
+    }
+    header.boundingBoxMin[0] = minX;
+    header.boundingBoxMin[1] = minY;
+    header.boundingBoxMin[2] = minZ;
+    header.boundingBoxMax[0] = maxX;
+    header.boundingBoxMax[1] = maxY;
+    header.boundingBoxMax[2] = maxZ;
+
+    std::vector<BinLinesAttributeInfo> attributeInfos(numAttributes);
+    std::string stringPool;
+    for (size_t attributeIndex = 0; attributeIndex < numAttributes; attributeIndex++) {
+        const std::vector<float> &attribute = trajectories.attributes.at(attributeIndex);
+        float minValue = FLT_MAX, maxValue = -FLT_MAX;
+        #pragma omp parallel for reduction(min:minValue) reduction(max:maxValue)
+        for (size_t i = 0; i < numPoints; i++) {
+            if (std::isfinite(attribute[i])) {
+                minValue = std::min(minValue, attribute[i]);
+                maxValue = std::max(maxValue, attribute[i]);
+            }
+        }
+        if (minValue > maxValue) {
+            minValue = maxValue = 0.0f;
+        }
+
+        std::string name = attributeIndex < attributeNames.size() && !attributeNames.at(attributeIndex).empty()
+                ? attributeNames.at(attributeIndex) : getDefaultAttributeName(attributeIndex);
+        BinLinesAttributeInfo &info = attributeInfos.at(attributeIndex);
+        info.nameOffset = uint32_t(stringPool.size());
+        info.nameLength = uint32_t(name.size());
+        info.minValue = minValue;
+        info.maxValue = maxValue;
+        info.dataOffset = 0;
+        stringPool += name;
+    }
+
+    // Compress the blocks in parallel. Each block only depends on its own points.
+    std::vector<std::vector<uint8_t>> blocks;
+    std::vector<uint64_t> blockTable;
+    if (settings.compressed) {
+        header.positionQuantizationBits = settings.positionQuantizationBits;
+        header.attributeQuantizationBits = settings.attributeQuantizationBits;
+        header.blockSize = settings.blockSize;
+        BinLinesQuantizer positionQuantizers[3] = {
+                BinLinesQuantizer(minX, maxX, settings.positionQuantizationBits),
+                BinLinesQuantizer(minY, maxY, settings.positionQuantizationBits),
+                BinLinesQuantizer(minZ, maxZ, settings.positionQuantizationBits)
+        };
+        std::vector<BinLinesQuantizer> attributeQuantizers;
+        for (const BinLinesAttributeInfo &info : attributeInfos) {
+            attributeQuantizers.push_back(BinLinesQuantizer(
+                    info.minValue, info.maxValue, settings.attributeQuantizationBits));
+        }
+
+        const size_t numBlocks = (numPoints + settings.blockSize - 1) / settings.blockSize;
+        blocks.resize(numBlocks);
+        #pragma omp parallel for schedule(dynamic)
+        for (size_t blockIndex = 0; blockIndex < numBlocks; blockIndex++) {
+            size_t start = blockIndex * settings.blockSize;
+            size_t end = std::min(start + settings.blockSize, numPoints);
+            encodeBlock(trajectories, start, end, positionQuantizers, attributeQuantizers, blocks.at(blockIndex));
+        }
+
+        blockTable.resize(numBlocks + 1);
+        blockTable.front() = 0;
+        for (size_t blockIndex = 0; blockIndex < numBlocks; blockIndex++) {
+            blockTable.at(blockIndex + 1) = blockTable.at(blockIndex) + blocks.at(blockIndex).size();
+        }
+    }
+
+    // File layout
+    uint64_t fileOffset = alignSectionOffset(sizeof(BinLinesFileHeader));
+    header.attributeInfoOffset = fileOffset;
+    header.stringPoolOffset = fileOffset + numAttributes * sizeof(BinLinesAttributeInfo);
+    header.stringPoolSize = stringPool.size();
+    fileOffset = alignSectionOffset(header.stringPoolOffset + header.stringPoolSize);
+    header.lineOffsetsOffset = fileOffset;
+    fileOffset = alignSectionOffset(fileOffset + (numLines + 1) * sizeof(uint64_t));
+    if (settings.compressed) {
+        header.blockTableOffset = fileOffset;
+        fileOffset = alignSectionOffset(fileOffset + blockTable.size() * sizeof(uint64_t));
+        header.compressedDataOffset = fileOffset;
+        fileOffset += blockTable.back();
+    } else {
+        header.positionsOffset = fileOffset;
+        fileOffset = alignSectionOffset(fileOffset + numPoints * sizeof(glm::vec3));
+        for (BinLinesAttributeInfo &info : attributeInfos) {
+            info.dataOffset = fileOffset;
+            fileOffset = alignSectionOffset(fileOffset + numPoints * sizeof(float));
+        }
+    }
+
+    std::vector<uint64_t> lineOffsets(trajectories.lineOffsets.begin(), trajectories.lineOffsets.end());
+
+    std::string tempFilename = filename + ".tmp";
+    FILE *file = fopen(tempFilename.c_str(), "wb");
+    if (file == nullptr) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in writeBinLinesFile: Could not open file \""
+                + tempFilename + "\" for writing.");
+        return false;
+    }
+
+    bool ioError = false;
+    uint64_t writeOffset = 0;
+    const uint8_t paddingBytes[BINLINES_SECTION_ALIGNMENT] = { 0 };
+    auto writeBytes = [&](const void *data, size_t dataSize) {
+        if (dataSize > 0 && !ioError && fwrite(data, 1, dataSize, file) != dataSize) {
+            ioError = true;
+        }
+        writeOffset += dataSize;
+    };
+    auto writeSection = [&](uint64_t sectionOffset, const void *data, size_t dataSize) {
+        writeBytes(paddingBytes, sectionOffset - writeOffset);
+        writeBytes(data, dataSize);
+    };
+
+    writeSection(0, &header, sizeof(BinLinesFileHeader));
+    writeSection(header.attributeInfoOffset, attributeInfos.data(), numAttributes * sizeof(BinLinesAttributeInfo));
+    writeSection(header.stringPoolOffset, stringPool.data(), stringPool.size());
+    writeSection(header.lineOffsetsOffset, lineOffsets.data(), lineOffsets.size() * sizeof(uint64_t));
+    if (settings.compressed) {
+        writeSection(header.blockTableOffset, blockTable.data(), blockTable.size() * sizeof(uint64_t));
+        writeSection(header.compressedDataOffset, nullptr, 0);
+        for (const std::vector<uint8_t> &block : blocks) {
+            writeBytes(block.data(), block.size());
+        }
+    } else {
+        writeSection(header.positionsOffset, trajectories.positions.data(), numPoints * sizeof(glm::vec3));
+        for (size_t attributeIndex = 0; attributeIndex < numAttributes; attributeIndex++) {
+            writeSection(attributeInfos.at(attributeIndex).dataOffset,
+                    trajectories.attributes.at(attributeIndex).data(), numPoints * sizeof(float));
+        }
+    }
+
+    if (fflush(file) != 0) {
+        ioError = true;
+    }
+#ifndef _WIN32
+    fsync(fileno(file));
+#endif
+    fclose(file);
+
+    if (ioError) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in writeBinLinesFile: Could not write file \""
+                + tempFilename + "\".");
+        remove(tempFilename.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    bool renamed = MoveFileExA(tempFilename.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    bool renamed = rename(tempFilename.c_str(), filename.c_str()) == 0;
+#endif
+    if (!renamed) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in writeBinLinesFile: Could not rename \""
+                + tempFilename + "\" to \"" + filename + "\".");
+        remove(tempFilename.c_str());
+        return false;
+    }
+
+    double elapsedSeconds = std::max(getCurrentTimeSeconds() - startTime, 1e-9);
+    double sizeMB = writeOffset / 1024.0 / 1024.0;
+    sgl::Logfile::get()->writeInfo(std::string() + "Wrote " + sgl::toString(sizeMB) + " MB to \"" + filename
+            + "\" in " + sgl::toString(elapsedSeconds) + "s (" + sgl::toString(sizeMB / elapsedSeconds) + " MB/s).");
+    return true;
+}
+
+
+BinLinesStreamWriter::~BinLinesStreamWriter()
+{
+    if (file) {
+        abort();
+    }
+}
+
+bool BinLinesStreamWriter::open(const std::string &filename)
+{
+    abort();
+    this->filename = filename;
+    tempFilename = filename + ".tmp";
+    numAttributes = 0;
+    numTrajectories = 0;
+    ioError = false;
+
+    file = fopen(tempFilename.c_str(), "wb");
+    if (file == nullptr) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in BinLinesStreamWriter::open: Could not open file \""
+                + tempFilename + "\" for writing.");
+        return false;
+    }
+
+    // Placeholder; the header is written by finish().
+    uint32_t header[3] = { BINLINES_FORMAT_VERSION_LEGACY, 0u, 0u };
+    ioError = fwrite(header, sizeof(header), 1, file) != 1;
+    return !ioError;
+}
+
+bool BinLinesStreamWriter::writeTrajectories(const TrajectorySet &trajectories)
+{
+    if (!file || trajectories.empty()) {
+        return file != nullptr;
+    }
+    if (numTrajectories == 0) {
+        numAttributes = uint32_t(trajectories.getNumAttributes());
+    }
+    if (trajectories.getNumAttributes() != numAttributes
+            || numTrajectories + trajectories.getNumTrajectories() > UINT32_MAX) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in BinLinesStreamWriter::writeTrajectories: The "
+                "lines cannot be stored in \"" + filename + "\" (mismatch in number of attributes or too many lines).");
+        ioError = true;
+        return false;
+    }
+
+    for (size_t lineIndex = 0; lineIndex < trajectories.getNumTrajectories() && !ioError; lineIndex++) {
+        const size_t numPoints = trajectories.getNumPoints(lineIndex);
+        if (numPoints > UINT32_MAX) {
+            ioError = true;
+            break;
+        }
+        uint32_t trajectoryNumPoints = uint32_t(numPoints);
+        ioError = fwrite(&trajectoryNumPoints, sizeof(uint32_t), 1, file) != 1
+                || fwrite(trajectories.getPositions(lineIndex).data(), sizeof(glm::vec3), numPoints, file) != numPoints;
+        for (uint32_t attributeIndex = 0; attributeIndex < numAttributes && !ioError; attributeIndex++) {
+            ioError = fwrite(trajectories.getAttribute(lineIndex, attributeIndex).data(), sizeof(float), numPoints,
+                    file) != numPoints;
+        }
+    }
+    numTrajectories += trajectories.getNumTrajectories();
+    return !ioError;
+}
+
+bool BinLinesStreamWriter::finish()
+{
+    if (!file) {
+        return false;
+    }
+
+    // Now that the number of lines is known, the header can be written.
+    uint32_t header[3] = { BINLINES_FORMAT_VERSION_LEGACY, uint32_t(numTrajectories), numAttributes };
+    if (fseek(file, 0, SEEK_SET) != 0 || fwrite(header, sizeof(header), 1, file) != 1 || fflush(file) != 0) {
+        ioError = true;
+    }
+#ifndef _WIN32
+    fsync(fileno(file));
+#endif
+    fclose(file);
+    file = nullptr;
+
+    if (ioError) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in BinLinesStreamWriter::finish: Could not write file \""
+                + tempFilename + "\".");
+        remove(tempFilename.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    bool renamed = MoveFileExA(tempFilename.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    bool renamed = rename(tempFilename.c_str(), filename.c_str()) == 0;
+#endif
+    if (!renamed) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in BinLinesStreamWriter::finish: Could not rename \""
+                + tempFilename + "\" to \"" + filename + "\".");
+        remove(tempFilename.c_str());
+        return false;
+    }
+    return true;
+}
+
+void BinLinesStreamWriter::abort()
+{
+    if (file) {
+        fclose(file);
+        file = nullptr;
+        remove(tempFilename.c_str());
+    }
+}
+
+
+// --- Reader ---
+
+/**
+ * Reads a version 1 file. The sizes of all lines are determined in a first pass over the file, such that the point
+ * data can afterwards be copied in parallel to its final position.
+ */
+static bool readBinLinesFileVersion1(const std::string &filename, TrajectorySet &trajectories)
+{
+    MappedFile mappedFile;
+    if (!mappedFile.open(filename)) {
+        return false;
+    }
+    const uint8_t *fileData = mappedFile.getData();
+    const uint64_t fileSize = mappedFile.getSize();
+
+    uint32_t header[3];
+    if (fileSize < sizeof(header)) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in readBinLinesFile: Truncated header in file \""
+                + filename + "\".");
+        return false;
+    }
+    memcpy(header, fileData, sizeof(header));
+    const uint32_t numTrajectories = header[1];
+    const uint32_t numAttributes = header[2];
+    const uint64_t bytesPerPoint = sizeof(glm::vec3) + uint64_t(numAttributes) * sizeof(float);
+
+    std::vector<size_t> numPointsPerLine(numTrajectories);
+    std::vector<uint64_t> lineDataOffsets(numTrajectories);
+    uint64_t fileOffset = sizeof(header);
+    for (uint32_t trajectoryIndex = 0; trajectoryIndex < numTrajectories; trajectoryIndex++) {
+        uint32_t trajectoryNumPoints = 0;
+        if (isRangeInFile(fileOffset, 1, sizeof(uint32_t), fileSize)) {
+            memcpy(&trajectoryNumPoints, fileData + fileOffset, sizeof(uint32_t));
+        }
+        fileOffset += sizeof(uint32_t);
+        if (!isRangeInFile(fileOffset, trajectoryNumPoints, bytesPerPoint, fileSize)) {
+            sgl::Logfile::get()->writeError(std::string() + "Error in readBinLinesFile: Unexpected end of file \""
+                    + filename + "\".");
+            return false;
+        }
+        numPointsPerLine.at(trajectoryIndex) = trajectoryNumPoints;
+        lineDataOffsets.at(trajectoryIndex) = fileOffset;
+        fileOffset += trajectoryNumPoints * bytesPerPoint;
+    }
+
+    trajectories.allocate(numPointsPerLine, numAttributes);
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (size_t trajectoryIndex = 0; trajectoryIndex < numTrajectories; trajectoryIndex++) {
+        const size_t trajectoryNumPoints = numPointsPerLine.at(trajectoryIndex);
+        const uint8_t *lineData = fileData + lineDataOffsets.at(trajectoryIndex);
+        memcpy(trajectories.getPositions(trajectoryIndex).data(), lineData, trajectoryNumPoints * sizeof(glm::vec3));
+        lineData += trajectoryNumPoints * sizeof(glm::vec3);
+        for (uint32_t attributeIndex = 0; attributeIndex < numAttributes; attributeIndex++) {
+            memcpy(trajectories.getAttribute(trajectoryIndex, attributeIndex).data(), lineData,
+                    trajectoryNumPoints * sizeof(float));
+            lineData += trajectoryNumPoints * sizeof(float);
+        }
+    }
+    return true;
+}
+
+bool MappedBinLines::open(const std::string &filename)
+{
+    close();
+    this->filename = filename;
+
+    mappedFile = MappedFilePtr(new MappedFile);
+    if (!mappedFile->open(filename)) {
+        mappedFile = MappedFilePtr();
+        return false;
+    }
+
+    uint32_t version = 0;
+    if (mappedFile->getSize() >= sizeof(uint32_t)) {
+        memcpy(&version, mappedFile->getData(), sizeof(uint32_t));
+    }
+
+    bool success = false;
+    if (version == BINLINES_FORMAT_VERSION) {
+        success = openVersion2(filename);
+    } else if (version == BINLINES_FORMAT_VERSION_LEGACY) {
+        mappedFile = MappedFilePtr();
+        success = openVersion1(filename);
+    } else {
+        sgl::Logfile::get()->writeError(std::string() + "Error in readBinLinesFile: Invalid version in file \""
+                + filename + "\".");
+    }
+
+    if (!success) {
+        close();
+    }
+    return success;
+}
+
+bool MappedBinLines::openVersion2(const std::string &filename)
+{
+    const uint8_t *fileData = mappedFile->getData();
+    const uint64_t fileSize = mappedFile->getSize();
+
+    BinLinesFileHeader header;
+    if (fileSize < sizeof(BinLinesFileHeader)) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in readBinLinesFile: Truncated header in file \""
+                + filename + "\".");
+        return false;
+    }
+    memcpy(&header, fileData, sizeof(BinLinesFileHeader));
+    compressed = (header.flags & BINLINES_FLAG_COMPRESSED) != 0;
+    const uint64_t numBlocks = compressed && header.blockSize > 0
+            ? (header.numPoints + header.blockSize - 1) / header.blockSize : 0;
+    bool headerValid = header.magicNumber == BINLINES_MAGIC_NUMBER
+            && header.numLines < fileSize / sizeof(uint64_t)
+            && isRangeInFile(header.attributeInfoOffset, header.numAttributes, sizeof(BinLinesAttributeInfo), fileSize)
+            && isRangeInFile(header.stringPoolOffset, header.stringPoolSize, 1, fileSize)
+            && header.lineOffsetsOffset % sizeof(uint64_t) == 0
+            && isRangeInFile(header.lineOffsetsOffset, header.numLines + 1, sizeof(uint64_t), fileSize);
+    if (headerValid && compressed) {
+        headerValid = header.blockSize > 0
+                && header.positionQuantizationBits >= 1 && header.positionQuantizationBits <= 30
+                && header.attributeQuantizationBits >= 1 && header.attributeQuantizationBits <= 30
+                && header.blockTableOffset % sizeof(uint64_t) == 0
+                && isRangeInFile(header.blockTableOffset, numBlocks + 1, sizeof(uint64_t), fileSize)
+                && header.compressedDataOffset <= fileSize
+                // Every point needs at least one byte per coordinate and attribute.
+                && isRangeInFile(header.compressedDataOffset, header.numPoints, 3u + header.numAttributes, fileSize);
+    } else if (headerValid) {
+        headerValid = header.positionsOffset % sizeof(float) == 0
+                && isRangeInFile(header.positionsOffset, header.numPoints, sizeof(glm::vec3), fileSize);
+    }
+    if (!headerValid) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in readBinLinesFile: Invalid header in file \""
+                + filename + "\".");
+        return false;
+    }
+
+    numLines = header.numLines;
+    numPoints = header.numPoints;
+    boundingBox = sgl::AABB3(
+            glm::vec3(header.boundingBoxMin[0], header.boundingBoxMin[1], header.boundingBoxMin[2]),
+            glm::vec3(header.boundingBoxMax[0], header.boundingBoxMax[1], header.boundingBoxMax[2]));
+    positionQuantizationBits = header.positionQuantizationBits;
+    attributeQuantizationBits = header.attributeQuantizationBits;
+    blockSize = header.blockSize;
+
+    attributeInfos.resize(header.numAttributes);
+    if (header.numAttributes > 0) {
+        memcpy(&attributeInfos.front(), fileData + header.attributeInfoOffset,
+                header.numAttributes * sizeof(BinLinesAttributeInfo));
+    }
+    const char *stringPool = (const char*)fileData + header.stringPoolOffset;
+    for (const BinLinesAttributeInfo &info : attributeInfos) {
+        if (uint64_t(info.nameOffset) + info.nameLength > header.stringPoolSize
+                || (!compressed && (info.dataOffset % sizeof(float) != 0
+                        || !isRangeInFile(info.dataOffset, numPoints, sizeof(float), fileSize)))) {
+            sgl::Logfile::get()->writeError(std::string() + "Error in readBinLinesFile: Invalid attribute info in "
+                    "file \"" + filename + "\".");
+            return false;
+        }
+        attributeNames.push_back(std::string(stringPool + info.nameOffset, info.nameLength));
+        attributes.push_back(compressed ? nullptr : (const float*)(fileData + info.dataOffset));
+    }
+
+    // The line offsets must be monotonic, as all per-line accessors rely on them.
+    lineOffsets = (const uint64_t*)(fileData + header.lineOffsetsOffset);
+    bool lineOffsetsValid = lineOffsets[0] == 0 && lineOffsets[numLines] == numPoints;
+    #pragma omp parallel for reduction(&&:lineOffsetsValid)
+    for (size_t lineIndex = 0; lineIndex < numLines; lineIndex++) {
+        lineOffsetsValid = lineOffsetsValid && lineOffsets[lineIndex] <= lineOffsets[lineIndex + 1];
+    }
+    if (!lineOffsetsValid) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in readBinLinesFile: Invalid line offsets in file \""
+                + filename + "\".");
+        return false;
+    }
+
+    if (compressed) {
+        blockTable = (const uint64_t*)(fileData + header.blockTableOffset);
+        compressedData = fileData + header.compressedDataOffset;
+        compressedDataSize = size_t(fileSize - header.compressedDataOffset);
+        bool blockTableValid = blockTable[0] == 0 && blockTable[numBlocks] <= compressedDataSize;
+        for (size_t blockIndex = 0; blockIndex < numBlocks; blockIndex++) {
+            blockTableValid = blockTableValid && blockTable[blockIndex] <= blockTable[blockIndex + 1];
+        }
+        if (!blockTableValid) {
+            sgl::Logfile::get()->writeError(std::string() + "Error in readBinLinesFile: Invalid block table in file \""
+                    + filename + "\".");
+            return false;
+        }
+    } else {
+        positions = (const glm::vec3*)(fileData + header.positionsOffset);
+    }
+
+    formatVersion = BINLINES_FORMAT_VERSION;
+    return true;
+}
+
+bool MappedBinLines::openVersion1(const std::string &filename)
+{
+    if (!readBinLinesFileVersion1(filename, legacyTrajectories)) {
+        return false;
+    }
+
+    numLines = legacyTrajectories.getNumTrajectories();
+    numPoints = legacyTrajectories.getNumPoints();
+    boundingBox = legacyTrajectories.computeBoundingBox();
+    legacyLineOffsets.assign(legacyTrajectories.lineOffsets.begin(), legacyTrajectories.lineOffsets.end());
+    lineOffsets = legacyLineOffsets.data();
+    positions = legacyTrajectories.positions.data();
+    for (size_t attributeIndex = 0; attributeIndex < legacyTrajectories.getNumAttributes(); attributeIndex++) {
+        BinLinesAttributeInfo info;
+        memset(&info, 0, sizeof(BinLinesAttributeInfo));
+        legacyTrajectories.computeAttributeRange(attributeIndex, info.minValue, info.maxValue);
+        attributeInfos.push_back(info);
+        attributeNames.push_back(getDefaultAttributeName(attributeIndex));
+        attributes.push_back(legacyTrajectories.attributes.at(attributeIndex).data());
+    }
+
+    formatVersion = BINLINES_FORMAT_VERSION_LEGACY;
+    return true;
+}
+
+void MappedBinLines::close()
+{
+    formatVersion = 0;
+    mappedFile = MappedFilePtr();
+    numLines = 0;
+    numPoints = 0;
+    compressed = false;
+    boundingBox = sgl::AABB3();
+    attributeNames.clear();
+    attributeInfos.clear();
+    positionQuantizationBits = 0;
+    attributeQuantizationBits = 0;
+    blockSize = 0;
+    lineOffsets = nullptr;
+    positions = nullptr;
+    attributes.clear();
+    blockTable = nullptr;
+    compressedData = nullptr;
+    compressedDataSize = 0;
+    legacyTrajectories = TrajectorySet();
+    legacyLineOffsets.clear();
+}
+
+ArrayView<const glm::vec3> MappedBinLines::getPositions(size_t lineIndex) const
+{
+    if (compressed) {
+        return ArrayView<const glm::vec3>();
+    }
+    return ArrayView<const glm::vec3>(positions + lineOffsets[lineIndex], getNumPoints(lineIndex));
+}
+
+ArrayView<const float> MappedBinLines::getAttribute(size_t lineIndex, size_t attributeIndex) const
+{
+    if (compressed) {
+        return ArrayView<const float>();
+    }
+    return ArrayView<const float>(attributes.at(attributeIndex) + lineOffsets[lineIndex], getNumPoints(lineIndex));
+}
+
+bool MappedBinLines::decodeBlock(size_t blockIndex, glm::vec3 *positionsOut,
+        const std::vector<float*> &attributesOut) const
+{
+    const size_t start = blockIndex * blockSize;
+    const size_t end = std::min(start + blockSize, numPoints);
+    const uint8_t *ptr = compressedData + blockTable[blockIndex];
+    const uint8_t *blockEnd = compressedData + blockTable[blockIndex + 1];
+
+    const glm::vec3 minVec = boundingBox.getMinimum(), maxVec = boundingBox.getMaximum();
+    BinLinesQuantizer positionQuantizers[3] = {
+            BinLinesQuantizer(minVec.x, maxVec.x, positionQuantizationBits),
+            BinLinesQuantizer(minVec.y, maxVec.y, positionQuantizationBits),
+            BinLinesQuantizer(minVec.z, maxVec.z, positionQuantizationBits)
+    };
+    const int64_t maxPositionLevel = int64_t(positionQuantizers[0].getMaxLevel());
+
+    bool valid = true;
+    int64_t previousPosition[3] = { 0, 0, 0 };
+    forEachBlockPoint(lineOffsets, numLines, start, end, [&](size_t pointIndex, bool restart) {
+        for (int c = 0; c < 3; c++) {
+            int64_t delta = 0;
+            valid = valid && readVarint(ptr, blockEnd, delta);
+            int64_t level = restart ? delta : previousPosition[c] + delta;
+            valid = valid && level >= 0 && level <= maxPositionLevel;
+            previousPosition[c] = level;
+            positionsOut[pointIndex - start][c] = positionQuantizers[c].dequantize(uint32_t(level));
+        }
+    });
+
+    for (size_t attributeIndex = 0; attributeIndex < attributesOut.size() && valid; attributeIndex++) {
+        const BinLinesAttributeInfo &info = attributeInfos.at(attributeIndex);
+        BinLinesQuantizer quantizer(info.minValue, info.maxValue, attributeQuantizationBits);
+        const int64_t maxLevel = int64_t(quantizer.getMaxLevel());
+        float *attributeOut = attributesOut.at(attributeIndex);
+        int64_t previousValue = 0;
+        forEachBlockPoint(lineOffsets, numLines, start, end, [&](size_t pointIndex, bool restart) {
+            int64_t delta = 0;
+            valid = valid && readVarint(ptr, blockEnd, delta);
+            int64_t level = restart ? delta : previousValue + delta;
+            valid = valid && level >= 0 && level <= maxLevel;
+            previousValue = level;
+            attributeOut[pointIndex - start] = quantizer.dequantize(uint32_t(level));
+        });
+    }
+
+    return valid && ptr == blockEnd;
+}
+
+bool MappedBinLines::readLine(size_t lineIndex, std::vector<glm::vec3> &linePositions,
+        std::vector<std::vector<float>> &lineAttributes) const
+{
+    const size_t start = size_t(lineOffsets[lineIndex]);
+    const size_t end = size_t(lineOffsets[lineIndex + 1]);
+    const size_t numAttributes = attributeNames.size();
+    linePositions.resize(end - start);
+    lineAttributes.resize(numAttributes);
+    for (std::vector<float> &attribute : lineAttributes) {
+        attribute.resize(end - start);
+    }
+
+    if (!compressed) {
+        std::copy(positions + start, positions + end, linePositions.begin());
+        for (size_t attributeIndex = 0; attributeIndex < numAttributes; attributeIndex++) {
+            std::copy(attributes.at(attributeIndex) + start, attributes.at(attributeIndex) + end,
+                    lineAttributes.at(attributeIndex).begin());
+        }
+        return true;
+    }
+
+    // Decode all blocks overlapping the line and copy the points of the line.
+    std::vector<glm::vec3> blockPositions(blockSize);
+    std::vector<std::vector<float>> blockAttributes(numAttributes, std::vector<float>(blockSize));
+    std::vector<float*> blockAttributePointers;
+    for (std::vector<float> &attribute : blockAttributes) {
+        blockAttributePointers.push_back(attribute.data());
+    }
+    for (size_t blockIndex = start / blockSize; blockIndex * blockSize < end; blockIndex++) {
+        if (!decodeBlock(blockIndex, blockPositions.data(), blockAttributePointers)) {
+            sgl::Logfile::get()->writeError(std::string() + "Error in MappedBinLines::readLine: Corrupt data in "
+                    "file \"" + filename + "\".");
+            return false;
+        }
+        size_t blockStart = blockIndex * blockSize;
+        size_t copyStart = std::max(start, blockStart);
+        size_t copyEnd = std::min(end, blockStart + blockSize);
+        std::copy(blockPositions.begin() + (copyStart - blockStart), blockPositions.begin() + (copyEnd - blockStart),
+                linePositions.begin() + (copyStart - start));
+        for (size_t attributeIndex = 0; attributeIndex < numAttributes; attributeIndex++) {
+            const std::vector<float> &blockAttribute = blockAttributes.at(attributeIndex);
+            std::copy(blockAttribute.begin() + (copyStart - blockStart), blockAttribute.begin() + (copyEnd - blockStart),
+                    lineAttributes.at(attributeIndex).begin() + (copyStart - start));
+        }
+    }
+    return true;
+}
+
+bool MappedBinLines::readAll(TrajectorySet &trajectories) const
+{
+    const size_t numAttributes = attributeNames.size();
+    trajectories.lineOffsets.assign(lineOffsets, lineOffsets + numLines + 1);
+    trajectories.positions.resize(numPoints);
+    trajectories.attributes.resize(numAttributes);
+    for (std::vector<float> &attribute : trajectories.attributes) {
+        attribute.resize(numPoints);
+    }
+
+    if (!compressed) {
+        // Copy in chunks, such that the page faults of the memory-mapped file are distributed among the threads.
+        const size_t CHUNK_SIZE = size_t(1) << 18;
+        const size_t numChunks = (numPoints + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        #pragma omp parallel for
+        for (size_t chunkIndex = 0; chunkIndex < numChunks; chunkIndex++) {
+            size_t start = chunkIndex * CHUNK_SIZE;
+            size_t end = std::min(start + CHUNK_SIZE, numPoints);
+            std::copy(positions + start, positions + end, trajectories.positions.begin() + start);
+            for (size_t attributeIndex = 0; attributeIndex < numAttributes; attributeIndex++) {
+                std::copy(attributes.at(attributeIndex) + start, attributes.at(attributeIndex) + end,
+                        trajectories.attributes.at(attributeIndex).begin() + start);
+            }
+        }
+        return true;
+    }
+
+    const size_t numBlocks = (numPoints + blockSize - 1) / blockSize;
+    bool valid = true;
+    #pragma omp parallel for schedule(dynamic) reduction(&&:valid)
+    for (size_t blockIndex = 0; blockIndex < numBlocks; blockIndex++) {
+        size_t start = blockIndex * blockSize;
+        std::vector<float*> attributesOut(numAttributes);
+        for (size_t attributeIndex = 0; attributeIndex < numAttributes; attributeIndex++) {
+            attributesOut.at(attributeIndex) = trajectories.attributes.at(attributeIndex).data() + start;
+        }
+        valid = decodeBlock(blockIndex, trajectories.positions.data() + start, attributesOut) && valid;
+    }
+    if (!valid) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in MappedBinLines::readAll: Corrupt data in file \""
+                + filename + "\".");
+    }
+    return valid;
+}
+
+
+bool readBinLinesFile(const std::string &filename, TrajectorySet &trajectories)
+{
+    // Version 1 files are read directly into the output to avoid copying the data owned by MappedBinLines.
+    uint32_t version = 0;
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (file != nullptr) {
+        if (fread(&version, sizeof(uint32_t), 1, file) != 1) {
+            version = 0;
+        }
+        fclose(file);
+    }
+    if (version == BINLINES_FORMAT_VERSION_LEGACY) {
+        if (!readBinLinesFileVersion1(filename, trajectories)) {
+            trajectories = TrajectorySet();
+            return false;
+        }
+        return true;
+    }
+
+    MappedBinLines binLines;
+    if (!binLines.open(filename) || !binLines.readAll(trajectories)) {
+        trajectories = TrajectorySet();
+        return false;
+    }
+    return true;
+}
+
+bool convertBinLinesFileToVersion2(const std::string &inputFilename, const std::string &outputFilename,
+        const BinLinesWriteSettings &settings)
+{
+    MappedBinLines binLines;
+    TrajectorySet trajectories;
+    if (!binLines.open(inputFilename) || !binLines.readAll(trajectories)) {
+        return false;
+    }
+    return writeBinLinesFile(outputFilename, trajectories, binLines.getAttributeNames(), settings);
+}
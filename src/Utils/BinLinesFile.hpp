@@ -0,0 +1,210 @@
+#ifndef PIXELSYNCOIT_BINLINESFILE_HPP
+#define PIXELSYNCOIT_BINLINESFILE_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+
+#include <glm/glm.hpp>
+#include <Math/Geometry/AABB3.hpp>
+
+#include "ArrayView.hpp"
+#include "MappedFile.hpp"
+#include "TrajectorySet.hpp"
+
+/**
+ * .binlines trajectory files.
+ *
+ * Version 1: uint32_t version, numTrajectories, numAttributes, followed by the data of each trajectory: uint32_t
+ * numPoints, numPoints glm::vec3 positions and numAttributes float arrays with numPoints values each.
+ *
+ * Version 2 (structure of arrays, memory-mappable):
+ *  - A BinLinesFileHeader at offset 0. The first four bytes store the format version in all versions of the format.
+ *  - numAttributes BinLinesAttributeInfo entries followed by a string pool storing the attribute names.
+ *  - The line offset table: numLines + 1 uint64_t point offsets, i.e., line i consists of the points
+ *    [lineOffsets[i], lineOffsets[i+1]).
+ *  - Uncompressed files: The positions of all points (glm::vec3) and one float array per attribute.
+ *  - Compressed files (BINLINES_FLAG_COMPRESSED): A block table with numBlocks + 1 uint64_t byte offsets relative to
+ *    compressedDataOffset, followed by the compressed blocks. Each block stores blockSize points (the last one
+ *    possibly fewer), so blocks can be decoded independently and in parallel. The positions are quantized on a
+ *    regular grid spanning the bounding box and the attributes on their value range. Within a block, first the
+ *    positions and then each attribute are stored as zigzag-coded varint deltas to the previous point of the same
+ *    line (to zero for the first point of a line or block).
+ * All sections start at a multiple of BINLINES_SECTION_ALIGNMENT, such that the data of uncompressed files can be
+ * accessed in place after memory-mapping the file.
+ */
+const uint32_t BINLINES_FORMAT_VERSION = 2u;
+const uint32_t BINLINES_FORMAT_VERSION_LEGACY = 1u;
+const uint32_t BINLINES_SECTION_ALIGNMENT = 64u;
+
+enum BinLinesFlags {
+    BINLINES_FLAG_COMPRESSED = 1
+};
+
+struct BinLinesFileHeader
+{
+    uint32_t version;
+    uint32_t magicNumber;
+    uint64_t numLines;
+    uint64_t numPoints;
+    uint32_t numAttributes;
+    uint32_t flags; // BinLinesFlags
+    float boundingBoxMin[3];
+    float boundingBoxMax[3];
+    uint32_t positionQuantizationBits; // Compressed files only
+    uint32_t attributeQuantizationBits; // Compressed files only
+    uint64_t attributeInfoOffset; // Absolute byte offsets in the file
+    uint64_t stringPoolOffset;
+    uint64_t stringPoolSize;
+    uint64_t lineOffsetsOffset;
+    uint64_t positionsOffset; // Uncompressed files only
+    uint64_t blockTableOffset; // Compressed files only
+    uint64_t compressedDataOffset; // Compressed files only
+    uint32_t blockSize; // Compressed files only: Number of points per block
+    uint32_t reserved;
+};
+
+struct BinLinesAttributeInfo
+{
+    uint32_t nameOffset; // Byte offset of the name in the string pool
+    uint32_t nameLength;
+    float minValue;
+    float maxValue;
+    uint64_t dataOffset; // Uncompressed files only: Absolute byte offset of the float array
+};
+
+struct BinLinesWriteSettings
+{
+    /// Lossy compression (quantization + delta coding). The maximum position error is half a quantization step,
+    /// i.e., extent / (2 * (2^positionQuantizationBits - 1)) per axis. Non-finite values are not preserved.
+    bool compressed = false;
+    uint32_t positionQuantizationBits = 20;
+    uint32_t attributeQuantizationBits = 16;
+    uint32_t blockSize = 4096;
+};
+
+/**
+ * Writes a version 2 .binlines file. Like BinaryMeshStreamWriter, the data is written to "<filename>.tmp" first, which
+ * is renamed to the final file name when all data was written successfully.
+ * @param attributeNames The names of the attributes. Missing names are set to "attribute<i>".
+ * @return True if the file was written successfully.
+ */
+bool writeBinLinesFile(const std::string &filename, const TrajectorySet &trajectories,
+        const std::vector<std::string> &attributeNames = {},
+        const BinLinesWriteSettings &settings = BinLinesWriteSettings());
+
+/**
+ * Writes a version 1 .binlines file incrementally, e.g. while converting a dataset that does not fit into memory.
+ * Version 1 is used as it is purely sequential (version 2 needs the number of points and the value ranges before the
+ * data can be written); such files can be converted afterwards with convertBinLinesFileToVersion2.
+ * Like writeBinLinesFile, the data is written to "<filename>.tmp", which is renamed by finish().
+ */
+class BinLinesStreamWriter
+{
+public:
+    BinLinesStreamWriter() : file(nullptr), numAttributes(0), numTrajectories(0), ioError(false) {}
+    ~BinLinesStreamWriter();
+    BinLinesStreamWriter(const BinLinesStreamWriter&) = delete;
+    BinLinesStreamWriter &operator=(const BinLinesStreamWriter&) = delete;
+
+    /// @return True if the temporary file could be created.
+    bool open(const std::string &filename);
+    /// Appends all lines of the passed set. All sets need to have the same number of attributes.
+    bool writeTrajectories(const TrajectorySet &trajectories);
+    /// Writes the header and renames the file. @return True if all data was written successfully.
+    bool finish();
+    /// Closes and removes the temporary file.
+    void abort();
+
+private:
+    std::string filename, tempFilename;
+    FILE *file;
+    uint32_t numAttributes;
+    uint64_t numTrajectories;
+    bool ioError;
+};
+
+/**
+ * Random access reader for .binlines files. Version 2 files are memory-mapped, i.e., opening a file only reads the
+ * header and the tables, and accessing a line only touches the pages of this line. The data of uncompressed files can
+ * be accessed without copying via getPositions/getAttribute.
+ * Version 1 files have no line offset table and are read completely into memory owned by this object.
+ */
+class MappedBinLines
+{
+public:
+    MappedBinLines() : formatVersion(0), numLines(0), numPoints(0), compressed(false), positionQuantizationBits(0),
+            attributeQuantizationBits(0), blockSize(0), lineOffsets(nullptr), positions(nullptr), blockTable(nullptr), compressedData(nullptr),
+            compressedDataSize(0) {}
+    MappedBinLines(const MappedBinLines&) = delete;
+    MappedBinLines &operator=(const MappedBinLines&) = delete;
+
+    /// @return True if the file could be opened.
+    bool open(const std::string &filename);
+    void close();
+    inline bool isOpen() const { return formatVersion != 0; }
+    inline uint32_t getFormatVersion() const { return formatVersion; }
+    inline bool isCompressed() const { return compressed; }
+
+    inline size_t getNumLines() const { return numLines; }
+    inline size_t getNumPoints() const { return numPoints; }
+    inline size_t getNumPoints(size_t lineIndex) const {
+        return size_t(lineOffsets[lineIndex + 1] - lineOffsets[lineIndex]);
+    }
+    inline size_t getNumAttributes() const { return attributeNames.size(); }
+    inline const std::vector<std::string> &getAttributeNames() const { return attributeNames; }
+    inline const sgl::AABB3 &getBoundingBox() const { return boundingBox; }
+
+    // Zero-copy access (not available for compressed files).
+    ArrayView<const glm::vec3> getPositions(size_t lineIndex) const;
+    ArrayView<const float> getAttribute(size_t lineIndex, size_t attributeIndex) const;
+
+    /// Copies (or decodes) one line. @return False if the compressed data is corrupt.
+    bool readLine(size_t lineIndex, std::vector<glm::vec3> &linePositions,
+            std::vector<std::vector<float>> &lineAttributes) const;
+    /// Copies (or decodes) all lines in parallel. @return False if the compressed data is corrupt.
+    bool readAll(TrajectorySet &trajectories) const;
+
+private:
+    bool openVersion2(const std::string &filename);
+    bool openVersion1(const std::string &filename);
+    /// Decodes the block into positionsOut[0, n) and attributesOut[a][0, n).
+    bool decodeBlock(size_t blockIndex, glm::vec3 *positionsOut, const std::vector<float*> &attributesOut) const;
+
+    std::string filename;
+    uint32_t formatVersion;
+    MappedFilePtr mappedFile;
+    size_t numLines, numPoints;
+    bool compressed;
+    sgl::AABB3 boundingBox;
+    std::vector<std::string> attributeNames;
+    std::vector<BinLinesAttributeInfo> attributeInfos;
+    uint32_t positionQuantizationBits, attributeQuantizationBits;
+    uint32_t blockSize;
+
+    const uint64_t *lineOffsets;
+    const glm::vec3 *positions;
+    std::vector<const float*> attributes;
+    const uint64_t *blockTable;
+    const uint8_t *compressedData;
+    size_t compressedDataSize;
+
+    TrajectorySet legacyTrajectories; ///< Owns the data of version 1 files.
+    std::vector<uint64_t> legacyLineOffsets;
+};
+
+/**
+ * Reads a .binlines file of any version into a TrajectorySet.
+ * @return False if the file could not be opened or is corrupt.
+ */
+bool readBinLinesFile(const std::string &filename, TrajectorySet &trajectories);
+
+/**
+ * Converts a version 1 .binlines file (e.g. written by the CFD pipeline or BinLinesStreamWriter) to version 2.
+ * Version 1 files store no attribute names; they are named "attribute<i>".
+ */
+bool convertBinLinesFileToVersion2(const std::string &inputFilename, const std::string &outputFilename,
+        const BinLinesWriteSettings &settings = BinLinesWriteSettings());
+
+#endif //PIXELSYNCOIT_BINLINESFILE_HPP
@@ -37,7 +37,7 @@
 #include "ImportanceCriteria.hpp"
 #include "BinaryObjLoader.hpp"
 
-void convertBinaryObjMeshToBinmesh(
+bool convertBinaryObjMeshToBinmesh(
         const std::string &bobjFilename,
         const std::string &binaryFilename)
 {
@@ -45,7 +45,7 @@ void convertBinaryObjMeshToBinmesh(
     if (!fin.is_open()) {
         sgl::Logfile::get()->writeError(std::string() + "Error in convertBinaryObjMeshToBinmesh: File \""
                 + bobjFilename + "\" does not exist.");
-        return;
+        return false;
     }
     sgl::Logfile::get()->writeInfo(std::string() + "Loading binary OBJ mesh from \"" + bobjFilename + "\"...");
 
@@ -92,7 +92,7 @@ void convertBinaryObjMeshToBinmesh(
     if (vertices.size() / 3 > UINT32_MAX) {
         sgl::Logfile::get()->writeError(std::string() + "Error in convertBinaryObjMeshToBinmesh: File \""
                 + bobjFilename + "\" has more than UINT32_MAX vertices (not supported currently).");
-        return;
+        return false;
     }
 
     // Convert indices to 32-bit values for the mesh.
@@ -154,6 +154,9 @@ void convertBinaryObjMeshToBinmesh(
     vertexAttributeData.clear(); vertexAttributeData.shrink_to_fit();
 
     sgl::Logfile::get()->writeInfo(std::string() + "Writing binary mesh...");
-    writeMesh3D(binaryFilename, binaryMesh);
+    if (!writeMesh3D(binaryFilename, binaryMesh)) {
+        return false;
+    }
     sgl::Logfile::get()->writeInfo(std::string() + "Finished writing binary mesh.");
-}
\ No newline at end of file
+    return true;
+}
@@ -26,12 +26,82 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <map>
+#include <cstdlib>
+#include <algorithm>
+#include <iostream>
 #include <Utils/Convert.hpp>
 #include <Utils/File/Logfile.hpp>
+#include "MeshAdjacency.hpp"
 #include "ComputeNormals.hpp"
-#include <iostream>
-#include <algorithm>
+
+/// Rows with more triangles than this remove duplicate neighbors by sorting instead of a linear search.
+static const size_t MAX_NUM_TRIANGLES_LINEAR_SEARCH = 32;
+
+/**
+ * Collects the ring-1 neighbors of vertex i (i.e., all vertices sharing a triangle with i) in the order in which
+ * they are first encountered when iterating over the (sorted) adjacent triangles.
+ * The neighbors are written directly into ring1Vertices, which only grows (at most two neighbors per triangle).
+ * Duplicates are found by a linear search for typical rows, and by sorting (vertex, position) pairs for vertices
+ * shared by many triangles.
+ * @param scratch A buffer reused between calls for the large rows.
+ * @return The number of ring-1 neighbors.
+ */
+static size_t collectRing1Vertices(
+        size_t i, const std::vector<uint32_t> &indices, ArrayView<const uint32_t> faceIndices,
+        std::vector<uint64_t> &scratch, std::vector<uint32_t> &ring1Vertices)
+{
+    if (ring1Vertices.size() < faceIndices.size() * 2) {
+        ring1Vertices.resize(faceIndices.size() * 2);
+    }
+
+    size_t numRing1Vertices = 0;
+    if (faceIndices.size() <= MAX_NUM_TRIANGLES_LINEAR_SEARCH) {
+        for (uint32_t face : faceIndices) {
+            const uint32_t *triangle = indices.data() + size_t(face) * 3;
+            for (size_t j = 0; j < 3; j++) {
+                uint32_t vID = triangle[j];
+                if (vID == i) {
+                    continue;
+                }
+                size_t k = 0;
+                while (k < numRing1Vertices && ring1Vertices[k] != vID) {
+                    k++;
+                }
+                if (k == numRing1Vertices) {
+                    ring1Vertices[numRing1Vertices++] = vID;
+                }
+            }
+        }
+        return numRing1Vertices;
+    }
+
+    scratch.clear();
+    for (uint32_t face : faceIndices) {
+        const uint32_t *triangle = indices.data() + size_t(face) * 3;
+        for (size_t j = 0; j < 3; j++) {
+            uint32_t vID = triangle[j];
+            if (vID != i) {
+                scratch.push_back((uint64_t(vID) << 32u) | uint64_t(scratch.size()));
+            }
+        }
+    }
+
+    // Keep the first occurrence of each vertex, then restore the order of discovery.
+    std::sort(scratch.begin(), scratch.end());
+    uint64_t lastVID = UINT64_MAX;
+    for (size_t k = 0; k < scratch.size(); k++) {
+        uint64_t vID = scratch[k] >> 32u;
+        if (vID != lastVID) {
+            scratch[numRing1Vertices++] = (scratch[k] << 32u) | vID;
+            lastVID = vID;
+        }
+    }
+    std::sort(scratch.begin(), scratch.begin() + numRing1Vertices);
+    for (size_t k = 0; k < numRing1Vertices; k++) {
+        ring1Vertices[k] = uint32_t(scratch[k] & 0xFFFFFFFFu);
+    }
+    return numRing1Vertices;
+}
 
 /**
  * Creates normals for the specified indexed vertex set.
@@ -44,19 +114,11 @@ void computeNormals(
         std::vector<glm::vec3> &normals,
         std::vector<float> &attributes)
 {
-    // For finding all triangles with a specific index. Maps vertex index -> first triangle index.
+    // For finding all triangles with a specific index.
     sgl::Logfile::get()->writeInfo(std::string() + "Creating index map for "
             + sgl::toString(indices.size()) + " indices...");
-    std::vector<std::vector<uint32_t>> indexMap;
-    indexMap.resize(vertices.size());
-
-#pragma omp parallel for
-    for (size_t j = 0; j < indices.size(); j++) {
-        size_t vindex = indices.at(j);
-        size_t faceIndex = j / 3;
-
-        indexMap[vindex].push_back(faceIndex);
-    }
+    VertexTriangleAdjacency adjacency;
+    buildVertexTriangleAdjacency(indices.data(), indices.size(), vertices.size(), adjacency);
 
     std::vector<glm::vec3> faceNormals(indices.size() / 3);
     sgl::Logfile::get()->writeInfo(std::string() + "Computing face normals for "
@@ -65,164 +127,108 @@ void computeNormals(
     for (size_t f = 0; f < faceNormals.size(); ++f)
     {
         size_t vertIndex = f * 3;
-        size_t i1 = indices.at(vertIndex), i2 = indices.at(vertIndex+1), i3 = indices.at(vertIndex+2);
-        glm::vec3 faceNormal = glm::cross(vertices.at(i3) - vertices.at(i1), vertices.at(i2) - vertices.at(i1));
-//        faceNormal = glm::normalize(faceNormal);
+        size_t i1 = indices[vertIndex], i2 = indices[vertIndex+1], i3 = indices[vertIndex+2];
         // don't normalize weights as triangle area is encoded in cross product
         // area is then used to weight contribution of normal to average normal at each vertex
-        faceNormals[f] = faceNormal;
+        faceNormals[f] = glm::cross(vertices[i3] - vertices[i1], vertices[i2] - vertices[i1]);
     }
 
     sgl::Logfile::get()->writeInfo(std::string() + "Computing normals for "
             + sgl::toString(vertices.size()) + " vertices...");
     normals.resize(vertices.size());
 
-#pragma omp parallel for
+    // The faces of each vertex are summed up in ascending order, so the result is independent of the thread count.
+    bool hasUnreferencedVertices = false;
+#pragma omp parallel for reduction(||:hasUnreferencedVertices)
     for (size_t i = 0; i < vertices.size(); i++) {
-
-        glm::vec3 normal(0.0f, 0.0f, 0.0f);
-        int numTrianglesSharedBy = 0;
-
-        const auto& faceIndices = indexMap[i];
-        for (const auto& face : faceIndices)
-        {
-//            size_t vertIndex = face * 3;
-//            size_t i1 = indices.at(vertIndex), i2 = indices.at(vertIndex+1), i3 = indices.at(vertIndex+2);
-//            glm::vec3 faceNormal = glm::cross(vertices.at(i3) - vertices.at(i1), vertices.at(i2) - vertices.at(i1));
-            const glm::vec3& faceNormal = faceNormals[face];
-            normal += faceNormal;
-            numTrianglesSharedBy++;
+        ArrayView<const uint32_t> faceIndices = adjacency.getTriangles(i);
+        if (faceIndices.empty()) {
+            hasUnreferencedVertices = true;
+            continue;
         }
 
-        if (numTrianglesSharedBy == 0) {
-            sgl::Logfile::get()->writeError("Error in createNormals: numTrianglesSharedBy == 0");
-            exit(1);
+        glm::vec3 normal(0.0f, 0.0f, 0.0f);
+        for (uint32_t face : faceIndices) {
+            normal += faceNormals[face];
         }
-        normal /= (float)numTrianglesSharedBy;
-        normal = glm::normalize(normal);
-        normals[i] = normal;
+        normal /= (float)faceIndices.size();
+        normals[i] = glm::normalize(normal);
+    }
+    if (hasUnreferencedVertices) {
+        sgl::Logfile::get()->writeError("Error in createNormals: numTrianglesSharedBy == 0");
+        exit(1);
     }
 
+    // Free the memory before the curvature pass.
+    faceNormals.clear();
+    faceNormals.shrink_to_fit();
+
     sgl::Logfile::get()->writeInfo(std::string() + "Computing curvature for "
                                    + sgl::toString(vertices.size()) + " vertices...");
     attributes.resize(vertices.size());
 
-#pragma omp parallel for
-    for (size_t i = 0; i < vertices.size(); i++)
+#pragma omp parallel
     {
-        // min curvature
-//        float k1 = std::numeric_limits<float>::max();
-//        float k2 = -std::numeric_limits<float>::min();
-
-        const auto& faceIndices = indexMap[i];
-        const glm::vec3& n0 = normals[i];
-        const glm::vec3& p0 = vertices[i];
-
-        // find edges
+        // Scratch buffers reused for all vertices processed by this thread.
+        std::vector<uint64_t> scratch;
         std::vector<uint32_t> ring1Vertices;
+        std::vector<float> ring1Curvatures;
 
-        for (const auto& face : faceIndices)
+#pragma omp for schedule(dynamic, 4096)
+        for (size_t i = 0; i < vertices.size(); i++)
         {
-            size_t vertIndex = face * 3;
-//            size_t i1 = indices.at(vertIndex), i2 = indices.at(vertIndex+1), i3 = indices.at(vertIndex+2);
-            std::vector<uint32_t> idx = { indices[vertIndex], indices[vertIndex+1], indices[vertIndex+2] };
+            const glm::vec3& n0 = normals[i];
+            const glm::vec3& p0 = vertices[i];
 
-            for (auto j = 0; j < 3; ++j)
-            {
-                auto vID = idx[j];
-                if (vID == i) { continue; }
+            // find edges
+            const size_t numRing1Vertices = collectRing1Vertices(
+                    i, indices, adjacency.getTriangles(i), scratch, ring1Vertices);
 
-                if (std::find(ring1Vertices.begin(), ring1Vertices.end(), vID) == ring1Vertices.end())
-                {
-                    ring1Vertices.push_back(vID);
-                }
+            // compute curvature
+            if (ring1Curvatures.size() < numRing1Vertices) {
+                ring1Curvatures.resize(numRing1Vertices);
             }
-        }
-
-        // compute curvature
-        std::vector<float> ring1Curvatures(ring1Vertices.size(), 0);
-
-        for (auto v = 0; v < ring1Vertices.size(); ++v)
-        {
-            const uint32_t vID = ring1Vertices[v];
+            for (size_t v = 0; v < numRing1Vertices; ++v)
+            {
+                const uint32_t vID = ring1Vertices[v];
 
-            const glm::vec3& n1 = normals[vID];
-            const glm::vec3& p1 = vertices[vID];
+                const glm::vec3& n1 = normals[vID];
+                const glm::vec3& p1 = vertices[vID];
 
-            const glm::vec3 n = n1 - n0;
-            const glm::vec3 p = p1 - p0;
+                const glm::vec3 n = n1 - n0;
+                const glm::vec3 p = p1 - p0;
 
-            const float l2 = glm::length(p) * glm::length(p);
+                const float l2 = glm::dot(p, p);
 
-            ring1Curvatures[v] = glm::dot(n, p) / l2;
-        }
+                ring1Curvatures[v] = glm::dot(n, p) / l2;
+            }
 
-        // compute edge curvatures
+            // compute edge curvatures
+            double totalCurvature = 0;
+            double totalAngle = 0;
 
-        double totalCurvature = 0;
-        double totalAngle = 0;
+            for (size_t e = 0; e + 1 < numRing1Vertices; ++e)
+            {
+                const glm::vec3& p1 = vertices[ring1Vertices[e]];
+                const glm::vec3& p2 = vertices[ring1Vertices[e + 1]];
+
+                // compute edge angle
+                glm::vec3 edge0 = p1 - p0;
+                glm::vec3 edge1 = p2 - p0;
+                glm::vec3 product = glm::cross(edge0, edge1);
+                double sineValue = glm::length(product) / (glm::length(edge0) * glm::length(edge1));
+                double angle = std::asin(std::min(1.0, sineValue));
+
+                totalAngle += angle;
+                totalCurvature += angle * (ring1Curvatures[e] + ring1Curvatures[e + 1]);
+            }
 
-        for (auto e = 0; e < ring1Vertices.size() - 1; ++e)
-        {
-            const glm::vec3& p1 = vertices[ring1Vertices[e]];
-            const glm::vec3& p2 = vertices[ring1Vertices[e + 1]];
-
-            // compute edge angle
-            glm::vec3 edge0 = p1 - p0;
-            glm::vec3 edge1 = p2 - p0;
-            glm::vec3 product = glm::cross(edge0, edge1);
-            double sineValue = glm::length(product) / (glm::length(edge0), glm::length(edge1));
-            double angle = glm::asin(std::min(1.0, sineValue));
-
-            totalAngle += angle;
-            totalCurvature += angle * (ring1Curvatures[e] + ring1Curvatures[e + 1]);
+            if (totalAngle > 0.0) {
+                totalCurvature = totalCurvature / (2 * totalAngle);
+            } else {
+                totalCurvature = 0.0;
+            }
+            attributes[i] = float(totalCurvature);
         }
-
-        totalCurvature = totalCurvature / (2 * totalAngle);
-        attributes[i] = totalCurvature;
-
-        ring1Curvatures.clear();
-        ring1Curvatures.shrink_to_fit();
-
-        ring1Vertices.clear();
-        ring1Vertices.shrink_to_fit();
-
-        // loop over faces
-//        for (const auto& face : faceIndices)
-//        {
-//            size_t vertIndex = face * 3;
-////            size_t i1 = indices.at(vertIndex), i2 = indices.at(vertIndex+1), i3 = indices.at(vertIndex+2);
-//            std::vector<uint32_t> idx = { indices[vertIndex], indices[vertIndex+1], indices[vertIndex+2] };
-//
-//            for (auto j = 0; j < 3; ++j)
-//            {
-//                auto vID = idx[j];
-//                if (vID == i) { continue; }
-//
-//                // compute curvature
-//                const glm::vec3& v1 = vertices[vID];
-//                const glm::vec3& n1 = normals[vID];
-//
-//                auto pD = glm::normalize(v1 - v0);
-//
-//                float k = glm::dot((n1 - n0), pD);
-//
-//                k1 = std::min(k, k1);
-//                k2 = std::max(k, k2);
-//            }
-//        }
-
-        //float meanCurvature = (k1 + k2) / 2;
-//        float gaussianCurvature = k1 * k2;
-//        attributes[i] = meanCurvature;
     }
-
-
-    // try to free memory for large data
-    std::cout << "Free memory" << std::endl << std::flush;
-    faceNormals.clear();
-    faceNormals.shrink_to_fit();
-    indexMap.clear();
-    indexMap.shrink_to_fit();
-    std::cout << "Free memory done." << std::endl << std::flush;
 }
@@ -0,0 +1,623 @@
+#define _FILE_OFFSET_BITS 64
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+#include <Utils/File/Logfile.hpp>
+#include <Utils/File/FileUtils.hpp>
+#include <Utils/Convert.hpp>
+
+#include "Hash.hpp"
+#include "MappedFile.hpp"
+#include "ConversionCache.hpp"
+
+static const char *MANIFEST_HEADER = "PixelSyncOIT conversion cache manifest 1";
+
+/**
+ * Exclusive lock on a file, which is held until the object is destroyed. It works both between processes and between
+ * threads of the same process (every object opens the file separately).
+ */
+class LockFile
+{
+public:
+    explicit LockFile(const std::string &filename);
+    ~LockFile();
+    LockFile(const LockFile&) = delete;
+    LockFile &operator=(const LockFile&) = delete;
+
+private:
+#ifdef _WIN32
+    HANDLE fileHandle;
+#else
+    int fileDescriptor;
+#endif
+};
+
+#ifdef _WIN32
+
+LockFile::LockFile(const std::string &filename)
+{
+    fileHandle = CreateFileA(filename.c_str(), GENERIC_READ | GENERIC_WRITE,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in LockFile::LockFile: Could not open file \""
+                + filename + "\".");
+        return;
+    }
+    OVERLAPPED overlapped = {};
+    if (!LockFileEx(fileHandle, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &overlapped)) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in LockFile::LockFile: Could not lock file \""
+                + filename + "\".");
+    }
+}
+
+LockFile::~LockFile()
+{
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        OVERLAPPED overlapped = {};
+        UnlockFileEx(fileHandle, 0, 1, 0, &overlapped);
+        CloseHandle(fileHandle);
+    }
+}
+
+static bool getFileStatus(const std::string &filename, uint64_t &size, uint64_t &modificationTime)
+{
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExA(filename.c_str(), GetFileExInfoStandard, &attributes)
+            || (attributes.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0) {
+        return false;
+    }
+    size = (uint64_t(attributes.nFileSizeHigh) << 32u) | uint64_t(attributes.nFileSizeLow);
+    modificationTime = (uint64_t(attributes.ftLastWriteTime.dwHighDateTime) << 32u)
+            | uint64_t(attributes.ftLastWriteTime.dwLowDateTime);
+    return true;
+}
+
+static bool renameFile(const std::string &oldFilename, const std::string &newFilename)
+{
+    return MoveFileExA(oldFilename.c_str(), newFilename.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+static uint32_t getProcessId()
+{
+    return uint32_t(GetCurrentProcessId());
+}
+
+#else
+
+LockFile::LockFile(const std::string &filename)
+{
+    fileDescriptor = ::open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fileDescriptor < 0) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in LockFile::LockFile: Could not open file \""
+                + filename + "\".");
+        return;
+    }
+    while (flock(fileDescriptor, LOCK_EX) != 0) {
+        if (errno != EINTR) {
+            sgl::Logfile::get()->writeError(std::string() + "Error in LockFile::LockFile: Could not lock file \""
+                    + filename + "\".");
+            break;
+        }
+    }
+}
+
+LockFile::~LockFile()
+{
+    if (fileDescriptor >= 0) {
+        flock(fileDescriptor, LOCK_UN);
+        ::close(fileDescriptor);
+    }
+}
+
+static bool getFileStatus(const std::string &filename, uint64_t &size, uint64_t &modificationTime)
+{
+    struct stat fileStatus;
+    if (stat(filename.c_str(), &fileStatus) != 0 || !S_ISREG(fileStatus.st_mode)) {
+        return false;
+    }
+    size = uint64_t(fileStatus.st_size);
+#ifdef __linux__
+    modificationTime = uint64_t(fileStatus.st_mtim.tv_sec) * 1000000000ull + uint64_t(fileStatus.st_mtim.tv_nsec);
+#else
+    modificationTime = uint64_t(fileStatus.st_mtime) * 1000000000ull;
+#endif
+    return true;
+}
+
+static bool renameFile(const std::string &oldFilename, const std::string &newFilename)
+{
+    return std::rename(oldFilename.c_str(), newFilename.c_str()) == 0;
+}
+
+static uint32_t getProcessId()
+{
+    return uint32_t(getpid());
+}
+
+#endif
+
+static uint64_t getCurrentTimeMicroseconds()
+{
+    return uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+static std::string toHexString(uint64_t value)
+{
+    char buffer[17];
+    snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long)value);
+    return buffer;
+}
+
+static std::string getByteSizeString(uint64_t numBytes)
+{
+    char buffer[32];
+    if (numBytes >= (uint64_t(1) << 30u)) {
+        snprintf(buffer, sizeof(buffer), "%.2f GiB", double(numBytes) / double(uint64_t(1) << 30u));
+    } else {
+        snprintf(buffer, sizeof(buffer), "%.2f MiB", double(numBytes) / double(uint64_t(1) << 20u));
+    }
+    return buffer;
+}
+
+
+ConversionCacheKey::ConversionCacheKey(const std::string &artifactType, const std::string &extension)
+        : artifactType(artifactType), extension(extension)
+{
+}
+
+void ConversionCacheKey::addSourceFile(const std::string &filename)
+{
+    sourceFilenames.push_back(filename);
+}
+
+void ConversionCacheKey::addParameter(const std::string &name, const std::string &value)
+{
+    parameterString += name + "=" + value + "\n";
+}
+
+void ConversionCacheKey::addParameter(const std::string &name, int value)
+{
+    addParameter(name, sgl::toString(value));
+}
+
+void ConversionCacheKey::addParameter(const std::string &name, float value)
+{
+    // Hexadecimal floating point notation: Exact, i.e., every change of the value results in a different key
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%a", double(value));
+    addParameter(name, std::string(buffer));
+}
+
+
+ConversionCache::ConversionCache(const std::string &cacheDirectory, uint64_t sizeBudgetBytes)
+        : cacheDirectory(cacheDirectory), sizeBudgetBytes(sizeBudgetBytes)
+{
+    if (!this->cacheDirectory.empty() && this->cacheDirectory.back() != '/' && this->cacheDirectory.back() != '\\') {
+        this->cacheDirectory += "/";
+    }
+    sgl::FileUtils::get()->ensureDirectoryExists(this->cacheDirectory);
+    manifestFilename = this->cacheDirectory + "manifest.txt";
+    manifestLockFilename = this->cacheDirectory + "manifest.lock";
+    conversionLockFilename = this->cacheDirectory + "conversion.lock";
+}
+
+ConversionCache *ConversionCache::get()
+{
+    static ConversionCache conversionCache("Data/ConversionCache/");
+    return &conversionCache;
+}
+
+void ConversionCache::setSizeBudget(uint64_t sizeBudgetBytes)
+{
+    this->sizeBudgetBytes = sizeBudgetBytes;
+    enforceSizeBudget();
+}
+
+
+bool ConversionCache::readManifest(Manifest &manifest)
+{
+    manifest = Manifest();
+    std::ifstream file(manifestFilename.c_str());
+    if (!file.is_open()) {
+        // No artifacts stored yet
+        return true;
+    }
+
+    std::string line;
+    if (!std::getline(file, line) || line != MANIFEST_HEADER) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in ConversionCache::readManifest: Invalid manifest \""
+                + manifestFilename + "\". Ignoring the stored artifacts.");
+        return false;
+    }
+
+    // Entries: "artifact <hash> <size> <last access> <conversion time> <file name>"
+    // and "source <hash> <size> <modification time> <file name>". The file name is the rest of the line.
+    while (std::getline(file, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        std::istringstream lineStream(line);
+        std::string entryType, hashString, filename;
+        lineStream >> entryType >> hashString;
+        if (entryType == "artifact") {
+            Artifact artifact;
+            lineStream >> artifact.size >> artifact.lastAccess >> artifact.conversionTimeMS;
+            lineStream.get();
+            std::getline(lineStream, artifact.filename);
+            if (lineStream.fail() || artifact.filename.empty()) {
+                continue;
+            }
+            manifest.artifacts[hashString] = artifact;
+        } else if (entryType == "source") {
+            SourceFile sourceFile;
+            lineStream >> sourceFile.size >> sourceFile.modificationTime;
+            lineStream.get();
+            std::getline(lineStream, filename);
+            if (lineStream.fail() || filename.empty()) {
+                continue;
+            }
+            sourceFile.hash = std::strtoull(hashString.c_str(), nullptr, 16);
+            manifest.sourceFiles[filename] = sourceFile;
+        }
+    }
+    return true;
+}
+
+bool ConversionCache::writeManifest(const Manifest &manifest)
+{
+    // Readers never see a partially written manifest
+    std::string temporaryFilename = manifestFilename + ".tmp";
+    {
+        std::ofstream file(temporaryFilename.c_str(), std::ofstream::trunc);
+        if (!file.is_open()) {
+            sgl::Logfile::get()->writeError(std::string() + "Error in ConversionCache::writeManifest: "
+                    + "Could not write file \"" + temporaryFilename + "\".");
+            return false;
+        }
+        file << MANIFEST_HEADER << "\n";
+        for (auto &entry : manifest.artifacts) {
+            const Artifact &artifact = entry.second;
+            file << "artifact " << entry.first << " " << artifact.size << " " << artifact.lastAccess << " "
+                    << artifact.conversionTimeMS << " " << artifact.filename << "\n";
+        }
+        for (auto &entry : manifest.sourceFiles) {
+            const SourceFile &sourceFile = entry.second;
+            file << "source " << toHexString(sourceFile.hash) << " " << sourceFile.size << " "
+                    << sourceFile.modificationTime << " " << entry.first << "\n";
+        }
+        if (!file.good()) {
+            return false;
+        }
+    }
+    if (!renameFile(temporaryFilename, manifestFilename)) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in ConversionCache::writeManifest: "
+                + "Could not replace file \"" + manifestFilename + "\".");
+        return false;
+    }
+    return true;
+}
+
+
+bool ConversionCache::computeArtifactHash(const ConversionCacheKey &key, uint64_t &artifactHash)
+{
+    std::vector<std::pair<std::string, SourceFile>> sourceFiles;
+    return computeArtifactHash(key, artifactHash, sourceFiles);
+}
+
+bool ConversionCache::computeArtifactHash(const ConversionCacheKey &key, uint64_t &artifactHash,
+        std::vector<std::pair<std::string, SourceFile>> &sourceFiles)
+{
+    sourceFiles.clear();
+    for (const std::string &filename : key.getSourceFilenames()) {
+        SourceFile sourceFile;
+        if (!getFileStatus(filename, sourceFile.size, sourceFile.modificationTime)) {
+            sgl::Logfile::get()->writeError(std::string() + "Error in ConversionCache::computeArtifactHash: "
+                    + "File \"" + filename + "\" not found.");
+            return false;
+        }
+        sourceFiles.push_back(std::make_pair(filename, sourceFile));
+    }
+
+    if (!sourceFiles.empty()) {
+        Manifest manifest;
+        {
+            LockFile manifestLock(manifestLockFilename);
+            readManifest(manifest);
+        }
+
+        // Only hash the content of files that changed since the hash was memoized
+        for (auto &entry : sourceFiles) {
+            SourceFile &sourceFile = entry.second;
+            auto it = manifest.sourceFiles.find(entry.first);
+            if (it != manifest.sourceFiles.end() && it->second.size == sourceFile.size
+                    && it->second.modificationTime == sourceFile.modificationTime) {
+                sourceFile.hash = it->second.hash;
+                continue;
+            }
+            if (sourceFile.size == 0) {
+                sourceFile.hash = XXHash64::hash(nullptr, 0);
+                continue;
+            }
+            MappedFile mappedFile;
+            if (!mappedFile.open(entry.first)) {
+                return false;
+            }
+            mappedFile.prefetch(0, mappedFile.getSize());
+            sourceFile.hash = XXHash64::hash(mappedFile.getData(), mappedFile.getSize());
+            sourceFile.size = mappedFile.getSize();
+        }
+    }
+
+    XXHash64 hash;
+    const std::string &artifactType = key.getArtifactType();
+    const std::string &extension = key.getExtension();
+    const std::string &parameterString = key.getParameterString();
+    hash.update(artifactType.c_str(), artifactType.size() + 1);
+    hash.update(extension.c_str(), extension.size() + 1);
+    hash.update(parameterString.c_str(), parameterString.size() + 1);
+    for (auto &entry : sourceFiles) {
+        hash.update(&entry.second.hash, sizeof(uint64_t));
+    }
+    artifactHash = hash.digest();
+    return true;
+}
+
+bool ConversionCache::lookupArtifact(const std::string &hashString, const std::string &artifactFilename,
+        const std::vector<std::pair<std::string, SourceFile>> &sourceFiles, Artifact &artifact)
+{
+    LockFile manifestLock(manifestLockFilename);
+    Manifest manifest;
+    readManifest(manifest);
+    for (auto &entry : sourceFiles) {
+        manifest.sourceFiles[entry.first] = entry.second;
+    }
+
+    uint64_t size = 0, modificationTime = 0;
+    bool exists = getFileStatus(cacheDirectory + artifactFilename, size, modificationTime) && size > 0;
+    if (exists) {
+        // Artifacts not in the manifest are complete as well (they are only renamed to their name when complete)
+        Artifact &manifestArtifact = manifest.artifacts[hashString];
+        manifestArtifact.filename = artifactFilename;
+        manifestArtifact.size = size;
+        manifestArtifact.lastAccess = getCurrentTimeMicroseconds();
+        artifact = manifestArtifact;
+    } else {
+        manifest.artifacts.erase(hashString);
+    }
+    writeManifest(manifest);
+    return exists;
+}
+
+std::string ConversionCache::getArtifact(const ConversionCacheKey &key, const ConversionFunction &convert)
+{
+    std::vector<std::pair<std::string, SourceFile>> sourceFiles;
+    uint64_t artifactHash = 0;
+    if (!computeArtifactHash(key, artifactHash, sourceFiles)) {
+        return "";
+    }
+    std::string hashString = toHexString(artifactHash);
+    std::string artifactFilename = key.getArtifactType() + "_" + hashString + key.getExtension();
+    std::string artifactPath = cacheDirectory + artifactFilename;
+
+    Artifact artifact;
+    bool isHit = lookupArtifact(hashString, artifactFilename, sourceFiles, artifact);
+    if (!isHit) {
+        LockFile conversionLock(conversionLockFilename);
+        // Another thread or process might have converted the artifact while we were waiting for the lock
+        isHit = lookupArtifact(hashString, artifactFilename, sourceFiles, artifact);
+        if (!isHit) {
+            static std::atomic<uint32_t> temporaryFileCounter(0);
+            std::string temporaryPath = cacheDirectory + "tmp_" + sgl::toString(getProcessId()) + "_"
+                    + sgl::toString(temporaryFileCounter++) + "_" + artifactFilename;
+            std::remove(temporaryPath.c_str());
+            sgl::Logfile::get()->writeInfo(std::string() + "Conversion cache miss: Creating \"" + artifactPath
+                    + "\"");
+
+            auto start = std::chrono::system_clock::now();
+            bool converted = convert(temporaryPath);
+            auto end = std::chrono::system_clock::now();
+            double conversionTimeMS = std::chrono::duration<double, std::milli>(end - start).count();
+
+            uint64_t size = 0, modificationTime = 0;
+            if (!converted || !getFileStatus(temporaryPath, size, modificationTime) || size == 0
+                    || !renameFile(temporaryPath, artifactPath)) {
+                sgl::Logfile::get()->writeError(std::string() + "Error in ConversionCache::getArtifact: "
+                        + "The conversion failed or didn't create the file \"" + artifactPath + "\".");
+                std::remove(temporaryPath.c_str());
+                std::lock_guard<std::mutex> lock(statisticsMutex);
+                statistics.numMisses++;
+                statistics.numFailedConversions++;
+                return "";
+            }
+
+            LockFile manifestLock(manifestLockFilename);
+            Manifest manifest;
+            readManifest(manifest);
+            Artifact &manifestArtifact = manifest.artifacts[hashString];
+            manifestArtifact.filename = artifactFilename;
+            manifestArtifact.size = size;
+            manifestArtifact.lastAccess = getCurrentTimeMicroseconds();
+            manifestArtifact.conversionTimeMS = conversionTimeMS;
+            for (auto &entry : sourceFiles) {
+                manifest.sourceFiles[entry.first] = entry.second;
+            }
+            evictArtifacts(manifest, hashString);
+            writeManifest(manifest);
+
+            std::lock_guard<std::mutex> lock(statisticsMutex);
+            statistics.numMisses++;
+            statistics.bytesWritten += size;
+            return artifactPath;
+        }
+    }
+
+    sgl::Logfile::get()->writeInfo(std::string() + "Conversion cache hit: Using \"" + artifactPath + "\"");
+    std::lock_guard<std::mutex> lock(statisticsMutex);
+    statistics.numHits++;
+    statistics.bytesSaved += artifact.size;
+    statistics.conversionTimeSavedMS += artifact.conversionTimeMS;
+    return artifactPath;
+}
+
+bool ConversionCache::updateArtifact(const std::string &artifactPath, const UpdateFunction &update)
+{
+    if (artifactPath.compare(0, cacheDirectory.size(), cacheDirectory) != 0) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in ConversionCache::updateArtifact: \""
+                + artifactPath + "\" is not in the cache directory.");
+        return false;
+    }
+    const std::string artifactFilename = artifactPath.substr(cacheDirectory.size());
+
+    LockFile conversionLock(conversionLockFilename);
+    uint64_t oldSize = 0, size = 0, modificationTime = 0;
+    if (!getFileStatus(artifactPath, oldSize, modificationTime)) {
+        // E.g. evicted by another process since it was returned by getArtifact
+        sgl::Logfile::get()->writeError(std::string() + "Error in ConversionCache::updateArtifact: The artifact \""
+                + artifactPath + "\" doesn't exist.");
+        return false;
+    }
+    bool updated = update(artifactPath);
+    if (!getFileStatus(artifactPath, size, modificationTime)) {
+        return false;
+    }
+
+    LockFile manifestLock(manifestLockFilename);
+    Manifest manifest;
+    readManifest(manifest);
+    for (auto &entry : manifest.artifacts) {
+        if (entry.second.filename == artifactFilename) {
+            entry.second.size = size;
+            entry.second.lastAccess = getCurrentTimeMicroseconds();
+            evictArtifacts(manifest, entry.first);
+            break;
+        }
+    }
+    writeManifest(manifest);
+
+    std::lock_guard<std::mutex> lock(statisticsMutex);
+    statistics.bytesWritten += size > oldSize ? size - oldSize : 0;
+    return updated;
+}
+
+void ConversionCache::evictArtifacts(Manifest &manifest, const std::string &keepArtifact)
+{
+    // Forget artifacts that were deleted externally
+    uint64_t totalSize = 0;
+    std::vector<std::pair<uint64_t, std::string>> artifactsByAccess;
+    for (auto it = manifest.artifacts.begin(); it != manifest.artifacts.end(); ) {
+        uint64_t size = 0, modificationTime = 0;
+        if (!getFileStatus(cacheDirectory + it->second.filename, size, modificationTime)) {
+            it = manifest.artifacts.erase(it);
+            continue;
+        }
+        it->second.size = size;
+        totalSize += size;
+        if (it->first != keepArtifact) {
+            artifactsByAccess.push_back(std::make_pair(it->second.lastAccess, it->first));
+        }
+        ++it;
+    }
+
+    std::sort(artifactsByAccess.begin(), artifactsByAccess.end());
+    size_t numEvictions = 0;
+    uint64_t bytesEvicted = 0;
+    for (auto &entry : artifactsByAccess) {
+        if (totalSize <= sizeBudgetBytes) {
+            break;
+        }
+        const Artifact &artifact = manifest.artifacts[entry.second];
+        std::string artifactPath = cacheDirectory + artifact.filename;
+        if (std::remove(artifactPath.c_str()) != 0) {
+            // E.g. still opened by another process on Windows
+            continue;
+        }
+        sgl::Logfile::get()->writeInfo(std::string() + "Conversion cache: Evicted \"" + artifactPath + "\" ("
+                + getByteSizeString(artifact.size) + ")");
+        totalSize -= artifact.size;
+        bytesEvicted += artifact.size;
+        numEvictions++;
+        manifest.artifacts.erase(entry.second);
+    }
+
+    std::lock_guard<std::mutex> lock(statisticsMutex);
+    statistics.numEvictions += numEvictions;
+    statistics.bytesEvicted += bytesEvicted;
+}
+
+void ConversionCache::enforceSizeBudget()
+{
+    LockFile manifestLock(manifestLockFilename);
+    Manifest manifest;
+    readManifest(manifest);
+    evictArtifacts(manifest, "");
+    writeManifest(manifest);
+}
+
+void ConversionCache::clear()
+{
+    LockFile conversionLock(conversionLockFilename);
+    LockFile manifestLock(manifestLockFilename);
+    Manifest manifest;
+    readManifest(manifest);
+    for (auto &entry : manifest.artifacts) {
+        std::string artifactPath = cacheDirectory + entry.second.filename;
+        std::remove(artifactPath.c_str());
+    }
+    manifest.artifacts.clear();
+    writeManifest(manifest);
+}
+
+uint64_t ConversionCache::getTotalSize()
+{
+    LockFile manifestLock(manifestLockFilename);
+    Manifest manifest;
+    readManifest(manifest);
+    uint64_t totalSize = 0;
+    for (auto &entry : manifest.artifacts) {
+        totalSize += entry.second.size;
+    }
+    return totalSize;
+}
+
+
+ConversionCacheStatistics ConversionCache::getStatistics()
+{
+    std::lock_guard<std::mutex> lock(statisticsMutex);
+    return statistics;
+}
+
+void ConversionCache::resetStatistics()
+{
+    std::lock_guard<std::mutex> lock(statisticsMutex);
+    statistics = ConversionCacheStatistics();
+}
+
+std::string ConversionCache::getStatisticsString()
+{
+    ConversionCacheStatistics statistics = getStatistics();
+    return std::string() + "Conversion cache: " + sgl::toString(statistics.numHits) + " hits, "
+            + sgl::toString(statistics.numMisses) + " misses (hit rate "
+            + sgl::toString(int(statistics.getHitRate() * 100.0 + 0.5)) + "%), "
+            + getByteSizeString(statistics.bytesSaved) + " and "
+            + sgl::toString(int(statistics.conversionTimeSavedMS + 0.5)) + "ms of conversions saved, "
+            + sgl::toString(statistics.numEvictions) + " evictions ("
+            + getByteSizeString(statistics.bytesEvicted) + ")";
+}
@@ -0,0 +1,174 @@
+#ifndef PIXELSYNCOIT_CONVERSIONCACHE_HPP
+#define PIXELSYNCOIT_CONVERSIONCACHE_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <functional>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Cache for the artifacts of the conversion steps (e.g. .binmesh files converted from trajectory files, .voxel grids).
+ * Each artifact is keyed on the hash of the content of its source files and of all parameters of the conversion, so
+ * an artifact is never reused after the source file or a parameter (line radius, grid resolution, ...) has changed.
+ * The artifacts are stored in a cache directory together with a manifest (manifest.txt), which records their size and
+ * last access. If the total size of the artifacts exceeds the size budget, the least recently used ones are evicted.
+ *
+ * Several threads and processes may use the same cache directory: Artifacts are written to a temporary file and
+ * renamed when they are complete, conversions are serialized by a lock file (so an artifact requested by two
+ * processes at the same time is only converted once), and the manifest is only modified while holding a second lock
+ * file. The content hash of each source file is memoized in the manifest together with its size and modification
+ * time, i.e., a cache hit only needs to hash the source files after they have changed.
+ */
+
+/// Identifies an artifact: The conversion, its source files and all of its parameters.
+class ConversionCacheKey
+{
+public:
+    /**
+     * @param artifactType Name of the conversion (e.g. "trajectories_triangle_mesh"). Used as the prefix of the file
+     * name of the artifact in the cache directory.
+     * @param extension Extension of the artifact file (e.g. ".binmesh").
+     */
+    ConversionCacheKey(const std::string &artifactType, const std::string &extension);
+
+    /// The content of the file is part of the key (see ConversionCache::getArtifact).
+    void addSourceFile(const std::string &filename);
+    void addParameter(const std::string &name, const std::string &value);
+    void addParameter(const std::string &name, int value);
+    /// Floating point parameters are compared bitwise.
+    void addParameter(const std::string &name, float value);
+
+    inline const std::string &getArtifactType() const { return artifactType; }
+    inline const std::string &getExtension() const { return extension; }
+    inline const std::vector<std::string> &getSourceFilenames() const { return sourceFilenames; }
+    /// All parameters in the order they were added (one "name=value" line per parameter).
+    inline const std::string &getParameterString() const { return parameterString; }
+
+private:
+    std::string artifactType;
+    std::string extension;
+    std::vector<std::string> sourceFilenames;
+    std::string parameterString;
+};
+
+struct ConversionCacheStatistics
+{
+    size_t numHits = 0;
+    size_t numMisses = 0;
+    size_t numFailedConversions = 0;
+    size_t numEvictions = 0;
+    /// Total size of the artifacts that were reused instead of being converted again.
+    uint64_t bytesSaved = 0;
+    uint64_t bytesWritten = 0;
+    uint64_t bytesEvicted = 0;
+    /// The conversion time of the reused artifacts (as measured when they were converted).
+    double conversionTimeSavedMS = 0.0;
+
+    inline double getHitRate() const {
+        return numHits + numMisses == 0 ? 0.0 : double(numHits) / double(numHits + numMisses);
+    }
+};
+
+const uint64_t DEFAULT_CONVERSION_CACHE_SIZE_BUDGET = uint64_t(32) << 30u; // 32 GiB
+
+class ConversionCache
+{
+public:
+    /// @param cacheDirectory Created if it doesn't exist yet. Should end with a slash.
+    explicit ConversionCache(const std::string &cacheDirectory,
+            uint64_t sizeBudgetBytes = DEFAULT_CONVERSION_CACHE_SIZE_BUDGET);
+
+    /// The cache used by the application (directory "Data/ConversionCache/").
+    static ConversionCache *get();
+
+    /// Writes the artifact to the passed (temporary) file name. @return False if the conversion failed.
+    typedef std::function<bool(const std::string &outputFilename)> ConversionFunction;
+
+    /**
+     * Looks up the artifact with the passed key. On a cache miss, the artifact is created by calling convert.
+     * The least recently used artifacts are evicted if the size budget is exceeded afterwards (never the returned one).
+     * @return The file name of the artifact in the cache directory, or an empty string if a source file doesn't exist
+     * or the conversion failed or didn't create the file.
+     */
+    std::string getArtifact(const ConversionCacheKey &key, const ConversionFunction &convert);
+
+    /// Modifies an artifact in the cache directory in place. @return False if the update failed.
+    typedef std::function<bool(const std::string &artifactFilename)> UpdateFunction;
+
+    /**
+     * Modifies an artifact returned by getArtifact in place (e.g. appends data the conversion didn't compute). The
+     * update is serialized with the conversions by the conversion lock file, such that no other thread or process
+     * converts or modifies an artifact at the same time. The size of the artifact is updated in the manifest.
+     * @return False if the artifact doesn't exist (anymore) or update returned false.
+     */
+    bool updateArtifact(const std::string &artifactPath, const UpdateFunction &update);
+
+    /**
+     * @param artifactHash The hash identifying the artifact (computed from the key and the content of its sources).
+     * @return False if a source file doesn't exist.
+     */
+    bool computeArtifactHash(const ConversionCacheKey &key, uint64_t &artifactHash);
+
+    /// Evicts the least recently used artifacts until their total size is at most the size budget.
+    void enforceSizeBudget();
+    /// Removes all artifacts (e.g. for benchmarking the conversions).
+    void clear();
+
+    void setSizeBudget(uint64_t sizeBudgetBytes);
+    inline uint64_t getSizeBudget() const { return sizeBudgetBytes; }
+    inline const std::string &getCacheDirectory() const { return cacheDirectory; }
+    /// @return The total size of the artifacts according to the manifest.
+    uint64_t getTotalSize();
+
+    ConversionCacheStatistics getStatistics();
+    void resetStatistics();
+    /// Hits, misses, hit rate, bytes and conversion time saved and evictions in one line (e.g. for the log file).
+    std::string getStatisticsString();
+
+private:
+    /// Manifest entry of an artifact.
+    struct Artifact
+    {
+        std::string filename; ///< Relative to the cache directory.
+        uint64_t size = 0;
+        uint64_t lastAccess = 0; ///< Microseconds since the epoch.
+        double conversionTimeMS = 0.0;
+    };
+    /// Memoized content hash of a source file.
+    struct SourceFile
+    {
+        uint64_t size = 0;
+        uint64_t modificationTime = 0;
+        uint64_t hash = 0;
+    };
+    struct Manifest
+    {
+        std::map<std::string, Artifact> artifacts; ///< Key: The artifact hash in hexadecimal notation.
+        std::map<std::string, SourceFile> sourceFiles; ///< Key: The file name as passed to the cache key.
+    };
+
+    bool readManifest(Manifest &manifest);
+    bool writeManifest(const Manifest &manifest);
+    /// Removes the least recently used artifacts (except for keepArtifact) until the size budget is met.
+    void evictArtifacts(Manifest &manifest, const std::string &keepArtifact);
+    bool computeArtifactHash(const ConversionCacheKey &key, uint64_t &artifactHash,
+            std::vector<std::pair<std::string, SourceFile>> &sourceFiles);
+    /// Looks up the artifact file and updates the manifest (last access, memoized source hashes).
+    bool lookupArtifact(const std::string &hashString, const std::string &artifactFilename,
+            const std::vector<std::pair<std::string, SourceFile>> &sourceFiles, Artifact &artifact);
+
+    std::string cacheDirectory;
+    std::string manifestFilename;
+    std::string manifestLockFilename;
+    std::string conversionLockFilename;
+    uint64_t sizeBudgetBytes;
+
+    std::mutex statisticsMutex;
+    ConversionCacheStatistics statistics;
+};
+
+#endif //PIXELSYNCOIT_CONVERSIONCACHE_HPP
@@ -236,7 +236,7 @@ void downscaleHairData(HairData &hairData, float scalingFactor)
     }
 }
 
-void convertHairDataToBinaryTriangleMesh(
+bool convertHairDataToBinaryTriangleMesh(
         const std::string &hairFilename,
         const std::string &binaryFilename)
 {
@@ -257,34 +257,22 @@ void convertHairDataToBinaryTriangleMesh(
 
     initializeCircleData(3, hairData.defaultThickness);
 
-    size_t numStrands = hairData.strands.size();
-    for (HairStrand &strand : hairData.strands) {
-        std::vector<glm::vec3> &pathLineCenters = strand.points;
-        std::vector<float> &pathLineThicknesses = strand.thicknesses;
-        std::vector<uint32_t> &pathLineColors = strand.colors;
-
-        // Create tube render data
-        std::vector<glm::vec3> localVertices;
-        std::vector<uint32_t> localColors;
-        std::vector<glm::vec3> localNormals;
-        std::vector<uint32_t> localIndices;
-        if (hairData.hasThicknessArray) {
-            sgl::Logfile::get()->writeError("Error in convertHairDataToBinaryTriangleMesh: Variable thickness not yet "
-                                            "supported.");
-        } else {
-            createTubeRenderData(pathLineCenters, pathLineColors, localVertices, localNormals, localColors, localIndices);
-        }
-        //createTubeRenderData(pathLineCenters, pathLineThicknesses, hairData.defaultThickness, pathLineColors,
-        //        localVertices, localColors, localIndices);
-        //createNormals(localVertices, localIndices, localNormals);
-
-        // Local -> global
-        for (size_t i = 0; i < localIndices.size(); i++) {
-            globalIndices.push_back(localIndices.at(i) + globalVertexPositions.size());
+    if (hairData.hasThicknessArray) {
+        sgl::Logfile::get()->writeError("Error in convertHairDataToBinaryTriangleMesh: Variable thickness not yet "
+                                        "supported.");
+    } else {
+        // Create the tube render data of all strands at once (in parallel)
+        std::vector<ArrayView<const glm::vec3>> strandsPoints;
+        std::vector<ArrayView<const uint32_t>> strandsColors;
+        strandsPoints.reserve(hairData.strands.size());
+        for (const HairStrand &strand : hairData.strands) {
+            strandsPoints.push_back(strand.points);
+            if (hairData.hasColorArray) {
+                strandsColors.push_back(strand.colors);
+            }
         }
-        globalVertexPositions.insert(globalVertexPositions.end(), localVertices.begin(), localVertices.end());
-        globalColors.insert(globalColors.end(), localColors.begin(), localColors.end());
-        globalNormals.insert(globalNormals.end(), localNormals.begin(), localNormals.end());
+        createTubeRenderData(strandsPoints, strandsColors, globalVertexPositions, globalNormals, globalColors,
+                globalIndices);
     }
 
 
@@ -333,5 +321,5 @@ void convertHairDataToBinaryTriangleMesh(
                               + sgl::toString(globalVertexPositions.size()) + " vertices, "
                               + sgl::toString(globalIndices.size()) + " indices.");
     sgl::Logfile::get()->writeInfo(std::string() + "Writing binary mesh...");
-    writeMesh3D(binaryFilename, binaryMesh);
+    return writeMesh3D(binaryFilename, binaryMesh);
 }
@@ -43,7 +43,8 @@ struct HairData {
  */
 void loadHairFile(const std::string &hairFilename, HairData &hairData);
 
-void convertHairDataToBinaryTriangleMesh(
+/// @return False if the binary file couldn't be written.
+bool convertHairDataToBinaryTriangleMesh(
         const std::string &hairFilename,
         const std::string &binaryFilename);
 
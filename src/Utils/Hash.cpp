@@ -0,0 +1,148 @@
+#include <cstring>
+#include "Hash.hpp"
+
+static const uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+static const uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t rotl64(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t read64(const uint8_t *ptr)
+{
+    uint64_t value;
+    memcpy(&value, ptr, sizeof(uint64_t));
+    return value;
+}
+
+static inline uint32_t read32(const uint8_t *ptr)
+{
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(uint32_t));
+    return value;
+}
+
+static inline uint64_t xxh64Round(uint64_t acc, uint64_t input)
+{
+    acc += input * PRIME64_2;
+    acc = rotl64(acc, 31);
+    acc *= PRIME64_1;
+    return acc;
+}
+
+static inline uint64_t xxh64MergeRound(uint64_t acc, uint64_t val)
+{
+    val = xxh64Round(0, val);
+    acc ^= val;
+    acc = acc * PRIME64_1 + PRIME64_4;
+    return acc;
+}
+
+XXHash64::XXHash64(uint64_t seed)
+{
+    reset(seed);
+}
+
+void XXHash64::reset(uint64_t seed)
+{
+    this->seed = seed;
+    totalLength = 0;
+    bufferSize = 0;
+    v1 = seed + PRIME64_1 + PRIME64_2;
+    v2 = seed + PRIME64_2;
+    v3 = seed;
+    v4 = seed - PRIME64_1;
+}
+
+void XXHash64::update(const void *data, size_t size)
+{
+    const uint8_t *ptr = (const uint8_t*)data;
+    const uint8_t *end = ptr + size;
+    totalLength += size;
+
+    // Not enough data for a full stripe: Just buffer the input
+    if (bufferSize + size < 32) {
+        memcpy(buffer + bufferSize, ptr, size);
+        bufferSize += (uint32_t)size;
+        return;
+    }
+
+    // Complete the buffered stripe first
+    if (bufferSize > 0) {
+        size_t numBytesToFill = 32 - bufferSize;
+        memcpy(buffer + bufferSize, ptr, numBytesToFill);
+        v1 = xxh64Round(v1, read64(buffer));
+        v2 = xxh64Round(v2, read64(buffer + 8));
+        v3 = xxh64Round(v3, read64(buffer + 16));
+        v4 = xxh64Round(v4, read64(buffer + 24));
+        ptr += numBytesToFill;
+        bufferSize = 0;
+    }
+
+    // Process all full stripes directly from the input
+    while (ptr + 32 <= end) {
+        v1 = xxh64Round(v1, read64(ptr));
+        v2 = xxh64Round(v2, read64(ptr + 8));
+        v3 = xxh64Round(v3, read64(ptr + 16));
+        v4 = xxh64Round(v4, read64(ptr + 24));
+        ptr += 32;
+    }
+
+    if (ptr < end) {
+        bufferSize = (uint32_t)(end - ptr);
+        memcpy(buffer, ptr, bufferSize);
+    }
+}
+
+uint64_t XXHash64::digest() const
+{
+    uint64_t h;
+    if (totalLength >= 32) {
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = xxh64MergeRound(h, v1);
+        h = xxh64MergeRound(h, v2);
+        h = xxh64MergeRound(h, v3);
+        h = xxh64MergeRound(h, v4);
+    } else {
+        h = seed + PRIME64_5;
+    }
+    h += totalLength;
+
+    // Process the remaining bytes in the stripe buffer
+    const uint8_t *ptr = buffer;
+    const uint8_t *end = buffer + bufferSize;
+    while (ptr + 8 <= end) {
+        h ^= xxh64Round(0, read64(ptr));
+        h = rotl64(h, 27) * PRIME64_1 + PRIME64_4;
+        ptr += 8;
+    }
+    if (ptr + 4 <= end) {
+        h ^= (uint64_t)read32(ptr) * PRIME64_1;
+        h = rotl64(h, 23) * PRIME64_2 + PRIME64_3;
+        ptr += 4;
+    }
+    while (ptr < end) {
+        h ^= (*ptr) * PRIME64_5;
+        h = rotl64(h, 11) * PRIME64_1;
+        ptr++;
+    }
+
+    // Final avalanche
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t XXHash64::hash(const void *data, size_t size, uint64_t seed)
+{
+    XXHash64 hasher(seed);
+    hasher.update(data, size);
+    return hasher.digest();
+}
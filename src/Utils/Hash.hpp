@@ -0,0 +1,30 @@
+#ifndef PIXELSYNCOIT_HASH_HPP
+#define PIXELSYNCOIT_HASH_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Streaming implementation of the 64-bit xxHash algorithm (XXH64), cf. https://github.com/Cyan4973/xxHash.
+ * It processes data at memory bandwidth and is used e.g. for the per-section checksums of .binmesh files.
+ */
+class XXHash64
+{
+public:
+    explicit XXHash64(uint64_t seed = 0);
+    void reset(uint64_t seed = 0);
+    void update(const void *data, size_t size);
+    uint64_t digest() const;
+
+    /// Convenience function hashing a single contiguous buffer.
+    static uint64_t hash(const void *data, size_t size, uint64_t seed = 0);
+
+private:
+    uint64_t totalLength;
+    uint64_t seed;
+    uint64_t v1, v2, v3, v4;
+    uint8_t buffer[32];
+    uint32_t bufferSize;
+};
+
+#endif //PIXELSYNCOIT_HASH_HPP
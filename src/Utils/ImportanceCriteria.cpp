@@ -2,26 +2,19 @@
 // Created by christoph on 28.02.19.
 //
 
+#include <algorithm>
 #include <Math/Math.hpp>
+#include <Utils/File/Logfile.hpp>
+#include <Utils/Convert.hpp>
+#include "TrajectorySet.hpp"
+#include "Unorm16.hpp"
 #include "ImportanceCriteria.hpp"
 
 /// https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/packUnorm.xhtml
 void packUnorm16Array(const std::vector<float> &floatVector, std::vector<uint16_t> &unormVector)
 {
-    float minValue = FLT_MAX;
-    float maxValue = -FLT_MAX;
-    #pragma omp parallel for reduction(min:minValue) reduction(max:maxValue)
-    for (size_t i = 0; i < floatVector.size(); i++) {
-        minValue = std::min(minValue, floatVector.at(i));
-        maxValue = std::max(maxValue, floatVector.at(i));
-    }
-
     unormVector.resize(floatVector.size());
-    #pragma omp parallel for
-    for (size_t i = 0; i < unormVector.size(); i++) {
-        unormVector.at(i) = glm::round(glm::clamp((floatVector.at(i) - minValue) / (maxValue - minValue),
-                                                  0.0f, 1.0f) * 65535.0f);
-    }
+    packUnorm16(floatVector.data(), floatVector.size(), unormVector.data(), UNORM16_ROUND_NEAREST);
 }
 
 /// https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/packUnorm.xhtml
@@ -37,13 +30,10 @@ void packUnorm16ArrayOfArrays(
 
 
 /// https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/unpackUnorm.xhtml
-void unpackUnorm16Array(uint16_t *unormVector, size_t vectorSize, std::vector<float> &floatVector)
+void unpackUnorm16Array(const uint16_t *unormVector, size_t vectorSize, std::vector<float> &floatVector)
 {
     floatVector.resize(vectorSize);
-    #pragma omp parallel for
-    for (size_t i = 0; i < vectorSize; i++) {
-        floatVector.at(i) = unormVector[i]/65535.0;
-    }
+    unpackUnorm16(unormVector, vectorSize, floatVector.data());
 }
 
 
@@ -74,11 +64,15 @@ std::vector<float> computeSegmentLengths(std::vector<glm::vec3> &vertexPositions
     return segmentLengths;
 }
 
-std::vector<float> computeCurvature(std::vector<glm::vec3> &vertexPositions)
+void computeCurvature(const glm::vec3 *vertexPositions, size_t numVertices, float *curvatures)
 {
-    int n = (int)vertexPositions.size();
-    std::vector<float> curvatures;
-    curvatures.reserve(n);
+    int n = (int)numVertices;
+    if (n < 2) {
+        for (int i = 0; i < n; i++) {
+            curvatures[i] = 0.0f;
+        }
+        return;
+    }
 
     glm::vec3 tangent, lastTangent = glm::vec3(1.0f, 0.0f, 0.0f);
 
@@ -87,17 +81,17 @@ std::vector<float> computeCurvature(std::vector<glm::vec3> &vertexPositions)
 
         if (i == 0) {
             // First node
-            tangent = vertexPositions.at(i+1) - vertexPositions.at(i);
+            tangent = vertexPositions[i+1] - vertexPositions[i];
         } else if (i == n-1) {
             // Last node
-            tangent = vertexPositions.at(i) - vertexPositions.at(i-1);
+            tangent = vertexPositions[i] - vertexPositions[i-1];
         } else {
             // Node with two neighbors
-            tangent = vertexPositions.at(i+1) - vertexPositions.at(i);
+            tangent = vertexPositions[i+1] - vertexPositions[i];
         }
         if (glm::length(tangent) < 1E-08f) {
             // In case the two vertices are almost identical, just skip this path line segment
-            curvatures.push_back(0.0f);
+            curvatures[i] = 0.0f;
             continue;
         }
 
@@ -111,126 +105,15 @@ std::vector<float> computeCurvature(std::vector<glm::vec3> &vertexPositions)
         }
 
         lastTangent = tangent;
-        curvatures.push_back(curvatureAngle);
+        curvatures[i] = curvatureAngle;
     }
-
-    return curvatures;
 }
 
-std::vector<float> computeSegmentAttributeDifference(
-        std::vector<glm::vec3> &vertexPositions,
-        std::vector<float> &vertexAttributes)
-{
-    int n = (int)vertexPositions.size();
-    std::vector<float> segmentAttributeDifferences;
-    segmentAttributeDifferences.reserve(n);
-
-    for (int i = 0; i < n; i++) {
-        float segmentAttributeDifference = 0.0f;
-
-        if (i == 0) {
-            // First node
-            segmentAttributeDifference = vertexAttributes.at(i+1) - vertexAttributes.at(i);
-        } else if (i == n-1) {
-            // Last node
-            segmentAttributeDifference = vertexAttributes.at(i) - vertexAttributes.at(i-1);
-        } else {
-            // Node with two neighbors
-            segmentAttributeDifference = vertexAttributes.at(i+1) - vertexAttributes.at(i);
-        }
-
-        segmentAttributeDifferences.push_back(std::abs(segmentAttributeDifference));
-    }
-
-    return segmentAttributeDifferences;
-}
-
-std::vector<float> computeTotalAttributeDifference(
-        std::vector<glm::vec3> &vertexPositions,
-        std::vector<float> &vertexAttributes)
-{
-    int n = (int)vertexPositions.size();
-    std::vector<float> segmentAttributeDifferences;
-    segmentAttributeDifferences.reserve(n);
-
-    float minAttribute = FLT_MAX;
-    float maxAttribute = -FLT_MAX;
-    #pragma omp parallel for reduction(min:minAttribute) reduction(max:maxAttribute)
-    for (int i = 0; i < n; i++) {
-        minAttribute = std::min(minAttribute, vertexAttributes.at(i));
-        maxAttribute = std::max(maxAttribute, vertexAttributes.at(i));
-    }
-
-    float totalPressureDifference = maxAttribute - minAttribute;
-    for (int i = 0; i < n; i++) {
-        segmentAttributeDifferences.push_back(totalPressureDifference);
-    }
-
-    return segmentAttributeDifferences;
-}
-
-std::vector<float> computeAngleOfAscent(std::vector<glm::vec3> &vertexPositions)
-{
-    int n = (int)vertexPositions.size();
-    std::vector<float> angleOfAscentArray;
-    angleOfAscentArray.reserve(n);
-    glm::vec3 tangent;
-    const glm::vec3 angleUp(0.0f, 1.0f, 0.0f);
-
-    for (int i = 0; i < n; i++) {
-        // Angle between line segment and xz-plane
-        float angleOfAscent = 0.0f;
-
-        if (i == 0) {
-            // First node
-            tangent = vertexPositions.at(i+1) - vertexPositions.at(i);
-        } else if (i == n-1) {
-            // Last node
-            tangent = vertexPositions.at(i) - vertexPositions.at(i-1);
-        } else {
-            // Node with two neighbors
-            tangent = vertexPositions.at(i+1) - vertexPositions.at(i);
-        }
-        if (glm::length(tangent) < 0.0001f) {
-            // In case the two vertices are almost identical, just skip this path line segment
-            angleOfAscentArray.push_back(0.0f);
-            continue;
-        }
-
-        tangent = glm::normalize(tangent);
-        float cosAngle = glm::clamp(glm::dot(tangent, angleUp), 0.0f, 1.0f);
-        angleOfAscent = 1.0f - glm::acos(cosAngle) / sgl::PI;
-
-        angleOfAscentArray.push_back(angleOfAscent);
-    }
-
-    return angleOfAscentArray;
-}
-
-std::vector<float> computeSegmentHeightDifference(std::vector<glm::vec3> &vertexPositions)
+std::vector<float> computeCurvature(std::vector<glm::vec3> &vertexPositions)
 {
-    int n = (int)vertexPositions.size();
-    std::vector<float> computeSegmentHeightDifferences;
-    computeSegmentHeightDifferences.reserve(n);
-
-    for (int i = 0; i < n; i++) {
-        float segmentHeightDifference = 0.0f;
-
-        if (i == 0) {
-            // First node
-            segmentHeightDifference = vertexPositions.at(i+1).y - vertexPositions.at(i).y;
-        } else if (i == n-1) {
-            // Last node
-            segmentHeightDifference = vertexPositions.at(i).y - vertexPositions.at(i-1).y;
-        } else {
-            // Node with two neighbors
-            segmentHeightDifference = vertexPositions.at(i+1).y - vertexPositions.at(i).y;
-        }
-
-        computeSegmentHeightDifferences.push_back(segmentHeightDifference);
-    }
-
-    return computeSegmentHeightDifferences;
+    std::vector<float> curvatures(vertexPositions.size());
+    computeCurvature(vertexPositions.data(), vertexPositions.size(), curvatures.data());
+    return curvatures;
 }
 
 
@@ -289,3 +172,226 @@ void computeTrajectoryAttributes(
         //        importanceCriteria.push_back(computeSegmentLengths(vertexPositions));
     }
 }
+
+const std::vector<ImportanceCriterionKernel> &getImportanceCriterionKernels(TrajectoryType trajectoryType)
+{
+    // Same order as the display names of the importance criteria of the trajectory types.
+    static const std::vector<ImportanceCriterionKernel> aneurysmKernels = {
+            IMPORTANCE_CRITERION_KERNEL_ATTRIBUTE, IMPORTANCE_CRITERION_KERNEL_CURVATURE
+    };
+    static const std::vector<ImportanceCriterionKernel> wcbKernels = {
+            IMPORTANCE_CRITERION_KERNEL_ATTRIBUTE, IMPORTANCE_CRITERION_KERNEL_CURVATURE
+    };
+    static const std::vector<ImportanceCriterionKernel> convectionRollsKernels = {
+            IMPORTANCE_CRITERION_KERNEL_ATTRIBUTE, IMPORTANCE_CRITERION_KERNEL_CURVATURE,
+            IMPORTANCE_CRITERION_KERNEL_SEGMENT_LENGTH
+    };
+    // The velocity magnitude of the CFD stream lines is the distance covered per (constant) integration step.
+    static const std::vector<ImportanceCriterionKernel> cfdKernels = {
+            IMPORTANCE_CRITERION_KERNEL_ATTRIBUTE, IMPORTANCE_CRITERION_KERNEL_SEGMENT_LENGTH
+    };
+    static const std::vector<ImportanceCriterionKernel> noKernels;
+
+    if (trajectoryType == TRAJECTORY_TYPE_ANEURYSM) {
+        return aneurysmKernels;
+    } else if (trajectoryType == TRAJECTORY_TYPE_WCB) {
+        return wcbKernels;
+    } else if (trajectoryType == TRAJECTORY_TYPE_CONVECTION_ROLLS
+            || trajectoryType == TRAJECTORY_TYPE_CONVECTION_ROLLS_NEW || trajectoryType == TRAJECTORY_TYPE_RINGS
+            || trajectoryType == TRAJECTORY_TYPE_UCLA) {
+        return convectionRollsKernels;
+    } else if (trajectoryType == TRAJECTORY_TYPE_CFD) {
+        return cfdKernels;
+    }
+    return noKernels;
+}
+
+std::vector<int> getDefaultImportanceCriteria(TrajectoryType trajectoryType)
+{
+    std::vector<int> importanceCriteria;
+    if (getNumImportanceCriteria(trajectoryType) > 0) {
+        importanceCriteria.push_back(0);
+    }
+    return importanceCriteria;
+}
+
+
+// The kernels below process one line each. The tangent of a point is the segment to the next point (the segment to
+// the previous point for the last point), i.e., the values of segment min(i, n-2) are stored at point i.
+
+static void computeSegmentLengthKernel(const glm::vec3 *positions, size_t n, float *values)
+{
+    #pragma omp simd
+    for (size_t i = 0; i < n - 1; i++) {
+        values[i] = glm::length(positions[i+1] - positions[i]);
+    }
+    values[n-1] = values[n-2];
+}
+
+static void computeCurvatureKernel(
+        const glm::vec3 *positions, size_t n, float *values, std::vector<glm::vec3> &tangents)
+{
+    tangents.resize(n - 1);
+    glm::vec3 *tangentData = tangents.data();
+    bool hasDegenerateSegments = false;
+    #pragma omp simd reduction(||:hasDegenerateSegments)
+    for (size_t i = 0; i < n - 1; i++) {
+        glm::vec3 tangent = positions[i+1] - positions[i];
+        hasDegenerateSegments = hasDegenerateSegments || glm::length(tangent) < 1E-08f;
+        tangentData[i] = glm::normalize(tangent);
+    }
+    if (hasDegenerateSegments) {
+        // Degenerate segments are skipped, i.e., the angle is computed to the last non-degenerate segment.
+        computeCurvature(positions, n, values);
+        return;
+    }
+
+    values[0] = 0.0f;
+    #pragma omp simd
+    for (size_t i = 1; i < n - 1; i++) {
+        float cosAngle = glm::clamp(glm::dot(tangentData[i], tangentData[i-1]), 0.0f, 1.0f);
+        values[i] = glm::acos(cosAngle) / sgl::PI;
+    }
+    values[n-1] = 0.0f;
+}
+
+void computeImportanceCriterion(
+        ImportanceCriterionKernel kernel, const TrajectorySet &trajectories, float *values)
+{
+    if (kernel == IMPORTANCE_CRITERION_KERNEL_ATTRIBUTE) {
+        if (trajectories.getNumAttributes() > 0) {
+            std::copy(trajectories.attributes.front().begin(), trajectories.attributes.front().end(), values);
+        } else {
+            std::fill(values, values + trajectories.getNumPoints(), 0.0f);
+        }
+        return;
+    }
+    const glm::vec3 *positions = trajectories.positions.data();
+    const size_t *lineOffsets = trajectories.lineOffsets.data();
+    const size_t numLines = trajectories.getNumTrajectories();
+    #pragma omp parallel
+    {
+        std::vector<glm::vec3> tangents;
+        #pragma omp for schedule(dynamic, 256)
+        for (size_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+            const size_t offset = lineOffsets[lineIdx];
+            const size_t n = lineOffsets[lineIdx + 1] - offset;
+            float *lineValues = values + offset;
+            if (n < 2) {
+                // No segment
+                std::fill(lineValues, lineValues + n, 0.0f);
+                continue;
+            }
+
+            if (kernel == IMPORTANCE_CRITERION_KERNEL_CURVATURE) {
+                computeCurvatureKernel(positions + offset, n, lineValues, tangents);
+            } else if (kernel == IMPORTANCE_CRITERION_KERNEL_SEGMENT_LENGTH) {
+                computeSegmentLengthKernel(positions + offset, n, lineValues);
+            }
+        }
+    }
+}
+
+ImportanceCriterionRegistry::ImportanceCriterionRegistry(
+        TrajectoryType trajectoryType, const TrajectorySet &trajectories)
+        : trajectories(trajectories), kernels(getImportanceCriterionKernels(trajectoryType))
+{
+    criteria.resize(kernels.size());
+    computed.resize(kernels.size(), false);
+}
+
+bool ImportanceCriterionRegistry::isComputed(int criterionIndex)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return criterionIndex >= 0 && criterionIndex < getNumCriteria() && computed.at(criterionIndex);
+}
+
+size_t ImportanceCriterionRegistry::getNumComputations()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return numComputations;
+}
+
+bool ImportanceCriterionRegistry::computeCriterion(int criterionIndex)
+{
+    if (criterionIndex < 0 || criterionIndex >= getNumCriteria()) {
+        sgl::Logfile::get()->writeError(
+                "Error in ImportanceCriterionRegistry::computeCriterion: Invalid importance criterion index "
+                + sgl::toString(criterionIndex) + ".");
+        return false;
+    }
+    if (!computed.at(criterionIndex)) {
+        std::vector<float> &values = criteria.at(criterionIndex);
+        values.resize(trajectories.getNumPoints());
+        computeImportanceCriterion(kernels.at(criterionIndex), trajectories, values.data());
+        computed.at(criterionIndex) = true;
+        numComputations++;
+    }
+    return true;
+}
+
+const std::vector<float> *ImportanceCriterionRegistry::getCriterion(int criterionIndex)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!computeCriterion(criterionIndex)) {
+        return nullptr;
+    }
+    return &criteria.at(criterionIndex);
+}
+
+bool ImportanceCriterionRegistry::takeCriterion(int criterionIndex, std::vector<float> &values)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!computeCriterion(criterionIndex)) {
+        return false;
+    }
+    values = std::move(criteria.at(criterionIndex));
+    criteria.at(criterionIndex) = std::vector<float>();
+    computed.at(criterionIndex) = false;
+    return true;
+}
+
+void ImportanceCriterionRegistry::releaseCriterion(int criterionIndex)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (criterionIndex >= 0 && criterionIndex < getNumCriteria()) {
+        criteria.at(criterionIndex) = std::vector<float>();
+        computed.at(criterionIndex) = false;
+    }
+}
+
+
+void computeTrajectoryAttributes(TrajectoryType trajectoryType, TrajectorySet &trajectories)
+{
+    computeTrajectoryAttributes(trajectoryType, trajectories, getDefaultImportanceCriteria(trajectoryType));
+}
+
+bool computeTrajectoryAttributes(
+        TrajectoryType trajectoryType, TrajectorySet &trajectories, const std::vector<int> &importanceCriteria)
+{
+    // The attribute read from the file is needed until all criteria are computed.
+    ImportanceCriterionRegistry registry(trajectoryType, trajectories);
+    std::vector<std::vector<float>> attributes(importanceCriteria.size());
+    bool success = true;
+    for (size_t i = 0; i < importanceCriteria.size(); i++) {
+        int criterionIndex = importanceCriteria.at(i);
+        bool isRequestedAgain = std::find(importanceCriteria.begin() + i + 1, importanceCriteria.end(),
+                criterionIndex) != importanceCriteria.end();
+        bool isValid;
+        if (isRequestedAgain) {
+            const std::vector<float> *values = registry.getCriterion(criterionIndex);
+            isValid = values != nullptr;
+            if (isValid) {
+                attributes.at(i) = *values;
+            }
+        } else {
+            isValid = registry.takeCriterion(criterionIndex, attributes.at(i));
+        }
+        if (!isValid) {
+            attributes.at(i).resize(trajectories.getNumPoints(), 0.0f);
+            success = false;
+        }
+    }
+    trajectories.attributes = std::move(attributes);
+    return success;
+}
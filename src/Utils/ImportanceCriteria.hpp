@@ -6,8 +6,13 @@
 #define PIXELSYNCOIT_IMPORTANCECRITERIA_HPP
 
 #include <vector>
+#include <mutex>
 #include <glm/glm.hpp>
 
+#include "ArrayView.hpp"
+
+struct TrajectorySet;
+
 enum TrajectoryType {
     TRAJECTORY_TYPE_ANEURYSM = 0, TRAJECTORY_TYPE_WCB, TRAJECTORY_TYPE_CONVECTION_ROLLS, TRAJECTORY_TYPE_RINGS,
     TRAJECTORY_TYPE_CONVECTION_ROLLS_NEW, TRAJECTORY_TYPE_CFD, TRAJECTORY_TYPE_UCLA
@@ -67,7 +72,7 @@ void packUnorm16ArrayOfArrays(
         std::vector<std::vector<uint16_t>> &unormVector);
 
 /// https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/unpackUnorm.xhtml
-void unpackUnorm16Array(uint16_t *unormVector, size_t vectorSize, std::vector<float> &floatVector);
+void unpackUnorm16Array(const uint16_t *unormVector, size_t vectorSize, std::vector<float> &floatVector);
 
 void computeTrajectoryAttributes(
         TrajectoryType trajectoryType,
@@ -75,4 +80,95 @@ void computeTrajectoryAttributes(
         std::vector<float> &vertexAttributes,
         std::vector<std::vector<float>> &importanceCriteria);
 
+/// Per-line implementations of the curvature and segment length criteria (see computeImportanceCriterion).
+std::vector<float> computeCurvature(std::vector<glm::vec3> &vertexPositions);
+std::vector<float> computeSegmentLengths(std::vector<glm::vec3> &vertexPositions);
+
+/**
+ * Same as above for all lines of a trajectory set at once, but only with the default importance criteria (see
+ * getDefaultImportanceCriteria), i.e., all other criteria are computed on request.
+ * On input, the first attribute of the set needs to contain the per-point attribute read from the file. On output,
+ * the attributes of the set are the importance criteria.
+ */
+void computeTrajectoryAttributes(TrajectoryType trajectoryType, TrajectorySet &trajectories);
+
+/**
+ * Same as above, but with the passed importance criteria (indices into getImportanceCriterionKernels). On output,
+ * attribute i of the set is the importance criterion importanceCriteria[i]. Only these criteria are computed.
+ * The criteria are cached in an ImportanceCriterionRegistry for the duration of the call only, i.e., a criterion
+ * requested twice is computed once. As the attribute read from the file is replaced, the set can't be passed again.
+ * @return False if an index is not a valid importance criterion of the trajectory type.
+ */
+bool computeTrajectoryAttributes(
+        TrajectoryType trajectoryType, TrajectorySet &trajectories, const std::vector<int> &importanceCriteria);
+
+
+/// The kernels computing the importance criteria of all points of a trajectory set.
+enum ImportanceCriterionKernel {
+    IMPORTANCE_CRITERION_KERNEL_ATTRIBUTE = 0, // The attribute read from the file (e.g. vorticity or pressure)
+    IMPORTANCE_CRITERION_KERNEL_CURVATURE, // Angle between neighboring segments divided by pi
+    IMPORTANCE_CRITERION_KERNEL_SEGMENT_LENGTH
+};
+const char *const IMPORTANCE_CRITERION_KERNEL_NAMES[] = {
+        "attribute", "curvature", "segment_length"
+};
+const int NUM_IMPORTANCE_CRITERION_KERNELS = int(IMPORTANCE_CRITERION_KERNEL_SEGMENT_LENGTH) + 1;
+
+/**
+ * The registry of the importance criteria of each trajectory type: Entry i is the kernel computing the importance
+ * criterion i (i.e., the enum entries above and the attribute "vertexAttribute<i>" of the converted meshes).
+ */
+const std::vector<ImportanceCriterionKernel> &getImportanceCriterionKernels(TrajectoryType trajectoryType);
+inline int getNumImportanceCriteria(TrajectoryType trajectoryType) {
+    return int(getImportanceCriterionKernels(trajectoryType).size());
+}
+/// The criteria computed when loading a trajectory file: Only the attribute read from the file (if any).
+std::vector<int> getDefaultImportanceCriteria(TrajectoryType trajectoryType);
+
+/**
+ * Computes an importance criterion for all points of a trajectory set. The lines are processed in parallel, and the
+ * points of each line in vectorizable loops over the flat arrays of the set.
+ * @param trajectories The first attribute needs to contain the attribute read from the file (if the kernel uses it).
+ * @param values Output array with space for all points of the set.
+ */
+void computeImportanceCriterion(
+        ImportanceCriterionKernel kernel, const TrajectorySet &trajectories, float *values);
+
+/**
+ * Computes the importance criteria of a trajectory set on their first request and keeps them in memory afterwards,
+ * such that only the criteria that are actually displayed or converted are computed.
+ * Thread-safe; the trajectory set needs to stay unchanged while the registry is in use.
+ */
+class ImportanceCriterionRegistry
+{
+public:
+    /// @param trajectories The first attribute needs to contain the attribute read from the file.
+    ImportanceCriterionRegistry(TrajectoryType trajectoryType, const TrajectorySet &trajectories);
+
+    inline int getNumCriteria() const { return int(kernels.size()); }
+    bool isComputed(int criterionIndex);
+    /// @return The number of kernel invocations so far (i.e., of cache misses).
+    size_t getNumComputations();
+
+    /**
+     * @return The values of the importance criterion for all points of the set, or nullptr if the index is invalid.
+     * The pointer stays valid until releaseCriterion is called for the criterion.
+     */
+    const std::vector<float> *getCriterion(int criterionIndex);
+    /// Moves the values out of the registry (computing them if necessary). @return False if the index is invalid.
+    bool takeCriterion(int criterionIndex, std::vector<float> &values);
+    /// Frees the memory of the criterion. It is computed again on its next request.
+    void releaseCriterion(int criterionIndex);
+
+private:
+    bool computeCriterion(int criterionIndex);
+
+    const TrajectorySet &trajectories;
+    std::vector<ImportanceCriterionKernel> kernels;
+    std::vector<std::vector<float>> criteria;
+    std::vector<bool> computed;
+    size_t numComputations = 0;
+    std::mutex mutex;
+};
+
 #endif //PIXELSYNCOIT_IMPORTANCECRITERIA_HPP
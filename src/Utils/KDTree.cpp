@@ -2,6 +2,15 @@
 // Created by christoph on 28.08.18.
 //
 
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "ParallelAlgorithms.hpp"
 #include "KDTree.hpp"
 
 bool Rectangle::contains(const glm::vec3 &pt) const
@@ -12,87 +21,304 @@ bool Rectangle::contains(const glm::vec3 &pt) const
     return false;
 }
 
-void KDTree::build(const std::vector<Point*> &points)
+
+/// A subtree on the traversal stack (the depth determines the splitting axis).
+struct KDTraversalEntry
+{
+    size_t begin, end;
+    int depth;
+    /// Lower bound of the squared distance of the query point to the points in the subtree.
+    float minDistanceSquared;
+};
+
+/// Two entries per level suffice for the depth-first traversal (depth <= log2(#points) + 1).
+const int KD_TRAVERSAL_STACK_SIZE = 2 * 64 + 2;
+
+static inline float distanceSquared(const glm::vec3 &a, const glm::vec3 &b)
 {
-    root = _build(points, 0);
+    glm::vec3 diff = a - b;
+    return glm::dot(diff, diff);
 }
 
-std::shared_ptr<KDNode> KDTree::_build(std::vector<Point*> points, int depth)
+
+void KDTree::build(const std::vector<glm::vec3> &inputPoints)
 {
-    const int k = 3; // Number of dimensions
+    points.resize(inputPoints.size());
+    #pragma omp parallel for
+    for (size_t i = 0; i < inputPoints.size(); i++) {
+        points[i] = Point(inputPoints[i], int(i));
+    }
+    _build();
+}
+
+void KDTree::build(const std::vector<Point> &inputPoints)
+{
+    points = inputPoints;
+    _build();
+}
+
+void KDTree::clear()
+{
+    points.clear();
+    points.shrink_to_fit();
+}
+
+void KDTree::_splitRange(size_t begin, size_t end, int depth)
+{
+    const int axis = depth % 3;
+    std::nth_element(points.begin() + begin, points.begin() + (begin + (end - begin) / 2), points.begin() + end,
+            [axis](const Point &a, const Point &b) { return a.position[axis] < b.position[axis]; });
+}
 
-    if (points.size() == 0) {
-        return std::shared_ptr<KDNode>();
+void KDTree::_buildSubtree(size_t begin, size_t end, int depth)
+{
+    if (end - begin <= 1) {
+        return;
     }
+    _splitRange(begin, end, depth);
+    size_t medianIndex = begin + (end - begin) / 2;
+    _buildSubtree(begin, medianIndex, depth + 1);
+    _buildSubtree(medianIndex + 1, end, depth + 1);
+}
 
-    int axis = depth % k;
-    std::sort(points.begin(), points.end(), [axis](Point *a, Point *b) {
-        if (axis == 0) return a->position.x < b->position.x;
-        if (axis == 1) return a->position.y < b->position.y;
-        return a->position.z < b->position.z;
-    });
-    size_t medianIndex = points.size() / 2;
-    std::vector<Point*> leftPoints = std::vector<Point*>(points.begin(), points.begin() + medianIndex);
-    std::vector<Point*> rightPoints = std::vector<Point*>(points.begin() + medianIndex + 1, points.end());
+void KDTree::_build()
+{
+    int numThreads = 1;
+#ifdef _OPENMP
+    numThreads = omp_get_max_threads();
+#endif
+
+    // The top levels contain too few subtrees for parallelizing over subtrees, so they are split level by level.
+    // Every split only reorders its own range, so the result does not depend on the number of threads.
+    std::vector<std::pair<size_t, size_t>> ranges;
+    if (points.size() > 1) {
+        ranges.push_back(std::make_pair(size_t(0), points.size()));
+    }
+    int depth = 0;
+    while (!ranges.empty() && ranges.size() < size_t(numThreads) * 8) {
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t i = 0; i < ranges.size(); i++) {
+            _splitRange(ranges[i].first, ranges[i].second, depth);
+        }
+
+        std::vector<std::pair<size_t, size_t>> childRanges;
+        for (const std::pair<size_t, size_t> &range : ranges) {
+            size_t medianIndex = range.first + (range.second - range.first) / 2;
+            if (medianIndex - range.first > 1) {
+                childRanges.push_back(std::make_pair(range.first, medianIndex));
+            }
+            if (range.second - (medianIndex + 1) > 1) {
+                childRanges.push_back(std::make_pair(medianIndex + 1, range.second));
+            }
+        }
+        ranges.swap(childRanges);
+        depth++;
+    }
 
-    std::shared_ptr<KDNode> node = std::shared_ptr<KDNode>(new KDNode);
-    node->axis = axis;
-    node->location = points.at(medianIndex);
-    node->left = _build(leftPoints, depth + 1);
-    node->right = _build(rightPoints, depth + 1);
-    return node;
+    // Build the remaining subtrees in parallel.
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t i = 0; i < ranges.size(); i++) {
+        _buildSubtree(ranges[i].first, ranges[i].second, depth);
+    }
 }
 
 
-std::vector<Point*> KDTree::findPointsInRectangle(const Rectangle &rect)
+const Point *KDTree::findCloseIndexedPoint(const glm::vec3 &centerPoint, float maxDistance) const
 {
-    std::vector<Point*> points;
-    _findPointsInRectangle(rect, points, root);
-    return points;
+    std::vector<Neighbor> heap;
+    _findKNearestPoints(centerPoint, 1, heap);
+    if (heap.empty() || heap.front().distanceSquared >= maxDistance * maxDistance) {
+        return nullptr;
+    }
+    return &points[heap.front().treeIndex];
 }
 
-void KDTree::_findPointsInRectangle(const Rectangle &rect, std::vector<Point*> &points, std::shared_ptr<KDNode> node)
+void KDTree::findPointsInRectangle(const Rectangle &rect, std::vector<int> &indices) const
 {
-    if (rect.contains(node->location->position)) {
-        points.push_back(node->location);
+    indices.clear();
+    if (points.empty()) {
+        return;
     }
 
-    if ((node->axis == 0 && rect.min.x <= node->location->position.x)
-        || (node->axis == 1 && rect.min.y <= node->location->position.y)
-        || (node->axis == 2 && rect.min.z <= node->location->position.z)) {
-        _findPointsInRectangle(rect, points, node->left);
+    KDTraversalEntry stack[KD_TRAVERSAL_STACK_SIZE];
+    int stackSize = 0;
+    stack[stackSize++] = { 0, points.size(), 0, 0.0f };
+    while (stackSize > 0) {
+        KDTraversalEntry entry = stack[--stackSize];
+        size_t medianIndex = entry.begin + (entry.end - entry.begin) / 2;
+        const Point &point = points[medianIndex];
+        if (rect.contains(point.position)) {
+            indices.push_back(point.index);
+        }
+
+        const int axis = entry.depth % 3;
+        if (medianIndex + 1 < entry.end && rect.max[axis] >= point.position[axis]) {
+            stack[stackSize++] = { medianIndex + 1, entry.end, entry.depth + 1, 0.0f };
+        }
+        if (entry.begin < medianIndex && rect.min[axis] <= point.position[axis]) {
+            stack[stackSize++] = { entry.begin, medianIndex, entry.depth + 1, 0.0f };
+        }
     }
-    if ((node->axis == 0 && rect.max.x >= node->location->position.x)
-        || (node->axis == 1 && rect.max.y >= node->location->position.y)
-        || (node->axis == 2 && rect.max.z >= node->location->position.z)) {
-        _findPointsInRectangle(rect, points, node->right);
+}
+
+void KDTree::findPointsInRadius(const glm::vec3 &center, float radius, std::vector<int> &indices) const
+{
+    indices.clear();
+    if (points.empty()) {
+        return;
     }
-};
+    const float radiusSquared = radius * radius;
+
+    KDTraversalEntry stack[KD_TRAVERSAL_STACK_SIZE];
+    int stackSize = 0;
+    stack[stackSize++] = { 0, points.size(), 0, 0.0f };
+    while (stackSize > 0) {
+        KDTraversalEntry entry = stack[--stackSize];
+        if (entry.minDistanceSquared > radiusSquared) {
+            continue;
+        }
+        size_t medianIndex = entry.begin + (entry.end - entry.begin) / 2;
+        const Point &point = points[medianIndex];
+        if (distanceSquared(point.position, center) <= radiusSquared) {
+            indices.push_back(point.index);
+        }
+
+        const int axis = entry.depth % 3;
+        float planeDistance = center[axis] - point.position[axis];
+        float planeDistanceSquared = planeDistance * planeDistance;
+        // Points with position[axis] == median value may lie in both subtrees.
+        float leftDistanceSquared = planeDistance < 0.0f ? entry.minDistanceSquared : planeDistanceSquared;
+        float rightDistanceSquared = planeDistance > 0.0f ? entry.minDistanceSquared : planeDistanceSquared;
+        if (medianIndex + 1 < entry.end) {
+            stack[stackSize++] = { medianIndex + 1, entry.end, entry.depth + 1,
+                                   std::max(entry.minDistanceSquared, rightDistanceSquared) };
+        }
+        if (entry.begin < medianIndex) {
+            stack[stackSize++] = { entry.begin, medianIndex, entry.depth + 1,
+                                   std::max(entry.minDistanceSquared, leftDistanceSquared) };
+        }
+    }
+}
+
+void KDTree::_findKNearestPoints(
+        const glm::vec3 &center, size_t k, std::vector<Neighbor> &heap) const
+{
+    heap.clear();
+    if (points.empty() || k == 0) {
+        return;
+    }
+
+    KDTraversalEntry stack[KD_TRAVERSAL_STACK_SIZE];
+    int stackSize = 0;
+    stack[stackSize++] = { 0, points.size(), 0, 0.0f };
+    while (stackSize > 0) {
+        KDTraversalEntry entry = stack[--stackSize];
+        // Ties are not pruned, as a point with equal distance and smaller index might replace the farthest point.
+        if (heap.size() == k && entry.minDistanceSquared > heap.front().distanceSquared) {
+            continue;
+        }
+        size_t medianIndex = entry.begin + (entry.end - entry.begin) / 2;
+        const Point &point = points[medianIndex];
+        Neighbor candidate = { distanceSquared(point.position, center), point.index, medianIndex };
+        if (heap.size() < k) {
+            heap.push_back(candidate);
+            std::push_heap(heap.begin(), heap.end());
+        } else if (candidate < heap.front()) {
+            std::pop_heap(heap.begin(), heap.end());
+            heap.back() = candidate;
+            std::push_heap(heap.begin(), heap.end());
+        }
+
+        // Visit the subtree on the side of the query point first (pushed last).
+        const int axis = entry.depth % 3;
+        float planeDistance = center[axis] - point.position[axis];
+        float farDistanceSquared = std::max(entry.minDistanceSquared, planeDistance * planeDistance);
+        bool hasLeft = entry.begin < medianIndex;
+        bool hasRight = medianIndex + 1 < entry.end;
+        if (planeDistance < 0.0f) {
+            if (hasRight) {
+                stack[stackSize++] = { medianIndex + 1, entry.end, entry.depth + 1, farDistanceSquared };
+            }
+            if (hasLeft) {
+                stack[stackSize++] = { entry.begin, medianIndex, entry.depth + 1, entry.minDistanceSquared };
+            }
+        } else {
+            // For planeDistance == 0, both subtrees may contain points on the splitting plane.
+            if (hasLeft) {
+                stack[stackSize++] = { entry.begin, medianIndex, entry.depth + 1, farDistanceSquared };
+            }
+            if (hasRight) {
+                stack[stackSize++] = { medianIndex + 1, entry.end, entry.depth + 1, entry.minDistanceSquared };
+            }
+        }
+    }
+}
+
+void KDTree::findKNearestPoints(
+        const glm::vec3 &center, int k, std::vector<int> &indices, std::vector<float> *distances) const
+{
+    std::vector<Neighbor> heap;
+    _findKNearestPoints(center, size_t(std::max(k, 0)), heap);
+    std::sort_heap(heap.begin(), heap.end());
+
+    indices.resize(heap.size());
+    if (distances) {
+        distances->resize(heap.size());
+    }
+    for (size_t i = 0; i < heap.size(); i++) {
+        indices[i] = heap[i].index;
+        if (distances) {
+            (*distances)[i] = std::sqrt(heap[i].distanceSquared);
+        }
+    }
+}
+
+void KDTree::findKNearestPointsBatch(const std::vector<glm::vec3> &queryPoints, int k,
+        std::vector<int> &indices, std::vector<float> &distances) const
+{
+    const size_t numNeighbors = size_t(std::max(k, 0));
+    indices.resize(queryPoints.size() * numNeighbors);
+    distances.resize(queryPoints.size() * numNeighbors);
 
+    #pragma omp parallel
+    {
+        std::vector<Neighbor> heap;
+        heap.reserve(numNeighbors);
 
-Point *KDTree::findCloseIndexedPoint(Point *centerPoint, float maxDistance)
-{
-    // Find all points in bounding rectangle and test if their distance is less or equal than searched one
-    Rectangle rect;
-    rect.min = glm::vec3(
-            centerPoint->position.x - maxDistance,
-            centerPoint->position.y - maxDistance,
-            centerPoint->position.z - maxDistance);
-    rect.max = glm::vec3(
-            centerPoint->position.x + maxDistance,
-            centerPoint->position.y + maxDistance,
-            centerPoint->position.z + maxDistance);
-
-    std::vector<Point*> rectPoints = findPointsInRectangle(rect);
-
-    Point *closestPoint = NULL;
-    float closestDistance = FLT_MAX;
-    for (Point *point : rectPoints) {
-        float currDistance = (centerPoint->position - point->position).length();
-        if (currDistance < closestDistance && currDistance < maxDistance) {
-            closestPoint = point;
-            closestDistance = currDistance;
+        #pragma omp for schedule(dynamic, 256)
+        for (size_t i = 0; i < queryPoints.size(); i++) {
+            _findKNearestPoints(queryPoints[i], numNeighbors, heap);
+            std::sort_heap(heap.begin(), heap.end());
+            for (size_t j = 0; j < numNeighbors; j++) {
+                if (j < heap.size()) {
+                    indices[i * numNeighbors + j] = heap[j].index;
+                    distances[i * numNeighbors + j] = std::sqrt(heap[j].distanceSquared);
+                } else {
+                    indices[i * numNeighbors + j] = -1;
+                    distances[i * numNeighbors + j] = FLT_MAX;
+                }
+            }
         }
     }
-    return closestPoint;
+}
+
+void KDTree::findPointsInRadiusBatch(const std::vector<glm::vec3> &queryPoints, float radius,
+        std::vector<size_t> &offsets, std::vector<int> &indices) const
+{
+    std::vector<std::vector<int>> queryResults(queryPoints.size());
+    offsets.resize(queryPoints.size() + 1);
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (size_t i = 0; i < queryPoints.size(); i++) {
+        findPointsInRadius(queryPoints[i], radius, queryResults[i]);
+        offsets[i] = queryResults[i].size();
+    }
+
+    offsets.back() = parallelExclusivePrefixSum(offsets.data(), offsets.data(), queryPoints.size());
+    indices.resize(offsets.back());
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (size_t i = 0; i < queryPoints.size(); i++) {
+        std::copy(queryResults[i].begin(), queryResults[i].end(), indices.begin() + offsets[i]);
+    }
 }
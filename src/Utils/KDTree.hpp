@@ -5,14 +5,15 @@
 #ifndef PIXELSYNCOIT_KDTREE_HPP
 #define PIXELSYNCOIT_KDTREE_HPP
 
-#include <algorithm>
-#include <memory>
 #include <vector>
+#include <cstddef>
 #include <glm/glm.hpp>
 
 class Point
 {
 public:
+    Point() : position(0.0f), index(0) {}
+    Point(const glm::vec3 &position, int index) : position(position), index(index) {}
     glm::vec3 position;
     int index;
 };
@@ -24,30 +25,77 @@ public:
     bool contains(const glm::vec3 &pt) const;
 };
 
-class KDNode
+/**
+ * KD-tree over 3D points stored in an implicit, array-based layout (no node objects or pointers).
+ * The points of a subtree occupy a contiguous range [begin, end) of the point array. The splitting point of the
+ * subtree is the median at begin + (end - begin) / 2, the left subtree is [begin, median) and the right subtree is
+ * [median + 1, end). The splitting axis is depth % 3.
+ * The tree is built with std::nth_element instead of fully sorting each level. The top levels are split level by
+ * level, and the remaining subtrees are built in parallel.
+ * All query functions return the indices (Point::index) of the found points.
+ */
+class KDTree
 {
 public:
-    int axis;
-    Point *location;
-    std::shared_ptr<KDNode> left;
-    std::shared_ptr<KDNode> right;
-};
+    /// Builds the tree. The index of points[i] is i.
+    void build(const std::vector<glm::vec3> &points);
+    /// Builds the tree using the passed indices.
+    void build(const std::vector<Point> &points);
+    void clear();
 
-class KDTree
-{
-    void build(const std::vector<Point*> &points);
+    inline size_t getNumPoints() const { return points.size(); }
+    inline bool empty() const { return points.empty(); }
+    /// The points in tree order.
+    inline const std::vector<Point> &getPoints() const { return points; }
+
+    /// Used for e.g. giving points that are approx. the same (i.e. low distance) the same index.
+    /// @return The closest point with a distance less than maxDistance, or nullptr if there is none.
+    const Point *findCloseIndexedPoint(const glm::vec3 &centerPoint, float maxDistance) const;
+
+    /// Finds all points within the rectangle (borders inclusive).
+    void findPointsInRectangle(const Rectangle &rect, std::vector<int> &indices) const;
+    /// Finds all points with a distance less than or equal to radius to the center.
+    void findPointsInRadius(const glm::vec3 &center, float radius, std::vector<int> &indices) const;
+    /**
+     * Finds the k nearest points to the center. The results are sorted by ascending distance (points with equal
+     * distance by ascending index). Less than k points are returned if the tree stores less than k points.
+     * @param distances If not nullptr, the (non-squared) distances of the found points.
+     */
+    void findKNearestPoints(const glm::vec3 &center, int k, std::vector<int> &indices,
+            std::vector<float> *distances = nullptr) const;
 
-    /// Used for e.g. giving points that are approx. the same (i.e. low distance)
-    /// the same index.
-    Point *findCloseIndexedPoint(Point *centerPoint, float maxDistance);
-    std::vector<Point*> findPointsInRectangle(const Rectangle &rect);
+    // Batch queries (processed in parallel)
+    /**
+     * The results of query i are stored in indices[k*i], ..., indices[k*i+k-1]. If the tree stores less than k
+     * points, the remaining entries are set to -1 and the distances to FLT_MAX.
+     */
+    void findKNearestPointsBatch(const std::vector<glm::vec3> &queryPoints, int k,
+            std::vector<int> &indices, std::vector<float> &distances) const;
+    /**
+     * The results of query i are stored in indices[offsets[i]], ..., indices[offsets[i+1]-1] (i.e., CSR format).
+     */
+    void findPointsInRadiusBatch(const std::vector<glm::vec3> &queryPoints, float radius,
+            std::vector<size_t> &offsets, std::vector<int> &indices) const;
 
 private:
     // Internal implementations
-    std::shared_ptr<KDNode> _build(std::vector<Point*> points, int depth);
-    void _findPointsInRectangle(const Rectangle &rect, std::vector<Point*> &points, std::shared_ptr<KDNode> node);
+    void _build();
+    void _buildSubtree(size_t begin, size_t end, int depth);
+    void _splitRange(size_t begin, size_t end, int depth);
+    /// A candidate of a nearest neighbor search, ordered by distance and then by point index.
+    struct Neighbor {
+        float distanceSquared;
+        int index;
+        size_t treeIndex; ///< Position in the point array.
+        inline bool operator<(const Neighbor &other) const {
+            return distanceSquared < other.distanceSquared
+                    || (distanceSquared == other.distanceSquared && index < other.index);
+        }
+    };
+    /// Leaves the k nearest points as a max-heap in heap.
+    void _findKNearestPoints(const glm::vec3 &center, size_t k, std::vector<Neighbor> &heap) const;
 
-    std::shared_ptr<KDNode> root;
+    std::vector<Point> points;
 };
 
 #endif //PIXELSYNCOIT_KDTREE_HPP
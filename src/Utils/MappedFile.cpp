@@ -0,0 +1,153 @@
+#define _FILE_OFFSET_BITS 64
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+
+#include <Utils/File/Logfile.hpp>
+#include "MappedFile.hpp"
+
+MappedFile::MappedFile() : data(nullptr), size(0)
+#ifdef _WIN32
+        , fileHandle(nullptr), mappingHandle(nullptr)
+#else
+        , fileDescriptor(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string &filename)
+{
+    close();
+    this->filename = filename;
+
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in MappedFile::open: File \"" + filename
+                + "\" not found.");
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    if (fileSize.QuadPart == 0) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in MappedFile::open: File \"" + filename
+                + "\" is empty.");
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in MappedFile::open: Could not map file \""
+                + filename + "\".");
+        CloseHandle(file);
+        return false;
+    }
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == NULL) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in MappedFile::open: Could not map file \""
+                + filename + "\".");
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = (const uint8_t*)view;
+    size = (size_t)fileSize.QuadPart;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (data) {
+        UnmapViewOfFile((LPCVOID)data);
+        CloseHandle((HANDLE)mappingHandle);
+        CloseHandle((HANDLE)fileHandle);
+    }
+    data = nullptr;
+    size = 0;
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+}
+
+void MappedFile::prefetch(size_t offset, size_t numBytes) const
+{
+    // PrefetchVirtualMemory is not available on all supported Windows versions; rely on demand paging.
+}
+
+#else
+
+bool MappedFile::open(const std::string &filename)
+{
+    close();
+    this->filename = filename;
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in MappedFile::open: File \"" + filename
+                + "\" not found.");
+        return false;
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in MappedFile::open: File \"" + filename
+                + "\" is empty or cannot be accessed.");
+        ::close(fd);
+        return false;
+    }
+
+    void *mapping = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in MappedFile::open: Could not map file \""
+                + filename + "\".");
+        ::close(fd);
+        return false;
+    }
+
+    fileDescriptor = fd;
+    data = (const uint8_t*)mapping;
+    size = (size_t)fileStat.st_size;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (data) {
+        munmap((void*)data, size);
+        ::close(fileDescriptor);
+    }
+    data = nullptr;
+    size = 0;
+    fileDescriptor = -1;
+}
+
+void MappedFile::prefetch(size_t offset, size_t numBytes) const
+{
+    if (!data || offset >= size) {
+        return;
+    }
+    // madvise expects a page-aligned start address
+    const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t alignedOffset = offset / pageSize * pageSize;
+    size_t end = std::min(offset + numBytes, size);
+    madvise((void*)(data + alignedOffset), end - alignedOffset, MADV_WILLNEED);
+}
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef PIXELSYNCOIT_MAPPEDFILE_HPP
+#define PIXELSYNCOIT_MAPPEDFILE_HPP
+
+#include <string>
+#include <memory>
+#include <cstdint>
+
+/**
+ * Read-only memory mapping of a whole file. The pages are loaded lazily by the operating system on first access,
+ * i.e., opening a multi-GB file is cheap and data that is never accessed is never read from disk.
+ */
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile &operator=(const MappedFile&) = delete;
+
+    /// @return True if the file could be opened and mapped.
+    bool open(const std::string &filename);
+    void close();
+
+    inline bool isOpen() const { return data != nullptr; }
+    inline const uint8_t *getData() const { return data; }
+    inline size_t getSize() const { return size; }
+    inline const std::string &getFilename() const { return filename; }
+
+    /// Hint to the operating system that the specified byte range will be needed soon (e.g. before GPU upload).
+    void prefetch(size_t offset, size_t numBytes) const;
+
+private:
+    std::string filename;
+    const uint8_t *data;
+    size_t size;
+#ifdef _WIN32
+    void *fileHandle;
+    void *mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+};
+
+typedef std::shared_ptr<MappedFile> MappedFilePtr;
+
+#endif //PIXELSYNCOIT_MAPPEDFILE_HPP
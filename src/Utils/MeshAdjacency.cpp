@@ -0,0 +1,40 @@
+#include <algorithm>
+
+#include "ParallelAlgorithms.hpp"
+#include "MeshAdjacency.hpp"
+
+void buildVertexTriangleAdjacency(
+        const uint32_t *indices, size_t numIndices, size_t numVertices, VertexTriangleAdjacency &adjacency)
+{
+    std::vector<size_t> &triangleOffsets = adjacency.triangleOffsets;
+    std::vector<uint32_t> &triangleIndices = adjacency.triangleIndices;
+    triangleOffsets.assign(numVertices + 1, 0);
+    triangleIndices.resize(numIndices);
+
+    // Count the number of triangles referencing each vertex.
+    #pragma omp parallel for
+    for (size_t j = 0; j < numIndices; j++) {
+        #pragma omp atomic
+        triangleOffsets[indices[j]]++;
+    }
+
+    // Row offsets. The last entry receives the total number of references.
+    triangleOffsets.back() = parallelExclusivePrefixSum(
+            triangleOffsets.data(), triangleOffsets.data(), numVertices);
+
+    // Scatter the triangle indices into the rows. The order within a row depends on the thread scheduling.
+    std::vector<size_t> rowCursors(triangleOffsets.begin(), triangleOffsets.end() - 1);
+    #pragma omp parallel for
+    for (size_t j = 0; j < numIndices; j++) {
+        size_t writePosition;
+        #pragma omp atomic capture
+        writePosition = rowCursors[indices[j]]++;
+        triangleIndices[writePosition] = uint32_t(j / 3);
+    }
+
+    // Sort the rows to obtain a deterministic order.
+    #pragma omp parallel for schedule(dynamic, 4096)
+    for (size_t i = 0; i < numVertices; i++) {
+        std::sort(triangleIndices.begin() + triangleOffsets[i], triangleIndices.begin() + triangleOffsets[i + 1]);
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef PIXELSYNCOIT_MESHADJACENCY_HPP
+#define PIXELSYNCOIT_MESHADJACENCY_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "ArrayView.hpp"
+
+/**
+ * Vertex-to-triangle adjacency of an indexed triangle mesh in compressed sparse row (CSR) format.
+ * The triangles referencing vertex i are triangleIndices[triangleOffsets[i]], ...,
+ * triangleIndices[triangleOffsets[i+1]-1], sorted in ascending order.
+ * A triangle referencing the same vertex multiple times (degenerate triangle) is listed multiple times.
+ */
+struct VertexTriangleAdjacency
+{
+    /// Size: number of vertices + 1.
+    std::vector<size_t> triangleOffsets;
+    /// Size: number of indices.
+    std::vector<uint32_t> triangleIndices;
+
+    inline size_t getNumVertices() const { return triangleOffsets.empty() ? 0 : triangleOffsets.size() - 1; }
+    inline size_t getNumTriangles(size_t vertexIndex) const {
+        return triangleOffsets[vertexIndex + 1] - triangleOffsets[vertexIndex];
+    }
+    inline ArrayView<const uint32_t> getTriangles(size_t vertexIndex) const {
+        return ArrayView<const uint32_t>(
+                triangleIndices.data() + triangleOffsets[vertexIndex], getNumTriangles(vertexIndex));
+    }
+};
+
+/**
+ * Builds the vertex-to-triangle adjacency of a triangle mesh using a parallel counting sort:
+ * 1. Count the number of references of each vertex (atomic increments).
+ * 2. Exclusive prefix sum of the counts -> row offsets.
+ * 3. Scatter the triangle indices into the rows (atomic cursors).
+ * 4. Sort each (short) row, which makes the result independent of the number of threads.
+ * @param indices The triangle indices (three per triangle).
+ * @param numIndices The number of indices.
+ * @param numVertices The number of vertices referenced by the indices.
+ * @param adjacency The (output) adjacency.
+ */
+void buildVertexTriangleAdjacency(
+        const uint32_t *indices, size_t numIndices, size_t numVertices, VertexTriangleAdjacency &adjacency);
+
+#endif //PIXELSYNCOIT_MESHADJACENCY_HPP
@@ -0,0 +1,323 @@
+#include <algorithm>
+#include <cstring>
+#include <cfloat>
+
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <Utils/File/Logfile.hpp>
+#include <Utils/Convert.hpp>
+
+#include "ImportanceCriteria.hpp"
+#include "Unorm16.hpp"
+#include "RandomPermutation.hpp"
+#include "MeshPreprocessing.hpp"
+
+using namespace sgl;
+
+sgl::AABB3 computeAABB(const std::vector<glm::vec3> &vertices)
+{
+    if (vertices.size() < 1) {
+        Logfile::get()->writeError("computeAABB: vertices.size() < 1");
+        return sgl::AABB3();
+    }
+
+    glm::vec3 minV = glm::vec3(FLT_MAX, FLT_MAX, FLT_MAX);
+    glm::vec3 maxV = glm::vec3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (const glm::vec3 &pt : vertices) {
+        minV.x = std::min(minV.x, pt.x);
+        minV.y = std::min(minV.y, pt.y);
+        minV.z = std::min(minV.z, pt.z);
+        maxV.x = std::max(maxV.x, pt.x);
+        maxV.y = std::max(maxV.y, pt.y);
+        maxV.z = std::max(maxV.z, pt.z);
+    }
+
+    return sgl::AABB3(minV, maxV);
+}
+
+std::vector<uint32_t> shuffleIndicesLines(const uint32_t *indices, size_t numIndices, uint64_t seed) {
+    size_t numSegments = numIndices / 2;
+    std::vector<uint32_t> shuffledIndices(numSegments*2);
+    shufflePrimitives(indices, numSegments, 2, seed, shuffledIndices.data());
+    return shuffledIndices;
+}
+
+/// Number of line segments processed at once when searching for the start of the lines.
+const size_t LINE_START_CHUNK_SIZE = size_t(1) << 16;
+
+/**
+ * Computes the index of the first segment of every line (i.e., of a segment not starting at the end of the previous
+ * segment) followed by numSegments. The chunks of segments are processed in parallel.
+ */
+static void computeLineStarts(const uint32_t *indices, size_t numSegments, std::vector<size_t> &lineStarts)
+{
+    const size_t numChunks = (numSegments + LINE_START_CHUNK_SIZE - 1) / LINE_START_CHUNK_SIZE;
+    std::vector<size_t> chunkOffsets(numChunks + 1, 0);
+    #pragma omp parallel for
+    for (size_t chunkIndex = 0; chunkIndex < numChunks; chunkIndex++) {
+        size_t end = std::min((chunkIndex + 1) * LINE_START_CHUNK_SIZE, numSegments);
+        size_t numLineStarts = 0;
+        for (size_t i = chunkIndex * LINE_START_CHUNK_SIZE; i < end; i++) {
+            numLineStarts += (i == 0 || indices[i*2] != indices[(i-1)*2+1]) ? 1 : 0;
+        }
+        chunkOffsets[chunkIndex + 1] = numLineStarts;
+    }
+    for (size_t chunkIndex = 0; chunkIndex < numChunks; chunkIndex++) {
+        chunkOffsets[chunkIndex + 1] += chunkOffsets[chunkIndex];
+    }
+
+    lineStarts.resize(chunkOffsets.back() + 1);
+    lineStarts.back() = numSegments;
+    #pragma omp parallel for
+    for (size_t chunkIndex = 0; chunkIndex < numChunks; chunkIndex++) {
+        size_t end = std::min((chunkIndex + 1) * LINE_START_CHUNK_SIZE, numSegments);
+        size_t lineIndex = chunkOffsets[chunkIndex];
+        for (size_t i = chunkIndex * LINE_START_CHUNK_SIZE; i < end; i++) {
+            if (i == 0 || indices[i*2] != indices[(i-1)*2+1]) {
+                lineStarts[lineIndex++] = i;
+            }
+        }
+    }
+}
+
+std::vector<uint32_t> shuffleLineOrder(const uint32_t *indices, size_t numIndices, uint64_t seed) {
+    size_t numSegments = numIndices / 2;
+
+    // 1. Compute list of all lines (as segment ranges [lineStarts[i], lineStarts[i+1]))
+    std::vector<size_t> lineStarts;
+    computeLineStarts(indices, numSegments, lineStarts);
+    size_t numLines = lineStarts.size() - 1;
+
+    // 2. Shuffle line list and compute the position of each line in the shuffled index array
+    RandomPermutation permutation(numLines, seed);
+    std::vector<size_t> shuffledLines(numLines);
+    std::vector<size_t> shuffledLineOffsets(numLines + 1, 0);
+    #pragma omp parallel for
+    for (size_t i = 0; i < numLines; i++) {
+        size_t lineIndex = size_t(permutation(i));
+        shuffledLines[i] = lineIndex;
+        shuffledLineOffsets[i + 1] = lineStarts[lineIndex + 1] - lineStarts[lineIndex];
+    }
+    for (size_t i = 0; i < numLines; i++) {
+        shuffledLineOffsets[i + 1] += shuffledLineOffsets[i];
+    }
+
+    // 3. Reconstruct line list from shuffled lines
+    std::vector<uint32_t> shuffledIndices(numSegments*2);
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (size_t i = 0; i < numLines; i++) {
+        size_t lineIndex = shuffledLines[i];
+        size_t numLineSegments = lineStarts[lineIndex + 1] - lineStarts[lineIndex];
+        memcpy(&shuffledIndices[shuffledLineOffsets[i]*2], indices + lineStarts[lineIndex]*2,
+                numLineSegments*2*sizeof(uint32_t));
+    }
+
+    return shuffledIndices;
+}
+
+std::vector<uint32_t> shuffleIndicesTriangles(const uint32_t *indices, size_t numIndices, uint64_t seed) {
+    size_t numTriangles = numIndices / 3;
+    std::vector<uint32_t> shuffledIndices(numTriangles*3);
+    shufflePrimitives(indices, numTriangles, 3, seed, shuffledIndices.data());
+    return shuffledIndices;
+}
+
+
+/// Shuffled indices if shuffling is enabled for the vertex mode of the submesh, otherwise an empty vector.
+static std::vector<uint32_t> shuffleSubmeshIndices(
+        const BinarySubMeshView &submesh, const MeshPreprocessingSettings &settings)
+{
+    if (submesh.vertexMode == VERTEX_MODE_LINES) {
+        return shuffleLineOrder(submesh.indices, submesh.numIndices, settings.shuffleSeed);
+    } else if (submesh.vertexMode == VERTEX_MODE_TRIANGLES) {
+        return shuffleIndicesTriangles(submesh.indices, submesh.numIndices, settings.shuffleSeed);
+    }
+    return std::vector<uint32_t>();
+}
+
+/// Returns -1 if the attribute is not an attribute "vertexAttribute<N>".
+static int getLineAttributeIndex(const std::string &attributeName)
+{
+    if (!boost::starts_with(attributeName, "vertexAttribute")) {
+        return -1;
+    }
+    return sgl::fromString<int>(attributeName.substr(15));
+}
+
+void preprocessSubmesh(const BinarySubMeshView &submesh, const MeshPreprocessingSettings &settings,
+        PreprocessedSubmesh &preprocessedSubmesh)
+{
+    preprocessedSubmesh = PreprocessedSubmesh();
+    const bool useAoS = settings.useProgrammableFetch && settings.programmableFetchUseAoS;
+
+    if (submesh.numIndices > 0 && settings.useProgrammableFetch) {
+        // Every line segment (i0, i1) is rendered as the two triangles 0,2,3,0,3,1 of the vertices 2*i0, 2*i0+1,
+        // 2*i1 and 2*i1+1.
+        const size_t numSegments = submesh.numIndices / 2;
+        std::vector<uint32_t> &fetchIndices = preprocessedSubmesh.indices;
+        fetchIndices.resize(numSegments * 6);
+        const uint32_t *indices = submesh.indices;
+        #pragma omp parallel for
+        for (size_t i = 0; i < numSegments; i++) {
+            uint32_t base0 = indices[i*2]*2;
+            uint32_t base1 = indices[i*2+1]*2;
+            uint32_t *segmentIndices = &fetchIndices[i*6];
+            segmentIndices[0] = base0;
+            segmentIndices[1] = base1;
+            segmentIndices[2] = base1+1;
+            segmentIndices[3] = base0;
+            segmentIndices[4] = base1+1;
+            segmentIndices[5] = base0+1;
+        }
+    } else if (submesh.numIndices > 0 && settings.shuffleData) {
+        preprocessedSubmesh.indices = shuffleSubmeshIndices(submesh, settings);
+    }
+
+    // Positions and tangents are only referenced; the AoS data is assembled from the mapped file below.
+    const glm::vec3 *positions = nullptr, *tangents = nullptr;
+    size_t numPositions = 0, numTangents = 0;
+    std::vector<int> lineAttributeIndices; // For AoS: Index N of the importance criterion "vertexAttribute<N>".
+    preprocessedSubmesh.vec4Attributes.resize(submesh.attributes.size());
+
+    for (size_t j = 0; j < submesh.attributes.size(); j++) {
+        const BinaryMeshAttributeView &meshAttribute = submesh.attributes.at(j);
+
+        if (meshAttribute.numComponents == 1) {
+            preprocessedSubmesh.importanceCriterionAttributes.push_back(ImportanceCriterionAttribute());
+            ImportanceCriterionAttribute &importanceCriterionAttribute =
+                    preprocessedSubmesh.importanceCriterionAttributes.back();
+            importanceCriterionAttribute.name = meshAttribute.name;
+
+            // The minimum and maximum value are computed in the same pass.
+            const uint16_t *attributeValuesUnorm = (const uint16_t*)meshAttribute.data;
+            size_t numAttributeValues = meshAttribute.dataSize / sizeof(uint16_t);
+            Unorm16Statistics statistics;
+            importanceCriterionAttribute.attributes.resize(numAttributeValues);
+            unpackUnorm16(attributeValuesUnorm, numAttributeValues, importanceCriterionAttribute.attributes.data(),
+                    &statistics);
+            importanceCriterionAttribute.minAttribute = statistics.minValue;
+            importanceCriterionAttribute.maxAttribute = statistics.maxValue;
+
+            if (useAoS) {
+                lineAttributeIndices.push_back(getLineAttributeIndex(meshAttribute.name));
+            }
+        }
+
+        if (meshAttribute.numComponents == 3 && settings.useProgrammableFetch && !settings.programmableFetchUseAoS) {
+            // vec3 problematic in std430 struct
+            const glm::vec3 *attributeValues = (const glm::vec3*)meshAttribute.data;
+            size_t numAttributeValues = meshAttribute.dataSize / sizeof(glm::vec3);
+            std::vector<glm::vec4> &vec4AttributeValues = preprocessedSubmesh.vec4Attributes.at(j);
+            vec4AttributeValues.resize(numAttributeValues);
+            #pragma omp parallel for
+            for (size_t i = 0; i < numAttributeValues; i++) {
+                vec4AttributeValues[i] = glm::vec4(attributeValues[i], 1.0f);
+            }
+        }
+
+        if (meshAttribute.name == "vertexPosition") {
+            positions = (const glm::vec3*)meshAttribute.data;
+            numPositions = meshAttribute.dataSize / sizeof(glm::vec3);
+        } else if (meshAttribute.name == "vertexLineTangent") {
+            tangents = (const glm::vec3*)meshAttribute.data;
+            numTangents = meshAttribute.dataSize / sizeof(glm::vec3);
+        }
+    }
+
+    if (numPositions > 0) {
+        float minX = FLT_MAX, minY = FLT_MAX, minZ = FLT_MAX;
+        float maxX = -FLT_MAX, maxY = -FLT_MAX, maxZ = -FLT_MAX;
+        #pragma omp parallel for reduction(min:minX,minY,minZ) reduction(max:maxX,maxY,maxZ)
+        for (size_t i = 0; i < numPositions; i++) {
+            const glm::vec3 &pt = positions[i];
+            minX = std::min(minX, pt.x);
+            minY = std::min(minY, pt.y);
+            minZ = std::min(minZ, pt.z);
+            maxX = std::max(maxX, pt.x);
+            maxY = std::max(maxY, pt.y);
+            maxZ = std::max(maxZ, pt.z);
+        }
+        preprocessedSubmesh.hasBoundingBox = true;
+        preprocessedSubmesh.boundingBox = sgl::AABB3(glm::vec3(minX, minY, minZ), glm::vec3(maxX, maxY, maxZ));
+    }
+
+    if (useAoS && !lineAttributeIndices.empty()) {
+        int maxLineAttributeIndex = *std::max_element(lineAttributeIndices.begin(), lineAttributeIndices.end());
+        std::vector<const float*> lineAttributes(size_t(std::max(maxLineAttributeIndex + 1, 0)), nullptr);
+        std::vector<size_t> numLineAttributeValues(lineAttributes.size(), 0);
+        for (size_t k = 0; k < lineAttributeIndices.size(); k++) {
+            if (lineAttributeIndices.at(k) >= 0) {
+                const std::vector<float> &values = preprocessedSubmesh.importanceCriterionAttributes.at(k).attributes;
+                lineAttributes.at(lineAttributeIndices.at(k)) = values.data();
+                numLineAttributeValues.at(lineAttributeIndices.at(k)) = values.size();
+            }
+        }
+
+        preprocessedSubmesh.linePointData.resize(lineAttributes.size());
+        for (size_t attributeIndex = 0; attributeIndex < lineAttributes.size(); attributeIndex++) {
+            const float *attributeValues = lineAttributes.at(attributeIndex);
+            if (attributeValues == nullptr) {
+                // Not stored in the file or not selected for loading (see BinaryMeshSelection).
+                continue;
+            }
+            std::vector<LinePointData> &linePointData = preprocessedSubmesh.linePointData.at(attributeIndex);
+            linePointData.resize(numPositions);
+            const size_t numAttributeValues = numLineAttributeValues.at(attributeIndex);
+            #pragma omp parallel for
+            for (size_t i = 0; i < numPositions; i++) {
+                LinePointData &pointData = linePointData[i];
+                pointData.vertexPosition = positions[i];
+                pointData.vertexAttribute = i < numAttributeValues ? attributeValues[i] : 0.0f;
+                pointData.vertexTangent = i < numTangents ? tangents[i] : glm::vec3(0.0f);
+                pointData.padding = 0.0f;
+            }
+        }
+    }
+}
+
+void selectImportanceCriterion(const BinaryMeshTableOfContents &tableOfContents, int importanceCriterionIndex,
+        BinaryMeshSelection &selection, std::vector<std::string> &unselectedAttributeNames)
+{
+    const std::string selectedName = "vertexAttribute" + sgl::toString(importanceCriterionIndex);
+    selection = BinaryMeshSelection();
+    unselectedAttributeNames.clear();
+    for (const BinaryMeshSectionInfo &sectionInfo : tableOfContents.sections) {
+        if (sectionInfo.sectionType != BINMESH_SECTION_ATTRIBUTE) {
+            continue;
+        }
+        std::vector<std::string> &names = sectionInfo.numComponents != 1
+                || getLineAttributeIndex(sectionInfo.name) < 0 || sectionInfo.name == selectedName
+                ? selection.attributeNames : unselectedAttributeNames;
+        if (std::find(names.begin(), names.end(), sectionInfo.name) == names.end()) {
+            names.push_back(sectionInfo.name);
+        }
+    }
+}
+
+bool preprocessSelectedAttributes(const std::string &filename, const std::vector<std::string> &attributeNames,
+        const MeshPreprocessingSettings &settings, MappedBinaryMesh &mesh,
+        std::vector<PreprocessedSubmesh> &preprocessedSubmeshes)
+{
+    preprocessedSubmeshes.clear();
+    if (attributeNames.empty()) {
+        return true;
+    }
+
+    BinaryMeshSelection selection;
+    selection.attributeNames = attributeNames;
+    selection.loadIndices = false;
+    if (settings.useProgrammableFetch && settings.programmableFetchUseAoS) {
+        selection.attributeNames.push_back("vertexPosition");
+        selection.attributeNames.push_back("vertexLineTangent");
+    }
+    if (!mesh.open(filename, selection)) {
+        return false;
+    }
+    mesh.prefetch();
+
+    preprocessedSubmeshes.resize(mesh.submeshes.size());
+    for (size_t i = 0; i < mesh.submeshes.size(); i++) {
+        preprocessSubmesh(mesh.submeshes.at(i), settings, preprocessedSubmeshes.at(i));
+    }
+    return true;
+}
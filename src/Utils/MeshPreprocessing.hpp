@@ -0,0 +1,101 @@
+#ifndef PIXELSYNCOIT_MESHPREPROCESSING_HPP
+#define PIXELSYNCOIT_MESHPREPROCESSING_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+#include <Math/Geometry/AABB3.hpp>
+
+#include "MeshSerializer.hpp"
+
+/**
+ * The CPU side preprocessing of a submesh loaded by parseMesh3D before its data can be uploaded to the GPU
+ * (shuffling, programmable fetch index and vertex data, unpacking of the importance criteria, bounding box).
+ * It doesn't need an OpenGL context, so it can also be used by the headless benchmark.
+ */
+
+/// Vertex data of programmable fetch in array of structs mode (std430 layout).
+struct LinePointData
+{
+    glm::vec3 vertexPosition;
+    float vertexAttribute;
+    glm::vec3 vertexTangent;
+    float padding;
+};
+
+struct MeshPreprocessingSettings
+{
+    /// Shuffles the order of the lines (line meshes) or triangles (triangle meshes) for testing the order dependency
+    /// of OIT algorithms. The order only depends on the seed (see InternalState::shuffleSeed).
+    bool shuffleData = false;
+    uint64_t shuffleSeed = 0;
+    /// Lines are rendered as quads with programmable vertex fetching (see MeshRenderer::useProgrammableFetch).
+    bool useProgrammableFetch = false;
+    bool programmableFetchUseAoS = true;
+};
+
+/**
+ * The data of a submesh that needs to be created on the CPU. Data that can be uploaded as stored in the file (e.g. the
+ * indices if no shuffling is used) is not copied.
+ */
+struct PreprocessedSubmesh
+{
+    /// Shuffled indices or programmable fetch indices. Empty if the indices of the file can be used.
+    std::vector<uint32_t> indices;
+    /// The unpacked attributes with one component (importance criteria) in the order of submesh.attributes.
+    std::vector<ImportanceCriterionAttribute> importanceCriterionAttributes;
+    /// Programmable fetch without AoS: The attributes with three components padded to glm::vec4 (std430).
+    /// Indexed like submesh.attributes; empty for all other attributes.
+    std::vector<std::vector<glm::vec4>> vec4Attributes;
+    /// Programmable fetch with AoS: One array for each attribute index N of the attributes "vertexAttribute<N>"
+    /// (empty for indices N without an attribute in the submesh).
+    std::vector<std::vector<LinePointData>> linePointData;
+    /// Bounding box of the attribute "vertexPosition" (if the submesh has vertex positions).
+    bool hasBoundingBox = false;
+    sgl::AABB3 boundingBox;
+};
+
+/**
+ * Fused, parallel preprocessing: Every buffer of the submesh is read once (the unorm16 attributes are unpacked
+ * together with their range, the LinePointData array is assembled directly from the memory-mapped positions and
+ * tangents, and the bounding box is computed in place).
+ * Missing tangents are set to zero for programmable fetch.
+ */
+void preprocessSubmesh(const BinarySubMeshView &submesh, const MeshPreprocessingSettings &settings,
+        PreprocessedSubmesh &preprocessedSubmesh);
+
+/**
+ * Selective loading of the importance criteria: Only the importance criterion
+ * "vertexAttribute<importanceCriterionIndex>" and all attributes that are no importance criteria (positions, normals,
+ * tangents, ...) are selected. The names of the importance criteria that are not selected are returned in
+ * unselectedAttributeNames (in the order of the file, without duplicates), such that they can be loaded on demand
+ * with preprocessSelectedAttributes.
+ */
+void selectImportanceCriterion(const BinaryMeshTableOfContents &tableOfContents, int importanceCriterionIndex,
+        BinaryMeshSelection &selection, std::vector<std::string> &unselectedAttributeNames);
+
+/**
+ * Loads and preprocesses only the passed attributes of all submeshes of a .binmesh file, e.g. an importance criterion
+ * that was not selected when the mesh was loaded. For programmable fetch in AoS mode, the vertex positions and tangents
+ * are loaded, too, as they are part of the LinePointData arrays. The indices are never loaded.
+ * @param mesh The file opened with the selection. The preprocessed data may reference its memory mapping.
+ * @return False if the file couldn't be opened.
+ */
+bool preprocessSelectedAttributes(const std::string &filename, const std::vector<std::string> &attributeNames,
+        const MeshPreprocessingSettings &settings, MappedBinaryMesh &mesh,
+        std::vector<PreprocessedSubmesh> &preprocessedSubmeshes);
+
+sgl::AABB3 computeAABB(const std::vector<glm::vec3> &vertices);
+
+/**
+ * Deterministic parallel shuffling (see RandomPermutation): The results only depend on the seed, not on the number of
+ * threads. shuffleIndicesLines shuffles the line segments, shuffleLineOrder the lines (i.e., the segments of a line
+ * stay in order) and shuffleIndicesTriangles the triangles.
+ */
+std::vector<uint32_t> shuffleIndicesLines(const uint32_t *indices, size_t numIndices, uint64_t seed);
+std::vector<uint32_t> shuffleLineOrder(const uint32_t *indices, size_t numIndices, uint64_t seed);
+std::vector<uint32_t> shuffleIndicesTriangles(const uint32_t *indices, size_t numIndices, uint64_t seed);
+
+#endif //PIXELSYNCOIT_MESHPREPROCESSING_HPP
@@ -0,0 +1,401 @@
+#include <algorithm>
+#include <future>
+#include <chrono>
+#include <cfloat>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <glm/glm.hpp>
+
+#include <Utils/File/Logfile.hpp>
+#include <Utils/Convert.hpp>
+#include <Graphics/Shader/ShaderManager.hpp>
+#include <Graphics/Shader/ShaderAttributes.hpp>
+#include <Graphics/Renderer.hpp>
+
+#include "ImportanceCriteria.hpp"
+#include "MeshSerializer.hpp"
+#include "MeshPreprocessing.hpp"
+
+using namespace std;
+using namespace sgl;
+
+void MeshRenderer::render(sgl::ShaderProgramPtr passShader, bool isGBufferPass, int attributeIndex)
+{
+    if (useProgrammableFetch) {
+        for (SSBOEntry &ssboEntry : ssboEntries) {
+            if (ssboEntry.bindingPoint >= 0 && (!boost::starts_with(ssboEntry.attributeName, "vertexAttribute")
+                    || attributeIndex == sgl::fromString<int>(ssboEntry.attributeName.substr(15)))) {
+                sgl::ShaderManager->bindShaderStorageBuffer(ssboEntry.bindingPoint, ssboEntry.attributeBuffer);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < shaderAttributes.size(); i++) {
+        //ShaderProgram *shader = shaderAttributes.at(i)->getShaderProgram();
+        if (!boost::starts_with(passShader->getShaderList().front()->getFileID(), "PseudoPhongVorticity")
+                && !boost::starts_with(passShader->getShaderList().front()->getFileID(), "DepthPeelingGatherDepthComplexity")
+                && !isGBufferPass) {
+            if (passShader->hasUniform("ambientColor")) {
+                passShader->setUniform("ambientColor", materials.at(i).ambientColor);
+            }
+            if (passShader->hasUniform("diffuseColor")) {
+                passShader->setUniform("diffuseColor", materials.at(i).diffuseColor);
+            }
+            if (passShader->hasUniform("specularColor")) {
+                passShader->setUniform("specularColor", materials.at(i).specularColor);
+            }
+            if (passShader->hasUniform("specularExponent")) {
+                passShader->setUniform("specularExponent", materials.at(i).specularExponent);
+            }
+            if (passShader->hasUniform("opacity")) {
+                passShader->setUniform("opacity", materials.at(i).opacity);
+            }
+        }
+        Renderer->render(shaderAttributes.at(i), passShader);
+    }
+}
+
+void MeshRenderer::setNewShader(sgl::ShaderProgramPtr newShader)
+{
+    for (size_t i = 0; i < shaderAttributes.size(); i++) {
+        shaderAttributes.at(i) = shaderAttributes.at(i)->copy(newShader, false);
+    }
+}
+
+struct ImportanceCriterionLoadTask
+{
+    std::string attributeName;
+    MappedBinaryMesh mesh;
+    std::vector<PreprocessedSubmesh> preprocessedSubmeshes;
+    // Declared last, as the destructor of the future waits for the thread that accesses the members above.
+    std::future<bool> result;
+};
+
+bool MeshRenderer::isImportanceCriterionLoaded(int importanceCriterionIndex) const
+{
+    return unloadedImportanceCriteria.find("vertexAttribute" + sgl::toString(importanceCriterionIndex))
+            == unloadedImportanceCriteria.end();
+}
+
+ImportanceCriterionAttribute *MeshRenderer::getImportanceCriterionAttribute(int importanceCriterionIndex)
+{
+    const std::string attributeName = "vertexAttribute" + sgl::toString(importanceCriterionIndex);
+    for (ImportanceCriterionAttribute &attribute : importanceCriterionAttributes) {
+        if (attribute.name == attributeName) {
+            return &attribute;
+        }
+    }
+    return nullptr;
+}
+
+bool MeshRenderer::isImportanceCriterionLoading(int importanceCriterionIndex) const
+{
+    const std::string attributeName = "vertexAttribute" + sgl::toString(importanceCriterionIndex);
+    for (const std::shared_ptr<ImportanceCriterionLoadTask> &task : importanceCriterionLoadTasks) {
+        if (task->attributeName == attributeName) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MeshRenderer::loadImportanceCriterionAsync(int importanceCriterionIndex)
+{
+    if (isImportanceCriterionLoaded(importanceCriterionIndex)
+            || isImportanceCriterionLoading(importanceCriterionIndex)) {
+        return;
+    }
+
+    MeshPreprocessingSettings preprocessingSettings;
+    preprocessingSettings.useProgrammableFetch = useProgrammableFetch;
+    preprocessingSettings.programmableFetchUseAoS = programmableFetchUseAoS;
+
+    std::shared_ptr<ImportanceCriterionLoadTask> task(new ImportanceCriterionLoadTask);
+    task->attributeName = "vertexAttribute" + sgl::toString(importanceCriterionIndex);
+    ImportanceCriterionLoadTask *taskPointer = task.get();
+    const std::string meshFilename = filename;
+    task->result = std::async(std::launch::async, [taskPointer, meshFilename, preprocessingSettings]() {
+        return preprocessSelectedAttributes(meshFilename, { taskPointer->attributeName }, preprocessingSettings,
+                taskPointer->mesh, taskPointer->preprocessedSubmeshes);
+    });
+    importanceCriterionLoadTasks.push_back(task);
+}
+
+void MeshRenderer::loadImportanceCriterion(int importanceCriterionIndex)
+{
+    loadImportanceCriterionAsync(importanceCriterionIndex);
+    for (const std::shared_ptr<ImportanceCriterionLoadTask> &task : importanceCriterionLoadTasks) {
+        task->result.wait();
+    }
+    updateImportanceCriterionLoading();
+}
+
+bool MeshRenderer::updateImportanceCriterionLoading()
+{
+    bool uploaded = false;
+    for (auto it = importanceCriterionLoadTasks.begin(); it != importanceCriterionLoadTasks.end(); ) {
+        ImportanceCriterionLoadTask &task = **it;
+        if (task.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++it;
+            continue;
+        }
+        if (task.result.get() && task.preprocessedSubmeshes.size() == shaderAttributes.size()) {
+            uploadImportanceCriterion(task);
+            uploaded = true;
+        } else {
+            Logfile::get()->writeError(std::string() + "Error in MeshRenderer::updateImportanceCriterionLoading: "
+                    + "Couldn't load the attribute \"" + task.attributeName + "\" from the file \"" + filename
+                    + "\".");
+        }
+        it = importanceCriterionLoadTasks.erase(it);
+    }
+    return uploaded;
+}
+
+void MeshRenderer::uploadImportanceCriterion(ImportanceCriterionLoadTask &task)
+{
+    const std::string &attributeName = task.attributeName;
+    const int attributeIndex = sgl::fromString<int>(attributeName.substr(15));
+    auto importanceCriterionIt = importanceCriterionAttributes.begin();
+
+    for (size_t i = 0; i < task.preprocessedSubmeshes.size(); i++) {
+        const BinarySubMeshView &submesh = task.mesh.submeshes.at(i);
+        PreprocessedSubmesh &preprocessedSubmesh = task.preprocessedSubmeshes.at(i);
+        auto attributeIt = std::find_if(submesh.attributes.begin(), submesh.attributes.end(),
+                [&attributeName](const BinaryMeshAttributeView &attribute) { return attribute.name == attributeName; });
+        if (attributeIt == submesh.attributes.end() || preprocessedSubmesh.importanceCriterionAttributes.empty()) {
+            continue;
+        }
+        const BinaryMeshAttributeView &meshAttribute = *attributeIt;
+        ImportanceCriterionAttribute &importanceCriterionAttribute =
+                preprocessedSubmesh.importanceCriterionAttributes.front();
+
+        // Same buffers as in parseMesh3D.
+        GeometryBufferPtr attributeBuffer;
+        if (!useProgrammableFetch) {
+            attributeBuffer = Renderer->createGeometryBuffer(
+                    meshAttribute.dataSize, (void*)meshAttribute.data, VERTEX_BUFFER);
+            shaderAttributes.at(i)->addGeometryBufferOptional(
+                    attributeBuffer, meshAttribute.name.c_str(), meshAttribute.attributeFormat,
+                    meshAttribute.numComponents, 0, 0, 0, ATTRIB_CONVERSION_FLOAT_NORMALIZED);
+            shaderAttributeNames.insert(meshAttribute.name);
+        } else if (!programmableFetchUseAoS) {
+            attributeBuffer = Renderer->createGeometryBuffer(
+                    importanceCriterionAttribute.attributes.size()*sizeof(float),
+                    (void*)importanceCriterionAttribute.attributes.data(), SHADER_STORAGE_BUFFER);
+            ssboEntries.push_back(SSBOEntry(4, meshAttribute.name, attributeBuffer));
+        } else if (size_t(attributeIndex) < preprocessedSubmesh.linePointData.size()) {
+            const std::vector<LinePointData> &linePointData = preprocessedSubmesh.linePointData.at(attributeIndex);
+            attributeBuffer = Renderer->createGeometryBuffer(
+                    linePointData.size()*sizeof(LinePointData), (void*)linePointData.data(), SHADER_STORAGE_BUFFER);
+            ssboEntries.push_back(SSBOEntry(2, meshAttribute.name, attributeBuffer));
+        }
+
+        // The entries are stored in the order of the submeshes, so the next entry with this name belongs to submesh i.
+        importanceCriterionIt = std::find_if(importanceCriterionIt, importanceCriterionAttributes.end(),
+                [&attributeName](const ImportanceCriterionAttribute &attribute) {
+                    return attribute.name == attributeName;
+                });
+        if (importanceCriterionIt != importanceCriterionAttributes.end()) {
+            *importanceCriterionIt = std::move(importanceCriterionAttribute);
+            ++importanceCriterionIt;
+        }
+    }
+
+    unloadedImportanceCriteria.erase(attributeName);
+}
+
+
+MeshRenderer parseMesh3D(const std::string &filename, sgl::ShaderProgramPtr shader, bool shuffleData,
+        bool useProgrammableFetch, bool programmableFetchUseAoS, float lineRadius, uint64_t shuffleSeed,
+        int importanceCriterionIndex)
+{
+    MeshRenderer meshRenderer(useProgrammableFetch);
+    meshRenderer.programmableFetchUseAoS = programmableFetchUseAoS;
+    meshRenderer.filename = filename;
+
+    // Only load the importance criterion that is displayed, the others are loaded on demand.
+    BinaryMeshTableOfContents tableOfContents;
+    BinaryMeshSelection selection;
+    bool hasTableOfContents = readBinaryMeshTableOfContents(filename, tableOfContents);
+    if (hasTableOfContents && importanceCriterionIndex >= 0) {
+        std::vector<std::string> unselectedAttributeNames;
+        selectImportanceCriterion(tableOfContents, importanceCriterionIndex, selection, unselectedAttributeNames);
+        meshRenderer.unloadedImportanceCriteria.insert(
+                unselectedAttributeNames.begin(), unselectedAttributeNames.end());
+    }
+
+    MappedBinaryMesh mesh;
+    if (mesh.open(filename, selection)) {
+        // All selected data is uploaded to the GPU below, so let the operating system read ahead.
+        mesh.prefetch();
+    }
+
+    if (!shader) {
+        shader = ShaderManager->getShaderProgram({"PseudoPhong.Vertex", "PseudoPhong.Fragment"});
+    }
+
+    std::vector<sgl::ShaderAttributesPtr> &shaderAttributes = meshRenderer.shaderAttributes;
+    std::vector<ObjMaterial> &materials = meshRenderer.materials;
+    shaderAttributes.reserve(mesh.submeshes.size());
+    materials.reserve(mesh.submeshes.size());
+
+    // Bounding box of all submeshes combined
+    AABB3 totalBoundingBox(glm::vec3(FLT_MAX, FLT_MAX, FLT_MAX), glm::vec3(-FLT_MAX, -FLT_MAX, -FLT_MAX));
+
+    // Importance criterion attributes are bound to location 3 and onwards in vertex shader
+    //int importanceCriterionLocationCounter = 3;
+
+
+    MeshPreprocessingSettings preprocessingSettings;
+    preprocessingSettings.shuffleData = shuffleData;
+    preprocessingSettings.shuffleSeed = shuffleSeed;
+    preprocessingSettings.useProgrammableFetch = useProgrammableFetch;
+    preprocessingSettings.programmableFetchUseAoS = programmableFetchUseAoS;
+
+    // Iterate over all submeshes and create rendering data
+    for (size_t i = 0; i < mesh.submeshes.size(); i++) {
+        const BinarySubMeshView &submesh = mesh.submeshes.at(i);
+        PreprocessedSubmesh preprocessedSubmesh;
+        preprocessSubmesh(submesh, preprocessingSettings, preprocessedSubmesh);
+
+        ShaderAttributesPtr renderData = ShaderManager->createShaderAttributes(shader);
+        if (!useProgrammableFetch) {
+            renderData->setVertexMode(submesh.vertexMode);
+        } else {
+            renderData->setVertexMode(VERTEX_MODE_TRIANGLES);
+        }
+
+        if (submesh.numIndices > 0) {
+            // The shuffled or programmable fetch indices, or the indices of the file.
+            GeometryBufferPtr indexBuffer;
+            if (!preprocessedSubmesh.indices.empty() || useProgrammableFetch) {
+                indexBuffer = Renderer->createGeometryBuffer(
+                        sizeof(uint32_t)*preprocessedSubmesh.indices.size(),
+                        (void*)preprocessedSubmesh.indices.data(), INDEX_BUFFER);
+            } else {
+                indexBuffer = Renderer->createGeometryBuffer(
+                        sizeof(uint32_t)*submesh.numIndices, (void*)submesh.indices, INDEX_BUFFER);
+            }
+            renderData->setIndexGeometryBuffer(indexBuffer, ATTRIB_UNSIGNED_INT);
+        }
+
+        size_t importanceCriterionCounter = 0;
+        for (size_t j = 0; j < submesh.attributes.size(); j++) {
+            const BinaryMeshAttributeView &meshAttribute = submesh.attributes.at(j);
+            GeometryBufferPtr attributeBuffer;
+
+            // Assume only one component means importance criterion like vorticity, line width, ...
+            if (meshAttribute.numComponents == 1) {
+                ImportanceCriterionAttribute &importanceCriterionAttribute =
+                        preprocessedSubmesh.importanceCriterionAttributes.at(importanceCriterionCounter++);
+
+                // SSBOs can't directly perform process uint16_t -> float :(
+                if (useProgrammableFetch && !programmableFetchUseAoS) {
+                    attributeBuffer = Renderer->createGeometryBuffer(
+                            importanceCriterionAttribute.attributes.size()*sizeof(float),
+                            (void*)importanceCriterionAttribute.attributes.data(), SHADER_STORAGE_BUFFER);
+                }
+            }
+
+            BufferType bufferType = useProgrammableFetch ? SHADER_STORAGE_BUFFER : VERTEX_BUFFER;
+
+            if (!(useProgrammableFetch && programmableFetchUseAoS)
+                && !(meshAttribute.numComponents == 1 && useProgrammableFetch)
+                && !(meshAttribute.numComponents == 3 && useProgrammableFetch)) {
+                attributeBuffer = Renderer->createGeometryBuffer(
+                        meshAttribute.dataSize, (void*)meshAttribute.data, bufferType);
+            }
+            if (meshAttribute.numComponents == 3 && (useProgrammableFetch && !programmableFetchUseAoS)) {
+                // vec3 problematic in std430 struct
+                const std::vector<glm::vec4> &vec4AttributeValues = preprocessedSubmesh.vec4Attributes.at(j);
+                attributeBuffer = Renderer->createGeometryBuffer(
+                        vec4AttributeValues.size()*sizeof(glm::vec4), (void*)vec4AttributeValues.data(), bufferType);
+            }
+
+            if (!useProgrammableFetch) {
+                if (meshAttribute.numComponents == 1) {
+                    // Importance criterion attributes are bound to location 3 and onwards in vertex shader
+                    renderData->addGeometryBufferOptional(
+                            attributeBuffer, meshAttribute.name.c_str(), meshAttribute.attributeFormat,
+                            meshAttribute.numComponents, 0, 0, 0, ATTRIB_CONVERSION_FLOAT_NORMALIZED);
+                } else {
+                    bool isNormalizedColor = (meshAttribute.name == "vertexColor");
+                    renderData->addGeometryBufferOptional(
+                            attributeBuffer, meshAttribute.name.c_str(), meshAttribute.attributeFormat,
+                            meshAttribute.numComponents, 0, 0, 0,
+                            isNormalizedColor ? ATTRIB_CONVERSION_FLOAT_NORMALIZED : ATTRIB_CONVERSION_FLOAT);
+                }
+                meshRenderer.shaderAttributeNames.insert(meshAttribute.name);
+            } else if (!programmableFetchUseAoS) {
+                int bindingPoint = -1;
+                if (meshAttribute.name == "vertexPosition") {
+                    bindingPoint = 2;
+                } else if (meshAttribute.name == "vertexLineTangent") {
+                    bindingPoint = 3;
+                } else if (boost::starts_with(meshAttribute.name, "vertexAttribute")) {
+                    bindingPoint = 4;
+                }
+                meshRenderer.ssboEntries.push_back(SSBOEntry(bindingPoint, meshAttribute.name, attributeBuffer));
+            }
+        }
+
+        // The importance criteria in the order of the file. The ones that were not loaded get an entry without values.
+        std::vector<std::string> importanceCriterionNames;
+        if (hasTableOfContents) {
+            for (const BinaryMeshSectionInfo &sectionInfo : tableOfContents.sections) {
+                if (sectionInfo.sectionType == BINMESH_SECTION_ATTRIBUTE && sectionInfo.submeshIndex == i
+                        && sectionInfo.numComponents == 1) {
+                    importanceCriterionNames.push_back(sectionInfo.name);
+                }
+            }
+        } else {
+            for (const ImportanceCriterionAttribute &attribute : preprocessedSubmesh.importanceCriterionAttributes) {
+                importanceCriterionNames.push_back(attribute.name);
+            }
+        }
+        for (const std::string &attributeName : importanceCriterionNames) {
+            auto it = std::find_if(preprocessedSubmesh.importanceCriterionAttributes.begin(),
+                    preprocessedSubmesh.importanceCriterionAttributes.end(),
+                    [&attributeName](const ImportanceCriterionAttribute &attribute) {
+                        return attribute.name == attributeName;
+                    });
+            if (it != preprocessedSubmesh.importanceCriterionAttributes.end()) {
+                meshRenderer.importanceCriterionAttributes.push_back(std::move(*it));
+            } else {
+                ImportanceCriterionAttribute importanceCriterionAttribute;
+                importanceCriterionAttribute.name = attributeName;
+                importanceCriterionAttribute.minAttribute = 0.0f;
+                importanceCriterionAttribute.maxAttribute = 0.0f;
+                meshRenderer.importanceCriterionAttributes.push_back(importanceCriterionAttribute);
+            }
+        }
+
+        if (preprocessedSubmesh.hasBoundingBox) {
+            totalBoundingBox.combine(preprocessedSubmesh.boundingBox);
+        }
+
+        if (useProgrammableFetch && programmableFetchUseAoS) {
+            for (size_t attributeIndex = 0; attributeIndex < preprocessedSubmesh.linePointData.size();
+                    attributeIndex++) {
+                const std::vector<LinePointData> &linePointData = preprocessedSubmesh.linePointData.at(attributeIndex);
+                if (linePointData.empty()) {
+                    continue;
+                }
+                GeometryBufferPtr attributeBuffer = Renderer->createGeometryBuffer(
+                        linePointData.size()*sizeof(LinePointData), (void*)linePointData.data(),
+                        SHADER_STORAGE_BUFFER);
+                meshRenderer.ssboEntries.push_back(SSBOEntry(2, "vertexAttribute" + sgl::toString(attributeIndex),
+                        attributeBuffer));
+            }
+        }
+
+        shaderAttributes.push_back(renderData);
+        materials.push_back(mesh.submeshes.at(i).material);
+    }
+
+    meshRenderer.boundingBox = totalBoundingBox;
+    meshRenderer.boundingSphere = sgl::Sphere(totalBoundingBox.getCenter(), glm::length(totalBoundingBox.getExtent()));
+
+    return meshRenderer;
+}
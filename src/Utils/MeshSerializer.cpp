@@ -6,87 +6,318 @@
  */
 
 #include <fstream>
+#include <cstring>
+#include <cassert>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
 #include <algorithm>
-#include <random>
 #include <chrono>
 #include <cmath>
 
-#include <boost/algorithm/string/predicate.hpp>
 #include <glm/glm.hpp>
 
 #include <Utils/Events/Stream/Stream.hpp>
 #include <Utils/File/Logfile.hpp>
 #include <Utils/Convert.hpp>
-#include <Graphics/Shader/ShaderManager.hpp>
 #include <Graphics/Shader/ShaderAttributes.hpp>
-#include <Graphics/Renderer.hpp>
 
-#include "ImportanceCriteria.hpp"
 #include "MeshSerializer.hpp"
 
 using namespace std;
 using namespace sgl;
 
-const uint32_t MESH_FORMAT_VERSION = 4u;
+const uint32_t BINMESH_MAGIC_NUMBER = 0x48534D42u; // "BMSH"
 
-void writeMesh3D(const std::string &filename, const BinaryMesh &mesh) {
-#ifndef __MINGW32__
-    std::ofstream file(filename.c_str(), std::ofstream::binary);
-    if (!file.is_open()) {
-        Logfile::get()->writeError(std::string() + "Error in writeMesh3D: File \"" + filename + "\" not found.");
+static inline uint64_t alignSectionOffset(uint64_t offset)
+{
+    return (offset + BINMESH_SECTION_ALIGNMENT - 1) / BINMESH_SECTION_ALIGNMENT * BINMESH_SECTION_ALIGNMENT;
+}
+
+static double getCurrentTimeSeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+BinaryMeshStreamWriter::BinaryMeshStreamWriter(size_t memoryCeiling)
+        : memoryCeiling(std::max(memoryCeiling, size_t(BINMESH_SECTION_ALIGNMENT))), file(nullptr), fileOffset(0),
+          ioError(false), flags(0), throughputMBs(0.0), startTime(0.0), currentSubmeshIndex(-1), sectionOpen(false)
+{
+    memset(&currentSection, 0, sizeof(BinaryMeshSectionEntry));
+}
+
+BinaryMeshStreamWriter::~BinaryMeshStreamWriter()
+{
+    if (file) {
+        abort();
+    }
+}
+
+bool BinaryMeshStreamWriter::open(const std::string &filename)
+{
+    if (file) {
+        abort();
+    }
+
+    this->filename = filename;
+    tempFilename = filename + ".tmp";
+    file = fopen(tempFilename.c_str(), "wb");
+    if (file == NULL) {
+        Logfile::get()->writeError(std::string() + "Error in BinaryMeshStreamWriter::open: Cannot create file \""
+                + tempFilename + "\".");
+        return false;
+    }
+
+    buffer.clear();
+    buffer.reserve(memoryCeiling);
+    sections.clear();
+    stringPool.clear();
+    fileOffset = 0;
+    ioError = false;
+    flags = 0;
+    currentSubmeshIndex = -1;
+    sectionOpen = false;
+    startTime = getCurrentTimeSeconds();
+
+    // Reserve space for the header. It is written in finish when the position of the section table is known.
+    BinaryMeshFileHeader header;
+    memset(&header, 0, sizeof(BinaryMeshFileHeader));
+    writeBytes(&header, sizeof(BinaryMeshFileHeader));
+    return true;
+}
+
+void BinaryMeshStreamWriter::flushBuffer()
+{
+    if (!buffer.empty()) {
+        if (fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+            ioError = true;
+        }
+        buffer.clear();
+    }
+}
+
+void BinaryMeshStreamWriter::writeBytes(const void *data, size_t dataSize)
+{
+    const uint8_t *bytes = (const uint8_t*)data;
+    fileOffset += dataSize;
+
+    if (buffer.size() + dataSize <= memoryCeiling) {
+        buffer.insert(buffer.end(), bytes, bytes + dataSize);
         return;
     }
- #else
-    FILE *fileptr = fopen(filename.c_str(), "wb");
-    if (fileptr == NULL) {
-        Logfile::get()->writeError(std::string() + "Error in writeMesh3D: File \"" + filename + "\" not found.");
+
+    // Too large for the buffer: Write the buffered data, then stream the passed data in bounded chunks.
+    flushBuffer();
+    while (dataSize >= memoryCeiling) {
+        if (fwrite(bytes, 1, memoryCeiling, file) != memoryCeiling) {
+            ioError = true;
+        }
+        bytes += memoryCeiling;
+        dataSize -= memoryCeiling;
+    }
+    buffer.insert(buffer.end(), bytes, bytes + dataSize);
+}
+
+void BinaryMeshStreamWriter::writePadding()
+{
+    const uint8_t paddingBytes[BINMESH_SECTION_ALIGNMENT] = { 0 };
+    writeBytes(paddingBytes, alignSectionOffset(fileOffset) - fileOffset);
+}
+
+void BinaryMeshStreamWriter::beginSubmesh(const ObjMaterial &material, sgl::VertexMode vertexMode)
+{
+    assert(file && !sectionOpen);
+    currentSubmeshIndex++;
+    uint32_t vertexModeUint = (uint32_t)vertexMode;
+    beginSection(BINMESH_SECTION_SUBMESH_INFO, "", sgl::ATTRIB_UNSIGNED_INT, 0);
+    appendSectionData(&material, sizeof(ObjMaterial));
+    appendSectionData(&vertexModeUint, sizeof(uint32_t));
+    endSection();
+}
+
+void BinaryMeshStreamWriter::beginSection(BinaryMeshSectionType sectionType, const std::string &name,
+        sgl::VertexAttributeFormat attributeFormat, uint32_t numComponents)
+{
+    assert(file && !sectionOpen && currentSubmeshIndex >= 0);
+    writePadding();
+
+    memset(&currentSection, 0, sizeof(BinaryMeshSectionEntry));
+    currentSection.sectionType = sectionType;
+    currentSection.submeshIndex = (uint32_t)currentSubmeshIndex;
+    currentSection.attributeFormat = attributeFormat;
+    currentSection.numComponents = numComponents;
+    currentSection.nameOffset = (uint32_t)stringPool.size();
+    currentSection.nameLength = (uint32_t)name.size();
+    currentSection.dataOffset = fileOffset;
+    stringPool += name;
+    sectionHasher.reset();
+    sectionOpen = true;
+}
+
+void BinaryMeshStreamWriter::appendSectionData(const void *data, size_t dataSize)
+{
+    assert(sectionOpen);
+    if (dataSize == 0) {
         return;
     }
- #endif
+    sectionHasher.update(data, dataSize);
+    writeBytes(data, dataSize);
+}
 
-    sgl::BinaryWriteStream stream;
-    stream.write((uint32_t)MESH_FORMAT_VERSION);
-    stream.write((uint32_t)mesh.submeshes.size());
+void BinaryMeshStreamWriter::endSection()
+{
+    assert(sectionOpen);
+    currentSection.dataSize = fileOffset - currentSection.dataOffset;
+    currentSection.checksum = sectionHasher.digest();
+    sections.push_back(currentSection);
+    sectionOpen = false;
+}
 
-    for (const BinarySubMesh &submesh : mesh.submeshes) {
-        stream.write(submesh.material);
-        stream.write((uint32_t)submesh.vertexMode);
-        stream.writeArray(submesh.indices);
+void BinaryMeshStreamWriter::writeIndices(const uint32_t *indices, size_t numIndices)
+{
+    beginSection(BINMESH_SECTION_INDICES, "", sgl::ATTRIB_UNSIGNED_INT, 1);
+    appendSectionData(indices, numIndices * sizeof(uint32_t));
+    endSection();
+}
+
+void BinaryMeshStreamWriter::writeAttribute(const std::string &name, sgl::VertexAttributeFormat attributeFormat,
+        uint32_t numComponents, const void *data, size_t dataSize)
+{
+    beginSection(BINMESH_SECTION_ATTRIBUTE, name, attributeFormat, numComponents);
+    appendSectionData(data, dataSize);
+    endSection();
+}
+
+void BinaryMeshStreamWriter::writeUniform(const std::string &name, sgl::VertexAttributeFormat attributeFormat,
+        uint32_t numComponents, const void *data, size_t dataSize)
+{
+    beginSection(BINMESH_SECTION_UNIFORM, name, attributeFormat, numComponents);
+    appendSectionData(data, dataSize);
+    endSection();
+}
+
+void BinaryMeshStreamWriter::writeMeshlets(const BinaryMeshMeshlet *meshlets, size_t numMeshlets)
+{
+    beginSection(BINMESH_SECTION_MESHLETS);
+    appendSectionData(meshlets, numMeshlets * sizeof(BinaryMeshMeshlet));
+    endSection();
+}
+
+bool BinaryMeshStreamWriter::finish()
+{
+    assert(file && !sectionOpen);
+
+    // Section table (entries + string pool)
+    writePadding();
+    BinaryMeshFileHeader header;
+    memset(&header, 0, sizeof(BinaryMeshFileHeader));
+    header.version = MESH_FORMAT_VERSION;
+    header.magicNumber = BINMESH_MAGIC_NUMBER;
+    header.numSubmeshes = (uint32_t)(currentSubmeshIndex + 1);
+    header.numSections = (uint32_t)sections.size();
+    header.flags = flags;
+    header.sectionTableOffset = fileOffset;
+    header.sectionTableSize = sections.size() * sizeof(BinaryMeshSectionEntry) + stringPool.size();
+
+    XXHash64 tableHasher;
+    tableHasher.update(sections.data(), sections.size() * sizeof(BinaryMeshSectionEntry));
+    tableHasher.update(stringPool.data(), stringPool.size());
+    header.sectionTableChecksum = tableHasher.digest();
+    writeBytes(sections.data(), sections.size() * sizeof(BinaryMeshSectionEntry));
+    writeBytes(stringPool.data(), stringPool.size());
+    flushBuffer();
+
+    // Now that the position of the section table is known, the header can be written.
+    if (fseek(file, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(BinaryMeshFileHeader), 1, file) != 1) {
+        ioError = true;
+    }
+    if (fflush(file) != 0) {
+        ioError = true;
+    }
+#ifndef _WIN32
+    fsync(fileno(file));
+#endif
+    fclose(file);
+    file = nullptr;
+
+    if (ioError) {
+        Logfile::get()->writeError(std::string() + "Error in BinaryMeshStreamWriter::finish: Could not write file \""
+                + tempFilename + "\".");
+        remove(tempFilename.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    bool renamed = MoveFileExA(tempFilename.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    bool renamed = rename(tempFilename.c_str(), filename.c_str()) == 0;
+#endif
+    if (!renamed) {
+        Logfile::get()->writeError(std::string() + "Error in BinaryMeshStreamWriter::finish: Could not rename \""
+                + tempFilename + "\" to \"" + filename + "\".");
+        remove(tempFilename.c_str());
+        return false;
+    }
+
+    double elapsedSeconds = std::max(getCurrentTimeSeconds() - startTime, 1e-9);
+    double sizeMB = fileOffset / 1024.0 / 1024.0;
+    throughputMBs = sizeMB / elapsedSeconds;
+    Logfile::get()->writeInfo(std::string() + "Wrote " + sgl::toString(sizeMB) + " MB to \"" + filename + "\" in "
+            + sgl::toString(elapsedSeconds) + "s (" + sgl::toString(throughputMBs) + " MB/s).");
+    return true;
+}
+
+void BinaryMeshStreamWriter::abort()
+{
+    if (file) {
+        fclose(file);
+        file = nullptr;
+        remove(tempFilename.c_str());
+    }
+    buffer.clear();
+    sections.clear();
+    stringPool.clear();
+    sectionOpen = false;
+}
+
+bool writeMesh3D(const std::string &filename, const BinaryMesh &mesh, size_t memoryCeiling) {
+    BinaryMeshStreamWriter writer(memoryCeiling);
+    if (!writer.open(filename)) {
+        return false;
+    }
 
-        // Write attributes
-        stream.write((uint32_t)submesh.attributes.size());
+    for (const BinarySubMesh &submesh : mesh.submeshes) {
+        writer.beginSubmesh(submesh.material, submesh.vertexMode);
+        writer.writeIndices(submesh.indices.data(), submesh.indices.size());
         for (const BinaryMeshAttribute &attribute : submesh.attributes) {
-            stream.write(attribute.name);
-            stream.write((uint32_t)attribute.attributeFormat);
-            stream.write((uint32_t)attribute.numComponents);
-            stream.writeArray(attribute.data);
+            writer.writeAttribute(attribute.name, attribute.attributeFormat, attribute.numComponents,
+                    attribute.data.data(), attribute.data.size());
         }
-
-        // Write uniforms
-        stream.write((uint32_t)submesh.uniforms.size());
         for (const BinaryMeshUniform &uniform : submesh.uniforms) {
-            stream.write(uniform.name);
-            stream.write((uint32_t)uniform.attributeFormat);
-            stream.write((uint32_t)uniform.numComponents);
-            stream.writeArray(uniform.data);
+            writer.writeUniform(uniform.name, uniform.attributeFormat, uniform.numComponents,
+                    uniform.data.data(), uniform.data.size());
+        }
+        if (!submesh.meshlets.empty()) {
+            writer.writeMeshlets(submesh.meshlets.data(), submesh.meshlets.size());
         }
     }
 
-#ifndef __MINGW32__
-    file.write((const char*)stream.getBuffer(), stream.getSize());
-    file.close();
-#else
-    fwrite((const void*)stream.getBuffer(), stream.getSize(), 1, fileptr);
-    fclose(fileptr);
-#endif
+    return writer.finish();
 }
 
-void readMesh3D(const std::string &filename, BinaryMesh &mesh) {
+/**
+ * Reads a file in the old version 4 format, where all data was serialized sequentially using sgl::BinaryWriteStream.
+ */
+static bool readMesh3DVersion4(const std::string &filename, BinaryMesh &mesh) {
 #ifndef __MINGW32__
     std::ifstream file(filename.c_str(), std::ifstream::binary);
     if (!file.is_open()) {
         Logfile::get()->writeError(std::string() + "Error in readMesh3D: File \"" + filename + "\" not found.");
-        return;
+        return false;
     }
 
     file.seekg(0, file.end);
@@ -103,7 +334,7 @@ void readMesh3D(const std::string &filename, BinaryMesh &mesh) {
     FILE *fileptr = fopen(filename.c_str(), "rb");
     if (fileptr == NULL) {
         Logfile::get()->writeError(std::string() + "Error in readMesh3D: File \"" + filename + "\" not found.");
-        return;
+        return false;
     }
     fseeko64(fileptr, 0L, SEEK_END);
     size_t size = ftello64 (fileptr);
@@ -118,10 +349,10 @@ void readMesh3D(const std::string &filename, BinaryMesh &mesh) {
     sgl::BinaryReadStream stream(buffer, size);
     uint32_t version;
     stream.read(version);
-    if (version != MESH_FORMAT_VERSION) {
+    if (version != MESH_FORMAT_VERSION_LEGACY) {
         Logfile::get()->writeError(std::string() + "Error in readMesh3D: Invalid version in file \""
                 + filename + "\".");
-        return;
+        return false;
     }
 
     uint32_t numSubmeshes;
@@ -168,393 +399,579 @@ void readMesh3D(const std::string &filename, BinaryMesh &mesh) {
     }
 
     //delete[] buffer; // BinaryReadStream does deallocation
+    return true;
 }
 
+/**
+ * Validates the header and the section table of a version 5 file and decodes the names of the sections.
+ * Only the pages of the header and the section table are touched.
+ */
+static bool readSectionTable(const std::string &filename, const MappedFile &mappedFile, BinaryMeshFileHeader &header,
+        std::vector<BinaryMeshSectionEntry> &sections, std::vector<std::string> &sectionNames) {
+    const uint8_t *fileData = mappedFile.getData();
+    const size_t fileSize = mappedFile.getSize();
 
+    if (fileSize < sizeof(BinaryMeshFileHeader)) {
+        Logfile::get()->writeError(std::string() + "Error in readMesh3D: Truncated header in file \""
+                + filename + "\".");
+        return false;
+    }
+    memcpy(&header, fileData, sizeof(BinaryMeshFileHeader));
+    if (header.magicNumber != BINMESH_MAGIC_NUMBER
+            || header.sectionTableOffset + header.sectionTableSize > fileSize
+            || header.numSections * sizeof(BinaryMeshSectionEntry) > header.sectionTableSize) {
+        Logfile::get()->writeError(std::string() + "Error in readMesh3D: Invalid header in file \""
+                + filename + "\".");
+        return false;
+    }
 
+    const uint8_t *sectionTable = fileData + header.sectionTableOffset;
+    if (XXHash64::hash(sectionTable, header.sectionTableSize) != header.sectionTableChecksum) {
+        Logfile::get()->writeError(std::string() + "Error in readMesh3D: Corrupt section table in file \""
+                + filename + "\".");
+        return false;
+    }
 
-
-void MeshRenderer::render(sgl::ShaderProgramPtr passShader, bool isGBufferPass, int attributeIndex)
-{
-    if (useProgrammableFetch) {
-        for (SSBOEntry &ssboEntry : ssboEntries) {
-            if (ssboEntry.bindingPoint >= 0 && (!boost::starts_with(ssboEntry.attributeName, "vertexAttribute")
-                    || attributeIndex == sgl::fromString<int>(ssboEntry.attributeName.substr(15)))) {
-                sgl::ShaderManager->bindShaderStorageBuffer(ssboEntry.bindingPoint, ssboEntry.attributeBuffer);
-            }
-        }
+    const char *stringPool = (const char*)sectionTable + header.numSections * sizeof(BinaryMeshSectionEntry);
+    const size_t stringPoolSize = header.sectionTableSize - header.numSections * sizeof(BinaryMeshSectionEntry);
+    sections.resize(header.numSections);
+    if (header.numSections > 0) {
+        memcpy(&sections.front(), sectionTable, header.numSections * sizeof(BinaryMeshSectionEntry));
     }
 
-    for (size_t i = 0; i < shaderAttributes.size(); i++) {
-        //ShaderProgram *shader = shaderAttributes.at(i)->getShaderProgram();
-        if (!boost::starts_with(passShader->getShaderList().front()->getFileID(), "PseudoPhongVorticity")
-                && !boost::starts_with(passShader->getShaderList().front()->getFileID(), "DepthPeelingGatherDepthComplexity")
-                && !isGBufferPass) {
-            if (passShader->hasUniform("ambientColor")) {
-                passShader->setUniform("ambientColor", materials.at(i).ambientColor);
-            }
-            if (passShader->hasUniform("diffuseColor")) {
-                passShader->setUniform("diffuseColor", materials.at(i).diffuseColor);
-            }
-            if (passShader->hasUniform("specularColor")) {
-                passShader->setUniform("specularColor", materials.at(i).specularColor);
-            }
-            if (passShader->hasUniform("specularExponent")) {
-                passShader->setUniform("specularExponent", materials.at(i).specularExponent);
-            }
-            if (passShader->hasUniform("opacity")) {
-                passShader->setUniform("opacity", materials.at(i).opacity);
-            }
+    sectionNames.clear();
+    sectionNames.reserve(sections.size());
+    for (const BinaryMeshSectionEntry &entry : sections) {
+        if (entry.dataOffset + entry.dataSize > fileSize || entry.submeshIndex >= header.numSubmeshes
+                || size_t(entry.nameOffset) + entry.nameLength > stringPoolSize) {
+            Logfile::get()->writeError(std::string() + "Error in readMesh3D: Invalid section entry in file \""
+                    + filename + "\".");
+            return false;
         }
-        Renderer->render(shaderAttributes.at(i), passShader);
+        sectionNames.push_back(std::string(stringPool + entry.nameOffset, entry.nameLength));
     }
+    return true;
 }
 
-void MeshRenderer::setNewShader(sgl::ShaderProgramPtr newShader)
-{
-    for (size_t i = 0; i < shaderAttributes.size(); i++) {
-        shaderAttributes.at(i) = shaderAttributes.at(i)->copy(newShader, false);
+bool BinaryMeshSelection::containsSubmesh(uint32_t submeshIndex) const {
+    return submeshIndices.empty()
+            || std::find(submeshIndices.begin(), submeshIndices.end(), submeshIndex) != submeshIndices.end();
+}
+
+bool BinaryMeshSelection::containsAttribute(const std::string &name) const {
+    return attributeNames.empty()
+            || std::find(attributeNames.begin(), attributeNames.end(), name) != attributeNames.end();
+}
+
+bool BinaryMeshSelection::containsSection(uint32_t sectionType, uint32_t submeshIndex, const std::string &name) const {
+    if (!containsSubmesh(submeshIndex)) {
+        return false;
+    }
+    if (sectionType == BINMESH_SECTION_INDICES) {
+        return loadIndices;
+    }
+    if (sectionType == BINMESH_SECTION_ATTRIBUTE) {
+        return containsAttribute(name);
     }
+    return true;
 }
 
+bool readBinaryMeshTableOfContents(const std::string &filename, BinaryMeshTableOfContents &tableOfContents) {
+    MappedFile mappedFile;
+    if (!mappedFile.open(filename)) {
+        return false;
+    }
 
-sgl::AABB3 computeAABB(const std::vector<glm::vec3> &vertices)
-{
-    if (vertices.size() < 1) {
-        Logfile::get()->writeError("computeAABB: vertices.size() < 1");
-        return sgl::AABB3();
+    uint32_t version = 0;
+    if (mappedFile.getSize() >= sizeof(uint32_t)) {
+        memcpy(&version, mappedFile.getData(), sizeof(uint32_t));
+    }
+    if (version != MESH_FORMAT_VERSION) {
+        // Version 4 files have no section table.
+        return false;
     }
 
-    glm::vec3 minV = glm::vec3(FLT_MAX, FLT_MAX, FLT_MAX);
-    glm::vec3 maxV = glm::vec3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
-    for (const glm::vec3 &pt : vertices) {
-        minV.x = std::min(minV.x, pt.x);
-        minV.y = std::min(minV.y, pt.y);
-        minV.z = std::min(minV.z, pt.z);
-        maxV.x = std::max(maxV.x, pt.x);
-        maxV.y = std::max(maxV.y, pt.y);
-        maxV.z = std::max(maxV.z, pt.z);
+    BinaryMeshFileHeader header;
+    std::vector<BinaryMeshSectionEntry> sections;
+    std::vector<std::string> sectionNames;
+    if (!readSectionTable(filename, mappedFile, header, sections, sectionNames)) {
+        return false;
     }
 
-    return sgl::AABB3(minV, maxV);
+    tableOfContents.numSubmeshes = header.numSubmeshes;
+    tableOfContents.flags = header.flags;
+    tableOfContents.sections.resize(sections.size());
+    for (size_t i = 0; i < sections.size(); i++) {
+        const BinaryMeshSectionEntry &entry = sections.at(i);
+        BinaryMeshSectionInfo &sectionInfo = tableOfContents.sections.at(i);
+        sectionInfo.sectionType = (BinaryMeshSectionType)entry.sectionType;
+        sectionInfo.submeshIndex = entry.submeshIndex;
+        sectionInfo.name = sectionNames.at(i);
+        sectionInfo.attributeFormat = (sgl::VertexAttributeFormat)entry.attributeFormat;
+        sectionInfo.numComponents = entry.numComponents;
+        sectionInfo.dataSize = entry.dataSize;
+    }
+    return true;
+}
+
+bool MappedBinaryMesh::open(const std::string &filename, bool verifyChecksums) {
+    return open(filename, BinaryMeshSelection(), verifyChecksums);
 }
 
-std::vector<uint32_t> shuffleIndicesLines(const std::vector<uint32_t> &indices) {
-    size_t numSegments = indices.size() / 2;
-    std::vector<size_t> shuffleOffsets;
-    for (size_t i = 0; i < numSegments; i++) {
-        shuffleOffsets.push_back(i);
+bool MappedBinaryMesh::open(const std::string &filename, const BinaryMeshSelection &selection, bool verifyChecksums) {
+    close();
+
+    mappedFile = MappedFilePtr(new MappedFile);
+    if (!mappedFile->open(filename)) {
+        mappedFile = MappedFilePtr();
+        return false;
+    }
+
+    uint32_t version = 0;
+    if (mappedFile->getSize() >= sizeof(uint32_t)) {
+        memcpy(&version, mappedFile->getData(), sizeof(uint32_t));
     }
-    auto rng = std::default_random_engine{};
-    rng.seed(std::chrono::system_clock::now().time_since_epoch().count());
-    std::shuffle(std::begin(shuffleOffsets), std::end(shuffleOffsets), rng);
 
-    std::vector<uint32_t> shuffledIndices;
-    shuffledIndices.reserve(numSegments*2);
-    for (size_t i = 0; i < numSegments; i++) {
-        size_t lineIndex = shuffleOffsets.at(i);
-        shuffledIndices.push_back(indices.at(lineIndex*2));
-        shuffledIndices.push_back(indices.at(lineIndex*2+1));
+    bool success = false;
+    if (version == MESH_FORMAT_VERSION) {
+        success = openVersion5(filename, selection, verifyChecksums);
+    } else if (version == MESH_FORMAT_VERSION_LEGACY) {
+        mappedFile = MappedFilePtr();
+        success = openVersion4(filename, selection);
+    } else {
+        Logfile::get()->writeError(std::string() + "Error in readMesh3D: Invalid version in file \""
+                + filename + "\".");
     }
 
-    return shuffledIndices;
+    if (!success) {
+        close();
+    }
+    return success;
 }
 
-std::vector<uint32_t> shuffleLineOrder(const std::vector<uint32_t> &indices) {
-    size_t numSegments = indices.size() / 2;
+bool MappedBinaryMesh::openVersion5(const std::string &filename, const BinaryMeshSelection &selection,
+        bool verifyChecksums) {
+    const uint8_t *fileData = mappedFile->getData();
 
-    // 1. Compute list of all lines
-    std::vector<std::vector<uint32_t>> lines;
-    std::vector<uint32_t> currentLine;
-    for (size_t i = 0; i < numSegments; i++) {
-        uint32_t idx0 = indices.at(i*2);
-        uint32_t idx1 = indices.at(i*2+1);
+    BinaryMeshFileHeader header;
+    std::vector<BinaryMeshSectionEntry> allSections;
+    std::vector<std::string> allSectionNames;
+    if (!readSectionTable(filename, *mappedFile, header, allSections, allSectionNames)) {
+        return false;
+    }
 
-        // Start new line?
-        if (i > 0 && idx0 != indices.at((i-1)*2+1)) {
-            lines.push_back(currentLine);
-            currentLine.clear();
+    // Only the selected sections are exposed (and verified), i.e., the pages of the other sections are never touched.
+    std::vector<BinaryMeshSectionEntry> sections;
+    std::vector<std::string> sectionNames;
+    for (size_t i = 0; i < allSections.size(); i++) {
+        const BinaryMeshSectionEntry &entry = allSections.at(i);
+        if (selection.containsSection(entry.sectionType, entry.submeshIndex, allSectionNames.at(i))) {
+            sections.push_back(entry);
+            sectionNames.push_back(allSectionNames.at(i));
         }
-
-        // Add indices to line
-        currentLine.push_back(idx0);
-        currentLine.push_back(idx1);
     }
-    if (currentLine.size() > 0) {
-        lines.push_back(currentLine);
+
+    if (verifyChecksums) {
+        bool checksumsValid = true;
+        #pragma omp parallel for schedule(dynamic) reduction(&&:checksumsValid)
+        for (size_t i = 0; i < sections.size(); i++) {
+            const BinaryMeshSectionEntry &entry = sections.at(i);
+            checksumsValid = checksumsValid
+                    && XXHash64::hash(fileData + entry.dataOffset, entry.dataSize) == entry.checksum;
+        }
+        if (!checksumsValid) {
+            Logfile::get()->writeError(std::string() + "Error in readMesh3D: Checksum mismatch in file \""
+                    + filename + "\".");
+            return false;
+        }
     }
 
-    // 2. Shuffle line list
-    auto rng = std::default_random_engine{};
-    rng.seed(std::chrono::system_clock::now().time_since_epoch().count());
-    std::shuffle(std::begin(lines), std::end(lines), rng);
+    // Maps the submesh indices in the file to the indices in the submeshes array.
+    std::vector<int> submeshViewIndices(header.numSubmeshes, -1);
+    for (uint32_t i = 0; i < header.numSubmeshes; i++) {
+        if (selection.containsSubmesh(i)) {
+            submeshViewIndices.at(i) = int(submeshes.size());
+            submeshes.push_back(BinarySubMeshView());
+        }
+    }
+    for (BinarySubMeshView &submesh : submeshes) {
+        submesh.vertexMode = VERTEX_MODE_TRIANGLES;
+        submesh.indices = nullptr;
+        submesh.numIndices = 0;
+        submesh.meshlets = nullptr;
+        submesh.numMeshlets = 0;
+    }
+    for (size_t i = 0; i < sections.size(); i++) {
+        const BinaryMeshSectionEntry &entry = sections.at(i);
+        BinarySubMeshView &submesh = submeshes.at(submeshViewIndices.at(entry.submeshIndex));
+        const uint8_t *sectionData = entry.dataSize > 0 ? fileData + entry.dataOffset : nullptr;
+        // The range of a selected section is merged with the previous range if it directly follows it in the file.
+        // The table is in file order for converted files, but sections added by appendBinaryMeshAttributes are listed
+        // with their submesh while their data is stored at the end of the file, so they start a new range.
+        if (!sectionRanges.empty() && entry.dataOffset >= sectionRanges.back().first
+                && sectionRanges.back().first + sectionRanges.back().second + BINMESH_SECTION_ALIGNMENT
+                >= entry.dataOffset) {
+            sectionRanges.back().second = size_t(entry.dataOffset + entry.dataSize) - sectionRanges.back().first;
+        } else {
+            sectionRanges.push_back(std::make_pair(size_t(entry.dataOffset), size_t(entry.dataSize)));
+        }
 
-    // 3. Reconstruct line list from shuffled lines
-    std::vector<uint32_t> shuffledIndices;
-    shuffledIndices.reserve(indices.size());
-    for (const std::vector<uint32_t> &line : lines) {
-        for (uint32_t idx : line) {
-            shuffledIndices.push_back(idx);
+        if (entry.sectionType == BINMESH_SECTION_SUBMESH_INFO) {
+            if (entry.dataSize != sizeof(ObjMaterial) + sizeof(uint32_t)) {
+                Logfile::get()->writeError(std::string() + "Error in readMesh3D: Invalid submesh info in file \""
+                        + filename + "\".");
+                return false;
+            }
+            uint32_t vertexMode;
+            memcpy(&submesh.material, sectionData, sizeof(ObjMaterial));
+            memcpy(&vertexMode, sectionData + sizeof(ObjMaterial), sizeof(uint32_t));
+            submesh.vertexMode = (sgl::VertexMode)vertexMode;
+        } else if (entry.sectionType == BINMESH_SECTION_INDICES) {
+            submesh.indices = (const uint32_t*)sectionData;
+            submesh.numIndices = entry.dataSize / sizeof(uint32_t);
+        } else if (entry.sectionType == BINMESH_SECTION_ATTRIBUTE || entry.sectionType == BINMESH_SECTION_UNIFORM) {
+            BinaryMeshAttributeView view;
+            view.name = sectionNames.at(i);
+            view.attributeFormat = (sgl::VertexAttributeFormat)entry.attributeFormat;
+            view.numComponents = entry.numComponents;
+            view.data = sectionData;
+            view.dataSize = entry.dataSize;
+            if (entry.sectionType == BINMESH_SECTION_ATTRIBUTE) {
+                submesh.attributes.push_back(view);
+            } else {
+                submesh.uniforms.push_back(view);
+            }
+        } else if (entry.sectionType == BINMESH_SECTION_MESHLETS) {
+            if (entry.dataSize % sizeof(BinaryMeshMeshlet) != 0) {
+                Logfile::get()->writeError(std::string() + "Error in readMesh3D: Invalid meshlet section in file \""
+                        + filename + "\".");
+                return false;
+            }
+            submesh.meshlets = (const BinaryMeshMeshlet*)sectionData;
+            submesh.numMeshlets = entry.dataSize / sizeof(BinaryMeshMeshlet);
         }
+        // Unknown section types are skipped for forward compatibility.
     }
 
-    return shuffledIndices;
+    formatVersion = header.version;
+    flags = header.flags;
+    return true;
 }
 
-std::vector<uint32_t> shuffleIndicesTriangles(const std::vector<uint32_t> &indices) {
-    size_t numSegments = indices.size() / 3;
-    std::vector<size_t> shuffleOffsets;
-    for (size_t i = 0; i < numSegments; i++) {
-        shuffleOffsets.push_back(i);
+bool MappedBinaryMesh::openVersion4(const std::string &filename, const BinaryMeshSelection &selection) {
+    if (!readMesh3DVersion4(filename, legacyMesh)) {
+        return false;
     }
-    auto rng = std::default_random_engine{};
-    rng.seed(std::chrono::system_clock::now().time_since_epoch().count());
-    std::shuffle(std::begin(shuffleOffsets), std::end(shuffleOffsets), rng);
 
-    std::vector<uint32_t> shuffledIndices;
-    shuffledIndices.reserve(numSegments*3);
-    for (size_t i = 0; i < numSegments; i++) {
-        size_t lineIndex = shuffleOffsets.at(i);
-        shuffledIndices.push_back(indices.at(lineIndex*3));
-        shuffledIndices.push_back(indices.at(lineIndex*3+1));
-        shuffledIndices.push_back(indices.at(lineIndex*3+2));
+    // Version 4 files can only be read as a whole, so the selection is applied after reading the file.
+    std::vector<BinarySubMesh> selectedSubmeshes;
+    for (size_t i = 0; i < legacyMesh.submeshes.size(); i++) {
+        if (!selection.containsSubmesh(uint32_t(i))) {
+            continue;
+        }
+        BinarySubMesh &submesh = legacyMesh.submeshes.at(i);
+        if (!selection.loadIndices) {
+            submesh.indices.clear();
+        }
+        std::vector<BinaryMeshAttribute> selectedAttributes;
+        for (BinaryMeshAttribute &attribute : submesh.attributes) {
+            if (selection.containsAttribute(attribute.name)) {
+                selectedAttributes.push_back(std::move(attribute));
+            }
+        }
+        submesh.attributes.swap(selectedAttributes);
+        selectedSubmeshes.push_back(std::move(submesh));
+    }
+    legacyMesh.submeshes.swap(selectedSubmeshes);
+
+    auto createView = [](const std::string &name, sgl::VertexAttributeFormat attributeFormat,
+            uint32_t numComponents, const std::vector<uint8_t> &data) {
+        BinaryMeshAttributeView view;
+        view.name = name;
+        view.attributeFormat = attributeFormat;
+        view.numComponents = numComponents;
+        view.data = data.empty() ? nullptr : data.data();
+        view.dataSize = data.size();
+        return view;
+    };
+
+    submeshes.resize(legacyMesh.submeshes.size());
+    for (size_t i = 0; i < legacyMesh.submeshes.size(); i++) {
+        const BinarySubMesh &submesh = legacyMesh.submeshes.at(i);
+        BinarySubMeshView &submeshView = submeshes.at(i);
+        submeshView.material = submesh.material;
+        submeshView.vertexMode = submesh.vertexMode;
+        submeshView.indices = submesh.indices.empty() ? nullptr : submesh.indices.data();
+        submeshView.numIndices = submesh.indices.size();
+        for (const BinaryMeshAttribute &attribute : submesh.attributes) {
+            submeshView.attributes.push_back(createView(
+                    attribute.name, attribute.attributeFormat, attribute.numComponents, attribute.data));
+        }
+        for (const BinaryMeshUniform &uniform : submesh.uniforms) {
+            submeshView.uniforms.push_back(createView(
+                    uniform.name, uniform.attributeFormat, uniform.numComponents, uniform.data));
+        }
     }
 
-    return shuffledIndices;
+    formatVersion = MESH_FORMAT_VERSION_LEGACY;
+    return true;
 }
 
+void MappedBinaryMesh::prefetch() const {
+    if (!mappedFile) {
+        return;
+    }
+    for (const std::pair<size_t, size_t> &sectionRange : sectionRanges) {
+        mappedFile->prefetch(sectionRange.first, sectionRange.second);
+    }
+}
 
-struct LinePointData
-{
-    glm::vec3 vertexPosition;
-    float vertexAttribute;
-    glm::vec3 vertexTangent;
-    float padding;
-};
-
-MeshRenderer parseMesh3D(const std::string &filename, sgl::ShaderProgramPtr shader, bool shuffleData,
-        bool useProgrammableFetch, bool programmableFetchUseAoS, float lineRadius)
-{
-    MeshRenderer meshRenderer(useProgrammableFetch);
-    BinaryMesh mesh;
-    readMesh3D(filename, mesh);
+void MappedBinaryMesh::close() {
+    submeshes.clear();
+    sectionRanges.clear();
+    legacyMesh.submeshes.clear();
+    mappedFile = MappedFilePtr();
+    formatVersion = 0;
+    flags = 0;
+}
 
-    if (!shader) {
-        shader = ShaderManager->getShaderProgram({"PseudoPhong.Vertex", "PseudoPhong.Fragment"});
+void MappedBinaryMesh::copyTo(BinaryMesh &mesh) const {
+    if (formatVersion == MESH_FORMAT_VERSION_LEGACY) {
+        mesh = legacyMesh;
+        return;
     }
 
-    std::vector<sgl::ShaderAttributesPtr> &shaderAttributes = meshRenderer.shaderAttributes;
-    std::vector<ObjMaterial> &materials = meshRenderer.materials;
-    shaderAttributes.reserve(mesh.submeshes.size());
-    materials.reserve(mesh.submeshes.size());
+    mesh.submeshes.resize(submeshes.size());
+    for (size_t i = 0; i < submeshes.size(); i++) {
+        const BinarySubMeshView &submeshView = submeshes.at(i);
+        BinarySubMesh &submesh = mesh.submeshes.at(i);
+        submesh.material = submeshView.material;
+        submesh.vertexMode = submeshView.vertexMode;
+        submesh.indices.assign(submeshView.indices, submeshView.indices + submeshView.numIndices);
 
-    // Bounding box of all submeshes combined
-    AABB3 totalBoundingBox(glm::vec3(FLT_MAX, FLT_MAX, FLT_MAX), glm::vec3(-FLT_MAX, -FLT_MAX, -FLT_MAX));
+        submesh.attributes.resize(submeshView.attributes.size());
+        for (size_t j = 0; j < submeshView.attributes.size(); j++) {
+            const BinaryMeshAttributeView &view = submeshView.attributes.at(j);
+            BinaryMeshAttribute &attribute = submesh.attributes.at(j);
+            attribute.name = view.name;
+            attribute.attributeFormat = view.attributeFormat;
+            attribute.numComponents = view.numComponents;
+            attribute.data.assign(view.data, view.data + view.dataSize);
+        }
 
-    // Importance criterion attributes are bound to location 3 and onwards in vertex shader
-    //int importanceCriterionLocationCounter = 3;
+        submesh.uniforms.resize(submeshView.uniforms.size());
+        for (size_t j = 0; j < submeshView.uniforms.size(); j++) {
+            const BinaryMeshAttributeView &view = submeshView.uniforms.at(j);
+            BinaryMeshUniform &uniform = submesh.uniforms.at(j);
+            uniform.name = view.name;
+            uniform.attributeFormat = view.attributeFormat;
+            uniform.numComponents = view.numComponents;
+            uniform.data.assign(view.data, view.data + view.dataSize);
+        }
 
+        submesh.meshlets.assign(submeshView.meshlets, submeshView.meshlets + submeshView.numMeshlets);
+    }
+}
 
-    // Iterate over all submeshes and create rendering data
-    for (size_t i = 0; i < mesh.submeshes.size(); i++) {
-        BinarySubMesh &submesh = mesh.submeshes.at(i);
-        ShaderAttributesPtr renderData = ShaderManager->createShaderAttributes(shader);
-        if (!useProgrammableFetch) {
-            renderData->setVertexMode(submesh.vertexMode);
-        } else {
-            renderData->setVertexMode(VERTEX_MODE_TRIANGLES);
-        }
+bool readMesh3D(const std::string &filename, BinaryMesh &mesh) {
+    // All data is copied anyway, so the checksums of all sections are validated as well.
+    MappedBinaryMesh mappedMesh;
+    if (!mappedMesh.open(filename, true)) {
+        return false;
+    }
+    mappedMesh.copyTo(mesh);
+    return true;
+}
 
-        if (submesh.indices.size() > 0 && !useProgrammableFetch) {
-            if (shuffleData && (submesh.vertexMode == VERTEX_MODE_LINES || submesh.vertexMode == VERTEX_MODE_TRIANGLES)) {
-                std::vector<uint32_t> shuffledIndices;
-                if (submesh.vertexMode == VERTEX_MODE_LINES) {
-                    //shuffledIndices = shuffleIndicesLines(submesh.indices);
-                    shuffledIndices = shuffleLineOrder(submesh.indices);
-                } else if (submesh.vertexMode == VERTEX_MODE_TRIANGLES) {
-                    shuffledIndices = shuffleIndicesTriangles(submesh.indices);
-                } else {
-                    Logfile::get()->writeError("ERROR in parseMesh3D: shuffleData and unsupported vertex mode!");
-                    shuffledIndices = submesh.indices;
-                }
-                GeometryBufferPtr indexBuffer = Renderer->createGeometryBuffer(
-                        sizeof(uint32_t)*shuffledIndices.size(), (void*)&shuffledIndices.front(), INDEX_BUFFER);
-                renderData->setIndexGeometryBuffer(indexBuffer, ATTRIB_UNSIGNED_INT);
-            } else {
-                GeometryBufferPtr indexBuffer = Renderer->createGeometryBuffer(
-                        sizeof(uint32_t)*submesh.indices.size(), (void*)&submesh.indices.front(), INDEX_BUFFER);
-                renderData->setIndexGeometryBuffer(indexBuffer, ATTRIB_UNSIGNED_INT);
-            }
-        }
-        if (submesh.indices.size() > 0 && useProgrammableFetch) {
-            // Modify indices
-            std::vector<uint32_t> fetchIndices;
-            fetchIndices.reserve(submesh.indices.size()*3);
-            // Iterate over all line segments
-            for (size_t i = 0; i < submesh.indices.size(); i += 2) {
-                uint32_t base0 = submesh.indices.at(i)*2;
-                uint32_t base1 = submesh.indices.at(i+1)*2;
-                // 0,2,3,0,3,1
-                fetchIndices.push_back(base0);
-                fetchIndices.push_back(base1);
-                fetchIndices.push_back(base1+1);
-                fetchIndices.push_back(base0);
-                fetchIndices.push_back(base1+1);
-                fetchIndices.push_back(base0+1);
-            }
-            GeometryBufferPtr indexBuffer = Renderer->createGeometryBuffer(
-                    sizeof(uint32_t)*fetchIndices.size(), (void*)&fetchIndices.front(), INDEX_BUFFER);
-            renderData->setIndexGeometryBuffer(indexBuffer, ATTRIB_UNSIGNED_INT);
-        }
+/// @return The size of one component of the passed attribute format in bytes.
+static size_t getAttributeFormatSize(sgl::VertexAttributeFormat attributeFormat) {
+    switch (attributeFormat) {
+        case ATTRIB_BYTE:
+        case ATTRIB_UNSIGNED_BYTE:
+            return 1;
+        case ATTRIB_SHORT:
+        case ATTRIB_UNSIGNED_SHORT:
+        case ATTRIB_HALF_FLOAT:
+            return 2;
+        case ATTRIB_DOUBLE:
+            return 8;
+        default:
+            return 4;
+    }
+}
 
-        // For programmableFetchUseAoS
-        std::vector<glm::vec3> vertexPositionData;
-        std::vector<std::vector<float>> vertexAttributeData;
-        std::vector<glm::vec3> vertexTangentData;
-
-        for (size_t j = 0; j < submesh.attributes.size(); j++) {
-            BinaryMeshAttribute &meshAttribute = submesh.attributes.at(j);
-            GeometryBufferPtr attributeBuffer;
-
-            // Assume only one component means importance criterion like vorticity, line width, ...
-            if (meshAttribute.numComponents == 1) {
-                ImportanceCriterionAttribute importanceCriterionAttribute;
-                importanceCriterionAttribute.name = meshAttribute.name;
-
-                // Copy values to mesh renderer data structure
-                uint16_t *attributeValuesUnorm = (uint16_t*)&meshAttribute.data.front();
-                size_t numAttributeValues = meshAttribute.data.size() / sizeof(uint16_t);
-                unpackUnorm16Array(attributeValuesUnorm, numAttributeValues, importanceCriterionAttribute.attributes);
-
-                // Compute minimum and maximum value
-                float minValue = FLT_MAX, maxValue = 0.0f;
-                #pragma omp parallel for reduction(min:minValue) reduction(max:maxValue)
-                for (size_t k = 0; k < numAttributeValues; k++) {
-                    minValue = std::min(minValue, importanceCriterionAttribute.attributes[k]);
-                    maxValue = std::max(maxValue, importanceCriterionAttribute.attributes[k]);
-                }
-                importanceCriterionAttribute.minAttribute = minValue;
-                importanceCriterionAttribute.maxAttribute = maxValue;
-
-                meshRenderer.importanceCriterionAttributes.push_back(importanceCriterionAttribute);
-
-                // SSBOs can't directly perform process uint16_t -> float :(
-                if (useProgrammableFetch && !programmableFetchUseAoS) {
-                    attributeBuffer = Renderer->createGeometryBuffer(
-                            numAttributeValues*sizeof(float), (void*)&importanceCriterionAttribute.attributes.front(),
-                            SHADER_STORAGE_BUFFER);
-                } else if (useProgrammableFetch) {
-                    int attributeIndex = sgl::fromString<int>(meshAttribute.name.substr(15));
-                    if (attributeIndex >= vertexAttributeData.size()) {
-                        vertexAttributeData.resize(attributeIndex+1);
-                    }
-                    vertexAttributeData.at(attributeIndex).resize(numAttributeValues);
-                    for (size_t k = 0; k < numAttributeValues; k++) {
-                        vertexAttributeData.at(attributeIndex).at(k) = importanceCriterionAttribute.attributes[k];
-                    }
-                }
-            }
+/// @return The number of vertices of the attribute, or 0 if its size is no multiple of the size of one vertex.
+static size_t getAttributeNumVertices(sgl::VertexAttributeFormat attributeFormat, uint32_t numComponents,
+        uint64_t dataSize) {
+    size_t vertexSize = getAttributeFormatSize(attributeFormat) * numComponents;
+    if (vertexSize == 0 || dataSize % vertexSize != 0) {
+        return 0;
+    }
+    return size_t(dataSize / vertexSize);
+}
 
-            BufferType bufferType = useProgrammableFetch ? SHADER_STORAGE_BUFFER : VERTEX_BUFFER;
+bool appendBinaryMeshAttributes(const std::string &filename,
+        const std::vector<BinaryMeshAppendedAttribute> &attributes) {
+    BinaryMeshFileHeader header;
+    std::vector<BinaryMeshSectionEntry> sections;
+    std::vector<std::string> sectionNames;
+    std::string stringPool;
+    uint64_t fileSize = 0;
+    {
+        // Only the pages of the header and the section table are touched.
+        MappedFile mappedFile;
+        if (!mappedFile.open(filename)) {
+            return false;
+        }
+        uint32_t version = 0;
+        if (mappedFile.getSize() >= sizeof(uint32_t)) {
+            memcpy(&version, mappedFile.getData(), sizeof(uint32_t));
+        }
+        if (version != MESH_FORMAT_VERSION) {
+            Logfile::get()->writeError(std::string() + "Error in appendBinaryMeshAttributes: Only format version 5 "
+                    + "files can be appended to (file \"" + filename + "\").");
+            return false;
+        }
+        if (!readSectionTable(filename, mappedFile, header, sections, sectionNames)) {
+            return false;
+        }
+        const size_t sectionEntriesSize = header.numSections * sizeof(BinaryMeshSectionEntry);
+        stringPool.assign((const char*)mappedFile.getData() + header.sectionTableOffset + sectionEntriesSize,
+                size_t(header.sectionTableSize - sectionEntriesSize));
+        fileSize = mappedFile.getSize();
+    }
 
-            if (!(useProgrammableFetch && programmableFetchUseAoS)
-                && !(meshAttribute.numComponents == 1 && useProgrammableFetch)
-                && !(meshAttribute.numComponents == 3 && useProgrammableFetch)) {
-                attributeBuffer = Renderer->createGeometryBuffer(
-                        meshAttribute.data.size(), (void*)&meshAttribute.data.front(), bufferType);
+    // Validate all attributes before the file is modified.
+    for (size_t i = 0; i < attributes.size(); i++) {
+        const BinaryMeshAppendedAttribute &appendedAttribute = attributes.at(i);
+        const BinaryMeshAttributeView &attribute = appendedAttribute.attribute;
+        std::string errorString;
+        bool hasName = false, hasVertexPositions = false;
+        size_t numVertices = 0;
+        for (size_t j = 0; j < sections.size(); j++) {
+            const BinaryMeshSectionEntry &entry = sections.at(j);
+            if (entry.submeshIndex != appendedAttribute.submeshIndex
+                    || entry.sectionType != BINMESH_SECTION_ATTRIBUTE) {
+                continue;
             }
-            if (meshAttribute.numComponents == 3 && (useProgrammableFetch && !programmableFetchUseAoS)) {
-                // vec3 problematic in std430 struct
-                glm::vec3 *attributeValues = (glm::vec3*)&meshAttribute.data.front();
-                size_t numAttributeValues = meshAttribute.data.size() / sizeof(glm::vec3);
-                std::vector<glm::vec4> vec4AttributeValues;
-                vec4AttributeValues.reserve(numAttributeValues);
-                for (size_t i = 0; i < numAttributeValues; i++) {
-                    glm::vec3 vec3Value = attributeValues[i];
-                    vec4AttributeValues.push_back(glm::vec4(vec3Value.x, vec3Value.y, vec3Value.z, 1.0f));
-                }
-                attributeBuffer = Renderer->createGeometryBuffer(
-                        vec4AttributeValues.size()*sizeof(glm::vec4), (void*)&vec4AttributeValues.front(), bufferType);
-            }
-
-            if (!useProgrammableFetch) {
-                if (meshAttribute.numComponents == 1) {
-                    // Importance criterion attributes are bound to location 3 and onwards in vertex shader
-                    renderData->addGeometryBufferOptional(
-                            attributeBuffer, meshAttribute.name.c_str(), meshAttribute.attributeFormat,
-                            meshAttribute.numComponents, 0, 0, 0, ATTRIB_CONVERSION_FLOAT_NORMALIZED);
-                } else {
-                    bool isNormalizedColor = (meshAttribute.name == "vertexColor");
-                    renderData->addGeometryBufferOptional(
-                            attributeBuffer, meshAttribute.name.c_str(), meshAttribute.attributeFormat,
-                            meshAttribute.numComponents, 0, 0, 0,
-                            isNormalizedColor ? ATTRIB_CONVERSION_FLOAT_NORMALIZED : ATTRIB_CONVERSION_FLOAT);
-                }
-                meshRenderer.shaderAttributeNames.insert(meshAttribute.name);
-            } else {
-                if (programmableFetchUseAoS) {
-                    if (meshAttribute.name == "vertexPosition") {
-                        glm::vec3 *attributeValues = (glm::vec3*)&meshAttribute.data.front();
-                        size_t numAttributeValues = meshAttribute.data.size() / sizeof(glm::vec3);
-                        vertexPositionData.reserve(numAttributeValues);
-                        for (size_t i = 0; i < numAttributeValues; i++) {
-                            vertexPositionData.push_back(attributeValues[i]);
-                        }
-                    } else if (meshAttribute.name == "vertexLineTangent") {
-                        glm::vec3 *attributeValues = (glm::vec3*)&meshAttribute.data.front();
-                        size_t numAttributeValues = meshAttribute.data.size() / sizeof(glm::vec3);
-                        vertexTangentData.reserve(numAttributeValues);
-                        for (size_t i = 0; i < numAttributeValues; i++) {
-                            vertexTangentData.push_back(attributeValues[i]);
-                        }
-                    }
-                } else {
-                    int bindingPoint = -1;
-                    if (meshAttribute.name == "vertexPosition") {
-                        bindingPoint = 2;
-                    } else if (meshAttribute.name == "vertexLineTangent") {
-                        bindingPoint = 3;
-                    } else if (boost::starts_with(meshAttribute.name, "vertexAttribute")) {
-                        bindingPoint = 4;
-                    }
-                    meshRenderer.ssboEntries.push_back(SSBOEntry(bindingPoint, meshAttribute.name, attributeBuffer));
-                }
+            hasName = hasName || sectionNames.at(j) == attribute.name;
+            if (sectionNames.at(j) == "vertexPosition") {
+                hasVertexPositions = true;
+                numVertices = getAttributeNumVertices(
+                        (sgl::VertexAttributeFormat)entry.attributeFormat, entry.numComponents, entry.dataSize);
             }
+        }
+        for (size_t j = 0; j < i; j++) {
+            hasName = hasName || (attributes.at(j).submeshIndex == appendedAttribute.submeshIndex
+                    && attributes.at(j).attribute.name == attribute.name);
+        }
 
-            if (meshAttribute.name == "vertexPosition") {
-                std::vector<glm::vec3> vertices;
-                vertices.resize(meshAttribute.data.size() / sizeof(glm::vec3));
-                memcpy(&vertices.front(), &meshAttribute.data.front(), meshAttribute.data.size());
-                totalBoundingBox.combine(computeAABB(vertices));
-            }
+        if (appendedAttribute.submeshIndex >= header.numSubmeshes) {
+            errorString = "The submesh " + sgl::toString(appendedAttribute.submeshIndex) + " doesn't exist";
+        } else if (hasName) {
+            errorString = "The submesh " + sgl::toString(appendedAttribute.submeshIndex)
+                    + " already has an attribute \"" + attribute.name + "\"";
+        } else if (!hasVertexPositions) {
+            errorString = "The submesh " + sgl::toString(appendedAttribute.submeshIndex)
+                    + " has no attribute \"vertexPosition\" to compare the number of vertices with";
+        } else if (getAttributeNumVertices(attribute.attributeFormat, attribute.numComponents, attribute.dataSize)
+                != numVertices) {
+            errorString = "The number of vertices of the attribute \"" + attribute.name
+                    + "\" doesn't match the vertex positions of the submesh";
+        }
+        if (!errorString.empty()) {
+            Logfile::get()->writeError(std::string() + "Error in appendBinaryMeshAttributes: " + errorString
+                    + " (file \"" + filename + "\").");
+            return false;
         }
+    }
+    if (attributes.empty()) {
+        return true;
+    }
+
+    FILE *file = fopen(filename.c_str(), "r+b");
+    if (!file) {
+        Logfile::get()->writeError(std::string() + "Error in appendBinaryMeshAttributes: Could not open file \""
+                + filename + "\" for writing.");
+        return false;
+    }
 
-        if (useProgrammableFetch && programmableFetchUseAoS) {
-            for (size_t attributeIndex = 0; attributeIndex < vertexAttributeData.size(); attributeIndex++) {
-                std::vector<LinePointData> linePointData;
-                linePointData.resize(vertexPositionData.size());
-
-                for (size_t i = 0; i < vertexPositionData.size(); i++) {
-                    linePointData.at(i).vertexPosition = vertexPositionData.at(i);
-                    linePointData.at(i).vertexAttribute = vertexAttributeData.at(attributeIndex).at(i);
-                    linePointData.at(i).vertexTangent = vertexTangentData.at(i);
-                    linePointData.at(i).padding = 0.0f;
-                }
-
-                GeometryBufferPtr attributeBuffer = Renderer->createGeometryBuffer(
-                        linePointData.size()*sizeof(LinePointData), (void*)&linePointData.front(),
-                        SHADER_STORAGE_BUFFER);
-                meshRenderer.ssboEntries.push_back(SSBOEntry(2, "vertexAttribute" + sgl::toString(attributeIndex),
-                        attributeBuffer));
+    // The new sections are written behind the end of the file (i.e., behind the old section table).
+    const uint8_t padding[BINMESH_SECTION_ALIGNMENT] = {};
+    bool ioError = fseek(file, 0, SEEK_END) != 0;
+    uint64_t fileOffset = fileSize;
+    auto writeData = [&](const void *data, size_t dataSize) {
+        if (!ioError && dataSize > 0 && fwrite(data, 1, dataSize, file) != dataSize) {
+            ioError = true;
+        }
+        fileOffset += dataSize;
+    };
+    auto writePadding = [&]() {
+        writeData(padding, size_t(alignSectionOffset(fileOffset) - fileOffset));
+    };
+
+    for (const BinaryMeshAppendedAttribute &appendedAttribute : attributes) {
+        const BinaryMeshAttributeView &attribute = appendedAttribute.attribute;
+        writePadding();
+        BinaryMeshSectionEntry entry;
+        memset(&entry, 0, sizeof(BinaryMeshSectionEntry));
+        entry.sectionType = BINMESH_SECTION_ATTRIBUTE;
+        entry.submeshIndex = appendedAttribute.submeshIndex;
+        entry.attributeFormat = (uint32_t)attribute.attributeFormat;
+        entry.numComponents = attribute.numComponents;
+        entry.nameOffset = (uint32_t)stringPool.size();
+        entry.nameLength = (uint32_t)attribute.name.size();
+        entry.dataOffset = fileOffset;
+        entry.dataSize = attribute.dataSize;
+        entry.checksum = XXHash64::hash(attribute.data, attribute.dataSize);
+        stringPool += attribute.name;
+        writeData(attribute.data, attribute.dataSize);
+
+        // Keep the order submesh info, indices, attributes, uniforms, meshlets of the sections of the submesh.
+        size_t insertionIndex = sections.size();
+        for (size_t i = 0; i < sections.size(); i++) {
+            const BinaryMeshSectionEntry &existingEntry = sections.at(i);
+            if (existingEntry.submeshIndex == entry.submeshIndex
+                    && existingEntry.sectionType <= BINMESH_SECTION_ATTRIBUTE) {
+                insertionIndex = i + 1;
             }
         }
-
-        shaderAttributes.push_back(renderData);
-        materials.push_back(mesh.submeshes.at(i).material);
+        sections.insert(sections.begin() + insertionIndex, entry);
     }
 
-    meshRenderer.boundingBox = totalBoundingBox;
-    meshRenderer.boundingSphere = sgl::Sphere(totalBoundingBox.getCenter(), glm::length(totalBoundingBox.getExtent()));
+    writePadding();
+    header.numSections = (uint32_t)sections.size();
+    header.sectionTableOffset = fileOffset;
+    header.sectionTableSize = sections.size() * sizeof(BinaryMeshSectionEntry) + stringPool.size();
+    XXHash64 tableHasher;
+    tableHasher.update(sections.data(), sections.size() * sizeof(BinaryMeshSectionEntry));
+    tableHasher.update(stringPool.data(), stringPool.size());
+    header.sectionTableChecksum = tableHasher.digest();
+    writeData(sections.data(), sections.size() * sizeof(BinaryMeshSectionEntry));
+    writeData(stringPool.data(), stringPool.size());
+
+    // The new data needs to be on disk before the header references it.
+    if (fflush(file) != 0) {
+        ioError = true;
+    }
+#ifndef _WIN32
+    fsync(fileno(file));
+#endif
+    if (!ioError && (fseek(file, 0, SEEK_SET) != 0
+            || fwrite(&header, sizeof(BinaryMeshFileHeader), 1, file) != 1 || fflush(file) != 0)) {
+        ioError = true;
+    }
+#ifndef _WIN32
+    fsync(fileno(file));
+#endif
+    fclose(file);
 
-    return meshRenderer;
+    if (ioError) {
+        Logfile::get()->writeError(std::string() + "Error in appendBinaryMeshAttributes: Could not write file \""
+                + filename + "\".");
+        return false;
+    }
+    Logfile::get()->writeInfo(std::string() + "Appended " + sgl::toString(attributes.size()) + " attribute(s) ("
+            + sgl::toString((fileOffset - fileSize) / 1024.0 / 1024.0) + " MB) to \"" + filename + "\".");
+    return true;
 }
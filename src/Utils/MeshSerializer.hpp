@@ -11,11 +11,18 @@
 #include <glm/glm.hpp>
 #include <vector>
 #include <set>
+#include <memory>
+#include <string>
+#include <utility>
+#include <cstdio>
 
 #include <Math/Geometry/AABB3.hpp>
 #include <Math/Geometry/Sphere.hpp>
 #include <Graphics/Shader/ShaderAttributes.hpp>
 
+#include "MappedFile.hpp"
+#include "Hash.hpp"
+
 /**
  * Parsing text-based mesh files, like .obj files, is really slow compared to binary formats.
  * The utility functions below serialize 3D mesh data to a file/read the data back from such a file.
@@ -86,6 +93,26 @@ struct BinaryMeshUniform
     std::vector<uint8_t> data;
 };
 
+/// Value of BinaryMeshMeshlet::normalCone.w for meshlets that can't be culled by their normals (e.g. lines).
+const float MESHLET_NO_NORMAL_CONE = 2.0f;
+
+/**
+ * A cluster of consecutive primitives of a submesh together with its bounds for culling on the CPU or GPU
+ * (see Meshlets.hpp). The layout matches std430, such that the array can be uploaded to a shader storage buffer as is.
+ */
+struct BinaryMeshMeshlet
+{
+    uint32_t indexOffset; // First index of the meshlet in the index buffer of the submesh
+    uint32_t indexCount;
+    float attributeMin, attributeMax; // Range of the attribute the meshlets were built for (normalized to [0,1])
+    glm::vec3 aabbMin;
+    float padding0;
+    glm::vec3 aabbMax;
+    float padding1;
+    glm::vec4 boundingSphere; // Center (xyz) and radius (w)
+    glm::vec4 normalCone; // Axis (xyz) and sine of the half opening angle (w; MESHLET_NO_NORMAL_CONE for no cone)
+};
+
 struct BinarySubMesh
 {
     ObjMaterial material;
@@ -93,6 +120,7 @@ struct BinarySubMesh
     std::vector<uint32_t> indices;
     std::vector<BinaryMeshAttribute> attributes;
     std::vector<BinaryMeshUniform> uniforms;
+    std::vector<BinaryMeshMeshlet> meshlets; // Optional
 };
 
 struct BinaryMesh
@@ -100,17 +128,296 @@ struct BinaryMesh
     std::vector<BinarySubMesh> submeshes;
 };
 
+/**
+ * File layout (format version 5):
+ *  - A BinaryMeshFileHeader at offset 0. The first four bytes store the format version in all versions of the format.
+ *  - The data sections. Each section starts at a multiple of BINMESH_SECTION_ALIGNMENT, such that the data can be
+ *    accessed in place after memory-mapping the file (e.g. as a glm::vec3 or uint32_t array).
+ *  - The section table at header.sectionTableOffset: header.numSections BinaryMeshSectionEntry objects followed by
+ *    a string pool storing the names of the attributes and uniforms.
+ * The sections of a submesh are stored in the order submesh info, indices, attributes, uniforms, meshlets.
+ * Every section and the section table store an XXH64 checksum of their content.
+ * Version 4 files (the mesh serialized sequentially using sgl::BinaryWriteStream) can still be read.
+ */
+const uint32_t MESH_FORMAT_VERSION = 5u;
+const uint32_t MESH_FORMAT_VERSION_LEGACY = 4u;
+const uint32_t BINMESH_SECTION_ALIGNMENT = 64u;
+/**
+ * Revision of the converters writing .binmesh files (e.g. convertTrajectoryDataToBinaryTriangleMesh). It needs to be
+ * incremented whenever the output for the same input changes (e.g. the vertex order or the computed importance
+ * criteria), such that converted meshes cached by an older build are not used anymore (see ConversionCache).
+ */
+const int MESH_CONVERTER_REVISION = 1;
+
+enum BinaryMeshSectionType {
+    BINMESH_SECTION_SUBMESH_INFO = 0, // ObjMaterial followed by the vertex mode (uint32_t)
+    BINMESH_SECTION_INDICES = 1,
+    BINMESH_SECTION_ATTRIBUTE = 2,
+    BINMESH_SECTION_UNIFORM = 3,
+    BINMESH_SECTION_MESHLETS = 4 // Array of BinaryMeshMeshlet (optional)
+};
+
+/// Bits of BinaryMeshFileHeader::flags describing how the converter ordered the primitives (see SpatialReordering).
+enum BinaryMeshFlags {
+    BINMESH_FLAG_MORTON_ORDER = 1u, // Lines/triangle clusters sorted along the Morton curve of their centroids
+    BINMESH_FLAG_HILBERT_ORDER = 2u, // Lines/triangle clusters sorted along the Hilbert curve of their centroids
+    BINMESH_FLAG_VERTEX_CACHE_OPTIMIZED = 4u // Triangle order optimized for the post-transform vertex cache
+};
+
+struct BinaryMeshFileHeader
+{
+    uint32_t version;
+    uint32_t magicNumber;
+    uint32_t numSubmeshes;
+    uint32_t numSections;
+    uint64_t sectionTableOffset;
+    uint64_t sectionTableSize; // Including the string pool
+    uint64_t sectionTableChecksum;
+    uint32_t flags; // BinaryMeshFlags
+    uint32_t reserved[5];
+};
+
+struct BinaryMeshSectionEntry
+{
+    uint32_t sectionType; // BinaryMeshSectionType
+    uint32_t submeshIndex;
+    uint32_t attributeFormat; // sgl::VertexAttributeFormat for attributes and uniforms
+    uint32_t numComponents;
+    uint32_t nameOffset; // Byte offset of the name in the string pool
+    uint32_t nameLength;
+    uint64_t dataOffset; // Absolute byte offset in the file
+    uint64_t dataSize;
+    uint64_t checksum; // XXH64 of the section data
+};
+
+/**
+ * Read-only view of a vertex attribute or uniform stored in a memory-mapped .binmesh file.
+ * The data pointer stays valid as long as the owning MappedBinaryMesh is open.
+ */
+struct BinaryMeshAttributeView
+{
+    std::string name;
+    sgl::VertexAttributeFormat attributeFormat;
+    uint32_t numComponents;
+    const uint8_t *data;
+    size_t dataSize;
+};
+
+struct BinarySubMeshView
+{
+    ObjMaterial material;
+    sgl::VertexMode vertexMode;
+    const uint32_t *indices;
+    size_t numIndices;
+    std::vector<BinaryMeshAttributeView> attributes;
+    std::vector<BinaryMeshAttributeView> uniforms;
+    const BinaryMeshMeshlet *meshlets = nullptr; // nullptr if the file stores no meshlets for the submesh
+    size_t numMeshlets = 0;
+};
+
+/**
+ * Selects the parts of a .binmesh file MappedBinaryMesh exposes. Sections that are not selected are never read, i.e.,
+ * e.g. a single importance criterion can be loaded from a file storing many of them at the cost of only this attribute.
+ */
+struct BinaryMeshSelection
+{
+    /// Indices of the submeshes in the file (empty: all submeshes).
+    std::vector<uint32_t> submeshIndices;
+    /// Names of the vertex attributes (empty: all attributes). Uniforms are always loaded, as they are small.
+    std::vector<std::string> attributeNames;
+    bool loadIndices = true;
+
+    bool containsSubmesh(uint32_t submeshIndex) const;
+    bool containsAttribute(const std::string &name) const;
+    bool containsSection(uint32_t sectionType, uint32_t submeshIndex, const std::string &name) const;
+};
+
+/// Entry of the table of contents of a .binmesh file.
+struct BinaryMeshSectionInfo
+{
+    BinaryMeshSectionType sectionType;
+    uint32_t submeshIndex;
+    std::string name; // Empty for sections that are no attributes or uniforms
+    sgl::VertexAttributeFormat attributeFormat;
+    uint32_t numComponents;
+    uint64_t dataSize;
+};
+
+struct BinaryMeshTableOfContents
+{
+    uint32_t numSubmeshes = 0;
+    uint32_t flags = 0; // BinaryMeshFlags
+    std::vector<BinaryMeshSectionInfo> sections;
+};
+
+/**
+ * Reads the table of contents (the section table) of a .binmesh file without touching the data of the sections, e.g.
+ * to decide which attributes to load with a BinaryMeshSelection.
+ * @return False if the file couldn't be read or is a version 4 file (which has no section table).
+ */
+bool readBinaryMeshTableOfContents(const std::string &filename, BinaryMeshTableOfContents &tableOfContents);
+
+/**
+ * Zero-copy reader for .binmesh files. Format version 5 files are memory-mapped and all submesh data is exposed as
+ * views into the mapping, i.e., no data is copied before it is e.g. uploaded to the GPU.
+ * Version 4 files are read into memory owned by this object, as their data is not aligned.
+ */
+class MappedBinaryMesh
+{
+public:
+    MappedBinaryMesh() : formatVersion(0), flags(0) {}
+    MappedBinaryMesh(const MappedBinaryMesh&) = delete;
+    MappedBinaryMesh &operator=(const MappedBinaryMesh&) = delete;
+
+    /**
+     * @param verifyChecksums If true, the checksums of all sections are validated. This touches all pages of the
+     * file and thus should only be used when file corruption is suspected.
+     * @return True if the file could be opened.
+     */
+    bool open(const std::string &filename, bool verifyChecksums = false);
+    /**
+     * Opens only the selected parts of the file (see BinaryMeshSelection). submeshes contains the selected submeshes
+     * in the order of the file; only the checksums of the selected sections are validated.
+     * Version 4 files are read completely, and the selection is applied afterwards.
+     */
+    bool open(const std::string &filename, const BinaryMeshSelection &selection, bool verifyChecksums = false);
+    void close();
+    /// Hint to the operating system that the data of all exposed sections will be needed soon.
+    void prefetch() const;
+    inline bool isOpen() const { return formatVersion != 0; }
+    inline uint32_t getFormatVersion() const { return formatVersion; }
+    /// BinaryMeshFlags of the file (always zero for version 4 files).
+    inline uint32_t getFlags() const { return flags; }
+    inline const MappedFilePtr &getMappedFile() const { return mappedFile; }
+
+    /// Copies the data of all views to an owning BinaryMesh object.
+    void copyTo(BinaryMesh &mesh) const;
+
+    std::vector<BinarySubMeshView> submeshes;
+
+private:
+    bool openVersion5(const std::string &filename, const BinaryMeshSelection &selection, bool verifyChecksums);
+    bool openVersion4(const std::string &filename, const BinaryMeshSelection &selection);
+
+    uint32_t formatVersion;
+    uint32_t flags;
+    MappedFilePtr mappedFile;
+    std::vector<std::pair<size_t, size_t>> sectionRanges; ///< Byte ranges of the exposed sections (for prefetch).
+    BinaryMesh legacyMesh; ///< Owns the data of version 4 files.
+};
+
+/// Default upper bound for the number of bytes BinaryMeshStreamWriter buffers in memory.
+const size_t BINMESH_DEFAULT_WRITE_MEMORY_CEILING = 16 * 1024 * 1024;
+
+/**
+ * Streams a .binmesh file (format version 5) section by section to disk, i.e., the data is never assembled in memory.
+ * At most memoryCeiling bytes are buffered; larger sections are written directly from the passed memory in chunks of
+ * at most memoryCeiling bytes. The data is written to a temporary file "<filename>.tmp", which is atomically renamed
+ * to the final file name in finish(). Thus, an interrupted conversion never leaves a truncated .binmesh file behind.
+ *
+ * Usage: open, then for every submesh beginSubmesh followed by writeIndices/writeAttribute/writeUniform (or
+ * beginSection/appendSectionData/endSection for data generated incrementally), and finally finish.
+ */
+class BinaryMeshStreamWriter
+{
+public:
+    explicit BinaryMeshStreamWriter(size_t memoryCeiling = BINMESH_DEFAULT_WRITE_MEMORY_CEILING);
+    ~BinaryMeshStreamWriter();
+    BinaryMeshStreamWriter(const BinaryMeshStreamWriter&) = delete;
+    BinaryMeshStreamWriter &operator=(const BinaryMeshStreamWriter&) = delete;
+
+    bool open(const std::string &filename);
+    void beginSubmesh(const ObjMaterial &material, sgl::VertexMode vertexMode);
+    void writeIndices(const uint32_t *indices, size_t numIndices);
+    void writeAttribute(const std::string &name, sgl::VertexAttributeFormat attributeFormat, uint32_t numComponents,
+            const void *data, size_t dataSize);
+    void writeUniform(const std::string &name, sgl::VertexAttributeFormat attributeFormat, uint32_t numComponents,
+            const void *data, size_t dataSize);
+    void writeMeshlets(const BinaryMeshMeshlet *meshlets, size_t numMeshlets);
+
+    // Incremental interface for sections whose data is not available as one contiguous array.
+    void beginSection(BinaryMeshSectionType sectionType, const std::string &name = "",
+            sgl::VertexAttributeFormat attributeFormat = sgl::ATTRIB_UNSIGNED_INT, uint32_t numComponents = 1);
+    void appendSectionData(const void *data, size_t dataSize);
+    void endSection();
+
+    /// Sets the BinaryMeshFlags stored in the header of the file (reset by open).
+    inline void setFlags(uint32_t flags) { this->flags = flags; }
+
+    /// Writes the section table and header and renames the temporary file. @return True if no I/O error occurred.
+    bool finish();
+    /// Discards the temporary file. Called automatically by the destructor if finish was not called.
+    void abort();
+
+    inline bool isOpen() const { return file != nullptr; }
+    inline uint64_t getNumBytesWritten() const { return fileOffset; }
+    /// Throughput of the last finished file in MB/s (1 MB = 1024^2 bytes).
+    inline double getThroughputMBs() const { return throughputMBs; }
+
+private:
+    void writeBytes(const void *data, size_t dataSize);
+    void writePadding();
+    void flushBuffer();
+
+    size_t memoryCeiling;
+    FILE *file;
+    std::string filename, tempFilename;
+    std::vector<uint8_t> buffer;
+    uint64_t fileOffset;
+    bool ioError;
+    uint32_t flags;
+    double throughputMBs;
+    double startTime;
+
+    int currentSubmeshIndex;
+    bool sectionOpen;
+    BinaryMeshSectionEntry currentSection;
+    XXHash64 sectionHasher;
+    std::vector<BinaryMeshSectionEntry> sections;
+    std::string stringPool;
+};
+
 /**
  * Writes a mesh to a binary file. The mesh data vectors may also be empty (i.e. size 0).
+ * The data is streamed to the file using BinaryMeshStreamWriter.
  * @param indices, vertices, texcoords, normals: The mesh data.
+ * @param memoryCeiling: The maximum number of bytes to buffer in memory.
+ * @return False if the file couldn't be written (see BinaryMeshStreamWriter::finish).
  */
-void writeMesh3D(const std::string &filename, const BinaryMesh &mesh);
+bool writeMesh3D(const std::string &filename, const BinaryMesh &mesh,
+        size_t memoryCeiling = BINMESH_DEFAULT_WRITE_MEMORY_CEILING);
 
 /**
  * Reads a mesh from a binary file. The mesh data vectors may also be empty (i.e. size 0).
+ * NOTE: This copies all data. Use MappedBinaryMesh for zero-copy access.
  * @param indices, vertices, texcoords, normals: The mesh data.
+ * @return False if the file couldn't be opened or is invalid (e.g. a checksum mismatch). The error is logged.
  */
-void readMesh3D(const std::string &filename, BinaryMesh &mesh);
+bool readMesh3D(const std::string &filename, BinaryMesh &mesh);
+
+/// A vertex attribute to append to a submesh of an existing .binmesh file (see appendBinaryMeshAttributes).
+struct BinaryMeshAppendedAttribute
+{
+    uint32_t submeshIndex;
+    BinaryMeshAttributeView attribute;
+};
+
+/**
+ * Appends vertex attributes to the submeshes of an existing .binmesh file (format version 5) without rewriting any
+ * of its data: The new sections and a new section table are written behind the end of the file, and the header is
+ * overwritten last. Thus, an interrupted append leaves the file with its old (valid) section table. The new attributes
+ * are listed after the existing attributes of their submesh.
+ * The old section table can't be overwritten without losing this guarantee, so it stays behind as unreachable bytes:
+ * Each append grows the file by the new sections, the new section table and the old section table (rounded up to
+ * BINMESH_SECTION_ALIGNMENT). The tables only store the section entries and names (about 3 KiB for 50 sections), and
+ * rewriting the file (e.g. readMesh3D followed by writeMesh3D) reclaims the space.
+ * The caller needs to make sure that no other thread or process writes to the file at the same time.
+ * @return False if the file is no version 5 file, a submesh doesn't exist, has no vertex positions or already has an
+ * attribute with the same name, the number of vertices differs from the vertex positions of the submesh or an I/O
+ * error occurred.
+ */
+bool appendBinaryMeshAttributes(const std::string &filename,
+        const std::vector<BinaryMeshAppendedAttribute> &attributes);
 
 struct ImportanceCriterionAttribute {
     std::string name;
@@ -119,6 +426,8 @@ struct ImportanceCriterionAttribute {
     float maxAttribute;
 };
 
+// The rendering helpers below are implemented in MeshRenderer.cpp, as they need an OpenGL context.
+
 // For programmable vertex fetching/pulling
 struct SSBOEntry {
     SSBOEntry(int bindingPoint, const std::string &attributeName, sgl::GeometryBufferPtr &attributeBuffer)
@@ -128,11 +437,15 @@ struct SSBOEntry {
     sgl::GeometryBufferPtr attributeBuffer;
 };
 
+/// Loads an importance criterion in a background thread (see MeshRenderer::loadImportanceCriterionAsync).
+struct ImportanceCriterionLoadTask;
+
 class MeshRenderer
 {
 public:
-    MeshRenderer() : useProgrammableFetch(false) {}
-    MeshRenderer(bool useProgrammableFetch) : useProgrammableFetch(useProgrammableFetch) {}
+    MeshRenderer() : useProgrammableFetch(false), programmableFetchUseAoS(true) {}
+    MeshRenderer(bool useProgrammableFetch)
+            : useProgrammableFetch(useProgrammableFetch), programmableFetchUseAoS(true) {}
 
     // attributeIndex: For programmable vertex fetching/pulling. We need to bind the correct line attribute SSBO!
     void render(sgl::ShaderProgramPtr passShader, bool isGBufferPass, int attributeIndex);
@@ -142,7 +455,34 @@ public:
         return shaderAttributeNames.find(name) != shaderAttributeNames.end();
     }
 
+    /**
+     * parseMesh3D may load only one importance criterion. The entries of the other importance criteria in
+     * importanceCriterionAttributes have no values until they are loaded on demand by the functions below.
+     */
+    bool isImportanceCriterionLoaded(int importanceCriterionIndex) const;
+    /**
+     * @return The entry of "vertexAttribute<importanceCriterionIndex>" in importanceCriterionAttributes, or nullptr if
+     * the file doesn't contain the importance criterion (the converters only store the requested ones).
+     */
+    ImportanceCriterionAttribute *getImportanceCriterionAttribute(int importanceCriterionIndex);
+    bool isImportanceCriterionLoading(int importanceCriterionIndex) const;
+    inline bool isLoadingImportanceCriteria() const { return !importanceCriterionLoadTasks.empty(); }
+    /**
+     * Starts loading the importance criterion "vertexAttribute<importanceCriterionIndex>" from the file in a background
+     * thread (if it is neither loaded nor being loaded yet). The data is uploaded by updateImportanceCriterionLoading.
+     */
+    void loadImportanceCriterionAsync(int importanceCriterionIndex);
+    /// Loads the importance criterion and waits for the upload (e.g. for performance measurements).
+    void loadImportanceCriterion(int importanceCriterionIndex);
+    /**
+     * Uploads the importance criteria whose background loading has finished. Needs to be called regularly (e.g. once
+     * per frame) by the thread owning the OpenGL context.
+     * @return True if an importance criterion was uploaded.
+     */
+    bool updateImportanceCriterionLoading();
+
     bool useProgrammableFetch;
+    bool programmableFetchUseAoS;
     std::vector<sgl::ShaderAttributesPtr> shaderAttributes;
     std::vector<SSBOEntry> ssboEntries; // For programmable vertex fetching/pulling
     std::set<std::string> shaderAttributeNames;
@@ -150,15 +490,27 @@ public:
     sgl::AABB3 boundingBox;
     sgl::Sphere boundingSphere;
     std::vector<ImportanceCriterionAttribute> importanceCriterionAttributes;
+
+    // For loading importance criteria on demand
+    std::string filename;
+    std::set<std::string> unloadedImportanceCriteria;
+    std::vector<std::shared_ptr<ImportanceCriterionLoadTask>> importanceCriterionLoadTasks;
+
+private:
+    void uploadImportanceCriterion(ImportanceCriterionLoadTask &task);
 };
 
 
 /**
  * Uses readMesh3D to read the mesh data from a file and assigns the data to a ShaderAttributesPtr object.
  * @param shader: The shader to use for the mesh.
+ * @param shuffleSeed: The seed of the primitive order if shuffleData is set.
+ * @param importanceCriterionIndex: If not negative, only the importance criterion "vertexAttribute<N>" with this index
+ * is loaded (see selectImportanceCriterion). The others can be loaded on demand by the returned object.
  * @return: The loaded mesh stored in a ShaderAttributes object.
  */
 MeshRenderer parseMesh3D(const std::string &filename, sgl::ShaderProgramPtr shader, bool shuffleData = false,
-        bool useProgrammableFetch = false, bool programmableFetchUseAoS = true, float lineRadius = 0.001f);
+        bool useProgrammableFetch = false, bool programmableFetchUseAoS = true, float lineRadius = 0.001f,
+        uint64_t shuffleSeed = 0, int importanceCriterionIndex = -1);
 
 #endif /* UTILS_MESHSERIALIZER_HPP_ */
@@ -0,0 +1,474 @@
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+#include <Utils/File/Logfile.hpp>
+#include <Utils/Convert.hpp>
+
+#include "ParallelAlgorithms.hpp"
+#include "Meshlets.hpp"
+
+/// Number of primitives of the windows the index buffer is split into if the primitives are not grouped by normal.
+const size_t MESHLET_WINDOW_NUM_PRIMITIVES = 16384;
+/// Number of meshlets tested by one task of cullMeshlets.
+const size_t MESHLET_CULLING_BLOCK_SIZE = 1024;
+/// Group of the triangles without a normal (degenerate triangles).
+const uint32_t NORMAL_GROUP_DEGENERATE = 6;
+/// Marks the unused slots of MeshletVertexSet (not a valid vertex index, as it is the primitive restart index).
+const uint32_t VERTEX_SET_EMPTY_SLOT = 0xFFFFFFFFu;
+
+/**
+ * The set of unique vertices of the meshlet under construction (open addressing with linear probing). The capacity is
+ * at least twice the maximum number of vertices of a meshlet, so the probe sequences stay short.
+ */
+class MeshletVertexSet
+{
+public:
+    explicit MeshletVertexSet(size_t maxVertices) : size(0) {
+        size_t capacity = 16;
+        while (capacity < 2 * maxVertices) {
+            capacity *= 2;
+        }
+        slots.resize(capacity, VERTEX_SET_EMPTY_SLOT);
+        mask = capacity - 1;
+    }
+
+    inline void clear() {
+        std::fill(slots.begin(), slots.end(), VERTEX_SET_EMPTY_SLOT);
+        size = 0;
+    }
+    inline size_t getSize() const { return size; }
+    inline bool contains(uint32_t vertexIndex) const {
+        return slots.at(findSlot(vertexIndex)) == vertexIndex;
+    }
+    inline void insert(uint32_t vertexIndex) {
+        size_t slot = findSlot(vertexIndex);
+        if (slots.at(slot) == VERTEX_SET_EMPTY_SLOT) {
+            slots.at(slot) = vertexIndex;
+            size++;
+        }
+    }
+
+private:
+    inline size_t findSlot(uint32_t vertexIndex) const {
+        size_t slot = (vertexIndex * 2654435761u) & mask;
+        while (slots[slot] != VERTEX_SET_EMPTY_SLOT && slots[slot] != vertexIndex) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    std::vector<uint32_t> slots;
+    size_t mask;
+    size_t size;
+};
+
+/// Read access to the attribute the meshlets store the range of (unorm16 or float).
+struct MeshletAttributeData
+{
+    const uint16_t *unorm16Data = nullptr;
+    const float *floatData = nullptr;
+    size_t numValues = 0;
+
+    inline float get(uint32_t vertexIndex) const {
+        return unorm16Data ? float(unorm16Data[vertexIndex]) / 65535.0f : floatData[vertexIndex];
+    }
+};
+
+static inline glm::vec3 computeTriangleNormal(const glm::vec3 *vertexPositions, const uint32_t *triangle)
+{
+    const glm::vec3 &p0 = vertexPositions[triangle[0]];
+    return glm::cross(vertexPositions[triangle[1]] - p0, vertexPositions[triangle[2]] - p0);
+}
+
+/// @return The dominant axis and its sign (0 to 5) or NORMAL_GROUP_DEGENERATE.
+static inline uint32_t getNormalGroup(const glm::vec3 &normal)
+{
+    glm::vec3 absNormal(std::abs(normal.x), std::abs(normal.y), std::abs(normal.z));
+    if (absNormal.x == 0.0f && absNormal.y == 0.0f && absNormal.z == 0.0f) {
+        return NORMAL_GROUP_DEGENERATE;
+    }
+    int axis = absNormal.x >= absNormal.y ? (absNormal.x >= absNormal.z ? 0 : 2) : (absNormal.y >= absNormal.z ? 1 : 2);
+    return uint32_t(axis) * 2u + (normal[axis] < 0.0f ? 1u : 0u);
+}
+
+/**
+ * Partitions the primitives [firstPrimitive, firstPrimitive + numPrimitives) into meshlets. The primitives are written
+ * in meshlet order to the same range of meshletIndices.
+ */
+static void buildWindowMeshlets(
+        const uint32_t *indices, size_t firstPrimitive, size_t numPrimitives, size_t primitiveSize,
+        const glm::vec3 *vertexPositions, bool groupByNormal, size_t maxPrimitives, size_t maxVertices,
+        MeshletVertexSet &vertexSet, std::vector<uint32_t> &primitiveOrder, std::vector<uint32_t> &primitiveGroups,
+        uint32_t *meshletIndices, std::vector<BinaryMeshMeshlet> &meshlets)
+{
+    // Stable counting sort of the triangles by the group of their normal.
+    primitiveOrder.resize(numPrimitives);
+    primitiveGroups.assign(numPrimitives, 0);
+    if (groupByNormal) {
+        size_t groupOffsets[NORMAL_GROUP_DEGENERATE + 2] = { 0 };
+        for (size_t i = 0; i < numPrimitives; i++) {
+            const uint32_t *triangle = indices + (firstPrimitive + i) * 3;
+            primitiveGroups.at(i) = getNormalGroup(computeTriangleNormal(vertexPositions, triangle));
+            groupOffsets[primitiveGroups.at(i) + 1]++;
+        }
+        for (uint32_t group = 1; group <= NORMAL_GROUP_DEGENERATE + 1; group++) {
+            groupOffsets[group] += groupOffsets[group - 1];
+        }
+        for (size_t i = 0; i < numPrimitives; i++) {
+            primitiveOrder.at(groupOffsets[primitiveGroups.at(i)]++) = uint32_t(i);
+        }
+    } else {
+        for (size_t i = 0; i < numPrimitives; i++) {
+            primitiveOrder.at(i) = uint32_t(i);
+        }
+    }
+
+    BinaryMeshMeshlet meshlet;
+    meshlet.indexOffset = uint32_t(firstPrimitive * primitiveSize);
+    meshlet.indexCount = 0;
+    uint32_t meshletGroup = 0;
+    vertexSet.clear();
+    for (size_t i = 0; i < numPrimitives; i++) {
+        const uint32_t primitiveIndex = primitiveOrder.at(i);
+        const uint32_t *primitive = indices + (firstPrimitive + primitiveIndex) * primitiveSize;
+        const uint32_t primitiveGroup = primitiveGroups.at(primitiveIndex);
+
+        size_t numNewVertices = 0;
+        for (size_t j = 0; j < primitiveSize; j++) {
+            // Indices occurring twice in a primitive (degenerate primitives) are only counted once.
+            if (!vertexSet.contains(primitive[j])
+                    && std::find(primitive, primitive + j, primitive[j]) == primitive + j) {
+                numNewVertices++;
+            }
+        }
+        if (meshlet.indexCount > 0 && (meshlet.indexCount / primitiveSize >= maxPrimitives
+                || vertexSet.getSize() + numNewVertices > maxVertices || primitiveGroup != meshletGroup)) {
+            meshlets.push_back(meshlet);
+            meshlet.indexOffset += meshlet.indexCount;
+            meshlet.indexCount = 0;
+            vertexSet.clear();
+        }
+
+        meshletGroup = primitiveGroup;
+        uint32_t *meshletPrimitive = meshletIndices + (firstPrimitive + i) * primitiveSize;
+        for (size_t j = 0; j < primitiveSize; j++) {
+            meshletPrimitive[j] = primitive[j];
+            vertexSet.insert(primitive[j]);
+        }
+        meshlet.indexCount += uint32_t(primitiveSize);
+    }
+    if (meshlet.indexCount > 0) {
+        meshlets.push_back(meshlet);
+    }
+}
+
+static void computeMeshletBounds(
+        BinaryMeshMeshlet &meshlet, const uint32_t *meshletIndices, size_t primitiveSize,
+        const glm::vec3 *vertexPositions, const MeshletAttributeData &attributeData)
+{
+    const uint32_t *indices = meshletIndices + meshlet.indexOffset;
+    glm::vec3 aabbMin(FLT_MAX), aabbMax(-FLT_MAX);
+    float attributeMin = FLT_MAX, attributeMax = -FLT_MAX;
+    for (uint32_t i = 0; i < meshlet.indexCount; i++) {
+        const glm::vec3 &position = vertexPositions[indices[i]];
+        aabbMin = glm::min(aabbMin, position);
+        aabbMax = glm::max(aabbMax, position);
+        if (attributeData.numValues > 0) {
+            float value = attributeData.get(indices[i]);
+            attributeMin = std::min(attributeMin, value);
+            attributeMax = std::max(attributeMax, value);
+        }
+    }
+    meshlet.aabbMin = aabbMin;
+    meshlet.aabbMax = aabbMax;
+    meshlet.padding0 = 0.0f;
+    meshlet.padding1 = 0.0f;
+    // Without the attribute, the meshlet is never culled by the attribute range.
+    meshlet.attributeMin = attributeData.numValues > 0 ? attributeMin : -FLT_MAX;
+    meshlet.attributeMax = attributeData.numValues > 0 ? attributeMax : FLT_MAX;
+
+    // Bounding sphere around the center of the AABB (at most sqrt(3) times larger than the minimal sphere).
+    glm::vec3 center = (aabbMin + aabbMax) * 0.5f;
+    float squaredRadius = 0.0f;
+    for (uint32_t i = 0; i < meshlet.indexCount; i++) {
+        glm::vec3 difference = vertexPositions[indices[i]] - center;
+        squaredRadius = std::max(squaredRadius, glm::dot(difference, difference));
+    }
+    meshlet.boundingSphere = glm::vec4(center, std::sqrt(squaredRadius));
+
+    // Normal cone of the triangles: The axis is the normalized mean of the unit normals, the half opening angle the
+    // maximum angle between the axis and a normal. Lines and cones of 90 degrees or more can't be used for culling.
+    meshlet.normalCone = glm::vec4(0.0f, 0.0f, 0.0f, MESHLET_NO_NORMAL_CONE);
+    if (primitiveSize != 3) {
+        return;
+    }
+    glm::vec3 normalSum(0.0f);
+    for (uint32_t i = 0; i < meshlet.indexCount; i += 3) {
+        glm::vec3 normal = computeTriangleNormal(vertexPositions, indices + i);
+        float normalLength = glm::length(normal);
+        if (normalLength > 0.0f) {
+            normalSum += normal / normalLength;
+        }
+    }
+    float normalSumLength = glm::length(normalSum);
+    if (normalSumLength <= 1e-6f) {
+        return;
+    }
+    glm::vec3 axis = normalSum / normalSumLength;
+    float minCosAngle = 1.0f;
+    for (uint32_t i = 0; i < meshlet.indexCount; i += 3) {
+        glm::vec3 normal = computeTriangleNormal(vertexPositions, indices + i);
+        float normalLength = glm::length(normal);
+        if (normalLength > 0.0f) {
+            minCosAngle = std::min(minCosAngle, glm::dot(axis, normal / normalLength));
+        }
+    }
+    if (minCosAngle > 0.0f) {
+        meshlet.normalCone = glm::vec4(axis, std::sqrt(std::max(1.0f - minCosAngle * minCosAngle, 0.0f)));
+    }
+}
+
+bool buildMeshlets(const BinarySubMeshView &submesh, const MeshletSettings &settings,
+        std::vector<uint32_t> &meshletIndices, std::vector<BinaryMeshMeshlet> &meshlets)
+{
+    meshletIndices.clear();
+    meshlets.clear();
+
+    size_t primitiveSize;
+    if (submesh.vertexMode == sgl::VERTEX_MODE_LINES) {
+        primitiveSize = 2;
+    } else if (submesh.vertexMode == sgl::VERTEX_MODE_TRIANGLES) {
+        primitiveSize = 3;
+    } else {
+        sgl::Logfile::get()->writeError("Error in buildMeshlets: Only line and triangle meshes are supported.");
+        return false;
+    }
+
+    const glm::vec3 *vertexPositions = nullptr;
+    size_t numVertices = 0;
+    MeshletAttributeData attributeData;
+    for (const BinaryMeshAttributeView &attribute : submesh.attributes) {
+        if (attribute.name == "vertexPosition" && attribute.attributeFormat == sgl::ATTRIB_FLOAT
+                && attribute.numComponents == 3) {
+            vertexPositions = (const glm::vec3*)attribute.data;
+            numVertices = attribute.dataSize / sizeof(glm::vec3);
+        } else if (attribute.name == settings.attributeName && attribute.numComponents == 1) {
+            if (attribute.attributeFormat == sgl::ATTRIB_UNSIGNED_SHORT) {
+                attributeData.unorm16Data = (const uint16_t*)attribute.data;
+                attributeData.numValues = attribute.dataSize / sizeof(uint16_t);
+            } else if (attribute.attributeFormat == sgl::ATTRIB_FLOAT) {
+                attributeData.floatData = (const float*)attribute.data;
+                attributeData.numValues = attribute.dataSize / sizeof(float);
+            }
+        }
+    }
+    if (vertexPositions == nullptr || numVertices == 0) {
+        sgl::Logfile::get()->writeError("Error in buildMeshlets: The submesh has no vertex positions.");
+        return false;
+    }
+
+    const size_t numPrimitives = submesh.numIndices / primitiveSize;
+    const uint32_t *indices = submesh.indices;
+    const size_t numAttributeValues = attributeData.numValues;
+    bool indicesValid = true;
+    #pragma omp parallel for reduction(&&:indicesValid)
+    for (size_t i = 0; i < numPrimitives * primitiveSize; i++) {
+        indicesValid = indicesValid && indices[i] < numVertices
+                && (numAttributeValues == 0 || indices[i] < numAttributeValues);
+    }
+    if (!indicesValid) {
+        sgl::Logfile::get()->writeError("Error in buildMeshlets: Vertex index out of range.");
+        return false;
+    }
+
+    const bool groupByNormal = settings.groupTrianglesByNormal && primitiveSize == 3;
+    const size_t maxPrimitives = std::max(settings.maxPrimitives, size_t(1));
+    const size_t maxVertices = std::max(settings.maxVertices, primitiveSize);
+    const size_t windowSize = groupByNormal ? std::max(settings.normalGroupingWindow, size_t(1))
+            : MESHLET_WINDOW_NUM_PRIMITIVES;
+    const size_t numWindows = (numPrimitives + windowSize - 1) / windowSize;
+    meshletIndices.resize(numPrimitives * primitiveSize);
+
+    // The windows are independent, so the meshlets don't depend on the number of threads.
+    std::vector<std::vector<BinaryMeshMeshlet>> windowMeshlets(numWindows);
+    #pragma omp parallel
+    {
+        MeshletVertexSet vertexSet(maxVertices);
+        std::vector<uint32_t> primitiveOrder, primitiveGroups;
+        #pragma omp for schedule(dynamic, 16)
+        for (size_t window = 0; window < numWindows; window++) {
+            size_t firstPrimitive = window * windowSize;
+            size_t numWindowPrimitives = std::min(windowSize, numPrimitives - firstPrimitive);
+            buildWindowMeshlets(indices, firstPrimitive, numWindowPrimitives, primitiveSize, vertexPositions,
+                    groupByNormal, maxPrimitives, maxVertices, vertexSet, primitiveOrder, primitiveGroups,
+                    meshletIndices.data(), windowMeshlets.at(window));
+        }
+    }
+
+    std::vector<size_t> windowMeshletCounts(numWindows), windowMeshletOffsets;
+    for (size_t window = 0; window < numWindows; window++) {
+        windowMeshletCounts.at(window) = windowMeshlets.at(window).size();
+    }
+    meshlets.resize(parallelExclusivePrefixSum(windowMeshletCounts, windowMeshletOffsets));
+
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (size_t window = 0; window < numWindows; window++) {
+        BinaryMeshMeshlet *windowOutput = meshlets.data() + windowMeshletOffsets.at(window);
+        for (const BinaryMeshMeshlet &meshlet : windowMeshlets.at(window)) {
+            *windowOutput = meshlet;
+            computeMeshletBounds(*windowOutput, meshletIndices.data(), primitiveSize, vertexPositions,
+                    attributeData);
+            windowOutput++;
+        }
+    }
+    return true;
+}
+
+bool convertBinaryMeshToMeshlets(const std::string &inputFilename, const std::string &outputFilename,
+        const MeshletSettings &settings)
+{
+    MappedBinaryMesh mesh;
+    if (!mesh.open(inputFilename)) {
+        return false;
+    }
+    BinaryMeshStreamWriter meshWriter;
+    if (!meshWriter.open(outputFilename)) {
+        return false;
+    }
+
+    uint32_t flags = mesh.getFlags();
+    size_t numMeshlets = 0;
+    for (const BinarySubMeshView &submesh : mesh.submeshes) {
+        std::vector<uint32_t> meshletIndices;
+        std::vector<BinaryMeshMeshlet> meshlets;
+        bool hasMeshlets = (submesh.vertexMode == sgl::VERTEX_MODE_LINES
+                || submesh.vertexMode == sgl::VERTEX_MODE_TRIANGLES)
+                && buildMeshlets(submesh, settings, meshletIndices, meshlets);
+        if (hasMeshlets && submesh.vertexMode == sgl::VERTEX_MODE_TRIANGLES && settings.groupTrianglesByNormal) {
+            // Grouping the triangles by normal changes the order optimized for the vertex cache.
+            flags &= ~uint32_t(BINMESH_FLAG_VERTEX_CACHE_OPTIMIZED);
+        }
+
+        meshWriter.beginSubmesh(submesh.material, submesh.vertexMode);
+        if (hasMeshlets) {
+            meshWriter.writeIndices(meshletIndices.data(), meshletIndices.size());
+        } else {
+            meshWriter.writeIndices(submesh.indices, submesh.numIndices);
+        }
+        for (const BinaryMeshAttributeView &attribute : submesh.attributes) {
+            meshWriter.writeAttribute(attribute.name, attribute.attributeFormat, attribute.numComponents,
+                    attribute.data, attribute.dataSize);
+        }
+        for (const BinaryMeshAttributeView &uniform : submesh.uniforms) {
+            meshWriter.writeUniform(uniform.name, uniform.attributeFormat, uniform.numComponents,
+                    uniform.data, uniform.dataSize);
+        }
+        if (hasMeshlets) {
+            meshWriter.writeMeshlets(meshlets.data(), meshlets.size());
+            numMeshlets += meshlets.size();
+        }
+    }
+    meshWriter.setFlags(flags);
+
+    if (!meshWriter.finish()) {
+        return false;
+    }
+    sgl::Logfile::get()->writeInfo(std::string() + "Built " + sgl::toString(numMeshlets) + " meshlets for \""
+            + inputFilename + "\".");
+    return true;
+}
+
+static inline float dotPlane(const glm::vec4 &plane, const glm::vec3 &point)
+{
+    return plane.x * point.x + plane.y * point.y + plane.z * point.z + plane.w;
+}
+
+void cullMeshlets(const BinaryMeshMeshlet *meshlets, size_t numMeshlets, const glm::mat4 &viewProjectionMatrix,
+        const glm::vec3 &cameraPosition, const MeshletCullingSettings &settings,
+        std::vector<MeshletDrawRange> &drawRanges, MeshletCullingStatistics *statistics)
+{
+    // Frustum planes in world space (Gribb and Hartmann): The fourth row of the matrix plus/minus the other rows.
+    const glm::mat4 &m = viewProjectionMatrix;
+    glm::vec4 frustumPlanes[6];
+    for (int i = 0; i < 3; i++) {
+        glm::vec4 row(m[0][i], m[1][i], m[2][i], m[3][i]);
+        glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+        frustumPlanes[i * 2] = row3 + row;
+        frustumPlanes[i * 2 + 1] = row3 - row;
+    }
+
+    const size_t numBlocks = (numMeshlets + MESHLET_CULLING_BLOCK_SIZE - 1) / MESHLET_CULLING_BLOCK_SIZE;
+    std::vector<std::vector<MeshletDrawRange>> blockDrawRanges(numBlocks);
+    size_t numAttributeCulled = 0, numFrustumCulled = 0, numBackfaceCulled = 0;
+    #pragma omp parallel for schedule(dynamic) reduction(+:numAttributeCulled,numFrustumCulled,numBackfaceCulled)
+    for (size_t block = 0; block < numBlocks; block++) {
+        std::vector<MeshletDrawRange> &ranges = blockDrawRanges.at(block);
+        size_t blockEnd = std::min((block + 1) * MESHLET_CULLING_BLOCK_SIZE, numMeshlets);
+        for (size_t i = block * MESHLET_CULLING_BLOCK_SIZE; i < blockEnd; i++) {
+            const BinaryMeshMeshlet &meshlet = meshlets[i];
+
+            if (settings.attributeRangeCulling && (meshlet.attributeMax < settings.attributeRangeMin
+                    || meshlet.attributeMin > settings.attributeRangeMax)) {
+                numAttributeCulled++;
+                continue;
+            }
+
+            if (settings.frustumCulling) {
+                // The AABB is outside if its corner furthest along the plane normal is behind one of the planes.
+                bool outside = false;
+                for (int j = 0; j < 6 && !outside; j++) {
+                    const glm::vec4 &plane = frustumPlanes[j];
+                    glm::vec3 corner(plane.x >= 0.0f ? meshlet.aabbMax.x : meshlet.aabbMin.x,
+                                     plane.y >= 0.0f ? meshlet.aabbMax.y : meshlet.aabbMin.y,
+                                     plane.z >= 0.0f ? meshlet.aabbMax.z : meshlet.aabbMin.z);
+                    outside = dotPlane(plane, corner) < 0.0f;
+                }
+                if (outside) {
+                    numFrustumCulled++;
+                    continue;
+                }
+            }
+
+            if (settings.backfaceCulling && meshlet.normalCone.w < 1.0f) {
+                // All triangles face away from every point of the bounding sphere if the angle between the axis and
+                // the view vector is less than 90 degrees minus the half opening angle of the cone (conservative).
+                glm::vec3 center(meshlet.boundingSphere.x, meshlet.boundingSphere.y, meshlet.boundingSphere.z);
+                glm::vec3 axis(meshlet.normalCone.x, meshlet.normalCone.y, meshlet.normalCone.z);
+                glm::vec3 viewVector = center - cameraPosition;
+                float radius = meshlet.boundingSphere.w;
+                if (glm::dot(axis, viewVector) - radius
+                        > meshlet.normalCone.w * (glm::length(viewVector) + radius)) {
+                    numBackfaceCulled++;
+                    continue;
+                }
+            }
+
+            if (!ranges.empty() && ranges.back().firstIndex + ranges.back().indexCount == meshlet.indexOffset) {
+                ranges.back().indexCount += meshlet.indexCount;
+            } else {
+                ranges.push_back(MeshletDrawRange{ meshlet.indexOffset, meshlet.indexCount });
+            }
+        }
+    }
+
+    // Concatenate the ranges of the blocks (merging the ranges adjacent across block boundaries).
+    drawRanges.clear();
+    for (const std::vector<MeshletDrawRange> &ranges : blockDrawRanges) {
+        for (const MeshletDrawRange &range : ranges) {
+            if (!drawRanges.empty() && drawRanges.back().firstIndex + drawRanges.back().indexCount
+                    == range.firstIndex) {
+                drawRanges.back().indexCount += range.indexCount;
+            } else {
+                drawRanges.push_back(range);
+            }
+        }
+    }
+
+    if (statistics) {
+        statistics->numAttributeCulled = numAttributeCulled;
+        statistics->numFrustumCulled = numFrustumCulled;
+        statistics->numBackfaceCulled = numBackfaceCulled;
+        statistics->numVisible = numMeshlets - numAttributeCulled - numFrustumCulled - numBackfaceCulled;
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef PIXELSYNCOIT_MESHLETS_HPP
+#define PIXELSYNCOIT_MESHLETS_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+#include "MeshSerializer.hpp"
+
+/**
+ * Meshlets: The submeshes of line and tube meshes are split into clusters of consecutive primitives with a bounded
+ * number of primitives and vertices. Each cluster stores its bounds (see BinaryMeshMeshlet), such that clusters
+ * outside of the view frustum, outside of the attribute range of interest or facing away from the camera can be
+ * culled per frame without looking at their primitives. The culling returns the index ranges of the remaining
+ * clusters, which can be drawn with one multi-draw call.
+ */
+
+struct MeshletSettings
+{
+    /// Upper bounds for the number of primitives and unique vertices of a meshlet.
+    size_t maxPrimitives = 64;
+    size_t maxVertices = 64;
+    /**
+     * Triangle meshes: The triangles of each window of normalGroupingWindow consecutive triangles are grouped by the
+     * dominant axis of their normal, and meshlets don't span several groups. Without grouping, a meshlet of a tube
+     * contains triangles facing in all directions, i.e., its normal cone is too wide for backface culling.
+     */
+    bool groupTrianglesByNormal = true;
+    size_t normalGroupingWindow = 256;
+    /// The attribute whose range is stored (one component, unorm16 or float).
+    std::string attributeName = "vertexAttribute0";
+};
+
+/**
+ * Builds the meshlets of a submesh with the vertex mode VERTEX_MODE_LINES or VERTEX_MODE_TRIANGLES.
+ * The primitives are partitioned greedily in the order of the index buffer, so spatially reordered meshes (see
+ * SpatialReordering.hpp) result in tighter bounds. The index buffer is split into windows that are processed in
+ * parallel; the result doesn't depend on the number of threads.
+ * @param meshletIndices The index buffer in meshlet order (the triangles may be permuted inside of their window if
+ * settings.groupTrianglesByNormal is set). The meshlets reference this buffer.
+ * @return False if the submesh has an unsupported vertex mode or no vertex positions.
+ */
+bool buildMeshlets(const BinarySubMeshView &submesh, const MeshletSettings &settings,
+        std::vector<uint32_t> &meshletIndices, std::vector<BinaryMeshMeshlet> &meshlets);
+
+/**
+ * Conversion step: Writes a copy of a .binmesh file, where the line and triangle submeshes store their meshlets
+ * (BINMESH_SECTION_MESHLETS) and the index buffer in meshlet order. Other submeshes are copied unchanged.
+ * The input file must differ from the output file, as it is memory-mapped while the output file is written.
+ * @return True if the output file was written.
+ */
+bool convertBinaryMeshToMeshlets(const std::string &inputFilename, const std::string &outputFilename,
+        const MeshletSettings &settings = MeshletSettings());
+
+struct MeshletCullingSettings
+{
+    bool frustumCulling = true;
+    /// Only valid if the primitives are drawn with back face culling, i.e., not for transparent tubes.
+    bool backfaceCulling = false;
+    /// Culls the meshlets whose attribute range doesn't intersect [attributeRangeMin, attributeRangeMax].
+    bool attributeRangeCulling = false;
+    float attributeRangeMin = 0.0f, attributeRangeMax = 1.0f;
+};
+
+/// A range of the index buffer, e.g. for glMultiDrawElements.
+struct MeshletDrawRange
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+};
+
+struct MeshletCullingStatistics
+{
+    size_t numVisible = 0;
+    /// The tests are applied in the order attribute range, frustum, backface; a meshlet is counted for the first test
+    /// that culls it.
+    size_t numAttributeCulled = 0;
+    size_t numFrustumCulled = 0;
+    size_t numBackfaceCulled = 0;
+};
+
+/**
+ * Culls the meshlets for one camera (in parallel) and writes the index ranges of the visible meshlets to drawRanges.
+ * Consecutive visible meshlets are merged into one range. The culling is conservative, i.e., no visible primitive is
+ * culled.
+ * @param viewProjectionMatrix The product of the projection and the view matrix (OpenGL clip space conventions).
+ * @param cameraPosition The position of the camera in world space (for backface culling).
+ */
+void cullMeshlets(const BinaryMeshMeshlet *meshlets, size_t numMeshlets, const glm::mat4 &viewProjectionMatrix,
+        const glm::vec3 &cameraPosition, const MeshletCullingSettings &settings,
+        std::vector<MeshletDrawRange> &drawRanges, MeshletCullingStatistics *statistics = nullptr);
+
+#endif //PIXELSYNCOIT_MESHLETS_HPP
@@ -9,9 +9,33 @@
 #include <iomanip>
 #include <cassert>
 
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <cfloat>
+#include <cmath>
+
+#ifdef _WIN32
+#define PSAPI_VERSION 2
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include <glm/glm.hpp>
 #include <netcdf.h>
 
+#include <Utils/File/Logfile.hpp>
+#include <Utils/Convert.hpp>
+
+#include "BinLinesFile.hpp"
+#include "ThreadPool.hpp"
 #include "NetCDFConverter.hpp"
 
 #if defined(DEBUG) || !defined(NDEBUG)
@@ -211,57 +235,6 @@ void loadFloatArray3D(int ncid, const char *varname, size_t zstart, size_t ystar
 
 
 
-Trajectories convertLatLonToCartesian(float *lat, float *lon, float *pressure, size_t trajectoryDim,
-        size_t timeDim) {
-    Trajectories trajectories;
-    trajectories.reserve(timeDim);
-
-    float minPressure = FLT_MAX;
-    float maxPressure = -FLT_MAX;
-    //float minPressure = 1200.0f;
-    //float maxPressure = 0.0001f;
-	#pragma omp parallel for reduction(min:minPressure) reduction(max:maxPressure)
-	for (size_t idx = 0; idx < trajectoryDim*timeDim; idx++) {
-	    if (pressure[idx] > 0.0f) {
-            minPressure = std::min(minPressure, pressure[idx]);
-	    }
-		maxPressure = std::max(maxPressure, pressure[idx]);
-	}
-	float logMinPressure = log(minPressure);
-	float logMaxPressure = log(maxPressure);
-
-    for (int trajectoryIndex = 0; trajectoryIndex < trajectoryDim; trajectoryIndex++) {
-        Trajectory trajectory;
-        trajectory.attributes.resize(1);
-        std::vector<glm::vec3> &cartesianCoords = trajectory.positions;
-        std::vector<float> &pressureAttr = trajectory.attributes.at(0);
-        cartesianCoords.reserve(trajectoryDim);
-        pressureAttr.reserve(trajectoryDim);
-        for (int i = 0; i < timeDim; i++) {
-            int index = i + trajectoryIndex*timeDim;
-            float pressureAtIdx = pressure[index];
-            if (pressureAtIdx <= 0.0f) {
-                continue;
-            }
-            //float normalizedPressure = (pressureAtIdx - minPressure) / (maxPressure - minPressure);
-            float normalizedLogPressure = (log(pressureAtIdx) - logMaxPressure) / (logMinPressure - logMaxPressure);
-            float x = lat[index]/100.0f;
-            float y = normalizedLogPressure;
-            float z = lon[index]/100.0f;
-
-            glm::vec3 cartesianCoord = glm::vec3(x, y, z);
-
-            cartesianCoords.push_back(cartesianCoord);
-            pressureAttr.push_back(pressureAtIdx);
-        }
-
-        if (!trajectory.positions.empty()) {
-            trajectories.push_back(trajectory);
-        }
-    }
-    return trajectories;
-}
-
 /**
  * Exports the passed trajectories to an .obj file. The normalized pressure is stored as a texture coordinate.
  * @param trajectories The trajectory paths to export.
@@ -309,56 +282,283 @@ void exportObjFile(Trajectories &trajectories, const std::string &filename)
     outfile.close();
 }
 
-Trajectories loadNetCdfFile(const std::string &filename)
+static double getCurrentTimeSeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double getPeakResidentSetSizeMiB()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return double(counters.PeakWorkingSetSize) / (1024.0 * 1024.0);
+    }
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        return double(usage.ru_maxrss) / (1024.0 * 1024.0); // Bytes
+#else
+        return double(usage.ru_maxrss) / 1024.0; // KiB
+#endif
+    }
+#endif
+    return 0.0;
+}
+
+/// The variables lat, lon and pressure of the WCB files have the dimensions (ensemble, trajectory, time).
+static bool readTrajectoryHyperslab(int ncid, int varid, size_t firstTrajectory, size_t numTrajectories,
+        size_t timeDim, float *data)
+{
+    size_t startp[] = {0, firstTrajectory, 0};
+    size_t countp[] = {1, numTrajectories, timeDim};
+    return nc_get_vara_float(ncid, varid, startp, countp, data) == NC_NOERR;
+}
+
+/// A chunk of trajectories on its way through the pipeline (read -> convert -> consume).
+struct NetCdfChunk
+{
+    size_t firstTrajectory = 0;
+    size_t numTrajectories = 0;
+    std::vector<float> lat, lon, pressure;
+    TrajectorySet trajectories;
+    std::future<void> converted;
+};
+
+/**
+ * Converts the trajectories of a chunk to Cartesian coordinates. Like before the chunked loading was introduced,
+ * points with missing values (pressure <= 0) are skipped and trajectories without valid points are removed.
+ */
+static void convertNetCdfChunk(NetCdfChunk &chunk, size_t timeDim, float logMinPressure, float logMaxPressure,
+        const NetCdfReadSettings &settings)
+{
+    std::vector<size_t> sourceTrajectories;
+    std::vector<size_t> numPointsPerLine;
+    for (size_t trajectoryIndex = 0; trajectoryIndex < chunk.numTrajectories; trajectoryIndex++) {
+        const float *pressure = chunk.pressure.data() + trajectoryIndex * timeDim;
+        size_t numValidPoints = 0;
+        for (size_t i = 0; i < timeDim; i++) {
+            if (pressure[i] > 0.0f) {
+                numValidPoints++;
+            }
+        }
+        if (numValidPoints > 0) {
+            sourceTrajectories.push_back(trajectoryIndex);
+            numPointsPerLine.push_back(numValidPoints);
+        }
+    }
+
+    chunk.trajectories.allocate(numPointsPerLine, 1);
+    for (size_t lineIndex = 0; lineIndex < sourceTrajectories.size(); lineIndex++) {
+        const size_t offset = sourceTrajectories.at(lineIndex) * timeDim;
+        ArrayView<glm::vec3> cartesianCoords = chunk.trajectories.getPositions(lineIndex);
+        ArrayView<float> pressureAttr = chunk.trajectories.getAttribute(lineIndex, 0);
+        size_t pointIndex = 0;
+        for (size_t i = 0; i < timeDim; i++) {
+            float pressureAtIdx = chunk.pressure[offset + i];
+            if (pressureAtIdx <= 0.0f) {
+                continue;
+            }
+            float normalizedLogPressure = (log(pressureAtIdx) - logMaxPressure) / (logMinPressure - logMaxPressure);
+            cartesianCoords[pointIndex] = glm::vec3(
+                    chunk.lat[offset + i] / 100.0f, normalizedLogPressure, chunk.lon[offset + i] / 100.0f);
+            pressureAttr[pointIndex] = pressureAtIdx;
+            pointIndex++;
+        }
+    }
+
+    if (settings.computeAttributes) {
+        computeTrajectoryAttributes(settings.trajectoryType, chunk.trajectories);
+    }
+}
+
+bool loadNetCdfFileChunked(const std::string &filename, const NetCdfReadSettings &settings,
+        const NetCdfChunkConsumer &consumer, NetCdfReadStatistics *statistics)
 {
-    Trajectories trajectories;
+    double startTime = getCurrentTimeSeconds();
 
-    // File handle
     int ncid;
+    if (nc_open(filename.c_str(), NC_NOWRITE, &ncid) != NC_NOERR) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in loadNetCdfFile: File \"" + filename
+                + "\" couldn't be opened.");
+        return false;
+    }
 
-    // Open the NetCDF file for reading
-    int status = nc_open(filename.c_str(), NC_NOWRITE, &ncid);
-    if (status != 0) {
-        std::cerr << "ERROR in loadNetCdfFile: File \"" << filename << "\" couldn't be opened!" << std::endl;
-        return trajectories;
+    int timeDimId, trajectoryDimId, latVarId, lonVarId, pressureVarId;
+    size_t timeDim = 0, trajectoryDim = 0;
+    if (nc_inq_dimid(ncid, "time", &timeDimId) != NC_NOERR || nc_inq_dimlen(ncid, timeDimId, &timeDim) != NC_NOERR
+            || nc_inq_dimid(ncid, "trajectory", &trajectoryDimId) != NC_NOERR
+            || nc_inq_dimlen(ncid, trajectoryDimId, &trajectoryDim) != NC_NOERR
+            || nc_inq_varid(ncid, "lat", &latVarId) != NC_NOERR || nc_inq_varid(ncid, "lon", &lonVarId) != NC_NOERR
+            || nc_inq_varid(ncid, "pressure", &pressureVarId) != NC_NOERR) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in loadNetCdfFile: File \"" + filename
+                + "\" is not a trajectory file.");
+        nc_close(ncid);
+        return false;
     }
 
-    // Load dimension data
-    size_t timeDim = getDim(ncid, "time");
-    size_t trajectoryDim = getDim(ncid, "trajectory");
-    size_t ensembleDim = getDim(ncid, "ensemble");
-    size_t startLonDim = getDim(ncid, "start_lon");
-    size_t startLatDim = getDim(ncid, "start_lat");
-    size_t timeIntervalDim = getDim(ncid, "time_interval");
-
-    // Load data arrays
-    double *time = NULL;
-    float *lon = NULL, *lat = NULL, *pressure = NULL, *startLon = NULL, *startLat = NULL, *timeInterval = NULL;
-    loadDoubleArray1D(ncid, "time", timeDim, &time);
-    loadFloatArray3D(ncid, "lon", 1, trajectoryDim, timeDim, &lon);
-    loadFloatArray3D(ncid, "lat", 1, trajectoryDim, timeDim, &lat);
-    loadFloatArray3D(ncid, "pressure", 1, trajectoryDim, timeDim, &pressure);
-    loadFloatArray1D(ncid, "start_lon", startLonDim, &startLon);
-    loadFloatArray1D(ncid, "start_lat", startLatDim, &startLat);
-    loadFloatArray1D(ncid, "time_interval", timeIntervalDim, &timeInterval);
-
-
-    trajectories = convertLatLonToCartesian(lat, lon, pressure, trajectoryDim, timeDim);
-    std::string outputFilename = filename.substr(0, filename.find_last_of(".")) + ".obj";
-    //exportObjFile(trajectories, outputFilename);
-
-
-    // Close the file
-    myassert(nc_close(ncid) == NC_NOERR);
-
-    SAFE_DELETE_ARRAY(time);
-    SAFE_DELETE_ARRAY(lon);
-    SAFE_DELETE_ARRAY(lat);
-    SAFE_DELETE_ARRAY(pressure);
-    SAFE_DELETE_ARRAY(startLon);
-    SAFE_DELETE_ARRAY(startLat);
-    SAFE_DELETE_ARRAY(timeInterval);
-
-    return trajectories;
+    const size_t bytesPerTrajectory = std::max(timeDim, size_t(1)) * 3 * sizeof(float);
+    const size_t numTrajectoriesPerChunk = std::max(
+            std::max(settings.chunkSizeMiB, size_t(1)) * 1024 * 1024 / bytesPerTrajectory, size_t(1));
+    const size_t numChunks = (trajectoryDim + numTrajectoriesPerChunk - 1) / numTrajectoriesPerChunk;
+    size_t bytesRead = 0;
+    bool success = true;
+
+    // Pass 1: Range of the (valid) pressure values for the logarithmic normalization.
+    float minPressure = FLT_MAX;
+    float maxPressure = -FLT_MAX;
+    {
+        std::vector<float> pressure(numTrajectoriesPerChunk * timeDim);
+        for (size_t chunkIndex = 0; chunkIndex < numChunks && success; chunkIndex++) {
+            size_t firstTrajectory = chunkIndex * numTrajectoriesPerChunk;
+            size_t numTrajectories = std::min(numTrajectoriesPerChunk, trajectoryDim - firstTrajectory);
+            success = readTrajectoryHyperslab(ncid, pressureVarId, firstTrajectory, numTrajectories, timeDim,
+                    pressure.data());
+            bytesRead += numTrajectories * timeDim * sizeof(float);
+            const size_t numValues = numTrajectories * timeDim;
+            #pragma omp parallel for reduction(min:minPressure) reduction(max:maxPressure)
+            for (size_t idx = 0; idx < numValues; idx++) {
+                if (pressure[idx] > 0.0f) {
+                    minPressure = std::min(minPressure, pressure[idx]);
+                }
+                maxPressure = std::max(maxPressure, pressure[idx]);
+            }
+        }
+    }
+    const float logMinPressure = log(minPressure);
+    const float logMaxPressure = log(maxPressure);
+
+    // Pass 2: The calling thread reads chunk i while the workers convert the chunks before it. Chunk i reuses the
+    // buffers of chunk i - numSlots, which is handed to the consumer first.
+    size_t numWorkerThreads = settings.numWorkerThreads;
+    if (numWorkerThreads == 0) {
+        numWorkerThreads = std::max(size_t(std::thread::hardware_concurrency()), size_t(1));
+    }
+    const size_t numSlots = std::min(numWorkerThreads + 1, std::max(numChunks, size_t(1)));
+    std::vector<NetCdfChunk> slots(numSlots);
+    size_t numTrajectoriesTotal = 0, numPointsTotal = 0;
+    {
+        ThreadPool threadPool(numWorkerThreads);
+        for (size_t chunkIndex = 0; chunkIndex < numChunks + numSlots; chunkIndex++) {
+            NetCdfChunk &chunk = slots.at(chunkIndex % numSlots);
+            if (chunkIndex >= numSlots && chunk.converted.valid()) {
+                try {
+                    chunk.converted.get();
+                    if (success) {
+                        numTrajectoriesTotal += chunk.trajectories.getNumTrajectories();
+                        numPointsTotal += chunk.trajectories.getNumPoints();
+                        success = consumer(chunk.trajectories);
+                    }
+                } catch (const std::exception &exception) {
+                    sgl::Logfile::get()->writeError(std::string() + "Error in loadNetCdfFile: "
+                            + exception.what());
+                    success = false;
+                }
+                chunk.trajectories = TrajectorySet();
+            }
+            if (chunkIndex >= numChunks || !success) {
+                continue;
+            }
+
+            chunk.firstTrajectory = chunkIndex * numTrajectoriesPerChunk;
+            chunk.numTrajectories = std::min(numTrajectoriesPerChunk, trajectoryDim - chunk.firstTrajectory);
+            const size_t numValues = chunk.numTrajectories * timeDim;
+            chunk.lat.resize(numValues);
+            chunk.lon.resize(numValues);
+            chunk.pressure.resize(numValues);
+            success = readTrajectoryHyperslab(ncid, latVarId, chunk.firstTrajectory, chunk.numTrajectories,
+                            timeDim, chunk.lat.data())
+                    && readTrajectoryHyperslab(ncid, lonVarId, chunk.firstTrajectory, chunk.numTrajectories,
+                            timeDim, chunk.lon.data())
+                    && readTrajectoryHyperslab(ncid, pressureVarId, chunk.firstTrajectory, chunk.numTrajectories,
+                            timeDim, chunk.pressure.data());
+            bytesRead += 3 * numValues * sizeof(float);
+            if (!success) {
+                continue;
+            }
+
+            std::shared_ptr<std::promise<void>> promise(new std::promise<void>);
+            chunk.converted = promise->get_future();
+            threadPool.enqueue([&chunk, promise, timeDim, logMinPressure, logMaxPressure, &settings]() {
+                try {
+#ifdef _OPENMP
+                    // The chunks are already processed in parallel; avoid nested thread teams in the workers.
+                    omp_set_num_threads(1);
+#endif
+                    convertNetCdfChunk(chunk, timeDim, logMinPressure, logMaxPressure, settings);
+                    promise->set_value();
+                } catch (...) {
+                    promise->set_exception(std::current_exception());
+                }
+            });
+        }
+    }
+
+    nc_close(ncid);
+
+    if (!success) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in loadNetCdfFile: Could not load file \""
+                + filename + "\".");
+        return false;
+    }
+
+    double elapsedSeconds = std::max(getCurrentTimeSeconds() - startTime, 1e-9);
+    double throughputMBs = bytesRead / (1024.0 * 1024.0) / elapsedSeconds;
+    double peakResidentSetSizeMiB = getPeakResidentSetSizeMiB();
+    sgl::Logfile::get()->writeInfo(std::string() + "Loaded " + sgl::toString(numTrajectoriesTotal)
+            + " trajectories from \"" + filename + "\" in " + sgl::toString(elapsedSeconds) + "s ("
+            + sgl::toString(throughputMBs) + " MB/s, peak RSS " + sgl::toString(peakResidentSetSizeMiB) + " MiB).");
+    if (statistics) {
+        statistics->numChunks = numChunks;
+        statistics->numTrajectories = numTrajectoriesTotal;
+        statistics->numPoints = numPointsTotal;
+        statistics->bytesRead = bytesRead;
+        statistics->elapsedSeconds = elapsedSeconds;
+        statistics->throughputMBs = throughputMBs;
+        statistics->peakResidentSetSizeMiB = peakResidentSetSizeMiB;
+    }
+    return true;
 }
 
+bool loadNetCdfFile(const std::string &filename, TrajectorySet &trajectories, const NetCdfReadSettings &settings,
+        NetCdfReadStatistics *statistics)
+{
+    trajectories = TrajectorySet();
+    bool success = loadNetCdfFileChunked(filename, settings, [&trajectories](TrajectorySet &chunk) {
+        if (trajectories.empty()) {
+            trajectories = std::move(chunk);
+        } else {
+            trajectories.append(chunk);
+        }
+        return true;
+    }, statistics);
+    if (!success) {
+        trajectories = TrajectorySet();
+    }
+    return success;
+}
+
+Trajectories loadNetCdfFile(const std::string &filename)
+{
+    TrajectorySet trajectories;
+    loadNetCdfFile(filename, trajectories);
+    return trajectories.toTrajectories();
+}
+
+bool convertNetCdfFileToBinLines(const std::string &netCdfFilename, const std::string &binLinesFilename,
+        const NetCdfReadSettings &settings, NetCdfReadStatistics *statistics)
+{
+    BinLinesStreamWriter writer;
+    if (!writer.open(binLinesFilename)) {
+        return false;
+    }
+    bool success = loadNetCdfFileChunked(netCdfFilename, settings, [&writer](TrajectorySet &chunk) {
+        return writer.writeTrajectories(chunk);
+    }, statistics);
+    if (!success) {
+        writer.abort();
+        return false;
+    }
+    return writer.finish();
+}
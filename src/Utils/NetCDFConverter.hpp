@@ -6,8 +6,58 @@
 #define NETCDFIMPORTER_NETCDFCONVERTER_HPP
 
 #include <string>
+#include <functional>
 #include "TrajectoryFile.hpp"
 
+struct NetCdfReadSettings
+{
+    /// Approximate size of the input data (lat, lon, pressure) of one chunk of trajectories.
+    size_t chunkSizeMiB = 64;
+    /// Number of worker threads converting the chunks (0: number of hardware threads). At most one more chunk than
+    /// workers is held in memory at once.
+    size_t numWorkerThreads = 0;
+    /// If set, the workers also compute the importance criteria (see computeTrajectoryAttributes) of each chunk.
+    bool computeAttributes = false;
+    TrajectoryType trajectoryType = TRAJECTORY_TYPE_WCB;
+};
+
+struct NetCdfReadStatistics
+{
+    size_t numChunks = 0;
+    size_t numTrajectories = 0; ///< Without the trajectories consisting only of missing values.
+    size_t numPoints = 0;
+    size_t bytesRead = 0;
+    double elapsedSeconds = 0.0;
+    double throughputMBs = 0.0;
+    /// Peak resident set size of the process (i.e., including memory allocated before loading the file).
+    double peakResidentSetSizeMiB = 0.0;
+};
+
+/// Receives the converted trajectories of one chunk. Returning false stops the loading.
+typedef std::function<bool(TrajectorySet &chunk)> NetCdfChunkConsumer;
+
+/**
+ * Reads the trajectories of a NetCDF file (WCB format) in chunks of trajectories (hyperslabs of the variables lat, lon
+ * and pressure). While the calling thread reads the next chunk, previously read chunks are filtered (missing values)
+ * and converted on a worker pool. The consumer is called on the calling thread in the order of the chunks in the
+ * file, so the memory usage is bounded by a few chunks plus what the consumer keeps.
+ * The pressure is normalized logarithmically over the whole file, which needs one additional pass over the pressure.
+ * @return False if the file could not be read or the consumer stopped the loading.
+ */
+bool loadNetCdfFileChunked(const std::string &filename, const NetCdfReadSettings &settings,
+        const NetCdfChunkConsumer &consumer, NetCdfReadStatistics *statistics = nullptr);
+
+/// Loads all trajectories of a NetCDF file into a TrajectorySet (see loadNetCdfFileChunked).
+bool loadNetCdfFile(const std::string &filename, TrajectorySet &trajectories,
+        const NetCdfReadSettings &settings = NetCdfReadSettings(), NetCdfReadStatistics *statistics = nullptr);
+
 Trajectories loadNetCdfFile(const std::string &filename);
 
+/**
+ * Converts a NetCDF file to a version 1 .binlines file without holding all trajectories in memory
+ * (see BinLinesStreamWriter).
+ */
+bool convertNetCdfFileToBinLines(const std::string &netCdfFilename, const std::string &binLinesFilename,
+        const NetCdfReadSettings &settings = NetCdfReadSettings(), NetCdfReadStatistics *statistics = nullptr);
+
 #endif //NETCDFIMPORTER_NETCDFCONVERTER_HPP
@@ -0,0 +1,189 @@
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cfloat>
+#include <clocale>
+#include <string>
+
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
+
+#include "NumberParser.hpp"
+
+static inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\v' || c == '\f';
+}
+
+static inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/// Exactly representable powers of ten in double precision.
+static const double POWERS_OF_TEN[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const int MAX_EXACT_POWER_OF_TEN = 22;
+static const uint64_t MAX_EXACT_MANTISSA = (1ull << 53u);
+
+/**
+ * Slow path using strtof with the "C" locale (independent of the global locale of the application).
+ */
+static const char *parseFloatFallback(const char *str, const char *end, float &value)
+{
+    // strtof needs a null-terminated string
+    const char *tokenEnd = str;
+    while (tokenEnd < end && !isBlank(*tokenEnd) && *tokenEnd != '\n' && *tokenEnd != '\r') {
+        tokenEnd++;
+    }
+    std::string token(str, tokenEnd);
+
+    char *parseEnd = nullptr;
+#ifdef _WIN32
+    static _locale_t cLocale = _create_locale(LC_NUMERIC, "C");
+    float parsedValue = _strtof_l(token.c_str(), &parseEnd, cLocale);
+#else
+    static locale_t cLocale = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+    float parsedValue = strtof_l(token.c_str(), &parseEnd, cLocale);
+#endif
+    if (parseEnd == token.c_str()) {
+        return nullptr;
+    }
+    value = parsedValue;
+    return str + (parseEnd - token.c_str());
+}
+
+const char *parseFloat(const char *str, const char *end, float &value)
+{
+    const char *ptr = str;
+    while (ptr < end && isBlank(*ptr)) {
+        ptr++;
+    }
+    const char *numberStart = ptr;
+
+    bool negative = false;
+    if (ptr < end && (*ptr == '+' || *ptr == '-')) {
+        negative = *ptr == '-';
+        ptr++;
+    }
+
+    // Accumulate all digits of the mantissa in an integer; the decimal point only shifts the exponent
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+    bool mantissaOverflow = false;
+    while (ptr < end && isDigit(*ptr)) {
+        if (mantissa < MAX_EXACT_MANTISSA / 10) {
+            mantissa = mantissa * 10 + uint64_t(*ptr - '0');
+        } else {
+            mantissaOverflow = true;
+        }
+        hasDigits = true;
+        ptr++;
+    }
+    if (ptr < end && (*ptr == 'x' || *ptr == 'X')) {
+        // Hexadecimal float
+        return parseFloatFallback(numberStart, end, value);
+    }
+    if (ptr < end && *ptr == '.') {
+        ptr++;
+        while (ptr < end && isDigit(*ptr)) {
+            if (mantissa < MAX_EXACT_MANTISSA / 10) {
+                mantissa = mantissa * 10 + uint64_t(*ptr - '0');
+                exponent--;
+            } else {
+                mantissaOverflow = true;
+            }
+            hasDigits = true;
+            ptr++;
+        }
+    }
+    if (!hasDigits) {
+        // E.g. inf, nan or no number at all
+        return parseFloatFallback(numberStart, end, value);
+    }
+    if (ptr < end && (*ptr == 'e' || *ptr == 'E')) {
+        // The exponent is only consumed if at least one digit follows (like strtof)
+        const char *exponentPtr = ptr + 1;
+        bool negativeExponent = false;
+        if (exponentPtr < end && (*exponentPtr == '+' || *exponentPtr == '-')) {
+            negativeExponent = *exponentPtr == '-';
+            exponentPtr++;
+        }
+        if (exponentPtr < end && isDigit(*exponentPtr)) {
+            int explicitExponent = 0;
+            while (exponentPtr < end && isDigit(*exponentPtr)) {
+                if (explicitExponent < 100000) {
+                    explicitExponent = explicitExponent * 10 + (*exponentPtr - '0');
+                }
+                exponentPtr++;
+            }
+            exponent += negativeExponent ? -explicitExponent : explicitExponent;
+            ptr = exponentPtr;
+        }
+    }
+
+    if (mantissaOverflow) {
+        return parseFloatFallback(numberStart, end, value);
+    }
+    if (mantissa == 0) {
+        value = negative ? -0.0f : 0.0f;
+        return ptr;
+    }
+    if (exponent < -MAX_EXACT_POWER_OF_TEN || exponent > MAX_EXACT_POWER_OF_TEN) {
+        return parseFloatFallback(numberStart, end, value);
+    }
+
+    // Mantissa and power of ten are exact, so the result is the correctly rounded double of the decimal number.
+    double doubleValue = double(mantissa);
+    if (exponent < 0) {
+        doubleValue /= POWERS_OF_TEN[-exponent];
+    } else {
+        doubleValue *= POWERS_OF_TEN[exponent];
+    }
+
+    // Rounding the double to float gives the correctly rounded float unless the double lies exactly on the midpoint
+    // between two floats (double rounding) or the float would be denormalized.
+    uint64_t doubleBits;
+    memcpy(&doubleBits, &doubleValue, sizeof(double));
+    const uint64_t lowerBitsMask = (1ull << 29u) - 1ull;
+    if ((doubleBits & lowerBitsMask) == (1ull << 28u) || doubleValue < double(FLT_MIN)
+            || doubleValue > double(FLT_MAX)) {
+        return parseFloatFallback(numberStart, end, value);
+    }
+
+    value = negative ? -float(doubleValue) : float(doubleValue);
+    return ptr;
+}
+
+const char *parseInt(const char *str, const char *end, int &value)
+{
+    const char *ptr = str;
+    while (ptr < end && isBlank(*ptr)) {
+        ptr++;
+    }
+
+    bool negative = false;
+    if (ptr < end && (*ptr == '+' || *ptr == '-')) {
+        negative = *ptr == '-';
+        ptr++;
+    }
+
+    if (ptr >= end || !isDigit(*ptr)) {
+        return nullptr;
+    }
+    int64_t result = 0;
+    while (ptr < end && isDigit(*ptr)) {
+        // Overflow is undefined for atoi; just avoid undefined behavior here
+        if (result < (int64_t(1) << 40)) {
+            result = result * 10 + (*ptr - '0');
+        }
+        ptr++;
+    }
+
+    value = int(negative ? -result : result);
+    return ptr;
+}
@@ -0,0 +1,30 @@
+#ifndef PIXELSYNCOIT_NUMBERPARSER_HPP
+#define PIXELSYNCOIT_NUMBERPARSER_HPP
+
+/**
+ * Locale-independent parsing of decimal numbers from character ranges that do not need to be null-terminated
+ * (e.g., memory-mapped text files). The functions skip leading spaces and tabs like sscanf/atoi do.
+ */
+
+/**
+ * Parses a floating point number. The result is identical to strtof/sscanf("%f") in the "C" locale, i.e., the
+ * number is rounded correctly. Typical decimal numbers (up to 15 significant digits, exponents up to +-22) are
+ * converted with a fast path that needs only one double-precision operation; all other inputs (hexadecimal floats,
+ * inf/nan, very long mantissas or exponents, rounding ties) use strtof with the "C" locale.
+ * @param str The first character to parse.
+ * @param end The end of the character range.
+ * @param value The parsed value (only written on success).
+ * @return A pointer to the first character after the number, or nullptr if no number could be parsed.
+ */
+const char *parseFloat(const char *str, const char *end, float &value);
+
+/**
+ * Parses a signed decimal integer (same semantics as atoi, i.e., parsing stops at the first non-digit character).
+ * @param str The first character to parse.
+ * @param end The end of the character range.
+ * @param value The parsed value (only written on success).
+ * @return A pointer to the first character after the number, or nullptr if no number could be parsed.
+ */
+const char *parseInt(const char *str, const char *end, int &value);
+
+#endif //PIXELSYNCOIT_NUMBERPARSER_HPP
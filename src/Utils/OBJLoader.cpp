@@ -263,7 +263,7 @@ void addMaterialsFromFile(const std::string &filename, const std::string &objFil
     file.close();
 }
 
-void convertObjMeshToBinary(
+bool convertObjMeshToBinary(
         const std::string &objFilename,
         const std::string &binaryFilename)
 {
@@ -271,7 +271,7 @@ void convertObjMeshToBinary(
 
     if (!file.is_open()) {
         Logfile::get()->writeError(string() + "Error in parseObjMesh: File \"" + objFilename + "\" does not exist.");
-        return;
+        return false;
     }
 
     vector<TempSubmesh> tempMesh;
@@ -408,7 +408,7 @@ void convertObjMeshToBinary(
     }
 
 
-    writeMesh3D(binaryFilename, binaryMesh);
+    return writeMesh3D(binaryFilename, binaryMesh);
 }
 
 
@@ -0,0 +1,165 @@
+#ifndef PIXELSYNCOIT_PARALLELALGORITHMS_HPP
+#define PIXELSYNCOIT_PARALLELALGORITHMS_HPP
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * Computes the exclusive prefix sum of the passed values, i.e., output[i] = input[0] + ... + input[i-1].
+ * The array is split into one contiguous block per thread. Each thread sums its block, the block sums are scanned
+ * serially and finally each thread scans its block starting at the offset of the block.
+ * As only integer types are used for offsets, the result does not depend on the number of threads.
+ * @param input The values to sum up.
+ * @param output The exclusive prefix sum (may be identical to input for an in-place scan).
+ * @param n The number of elements in input and output.
+ * @return The sum of all values.
+ */
+template<typename T>
+T parallelExclusivePrefixSum(const T *input, T *output, size_t n)
+{
+    if (n == 0) {
+        return T(0);
+    }
+
+    int numThreads = 1;
+#ifdef _OPENMP
+    // Only parallelize for larger arrays; otherwise the thread synchronization dominates.
+    if (n >= 1u << 16u) {
+        numThreads = omp_get_max_threads();
+    }
+#endif
+    std::vector<T> blockSums(numThreads + 1, T(0));
+    T totalSum = T(0);
+
+    #pragma omp parallel num_threads(numThreads)
+    {
+        int threadIdx = 0;
+        int numActiveThreads = 1;
+#ifdef _OPENMP
+        threadIdx = omp_get_thread_num();
+        numActiveThreads = omp_get_num_threads();
+#endif
+        size_t blockStart = n * threadIdx / numActiveThreads;
+        size_t blockEnd = n * (threadIdx + 1) / numActiveThreads;
+
+        T localSum = T(0);
+        for (size_t i = blockStart; i < blockEnd; i++) {
+            localSum += input[i];
+        }
+        blockSums.at(threadIdx + 1) = localSum;
+
+        #pragma omp barrier
+        #pragma omp single
+        {
+            for (int i = 0; i < numActiveThreads; i++) {
+                blockSums.at(i + 1) += blockSums.at(i);
+            }
+            totalSum = blockSums.at(numActiveThreads);
+        }
+
+        T runningSum = blockSums.at(threadIdx);
+        for (size_t i = blockStart; i < blockEnd; i++) {
+            T value = input[i];
+            output[i] = runningSum;
+            runningSum += value;
+        }
+    }
+
+    return totalSum;
+}
+
+template<typename T>
+T parallelExclusivePrefixSum(const std::vector<T> &input, std::vector<T> &output)
+{
+    output.resize(input.size());
+    return parallelExclusivePrefixSum(input.data(), output.data(), input.size());
+}
+
+/**
+ * Stable LSD radix sort of values by an unsigned key of up to 64 bits with 8 bits per pass. Only as many passes as
+ * necessary for maxKey are performed. In each pass, every thread counts the digits of its contiguous block, the scatter offsets
+ * are computed in (digit, block) order and the blocks are scattered. Thus, values with equal keys keep their input
+ * order and the result does not depend on the number of threads.
+ * @param values The values to sort.
+ * @param getKey A functor returning the key of a value (uint32_t or uint64_t).
+ * @param maxKey The largest key of all values.
+ */
+template<typename T, typename KeyFunctor>
+void parallelRadixSort(std::vector<T> &values, KeyFunctor getKey, uint64_t maxKey)
+{
+    const size_t n = values.size();
+    int numPasses = 0;
+    for (uint64_t key = maxKey; key > 0; key >>= 8u) {
+        numPasses++;
+    }
+    if (n < 2 || numPasses == 0) {
+        return;
+    }
+
+    int numThreads = 1;
+#ifdef _OPENMP
+    if (n >= 1u << 16u) {
+        numThreads = omp_get_max_threads();
+    }
+#endif
+    const size_t NUM_BUCKETS = 256;
+    std::vector<size_t> histograms(numThreads * NUM_BUCKETS);
+    std::vector<T> tmpValues(n);
+    T *src = values.data();
+    T *dst = tmpValues.data();
+
+    for (int pass = 0; pass < numPasses; pass++) {
+        const uint32_t shift = uint32_t(pass) * 8u;
+
+        #pragma omp parallel num_threads(numThreads)
+        {
+            int threadIdx = 0;
+            int numActiveThreads = 1;
+#ifdef _OPENMP
+            threadIdx = omp_get_thread_num();
+            numActiveThreads = omp_get_num_threads();
+#endif
+            size_t blockStart = n * threadIdx / numActiveThreads;
+            size_t blockEnd = n * (threadIdx + 1) / numActiveThreads;
+            size_t *histogram = &histograms[threadIdx * NUM_BUCKETS];
+
+            for (size_t digit = 0; digit < NUM_BUCKETS; digit++) {
+                histogram[digit] = 0;
+            }
+            for (size_t i = blockStart; i < blockEnd; i++) {
+                histogram[(getKey(src[i]) >> shift) & 0xFFu]++;
+            }
+
+            #pragma omp barrier
+            #pragma omp single
+            {
+                size_t offset = 0;
+                for (size_t digit = 0; digit < NUM_BUCKETS; digit++) {
+                    for (int i = 0; i < numActiveThreads; i++) {
+                        size_t count = histograms[i * NUM_BUCKETS + digit];
+                        histograms[i * NUM_BUCKETS + digit] = offset;
+                        offset += count;
+                    }
+                }
+            }
+
+            for (size_t i = blockStart; i < blockEnd; i++) {
+                dst[histogram[(getKey(src[i]) >> shift) & 0xFFu]++] = src[i];
+            }
+        }
+
+        std::swap(src, dst);
+    }
+
+    if (src != values.data()) {
+        values.swap(tmpValues);
+    }
+}
+
+#endif //PIXELSYNCOIT_PARALLELALGORITHMS_HPP
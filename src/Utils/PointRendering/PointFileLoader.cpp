@@ -37,7 +37,7 @@
 // timestep.xml -> uintah
 // .dat -> cosmic_web
 
-void convertPointDataSetToBinmesh(
+bool convertPointDataSetToBinmesh(
         const std::string &inputFilename,
         const std::string &binaryFilename) {
     sgl::Logfile::get()->writeInfo(std::string() + "Loading point data from \"" + inputFilename + "\"...");
@@ -51,7 +51,7 @@ void convertPointDataSetToBinmesh(
         sgl::Logfile::get()->writeError(
                 std::string() + "Error: Unknown point data set file association for \""
                 + inputFilename + "\"!");
-        return;
+        return false;
     }
 
     auto positions = static_cast<pl::DataT<float>*>(particleModel["positions"].get());
@@ -154,6 +154,9 @@ void convertPointDataSetToBinmesh(
     binarySubmesh.attributes.push_back(vertexAttribute);*/
 
     sgl::Logfile::get()->writeInfo(std::string() + "Writing binary mesh...");
-    writeMesh3D(binaryFilename, binaryMesh);
+    if (!writeMesh3D(binaryFilename, binaryMesh)) {
+        return false;
+    }
     sgl::Logfile::get()->writeInfo(std::string() + "Finished writing binary mesh.");
-}
\ No newline at end of file
+    return true;
+}
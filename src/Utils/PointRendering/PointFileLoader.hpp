@@ -35,8 +35,9 @@
  * - .dat -> cosmic_web data set
  * @param inputFilename The file name of the input data set.
  * @param binaryFilename: The file name of the binary output file.
+ * @return False if the input file couldn't be read or the binary file couldn't be written.
  */
-void convertPointDataSetToBinmesh(
+bool convertPointDataSetToBinmesh(
         const std::string &inputFilename,
         const std::string &binaryFilename);
 
@@ -0,0 +1,30 @@
+#include <algorithm>
+#include <cstring>
+
+#include "RandomPermutation.hpp"
+
+RandomPermutation::RandomPermutation(uint64_t size, uint64_t seed) : size(size)
+{
+    // Smallest number of bits b with 2^b >= size, rounded up to an even number for a balanced network.
+    uint32_t numBits = 0;
+    while (numBits < 64u && (uint64_t(1) << numBits) < size) {
+        numBits++;
+    }
+    halfBits = std::max((numBits + 1u) / 2u, 1u);
+    halfMask = (uint64_t(1) << halfBits) - 1u;
+    for (int round = 0; round < NUM_ROUNDS; round++) {
+        roundKeys[round] = counterBasedRandom(seed, uint64_t(round));
+    }
+}
+
+void shufflePrimitives(const uint32_t *indices, size_t numPrimitives, size_t primitiveSize, uint64_t seed,
+        uint32_t *shuffledIndices)
+{
+    RandomPermutation permutation(numPrimitives, seed);
+    #pragma omp parallel for
+    for (size_t i = 0; i < numPrimitives; i++) {
+        size_t primitiveIndex = size_t(permutation(i));
+        memcpy(shuffledIndices + i * primitiveSize, indices + primitiveIndex * primitiveSize,
+                primitiveSize * sizeof(uint32_t));
+    }
+}
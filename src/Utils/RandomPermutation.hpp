@@ -0,0 +1,72 @@
+#ifndef PIXELSYNCOIT_RANDOMPERMUTATION_HPP
+#define PIXELSYNCOIT_RANDOMPERMUTATION_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Counter-based random number generator: The random number "counter" of the stream "key" is computed directly
+ * (SplitMix64 mixing function) instead of advancing a state. Thus, random numbers can be generated in parallel and in
+ * any order, and the results do not depend on the number of threads.
+ */
+inline uint64_t counterBasedRandom(uint64_t key, uint64_t counter)
+{
+    uint64_t z = key + (counter + 1u) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30u)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27u)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31u);
+}
+
+/**
+ * A pseudo-random permutation of [0, size) determined by a seed. The permuted index of every element is computed
+ * independently in O(1) time and memory (a balanced Feistel network on the smallest power of four >= size with
+ * counterBasedRandom as round function; values outside of [0, size) are mapped again until they lie inside, i.e.,
+ * cycle walking). This allows for shuffling arrays with billions of elements in parallel without storing the
+ * permutation or a sequential random number stream.
+ */
+class RandomPermutation
+{
+public:
+    RandomPermutation(uint64_t size, uint64_t seed);
+
+    inline uint64_t getSize() const { return size; }
+
+    /// @return The element placed at position "index" of the shuffled sequence.
+    inline uint64_t operator()(uint64_t index) const {
+        if (size <= 1) {
+            return index;
+        }
+        uint64_t value = encrypt(index);
+        while (value >= size) {
+            value = encrypt(value);
+        }
+        return value;
+    }
+
+private:
+    static const int NUM_ROUNDS = 6;
+
+    inline uint64_t encrypt(uint64_t value) const {
+        uint64_t left = value >> halfBits, right = value & halfMask;
+        for (int round = 0; round < NUM_ROUNDS; round++) {
+            uint64_t newRight = left ^ (counterBasedRandom(roundKeys[round], right) & halfMask);
+            left = right;
+            right = newRight;
+        }
+        return (left << halfBits) | right;
+    }
+
+    uint64_t size;
+    uint32_t halfBits;
+    uint64_t halfMask;
+    uint64_t roundKeys[NUM_ROUNDS];
+};
+
+/**
+ * Writes the primitives (groups of primitiveSize consecutive indices, e.g. line segments or triangles) of "indices" in
+ * the order given by RandomPermutation(numPrimitives, seed) to "shuffledIndices" (in parallel).
+ */
+void shufflePrimitives(const uint32_t *indices, size_t numPrimitives, size_t primitiveSize, uint64_t seed,
+        uint32_t *shuffledIndices);
+
+#endif //PIXELSYNCOIT_RANDOMPERMUTATION_HPP
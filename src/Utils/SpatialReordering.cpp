@@ -0,0 +1,426 @@
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+#include "MeshSerializer.hpp"
+#include "ParallelAlgorithms.hpp"
+#include "SpatialReordering.hpp"
+
+/// Number of bits per axis of the space-filling curves (3 * 21 = 63 bits fit into a 64-bit code).
+const uint32_t CURVE_BITS_PER_AXIS = 21;
+
+uint32_t SpatialReorderSettings::getBinaryMeshFlags(bool isTriangleMesh) const
+{
+    uint32_t flags = 0;
+    if (curve == SPACE_FILLING_CURVE_MORTON) {
+        flags |= BINMESH_FLAG_MORTON_ORDER;
+    } else if (curve == SPACE_FILLING_CURVE_HILBERT) {
+        flags |= BINMESH_FLAG_HILBERT_ORDER;
+    }
+    if (optimizeVertexCache && isTriangleMesh) {
+        flags |= BINMESH_FLAG_VERTEX_CACHE_OPTIMIZED;
+    }
+    return flags;
+}
+
+/// Inserts two zero bits between all of the lowest 21 bits.
+static inline uint64_t spreadBits(uint32_t value)
+{
+    uint64_t x = value & 0x1FFFFFu;
+    x = (x | x << 32u) & 0x1F00000000FFFFull;
+    x = (x | x << 16u) & 0x1F0000FF0000FFull;
+    x = (x | x << 8u) & 0x100F00F00F00F00Full;
+    x = (x | x << 4u) & 0x10C30C30C30C30C3ull;
+    x = (x | x << 2u) & 0x1249249249249249ull;
+    return x;
+}
+
+uint64_t computeMortonCode(uint32_t x, uint32_t y, uint32_t z)
+{
+    return (spreadBits(x) << 2u) | (spreadBits(y) << 1u) | spreadBits(z);
+}
+
+uint64_t computeHilbertCode(uint32_t x, uint32_t y, uint32_t z)
+{
+    // Converts the coordinates to the "transposed" Hilbert index (AxestoTranspose), whose bits interleaved like a
+    // Morton code give the index on the curve.
+    uint32_t X[3] = { x & 0x1FFFFFu, y & 0x1FFFFFu, z & 0x1FFFFFu };
+    const uint32_t M = 1u << (CURVE_BITS_PER_AXIS - 1u);
+    uint32_t P, Q, t;
+
+    // Inverse undo
+    for (Q = M; Q > 1; Q >>= 1u) {
+        P = Q - 1;
+        for (int i = 0; i < 3; i++) {
+            if (X[i] & Q) {
+                X[0] ^= P; // invert
+            } else {
+                t = (X[0] ^ X[i]) & P; // exchange
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+
+    // Gray encode
+    for (int i = 1; i < 3; i++) {
+        X[i] ^= X[i-1];
+    }
+    t = 0;
+    for (Q = M; Q > 1; Q >>= 1u) {
+        if (X[2] & Q) {
+            t ^= Q - 1;
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        X[i] ^= t;
+    }
+
+    return computeMortonCode(X[0], X[1], X[2]);
+}
+
+struct CurveSortRecord
+{
+    uint64_t code;
+    uint32_t index;
+};
+
+void computeSpaceFillingCurveOrder(const std::vector<glm::vec3> &points, SpaceFillingCurve curve,
+        std::vector<uint32_t> &order)
+{
+    const size_t numPoints = points.size();
+    order.resize(numPoints);
+    if (curve == SPACE_FILLING_CURVE_NONE || numPoints < 2) {
+        for (size_t i = 0; i < numPoints; i++) {
+            order[i] = uint32_t(i);
+        }
+        return;
+    }
+
+    float minX = FLT_MAX, minY = FLT_MAX, minZ = FLT_MAX;
+    float maxX = -FLT_MAX, maxY = -FLT_MAX, maxZ = -FLT_MAX;
+    #pragma omp parallel for reduction(min:minX,minY,minZ) reduction(max:maxX,maxY,maxZ)
+    for (size_t i = 0; i < numPoints; i++) {
+        const glm::vec3 &point = points[i];
+        minX = std::min(minX, point.x); minY = std::min(minY, point.y); minZ = std::min(minZ, point.z);
+        maxX = std::max(maxX, point.x); maxY = std::max(maxY, point.y); maxZ = std::max(maxZ, point.z);
+    }
+    const glm::vec3 minPoint(minX, minY, minZ);
+    const glm::vec3 extent = glm::max(glm::vec3(maxX, maxY, maxZ) - minPoint, glm::vec3(FLT_MIN));
+    const float maxCell = float((1u << CURVE_BITS_PER_AXIS) - 1u);
+
+    std::vector<CurveSortRecord> records(numPoints);
+    uint64_t maxCode = 0;
+    #pragma omp parallel for reduction(max:maxCode)
+    for (size_t i = 0; i < numPoints; i++) {
+        glm::vec3 cell = glm::clamp((points[i] - minPoint) / extent, glm::vec3(0.0f), glm::vec3(1.0f)) * maxCell;
+        uint32_t x = uint32_t(cell.x), y = uint32_t(cell.y), z = uint32_t(cell.z);
+        uint64_t code = curve == SPACE_FILLING_CURVE_HILBERT ? computeHilbertCode(x, y, z)
+                : computeMortonCode(x, y, z);
+        records[i].code = code;
+        records[i].index = uint32_t(i);
+        maxCode = std::max(maxCode, code);
+    }
+
+    parallelRadixSort(records, [](const CurveSortRecord &record) { return record.code; }, maxCode);
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < numPoints; i++) {
+        order[i] = records[i].index;
+    }
+}
+
+
+/// Number of misses of a FIFO cache for local vertex indices (see simulateMeshCaches).
+static size_t countFifoCacheMisses(const uint32_t *localIndices, size_t numIndices, size_t numVertices,
+        uint32_t cacheSize)
+{
+    std::vector<size_t> insertionTimes(numVertices, 0);
+    size_t numMisses = 0;
+    for (size_t i = 0; i < numIndices; i++) {
+        size_t &insertionTime = insertionTimes[localIndices[i]];
+        if (insertionTime == 0 || numMisses + 1 - insertionTime > cacheSize) {
+            numMisses++;
+            insertionTime = numMisses;
+        }
+    }
+    return numMisses;
+}
+
+void optimizeVertexCacheOrder(uint32_t *indices, size_t numIndices, uint32_t cacheSize)
+{
+    const size_t numTriangles = numIndices / 3;
+    if (numTriangles < 2 || cacheSize < 3) {
+        return;
+    }
+
+    // Local vertex indices
+    std::vector<uint32_t> vertices(indices, indices + numTriangles * 3);
+    std::sort(vertices.begin(), vertices.end());
+    vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+    const size_t numVertices = vertices.size();
+    std::vector<uint32_t> localIndices(numTriangles * 3);
+    for (size_t i = 0; i < numTriangles * 3; i++) {
+        localIndices[i] = uint32_t(std::lower_bound(vertices.begin(), vertices.end(), indices[i]) - vertices.begin());
+    }
+
+    // Triangles adjacent to each vertex
+    std::vector<uint32_t> vertexTriangleOffsets(numVertices + 1, 0);
+    std::vector<uint32_t> numLiveTriangles(numVertices, 0);
+    for (size_t i = 0; i < numTriangles * 3; i++) {
+        numLiveTriangles[localIndices[i]]++;
+    }
+    for (size_t v = 0; v < numVertices; v++) {
+        vertexTriangleOffsets[v + 1] = vertexTriangleOffsets[v] + numLiveTriangles[v];
+    }
+    std::vector<uint32_t> vertexTriangles(numTriangles * 3);
+    std::vector<uint32_t> insertPositions(vertexTriangleOffsets.begin(), vertexTriangleOffsets.end() - 1);
+    for (size_t i = 0; i < numTriangles * 3; i++) {
+        vertexTriangles[insertPositions[localIndices[i]]++] = uint32_t(i / 3);
+    }
+
+    // The cache time stamps simulate a FIFO cache: A vertex is in the cache if time - cacheTimes[v] <= cacheSize.
+    std::vector<uint32_t> cacheTimes(numVertices, 0);
+    uint32_t time = cacheSize + 1;
+    std::vector<uint8_t> isTriangleEmitted(numTriangles, 0);
+    std::vector<uint32_t> deadEndStack, candidates;
+    std::vector<uint32_t> optimizedLocalIndices;
+    optimizedLocalIndices.reserve(numTriangles * 3);
+
+    int64_t fanningVertex = 0;
+    size_t cursor = 1;
+    while (fanningVertex >= 0) {
+        // Emit all remaining triangles around the fanning vertex.
+        candidates.clear();
+        for (uint32_t i = vertexTriangleOffsets[fanningVertex]; i < vertexTriangleOffsets[fanningVertex + 1]; i++) {
+            uint32_t t = vertexTriangles[i];
+            if (isTriangleEmitted[t]) {
+                continue;
+            }
+            isTriangleEmitted[t] = 1;
+            for (int k = 0; k < 3; k++) {
+                uint32_t v = localIndices[t*3 + k];
+                optimizedLocalIndices.push_back(v);
+                deadEndStack.push_back(v);
+                candidates.push_back(v);
+                numLiveTriangles[v]--;
+                if (time - cacheTimes[v] > cacheSize) {
+                    cacheTimes[v] = time;
+                    time++;
+                }
+            }
+        }
+
+        // Next fanning vertex: The oldest vertex of the last fan that will still be in the cache after emitting its
+        // remaining triangles (each adds at most two vertices).
+        fanningVertex = -1;
+        int64_t bestPriority = -1;
+        for (uint32_t v : candidates) {
+            if (numLiveTriangles[v] == 0) {
+                continue;
+            }
+            int64_t priority = 0;
+            if (time - cacheTimes[v] + 2 * numLiveTriangles[v] <= cacheSize) {
+                priority = time - cacheTimes[v];
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                fanningVertex = v;
+            }
+        }
+
+        // Dead end: Continue with the most recently used vertex with live triangles, or the next one in index order.
+        while (fanningVertex < 0 && !deadEndStack.empty()) {
+            uint32_t v = deadEndStack.back();
+            deadEndStack.pop_back();
+            if (numLiveTriangles[v] > 0) {
+                fanningVertex = v;
+            }
+        }
+        while (fanningVertex < 0 && cursor < numVertices) {
+            if (numLiveTriangles[cursor] > 0) {
+                fanningVertex = int64_t(cursor);
+            }
+            cursor++;
+        }
+    }
+
+    // Already well-ordered input (e.g. the rings of a tube) is kept if the fans don't improve it.
+    if (countFifoCacheMisses(optimizedLocalIndices.data(), numTriangles * 3, numVertices, cacheSize)
+            < countFifoCacheMisses(localIndices.data(), numTriangles * 3, numVertices, cacheSize)) {
+        for (size_t i = 0; i < numTriangles * 3; i++) {
+            indices[i] = vertices[optimizedLocalIndices[i]];
+        }
+    }
+}
+
+void reorderMeshClusters(std::vector<uint32_t> &indices, size_t primitiveSize,
+        const std::vector<size_t> &clusterOffsets, const glm::vec3 *vertexPositions, size_t numVertices,
+        const SpatialReorderSettings &settings, std::vector<uint32_t> &vertexOrder)
+{
+    const size_t numIndices = indices.size();
+    const size_t numClusters = clusterOffsets.size();
+    auto getClusterEnd = [&](size_t clusterIndex) {
+        return clusterIndex + 1 < numClusters ? clusterOffsets[clusterIndex + 1] : numIndices;
+    };
+
+    // Sort the clusters along the curve
+    std::vector<glm::vec3> clusterCentroids(numClusters);
+    std::vector<size_t> clusterSizes(numClusters);
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (size_t c = 0; c < numClusters; c++) {
+        glm::vec3 centroid(0.0f);
+        const size_t clusterEnd = getClusterEnd(c);
+        for (size_t i = clusterOffsets[c]; i < clusterEnd; i++) {
+            centroid += vertexPositions[indices[i]];
+        }
+        clusterSizes[c] = clusterEnd - clusterOffsets[c];
+        clusterCentroids[c] = clusterSizes[c] > 0 ? centroid / float(clusterSizes[c]) : centroid;
+    }
+    std::vector<uint32_t> clusterOrder;
+    computeSpaceFillingCurveOrder(clusterCentroids, settings.curve, clusterOrder);
+
+    std::vector<size_t> orderedClusterSizes(numClusters), orderedClusterOffsets;
+    for (size_t c = 0; c < numClusters; c++) {
+        orderedClusterSizes[c] = clusterSizes[clusterOrder[c]];
+    }
+    parallelExclusivePrefixSum(orderedClusterSizes, orderedClusterOffsets);
+
+    const bool optimizeVertexCache = settings.optimizeVertexCache && primitiveSize == 3;
+    std::vector<uint32_t> reorderedIndices(numIndices);
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (size_t c = 0; c < numClusters; c++) {
+        const uint32_t *clusterIndices = indices.data() + clusterOffsets[clusterOrder[c]];
+        uint32_t *reorderedClusterIndices = reorderedIndices.data() + orderedClusterOffsets[c];
+        std::copy(clusterIndices, clusterIndices + orderedClusterSizes[c], reorderedClusterIndices);
+        if (optimizeVertexCache) {
+            optimizeVertexCacheOrder(reorderedClusterIndices, orderedClusterSizes[c], settings.vertexCacheSize);
+        }
+    }
+
+    // Renumber the vertices in the order of their first use (sequential by definition, but only one pass).
+    const uint32_t UNUSED_VERTEX = 0xFFFFFFFFu;
+    std::vector<uint32_t> vertexRemap(numVertices, UNUSED_VERTEX);
+    vertexOrder.clear();
+    vertexOrder.reserve(numVertices);
+    for (size_t i = 0; i < numIndices; i++) {
+        uint32_t &newIndex = vertexRemap[reorderedIndices[i]];
+        if (newIndex == UNUSED_VERTEX) {
+            newIndex = uint32_t(vertexOrder.size());
+            vertexOrder.push_back(reorderedIndices[i]);
+        }
+        reorderedIndices[i] = newIndex;
+    }
+    for (size_t v = 0; v < numVertices; v++) {
+        if (vertexRemap[v] == UNUSED_VERTEX) {
+            vertexOrder.push_back(uint32_t(v));
+        }
+    }
+
+    indices.swap(reorderedIndices);
+}
+
+
+/**
+ * Set-associative cache with LRU replacement within each set (like the caches of CPUs and GPUs).
+ */
+class SetAssociativeCache
+{
+public:
+    SetAssociativeCache(size_t numSets, size_t associativity)
+            : numSets(numSets), associativity(associativity), tags(numSets * associativity, EMPTY_TAG) {}
+
+    /// @return True if the tag was in the cache. Afterwards, it is the most recently used entry of its set.
+    inline bool access(uint64_t tag) {
+        uint64_t *ways = &tags[(tag % numSets) * associativity];
+        size_t position = 0;
+        while (position < associativity && ways[position] != tag) {
+            position++;
+        }
+        const bool hit = position < associativity;
+        if (!hit) {
+            position = associativity - 1;
+        }
+        for (size_t i = position; i > 0; i--) {
+            ways[i] = ways[i - 1];
+        }
+        ways[0] = tag;
+        return hit;
+    }
+
+private:
+    static const uint64_t EMPTY_TAG = 0xFFFFFFFFFFFFFFFFull;
+    size_t numSets, associativity;
+    std::vector<uint64_t> tags;
+};
+
+// Simulated cache parameters (typical values of current GPUs).
+const uint32_t SIMULATED_VERTEX_CACHE_SIZE = 32;
+const size_t SIMULATED_CACHE_LINE_SIZE = 64;
+const size_t SIMULATED_FETCH_CACHE_SETS = 64; // 64 sets * 8 ways * 64 bytes = 32 KiB
+const size_t SIMULATED_FETCH_CACHE_WAYS = 8;
+const uint32_t SIMULATED_SPATIAL_GRID_RESOLUTION = 64;
+const size_t SIMULATED_SPATIAL_CACHE_SETS = 32; // 256 grid cells
+const size_t SIMULATED_SPATIAL_CACHE_WAYS = 8;
+
+MeshCacheStatistics simulateMeshCaches(const uint32_t *indices, size_t numIndices, size_t primitiveSize,
+        const glm::vec3 *vertexPositions, size_t numVertices)
+{
+    MeshCacheStatistics statistics;
+    const size_t numPrimitives = numIndices / primitiveSize;
+    if (numPrimitives == 0 || numVertices == 0) {
+        return statistics;
+    }
+
+    float minX = FLT_MAX, minY = FLT_MAX, minZ = FLT_MAX;
+    float maxX = -FLT_MAX, maxY = -FLT_MAX, maxZ = -FLT_MAX;
+    #pragma omp parallel for reduction(min:minX,minY,minZ) reduction(max:maxX,maxY,maxZ)
+    for (size_t i = 0; i < numVertices; i++) {
+        const glm::vec3 &point = vertexPositions[i];
+        minX = std::min(minX, point.x); minY = std::min(minY, point.y); minZ = std::min(minZ, point.z);
+        maxX = std::max(maxX, point.x); maxY = std::max(maxY, point.y); maxZ = std::max(maxZ, point.z);
+    }
+    const glm::vec3 minPoint(minX, minY, minZ);
+    const glm::vec3 extent = glm::max(glm::vec3(maxX, maxY, maxZ) - minPoint, glm::vec3(FLT_MIN));
+    const float maxCell = float(SIMULATED_SPATIAL_GRID_RESOLUTION - 1);
+
+    // FIFO vertex cache: A vertex is in the cache if less than cacheSize other vertices were inserted after it.
+    const uint64_t NOT_INSERTED = 0xFFFFFFFFFFFFFFFFull;
+    std::vector<uint64_t> insertionTimes(numVertices, NOT_INSERTED);
+    uint64_t numVertexCacheMisses = 0;
+    uint64_t numFetchMisses = 0;
+    uint64_t numSpatialMisses = 0;
+    SetAssociativeCache fetchCache(SIMULATED_FETCH_CACHE_SETS, SIMULATED_FETCH_CACHE_WAYS);
+    SetAssociativeCache spatialCache(SIMULATED_SPATIAL_CACHE_SETS, SIMULATED_SPATIAL_CACHE_WAYS);
+
+    for (size_t p = 0; p < numPrimitives; p++) {
+        glm::vec3 centroid(0.0f);
+        for (size_t k = 0; k < primitiveSize; k++) {
+            const uint32_t index = indices[p * primitiveSize + k];
+            centroid += vertexPositions[index];
+            const uint64_t insertionTime = insertionTimes[index];
+            if (insertionTime != NOT_INSERTED && numVertexCacheMisses - insertionTime < SIMULATED_VERTEX_CACHE_SIZE) {
+                continue;
+            }
+            // Vertex cache miss -> The vertex shader fetches the vertex position.
+            insertionTimes[index] = numVertexCacheMisses;
+            numVertexCacheMisses++;
+            if (!fetchCache.access(uint64_t(index) * sizeof(glm::vec3) / SIMULATED_CACHE_LINE_SIZE)) {
+                numFetchMisses++;
+            }
+        }
+
+        glm::vec3 normalizedCentroid = (centroid / float(primitiveSize) - minPoint) / extent;
+        glm::vec3 cell = glm::clamp(normalizedCentroid, glm::vec3(0.0f), glm::vec3(1.0f)) * maxCell;
+        uint64_t cellIndex = (uint64_t(cell.z) * SIMULATED_SPATIAL_GRID_RESOLUTION + uint64_t(cell.y))
+                * SIMULATED_SPATIAL_GRID_RESOLUTION + uint64_t(cell.x);
+        if (!spatialCache.access(cellIndex)) {
+            numSpatialMisses++;
+        }
+    }
+
+    statistics.averageCacheMissRatio = double(numVertexCacheMisses) / double(numPrimitives);
+    statistics.vertexFetchMissRatio = double(numFetchMisses) / double(numVertexCacheMisses);
+    statistics.spatialMissRatio = double(numSpatialMisses) / double(numPrimitives);
+    return statistics;
+}
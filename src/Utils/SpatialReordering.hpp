@@ -0,0 +1,116 @@
+#ifndef PIXELSYNCOIT_SPATIALREORDERING_HPP
+#define PIXELSYNCOIT_SPATIALREORDERING_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+/**
+ * Conversion-time reordering of the primitives of a mesh for memory locality. The converters emit the lines in the
+ * order of the input file, so primitives that are drawn one after another are often far apart in space (bad locality
+ * of the fragment writes) and neighbouring primitives in space are far apart in the vertex buffers.
+ * The mesh is split into clusters (whole lines for line meshes, parts of the tubes for triangle meshes), which are
+ * sorted along a space-filling curve of their centroids. Optionally, the triangles inside each cluster are reordered
+ * for the post-transform vertex cache. Finally, the vertices are renumbered in the order of their first use.
+ * All steps are deterministic, i.e., the result doesn't depend on the number of threads.
+ */
+
+enum SpaceFillingCurve {
+    SPACE_FILLING_CURVE_NONE = 0, // Keep the order of the clusters
+    SPACE_FILLING_CURVE_MORTON,
+    SPACE_FILLING_CURVE_HILBERT
+};
+
+struct SpatialReorderSettings
+{
+    SpaceFillingCurve curve = SPACE_FILLING_CURVE_NONE;
+    /// Reorders the triangles of each cluster for the post-transform vertex cache (see optimizeVertexCacheOrder).
+    bool optimizeVertexCache = false;
+    /// Size of the (FIFO) vertex cache the triangle order is optimized for.
+    uint32_t vertexCacheSize = 32;
+    /// Maximum number of triangles per cluster of a tube. Whole tubes are too coarse for sorting, as long lines span
+    /// large parts of the domain.
+    size_t maxClusterTriangles = 64;
+
+    inline bool isEnabled() const { return curve != SPACE_FILLING_CURVE_NONE || optimizeVertexCache; }
+    /// @return The BinaryMeshFlags describing the reordering.
+    uint32_t getBinaryMeshFlags(bool isTriangleMesh) const;
+};
+
+/**
+ * Result of simulating the caches of the GPU on the CPU for an index buffer (see simulateMeshCaches).
+ */
+struct MeshCacheStatistics
+{
+    /// Post-transform vertex cache (FIFO): Average cache miss ratio, i.e., transformed vertices per primitive (ACMR).
+    /// The optimum for triangle meshes is about 0.5, the worst case is the number of vertices per primitive.
+    double averageCacheMissRatio = 0.0;
+    /// Vertex fetch (set-associative LRU cache of 64 byte lines over the vertex positions): Misses per vertex fetch.
+    double vertexFetchMissRatio = 0.0;
+    /// Fragment writes (set-associative LRU cache of the cells of a 64^3 grid over the bounding box, touched by the
+    /// centroids of the primitives): Misses per primitive. Measures how coherent the primitives are in space.
+    double spatialMissRatio = 0.0;
+};
+
+struct SpatialReorderStatistics
+{
+    MeshCacheStatistics before, after;
+};
+
+/// Interleaves the lowest 21 bits of x, y and z (x in the most significant position of each triple).
+uint64_t computeMortonCode(uint32_t x, uint32_t y, uint32_t z);
+/// Index of the cell (x, y, z) on the 3D Hilbert curve of order 21 (John Skilling, "Programming the Hilbert curve").
+uint64_t computeHilbertCode(uint32_t x, uint32_t y, uint32_t z);
+
+/**
+ * @return order[i] is the index of the point with the i-th smallest code on the passed curve. The points are quantized
+ * on a grid of 2^21 cells per axis over their bounding box and sorted with parallelRadixSort, i.e., points with the
+ * same code keep their relative order.
+ */
+void computeSpaceFillingCurveOrder(const std::vector<glm::vec3> &points, SpaceFillingCurve curve,
+        std::vector<uint32_t> &order);
+
+/**
+ * Reorders the triangles in place for a FIFO post-transform vertex cache in linear time (Tipsify, see Sander et al.,
+ * "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007): The triangles are emitted as fans around
+ * a vertex, which is chosen among the vertices of the last fan such that it is still in the cache.
+ */
+void optimizeVertexCacheOrder(uint32_t *indices, size_t numIndices, uint32_t cacheSize = 32);
+
+/**
+ * Reorders the clusters (and the primitives inside of the clusters) of a mesh as described above.
+ * @param indices The index buffer (line segments or triangles). The indices are renumbered (see vertexOrder).
+ * @param primitiveSize 2 for line segments, 3 for triangles (only triangles are optimized for the vertex cache).
+ * @param clusterOffsets The start of every cluster in indices (ascending, multiples of primitiveSize).
+ * @param vertexOrder vertexOrder[newIndex] = oldIndex. Must be applied to all vertex attributes with
+ * reorderVertexData. Vertices not referenced by any primitive are moved to the end.
+ */
+void reorderMeshClusters(std::vector<uint32_t> &indices, size_t primitiveSize,
+        const std::vector<size_t> &clusterOffsets, const glm::vec3 *vertexPositions, size_t numVertices,
+        const SpatialReorderSettings &settings, std::vector<uint32_t> &vertexOrder);
+
+/// Applies the vertex order computed by reorderMeshClusters to a vertex attribute.
+template<typename T>
+void reorderVertexData(std::vector<T> &data, const std::vector<uint32_t> &vertexOrder)
+{
+    if (data.size() != vertexOrder.size()) {
+        return;
+    }
+    std::vector<T> reorderedData(data.size());
+    #pragma omp parallel for
+    for (size_t i = 0; i < vertexOrder.size(); i++) {
+        reorderedData[i] = data[vertexOrder[i]];
+    }
+    data.swap(reorderedData);
+}
+
+/**
+ * Simulates the vertex cache, the vertex fetch cache and the spatial coherence of the primitives (see
+ * MeshCacheStatistics) for drawing the primitives in the order of the index buffer.
+ */
+MeshCacheStatistics simulateMeshCaches(const uint32_t *indices, size_t numIndices, size_t primitiveSize,
+        const glm::vec3 *vertexPositions, size_t numVertices);
+
+#endif //PIXELSYNCOIT_SPATIALREORDERING_HPP
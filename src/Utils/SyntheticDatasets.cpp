@@ -0,0 +1,582 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <climits>
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <vector>
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <glm/glm.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <Math/Math.hpp>
+#include <Utils/File/Logfile.hpp>
+
+#include "SyntheticDatasets.hpp"
+
+/**
+ * SplitMix64 random number generator (cf. Steele et al., "Fast splittable pseudorandom number generators").
+ * Every line or block of primitives gets its own stream, which is seeded by hashing the dataset seed together with
+ * the index of the line or block. Thus, the generated data does not depend on the order of processing.
+ */
+class SyntheticRandom
+{
+public:
+    SyntheticRandom(uint64_t seed, uint64_t stream) : state(mix(seed ^ mix(stream + 0x632BE59BD9B4E019ull))) {}
+
+    inline uint64_t nextUint64() {
+        state += 0x9E3779B97F4A7C15ull;
+        return mix(state);
+    }
+    /// Uniformly distributed in [0, 1).
+    inline float nextFloat() { return float(nextUint64() >> 40u) * (1.0f / 16777216.0f); }
+    inline float nextFloat(float min, float max) { return min + (max - min) * nextFloat(); }
+    /// Uniformly distributed in [0, n).
+    inline uint32_t nextIndex(uint32_t n) { return uint32_t((nextUint64() >> 32u) * uint64_t(n) >> 32u); }
+    /// Standard normal distribution (Box-Muller transform).
+    inline float nextGaussian() {
+        float u = std::max(nextFloat(), 1e-7f);
+        return std::sqrt(-2.0f * std::log(u)) * std::cos(sgl::TWO_PI * nextFloat());
+    }
+    inline glm::vec3 nextGaussianVector() { return glm::vec3(nextGaussian(), nextGaussian(), nextGaussian()); }
+    /// Uniformly distributed on the unit sphere.
+    inline glm::vec3 nextUnitVector() { return unitVectorFromSpherical(nextFloat(-1.0f, 1.0f), nextFloat()); }
+
+    /// @param z The z coordinate in [-1, 1]. @param azimuth The azimuth angle in [0, 1) (i.e., divided by 2 pi).
+    static inline glm::vec3 unitVectorFromSpherical(float z, float azimuth) {
+        float r = std::sqrt(std::max(1.0f - z * z, 0.0f));
+        return glm::vec3(r * std::cos(sgl::TWO_PI * azimuth), r * std::sin(sgl::TWO_PI * azimuth), z);
+    }
+
+private:
+    static inline uint64_t mix(uint64_t z) {
+        z = (z ^ (z >> 30u)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27u)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31u);
+    }
+    uint64_t state;
+};
+
+/// Streams for data shared by all blocks (e.g. the cluster centers of point clouds).
+const uint64_t SYNTHETIC_GLOBAL_STREAM = UINT64_MAX;
+
+/// Computes two unit vectors orthogonal to the passed unit vector and to each other.
+static void computeOrthonormalBasis(const glm::vec3 &direction, glm::vec3 &tangent, glm::vec3 &binormal)
+{
+    glm::vec3 helperAxis = std::abs(direction.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    tangent = glm::normalize(glm::cross(direction, helperAxis));
+    binormal = glm::cross(direction, tangent);
+}
+
+template<typename T>
+static inline void appendValue(std::vector<char> &data, const T &value)
+{
+    size_t offset = data.size();
+    data.resize(offset + sizeof(T));
+    memcpy(&data[offset], &value, sizeof(T));
+}
+
+template<typename T>
+static inline void appendArray(std::vector<char> &data, const T *values, size_t n)
+{
+    size_t offset = data.size();
+    data.resize(offset + n * sizeof(T));
+    memcpy(&data[offset], values, n * sizeof(T));
+}
+
+static inline void appendString(std::vector<char> &data, const char *string, int length)
+{
+    data.insert(data.end(), string, string + length);
+}
+
+/**
+ * Generates the data of numBlocks consecutive file blocks in parallel and writes them to the file in order.
+ * Only a few blocks per thread are held in memory at the same time.
+ */
+static bool writeBlocks(std::ofstream &file, uint64_t numBlocks,
+        const std::function<void(uint64_t blockIdx, std::vector<char> &data)> &generateBlock)
+{
+    int numThreads = 1;
+#ifdef _OPENMP
+    numThreads = omp_get_max_threads();
+#endif
+    const uint64_t numBlocksPerBatch = uint64_t(numThreads) * 4;
+    std::vector<std::vector<char>> blockData(numBlocksPerBatch);
+
+    for (uint64_t batchStart = 0; batchStart < numBlocks && file.good(); batchStart += numBlocksPerBatch) {
+        const size_t numBatchBlocks = size_t(std::min(numBlocksPerBatch, numBlocks - batchStart));
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t i = 0; i < numBatchBlocks; i++) {
+            blockData[i].clear();
+            generateBlock(batchStart + i, blockData[i]);
+        }
+        for (size_t i = 0; i < numBatchBlocks; i++) {
+            file.write(blockData[i].data(), blockData[i].size());
+        }
+    }
+    return file.good();
+}
+
+
+// ---------- Lines and hair strands ----------
+
+const uint64_t NUM_LINES_PER_BLOCK = 64;
+
+/**
+ * Generates the points of a helix or random walk inside of the unit cube.
+ * @param attributes Attribute a of point i is stored at attributes[a * numPointsPerLine + i]. All attributes are
+ * smooth along the line and lie in [0, 1]. Attribute 0 takes the role of the vorticity of the real datasets.
+ */
+static void generateLine(const SyntheticDatasetSettings &settings, uint64_t lineIdx,
+        std::vector<glm::vec3> &positions, std::vector<float> &attributes)
+{
+    const uint32_t n = settings.numPointsPerLine;
+    SyntheticRandom random(settings.seed, lineIdx);
+    positions.resize(n);
+    attributes.resize(size_t(settings.numAttributes) * n);
+
+    if (settings.type == SYNTHETIC_DATASET_HELICES) {
+        // Half the maximum length plus the maximum radius is less than the minimum distance to the cube faces.
+        glm::vec3 center(random.nextFloat(0.22f, 0.78f), random.nextFloat(0.22f, 0.78f),
+                random.nextFloat(0.22f, 0.78f));
+        glm::vec3 axis = random.nextUnitVector();
+        glm::vec3 tangent, binormal;
+        computeOrthonormalBasis(axis, tangent, binormal);
+        float radius = random.nextFloat(0.01f, 0.06f);
+        float length = random.nextFloat(0.1f, 0.3f);
+        float numTurns = random.nextFloat(2.0f, 8.0f);
+        float frequency = random.nextFloat(0.5f, 3.0f);
+        float phase = random.nextFloat();
+        for (uint32_t i = 0; i < n; i++) {
+            float t = float(i) / float(n - 1);
+            float angle = sgl::TWO_PI * numTurns * t;
+            positions[i] = center + (t - 0.5f) * length * axis
+                    + radius * (std::cos(angle) * tangent + std::sin(angle) * binormal);
+            attributes[i] = 0.5f + 0.5f * std::sin(sgl::TWO_PI * (frequency * t + phase));
+        }
+    } else {
+        // Persistent random walk with a constant total length, reflected at the faces of the unit cube.
+        // Attribute 0 is the (exponentially smoothed) turning angle, i.e., a curvature measure.
+        glm::vec3 position(random.nextFloat(0.1f, 0.9f), random.nextFloat(0.1f, 0.9f), random.nextFloat(0.1f, 0.9f));
+        glm::vec3 direction = random.nextUnitVector();
+        float stepSize = random.nextFloat(0.2f, 0.6f) / float(n - 1);
+        float turningRate = random.nextFloat(0.1f, 0.4f);
+        float smoothedAngle = 0.0f;
+        for (uint32_t i = 0; i < n; i++) {
+            positions[i] = position;
+            attributes[i] = smoothedAngle;
+
+            glm::vec3 newDirection = direction + turningRate * random.nextGaussianVector();
+            float newDirectionLength = glm::length(newDirection);
+            newDirection = newDirectionLength > 1e-6f ? newDirection / newDirectionLength : direction;
+            float cosAngle = glm::clamp(glm::dot(direction, newDirection), -1.0f, 1.0f);
+            smoothedAngle = 0.8f * smoothedAngle + 0.2f * std::acos(cosAngle) / sgl::PI;
+            direction = newDirection;
+
+            position += stepSize * direction;
+            for (int j = 0; j < 3; j++) {
+                if (position[j] < 0.0f) {
+                    position[j] = -position[j];
+                    direction[j] = -direction[j];
+                } else if (position[j] > 1.0f) {
+                    position[j] = 2.0f - position[j];
+                    direction[j] = -direction[j];
+                }
+            }
+        }
+    }
+
+    // Additional attributes: Smooth waves with increasing frequency.
+    for (uint32_t a = 1; a < settings.numAttributes; a++) {
+        float phase = random.nextFloat();
+        for (uint32_t i = 0; i < n; i++) {
+            float t = float(i) / float(n - 1);
+            attributes[size_t(a) * n + i] = 0.5f + 0.5f * std::sin(sgl::TWO_PI * (float(a + 1) * t + phase));
+        }
+    }
+}
+
+static bool writeLinesObj(std::ofstream &file, const SyntheticDatasetSettings &settings, uint64_t numLines)
+{
+    const uint32_t n = settings.numPointsPerLine;
+    uint64_t numBlocks = (numLines + NUM_LINES_PER_BLOCK - 1) / NUM_LINES_PER_BLOCK;
+    return writeBlocks(file, numBlocks, [&](uint64_t blockIdx, std::vector<char> &data) {
+        std::vector<glm::vec3> positions;
+        std::vector<float> attributes;
+        char buffer[128];
+        uint64_t lineEnd = std::min((blockIdx + 1) * NUM_LINES_PER_BLOCK, numLines);
+        for (uint64_t lineIdx = blockIdx * NUM_LINES_PER_BLOCK; lineIdx < lineEnd; lineIdx++) {
+            generateLine(settings, lineIdx, positions, attributes);
+            for (uint32_t i = 0; i < n; i++) {
+                const glm::vec3 &p = positions[i];
+                appendString(data, buffer, snprintf(buffer, sizeof(buffer), "v %.7g %.7g %.7g\nvt %.7g\n",
+                        p.x, p.y, p.z, attributes[i]));
+            }
+            // The vertex indices of OBJ files start at one.
+            appendString(data, "l", 1);
+            unsigned long long firstIndex = lineIdx * n + 1;
+            for (uint32_t i = 0; i < n; i++) {
+                appendString(data, buffer, snprintf(buffer, sizeof(buffer), " %llu", firstIndex + i));
+            }
+            appendString(data, "\n", 1);
+        }
+    });
+}
+
+/// Version 1 of the .binlines format (see loadTrajectorySetFromBinLines).
+static bool writeLinesBinLines(std::ofstream &file, const SyntheticDatasetSettings &settings, uint64_t numLines)
+{
+    const uint32_t n = settings.numPointsPerLine;
+    const uint32_t header[3] = { 1u, uint32_t(numLines), settings.numAttributes };
+    file.write((const char*)header, sizeof(header));
+
+    uint64_t numBlocks = (numLines + NUM_LINES_PER_BLOCK - 1) / NUM_LINES_PER_BLOCK;
+    return writeBlocks(file, numBlocks, [&](uint64_t blockIdx, std::vector<char> &data) {
+        std::vector<glm::vec3> positions;
+        std::vector<float> attributes;
+        uint64_t lineEnd = std::min((blockIdx + 1) * NUM_LINES_PER_BLOCK, numLines);
+        for (uint64_t lineIdx = blockIdx * NUM_LINES_PER_BLOCK; lineIdx < lineEnd; lineIdx++) {
+            generateLine(settings, lineIdx, positions, attributes);
+            appendValue(data, n);
+            appendArray(data, positions.data(), positions.size());
+            appendArray(data, attributes.data(), attributes.size());
+        }
+    });
+}
+
+/**
+ * Generates a wavy hair strand. Like most models of http://www.cemyuksel.com/research/hairmodels/, the z axis
+ * points upwards and one unit is roughly one millimeter. The roots lie on the upper part of a head-sized sphere.
+ */
+static void generateHairStrand(const SyntheticDatasetSettings &settings, uint64_t strandIdx,
+        std::vector<glm::vec3> &points)
+{
+    const float HEAD_RADIUS = 80.0f;
+    const float GRAVITY_PER_UNIT_LENGTH = 0.015f;
+    const uint32_t n = settings.numPointsPerLine;
+    SyntheticRandom random(settings.seed, strandIdx);
+    points.resize(n);
+
+    glm::vec3 rootNormal = SyntheticRandom::unitVectorFromSpherical(random.nextFloat(-0.2f, 1.0f), random.nextFloat());
+    float strandLength = random.nextFloat(100.0f, 250.0f);
+    float stepSize = strandLength / float(n - 1);
+    float curlRadius = random.nextFloat(0.0f, 4.0f);
+    float curlFrequency = random.nextFloat(0.01f, 0.05f);
+    float curlPhase = random.nextFloat();
+
+    glm::vec3 position = HEAD_RADIUS * rootNormal;
+    glm::vec3 direction = rootNormal;
+    for (uint32_t i = 0; i < n; i++) {
+        // The curl is added around the center line, whose direction is bent downwards by gravity.
+        glm::vec3 tangent, binormal;
+        computeOrthonormalBasis(direction, tangent, binormal);
+        float angle = sgl::TWO_PI * (curlFrequency * stepSize * float(i) + curlPhase);
+        float rootFactor = std::min(float(i) / 8.0f, 1.0f);
+        points[i] = position + rootFactor * curlRadius * (std::cos(angle) * tangent + std::sin(angle) * binormal);
+
+        direction = glm::normalize(direction + glm::vec3(0.0f, 0.0f, -GRAVITY_PER_UNIT_LENGTH * stepSize));
+        position += stepSize * direction;
+        // Keep the strands outside of the head.
+        float distanceToCenter = glm::length(position);
+        if (distanceToCenter < HEAD_RADIUS) {
+            position *= HEAD_RADIUS / distanceToCenter;
+        }
+    }
+}
+
+/// See http://www.cemyuksel.com/research/hairmodels/ and loadHairFile. Only the points array is stored.
+static bool writeHair(std::ofstream &file, const SyntheticDatasetSettings &settings, uint64_t numStrands)
+{
+    std::vector<char> header;
+    appendValue(header, uint32_t(0x52494148)); // "HAIR"
+    appendValue(header, uint32_t(numStrands));
+    appendValue(header, uint32_t(numStrands * settings.numPointsPerLine));
+    appendValue(header, uint32_t(0x2)); // Only the points array is stored.
+    appendValue(header, uint32_t(settings.numPointsPerLine - 1)); // Default number of segments
+    appendValue(header, 0.5f); // Default thickness
+    appendValue(header, 1.0f); // Default opacity
+    appendValue(header, glm::vec3(0.45f, 0.3f, 0.15f)); // Default color
+    char fileInformation[88] = {};
+    snprintf(fileInformation, sizeof(fileInformation), "PixelSyncOIT synthetic hair (seed %llu)",
+            (unsigned long long)settings.seed);
+    appendArray(header, fileInformation, sizeof(fileInformation));
+    file.write(header.data(), header.size());
+
+    uint64_t numBlocks = (numStrands + NUM_LINES_PER_BLOCK - 1) / NUM_LINES_PER_BLOCK;
+    return writeBlocks(file, numBlocks, [&](uint64_t blockIdx, std::vector<char> &data) {
+        std::vector<glm::vec3> points;
+        uint64_t strandEnd = std::min((blockIdx + 1) * NUM_LINES_PER_BLOCK, numStrands);
+        for (uint64_t strandIdx = blockIdx * NUM_LINES_PER_BLOCK; strandIdx < strandEnd; strandIdx++) {
+            generateHairStrand(settings, strandIdx, points);
+            appendArray(data, points.data(), points.size());
+        }
+    });
+}
+
+
+// ---------- Point clouds ----------
+
+const uint64_t NUM_POINTS_PER_BLOCK = 65536;
+
+/**
+ * Cosmic web .dat file (see import_cosmic_web): A header followed by interleaved positions and velocities.
+ * The points lie in one brick of 768^3 units. 60% of the points belong to Gaussian clusters rotating around their
+ * center, 30% to filaments connecting pairs of clusters and 10% are uniformly distributed background points.
+ * The number of clusters is fixed, so the density of the point cloud increases with its size.
+ */
+static bool writePointsCosmicWeb(std::ofstream &file, const SyntheticDatasetSettings &settings)
+{
+    const float BRICK_SIZE = 768.0f;
+    const uint32_t NUM_CLUSTERS = 64;
+    const uint32_t NUM_FILAMENTS = 96;
+    const uint64_t numPoints = settings.size;
+
+    struct Cluster { glm::vec3 center, rotationAxis; float sigma, angularVelocity; };
+    struct Filament { glm::vec3 start, end; float width; };
+    SyntheticRandom globalRandom(settings.seed, SYNTHETIC_GLOBAL_STREAM);
+    std::vector<Cluster> clusters(NUM_CLUSTERS);
+    for (Cluster &cluster : clusters) {
+        cluster.center = BRICK_SIZE * glm::vec3(globalRandom.nextFloat(0.1f, 0.9f),
+                globalRandom.nextFloat(0.1f, 0.9f), globalRandom.nextFloat(0.1f, 0.9f));
+        cluster.rotationAxis = globalRandom.nextUnitVector();
+        cluster.sigma = BRICK_SIZE * globalRandom.nextFloat(0.005f, 0.03f);
+        cluster.angularVelocity = globalRandom.nextFloat(0.5f, 2.0f);
+    }
+    std::vector<Filament> filaments(NUM_FILAMENTS);
+    for (Filament &filament : filaments) {
+        filament.start = clusters.at(globalRandom.nextIndex(NUM_CLUSTERS)).center;
+        filament.end = clusters.at(globalRandom.nextIndex(NUM_CLUSTERS)).center;
+        filament.width = BRICK_SIZE * globalRandom.nextFloat(0.001f, 0.005f);
+    }
+
+    // Header (struct CosmicWebHeader with one-byte packing).
+    std::vector<char> header;
+    appendValue(header, int32_t(numPoints)); // np_local
+    appendValue(header, 1.0f); // a
+    appendValue(header, 0.0f); // t
+    appendValue(header, 0.0f); // tau
+    appendValue(header, int32_t(0)); // nts
+    appendValue(header, 0.0f); // dt_f_acc
+    appendValue(header, 0.0f); // dt_pp_acc
+    appendValue(header, 0.0f); // dt_c_acc
+    appendValue(header, int32_t(0)); // cur_checkpoint
+    appendValue(header, int32_t(0)); // cur_projection
+    appendValue(header, int32_t(0)); // cur_halofind
+    appendValue(header, 1.0f); // massp
+    file.write(header.data(), header.size());
+
+    uint64_t numBlocks = (numPoints + NUM_POINTS_PER_BLOCK - 1) / NUM_POINTS_PER_BLOCK;
+    return writeBlocks(file, numBlocks, [&](uint64_t blockIdx, std::vector<char> &data) {
+        SyntheticRandom random(settings.seed, blockIdx);
+        uint64_t pointEnd = std::min((blockIdx + 1) * NUM_POINTS_PER_BLOCK, numPoints);
+        data.reserve((pointEnd - blockIdx * NUM_POINTS_PER_BLOCK) * 2 * sizeof(glm::vec3));
+        for (uint64_t pointIdx = blockIdx * NUM_POINTS_PER_BLOCK; pointIdx < pointEnd; pointIdx++) {
+            glm::vec3 position, velocity;
+            float category = random.nextFloat();
+            if (category < 0.6f) {
+                const Cluster &cluster = clusters.at(random.nextIndex(NUM_CLUSTERS));
+                position = cluster.center + cluster.sigma * random.nextGaussianVector();
+                velocity = cluster.angularVelocity * glm::cross(cluster.rotationAxis, position - cluster.center)
+                        + random.nextGaussianVector();
+            } else if (category < 0.9f) {
+                const Filament &filament = filaments.at(random.nextIndex(NUM_FILAMENTS));
+                position = glm::mix(filament.start, filament.end, random.nextFloat())
+                        + filament.width * random.nextGaussianVector();
+                velocity = 0.05f * (filament.end - filament.start) + random.nextGaussianVector();
+            } else {
+                position = BRICK_SIZE * glm::vec3(random.nextFloat(), random.nextFloat(), random.nextFloat());
+                velocity = 5.0f * random.nextGaussianVector();
+            }
+            position = glm::clamp(position, glm::vec3(0.0f), glm::vec3(BRICK_SIZE));
+            appendValue(data, position);
+            appendValue(data, velocity);
+        }
+    });
+}
+
+
+// ---------- Triangle meshes ----------
+
+/**
+ * Binary OBJ file (see convertBinaryObjMeshToBinmesh): The number of vertices and triangles as 64-bit integers, the
+ * vertex positions and the 64-bit vertex indices. The mesh is a closed torus with a regular grid of
+ * numMajorSegments x numMinorSegments vertices, whose minor radius is modulated by random waves.
+ */
+static bool writeTriangleMeshBobj(std::ofstream &file, const SyntheticDatasetSettings &settings,
+        uint64_t &numTriangles)
+{
+    const float MAJOR_RADIUS = 1.0f;
+    const float MINOR_RADIUS = 0.35f;
+    const int NUM_WAVES = 12;
+    // 2 * numMajorSegments * numMinorSegments triangles with numMajorSegments = 2 * numMinorSegments.
+    const uint64_t numMinorSegments = std::max(uint64_t(std::llround(std::sqrt(double(settings.size) / 4.0))),
+            uint64_t(3));
+    const uint64_t numMajorSegments = 2 * numMinorSegments;
+    const uint64_t numVertices = numMajorSegments * numMinorSegments;
+    numTriangles = 2 * numVertices;
+
+    // Integer frequencies keep the surface closed.
+    struct Wave { float majorFrequency, minorFrequency, phase, amplitude; };
+    SyntheticRandom globalRandom(settings.seed, SYNTHETIC_GLOBAL_STREAM);
+    Wave waves[NUM_WAVES];
+    for (int i = 0; i < NUM_WAVES; i++) {
+        waves[i].majorFrequency = float(1 + globalRandom.nextIndex(12));
+        waves[i].minorFrequency = float(1 + globalRandom.nextIndex(6));
+        waves[i].phase = globalRandom.nextFloat();
+        waves[i].amplitude = globalRandom.nextFloat(0.02f, 0.1f) / float(1 + i / 4);
+    }
+
+    const uint64_t header[2] = { numVertices, numTriangles };
+    file.write((const char*)header, sizeof(header));
+
+    const uint64_t numRowsPerBlock = std::max(NUM_POINTS_PER_BLOCK / numMinorSegments, uint64_t(1));
+    const uint64_t numBlocks = (numMajorSegments + numRowsPerBlock - 1) / numRowsPerBlock;
+    bool success = writeBlocks(file, numBlocks, [&](uint64_t blockIdx, std::vector<char> &data) {
+        uint64_t rowEnd = std::min((blockIdx + 1) * numRowsPerBlock, numMajorSegments);
+        for (uint64_t i = blockIdx * numRowsPerBlock; i < rowEnd; i++) {
+            float majorAngle = sgl::TWO_PI * float(i) / float(numMajorSegments);
+            for (uint64_t j = 0; j < numMinorSegments; j++) {
+                float minorAngle = sgl::TWO_PI * float(j) / float(numMinorSegments);
+                float displacement = 0.0f;
+                for (const Wave &wave : waves) {
+                    displacement += wave.amplitude * std::sin(wave.majorFrequency * majorAngle
+                            + wave.minorFrequency * minorAngle + sgl::TWO_PI * wave.phase);
+                }
+                float minorRadius = MINOR_RADIUS * (1.0f + displacement);
+                float distanceToAxis = MAJOR_RADIUS + minorRadius * std::cos(minorAngle);
+                appendValue(data, glm::vec3(distanceToAxis * std::cos(majorAngle),
+                        distanceToAxis * std::sin(majorAngle), minorRadius * std::sin(minorAngle)));
+            }
+        }
+    });
+
+    return success && writeBlocks(file, numBlocks, [&](uint64_t blockIdx, std::vector<char> &data) {
+        uint64_t rowEnd = std::min((blockIdx + 1) * numRowsPerBlock, numMajorSegments);
+        for (uint64_t i = blockIdx * numRowsPerBlock; i < rowEnd; i++) {
+            uint64_t nextI = (i + 1) % numMajorSegments;
+            for (uint64_t j = 0; j < numMinorSegments; j++) {
+                uint64_t nextJ = (j + 1) % numMinorSegments;
+                uint64_t i00 = i * numMinorSegments + j, i01 = i * numMinorSegments + nextJ;
+                uint64_t i10 = nextI * numMinorSegments + j, i11 = nextI * numMinorSegments + nextJ;
+                const uint64_t indices[6] = { i00, i10, i11, i00, i11, i01 };
+                appendArray(data, indices, 6);
+            }
+        }
+    });
+}
+
+
+bool parseSyntheticDatasetType(const std::string &name, SyntheticDatasetType &type)
+{
+    for (int i = 0; i < NUM_SYNTHETIC_DATASET_TYPES; i++) {
+        if (name == SYNTHETIC_DATASET_TYPE_NAMES[i]) {
+            type = SyntheticDatasetType(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string getSyntheticDatasetDefaultExtension(SyntheticDatasetType type)
+{
+    if (type == SYNTHETIC_DATASET_HAIR) {
+        return ".hair";
+    } else if (type == SYNTHETIC_DATASET_POINTS) {
+        return "_000.dat";
+    } else if (type == SYNTHETIC_DATASET_TRIANGLE_MESH) {
+        return ".bobj";
+    } else {
+        return ".binlines";
+    }
+}
+
+bool generateSyntheticDataset(const std::string &filename, const SyntheticDatasetSettings &settings,
+        SyntheticDatasetStatistics *statistics)
+{
+    std::string lowerCaseFilename = boost::to_lower_copy(filename);
+    bool isLineDataset = settings.type == SYNTHETIC_DATASET_HELICES || settings.type == SYNTHETIC_DATASET_RANDOM_WALKS;
+    bool isObj = boost::ends_with(lowerCaseFilename, ".obj");
+    bool isBinLines = boost::ends_with(lowerCaseFilename, ".binlines");
+    uint64_t numLines = 0;
+    if (isLineDataset || settings.type == SYNTHETIC_DATASET_HAIR) {
+        uint64_t numPointsPerLine = std::max(settings.numPointsPerLine, 2u);
+        numLines = std::max((settings.size + numPointsPerLine - 1) / numPointsPerLine, uint64_t(1));
+    }
+
+    std::string errorMessage;
+    if (isLineDataset && !isObj && !isBinLines) {
+        errorMessage = "Line datasets can only be written to .obj and .binlines files.";
+    } else if (settings.type == SYNTHETIC_DATASET_HAIR && !boost::ends_with(lowerCaseFilename, ".hair")) {
+        errorMessage = "Hair datasets can only be written to .hair files.";
+    } else if (settings.type == SYNTHETIC_DATASET_POINTS && !boost::ends_with(lowerCaseFilename, ".dat")) {
+        errorMessage = "Point datasets can only be written to (cosmic web) .dat files.";
+    } else if (settings.type == SYNTHETIC_DATASET_TRIANGLE_MESH && !boost::ends_with(lowerCaseFilename, ".bobj")) {
+        errorMessage = "Triangle meshes can only be written to .bobj files.";
+    } else if ((isLineDataset || settings.type == SYNTHETIC_DATASET_HAIR) && settings.numPointsPerLine < 2) {
+        errorMessage = "Lines need to consist of at least two points.";
+    } else if (isLineDataset && settings.numAttributes == 0) {
+        errorMessage = "Lines need at least one attribute.";
+    } else if (isObj && numLines * settings.numPointsPerLine > uint64_t(INT_MAX)) {
+        errorMessage = "The vertex indices of .obj line files are limited to 32-bit signed integers.";
+    } else if (settings.type == SYNTHETIC_DATASET_HAIR && numLines * settings.numPointsPerLine > uint64_t(UINT32_MAX)) {
+        errorMessage = "The number of points of .hair files is limited to 32-bit unsigned integers.";
+    } else if (numLines > uint64_t(UINT32_MAX)) {
+        errorMessage = "The number of lines is limited to 32-bit unsigned integers.";
+    } else if (settings.type == SYNTHETIC_DATASET_POINTS && settings.size > uint64_t(INT_MAX)) {
+        errorMessage = "The number of points of cosmic web files is limited to 32-bit signed integers.";
+    } else if (settings.type == SYNTHETIC_DATASET_POINTS && !boost::ends_with(lowerCaseFilename, "000.dat")) {
+        // import_cosmic_web offsets the points by the brick index stored in the last three characters of the name.
+        errorMessage = "The file name of point datasets needs to end with \"000.dat\" (brick index 0).";
+    }
+    if (!errorMessage.empty()) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in generateSyntheticDataset: " + errorMessage
+                + " File: \"" + filename + "\".");
+        return false;
+    }
+
+    std::ofstream file(filename.c_str(), std::ofstream::binary);
+    if (!file.is_open()) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in generateSyntheticDataset: File \""
+                + filename + "\" could not be opened for writing.");
+        return false;
+    }
+    sgl::Logfile::get()->writeInfo(std::string() + "Generating synthetic dataset \"" + filename + "\" ("
+            + SYNTHETIC_DATASET_TYPE_NAMES[settings.type] + ", size " + std::to_string(settings.size)
+            + ", seed " + std::to_string(settings.seed) + ")...");
+
+    bool success = false;
+    uint64_t numPrimitives = numLines * settings.numPointsPerLine;
+    if (isLineDataset && isObj) {
+        success = writeLinesObj(file, settings, numLines);
+    } else if (isLineDataset) {
+        success = writeLinesBinLines(file, settings, numLines);
+    } else if (settings.type == SYNTHETIC_DATASET_HAIR) {
+        success = writeHair(file, settings, numLines);
+    } else if (settings.type == SYNTHETIC_DATASET_POINTS) {
+        success = writePointsCosmicWeb(file, settings);
+        numPrimitives = settings.size;
+    } else if (settings.type == SYNTHETIC_DATASET_TRIANGLE_MESH) {
+        success = writeTriangleMeshBobj(file, settings, numPrimitives);
+    }
+
+    uint64_t fileSize = uint64_t(file.tellp());
+    file.close();
+    if (!success || file.fail()) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in generateSyntheticDataset: Couldn't write file \""
+                + filename + "\".");
+        return false;
+    }
+
+    if (statistics) {
+        statistics->numPrimitives = numPrimitives;
+        statistics->numLines = numLines;
+        statistics->fileSize = fileSize;
+    }
+    return true;
+}
@@ -0,0 +1,73 @@
+#ifndef PIXELSYNCOIT_SYNTHETICDATASETS_HPP
+#define PIXELSYNCOIT_SYNTHETICDATASETS_HPP
+
+#include <string>
+#include <cstdint>
+
+/**
+ * Deterministic generator for synthetic datasets in the file formats the pipeline reads. It is meant for scaling
+ * tests on machines without access to the (large and not redistributable) datasets in MODEL_FILENAMES.
+ *
+ * The same seed and settings always produce a byte-identical file independent of the number of threads. A custom
+ * random number generator is used instead of the distributions of <random>, whose output differs between standard
+ * library implementations.
+ * Every line, strand or block of primitives is generated from its own random stream, so the data is generated in
+ * parallel and streamed to the file batch by batch. The memory usage does not grow with the dataset size.
+ */
+
+enum SyntheticDatasetType {
+    /// Helical streamlines with random center, axis, radius and pitch (.obj or .binlines).
+    SYNTHETIC_DATASET_HELICES = 0,
+    /// Smooth random walks reflected at the boundary of the unit cube (.obj or .binlines).
+    SYNTHETIC_DATASET_RANDOM_WALKS,
+    /// Wavy hair strands growing from the upper half of a sphere (.hair).
+    SYNTHETIC_DATASET_HAIR,
+    /// Clustered point cloud with filaments between the clusters (cosmic web .dat, see import_cosmic_web).
+    SYNTHETIC_DATASET_POINTS,
+    /// Closed torus surface with random bumps (.bobj, see convertBinaryObjMeshToBinmesh).
+    SYNTHETIC_DATASET_TRIANGLE_MESH
+};
+const char *const SYNTHETIC_DATASET_TYPE_NAMES[] = {
+        "helices", "random_walks", "hair", "points", "triangle_mesh"
+};
+const int NUM_SYNTHETIC_DATASET_TYPES =
+        ((int)(sizeof(SYNTHETIC_DATASET_TYPE_NAMES)/sizeof(*SYNTHETIC_DATASET_TYPE_NAMES)));
+
+struct SyntheticDatasetSettings
+{
+    SyntheticDatasetType type = SYNTHETIC_DATASET_HELICES;
+    uint64_t seed = 0;
+    /// Number of primitives: Line or strand points for lines and hair, points for point clouds, triangles for meshes.
+    uint64_t size = 1000000;
+    /// Number of points per line or hair strand.
+    uint32_t numPointsPerLine = 128;
+    /// Number of attributes per line point. Only used for .binlines files (.obj files store exactly one attribute).
+    uint32_t numAttributes = 1;
+};
+
+struct SyntheticDatasetStatistics
+{
+    /// Number of primitives actually written (the size is rounded to whole lines or mesh rows).
+    uint64_t numPrimitives = 0;
+    /// Number of lines or hair strands (zero for point clouds and meshes).
+    uint64_t numLines = 0;
+    uint64_t fileSize = 0;
+};
+
+/// @return False if the name does not match any of SYNTHETIC_DATASET_TYPE_NAMES.
+bool parseSyntheticDatasetType(const std::string &name, SyntheticDatasetType &type);
+
+/// The file ending used if none is specified, e.g. ".binlines" for lines. Point clouds end with "_000.dat", as
+/// import_cosmic_web reads the brick index from the last three characters of the file name.
+std::string getSyntheticDatasetDefaultExtension(SyntheticDatasetType type);
+
+/**
+ * Generates a synthetic dataset and writes it to the passed file. The file format is selected by the file ending,
+ * which needs to match the dataset type (see SyntheticDatasetType).
+ * @param statistics If not nullptr, information about the written data.
+ * @return False if the settings are invalid for the file format or the file could not be written.
+ */
+bool generateSyntheticDataset(const std::string &filename, const SyntheticDatasetSettings &settings,
+        SyntheticDatasetStatistics *statistics = nullptr);
+
+#endif //PIXELSYNCOIT_SYNTHETICDATASETS_HPP
@@ -0,0 +1,73 @@
+#include <algorithm>
+
+#include "ThreadPool.hpp"
+
+ThreadPool::ThreadPool(size_t numThreads)
+{
+    numThreads = std::max(numThreads, size_t(1));
+    workers.reserve(numThreads);
+    for (size_t i = 0; i < numThreads; i++) {
+        workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    waitForAll();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopWorkers = true;
+    }
+    taskAvailableCondition.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::enqueue(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    taskAvailableCondition.notify_one();
+}
+
+void ThreadPool::waitForAll()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    tasksFinishedCondition.wait(lock, [this]() { return tasks.empty() && numRunningTasks == 0; });
+}
+
+size_t ThreadPool::getNumPendingTasks()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return tasks.size() + numRunningTasks;
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskAvailableCondition.wait(lock, [this]() { return stopWorkers || !tasks.empty(); });
+            if (tasks.empty()) {
+                return; // stopWorkers is set
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            numRunningTasks++;
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            numRunningTasks--;
+            if (tasks.empty() && numRunningTasks == 0) {
+                tasksFinishedCondition.notify_all();
+            }
+        }
+    }
+}
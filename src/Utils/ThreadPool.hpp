@@ -0,0 +1,43 @@
+#ifndef PIXELSYNCOIT_THREADPOOL_HPP
+#define PIXELSYNCOIT_THREADPOOL_HPP
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * A fixed number of worker threads processing tasks in FIFO order.
+ * Used for background work that should overlap with rendering (data-parallel loops use OpenMP instead).
+ */
+class ThreadPool
+{
+public:
+    /// @param numThreads The number of worker threads (at least one thread is created).
+    explicit ThreadPool(size_t numThreads);
+    /// Waits until all enqueued tasks have been processed.
+    ~ThreadPool();
+
+    void enqueue(std::function<void()> task);
+    /// Blocks until the queue is empty and no task is running anymore.
+    void waitForAll();
+
+    inline size_t getNumThreads() const { return workers.size(); }
+    /// Number of tasks that are enqueued or currently running.
+    size_t getNumPendingTasks();
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskAvailableCondition;
+    std::condition_variable tasksFinishedCondition;
+    size_t numRunningTasks = 0;
+    bool stopWorkers = false;
+};
+
+#endif //PIXELSYNCOIT_THREADPOOL_HPP
@@ -5,35 +5,55 @@
 #define _FILE_OFFSET_BITS 64
 
 #include <cstdio>
+#include <cmath>
+#include <algorithm>
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <Utils/File/Logfile.hpp>
 #include <Math/Geometry/AABB3.hpp>
-#include <Utils/Events/Stream/Stream.hpp>
 #include "NetCDFConverter.hpp"
+#include "BinLinesFile.hpp"
+#include "MappedFile.hpp"
+#include "NumberParser.hpp"
 #include "TrajectoryFile.hpp"
 #include <iostream>
 
-Trajectories loadTrajectoriesFromFile(const std::string &filename, TrajectoryType trajectoryType)
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/// Selects the loader depending on the file ending. The positions and attributes are returned as stored in the file.
+static TrajectorySet loadTrajectorySetFromFileUnnormalized(
+        const std::string &filename, TrajectoryType trajectoryType)
 {
-    Trajectories trajectories;
+    TrajectorySet trajectories;
 
     std::string lowerCaseFilename = boost::to_lower_copy(filename);
     if (boost::ends_with(lowerCaseFilename, ".obj")) {
-        trajectories = loadTrajectoriesFromObj(filename, trajectoryType);
+        trajectories = loadTrajectorySetFromObj(filename, trajectoryType);
     } else if (boost::ends_with(lowerCaseFilename, ".nc")) {
-        trajectories = loadTrajectoriesFromNetCdf(filename, trajectoryType);
+        trajectories = loadTrajectorySetFromNetCdf(filename, trajectoryType);
     } else if (boost::ends_with(lowerCaseFilename, ".binlines")) {
-        trajectories = loadTrajectoriesFromBinLines(filename, trajectoryType);
+        trajectories = loadTrajectorySetFromBinLines(filename);
     }
 
-    sgl::AABB3 boundingBox;
-    for (Trajectory &trajectory : trajectories) {
-        for (glm::vec3 &position : trajectory.positions) {
-            boundingBox.combine(position);
-        }
+    // if UCLA --> normalize attributes (the first attribute is the one read from the file)
+    if (trajectoryType == TRAJECTORY_TYPE_UCLA && trajectories.getNumAttributes() > 0) {
+        float minAttr = std::numeric_limits<float>::max();
+        float maxAttr = std::numeric_limits<float>::lowest();
+        trajectories.computeAttributeRange(0, minAttr, maxAttr);
+        trajectories.normalizeAttribute(0, minAttr, maxAttr);
     }
 
+    return trajectories;
+}
+
+/// Normalizes the positions for special datasets. The importance criteria are computed before on the positions as
+/// stored in the file.
+static void normalizeTrajectoryPositions(TrajectorySet &trajectories, TrajectoryType trajectoryType)
+{
+    sgl::AABB3 boundingBox = trajectories.computeBoundingBox();
+
     bool isConvectionRolls = trajectoryType == TRAJECTORY_TYPE_CONVECTION_ROLLS_NEW;
     bool isUCLA = trajectoryType == TRAJECTORY_TYPE_UCLA;
     bool isRings = trajectoryType == TRAJECTORY_TYPE_RINGS;
@@ -42,9 +62,6 @@ Trajectories loadTrajectoriesFromFile(const std::string &filename, TrajectoryTyp
     glm::vec3 minVec(boundingBox.getMinimum());
     glm::vec3 maxVec(boundingBox.getMaximum());
 
-    float minAttr = std::numeric_limits<float>::max();
-    float maxAttr = std::numeric_limits<float>::lowest();
-
     if (isConvectionRolls) {
         minVec = glm::vec3(0);
         maxVec = glm::vec3(0.5);
@@ -52,16 +69,6 @@ Trajectories loadTrajectoriesFromFile(const std::string &filename, TrajectoryTyp
     {
         minVec = glm::vec3(glm::min(boundingBox.getMinimum().x, std::min(boundingBox.getMinimum().y, boundingBox.getMinimum().z)));
         maxVec = glm::vec3(glm::max(boundingBox.getMaximum().x, std::max(boundingBox.getMaximum().y, boundingBox.getMaximum().z)));
-
-        for(const Trajectory& traj : trajectories)
-        {
-            for (const float& attr : traj.attributes[0])
-            {
-                minAttr = std::min(minAttr, attr);
-                maxAttr = std::max(maxAttr, attr);
-            }
-        }
-
     } else {
         // Normalize data for rings
         float minValue = glm::min(boundingBox.getMinimum().x, std::min(boundingBox.getMinimum().y, boundingBox.getMinimum().z));
@@ -71,176 +78,277 @@ Trajectories loadTrajectoriesFromFile(const std::string &filename, TrajectoryTyp
     }
 
     if (isRings || isConvectionRolls || isCfdData || isUCLA) {
-        for (Trajectory &trajectory : trajectories) {
-            for (glm::vec3 &position : trajectory.positions) {
-                position = (position - minVec) / (maxVec - minVec);
-                if (isConvectionRolls || isCfdData) {
-                    glm::vec3 dims = glm::vec3(1);
-                    dims.y = boundingBox.getDimensions().y;
-                    position -= dims;
-                }
-            }
+        glm::vec3 offset(0.0f);
+        if (isConvectionRolls || isCfdData) {
+            offset = glm::vec3(1);
+            offset.y = boundingBox.getDimensions().y;
         }
+        trajectories.normalizePositions(minVec, maxVec, offset);
     }
+}
 
-    // if UCLA --> normalize attributes
-    if (isUCLA)
-    {
-        for(Trajectory& traj : trajectories)
-        {
-            for (float& attr : traj.attributes[0])
-            {
-                attr = (attr - minAttr) / (maxAttr - minAttr);
-            }
-        }
-    }
+TrajectorySet loadTrajectorySetFromFile(const std::string &filename, TrajectoryType trajectoryType)
+{
+    TrajectorySet trajectories = loadTrajectorySetFromFileUnnormalized(filename, trajectoryType);
+    normalizeTrajectoryPositions(trajectories, trajectoryType);
+    return trajectories;
+}
 
+TrajectorySet loadTrajectorySetFromFile(const std::string &filename, TrajectoryType trajectoryType,
+        const std::vector<int> &importanceCriteria)
+{
+    // The loaders only compute the default criteria (.binlines files may store more attributes).
+    TrajectorySet trajectories = loadTrajectorySetFromFileUnnormalized(filename, trajectoryType);
+    if (!trajectories.empty() && (importanceCriteria != getDefaultImportanceCriteria(trajectoryType)
+            || trajectories.getNumAttributes() != importanceCriteria.size())) {
+        computeTrajectoryAttributes(trajectoryType, trajectories, importanceCriteria);
+    }
+    normalizeTrajectoryPositions(trajectories, trajectoryType);
     return trajectories;
 }
 
-Trajectories loadTrajectoriesFromObj(const std::string &filename, TrajectoryType trajectoryType)
+Trajectories loadTrajectoriesFromFile(const std::string &filename, TrajectoryType trajectoryType)
 {
-    bool isConvectionRolls = trajectoryType == TRAJECTORY_TYPE_CONVECTION_ROLLS_NEW;
-    bool isRings = trajectoryType == TRAJECTORY_TYPE_RINGS;
-    bool isUCLA = trajectoryType == TRAJECTORY_TYPE_UCLA;
-    Trajectories trajectories;
+    return loadTrajectorySetFromFile(filename, trajectoryType).toTrajectories();
+}
 
-    std::vector<glm::vec3> globalLineVertices;
-    std::vector<float> globalLineVertexAttributes;
+/// Invalid line points are used in many scientific datasets to indicate invalid lines.
+static inline bool isValidLinePoint(const glm::vec3 &pos)
+{
+    const float MAX_VAL = 1e10f;
+    return std::fabs(pos.x) <= MAX_VAL && std::fabs(pos.y) <= MAX_VAL && std::fabs(pos.z) <= MAX_VAL;
+}
 
-    FILE *file = fopen64(filename.c_str(), "r");
-    if (!file) {
-        sgl::Logfile::get()->writeError(std::string() + "Error in convertObjTrajectoryDataToBinaryLineMesh: File \""
-                                        + filename + "\" does not exist.");
-        return trajectories;
-    }
-#if defined(_WIN32) && !defined(__MINGW32__)
-    _fseeki64(file, 0, SEEK_END);
-    size_t length = _ftelli64(file);
-    _fseeki64(file, 0, SEEK_SET);
-#else
-    fseeko(file, 0, SEEK_END);
-    size_t length = ftello(file);
-    fseeko(file, 0, SEEK_SET);
-#endif
+/// Data parsed from one chunk of a line .obj file (see parseObjLineFileChunk).
+struct ObjLineFileChunk
+{
+    std::vector<glm::vec3> lineVertices;
+    std::vector<float> lineVertexAttributes;
+    /// The (zero-based) vertex indices of all lines in the chunk.
+    std::vector<uint32_t> lineIndices;
+    /// Offset of the first index of each line in lineIndices (plus one entry for the end of the last line).
+    std::vector<size_t> lineIndexOffsets;
+};
+
+static inline bool isLineBreak(char c)
+{
+    return c == '\n' || c == '\r';
+}
 
-    char *fileBuffer = new char[length];
-    fread(fileBuffer, 1, length, file);
-    fclose(file);
-    std::string lineBuffer;
-    std::string numberString;
-
-    for (size_t charPtr = 0; charPtr < length; ) {
-        while (charPtr < length) {
-            char currentChar = fileBuffer[charPtr];
-            if (currentChar == '\n' || currentChar == '\r') {
-                charPtr++;
-                break;
-            }
-            lineBuffer.push_back(currentChar);
+/**
+ * Parses all 'v', 'vt' and 'l' records in the range [chunkStart, chunkEnd) of a line .obj file.
+ * The range needs to start at the beginning of a line.
+ */
+static void parseObjLineFileChunk(
+        const char *chunkStart, const char *chunkEnd, bool isConvectionRolls, ObjLineFileChunk &chunk)
+{
+    chunk.lineIndexOffsets.push_back(0);
+
+    for (const char *charPtr = chunkStart; charPtr < chunkEnd; ) {
+        const char *lineStart = charPtr;
+        while (charPtr < chunkEnd && !isLineBreak(*charPtr)) {
+            charPtr++;
+        }
+        const char *lineEnd = charPtr;
+        if (charPtr < chunkEnd) {
             charPtr++;
         }
 
-        if (lineBuffer.size() == 0) {
+        if (lineStart == lineEnd) {
             continue;
         }
 
-        char command = lineBuffer.at(0);
+        char command = lineStart[0];
         char command2 = ' ';
-        if (lineBuffer.size() > 1) {
-            command2 = lineBuffer.at(1);
+        if (lineEnd - lineStart > 1) {
+            command2 = lineStart[1];
         }
+        const char *arguments = std::min(lineStart + 2, lineEnd);
 
         if (command == 'g') {
             // New path
-            /*static int ctr = 0;
-            if (ctr >= 999) {
-                Logfile::get()->writeInfo(std::string() + "Parsing trajectory line group " + line.at(1) + "...");
-            }
-            ctr = (ctr + 1) % 1000;*/
         } else if (command == 'v' && command2 == 't') {
             // Path line vertex attribute
             float attr = 0.0f;
-            sscanf(lineBuffer.c_str()+2, "%f", &attr);
-            globalLineVertexAttributes.push_back(attr);
+            parseFloat(arguments, lineEnd, attr);
+            chunk.lineVertexAttributes.push_back(attr);
         } else if (command == 'v' && command2 == 'n') {
             // Not supported so far
         } else if (command == 'v') {
-            // Path line vertex position
-            glm::vec3 position;
-            if (isUCLA)
-            {
-                sscanf(lineBuffer.c_str()+2, "%f %f %f", &position.x, &position.y, &position.z);
+            // Path line vertex position (components that could not be parsed stay zero, like with sscanf)
+            glm::vec3 position(0.0f);
+            float *components[3] = { &position.x, &position.y, &position.z };
+            if (isConvectionRolls) {
+                components[1] = &position.z;
+                components[2] = &position.y;
             }
-            else if (isConvectionRolls) {
-                sscanf(lineBuffer.c_str()+2, "%f %f %f", &position.x, &position.z, &position.y);
-            } else {
-                sscanf(lineBuffer.c_str()+2, "%f %f %f", &position.x, &position.y, &position.z);
+            const char *numberPtr = arguments;
+            for (int i = 0; i < 3 && numberPtr != nullptr; i++) {
+                numberPtr = parseFloat(numberPtr, lineEnd, *components[i]);
             }
-            globalLineVertices.push_back(position);
+            chunk.lineVertices.push_back(position);
         } else if (command == 'l') {
-            // Get indices of current path line
-            std::vector<uint32_t> currentLineIndices;
-            for (size_t linePtr = 2; linePtr < lineBuffer.size(); linePtr++) {
-                char currentChar = lineBuffer.at(linePtr);
-                bool isWhitespace = currentChar == ' ' || currentChar == '\t';
-                if (isWhitespace && numberString.size() != 0) {
-                    currentLineIndices.push_back(atoi(numberString.c_str()) - 1);
-                    numberString.clear();
-                } else if (!isWhitespace) {
-                    numberString.push_back(currentChar);
+            // Get indices of current path line (whitespace-separated tokens, converted like atoi)
+            const char *tokenPtr = arguments;
+            while (tokenPtr < lineEnd) {
+                while (tokenPtr < lineEnd && (*tokenPtr == ' ' || *tokenPtr == '\t')) {
+                    tokenPtr++;
                 }
+                if (tokenPtr == lineEnd) {
+                    break;
+                }
+                const char *tokenEnd = tokenPtr;
+                while (tokenEnd < lineEnd && *tokenEnd != ' ' && *tokenEnd != '\t') {
+                    tokenEnd++;
+                }
+                int index = 0;
+                parseInt(tokenPtr, tokenEnd, index);
+                chunk.lineIndices.push_back(uint32_t(index - 1));
+                tokenPtr = tokenEnd;
             }
-            if (numberString.size() != 0) {
-                currentLineIndices.push_back(atoi(numberString.c_str()) - 1);
-                numberString.clear();
-            }
+            chunk.lineIndexOffsets.push_back(chunk.lineIndices.size());
+        } else if (command == '#') {
+            // Ignore comments
+        } else {
+            //Logfile::get()->writeError(std::string() + "Error in parseObjMesh: Unknown command \"" + command + "\".");
+        }
+    }
+}
+
+TrajectorySet loadTrajectorySetFromObj(const std::string &filename, TrajectoryType trajectoryType)
+{
+    bool isConvectionRolls = trajectoryType == TRAJECTORY_TYPE_CONVECTION_ROLLS_NEW;
+    TrajectorySet trajectories;
 
-            Trajectory trajectory;
+    MappedFile file;
+    if (!file.open(filename)) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in loadTrajectoriesFromObj: File \""
+                                        + filename + "\" could not be opened.");
+        return trajectories;
+    }
+    const char *fileBuffer = (const char*)file.getData();
+    const size_t length = file.getSize();
+    file.prefetch(0, length);
+
+    // Split the file into chunks at line boundaries. Multiple chunks per thread are used for load balancing.
+    int numThreads = 1;
+#ifdef _OPENMP
+    numThreads = omp_get_max_threads();
+#endif
+    const size_t MIN_CHUNK_SIZE = 1u << 20u;
+    size_t numChunks = std::max(std::min(size_t(numThreads) * 4, length / MIN_CHUNK_SIZE), size_t(1));
+    std::vector<size_t> chunkOffsets(numChunks + 1);
+    chunkOffsets.front() = 0;
+    chunkOffsets.back() = length;
+    for (size_t i = 1; i < numChunks; i++) {
+        size_t offset = std::max(length * i / numChunks, chunkOffsets.at(i - 1));
+        while (offset < length && offset > 0 && !isLineBreak(fileBuffer[offset - 1])) {
+            offset++;
+        }
+        chunkOffsets.at(i) = offset;
+    }
 
-            std::vector<float> pathLineVorticities;
-            trajectory.positions.reserve(currentLineIndices.size());
-            pathLineVorticities.reserve(currentLineIndices.size());
-            for (size_t i = 0; i < currentLineIndices.size(); i++) {
-                glm::vec3 pos = globalLineVertices.at(currentLineIndices.at(i));
+    std::vector<ObjLineFileChunk> chunks(numChunks);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t i = 0; i < numChunks; i++) {
+        parseObjLineFileChunk(fileBuffer + chunkOffsets.at(i), fileBuffer + chunkOffsets.at(i + 1),
+                isConvectionRolls, chunks.at(i));
+    }
+    file.close();
+
+    // Merge the vertex data of all chunks in file order
+    std::vector<size_t> chunkVertexOffsets(numChunks + 1, 0);
+    std::vector<size_t> chunkAttributeOffsets(numChunks + 1, 0);
+    std::vector<size_t> chunkLineOffsets(numChunks + 1, 0);
+    for (size_t i = 0; i < numChunks; i++) {
+        chunkVertexOffsets.at(i + 1) = chunkVertexOffsets.at(i) + chunks.at(i).lineVertices.size();
+        chunkAttributeOffsets.at(i + 1) = chunkAttributeOffsets.at(i) + chunks.at(i).lineVertexAttributes.size();
+        chunkLineOffsets.at(i + 1) = chunkLineOffsets.at(i) + chunks.at(i).lineIndexOffsets.size() - 1;
+    }
+    std::vector<glm::vec3> globalLineVertices(chunkVertexOffsets.back());
+    std::vector<float> globalLineVertexAttributes(chunkAttributeOffsets.back());
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t i = 0; i < numChunks; i++) {
+        ObjLineFileChunk &chunk = chunks.at(i);
+        std::copy(chunk.lineVertices.begin(), chunk.lineVertices.end(),
+                globalLineVertices.begin() + chunkVertexOffsets.at(i));
+        std::copy(chunk.lineVertexAttributes.begin(), chunk.lineVertexAttributes.end(),
+                globalLineVertexAttributes.begin() + chunkAttributeOffsets.at(i));
+        chunk.lineVertices.clear(); chunk.lineVertices.shrink_to_fit();
+        chunk.lineVertexAttributes.clear(); chunk.lineVertexAttributes.shrink_to_fit();
+    }
 
-                // Remove invalid line points (used in many scientific datasets to indicate invalid lines).
-                const float MAX_VAL = 1e10f;
-                if (std::fabs(pos.x) > MAX_VAL || std::fabs(pos.y) > MAX_VAL || std::fabs(pos.z) > MAX_VAL) {
+    // Count the valid points of all lines
+    std::vector<size_t> numPointsPerLine(chunkLineOffsets.back(), 0);
+    bool indicesValid = true;
+    #pragma omp parallel for schedule(dynamic, 1) reduction(&&:indicesValid)
+    for (size_t chunkIdx = 0; chunkIdx < numChunks; chunkIdx++) {
+        const ObjLineFileChunk &chunk = chunks.at(chunkIdx);
+        size_t numChunkLines = chunk.lineIndexOffsets.size() - 1;
+        for (size_t lineIdx = 0; lineIdx < numChunkLines; lineIdx++) {
+            size_t numPoints = 0;
+            for (size_t i = chunk.lineIndexOffsets.at(lineIdx); i < chunk.lineIndexOffsets.at(lineIdx + 1); i++) {
+                uint32_t vertexIndex = chunk.lineIndices.at(i);
+                if (vertexIndex >= globalLineVertices.size() || vertexIndex >= globalLineVertexAttributes.size()) {
+                    indicesValid = false;
                     continue;
                 }
-
-                trajectory.positions.push_back(globalLineVertices.at(currentLineIndices.at(i)));
-                pathLineVorticities.push_back(globalLineVertexAttributes.at(currentLineIndices.at(i)));
+                if (isValidLinePoint(globalLineVertices.at(vertexIndex))) {
+                    numPoints++;
+                }
             }
-
-            // Compute importance criteria
-            computeTrajectoryAttributes(
-                    trajectoryType, trajectory.positions, pathLineVorticities, trajectory.attributes);
-
-            // Line filtering for WCB trajectories
-            //if (trajectoryType == TRAJECTORY_TYPE_WCB) {
-            //  if (importanceCriteriaIn.at(3).size() > 0 && importanceCriteriaIn.at(3).at(0) < 500.0f) {
-            //      continue;
-            //  }
-            //}
-
-            trajectories.push_back(trajectory);
-        } else if (command = '#') {
-            // Ignore comments
-        } else {
-            //Logfile::get()->writeError(std::string() + "Error in parseObjMesh: Unknown command \"" + command + "\".");
+            numPointsPerLine.at(chunkLineOffsets.at(chunkIdx) + lineIdx) = numPoints;
         }
+    }
 
-        lineBuffer.clear();
+    // Write the points of all lines directly to the contiguous arrays of the trajectory set
+    trajectories.allocate(numPointsPerLine, 1);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t chunkIdx = 0; chunkIdx < numChunks; chunkIdx++) {
+        const ObjLineFileChunk &chunk = chunks.at(chunkIdx);
+        size_t numChunkLines = chunk.lineIndexOffsets.size() - 1;
+        for (size_t lineIdx = 0; lineIdx < numChunkLines; lineIdx++) {
+            size_t globalLineIdx = chunkLineOffsets.at(chunkIdx) + lineIdx;
+            ArrayView<glm::vec3> linePositions = trajectories.getPositions(globalLineIdx);
+            ArrayView<float> lineVorticities = trajectories.getAttribute(globalLineIdx, 0);
+            size_t pointIdx = 0;
+            for (size_t i = chunk.lineIndexOffsets.at(lineIdx); i < chunk.lineIndexOffsets.at(lineIdx + 1); i++) {
+                uint32_t vertexIndex = chunk.lineIndices.at(i);
+                if (vertexIndex >= globalLineVertices.size() || vertexIndex >= globalLineVertexAttributes.size()) {
+                    continue;
+                }
+                const glm::vec3 &pos = globalLineVertices.at(vertexIndex);
+                if (isValidLinePoint(pos)) {
+                    linePositions[pointIdx] = pos;
+                    lineVorticities[pointIdx] = globalLineVertexAttributes.at(vertexIndex);
+                    pointIdx++;
+                }
+            }
+        }
+    }
+    chunks.clear();
+    globalLineVertices.clear(); globalLineVertices.shrink_to_fit();
+    globalLineVertexAttributes.clear(); globalLineVertexAttributes.shrink_to_fit();
+
+    // Compute importance criteria
+    computeTrajectoryAttributes(trajectoryType, trajectories);
+
+    // Line filtering for WCB trajectories
+    //if (trajectoryType == TRAJECTORY_TYPE_WCB) {
+    //  if (importanceCriteriaIn.at(3).size() > 0 && importanceCriteriaIn.at(3).at(0) < 500.0f) {
+    //      continue;
+    //  }
+    //}
+
+    if (!indicesValid) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in loadTrajectoriesFromObj: File \""
+                + filename + "\" contains line indices referencing non-existent vertices or attributes.");
     }
 
     // compute byte size of raw representation with 1 attribute for paper
-    uint64_t byteSize = 0;
-    for (const auto& traj : trajectories)
-    {
-        byteSize += traj.positions.size() * sizeof(float) * 3;
-        byteSize += traj.attributes[0].size() * sizeof(float);
+    uint64_t byteSize = trajectories.getNumPoints() * sizeof(float) * 3;
+    if (trajectories.getNumAttributes() > 0) {
+        byteSize += trajectories.attributes.at(0).size() * sizeof(float);
     }
 
     byteSize = byteSize / 1024 / 1024;
@@ -249,67 +357,19 @@ Trajectories loadTrajectoriesFromObj(const std::string &filename, TrajectoryType
     return trajectories;
 }
 
-Trajectories loadTrajectoriesFromNetCdf(const std::string &filename, TrajectoryType trajectoryType) {
-    Trajectories trajectories = loadNetCdfFile(filename);
-
-    for (Trajectory &trajectory : trajectories) {
-        // Compute importance criteria
-        std::vector<float> oldAttributes = trajectory.attributes.at(0);
-        trajectory.attributes.clear();
-        computeTrajectoryAttributes(
-                trajectoryType, trajectory.positions, oldAttributes, trajectory.attributes);
-    }
-
+TrajectorySet loadTrajectorySetFromNetCdf(const std::string &filename, TrajectoryType trajectoryType) {
+    // The importance criteria are computed chunk by chunk while the file is being read.
+    NetCdfReadSettings settings;
+    settings.computeAttributes = true;
+    settings.trajectoryType = trajectoryType;
+    TrajectorySet trajectories;
+    loadNetCdfFile(filename, trajectories, settings);
     return trajectories;
 }
 
-Trajectories loadTrajectoriesFromBinLines(const std::string &filename, TrajectoryType trajectoryType) {
-    Trajectories trajectories;
-
-    std::ifstream file(filename.c_str(), std::ifstream::binary);
-    if (!file.is_open()) {
-        sgl::Logfile::get()->writeError(std::string() + "Error in loadTrajectoriesFromBinLines: File \""
-                + filename + "\" not found.");
-        return trajectories;
-    }
-
-    file.seekg(0, file.end);
-    size_t size = file.tellg();
-    file.seekg(0);
-    char *buffer = new char[size];
-    file.read(buffer, size);
-
-    // Read format version
-    sgl::BinaryReadStream stream(buffer, size);
-    const uint32_t LINE_FILE_FORMAT_VERSION = 1u;
-    uint32_t versionNumber;
-    stream.read(versionNumber);
-    if (versionNumber != LINE_FILE_FORMAT_VERSION) {
-        sgl::Logfile::get()->writeError(std::string()
-                + "Error in loadTrajectoriesFromBinLines: Invalid magic number in file \"" + filename + "\".");
-        return trajectories;
-    }
-
-
-
-    // Rest of header after format version
-    uint32_t numTrajectories, numAttributes, trajectoryNumPoints;
-    stream.read(numTrajectories);
-    stream.read(numAttributes);
-    trajectories.resize(numTrajectories);
-
-    for (uint32_t trajectoryIndex = 0; trajectoryIndex < numTrajectories; trajectoryIndex++) {
-        Trajectory &currentTrajectory = trajectories.at(trajectoryIndex);
-        stream.read(trajectoryNumPoints);
-        currentTrajectory.positions.resize(trajectoryNumPoints);
-        stream.read((void*)&currentTrajectory.positions.front(), sizeof(glm::vec3)*trajectoryNumPoints);
-        currentTrajectory.attributes.resize(numAttributes);
-        for (uint32_t attributeIndex = 0; attributeIndex < numAttributes; attributeIndex++) {
-            std::vector<float> &currentAttribute = currentTrajectory.attributes.at(attributeIndex);
-            currentAttribute.resize(trajectoryNumPoints);
-            stream.read((void*)&currentAttribute.front(), sizeof(float)*trajectoryNumPoints);
-        }
-    }
-
+TrajectorySet loadTrajectorySetFromBinLines(const std::string &filename) {
+    // Supports version 1 and 2 files; errors are logged by readBinLinesFile.
+    TrajectorySet trajectories;
+    readBinLinesFile(filename, trajectories);
     return trajectories;
 }
@@ -9,26 +9,34 @@
 #include <vector>
 #include <glm/glm.hpp>
 #include "Utils/ImportanceCriteria.hpp"
-
-struct Trajectory {
-    std::vector<glm::vec3> positions;
-    std::vector<std::vector<float>> attributes;
-};
-
-typedef std::vector<Trajectory> Trajectories;
+#include "Utils/TrajectorySet.hpp"
 
 /**
- * Selects loadTrajectoriesFromObj, loadTrajectoriesFromNetCdf or loadTrajectoriesFromBinLines depending on the file
- * endings and performs some normalization for special datasets (e.g. the rings dataset).
+ * Selects loadTrajectorySetFromObj, loadTrajectorySetFromNetCdf or loadTrajectorySetFromBinLines depending on the
+ * file endings and performs some normalization for special datasets (e.g. the rings dataset).
  * @param filename The name of the trajectory file to open.
  * @return The trajectories loaded from the file (empty if the file could not be opened).
  */
+TrajectorySet loadTrajectorySetFromFile(const std::string &filename, TrajectoryType trajectoryType);
+
+/**
+ * Same as above, but attribute i of the returned set is the importance criterion importanceCriteria[i] (see
+ * getImportanceCriterionKernels). Only the requested criteria are computed (on the positions as stored in the file,
+ * i.e., before the normalization).
+ */
+TrajectorySet loadTrajectorySetFromFile(const std::string &filename, TrajectoryType trajectoryType,
+        const std::vector<int> &importanceCriteria);
+
+/**
+ * Same as loadTrajectorySetFromFile, but returns one Trajectory object per line.
+ */
 Trajectories loadTrajectoriesFromFile(const std::string &filename, TrajectoryType trajectoryType);
 
-Trajectories loadTrajectoriesFromObj(const std::string &filename, TrajectoryType trajectoryType);
+TrajectorySet loadTrajectorySetFromObj(const std::string &filename, TrajectoryType trajectoryType);
 
-Trajectories loadTrajectoriesFromNetCdf(const std::string &filename, TrajectoryType trajectoryType);
+TrajectorySet loadTrajectorySetFromNetCdf(const std::string &filename, TrajectoryType trajectoryType);
 
-Trajectories loadTrajectoriesFromBinLines(const std::string &filename, TrajectoryType trajectoryType);
+/// The attributes are read from the file as stored by the conversion, i.e., no importance criteria are computed.
+TrajectorySet loadTrajectorySetFromBinLines(const std::string &filename);
 
 #endif //PIXELSYNCOIT_TRAJECTORYFILE_HPP
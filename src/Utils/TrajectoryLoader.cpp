@@ -5,16 +5,17 @@
 #include <Utils/File/Logfile.hpp>
 #include <Utils/Convert.hpp>
 #include <Math/Math.hpp>
-#include <Graphics/Shader/ShaderManager.hpp>
-#include <Graphics/Renderer.hpp>
 
 #include <chrono>
 #include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cfloat>
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/split.hpp>
-#include <GL/glew.h>
 
 #include "MeshSerializer.hpp"
+#include "ParallelAlgorithms.hpp"
 #include "TrajectoryFile.hpp"
 #include "TrajectoryLoader.hpp"
 
@@ -47,15 +48,14 @@ void initializeCircleData(int numSegments, float radius)
 }
 
 /**
- * Returns a oriented and shifted copy of a 2D circle in 3D space.
- * The number
- * @param vertices The list to append the circle points to.
- * @param normals Normal array of the tube to append normals to.
+ * Writes an oriented and shifted copy of a 2D circle in 3D space to the passed arrays.
+ * @param vertices The array to write the circle points to (space for circlePoints2D.size() points).
+ * @param normals Normal array of the tube to write the normals to (space for circlePoints2D.size() normals).
  * @param center The center of the circle in 3D space.
  * @param normal The normal orthogonal to the circle plane.
  * @param lastTangent The tangent of the last circle.
  */
-void insertOrientedCirclePoints(std::vector<glm::vec3> &vertices, std::vector<glm::vec3> &normals,
+static void writeOrientedCirclePoints(glm::vec3 *vertices, glm::vec3 *normals,
         const glm::vec3 &center, const glm::vec3 &normal, glm::vec3 &lastTangent)
 {
     if (circlePoints2D.size() == 0) {
@@ -89,271 +89,278 @@ void insertOrientedCirclePoints(std::vector<glm::vec3> &vertices, std::vector<gl
             center.x, center.y, center.z, 1.0f);
     glm::mat4 transform = translation * tangentFrameMatrix;
 
-    for (const glm::vec2 &circlePoint : circlePoints2D) {
+    for (size_t i = 0; i < circlePoints2D.size(); i++) {
+        const glm::vec2 &circlePoint = circlePoints2D.at(i);
         glm::vec4 transformedPoint = transform * glm::vec4(circlePoint.x, circlePoint.y, 0.0f, 1.0f);
-        vertices.push_back(glm::vec3(transformedPoint.x, transformedPoint.y, transformedPoint.z));
+        vertices[i] = glm::vec3(transformedPoint.x, transformedPoint.y, transformedPoint.z);
         glm::vec3 normal = glm::vec3(transformedPoint.x, transformedPoint.y, transformedPoint.z) - center;
         normal = glm::normalize(normal);
-        normals.push_back(normal);
+        normals[i] = normal;
     }
 }
 
-
-struct TubeNode
-{
-    /// Center vertex position
-    glm::vec3 center;
-
-    /// Tangent pointing in direction of next node (or negative direction of last node for the final node in the list).
-    glm::vec3 tangent;
-
-    /// Circle points (circle with center of tube node, in plane with normal vector of tube node)
-    std::vector<glm::vec3> circleVertices;
-
-    std::vector<uint32_t> circleIndices;
-};
-
 /**
- * @param pathLineCenters: The (input) path line points to create a tube from.
- * @param pathLineAttributes: The (input) path line point vertex attributes (belonging to pathLineCenters).
- * @param vertices: The (output) vertex points, which are a set of oriented circles around the centers (see above).
- * @param indices: The (output) indices specifying how tube triangles are built from the circle vertices.
+ * Computes the tangent of the tube node at the line point with index i.
+ * @return False if the line point is skipped when creating the tube (invalid position or degenerate segment).
  */
-template<typename T>
-void createTubeRenderData(const std::vector<glm::vec3> &pathLineCenters,
-                          const std::vector<T> &pathLineAttributes,
-                          std::vector<glm::vec3> &vertices,
-                          std::vector<glm::vec3> &normals,
-                          std::vector<T> &vertexAttributes,
-                          std::vector<uint32_t> &indices)
+static bool computeTubeNodeTangent(ArrayView<const glm::vec3> pathLineCenters, int i, glm::vec3 &tangent)
 {
     int n = (int)pathLineCenters.size();
-    if (n < 2) {
-        sgl::Logfile::get()->writeError("Error in createTube: n < 2");
-        return;
+    const glm::vec3 &center = pathLineCenters[i];
+
+    // Remove invalid line points (used in many scientific datasets to indicate invalid lines).
+    const float MAX_VAL = 1e10;
+    if (std::fabs(center.x) > MAX_VAL || std::fabs(center.y) > MAX_VAL || std::fabs(center.z) > MAX_VAL) {
+        return false;
     }
 
-    /// Circle points (circle with center of tube node, in plane with normal vector of tube node)
-    vertices.reserve(n*circlePoints2D.size());
-    normals.reserve(n*circlePoints2D.size());
-    vertexAttributes.reserve(n*circlePoints2D.size());
-    indices.reserve((n-1)*circlePoints2D.size()*6);
+    if (i == 0) {
+        // First node
+        tangent = pathLineCenters[i+1] - pathLineCenters[i];
+    } else if (i == n-1) {
+        // Last node
+        tangent = pathLineCenters[i] - pathLineCenters[i-1];
+    } else {
+        // Node with two neighbors - use both normals
+        tangent = pathLineCenters[i+1] - pathLineCenters[i];
+        //normal += pathLineCenters[i] - pathLineCenters[i-1];
+    }
 
-    std::vector<TubeNode> tubeNodes;
-    tubeNodes.reserve(n);
-    int numVertexPts = 0;
+    float lineSegmentLength = glm::length(tangent);
 
-    // Turbulence dataset: Remove fixed point whirls
-    glm::vec3 diffFirstLast = pathLineCenters.front() - pathLineCenters.back();
-    if (glm::length(diffFirstLast) < 0.01f) {
-        return;
+    if (lineSegmentLength < 0.0001f) {
+        // In case the two vertices are almost identical, just skip this path line segment
+        return false;
     }
+    tangent = glm::normalize(tangent);
+    return true;
+}
 
-    // First, create a list of tube nodes
-    glm::vec3 lastNormal = glm::vec3(1.0f, 0.0f, 0.0f);
+/**
+ * @return The number of tube nodes (i.e., circles) created for the passed line (n >= 2 is expected).
+ */
+static int countTubeNodes(ArrayView<const glm::vec3> pathLineCenters)
+{
+    int n = (int)pathLineCenters.size();
+    int numTubeNodes = 0;
+    glm::vec3 tangent;
     for (int i = 0; i < n; i++) {
-        glm::vec3 center = pathLineCenters.at(i);
-
-        // Remove invalid line points (used in many scientific datasets to indicate invalid lines).
-        const float MAX_VAL = 1e10;
-        if (std::fabs(center.x) > MAX_VAL || std::fabs(center.y) > MAX_VAL || std::fabs(center.z) > MAX_VAL) {
-            continue;
+        if (computeTubeNodeTangent(pathLineCenters, i, tangent)) {
+            numTubeNodes++;
         }
-
-        glm::vec3 tangent;
-        if (i == 0) {
-            // First node
-            tangent = pathLineCenters.at(i+1) - pathLineCenters.at(i);
-        } else if (i == n-1) {
-            // Last node
-            tangent = pathLineCenters.at(i) - pathLineCenters.at(i-1);
-        } else {
-            // Node with two neighbors - use both normals
-            tangent = pathLineCenters.at(i+1) - pathLineCenters.at(i);
-            //normal += pathLineCenters.at(i) - pathLineCenters.at(i-1);
-        }
-
-        if (glm::length(tangent) < 0.0001f) {
-            // In case the two vertices are almost identical, just skip this path line segment
-            continue;
-        }
-
-        TubeNode node;
-        node.center = pathLineCenters.at(i);
-        node.tangent = glm::normalize(tangent);
-        insertOrientedCirclePoints(vertices, normals, node.center, node.tangent, lastNormal);
-        node.circleIndices.reserve(circlePoints2D.size());
-        for (int j = 0; j < circlePoints2D.size(); j++) {
-            node.circleIndices.push_back(j + numVertexPts*circlePoints2D.size());
-            if (pathLineAttributes.size() > 0) {
-                vertexAttributes.push_back(pathLineAttributes.at(i));
-            }
-        }
-        tubeNodes.push_back(node);
-        numVertexPts++;
     }
+    return numTubeNodes;
+}
 
-
+/**
+ * Writes the indices of the triangles connecting the circles of numTubeNodes consecutive tube nodes.
+ * @param vertexOffset: The index of the first vertex of the tube in the (global) vertex arrays.
+ * @param indices: The (output) indices (space for (numTubeNodes-1) * numCirclePoints * 6 indices).
+ */
+static void writeTubeIndices(size_t numTubeNodes, size_t numCirclePoints, size_t vertexOffset, uint32_t *indices)
+{
     // Create tube triangles/indices for the vertex data
-    /*for (int i = 0; i < numVertexPts-1; i++) {
-        std::vector<uint32_t> &circleIndicesCurrent = tubeNodes.at(i).circleIndices;
-        std::vector<uint32_t> &circleIndicesNext = tubeNodes.at(i+1).circleIndices;
-        for (int j = 0; j < circlePoints2D.size(); j++) {
+    size_t indexCounter = 0;
+    for (size_t i = 0; i < numTubeNodes-1; i++) {
+        for (size_t j = 0; j < numCirclePoints; j++) {
             // Build two CCW triangles (one quad) for each side
             // Triangle 1
-            indices.push_back(circleIndicesCurrent.at(j));
-            indices.push_back(circleIndicesCurrent.at((j+1)%circlePoints2D.size()));
-            indices.push_back(circleIndicesNext.at((j+1)%circlePoints2D.size()));
+            indices[indexCounter++] = vertexOffset + j + i*numCirclePoints;
+            indices[indexCounter++] = vertexOffset + (j+1)%numCirclePoints + i*numCirclePoints;
+            indices[indexCounter++] = vertexOffset + (j+1)%numCirclePoints + (i+1)*numCirclePoints;
 
             // Triangle 2
-            indices.push_back(circleIndicesCurrent.at(j));
-            indices.push_back(circleIndicesNext.at((j+1)%circlePoints2D.size()));
-            indices.push_back(circleIndicesNext.at(j));
+            indices[indexCounter++] = vertexOffset + j + i*numCirclePoints;
+            indices[indexCounter++] = vertexOffset + (j+1)%numCirclePoints + (i+1)*numCirclePoints;
+            indices[indexCounter++] = vertexOffset + j + (i+1)*numCirclePoints;
         }
-    }*/
-    for (int i = 0; i < numVertexPts-1; i++) {
-        for (int j = 0; j < circlePoints2D.size(); j++) {
-            // Build two CCW triangles (one quad) for each side
-            // Triangle 1
-            indices.push_back(j + i*circlePoints2D.size());
-            indices.push_back((j+1)%circlePoints2D.size() + i*circlePoints2D.size());
-            indices.push_back((j+1)%circlePoints2D.size() + (i+1)*circlePoints2D.size());
-
-            // Triangle 2
-            indices.push_back(j + i*circlePoints2D.size());
-            indices.push_back((j+1)%circlePoints2D.size() + (i+1)*circlePoints2D.size());
-            indices.push_back(j + (i+1)*circlePoints2D.size());
-        }
-    }
-
-    // Only one vertex left -> Output nothing (tube consisting only of one point)
-    if (numVertexPts <= 1) {
-        vertices.clear();
-        normals.clear();
-        vertexAttributes.clear();
     }
 }
-void createTubeRenderData(const std::vector<glm::vec3> &pathLineCenters,
-                          std::vector<std::vector<float>> &importanceCriteriaLine,
-                          std::vector<glm::vec3> &vertices,
-                          std::vector<glm::vec3> &normals,
-                          std::vector<std::vector<float>> &importanceCriteriaVertex,
-                          std::vector<uint32_t> &indices)
+
+/**
+ * Writes the tube render data of one line to preallocated arrays. The caller is responsible for only passing lines
+ * with countTubeNodes(pathLineCenters) > 1.
+ * @param pathLineCenters: The (input) path line points to create a tube from.
+ * @param attributesLine: The (input) attributes of the line points (one view per attribute, e.g. importance criteria).
+ * @param vertexOffset: The index of the first vertex of this line in the (global) vertex arrays.
+ * @param vertices: The (output) vertex points of this line (space for numTubeNodes * circlePoints2D.size() points).
+ * @param normals: The (output) vertex normals of this line (same size as vertices).
+ * @param attributesVertex: The (output) global per-vertex attributes. The values of this line are written starting
+ * at vertexOffset.
+ * @param indices: The (output) indices of this line (space for (numTubeNodes-1) * circlePoints2D.size() * 6 indices).
+ * The indices are global, i.e., vertexOffset is added to them.
+ */
+template<typename T>
+static void writeTubeRenderData(ArrayView<const glm::vec3> pathLineCenters,
+                                const std::vector<ArrayView<const T>> &attributesLine,
+                                size_t vertexOffset,
+                                glm::vec3 *vertices,
+                                glm::vec3 *normals,
+                                std::vector<std::vector<T>> &attributesVertex,
+                                uint32_t *indices)
 {
     int n = (int)pathLineCenters.size();
-    int numImportanceCriteria = (int)importanceCriteriaLine.size();
-    if (n < 2) {
-        sgl::Logfile::get()->writeError("Error in createTube: n < 2");
-        return;
-    }
+    size_t numAttributes = attributesVertex.size();
+    size_t numCirclePoints = circlePoints2D.size();
+    size_t numVertexPts = 0;
 
-    /// Circle points (circle with center of tube node, in plane with normal vector of tube node)
-    vertices.reserve(n*circlePoints2D.size());
-    normals.reserve(n*circlePoints2D.size());
-    importanceCriteriaVertex.resize(numImportanceCriteria);
-    for (int i = 0; i < numImportanceCriteria; i++) {
-        importanceCriteriaVertex.at(i).reserve(n);
-    }
-    indices.reserve((n-1)*circlePoints2D.size()*6);
-
-    // List of all line nodes (points with data)
-    std::vector<TubeNode> tubeNodes;
-    tubeNodes.reserve(n);
-    int numVertexPts = 0;
-
-    // First, create a list of tube nodes
+    // First, create the oriented circles around the tube nodes
     glm::vec3 lastNormal = glm::vec3(1.0f, 0.0f, 0.0f);
+    glm::vec3 tangent;
     for (int i = 0; i < n; i++) {
-        glm::vec3 center = pathLineCenters.at(i);
-
-        // Remove invalid line points (used in many scientific datasets to indicate invalid lines).
-        const float MAX_VAL = 1e10;
-        if (std::fabs(center.x) > MAX_VAL || std::fabs(center.y) > MAX_VAL || std::fabs(center.z) > MAX_VAL) {
+        if (!computeTubeNodeTangent(pathLineCenters, i, tangent)) {
             continue;
         }
 
-        glm::vec3 tangent;
-        if (i == 0) {
-            // First node
-            tangent = pathLineCenters.at(i+1) - pathLineCenters.at(i);
-        } else if (i == n-1) {
-            // Last node
-            tangent = pathLineCenters.at(i) - pathLineCenters.at(i-1);
-        } else {
-            // Node with two neighbors - use both normals
-            tangent = pathLineCenters.at(i+1) - pathLineCenters.at(i);
-            //normal += pathLineCenters.at(i) - pathLineCenters.at(i-1);
+        size_t circleOffset = numVertexPts * numCirclePoints;
+        writeOrientedCirclePoints(vertices + circleOffset, normals + circleOffset, pathLineCenters[i], tangent,
+                lastNormal);
+        for (size_t k = 0; k < numAttributes; k++) {
+            T attribute = attributesLine.at(k)[i];
+            T *attributesCircle = &attributesVertex.at(k).at(vertexOffset + circleOffset);
+            for (size_t j = 0; j < numCirclePoints; j++) {
+                attributesCircle[j] = attribute;
+            }
         }
+        numVertexPts++;
+    }
 
-        float lineSegmentLength = glm::length(tangent);
+    writeTubeIndices(numVertexPts, numCirclePoints, vertexOffset, indices);
+}
 
-        if (lineSegmentLength < 0.0001f) {
-            //normal = glm::vec3(1.0f, 0.0f, 0.0f);
-            // In case the two vertices are almost identical, just skip this path line segment
+
+/// The ranges of the vertices and indices of multiple lines in the (global) output arrays.
+struct LineMeshRanges
+{
+    std::vector<size_t> vertexCounts, indexCounts;
+    std::vector<size_t> vertexOffsets, indexOffsets; ///< The exclusive prefix sums of the counts.
+    size_t numVertices = 0, numIndices = 0;
+    int numTooShortLines = 0; ///< Lines with less than two points.
+};
+
+/**
+ * Counting pass of the converters: Computes the number of vertices and indices of each line (in parallel) and their
+ * offsets in the output arrays. Lines with less than two points get an empty range.
+ * @param getLinePositions: Returns the points of line i (ArrayView<const glm::vec3>).
+ * @param isLineMesh: One vertex per tube node and two indices per segment (lines with one tube node are kept) instead
+ * of tubes with numCirclePoints vertices per tube node (lines with only one tube node are skipped).
+ * @param skipClosedLines: Whether to skip closed lines (fixed point whirls of the turbulence dataset).
+ */
+template<typename LinePositionsFunction>
+static void computeLineMeshRanges(size_t numLines, const LinePositionsFunction &getLinePositions, bool isLineMesh,
+        size_t numCirclePoints, bool skipClosedLines, LineMeshRanges &ranges)
+{
+    ranges.vertexCounts.assign(numLines, 0);
+    ranges.indexCounts.assign(numLines, 0);
+    int numTooShortLines = 0;
+    #pragma omp parallel for schedule(dynamic, 256) reduction(+:numTooShortLines)
+    for (size_t i = 0; i < numLines; i++) {
+        ArrayView<const glm::vec3> pathLineCenters = getLinePositions(i);
+        if (pathLineCenters.size() < 2) {
+            numTooShortLines++;
             continue;
         }
-        tangent = glm::normalize(tangent);
 
-        TubeNode node;
-        node.center = pathLineCenters.at(i);
-        node.tangent = tangent;
-        insertOrientedCirclePoints(vertices, normals, node.center, node.tangent, lastNormal);
-        node.circleIndices.reserve(circlePoints2D.size());
-        for (int j = 0; j < circlePoints2D.size(); j++) {
-            node.circleIndices.push_back(j + numVertexPts*circlePoints2D.size());
-            for (int k = 0; k < numImportanceCriteria; k++) {
-                importanceCriteriaVertex.at(k).push_back(importanceCriteriaLine.at(k).at(i));
-            }
+        // Turbulence dataset: Remove fixed point whirls
+        if (skipClosedLines && glm::length(pathLineCenters.front() - pathLineCenters.back()) < 0.01f) {
+            continue;
         }
-        tubeNodes.push_back(node);
-        numVertexPts++;
-    }
 
+        size_t numTubeNodes = countTubeNodes(pathLineCenters);
+        if (isLineMesh && numTubeNodes > 0) {
+            ranges.vertexCounts.at(i) = numTubeNodes;
+            ranges.indexCounts.at(i) = (numTubeNodes - 1) * 2;
+        } else if (!isLineMesh && numTubeNodes > 1) {
+            // Only one vertex left -> Output nothing (tube consisting only of one point)
+            ranges.vertexCounts.at(i) = numTubeNodes * numCirclePoints;
+            ranges.indexCounts.at(i) = (numTubeNodes - 1) * numCirclePoints * 6;
+        }
+    }
+    ranges.numTooShortLines = numTooShortLines;
 
-    // Create tube triangles/indices for the vertex data
-    /*for (int i = 0; i < numVertexPts-1; i++) {
-        std::vector<uint32_t> &circleIndicesCurrent = tubeNodes.at(i).circleIndices;
-        std::vector<uint32_t> &circleIndicesNext = tubeNodes.at(i+1).circleIndices;
-        for (int j = 0; j < circlePoints2D.size(); j++) {
-            // Build two CCW triangles (one quad) for each side
-            // Triangle 1
-            indices.push_back(circleIndicesCurrent.at(j));
-            indices.push_back(circleIndicesCurrent.at((j+1)%circlePoints2D.size()));
-            indices.push_back(circleIndicesNext.at((j+1)%circlePoints2D.size()));
+    ranges.numVertices = parallelExclusivePrefixSum(ranges.vertexCounts, ranges.vertexOffsets);
+    ranges.numIndices = parallelExclusivePrefixSum(ranges.indexCounts, ranges.indexOffsets);
+}
 
-            // Triangle 2
-            indices.push_back(circleIndicesCurrent.at(j));
-            indices.push_back(circleIndicesNext.at((j+1)%circlePoints2D.size()));
-            indices.push_back(circleIndicesNext.at(j));
-        }
-    }*/
-    // Create tube triangles/indices for the vertex data
-    for (int i = 0; i < numVertexPts-1; i++) {
-        for (int j = 0; j < circlePoints2D.size(); j++) {
-            // Build two CCW triangles (one quad) for each side
-            // Triangle 1
-            indices.push_back(j + i*circlePoints2D.size());
-            indices.push_back((j+1)%circlePoints2D.size() + i*circlePoints2D.size());
-            indices.push_back((j+1)%circlePoints2D.size() + (i+1)*circlePoints2D.size());
+/**
+ * Creates the tubes of multiple lines in parallel. The ranges of the lines are computed first (see
+ * computeLineMeshRanges), and each line then writes its data directly to its range of the preallocated output arrays.
+ * Thus, the output is identical for all thread counts.
+ * @param getLinePositions: Returns the points of line i (ArrayView<const glm::vec3>).
+ * @param getLineAttribute: Returns attribute k of the points of line i (ArrayView<const T>).
+ * @param skipClosedLines: Whether to skip closed lines (fixed point whirls of the turbulence dataset).
+ * @param attributesVertex: The (output) per-vertex attributes (numAttributes arrays, or none if no tube was created).
+ * @param ranges: The (output) ranges of the lines in the output arrays.
+ */
+template<typename T, typename LinePositionsFunction, typename LineAttributeFunction>
+static void createTubesParallel(size_t numLines, const LinePositionsFunction &getLinePositions,
+        const LineAttributeFunction &getLineAttribute, size_t numAttributes, bool skipClosedLines,
+        std::vector<glm::vec3> &vertices, std::vector<glm::vec3> &normals,
+        std::vector<std::vector<T>> &attributesVertex, std::vector<uint32_t> &indices, LineMeshRanges &ranges)
+{
+    computeLineMeshRanges(numLines, getLinePositions, false, circlePoints2D.size(), skipClosedLines, ranges);
+    if (ranges.numTooShortLines > 0) {
+        sgl::Logfile::get()->writeError(std::string() + "Error in createTube: n < 2 ("
+                + sgl::toString(ranges.numTooShortLines) + " lines skipped)");
+    }
+    const size_t numVertices = ranges.numVertices;
+    if (numVertices == 0) {
+        numAttributes = 0;
+    }
 
-            // Triangle 2
-            indices.push_back(j + i*circlePoints2D.size());
-            indices.push_back((j+1)%circlePoints2D.size() + (i+1)*circlePoints2D.size());
-            indices.push_back(j + (i+1)*circlePoints2D.size());
+    vertices.resize(numVertices);
+    normals.resize(numVertices);
+    attributesVertex.resize(numAttributes);
+    for (size_t k = 0; k < numAttributes; k++) {
+        attributesVertex.at(k).resize(numVertices);
+    }
+    indices.resize(ranges.numIndices);
+
+    // Fill pass: Each line writes directly to its range in the preallocated arrays
+    #pragma omp parallel
+    {
+        std::vector<ArrayView<const T>> lineAttributes(numAttributes);
+        #pragma omp for schedule(dynamic, 64)
+        for (size_t i = 0; i < numLines; i++) {
+            if (ranges.vertexCounts.at(i) == 0) {
+                continue;
+            }
+            for (size_t k = 0; k < numAttributes; k++) {
+                lineAttributes.at(k) = getLineAttribute(i, k);
+            }
+            size_t vertexOffset = ranges.vertexOffsets.at(i);
+            writeTubeRenderData(getLinePositions(i), lineAttributes, vertexOffset, &vertices.at(vertexOffset),
+                    &normals.at(vertexOffset), attributesVertex, &indices.at(ranges.indexOffsets.at(i)));
         }
     }
+}
 
-    // Only one vertex left -> Output nothing (tube consisting only of one point)
-    if (numVertexPts <= 1) {
-        vertices.clear();
-        normals.clear();
-        importanceCriteriaVertex.clear();
+template<typename T>
+void createTubeRenderData(const std::vector<ArrayView<const glm::vec3>> &linesCenters,
+                          const std::vector<ArrayView<const T>> &linesAttributes,
+                          std::vector<glm::vec3> &vertices,
+                          std::vector<glm::vec3> &normals,
+                          std::vector<T> &vertexAttributes,
+                          std::vector<uint32_t> &indices)
+{
+    std::vector<std::vector<T>> attributesVertex;
+    LineMeshRanges ranges;
+    createTubesParallel<T>(linesCenters.size(), [&linesCenters](size_t i) {
+        return linesCenters.at(i);
+    }, [&linesAttributes](size_t i, size_t) {
+        return linesAttributes.at(i);
+    }, linesAttributes.empty() ? 0 : 1, true, vertices, normals, attributesVertex, indices, ranges);
+
+    if (!attributesVertex.empty()) {
+        vertexAttributes = std::move(attributesVertex.front());
+    } else {
+        vertexAttributes.clear();
     }
 }
 
 template
-void createTubeRenderData<uint32_t>(const std::vector<glm::vec3> &pathLineCenters,
-                                    const std::vector<uint32_t> &pathLineAttributes,
+void createTubeRenderData<uint32_t>(const std::vector<ArrayView<const glm::vec3>> &linesCenters,
+                                    const std::vector<ArrayView<const uint32_t>> &linesAttributes,
                                     std::vector<glm::vec3> &vertices,
                                     std::vector<glm::vec3> &normals,
                                     std::vector<uint32_t> &vertexAttributes,
@@ -363,26 +370,73 @@ void createTubeRenderData<uint32_t>(const std::vector<glm::vec3> &pathLineCenter
 
 
 
-void convertTrajectoryDataToBinaryTriangleMesh(
+/**
+ * Applies reorderMeshClusters to the global arrays of a converter and reports the simulated cache statistics before
+ * and after reordering (if requested).
+ */
+static void reorderConvertedMesh(
+        size_t primitiveSize,
+        const std::vector<size_t> &clusterOffsets,
+        const SpatialReorderSettings &reorderSettings,
+        SpatialReorderStatistics *reorderStatistics,
+        std::vector<uint32_t> &globalIndices,
+        std::vector<glm::vec3> &globalVertexPositions,
+        const std::vector<std::vector<glm::vec3>*> &globalVec3Attributes,
+        std::vector<std::vector<float>> &globalImportanceCriteria)
+{
+    if (reorderStatistics) {
+        reorderStatistics->before = simulateMeshCaches(globalIndices.data(), globalIndices.size(), primitiveSize,
+                globalVertexPositions.data(), globalVertexPositions.size());
+    }
+
+    std::vector<uint32_t> vertexOrder;
+    reorderMeshClusters(globalIndices, primitiveSize, clusterOffsets, globalVertexPositions.data(),
+            globalVertexPositions.size(), reorderSettings, vertexOrder);
+    reorderVertexData(globalVertexPositions, vertexOrder);
+    for (std::vector<glm::vec3> *attribute : globalVec3Attributes) {
+        reorderVertexData(*attribute, vertexOrder);
+    }
+    for (std::vector<float> &importanceCriterion : globalImportanceCriteria) {
+        reorderVertexData(importanceCriterion, vertexOrder);
+    }
+
+    if (reorderStatistics) {
+        reorderStatistics->after = simulateMeshCaches(globalIndices.data(), globalIndices.size(), primitiveSize,
+                globalVertexPositions.data(), globalVertexPositions.size());
+        const MeshCacheStatistics &before = reorderStatistics->before, &after = reorderStatistics->after;
+        Logfile::get()->writeInfo(std::string() + "Spatial reordering: ACMR "
+                + sgl::toString(before.averageCacheMissRatio) + " -> " + sgl::toString(after.averageCacheMissRatio)
+                + ", vertex fetch miss ratio "
+                + sgl::toString(before.vertexFetchMissRatio) + " -> " + sgl::toString(after.vertexFetchMissRatio)
+                + ", spatial miss ratio " + sgl::toString(before.spatialMissRatio) + " -> "
+                + sgl::toString(after.spatialMissRatio));
+    }
+}
+
+/// @return The names of the converted importance criteria ("vertexAttribute<N>", N = criterion index).
+static std::vector<std::string> getImportanceCriterionAttributeNames(
+        const std::vector<int> &importanceCriteria, size_t numAttributes)
+{
+    std::vector<std::string> attributeNames;
+    for (size_t i = 0; i < numAttributes; i++) {
+        int criterionIndex = importanceCriteria.empty() ? int(i) : importanceCriteria.at(i);
+        attributeNames.push_back("vertexAttribute" + sgl::toString(criterionIndex));
+    }
+    return attributeNames;
+}
+
+bool convertTrajectoryDataToBinaryTriangleMesh(
         TrajectoryType trajectoryType,
         const std::string &trajectoriesFilename,
         const std::string &binaryFilename,
-        float lineRadius)
+        float lineRadius,
+        const SpatialReorderSettings &reorderSettings,
+        SpatialReorderStatistics *reorderStatistics,
+        const std::vector<int> &importanceCriteria)
 {
     auto start = std::chrono::system_clock::now();
 
-    if (trajectoryType == TRAJECTORY_TYPE_RINGS) {
-        initializeCircleData(3, lineRadius);
-    } else if (trajectoryType == TRAJECTORY_TYPE_ANEURYSM) {
-        initializeCircleData(3, lineRadius);
-    } else {
-        initializeCircleData(3, lineRadius);
-    }
-
-    BinaryMesh binaryMesh;
-    binaryMesh.submeshes.push_back(BinarySubMesh());
-    BinarySubMesh &submesh = binaryMesh.submeshes.front();
-    submesh.vertexMode = VERTEX_MODE_TRIANGLES;
+    initializeCircleData(NUM_CIRCLE_SEGMENTS, lineRadius);
 
     std::vector<glm::vec3> globalVertexPositions;
     std::vector<glm::vec3> globalNormals;
@@ -393,103 +447,101 @@ void convertTrajectoryDataToBinaryTriangleMesh(
     uint32_t numLineSegments = 0;
 
 
-    Trajectories trajectories = loadTrajectoriesFromFile(trajectoriesFilename, trajectoryType);
-
-    for (size_t i = 0; i < trajectories.size(); i++) {
-        Trajectory &trajectory = trajectories.at(i);
+    TrajectorySet trajectories = importanceCriteria.empty()
+            ? loadTrajectorySetFromFile(trajectoriesFilename, trajectoryType)
+            : loadTrajectorySetFromFile(trajectoriesFilename, trajectoryType, importanceCriteria);
+    std::vector<std::string> attributeNames = getImportanceCriterionAttributeNames(
+            importanceCriteria, trajectories.getNumAttributes());
+    const size_t numTrajectories = trajectories.getNumTrajectories();
 
+    for (size_t i = 0; i < numTrajectories; i++) {
         numLines++;
-        numLineSegments += trajectory.positions.size() - 1;
-
-        // Create tube render data
-        std::vector<glm::vec3> localVertices;
-        std::vector<std::vector<float>> importanceCriteriaVertex;
-        std::vector<glm::vec3> localNormals;
-        std::vector<uint32_t> localIndices;
-        createTubeRenderData(trajectory.positions, trajectory.attributes, localVertices, localNormals,
-                             importanceCriteriaVertex, localIndices);
+        numLineSegments += trajectories.getNumPoints(i) - 1;
+    }
 
-        // Local -> global
-        if (localVertices.size() > 0) {
-            for (size_t i = 0; i < localIndices.size(); i++) {
-                globalIndices.push_back(localIndices.at(i) + globalVertexPositions.size());
-            }
-            globalVertexPositions.insert(globalVertexPositions.end(), localVertices.begin(), localVertices.end());
-            globalNormals.insert(globalNormals.end(), localNormals.begin(), localNormals.end());
-            if (globalImportanceCriteria.empty()) {
-                globalImportanceCriteria.insert(globalImportanceCriteria.end(), importanceCriteriaVertex.begin(),
-                                                importanceCriteriaVertex.end());
-            } else {
-                for (size_t i = 0; i < globalImportanceCriteria.size(); i++) {
-                    globalImportanceCriteria.at(i).insert(globalImportanceCriteria.at(i).end(),
-                                                          importanceCriteriaVertex.at(i).begin(), importanceCriteriaVertex.at(i).end());
-                }
+    // Tubes of all lines (closed lines are kept, unlike in createTubeRenderData)
+    LineMeshRanges ranges;
+    createTubesParallel<float>(numTrajectories, [&trajectories](size_t i) -> ArrayView<const glm::vec3> {
+        return trajectories.getPositions(i);
+    }, [&trajectories](size_t i, size_t k) -> ArrayView<const float> {
+        return trajectories.getAttribute(i, k);
+    }, trajectories.getNumAttributes(), false, globalVertexPositions, globalNormals, globalImportanceCriteria,
+            globalIndices, ranges);
+    const size_t numImportanceCriteria = globalImportanceCriteria.size();
+
+    if (reorderSettings.isEnabled()) {
+        // Each tube is split into clusters of at most maxClusterTriangles triangles (but at least one ring segment).
+        // The clusters consist of whole ring segments, as the ring order is already optimal for the vertex cache.
+        std::vector<size_t> clusterOffsets;
+        const size_t numSegmentTriangles = circlePoints2D.size() * 2;
+        const size_t maxClusterIndices = std::max(
+                reorderSettings.maxClusterTriangles / numSegmentTriangles, size_t(1)) * numSegmentTriangles * 3;
+        for (size_t i = 0; i < numTrajectories; i++) {
+            for (size_t offset = 0; offset < ranges.indexCounts.at(i); offset += maxClusterIndices) {
+                clusterOffsets.push_back(ranges.indexOffsets.at(i) + offset);
             }
         }
+        reorderConvertedMesh(3, clusterOffsets, reorderSettings, reorderStatistics, globalIndices,
+                globalVertexPositions, { &globalNormals }, globalImportanceCriteria);
     }
 
-
-    submesh.material.diffuseColor = glm::vec3(165, 220, 84) / 255.0f;
-    submesh.material.opacity = 120 / 255.0f;
-    submesh.indices = globalIndices;
+    ObjMaterial material;
+    material.diffuseColor = glm::vec3(165, 220, 84) / 255.0f;
+    material.opacity = 120 / 255.0f;
 
     const size_t numIndices = globalIndices.size();
     const size_t numVertices = globalVertexPositions.size();
     const size_t numNormals = globalNormals.size();
+
+    std::vector<std::vector<uint16_t>> globalImportanceCriteriaUnorm;
+    packUnorm16ArrayOfArrays(globalImportanceCriteria, globalImportanceCriteriaUnorm);
     // free memory
-    globalIndices.clear(); globalIndices.shrink_to_fit();
+    globalImportanceCriteria.clear(); globalImportanceCriteria.shrink_to_fit();
 
-    BinaryMeshAttribute positionAttribute;
-    positionAttribute.name = "vertexPosition";
-    positionAttribute.attributeFormat = ATTRIB_FLOAT;
-    positionAttribute.numComponents = 3;
-    positionAttribute.data.resize(numVertices * sizeof(glm::vec3));
-    memcpy(&positionAttribute.data.front(), &globalVertexPositions.front(), numVertices * sizeof(glm::vec3));
-    submesh.attributes.push_back(positionAttribute);
+    auto end = std::chrono::system_clock::now();
 
+    Logfile::get()->writeInfo(std::string() + "Summary: "
+                              + sgl::toString(numVertices) + " vertices, "
+                              + sgl::toString(numIndices / 3) + " faces, "
+                              + sgl::toString(numIndices) + " indices.");
+    Logfile::get()->writeInfo(std::string() + "Writing binary mesh...");
+
+    // Stream the data directly from the global arrays to the file (no intermediate BinaryMesh copy).
+    BinaryMeshStreamWriter meshWriter;
+    if (!meshWriter.open(binaryFilename)) {
+        return false;
+    }
+    meshWriter.setFlags(reorderSettings.getBinaryMeshFlags(true));
+    meshWriter.beginSubmesh(material, VERTEX_MODE_TRIANGLES);
+    meshWriter.writeIndices(globalIndices.data(), numIndices);
     // free memory
-    globalVertexPositions.clear(); globalVertexPositions.shrink_to_fit();
+    globalIndices.clear(); globalIndices.shrink_to_fit();
 
-    BinaryMeshAttribute lineNormalsAttribute;
-    lineNormalsAttribute.name = "vertexNormal";
-    lineNormalsAttribute.attributeFormat = ATTRIB_FLOAT;
-    lineNormalsAttribute.numComponents = 3;
-    lineNormalsAttribute.data.resize(numNormals * sizeof(glm::vec3));
-    memcpy(&lineNormalsAttribute.data.front(), &globalNormals.front(), numNormals * sizeof(glm::vec3));
-    submesh.attributes.push_back(lineNormalsAttribute);
+    meshWriter.writeAttribute("vertexPosition", ATTRIB_FLOAT, 3,
+            globalVertexPositions.data(), numVertices * sizeof(glm::vec3));
+    // free memory
+    globalVertexPositions.clear(); globalVertexPositions.shrink_to_fit();
 
+    meshWriter.writeAttribute("vertexNormal", ATTRIB_FLOAT, 3, globalNormals.data(), numNormals * sizeof(glm::vec3));
     // free memory
     globalNormals.clear(); globalNormals.shrink_to_fit();
 
-    std::vector<std::vector<uint16_t>> globalImportanceCriteriaUnorm;
-    packUnorm16ArrayOfArrays(globalImportanceCriteria, globalImportanceCriteriaUnorm);
-
     for (size_t i = 0; i < globalImportanceCriteriaUnorm.size(); i++) {
         std::vector<uint16_t> &currentAttr = globalImportanceCriteriaUnorm.at(i);
-        BinaryMeshAttribute vertexAttribute;
-        vertexAttribute.name = "vertexAttribute" + sgl::toString(i);
-        vertexAttribute.attributeFormat = ATTRIB_UNSIGNED_SHORT;
-        vertexAttribute.numComponents = 1;
-        vertexAttribute.data.resize(currentAttr.size() * sizeof(uint16_t));
-        memcpy(&vertexAttribute.data.front(), &currentAttr.front(), currentAttr.size() * sizeof(uint16_t));
-        submesh.attributes.push_back(vertexAttribute);
+        meshWriter.writeAttribute(attributeNames.at(i), ATTRIB_UNSIGNED_SHORT, 1,
+                currentAttr.data(), currentAttr.size() * sizeof(uint16_t));
     }
-
     // free memory
     globalImportanceCriteriaUnorm.clear(); globalImportanceCriteriaUnorm.shrink_to_fit();
 
-    auto end = std::chrono::system_clock::now();
-
-    Logfile::get()->writeInfo(std::string() + "Summary: "
-                              + sgl::toString(numVertices) + " vertices, "
-                              + sgl::toString(numIndices / 3) + " faces, "
-                              + sgl::toString(numIndices) + " indices.");
-    Logfile::get()->writeInfo(std::string() + "Writing binary mesh...");
-    writeMesh3D(binaryFilename, binaryMesh);
+    if (!meshWriter.finish()) {
+        return false;
+    }
 
-    // compute size of renderable geometry;
-    float byteSize = positionAttribute.data.size() * sizeof(uint8_t) + lineNormalsAttribute.data.size() * sizeof(uint8_t)
-                     + submesh.attributes[0].data.size() * sizeof(uint8_t) + submesh.indices.size() * sizeof(uint32_t);
+    // compute size of renderable geometry (positions, normals, one attribute, indices)
+    float byteSize = numVertices * sizeof(glm::vec3) + numNormals * sizeof(glm::vec3)
+                     + (numImportanceCriteria > 0 ? numVertices * sizeof(uint16_t) : 0)
+                     + numIndices * sizeof(uint32_t);
 
     float MBSize = byteSize / 1024. / 1024.;
 
@@ -501,7 +553,7 @@ void convertTrajectoryDataToBinaryTriangleMesh(
             std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
     Logfile::get()->writeInfo(std::string() + "Computational time to create binmesh: "
                               + std::to_string(elapsed.count()));
-
+    return true;
 }
 
 
@@ -524,8 +576,8 @@ void computeLineNormal(const glm::vec3 &tangent, glm::vec3 &normal, const glm::v
  * @param vertices: The (output) vertex points, which are a set of oriented circles around the centers (see above).
  * @param indices: The (output) indices specifying how tube triangles are built from the circle vertices.
  */
-void createTangentAndNormalData(std::vector<glm::vec3> &pathLineCenters,
-                                std::vector<std::vector<float>> &importanceCriteriaIn,
+void createTangentAndNormalData(ArrayView<const glm::vec3> pathLineCenters,
+                                const std::vector<ArrayView<const float>> &importanceCriteriaIn,
                                 std::vector<glm::vec3> &vertices,
                                 std::vector<std::vector<float>> &importanceCriteriaOut,
                                 std::vector<glm::vec3> &tangents,
@@ -551,7 +603,7 @@ void createTangentAndNormalData(std::vector<glm::vec3> &pathLineCenters,
     // First, create a list of tube nodes
     glm::vec3 lastNormal = glm::vec3(1.0f, 0.0f, 0.0f);
     for (int i = 0; i < n; i++) {
-        glm::vec3 center = pathLineCenters.at(i);
+        glm::vec3 center = pathLineCenters[i];
 
         // Remove invalid line points (used in many scientific datasets to indicate invalid lines).
         const float MAX_VAL = 1e10;
@@ -562,14 +614,14 @@ void createTangentAndNormalData(std::vector<glm::vec3> &pathLineCenters,
         glm::vec3 tangent;
         if (i == 0) {
             // First node
-            tangent = pathLineCenters.at(i+1) - pathLineCenters.at(i);
+            tangent = pathLineCenters[i+1] - pathLineCenters[i];
         } else if (i == n-1) {
             // Last node
-            tangent = pathLineCenters.at(i) - pathLineCenters.at(i-1);
+            tangent = pathLineCenters[i] - pathLineCenters[i-1];
         } else {
             // Node with two neighbors - use both normals
-            tangent = pathLineCenters.at(i+1) - pathLineCenters.at(i);
-            //normal += pathLineCenters.at(i) - pathLineCenters.at(i-1);
+            tangent = pathLineCenters[i+1] - pathLineCenters[i];
+            //normal += pathLineCenters[i] - pathLineCenters[i-1];
         }
         if (glm::length(tangent) < 0.0001f) {
             // In case the two vertices are almost identical, just skip this path line segment
@@ -581,9 +633,9 @@ void createTangentAndNormalData(std::vector<glm::vec3> &pathLineCenters,
         computeLineNormal(tangent, normal, lastNormal);
         lastNormal = normal;
 
-        vertices.push_back(pathLineCenters.at(i));
+        vertices.push_back(pathLineCenters[i]);
         for (int j = 0; j < numImportanceCriteria; j++) {
-            importanceCriteriaOut.at(j).push_back(importanceCriteriaIn.at(j).at(i));
+            importanceCriteriaOut.at(j).push_back(importanceCriteriaIn.at(j)[i]);
         }
         tangents.push_back(tangent);
         normals.push_back(normal);
@@ -599,367 +651,35 @@ void createTangentAndNormalData(std::vector<glm::vec3> &pathLineCenters,
 
 
 
-struct InputLinePoint {
-    glm::vec3 linePoint;
-    float lineAttribute;
-};
-struct OutputLinePoint {
-    glm::vec3 linePoint;
-    float lineAttribute;
-    glm::vec3 lineTangent;
-    uint32_t valid; // 0 or 1
-    glm::vec3 lineNormal;
-    float padding2;
-};
-struct PathLinePoint {
-    glm::vec3 linePointPosition;
-    float linePointAttribute;
-    glm::vec3 lineTangent;
-    float padding1;
-    glm::vec3 lineNormal;
-    float padding2;
-};
-
-struct TubeVertex {
-    glm::vec3 vertexPosition;
-    float vertexAttribute;
-    glm::vec3 vertexNormal;
-    float padding;
-};
-
-void convertTrajectoryDataToBinaryTriangleMeshGPU(
+bool convertTrajectoryDataToBinaryLineMesh(
         TrajectoryType trajectoryType,
         const std::string &trajectoriesFilename,
         const std::string &binaryFilename,
-        float lineRadius)
-{
-    auto start = std::chrono::system_clock::now();
-    sgl::ShaderManager->invalidateShaderCache();
-
-    unsigned int NUM_CIRCLE_SEGMENTS = 3;
-    if (trajectoryType == TRAJECTORY_TYPE_RINGS) {
-        sgl::ShaderManager->addPreprocessorDefine("NUM_CIRCLE_SEGMENTS", NUM_CIRCLE_SEGMENTS);
-        sgl::ShaderManager->addPreprocessorDefine("CIRCLE_RADIUS", lineRadius);
-    } else if (trajectoryType == TRAJECTORY_TYPE_ANEURYSM) {
-        sgl::ShaderManager->addPreprocessorDefine("NUM_CIRCLE_SEGMENTS", NUM_CIRCLE_SEGMENTS);
-        sgl::ShaderManager->addPreprocessorDefine("CIRCLE_RADIUS", lineRadius);
-    } else {
-        sgl::ShaderManager->addPreprocessorDefine("NUM_CIRCLE_SEGMENTS", NUM_CIRCLE_SEGMENTS);
-        sgl::ShaderManager->addPreprocessorDefine("CIRCLE_RADIUS", lineRadius);
-    }
-
-    BinaryMesh binaryMesh;
-    binaryMesh.submeshes.push_back(BinarySubMesh());
-    BinarySubMesh &submesh = binaryMesh.submeshes.front();
-    submesh.vertexMode = VERTEX_MODE_TRIANGLES;
-
-    std::vector<uint32_t> lineOffsetsInput;
-    uint64_t numLinesInput = 0;
-    uint64_t numLinePointsInput = 0;
-
-    std::vector<uint32_t> lineOffsetsOutput;
-    uint64_t numLinesOutput = 0;
-    uint64_t numLinePointsOutput = 0;
-
-    std::vector<InputLinePoint> inputLinePoints;
-    std::vector<OutputLinePoint> outputLinePoints;
-    std::vector<PathLinePoint> pathLinePoints;
-
-    auto startLoad = std::chrono::system_clock::now();
-
-    Trajectories trajectories = loadTrajectoriesFromFile(trajectoriesFilename, trajectoryType);
-
-    lineOffsetsInput.push_back(0);
-    for (size_t i = 0; i < trajectories.size(); i++) {
-        Trajectory &trajectory = trajectories.at(i);
-
-        InputLinePoint inputLinePoint;
-        for (int j = 0; j < trajectory.positions.size(); j++) {
-            inputLinePoint.linePoint = trajectory.positions.at(j);
-            inputLinePoint.lineAttribute = trajectory.attributes.at(0).at(j);
-            inputLinePoints.push_back(inputLinePoint);
-        }
-
-        if (trajectory.positions.size() > 0) {
-            numLinePointsInput += trajectory.positions.size();
-            numLinesInput++;
-        } else {
-            continue;
-        }
-        lineOffsetsInput.push_back(numLinePointsInput);
-    }
-
-    auto endLoad = std::chrono::system_clock::now();
-    auto elapsedLoad = std::chrono::duration_cast<std::chrono::milliseconds>(endLoad - startLoad);
-    Logfile::get()->writeInfo(std::string() + "Computational time to load: " + std::to_string(elapsedLoad.count()));
-
-    const unsigned int WORK_GROUP_SIZE_1D = 256;
-    sgl::ShaderManager->addPreprocessorDefine("WORK_GROUP_SIZE_1D", WORK_GROUP_SIZE_1D);
-    unsigned int numWorkGroupsOld;
-    uint32_t numWorkGroups;
-    void *bufferMemory;
-
-    // PART 1: Create line normals & mask invalid line points
-    auto startNormals = std::chrono::system_clock::now();
-    sgl::GeometryBufferPtr lineOffsetBufferInput = sgl::Renderer->createGeometryBuffer(
-            (numLinesInput+1) * sizeof(uint32_t), &lineOffsetsInput.front(),
-            SHADER_STORAGE_BUFFER, BUFFER_STATIC);
-    sgl::GeometryBufferPtr inputLinePointBuffer = sgl::Renderer->createGeometryBuffer(
-            inputLinePoints.size() * sizeof(InputLinePoint), &inputLinePoints.front(),
-            SHADER_STORAGE_BUFFER, BUFFER_STATIC);
-    sgl::GeometryBufferPtr outputLinePointBuffer = sgl::Renderer->createGeometryBuffer(
-            inputLinePoints.size() * sizeof(OutputLinePoint),
-            SHADER_STORAGE_BUFFER, BUFFER_STATIC);
-
-    sgl::ShaderProgramPtr createLineNormalsShader = sgl::ShaderManager->getShaderProgram({"CreateLineNormals.Compute"});
-    sgl::ShaderManager->bindShaderStorageBuffer(2, lineOffsetBufferInput);
-    sgl::ShaderManager->bindShaderStorageBuffer(3, inputLinePointBuffer);
-    sgl::ShaderManager->bindShaderStorageBuffer(4, outputLinePointBuffer);
-    createLineNormalsShader->setUniform("numLines", static_cast<uint32_t>(numLinesInput));
-    numWorkGroupsOld = iceil(numLinesInput, WORK_GROUP_SIZE_1D); // last vector: local work group size
-    numWorkGroups = (numLinesInput - 1) / WORK_GROUP_SIZE_1D + 1;
-
-    createLineNormalsShader->dispatchCompute(numWorkGroups);
-    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
-
-    bufferMemory = outputLinePointBuffer->mapBuffer(BUFFER_MAP_READ_ONLY);
-    outputLinePoints.resize(inputLinePoints.size());
-    memcpy(&outputLinePoints.front(), bufferMemory, outputLinePoints.size() * sizeof(OutputLinePoint));
-    outputLinePointBuffer->unmapBuffer();
-    auto endNormals = std::chrono::system_clock::now();
-    auto elapsedNormals = std::chrono::duration_cast<std::chrono::milliseconds>(endNormals - startNormals);
-    Logfile::get()->writeInfo(std::string() + "Computational time to create normals: "
-            + std::to_string(elapsedNormals.count()));
-
-
-    // PART 1.2: OutputLinePoint -> PathLinePoint (while removing invalid points)
-    auto startCompact = std::chrono::system_clock::now();
-    pathLinePoints.reserve(outputLinePoints.size());
-    lineOffsetsOutput.push_back(0);
-    for (size_t lineID = 0; lineID < numLinesInput; lineID++) {
-        size_t linePointsOffset = lineOffsetsInput.at(lineID);
-        size_t numLinePoints = lineOffsetsInput.at(lineID+1)-linePointsOffset;
-
-        size_t currentLineNumPointsOutput = 0;
-
-        for (size_t linePointID = 0; linePointID < numLinePoints; linePointID++) {
-            OutputLinePoint &outputLinePoint = outputLinePoints.at(linePointsOffset+linePointID);
-            if (outputLinePoint.valid == 1) {
-                PathLinePoint pathLinePoint;
-                pathLinePoint.linePointPosition = outputLinePoint.linePoint;
-                pathLinePoint.linePointAttribute = outputLinePoint.lineAttribute;
-                pathLinePoint.lineTangent = outputLinePoint.lineTangent;
-                pathLinePoint.lineNormal = outputLinePoint.lineNormal;
-                pathLinePoints.push_back(pathLinePoint);
-                currentLineNumPointsOutput++;
-                numLinePointsOutput++;
-            }
-        }
-
-        if (currentLineNumPointsOutput > 0) {
-            numLinesOutput++;
-            lineOffsetsOutput.push_back(numLinePointsOutput);
-        }
-    }
-    auto endCompact = std::chrono::system_clock::now();
-    auto elapsedCompact = std::chrono::duration_cast<std::chrono::milliseconds>(endCompact - startCompact);
-    Logfile::get()->writeInfo(std::string() + "Computational time to compact: "
-            + std::to_string(elapsedCompact.count()));
-
-
-    // PART 2: CreateTubePoints.Compute
-    auto startTube = std::chrono::system_clock::now();
-    std::vector<TubeVertex> tubeVertices;
-    tubeVertices.resize(NUM_CIRCLE_SEGMENTS * pathLinePoints.size());
-
-    sgl::GeometryBufferPtr pathLinePointsBuffer = sgl::Renderer->createGeometryBuffer(
-            pathLinePoints.size() * sizeof(PathLinePoint), &pathLinePoints.front(),
-            SHADER_STORAGE_BUFFER, BUFFER_STATIC);
-    sgl::GeometryBufferPtr tubeVertexBuffer = sgl::Renderer->createGeometryBuffer(
-            NUM_CIRCLE_SEGMENTS * pathLinePoints.size() * sizeof(TubeVertex),
-            SHADER_STORAGE_BUFFER, BUFFER_STATIC);
-
-    int maxNumWorkGroupsSupported = 0;
-    glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, 0, &maxNumWorkGroupsSupported);
-
-    sgl::ShaderProgramPtr createTubePointsShader = sgl::ShaderManager->getShaderProgram({"CreateTubePoints.Compute"});
-    sgl::ShaderManager->bindShaderStorageBuffer(2, pathLinePointsBuffer);
-    sgl::ShaderManager->bindShaderStorageBuffer(3, tubeVertexBuffer);
-    createTubePointsShader->setUniform("numLinePoints", static_cast<uint32_t>(numLinePointsOutput));
-    numWorkGroups = iceil(pathLinePoints.size(), WORK_GROUP_SIZE_1D);
-    if (numWorkGroups > maxNumWorkGroupsSupported) {
-        sgl::Logfile::get()->writeInfo("Info: numWorkGroups > MAX_COMPUTE_WORK_GROUP_COUNT. Switching to CPU fallback.");
-        convertTrajectoryDataToBinaryTriangleMesh(trajectoryType, trajectoriesFilename, binaryFilename, lineRadius);
-        return;
-    }
-    createTubePointsShader->dispatchCompute(numWorkGroups);
-    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
-
-    bufferMemory = tubeVertexBuffer->mapBuffer(BUFFER_MAP_READ_ONLY);
-    memcpy(&tubeVertices.front(), bufferMemory, NUM_CIRCLE_SEGMENTS * pathLinePoints.size() * sizeof(TubeVertex));
-    tubeVertexBuffer->unmapBuffer();
-
-    std::vector<glm::vec3> globalVertexPositions;
-    std::vector<glm::vec3> globalNormals;
-    std::vector<std::vector<float>> globalImportanceCriteria;
-    globalVertexPositions.reserve(tubeVertices.size());
-    globalNormals.reserve(tubeVertices.size());
-    globalImportanceCriteria.resize(1);
-    globalImportanceCriteria.at(0).reserve(tubeVertices.size());
-    for (TubeVertex &tubeVertex : tubeVertices) {
-        globalVertexPositions.push_back(tubeVertex.vertexPosition);
-        globalNormals.push_back(tubeVertex.vertexNormal);
-        globalImportanceCriteria.at(0).push_back(tubeVertex.vertexAttribute);
-    }
-    auto endTube = std::chrono::system_clock::now();
-    auto elapsedTube = std::chrono::duration_cast<std::chrono::milliseconds>(endTube - startTube);
-    Logfile::get()->writeInfo(std::string() + "Computational time to create tube vertices: "
-                              + std::to_string(elapsedTube.count()));
-
-
-
-
-    // PART 3: CreateTubeIndices.Compute
-    auto startIndices = std::chrono::system_clock::now();
-    std::vector<uint32_t> tubeIndices;
-    size_t numLineSegments = numLinePointsOutput - numLinesOutput;
-    size_t numIndices = numLineSegments*NUM_CIRCLE_SEGMENTS*6;
-    tubeIndices.resize(numIndices);
-
-    sgl::GeometryBufferPtr lineOffsetBufferOutput = sgl::Renderer->createGeometryBuffer(
-            (numLinesOutput+1) * sizeof(uint32_t), &lineOffsetsOutput.front(),
-            SHADER_STORAGE_BUFFER, BUFFER_STATIC);
-    sgl::GeometryBufferPtr tubeIndexBuffer = sgl::Renderer->createGeometryBuffer(
-            numIndices * sizeof(uint32_t),
-            SHADER_STORAGE_BUFFER, BUFFER_STATIC);
-
-    sgl::ShaderProgramPtr createTubeIndicesShader = sgl::ShaderManager->getShaderProgram({"CreateTubeIndices.Compute"});
-    sgl::ShaderManager->bindShaderStorageBuffer(2, lineOffsetBufferOutput);
-    sgl::ShaderManager->bindShaderStorageBuffer(3, tubeIndexBuffer);
-    createTubeIndicesShader->setUniform("numLines", static_cast<uint32_t>(numLinesOutput));
-    numWorkGroups = iceil(numLinesOutput, WORK_GROUP_SIZE_1D); // last vector: local work group size
-    createTubeIndicesShader->dispatchCompute(numWorkGroups);
-    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
-
-    bufferMemory = tubeIndexBuffer->mapBuffer(BUFFER_MAP_READ_ONLY);
-    memcpy(&tubeIndices.front(), bufferMemory, numIndices * sizeof(uint32_t));
-    tubeIndexBuffer->unmapBuffer();
-    auto endIndices = std::chrono::system_clock::now();
-    auto elapsedIndices = std::chrono::duration_cast<std::chrono::milliseconds>(endIndices - startIndices);
-    Logfile::get()->writeInfo(std::string() + "Computational time to create tube indices: "
-            + std::to_string(elapsedIndices.count()));
-
-    sgl::ShaderManager->removePreprocessorDefine("WORK_GROUP_SIZE_1D");
-    sgl::ShaderManager->removePreprocessorDefine("NUM_CIRCLE_SEGMENTS");
-    sgl::ShaderManager->removePreprocessorDefine("CIRCLE_RADIUS");
-    sgl::ShaderManager->unbindShader();
-
-
-
-    // Normalize data for rings
-    auto startPost = std::chrono::system_clock::now();
-
-    submesh.material.diffuseColor = glm::vec3(165, 220, 84) / 255.0f;
-    submesh.material.opacity = 120 / 255.0f;
-    submesh.indices = tubeIndices;
-
-    const size_t numIndicesTubes = tubeIndices.size();
-    const size_t numVertices = globalVertexPositions.size();
-    const size_t numNormals = globalNormals.size();
-    // free memory
-    tubeIndices.clear(); tubeIndices.shrink_to_fit();
-
-    BinaryMeshAttribute positionAttribute;
-    positionAttribute.name = "vertexPosition";
-    positionAttribute.attributeFormat = ATTRIB_FLOAT;
-    positionAttribute.numComponents = 3;
-    positionAttribute.data.resize(numVertices * sizeof(glm::vec3));
-    memcpy(&positionAttribute.data.front(), &globalVertexPositions.front(), numVertices * sizeof(glm::vec3));
-    submesh.attributes.push_back(positionAttribute);
-
-    // free memory
-    globalVertexPositions.clear(); globalVertexPositions.shrink_to_fit();
-
-    BinaryMeshAttribute lineNormalsAttribute;
-    lineNormalsAttribute.name = "vertexNormal";
-    lineNormalsAttribute.attributeFormat = ATTRIB_FLOAT;
-    lineNormalsAttribute.numComponents = 3;
-    lineNormalsAttribute.data.resize(numNormals * sizeof(glm::vec3));
-    memcpy(&lineNormalsAttribute.data.front(), &globalNormals.front(), numNormals * sizeof(glm::vec3));
-    submesh.attributes.push_back(lineNormalsAttribute);
-
-    // free memory
-    globalNormals.clear(); globalNormals.shrink_to_fit();
-
-    std::vector<std::vector<uint16_t>> globalImportanceCriteriaUnorm;
-    packUnorm16ArrayOfArrays(globalImportanceCriteria, globalImportanceCriteriaUnorm);
-
-    for (size_t i = 0; i < globalImportanceCriteriaUnorm.size(); i++) {
-        std::vector<uint16_t> &currentAttr = globalImportanceCriteriaUnorm.at(i);
-        BinaryMeshAttribute vertexAttribute;
-        vertexAttribute.name = "vertexAttribute" + sgl::toString(i);
-        vertexAttribute.attributeFormat = ATTRIB_UNSIGNED_SHORT;
-        vertexAttribute.numComponents = 1;
-        vertexAttribute.data.resize(currentAttr.size() * sizeof(uint16_t));
-        memcpy(&vertexAttribute.data.front(), &currentAttr.front(), currentAttr.size() * sizeof(uint16_t));
-        submesh.attributes.push_back(vertexAttribute);
-    }
-    auto endPost = std::chrono::system_clock::now();
-    auto elapsedPost = std::chrono::duration_cast<std::chrono::milliseconds>(endPost - startPost);
-    Logfile::get()->writeInfo(std::string() + "Computational time post-process: " + std::to_string(elapsedPost.count()));
-
-    auto end = std::chrono::system_clock::now();
-
-    Logfile::get()->writeInfo(std::string() + "Summary: "
-                              + sgl::toString(numVertices) + " vertices, "
-                              + sgl::toString(numIndicesTubes / 3) + " faces, "
-                              + sgl::toString(numIndicesTubes) + " indices.");
-    Logfile::get()->writeInfo(std::string() + "Writing binary mesh...");
-    writeMesh3D(binaryFilename, binaryMesh);
-
-    // compute size of renderable geometry;
-    float byteSize = positionAttribute.data.size() * sizeof(uint8_t) + lineNormalsAttribute.data.size() * sizeof(uint8_t)
-                     + submesh.attributes[0].data.size() * sizeof(uint8_t) + submesh.indices.size() * sizeof(uint32_t);
-
-    float MBSize = byteSize / 1024. / 1024.;
-
-    // free memory
-    submesh.attributes.clear(); submesh.attributes.shrink_to_fit();
-
-    Logfile::get()->writeInfo(std::string() +  "Byte Size Mesh Structure: " + std::to_string(MBSize) + " MB");
-    Logfile::get()->writeInfo(std::string() +  "Num Lines: " + std::to_string(numLinesOutput / 1000.) + " Tsd.") ;
-    Logfile::get()->writeInfo(std::string() +  "Num Line Points: " + std::to_string(numLinePointsOutput / 1.0E6) + " Mio");
-
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-    Logfile::get()->writeInfo(std::string() + "Computational time to create binmesh: "
-                              + std::to_string(elapsed.count()));
-}
-
-
-
-void convertTrajectoryDataToBinaryLineMesh(
-        TrajectoryType trajectoryType,
-        const std::string &trajectoriesFilename,
-        const std::string &binaryFilename)
+        const SpatialReorderSettings &reorderSettings,
+        SpatialReorderStatistics *reorderStatistics,
+        const std::vector<int> &importanceCriteria)
 {
     auto start = std::chrono::system_clock::now();
 
-    BinaryMesh binaryMesh;
-    binaryMesh.submeshes.push_back(BinarySubMesh());
-    BinarySubMesh &submesh = binaryMesh.submeshes.front();
-    submesh.vertexMode = VERTEX_MODE_LINES;
-
     std::vector<glm::vec3> globalVertexPositions;
     std::vector<glm::vec3> globalNormals;
     std::vector<glm::vec3> globalTangents;
     std::vector<std::vector<float>> globalImportanceCriteria;
     std::vector<uint32_t> globalIndices;
+    std::vector<size_t> lineIndexOffsets;
 
 
-    Trajectories trajectories = loadTrajectoriesFromFile(trajectoriesFilename, trajectoryType);
+    TrajectorySet trajectories = importanceCriteria.empty()
+            ? loadTrajectorySetFromFile(trajectoriesFilename, trajectoryType)
+            : loadTrajectorySetFromFile(trajectoriesFilename, trajectoryType, importanceCriteria);
+    std::vector<std::string> attributeNames = getImportanceCriterionAttributeNames(
+            importanceCriteria, trajectories.getNumAttributes());
+    std::vector<ArrayView<const float>> lineImportanceCriteria(trajectories.getNumAttributes());
 
-    for (size_t i = 0; i < trajectories.size(); i++) {
-        Trajectory &trajectory = trajectories.at(i);
+    for (size_t i = 0; i < trajectories.getNumTrajectories(); i++) {
+        for (size_t k = 0; k < lineImportanceCriteria.size(); k++) {
+            lineImportanceCriteria.at(k) = trajectories.getAttribute(i, k);
+        }
 
         // Create tube render data
         std::vector<glm::vec3> localVertices;
@@ -967,11 +687,12 @@ void convertTrajectoryDataToBinaryLineMesh(
         std::vector<glm::vec3> localNormals;
         std::vector<uint32_t> localIndices;
         std::vector<std::vector<float>> importanceCriteriaOut;
-        createTangentAndNormalData(trajectory.positions, trajectory.attributes, localVertices,
+        createTangentAndNormalData(trajectories.getPositions(i), lineImportanceCriteria, localVertices,
                                    importanceCriteriaOut, localTangents, localNormals, localIndices);
 
         // Local -> global
         if (localVertices.size() > 0) {
+            lineIndexOffsets.push_back(globalIndices.size());
             for (size_t i = 0; i < localIndices.size(); i++) {
                 globalIndices.push_back(localIndices.at(i) + globalVertexPositions.size());
             }
@@ -991,81 +712,319 @@ void convertTrajectoryDataToBinaryLineMesh(
         }
     }
 
+    if (reorderSettings.isEnabled()) {
+        // The lines are kept intact, i.e., each line is one cluster.
+        reorderConvertedMesh(2, lineIndexOffsets, reorderSettings, reorderStatistics, globalIndices,
+                globalVertexPositions, { &globalNormals, &globalTangents }, globalImportanceCriteria);
+    }
+
 
-    submesh.material.diffuseColor = glm::vec3(165, 220, 84) / 255.0f;
-    submesh.material.opacity = 120 / 255.0f;
-    submesh.indices = globalIndices;
+    ObjMaterial material;
+    material.diffuseColor = glm::vec3(165, 220, 84) / 255.0f;
+    material.opacity = 120 / 255.0f;
 
     const size_t numIndices = globalIndices.size();
     const size_t numVertices = globalVertexPositions.size();
     const size_t numNormals = globalNormals.size();
     const size_t numTangents = globalTangents.size();
+
+    std::vector<std::vector<uint16_t>> globalImportanceCriteriaUnorm;
+    packUnorm16ArrayOfArrays(globalImportanceCriteria, globalImportanceCriteriaUnorm);
     // free memory
-    globalIndices.clear(); globalIndices.shrink_to_fit();
+    globalImportanceCriteria.clear(); globalImportanceCriteria.shrink_to_fit();
+
+    auto end = std::chrono::system_clock::now();
+
+    Logfile::get()->writeInfo(std::string() + "Summary: "
+                              + sgl::toString(numVertices) + " vertices, "
+                              + sgl::toString(numIndices / 3) + " faces, "
+                              + sgl::toString(numIndices) + " indices.");
+    Logfile::get()->writeInfo(std::string() + "Writing binary mesh...");
 
-    BinaryMeshAttribute positionAttribute;
-    positionAttribute.name = "vertexPosition";
-    positionAttribute.attributeFormat = ATTRIB_FLOAT;
-    positionAttribute.numComponents = 3;
-    positionAttribute.data.resize(numVertices * sizeof(glm::vec3));
-    memcpy(&positionAttribute.data.front(), &globalVertexPositions.front(), numVertices * sizeof(glm::vec3));
-    submesh.attributes.push_back(positionAttribute);
+    // Stream the data directly from the global arrays to the file (no intermediate BinaryMesh copy).
+    BinaryMeshStreamWriter meshWriter;
+    if (!meshWriter.open(binaryFilename)) {
+        return false;
+    }
+    meshWriter.setFlags(reorderSettings.getBinaryMeshFlags(false));
+    meshWriter.beginSubmesh(material, VERTEX_MODE_LINES);
+    meshWriter.writeIndices(globalIndices.data(), numIndices);
+    // free memory
+    globalIndices.clear(); globalIndices.shrink_to_fit();
 
+    meshWriter.writeAttribute("vertexPosition", ATTRIB_FLOAT, 3,
+            globalVertexPositions.data(), numVertices * sizeof(glm::vec3));
     // free memory
     globalVertexPositions.clear(); globalVertexPositions.shrink_to_fit();
 
-    BinaryMeshAttribute lineNormalsAttribute;
-    lineNormalsAttribute.name = "vertexLineNormal";
-    lineNormalsAttribute.attributeFormat = ATTRIB_FLOAT;
-    lineNormalsAttribute.numComponents = 3;
-    lineNormalsAttribute.data.resize(numNormals * sizeof(glm::vec3));
-    memcpy(&lineNormalsAttribute.data.front(), &globalNormals.front(), numNormals * sizeof(glm::vec3));
-    submesh.attributes.push_back(lineNormalsAttribute);
-
+    meshWriter.writeAttribute("vertexLineNormal", ATTRIB_FLOAT, 3,
+            globalNormals.data(), numNormals * sizeof(glm::vec3));
     // free memory
     globalNormals.clear(); globalNormals.shrink_to_fit();
 
-    BinaryMeshAttribute lineTangentAttribute;
-    lineTangentAttribute.name = "vertexLineTangent";
-    lineTangentAttribute.attributeFormat = ATTRIB_FLOAT;
-    lineTangentAttribute.numComponents = 3;
-    lineTangentAttribute.data.resize(numTangents * sizeof(glm::vec3));
-    memcpy(&lineTangentAttribute.data.front(), &globalTangents.front(), numTangents * sizeof(glm::vec3));
-    submesh.attributes.push_back(lineTangentAttribute);
-
+    meshWriter.writeAttribute("vertexLineTangent", ATTRIB_FLOAT, 3,
+            globalTangents.data(), numTangents * sizeof(glm::vec3));
     // free memory
     globalTangents.clear(); globalTangents.shrink_to_fit();
 
-    std::vector<std::vector<uint16_t>> globalImportanceCriteriaUnorm;
-    packUnorm16ArrayOfArrays(globalImportanceCriteria, globalImportanceCriteriaUnorm);
-
     for (size_t i = 0; i < globalImportanceCriteriaUnorm.size(); i++) {
         std::vector<uint16_t> &currentAttr = globalImportanceCriteriaUnorm.at(i);
-        BinaryMeshAttribute vertexAttribute;
-        vertexAttribute.name = "vertexAttribute" + sgl::toString(i);
-        vertexAttribute.attributeFormat = ATTRIB_UNSIGNED_SHORT;
-        vertexAttribute.numComponents = 1;
-        vertexAttribute.data.resize(currentAttr.size() * sizeof(uint16_t));
-        memcpy(&vertexAttribute.data.front(), &currentAttr.front(), currentAttr.size() * sizeof(uint16_t));
-        submesh.attributes.push_back(vertexAttribute);
+        meshWriter.writeAttribute(attributeNames.at(i), ATTRIB_UNSIGNED_SHORT, 1,
+                currentAttr.data(), currentAttr.size() * sizeof(uint16_t));
     }
-
     // free memory
     globalImportanceCriteriaUnorm.clear(); globalImportanceCriteriaUnorm.shrink_to_fit();
 
-    auto end = std::chrono::system_clock::now();
-
-    Logfile::get()->writeInfo(std::string() + "Summary: "
-                              + sgl::toString(numVertices) + " vertices, "
-                              + sgl::toString(numIndices / 3) + " faces, "
-                              + sgl::toString(numIndices) + " indices.");
-    Logfile::get()->writeInfo(std::string() + "Writing binary mesh...");
-    writeMesh3D(binaryFilename, binaryMesh);
+    if (!meshWriter.finish()) {
+        return false;
+    }
 
 
     auto elapsed =
             std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
     Logfile::get()->writeInfo(std::string() + "Computational time to create binmesh: "
                         + std::to_string(elapsed.count()));
+    return true;
 }
 
+
+
+/**
+ * Computes the vertices of a mesh converted by convertTrajectoryDataToBinaryLineMesh (one vertex per tube node) or
+ * convertTrajectoryDataToBinaryTriangleMesh (one circle per tube node) in the order they are emitted before the
+ * spatial reordering.
+ * @param vertexPoints: The (output) index of the line point (in trajectories.positions) of each vertex.
+ * @param indices: The (output) index buffer.
+ * @param clusterOffsets: The (output) offsets of the lines in the index buffer (for the reordering of line meshes).
+ */
+static void computeConvertedVertexPoints(
+        const TrajectorySet &trajectories, bool isLineMesh, size_t numCirclePoints,
+        std::vector<uint32_t> &vertexPoints, std::vector<uint32_t> &indices, std::vector<size_t> &clusterOffsets)
+{
+    const size_t numTrajectories = trajectories.getNumTrajectories();
+    LineMeshRanges ranges;
+    computeLineMeshRanges(numTrajectories, [&trajectories](size_t i) {
+        return trajectories.getPositions(i);
+    }, isLineMesh, numCirclePoints, false, ranges);
+    vertexPoints.resize(ranges.numVertices);
+    indices.resize(ranges.numIndices);
+    const size_t verticesPerNode = isLineMesh ? 1 : numCirclePoints;
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (size_t i = 0; i < numTrajectories; i++) {
+        if (ranges.vertexCounts.at(i) == 0) {
+            continue;
+        }
+        ArrayView<const glm::vec3> pathLineCenters = trajectories.getPositions(i);
+        const size_t vertexOffset = ranges.vertexOffsets.at(i);
+        size_t numTubeNodes = 0;
+        glm::vec3 tangent;
+        for (int j = 0; j < (int)pathLineCenters.size(); j++) {
+            if (!computeTubeNodeTangent(pathLineCenters, j, tangent)) {
+                continue;
+            }
+            uint32_t *nodeVertexPoints = &vertexPoints.at(vertexOffset + numTubeNodes * verticesPerNode);
+            for (size_t k = 0; k < verticesPerNode; k++) {
+                nodeVertexPoints[k] = uint32_t(trajectories.lineOffsets.at(i) + j);
+            }
+            numTubeNodes++;
+        }
+
+        uint32_t *lineIndices = indices.data() + ranges.indexOffsets.at(i);
+        if (isLineMesh) {
+            for (size_t j = 0; j + 1 < numTubeNodes; j++) {
+                lineIndices[j * 2] = uint32_t(vertexOffset + j);
+                lineIndices[j * 2 + 1] = uint32_t(vertexOffset + j + 1);
+            }
+        } else {
+            writeTubeIndices(numTubeNodes, numCirclePoints, vertexOffset, lineIndices);
+        }
+    }
+
+    // Like convertTrajectoryDataToBinaryLineMesh, only the lines with vertices are clusters.
+    clusterOffsets.clear();
+    for (size_t i = 0; i < numTrajectories; i++) {
+        if (ranges.vertexCounts.at(i) > 0) {
+            clusterOffsets.push_back(ranges.indexOffsets.at(i));
+        }
+    }
+}
+
+/**
+ * Checks that the vertex layout of a converted mesh matches the vertices computed by computeConvertedVertexPoints.
+ * @return An empty string if the layout matches, otherwise a description of the first mismatch.
+ */
+static std::string checkConvertedVertexLayout(
+        const TrajectorySet &trajectories, const BinarySubMeshView &submesh, bool hasMeshlets,
+        const std::vector<uint32_t> &vertexPoints, const std::vector<uint32_t> &indices)
+{
+    const BinaryMeshAttributeView *positionAttribute = nullptr;
+    for (const BinaryMeshAttributeView &attribute : submesh.attributes) {
+        if (attribute.name == "vertexPosition" && attribute.attributeFormat == ATTRIB_FLOAT
+                && attribute.numComponents == 3) {
+            positionAttribute = &attribute;
+        }
+    }
+    if (!positionAttribute) {
+        return "The mesh has no vertex positions";
+    }
+    const size_t numVertices = positionAttribute->dataSize / sizeof(glm::vec3);
+    if (numVertices != vertexPoints.size()) {
+        return "The number of vertices (" + sgl::toString(numVertices) + ") doesn't match the trajectories ("
+                + sgl::toString(vertexPoints.size()) + ")";
+    }
+    // Building the meshlets reorders the triangles, but keeps the number of indices.
+    if (submesh.numIndices != indices.size() || (!hasMeshlets && numVertices > 0
+            && memcmp(submesh.indices, indices.data(), indices.size() * sizeof(uint32_t)) != 0)) {
+        return "The lines or tubes of the mesh don't match the trajectories";
+    }
+
+    const glm::vec3 *vertexPositions = (const glm::vec3*)positionAttribute->data;
+    const bool isLineMesh = submesh.vertexMode == VERTEX_MODE_LINES;
+    size_t numMismatches = 0;
+    if (isLineMesh) {
+        // The vertices are the line points.
+        #pragma omp parallel for reduction(+:numMismatches)
+        for (size_t i = 0; i < numVertices; i++) {
+            if (memcmp(&vertexPositions[i], &trajectories.positions[vertexPoints[i]], sizeof(glm::vec3)) != 0) {
+                numMismatches++;
+            }
+        }
+    } else if (numVertices > 0) {
+        // The vertices lie on circles around the line points (with the line radius used by the conversion).
+        const float radius = glm::length(vertexPositions[0] - trajectories.positions[vertexPoints[0]]);
+        #pragma omp parallel for reduction(+:numMismatches)
+        for (size_t i = 0; i < numVertices; i++) {
+            const glm::vec3 &center = trajectories.positions[vertexPoints[i]];
+            float maxCoordinate = std::max(std::fabs(center.x), std::max(std::fabs(center.y), std::fabs(center.z)));
+            float tolerance = 1e-3f * radius + 4.0f * FLT_EPSILON * maxCoordinate;
+            if (!(std::fabs(glm::length(vertexPositions[i] - center) - radius) <= tolerance)) {
+                numMismatches++;
+            }
+        }
+    }
+    if (numMismatches > 0) {
+        return "The positions of " + sgl::toString(numMismatches) + " vertices don't match the trajectories";
+    }
+    return "";
+}
+
+bool appendImportanceCriteriaToBinaryMesh(
+        TrajectoryType trajectoryType,
+        const std::string &trajectoriesFilename,
+        const std::string &binaryFilename,
+        const std::vector<int> &importanceCriteria)
+{
+    auto start = std::chrono::system_clock::now();
+
+    // The converters only write one submesh.
+    BinaryMeshTableOfContents tableOfContents;
+    if (!readBinaryMeshTableOfContents(binaryFilename, tableOfContents) || tableOfContents.numSubmeshes != 1) {
+        Logfile::get()->writeError(std::string() + "Error in appendImportanceCriteriaToBinaryMesh: \""
+                + binaryFilename + "\" is no converted trajectory mesh.");
+        return false;
+    }
+    std::vector<int> missingCriteria;
+    for (int criterionIndex : importanceCriteria) {
+        std::string attributeName = "vertexAttribute" + sgl::toString(criterionIndex);
+        bool isStored = false;
+        for (const BinaryMeshSectionInfo &sectionInfo : tableOfContents.sections) {
+            isStored = isStored || (sectionInfo.sectionType == BINMESH_SECTION_ATTRIBUTE
+                    && sectionInfo.name == attributeName);
+        }
+        if (!isStored && std::find(missingCriteria.begin(), missingCriteria.end(), criterionIndex)
+                == missingCriteria.end()) {
+            missingCriteria.push_back(criterionIndex);
+        }
+    }
+    if (missingCriteria.empty()) {
+        return true;
+    }
+    bool hasMeshlets = false;
+    for (const BinaryMeshSectionInfo &sectionInfo : tableOfContents.sections) {
+        hasMeshlets = hasMeshlets || sectionInfo.sectionType == BINMESH_SECTION_MESHLETS;
+    }
+
+    BinaryMeshSelection selection;
+    selection.attributeNames = { "vertexPosition" };
+    MappedBinaryMesh mesh;
+    if (!mesh.open(binaryFilename, selection)) {
+        return false;
+    }
+    const BinarySubMeshView &submesh = mesh.submeshes.front();
+    const bool isLineMesh = submesh.vertexMode == VERTEX_MODE_LINES;
+    const uint32_t reorderFlags = mesh.getFlags()
+            & (BINMESH_FLAG_MORTON_ORDER | BINMESH_FLAG_HILBERT_ORDER | BINMESH_FLAG_VERTEX_CACHE_OPTIMIZED);
+    if ((!isLineMesh && submesh.vertexMode != VERTEX_MODE_TRIANGLES) || (!isLineMesh && reorderFlags != 0)) {
+        // The cluster size of the reordering of tubes is not stored in the file.
+        Logfile::get()->writeError(std::string() + "Error in appendImportanceCriteriaToBinaryMesh: Appending to \""
+                + binaryFilename + "\" is not supported (vertex mode or spatial reordering).");
+        return false;
+    }
+
+    TrajectorySet trajectories = loadTrajectorySetFromFile(trajectoriesFilename, trajectoryType, missingCriteria);
+    if (trajectories.getNumAttributes() != missingCriteria.size()) {
+        return false;
+    }
+
+    // Map the line points onto the vertices in the order of the converters.
+    const size_t numCirclePoints = size_t(NUM_CIRCLE_SEGMENTS);
+    std::vector<uint32_t> vertexPoints;
+    std::vector<uint32_t> indices;
+    std::vector<size_t> clusterOffsets;
+    computeConvertedVertexPoints(trajectories, isLineMesh, numCirclePoints, vertexPoints, indices, clusterOffsets);
+    if (reorderFlags != 0) {
+        // The reordering of line meshes only depends on the curve (one cluster per line).
+        SpatialReorderSettings reorderSettings;
+        reorderSettings.curve = (reorderFlags & BINMESH_FLAG_HILBERT_ORDER) != 0
+                ? SPACE_FILLING_CURVE_HILBERT : SPACE_FILLING_CURVE_MORTON;
+        std::vector<glm::vec3> vertexPositions(vertexPoints.size());
+        #pragma omp parallel for
+        for (size_t i = 0; i < vertexPoints.size(); i++) {
+            vertexPositions[i] = trajectories.positions[vertexPoints[i]];
+        }
+        std::vector<uint32_t> vertexOrder;
+        reorderMeshClusters(indices, 2, clusterOffsets, vertexPositions.data(), vertexPositions.size(),
+                reorderSettings, vertexOrder);
+        reorderVertexData(vertexPoints, vertexOrder);
+    }
+
+    std::string errorString = checkConvertedVertexLayout(
+            trajectories, submesh, hasMeshlets, vertexPoints, indices);
+    mesh.close();
+    if (!errorString.empty()) {
+        Logfile::get()->writeError(std::string() + "Error in appendImportanceCriteriaToBinaryMesh: " + errorString
+                + " (\"" + binaryFilename + "\", \"" + trajectoriesFilename + "\").");
+        return false;
+    }
+    indices.clear(); indices.shrink_to_fit();
+
+    std::vector<std::vector<uint16_t>> importanceCriteriaUnorm(missingCriteria.size());
+    std::vector<BinaryMeshAppendedAttribute> appendedAttributes(missingCriteria.size());
+    for (size_t k = 0; k < missingCriteria.size(); k++) {
+        const std::vector<float> &pointCriterion = trajectories.attributes.at(k);
+        std::vector<float> vertexCriterion(vertexPoints.size());
+        #pragma omp parallel for
+        for (size_t i = 0; i < vertexPoints.size(); i++) {
+            vertexCriterion[i] = pointCriterion[vertexPoints[i]];
+        }
+        packUnorm16Array(vertexCriterion, importanceCriteriaUnorm.at(k));
+
+        BinaryMeshAppendedAttribute &appendedAttribute = appendedAttributes.at(k);
+        appendedAttribute.submeshIndex = 0;
+        appendedAttribute.attribute.name = "vertexAttribute" + sgl::toString(missingCriteria.at(k));
+        appendedAttribute.attribute.attributeFormat = ATTRIB_UNSIGNED_SHORT;
+        appendedAttribute.attribute.numComponents = 1;
+        appendedAttribute.attribute.data = (const uint8_t*)importanceCriteriaUnorm.at(k).data();
+        appendedAttribute.attribute.dataSize = importanceCriteriaUnorm.at(k).size() * sizeof(uint16_t);
+    }
+    if (!appendBinaryMeshAttributes(binaryFilename, appendedAttributes)) {
+        return false;
+    }
+
+    auto end = std::chrono::system_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    Logfile::get()->writeInfo(std::string() + "Computational time to append importance criteria: "
+                              + std::to_string(elapsed.count()));
+    return true;
+}
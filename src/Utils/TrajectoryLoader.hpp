@@ -11,30 +11,35 @@
 
 #include <glm/glm.hpp>
 
+#include "ArrayView.hpp"
 #include "ImportanceCriteria.hpp"
+#include "SpatialReordering.hpp"
+
+/// Number of vertices of the circles the tubes of the triangle mesh converters are built from.
+const int NUM_CIRCLE_SEGMENTS = 3;
 
 /**
- * @param pathLineCenters: The (input) path line points to create a tube from.
- * @param pathLineAttributes: The (input) path line point vertex attributes (belonging to pathLineCenters).
+ * Creates the tube render data of multiple lines. The lines are processed in parallel: The vertices and indices of each
+ * line are counted first, and each line then writes its data directly to its range of the output arrays (the ranges
+ * are the exclusive prefix sums of the counts). Thus, the output doesn't depend on the number of threads.
+ * Lines with less than two points, closed lines (fixed point whirls) and lines with only one tube node are skipped.
+ * @param linesCenters: The (input) path line points to create tubes from (one view per line).
+ * @param linesAttributes: The (input) path line point vertex attributes (one view per line, or empty if none).
  * @param vertices: The (output) vertex points, which are a set of oriented circles around the centers (see above).
+ * @param normals: The (output) vertex normals.
+ * @param vertexAttributes: The (output) vertex attributes (empty if linesAttributes is empty).
  * @param indices: The (output) indices specifying how tube triangles are built from the circle vertices.
  */
 template<typename T>
-void createTubeRenderData(const std::vector<glm::vec3> &pathLineCenters,
-                          const std::vector<T> &pathLineAttributes,
+void createTubeRenderData(const std::vector<ArrayView<const glm::vec3>> &linesCenters,
+                          const std::vector<ArrayView<const T>> &linesAttributes,
                           std::vector<glm::vec3> &vertices,
                           std::vector<glm::vec3> &normals,
                           std::vector<T> &vertexAttributes,
                           std::vector<uint32_t> &indices);
-/*extern template
-void createTubeRenderData<uint32_t>(const std::vector<glm::vec3> &pathLineCenters,
-                                    const std::vector<uint32_t> &pathLineAttributes,
-                                    std::vector<glm::vec3> &vertices,
-                                    std::vector<float> &vertexAttributes,
-                                    std::vector<uint32_t> &indices);*/
 extern template
-void createTubeRenderData<uint32_t>(const std::vector<glm::vec3> &pathLineCenters,
-                                    const std::vector<uint32_t> &pathLineAttributes,
+void createTubeRenderData<uint32_t>(const std::vector<ArrayView<const glm::vec3>> &linesCenters,
+                                    const std::vector<ArrayView<const uint32_t>> &linesAttributes,
                                     std::vector<glm::vec3> &vertices,
                                     std::vector<glm::vec3> &normals,
                                     std::vector<uint32_t> &vertexAttributes,
@@ -42,21 +47,55 @@ void createTubeRenderData<uint32_t>(const std::vector<glm::vec3> &pathLineCenter
 
 void initializeCircleData(int numSegments, float radius);
 
-void convertTrajectoryDataToBinaryTriangleMesh(
+/**
+ * @param reorderSettings Optional spatial reordering of the tube clusters/lines (see SpatialReordering.hpp). The
+ * reordering is recorded in the flags of the .binmesh header.
+ * @param reorderStatistics If not nullptr and reordering is enabled, receives the simulated cache statistics before
+ * and after reordering (the simulation is sequential, so it is only performed on request).
+ * @param importanceCriteria The importance criteria to compute and store as "vertexAttribute<N>" (see
+ * getImportanceCriterionKernels). If empty, the attributes loaded by loadTrajectorySetFromFile are stored.
+ * @return False if the trajectories couldn't be loaded or the mesh couldn't be written.
+ */
+bool convertTrajectoryDataToBinaryTriangleMesh(
         TrajectoryType trajectoryType,
         const std::string &trajectoriesFilename,
         const std::string &binaryFilename,
-        float lineRadius);
+        float lineRadius,
+        const SpatialReorderSettings &reorderSettings = SpatialReorderSettings(),
+        SpatialReorderStatistics *reorderStatistics = nullptr,
+        const std::vector<int> &importanceCriteria = std::vector<int>());
 
-void convertTrajectoryDataToBinaryTriangleMeshGPU(
+/// GPU version of convertTrajectoryDataToBinaryTriangleMesh. @return False if the mesh couldn't be written.
+bool convertTrajectoryDataToBinaryTriangleMeshGPU(
         TrajectoryType trajectoryType,
         const std::string &trajectoriesFilename,
         const std::string &binaryFilename,
         float lineRadius);
 
-void convertTrajectoryDataToBinaryLineMesh(
+/// Line mesh version of convertTrajectoryDataToBinaryTriangleMesh. @return False if the conversion failed.
+bool convertTrajectoryDataToBinaryLineMesh(
+        TrajectoryType trajectoryType,
+        const std::string &trajectoriesFilename,
+        const std::string &binaryFilename,
+        const SpatialReorderSettings &reorderSettings = SpatialReorderSettings(),
+        SpatialReorderStatistics *reorderStatistics = nullptr,
+        const std::vector<int> &importanceCriteria = std::vector<int>());
+
+/**
+ * Appends importance criteria to a line or tube mesh converted from the same trajectory file (e.g. when another
+ * criterion is displayed) without converting the mesh again or rewriting its data (see appendBinaryMeshAttributes).
+ * The criteria of the line points are mapped onto the vertices in the order the converters emit them (including the
+ * spatial reordering of line meshes recorded in the header flags). Before appending, the vertex layout of the file is
+ * checked against the trajectories: The number of vertices and the index buffer need to match, and the vertex
+ * positions need to be the line points (line meshes) or lie on circles around them (tubes).
+ * @param importanceCriteria The criteria to store as "vertexAttribute<N>". Criteria already stored are skipped.
+ * @return False if the mesh doesn't match the trajectories, is a spatially reordered tube mesh (the cluster size is
+ * not stored in the file) or couldn't be written.
+ */
+bool appendImportanceCriteriaToBinaryMesh(
         TrajectoryType trajectoryType,
         const std::string &trajectoriesFilename,
-        const std::string &binaryFilename);
+        const std::string &binaryFilename,
+        const std::vector<int> &importanceCriteria);
 
 #endif //PIXELSYNCOIT_TRAJECTORYLOADER_HPP
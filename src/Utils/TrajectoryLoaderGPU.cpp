@@ -0,0 +1,349 @@
+#include <Utils/File/Logfile.hpp>
+#include <Utils/Convert.hpp>
+#include <Math/Math.hpp>
+#include <Graphics/Shader/ShaderManager.hpp>
+#include <Graphics/Renderer.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <GL/glew.h>
+
+#include "MeshSerializer.hpp"
+#include "TrajectoryFile.hpp"
+#include "TrajectoryLoader.hpp"
+
+using namespace sgl;
+
+/*
+ * The OpenGL compute shader version of the tube mesh creation. It is kept separate from TrajectoryLoader.cpp, such
+ * that the CPU converters can be used without an OpenGL context (e.g. by PixelSyncOITBenchmark).
+ */
+
+struct InputLinePoint {
+    glm::vec3 linePoint;
+    float lineAttribute;
+};
+struct OutputLinePoint {
+    glm::vec3 linePoint;
+    float lineAttribute;
+    glm::vec3 lineTangent;
+    uint32_t valid; // 0 or 1
+    glm::vec3 lineNormal;
+    float padding2;
+};
+struct PathLinePoint {
+    glm::vec3 linePointPosition;
+    float linePointAttribute;
+    glm::vec3 lineTangent;
+    float padding1;
+    glm::vec3 lineNormal;
+    float padding2;
+};
+
+struct TubeVertex {
+    glm::vec3 vertexPosition;
+    float vertexAttribute;
+    glm::vec3 vertexNormal;
+    float padding;
+};
+
+bool convertTrajectoryDataToBinaryTriangleMeshGPU(
+        TrajectoryType trajectoryType,
+        const std::string &trajectoriesFilename,
+        const std::string &binaryFilename,
+        float lineRadius)
+{
+    auto start = std::chrono::system_clock::now();
+    sgl::ShaderManager->invalidateShaderCache();
+
+    if (trajectoryType == TRAJECTORY_TYPE_RINGS) {
+        sgl::ShaderManager->addPreprocessorDefine("NUM_CIRCLE_SEGMENTS", NUM_CIRCLE_SEGMENTS);
+        sgl::ShaderManager->addPreprocessorDefine("CIRCLE_RADIUS", lineRadius);
+    } else if (trajectoryType == TRAJECTORY_TYPE_ANEURYSM) {
+        sgl::ShaderManager->addPreprocessorDefine("NUM_CIRCLE_SEGMENTS", NUM_CIRCLE_SEGMENTS);
+        sgl::ShaderManager->addPreprocessorDefine("CIRCLE_RADIUS", lineRadius);
+    } else {
+        sgl::ShaderManager->addPreprocessorDefine("NUM_CIRCLE_SEGMENTS", NUM_CIRCLE_SEGMENTS);
+        sgl::ShaderManager->addPreprocessorDefine("CIRCLE_RADIUS", lineRadius);
+    }
+
+    std::vector<uint32_t> lineOffsetsInput;
+    uint64_t numLinesInput = 0;
+    uint64_t numLinePointsInput = 0;
+
+    std::vector<uint32_t> lineOffsetsOutput;
+    uint64_t numLinesOutput = 0;
+    uint64_t numLinePointsOutput = 0;
+
+    std::vector<InputLinePoint> inputLinePoints;
+    std::vector<OutputLinePoint> outputLinePoints;
+    std::vector<PathLinePoint> pathLinePoints;
+
+    auto startLoad = std::chrono::system_clock::now();
+
+    TrajectorySet trajectories = loadTrajectorySetFromFile(trajectoriesFilename, trajectoryType);
+
+    lineOffsetsInput.push_back(0);
+    inputLinePoints.reserve(trajectories.getNumPoints());
+    for (size_t i = 0; i < trajectories.getNumTrajectories(); i++) {
+        ArrayView<const glm::vec3> linePositions = trajectories.getPositions(i);
+        ArrayView<const float> lineAttributes = trajectories.getAttribute(i, 0);
+
+        InputLinePoint inputLinePoint;
+        for (size_t j = 0; j < linePositions.size(); j++) {
+            inputLinePoint.linePoint = linePositions[j];
+            inputLinePoint.lineAttribute = lineAttributes[j];
+            inputLinePoints.push_back(inputLinePoint);
+        }
+
+        if (linePositions.size() > 0) {
+            numLinePointsInput += linePositions.size();
+            numLinesInput++;
+        } else {
+            continue;
+        }
+        lineOffsetsInput.push_back(numLinePointsInput);
+    }
+
+    auto endLoad = std::chrono::system_clock::now();
+    auto elapsedLoad = std::chrono::duration_cast<std::chrono::milliseconds>(endLoad - startLoad);
+    Logfile::get()->writeInfo(std::string() + "Computational time to load: " + std::to_string(elapsedLoad.count()));
+
+    const unsigned int WORK_GROUP_SIZE_1D = 256;
+    sgl::ShaderManager->addPreprocessorDefine("WORK_GROUP_SIZE_1D", WORK_GROUP_SIZE_1D);
+    unsigned int numWorkGroupsOld;
+    uint32_t numWorkGroups;
+    void *bufferMemory;
+
+    // PART 1: Create line normals & mask invalid line points
+    auto startNormals = std::chrono::system_clock::now();
+    sgl::GeometryBufferPtr lineOffsetBufferInput = sgl::Renderer->createGeometryBuffer(
+            (numLinesInput+1) * sizeof(uint32_t), &lineOffsetsInput.front(),
+            SHADER_STORAGE_BUFFER, BUFFER_STATIC);
+    sgl::GeometryBufferPtr inputLinePointBuffer = sgl::Renderer->createGeometryBuffer(
+            inputLinePoints.size() * sizeof(InputLinePoint), &inputLinePoints.front(),
+            SHADER_STORAGE_BUFFER, BUFFER_STATIC);
+    sgl::GeometryBufferPtr outputLinePointBuffer = sgl::Renderer->createGeometryBuffer(
+            inputLinePoints.size() * sizeof(OutputLinePoint),
+            SHADER_STORAGE_BUFFER, BUFFER_STATIC);
+
+    sgl::ShaderProgramPtr createLineNormalsShader = sgl::ShaderManager->getShaderProgram({"CreateLineNormals.Compute"});
+    sgl::ShaderManager->bindShaderStorageBuffer(2, lineOffsetBufferInput);
+    sgl::ShaderManager->bindShaderStorageBuffer(3, inputLinePointBuffer);
+    sgl::ShaderManager->bindShaderStorageBuffer(4, outputLinePointBuffer);
+    createLineNormalsShader->setUniform("numLines", static_cast<uint32_t>(numLinesInput));
+    numWorkGroupsOld = iceil(numLinesInput, WORK_GROUP_SIZE_1D); // last vector: local work group size
+    numWorkGroups = (numLinesInput - 1) / WORK_GROUP_SIZE_1D + 1;
+
+    createLineNormalsShader->dispatchCompute(numWorkGroups);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    bufferMemory = outputLinePointBuffer->mapBuffer(BUFFER_MAP_READ_ONLY);
+    outputLinePoints.resize(inputLinePoints.size());
+    memcpy(&outputLinePoints.front(), bufferMemory, outputLinePoints.size() * sizeof(OutputLinePoint));
+    outputLinePointBuffer->unmapBuffer();
+    auto endNormals = std::chrono::system_clock::now();
+    auto elapsedNormals = std::chrono::duration_cast<std::chrono::milliseconds>(endNormals - startNormals);
+    Logfile::get()->writeInfo(std::string() + "Computational time to create normals: "
+            + std::to_string(elapsedNormals.count()));
+
+
+    // PART 1.2: OutputLinePoint -> PathLinePoint (while removing invalid points)
+    auto startCompact = std::chrono::system_clock::now();
+    pathLinePoints.reserve(outputLinePoints.size());
+    lineOffsetsOutput.push_back(0);
+    for (size_t lineID = 0; lineID < numLinesInput; lineID++) {
+        size_t linePointsOffset = lineOffsetsInput.at(lineID);
+        size_t numLinePoints = lineOffsetsInput.at(lineID+1)-linePointsOffset;
+
+        size_t currentLineNumPointsOutput = 0;
+
+        for (size_t linePointID = 0; linePointID < numLinePoints; linePointID++) {
+            OutputLinePoint &outputLinePoint = outputLinePoints.at(linePointsOffset+linePointID);
+            if (outputLinePoint.valid == 1) {
+                PathLinePoint pathLinePoint;
+                pathLinePoint.linePointPosition = outputLinePoint.linePoint;
+                pathLinePoint.linePointAttribute = outputLinePoint.lineAttribute;
+                pathLinePoint.lineTangent = outputLinePoint.lineTangent;
+                pathLinePoint.lineNormal = outputLinePoint.lineNormal;
+                pathLinePoints.push_back(pathLinePoint);
+                currentLineNumPointsOutput++;
+                numLinePointsOutput++;
+            }
+        }
+
+        if (currentLineNumPointsOutput > 0) {
+            numLinesOutput++;
+            lineOffsetsOutput.push_back(numLinePointsOutput);
+        }
+    }
+    auto endCompact = std::chrono::system_clock::now();
+    auto elapsedCompact = std::chrono::duration_cast<std::chrono::milliseconds>(endCompact - startCompact);
+    Logfile::get()->writeInfo(std::string() + "Computational time to compact: "
+            + std::to_string(elapsedCompact.count()));
+
+
+    // PART 2: CreateTubePoints.Compute
+    auto startTube = std::chrono::system_clock::now();
+    std::vector<TubeVertex> tubeVertices;
+    tubeVertices.resize(NUM_CIRCLE_SEGMENTS * pathLinePoints.size());
+
+    sgl::GeometryBufferPtr pathLinePointsBuffer = sgl::Renderer->createGeometryBuffer(
+            pathLinePoints.size() * sizeof(PathLinePoint), &pathLinePoints.front(),
+            SHADER_STORAGE_BUFFER, BUFFER_STATIC);
+    sgl::GeometryBufferPtr tubeVertexBuffer = sgl::Renderer->createGeometryBuffer(
+            NUM_CIRCLE_SEGMENTS * pathLinePoints.size() * sizeof(TubeVertex),
+            SHADER_STORAGE_BUFFER, BUFFER_STATIC);
+
+    int maxNumWorkGroupsSupported = 0;
+    glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, 0, &maxNumWorkGroupsSupported);
+
+    sgl::ShaderProgramPtr createTubePointsShader = sgl::ShaderManager->getShaderProgram({"CreateTubePoints.Compute"});
+    sgl::ShaderManager->bindShaderStorageBuffer(2, pathLinePointsBuffer);
+    sgl::ShaderManager->bindShaderStorageBuffer(3, tubeVertexBuffer);
+    createTubePointsShader->setUniform("numLinePoints", static_cast<uint32_t>(numLinePointsOutput));
+    numWorkGroups = iceil(pathLinePoints.size(), WORK_GROUP_SIZE_1D);
+    if (numWorkGroups > maxNumWorkGroupsSupported) {
+        sgl::Logfile::get()->writeInfo("Info: numWorkGroups > MAX_COMPUTE_WORK_GROUP_COUNT. Switching to CPU fallback.");
+        return convertTrajectoryDataToBinaryTriangleMesh(
+                trajectoryType, trajectoriesFilename, binaryFilename, lineRadius);
+    }
+    createTubePointsShader->dispatchCompute(numWorkGroups);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    bufferMemory = tubeVertexBuffer->mapBuffer(BUFFER_MAP_READ_ONLY);
+    memcpy(&tubeVertices.front(), bufferMemory, NUM_CIRCLE_SEGMENTS * pathLinePoints.size() * sizeof(TubeVertex));
+    tubeVertexBuffer->unmapBuffer();
+
+    std::vector<glm::vec3> globalVertexPositions;
+    std::vector<glm::vec3> globalNormals;
+    std::vector<std::vector<float>> globalImportanceCriteria;
+    globalVertexPositions.reserve(tubeVertices.size());
+    globalNormals.reserve(tubeVertices.size());
+    globalImportanceCriteria.resize(1);
+    globalImportanceCriteria.at(0).reserve(tubeVertices.size());
+    for (TubeVertex &tubeVertex : tubeVertices) {
+        globalVertexPositions.push_back(tubeVertex.vertexPosition);
+        globalNormals.push_back(tubeVertex.vertexNormal);
+        globalImportanceCriteria.at(0).push_back(tubeVertex.vertexAttribute);
+    }
+    auto endTube = std::chrono::system_clock::now();
+    auto elapsedTube = std::chrono::duration_cast<std::chrono::milliseconds>(endTube - startTube);
+    Logfile::get()->writeInfo(std::string() + "Computational time to create tube vertices: "
+                              + std::to_string(elapsedTube.count()));
+
+
+
+
+    // PART 3: CreateTubeIndices.Compute
+    auto startIndices = std::chrono::system_clock::now();
+    std::vector<uint32_t> tubeIndices;
+    size_t numLineSegments = numLinePointsOutput - numLinesOutput;
+    size_t numIndices = numLineSegments*NUM_CIRCLE_SEGMENTS*6;
+    tubeIndices.resize(numIndices);
+
+    sgl::GeometryBufferPtr lineOffsetBufferOutput = sgl::Renderer->createGeometryBuffer(
+            (numLinesOutput+1) * sizeof(uint32_t), &lineOffsetsOutput.front(),
+            SHADER_STORAGE_BUFFER, BUFFER_STATIC);
+    sgl::GeometryBufferPtr tubeIndexBuffer = sgl::Renderer->createGeometryBuffer(
+            numIndices * sizeof(uint32_t),
+            SHADER_STORAGE_BUFFER, BUFFER_STATIC);
+
+    sgl::ShaderProgramPtr createTubeIndicesShader = sgl::ShaderManager->getShaderProgram({"CreateTubeIndices.Compute"});
+    sgl::ShaderManager->bindShaderStorageBuffer(2, lineOffsetBufferOutput);
+    sgl::ShaderManager->bindShaderStorageBuffer(3, tubeIndexBuffer);
+    createTubeIndicesShader->setUniform("numLines", static_cast<uint32_t>(numLinesOutput));
+    numWorkGroups = iceil(numLinesOutput, WORK_GROUP_SIZE_1D); // last vector: local work group size
+    createTubeIndicesShader->dispatchCompute(numWorkGroups);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+    bufferMemory = tubeIndexBuffer->mapBuffer(BUFFER_MAP_READ_ONLY);
+    memcpy(&tubeIndices.front(), bufferMemory, numIndices * sizeof(uint32_t));
+    tubeIndexBuffer->unmapBuffer();
+    auto endIndices = std::chrono::system_clock::now();
+    auto elapsedIndices = std::chrono::duration_cast<std::chrono::milliseconds>(endIndices - startIndices);
+    Logfile::get()->writeInfo(std::string() + "Computational time to create tube indices: "
+            + std::to_string(elapsedIndices.count()));
+
+    sgl::ShaderManager->removePreprocessorDefine("WORK_GROUP_SIZE_1D");
+    sgl::ShaderManager->removePreprocessorDefine("NUM_CIRCLE_SEGMENTS");
+    sgl::ShaderManager->removePreprocessorDefine("CIRCLE_RADIUS");
+    sgl::ShaderManager->unbindShader();
+
+
+
+    // Normalize data for rings
+    auto startPost = std::chrono::system_clock::now();
+
+    ObjMaterial material;
+    material.diffuseColor = glm::vec3(165, 220, 84) / 255.0f;
+    material.opacity = 120 / 255.0f;
+
+    const size_t numIndicesTubes = tubeIndices.size();
+    const size_t numVertices = globalVertexPositions.size();
+    const size_t numNormals = globalNormals.size();
+
+    std::vector<std::vector<uint16_t>> globalImportanceCriteriaUnorm;
+    packUnorm16ArrayOfArrays(globalImportanceCriteria, globalImportanceCriteriaUnorm);
+    // free memory
+    globalImportanceCriteria.clear(); globalImportanceCriteria.shrink_to_fit();
+    auto endPost = std::chrono::system_clock::now();
+    auto elapsedPost = std::chrono::duration_cast<std::chrono::milliseconds>(endPost - startPost);
+    Logfile::get()->writeInfo(std::string() + "Computational time post-process: " + std::to_string(elapsedPost.count()));
+
+    auto end = std::chrono::system_clock::now();
+
+    Logfile::get()->writeInfo(std::string() + "Summary: "
+                              + sgl::toString(numVertices) + " vertices, "
+                              + sgl::toString(numIndicesTubes / 3) + " faces, "
+                              + sgl::toString(numIndicesTubes) + " indices.");
+    Logfile::get()->writeInfo(std::string() + "Writing binary mesh...");
+
+    // Stream the data directly from the global arrays to the file (no intermediate BinaryMesh copy).
+    BinaryMeshStreamWriter meshWriter;
+    if (!meshWriter.open(binaryFilename)) {
+        return false;
+    }
+    meshWriter.beginSubmesh(material, VERTEX_MODE_TRIANGLES);
+    meshWriter.writeIndices(tubeIndices.data(), numIndicesTubes);
+    // free memory
+    tubeIndices.clear(); tubeIndices.shrink_to_fit();
+
+    meshWriter.writeAttribute("vertexPosition", ATTRIB_FLOAT, 3,
+            globalVertexPositions.data(), numVertices * sizeof(glm::vec3));
+    // free memory
+    globalVertexPositions.clear(); globalVertexPositions.shrink_to_fit();
+
+    meshWriter.writeAttribute("vertexNormal", ATTRIB_FLOAT, 3, globalNormals.data(), numNormals * sizeof(glm::vec3));
+    // free memory
+    globalNormals.clear(); globalNormals.shrink_to_fit();
+
+    for (size_t i = 0; i < globalImportanceCriteriaUnorm.size(); i++) {
+        std::vector<uint16_t> &currentAttr = globalImportanceCriteriaUnorm.at(i);
+        meshWriter.writeAttribute("vertexAttribute" + sgl::toString(i), ATTRIB_UNSIGNED_SHORT, 1,
+                currentAttr.data(), currentAttr.size() * sizeof(uint16_t));
+    }
+    const size_t numImportanceCriteria = globalImportanceCriteriaUnorm.size();
+    // free memory
+    globalImportanceCriteriaUnorm.clear(); globalImportanceCriteriaUnorm.shrink_to_fit();
+
+    if (!meshWriter.finish()) {
+        return false;
+    }
+
+    // compute size of renderable geometry (positions, normals, one attribute, indices)
+    float byteSize = numVertices * sizeof(glm::vec3) + numNormals * sizeof(glm::vec3)
+                     + (numImportanceCriteria > 0 ? numVertices * sizeof(uint16_t) : 0)
+                     + numIndicesTubes * sizeof(uint32_t);
+
+    float MBSize = byteSize / 1024. / 1024.;
+
+    Logfile::get()->writeInfo(std::string() +  "Byte Size Mesh Structure: " + std::to_string(MBSize) + " MB");
+    Logfile::get()->writeInfo(std::string() +  "Num Lines: " + std::to_string(numLinesOutput / 1000.) + " Tsd.") ;
+    Logfile::get()->writeInfo(std::string() +  "Num Line Points: " + std::to_string(numLinePointsOutput / 1.0E6) + " Mio");
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    Logfile::get()->writeInfo(std::string() + "Computational time to create binmesh: "
+                              + std::to_string(elapsed.count()));
+    return true;
+}
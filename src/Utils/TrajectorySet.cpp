@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cfloat>
+
+#include <Utils/File/Logfile.hpp>
+
+#include "ParallelAlgorithms.hpp"
+#include "TrajectorySet.hpp"
+
+void TrajectorySet::clear(size_t numAttributes)
+{
+    positions.clear();
+    attributes.clear();
+    attributes.resize(numAttributes);
+    lineOffsets.clear();
+    lineOffsets.push_back(0);
+}
+
+void TrajectorySet::reserve(size_t numLines, size_t numPoints)
+{
+    lineOffsets.reserve(numLines + 1);
+    positions.reserve(numPoints);
+    for (std::vector<float> &attribute : attributes) {
+        attribute.reserve(numPoints);
+    }
+}
+
+void TrajectorySet::addTrajectory(
+        ArrayView<const glm::vec3> linePositions, const std::vector<ArrayView<const float>> &lineAttributes)
+{
+    if (empty()) {
+        attributes.resize(lineAttributes.size());
+    }
+    if (lineAttributes.size() != attributes.size()) {
+        sgl::Logfile::get()->writeError("Error in TrajectorySet::addTrajectory: Mismatch in number of attributes.");
+        return;
+    }
+
+    positions.insert(positions.end(), linePositions.begin(), linePositions.end());
+    for (size_t i = 0; i < lineAttributes.size(); i++) {
+        attributes.at(i).insert(attributes.at(i).end(), lineAttributes.at(i).begin(), lineAttributes.at(i).end());
+    }
+    lineOffsets.push_back(positions.size());
+}
+
+void TrajectorySet::addTrajectory(const Trajectory &trajectory)
+{
+    std::vector<ArrayView<const float>> lineAttributes;
+    lineAttributes.reserve(trajectory.attributes.size());
+    for (const std::vector<float> &attribute : trajectory.attributes) {
+        lineAttributes.push_back(ArrayView<const float>(attribute));
+    }
+    addTrajectory(ArrayView<const glm::vec3>(trajectory.positions), lineAttributes);
+}
+
+void TrajectorySet::allocate(const std::vector<size_t> &numPointsPerLine, size_t numAttributes)
+{
+    lineOffsets.resize(numPointsPerLine.size() + 1);
+    size_t numPoints = parallelExclusivePrefixSum(numPointsPerLine.data(), lineOffsets.data(), numPointsPerLine.size());
+    lineOffsets.back() = numPoints;
+
+    positions.resize(numPoints);
+    attributes.resize(numAttributes);
+    for (std::vector<float> &attribute : attributes) {
+        attribute.resize(numPoints);
+    }
+}
+
+void TrajectorySet::append(const TrajectorySet &other)
+{
+    if (empty()) {
+        attributes.resize(other.attributes.size());
+    }
+    if (other.attributes.size() != attributes.size()) {
+        sgl::Logfile::get()->writeError("Error in TrajectorySet::append: Mismatch in number of attributes.");
+        return;
+    }
+
+    const size_t pointOffset = positions.size();
+    positions.insert(positions.end(), other.positions.begin(), other.positions.end());
+    for (size_t i = 0; i < attributes.size(); i++) {
+        attributes.at(i).insert(attributes.at(i).end(), other.attributes.at(i).begin(), other.attributes.at(i).end());
+    }
+    lineOffsets.reserve(lineOffsets.size() + other.getNumTrajectories());
+    for (size_t lineIndex = 1; lineIndex < other.lineOffsets.size(); lineIndex++) {
+        lineOffsets.push_back(pointOffset + other.lineOffsets.at(lineIndex));
+    }
+}
+
+sgl::AABB3 TrajectorySet::computeBoundingBox() const
+{
+    float minX = FLT_MAX, minY = FLT_MAX, minZ = FLT_MAX;
+    float maxX = -FLT_MAX, maxY = -FLT_MAX, maxZ = -FLT_MAX;
+    #pragma omp parallel for reduction(min:minX,minY,minZ) reduction(max:maxX,maxY,maxZ)
+    for (size_t i = 0; i < positions.size(); i++) {
+        const glm::vec3 &position = positions[i];
+        minX = std::min(minX, position.x);
+        minY = std::min(minY, position.y);
+        minZ = std::min(minZ, position.z);
+        maxX = std::max(maxX, position.x);
+        maxY = std::max(maxY, position.y);
+        maxZ = std::max(maxZ, position.z);
+    }
+    return sgl::AABB3(glm::vec3(minX, minY, minZ), glm::vec3(maxX, maxY, maxZ));
+}
+
+void TrajectorySet::computeAttributeRange(size_t attributeIndex, float &minValue, float &maxValue) const
+{
+    const std::vector<float> &attribute = attributes.at(attributeIndex);
+    float minAttr = FLT_MAX;
+    float maxAttr = -FLT_MAX;
+    #pragma omp parallel for reduction(min:minAttr) reduction(max:maxAttr)
+    for (size_t i = 0; i < attribute.size(); i++) {
+        minAttr = std::min(minAttr, attribute[i]);
+        maxAttr = std::max(maxAttr, attribute[i]);
+    }
+    minValue = minAttr;
+    maxValue = maxAttr;
+}
+
+void TrajectorySet::normalizePositions(const glm::vec3 &minVec, const glm::vec3 &maxVec, const glm::vec3 &offset)
+{
+    #pragma omp parallel for
+    for (size_t i = 0; i < positions.size(); i++) {
+        glm::vec3 &position = positions[i];
+        position = (position - minVec) / (maxVec - minVec);
+        position -= offset;
+    }
+}
+
+void TrajectorySet::normalizeAttribute(size_t attributeIndex, float minValue, float maxValue)
+{
+    std::vector<float> &attribute = attributes.at(attributeIndex);
+    #pragma omp parallel for
+    for (size_t i = 0; i < attribute.size(); i++) {
+        attribute[i] = (attribute[i] - minValue) / (maxValue - minValue);
+    }
+}
+
+TrajectorySet TrajectorySet::fromTrajectories(const Trajectories &trajectories)
+{
+    TrajectorySet trajectorySet;
+    std::vector<size_t> numPointsPerLine(trajectories.size());
+    for (size_t i = 0; i < trajectories.size(); i++) {
+        numPointsPerLine.at(i) = trajectories.at(i).positions.size();
+    }
+    size_t numAttributes = trajectories.empty() ? 0 : trajectories.front().attributes.size();
+    trajectorySet.allocate(numPointsPerLine, numAttributes);
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (size_t i = 0; i < trajectories.size(); i++) {
+        const Trajectory &trajectory = trajectories.at(i);
+        std::copy(trajectory.positions.begin(), trajectory.positions.end(), trajectorySet.getPositions(i).begin());
+        for (size_t j = 0; j < numAttributes && j < trajectory.attributes.size(); j++) {
+            const std::vector<float> &attribute = trajectory.attributes.at(j);
+            std::copy(attribute.begin(), attribute.begin() + std::min(attribute.size(), trajectory.positions.size()),
+                    trajectorySet.getAttribute(i, j).begin());
+        }
+    }
+
+    return trajectorySet;
+}
+
+Trajectories TrajectorySet::toTrajectories() const
+{
+    Trajectories trajectories(getNumTrajectories());
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (size_t i = 0; i < trajectories.size(); i++) {
+        Trajectory &trajectory = trajectories.at(i);
+        trajectory.positions = getPositions(i).toVector();
+        trajectory.attributes.resize(attributes.size());
+        for (size_t j = 0; j < attributes.size(); j++) {
+            trajectory.attributes.at(j) = getAttribute(i, j).toVector();
+        }
+    }
+    return trajectories;
+}
@@ -0,0 +1,141 @@
+#ifndef PIXELSYNCOIT_TRAJECTORYSET_HPP
+#define PIXELSYNCOIT_TRAJECTORYSET_HPP
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <Math/Geometry/AABB3.hpp>
+
+#include "ArrayView.hpp"
+
+struct Trajectory {
+    std::vector<glm::vec3> positions;
+    std::vector<std::vector<float>> attributes;
+};
+
+typedef std::vector<Trajectory> Trajectories;
+
+struct TrajectorySet;
+
+/**
+ * Read-only view of one line stored in a TrajectorySet.
+ */
+class TrajectoryView
+{
+public:
+    TrajectoryView(const TrajectorySet *trajectorySet, size_t lineIndex)
+            : trajectorySet(trajectorySet), lineIndex(lineIndex) {}
+    inline size_t getLineIndex() const { return lineIndex; }
+    size_t getNumPoints() const;
+    ArrayView<const glm::vec3> getPositions() const;
+    ArrayView<const float> getAttribute(size_t attributeIndex) const;
+
+private:
+    const TrajectorySet *trajectorySet;
+    size_t lineIndex;
+};
+
+/**
+ * Flat structure-of-arrays storage of a set of trajectories.
+ * The positions of all lines are stored in one contiguous array, as is each attribute. The points of line i are
+ * stored in the range [lineOffsets[i], lineOffsets[i+1]). In contrast to Trajectories, which needs two heap
+ * allocations per line (plus one per attribute), the number of allocations is independent of the number of lines.
+ */
+struct TrajectorySet
+{
+    TrajectorySet() : lineOffsets(1, 0) {}
+
+    /// Positions of all line points.
+    std::vector<glm::vec3> positions;
+    /// attributes[i] holds the values of attribute i for all line points.
+    std::vector<std::vector<float>> attributes;
+    /// Index of the first point of each line (size: number of lines + 1).
+    std::vector<size_t> lineOffsets;
+
+    inline size_t getNumTrajectories() const { return lineOffsets.size() - 1; }
+    inline size_t getNumPoints() const { return positions.size(); }
+    inline size_t getNumPoints(size_t lineIndex) const {
+        return lineOffsets[lineIndex + 1] - lineOffsets[lineIndex];
+    }
+    inline size_t getNumAttributes() const { return attributes.size(); }
+    inline bool empty() const { return getNumTrajectories() == 0; }
+
+    // Per-line access
+    inline ArrayView<glm::vec3> getPositions(size_t lineIndex) {
+        return ArrayView<glm::vec3>(positions.data() + lineOffsets[lineIndex], getNumPoints(lineIndex));
+    }
+    inline ArrayView<const glm::vec3> getPositions(size_t lineIndex) const {
+        return ArrayView<const glm::vec3>(positions.data() + lineOffsets[lineIndex], getNumPoints(lineIndex));
+    }
+    inline ArrayView<float> getAttribute(size_t lineIndex, size_t attributeIndex) {
+        return ArrayView<float>(
+                attributes[attributeIndex].data() + lineOffsets[lineIndex], getNumPoints(lineIndex));
+    }
+    inline ArrayView<const float> getAttribute(size_t lineIndex, size_t attributeIndex) const {
+        return ArrayView<const float>(
+                attributes[attributeIndex].data() + lineOffsets[lineIndex], getNumPoints(lineIndex));
+    }
+    inline TrajectoryView operator[](size_t lineIndex) const { return TrajectoryView(this, lineIndex); }
+
+    /// Iteration over all lines (yields TrajectoryView objects).
+    class ConstIterator
+    {
+    public:
+        ConstIterator(const TrajectorySet *trajectorySet, size_t lineIndex)
+                : trajectorySet(trajectorySet), lineIndex(lineIndex) {}
+        inline TrajectoryView operator*() const { return TrajectoryView(trajectorySet, lineIndex); }
+        inline ConstIterator &operator++() { lineIndex++; return *this; }
+        inline bool operator!=(const ConstIterator &other) const { return lineIndex != other.lineIndex; }
+        inline bool operator==(const ConstIterator &other) const { return lineIndex == other.lineIndex; }
+    private:
+        const TrajectorySet *trajectorySet;
+        size_t lineIndex;
+    };
+    inline ConstIterator begin() const { return ConstIterator(this, 0); }
+    inline ConstIterator end() const { return ConstIterator(this, getNumTrajectories()); }
+
+    // Construction
+    /// Removes all lines and sets the number of attributes per point.
+    void clear(size_t numAttributes = 0);
+    void reserve(size_t numLines, size_t numPoints);
+    /**
+     * Appends a line. The number of attributes needs to match getNumAttributes() unless the set is still empty, in
+     * which case the first line determines the number of attributes.
+     */
+    void addTrajectory(ArrayView<const glm::vec3> linePositions,
+            const std::vector<ArrayView<const float>> &lineAttributes);
+    void addTrajectory(const Trajectory &trajectory);
+    /**
+     * Allocates the storage for lines with the passed number of points. The line offsets are computed with a
+     * (parallel) prefix sum, such that the lines can afterwards be filled in parallel using the per-line views.
+     */
+    void allocate(const std::vector<size_t> &numPointsPerLine, size_t numAttributes);
+    /// Appends all lines of the passed set (same rules for the number of attributes as addTrajectory).
+    void append(const TrajectorySet &other);
+
+    // Parallel helpers
+    /// @return The bounding box of all points.
+    sgl::AABB3 computeBoundingBox() const;
+    /// Computes the minimum and maximum value of an attribute over all points.
+    void computeAttributeRange(size_t attributeIndex, float &minValue, float &maxValue) const;
+    /// position = (position - minVec) / (maxVec - minVec) - offset for all points.
+    void normalizePositions(const glm::vec3 &minVec, const glm::vec3 &maxVec,
+            const glm::vec3 &offset = glm::vec3(0.0f));
+    /// value = (value - minValue) / (maxValue - minValue) for all points.
+    void normalizeAttribute(size_t attributeIndex, float minValue, float maxValue);
+
+    // Conversion from/to the array-of-structures representation
+    static TrajectorySet fromTrajectories(const Trajectories &trajectories);
+    Trajectories toTrajectories() const;
+};
+
+inline size_t TrajectoryView::getNumPoints() const {
+    return trajectorySet->getNumPoints(lineIndex);
+}
+inline ArrayView<const glm::vec3> TrajectoryView::getPositions() const {
+    return trajectorySet->getPositions(lineIndex);
+}
+inline ArrayView<const float> TrajectoryView::getAttribute(size_t attributeIndex) const {
+    return trajectorySet->getAttribute(lineIndex, attributeIndex);
+}
+
+#endif //PIXELSYNCOIT_TRAJECTORYSET_HPP
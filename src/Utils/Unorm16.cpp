@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <cfloat>
+
+#include <glm/glm.hpp>
+
+#include "Unorm16.hpp"
+
+/// Number of values processed by one thread at once (fits into the L1/L2 cache together with the output).
+const size_t UNORM16_CHUNK_SIZE = size_t(1) << 14;
+
+static inline size_t getNumChunks(size_t numValues)
+{
+    return (numValues + UNORM16_CHUNK_SIZE - 1) / UNORM16_CHUNK_SIZE;
+}
+
+/**
+ * Calls kernel(chunkIndex, start, end, localHistogram) for all chunks in parallel. The per-thread histograms are
+ * added to the histogram of the statistics (if any).
+ */
+template<class Kernel>
+static void forEachChunk(size_t numValues, Unorm16Statistics *statistics, Kernel kernel)
+{
+    const size_t numChunks = getNumChunks(numValues);
+    const size_t numBins = statistics ? statistics->histogram.size() : 0;
+    if (numBins > 0) {
+        std::fill(statistics->histogram.begin(), statistics->histogram.end(), 0);
+    }
+
+    #pragma omp parallel if(numChunks > 1)
+    {
+        std::vector<uint64_t> localHistogram(numBins, 0);
+        #pragma omp for schedule(static)
+        for (size_t chunkIndex = 0; chunkIndex < numChunks; chunkIndex++) {
+            size_t start = chunkIndex * UNORM16_CHUNK_SIZE;
+            size_t end = std::min(start + UNORM16_CHUNK_SIZE, numValues);
+            kernel(chunkIndex, start, end, localHistogram);
+        }
+        if (numBins > 0) {
+            #pragma omp critical
+            {
+                for (size_t binIndex = 0; binIndex < numBins; binIndex++) {
+                    statistics->histogram[binIndex] += localHistogram[binIndex];
+                }
+            }
+        }
+    }
+}
+
+static inline void addCodesToHistogram(const uint16_t *codes, size_t numCodes, std::vector<uint64_t> &histogram)
+{
+    const uint64_t numBins = histogram.size();
+    if (numBins == 0) {
+        return;
+    }
+    for (size_t i = 0; i < numCodes; i++) {
+        histogram[(uint64_t(codes[i]) * numBins) >> 16]++;
+    }
+}
+
+/// NaN values are ignored, as comparisons with NaN are false.
+static inline void computeChunkRange(const float *values, size_t numValues, float &minValue, float &maxValue)
+{
+    float chunkMin = FLT_MAX, chunkMax = -FLT_MAX;
+    #pragma omp simd reduction(min:chunkMin) reduction(max:chunkMax)
+    for (size_t i = 0; i < numValues; i++) {
+        chunkMin = values[i] < chunkMin ? values[i] : chunkMin;
+        chunkMax = values[i] > chunkMax ? values[i] : chunkMax;
+    }
+    minValue = chunkMin;
+    maxValue = chunkMax;
+}
+
+/// Combines the per-chunk ranges (in a fixed order, i.e., independent of the number of threads).
+static void reduceChunkRanges(const std::vector<float> &chunkMin, const std::vector<float> &chunkMax,
+        float &minValue, float &maxValue)
+{
+    minValue = FLT_MAX;
+    maxValue = -FLT_MAX;
+    for (size_t chunkIndex = 0; chunkIndex < chunkMin.size(); chunkIndex++) {
+        minValue = std::min(minValue, chunkMin[chunkIndex]);
+        maxValue = std::max(maxValue, chunkMax[chunkIndex]);
+    }
+    if (minValue > maxValue) {
+        minValue = maxValue = 0.0f;
+    }
+}
+
+void computeValueRange(const float *values, size_t numValues, float &minValue, float &maxValue)
+{
+    const size_t numChunks = getNumChunks(numValues);
+    std::vector<float> chunkMin(numChunks), chunkMax(numChunks);
+    forEachChunk(numValues, nullptr, [&](size_t chunkIndex, size_t start, size_t end, std::vector<uint64_t>&) {
+        computeChunkRange(values + start, end - start, chunkMin[chunkIndex], chunkMax[chunkIndex]);
+    });
+    reduceChunkRanges(chunkMin, chunkMax, minValue, maxValue);
+}
+
+template<Unorm16Rounding rounding>
+static inline void packUnorm16Chunk(const float *values, size_t numValues, float minValue, float range,
+        uint16_t *unormValues)
+{
+    #pragma omp simd
+    for (size_t i = 0; i < numValues; i++) {
+        // Same operations as glm::clamp((value - minValue) / range, 0.0f, 1.0f) * 65535.0f, but NaN is mapped to 0.
+        float normalized = (values[i] - minValue) / range;
+        normalized = normalized > 0.0f ? normalized : 0.0f;
+        normalized = normalized < 1.0f ? normalized : 1.0f;
+        float scaled = normalized * 65535.0f;
+        uint32_t code = uint32_t(scaled);
+        // The fractional part is computed exactly, unlike in the common floor(scaled + 0.5f).
+        float fraction = scaled - float(code);
+        if (rounding == UNORM16_ROUND_NEAREST) {
+            code += fraction >= 0.5f ? 1u : 0u;
+        } else if (rounding == UNORM16_ROUND_NEAREST_EVEN) {
+            code += (fraction > 0.5f || (fraction == 0.5f && (code & 1u) != 0u)) ? 1u : 0u;
+        }
+        unormValues[i] = uint16_t(code);
+    }
+}
+
+void packUnorm16(const float *values, size_t numValues, float minValue, float maxValue, uint16_t *unormValues,
+        Unorm16Rounding rounding, Unorm16Statistics *statistics)
+{
+    const float range = maxValue - minValue;
+    if (statistics) {
+        statistics->minValue = minValue;
+        statistics->maxValue = maxValue;
+    }
+
+    forEachChunk(numValues, statistics, [&](size_t, size_t start, size_t end, std::vector<uint64_t> &histogram) {
+        if (!(range > 0.0f)) {
+            std::fill(unormValues + start, unormValues + end, uint16_t(0));
+        } else if (rounding == UNORM16_ROUND_NEAREST) {
+            packUnorm16Chunk<UNORM16_ROUND_NEAREST>(values + start, end - start, minValue, range, unormValues + start);
+        } else if (rounding == UNORM16_ROUND_NEAREST_EVEN) {
+            packUnorm16Chunk<UNORM16_ROUND_NEAREST_EVEN>(
+                    values + start, end - start, minValue, range, unormValues + start);
+        } else {
+            packUnorm16Chunk<UNORM16_ROUND_TRUNCATE>(values + start, end - start, minValue, range, unormValues + start);
+        }
+        addCodesToHistogram(unormValues + start, end - start, histogram);
+    });
+}
+
+void packUnorm16(const float *values, size_t numValues, uint16_t *unormValues,
+        Unorm16Rounding rounding, Unorm16Statistics *statistics)
+{
+    float minValue, maxValue;
+    computeValueRange(values, numValues, minValue, maxValue);
+    packUnorm16(values, numValues, minValue, maxValue, unormValues, rounding, statistics);
+}
+
+void unpackUnorm16(const uint16_t *unormValues, size_t numValues, float *values, Unorm16Statistics *statistics)
+{
+    const size_t numChunks = getNumChunks(numValues);
+    std::vector<float> chunkMin(statistics ? numChunks : 0), chunkMax(statistics ? numChunks : 0);
+
+    forEachChunk(numValues, statistics, [&](size_t chunkIndex, size_t start, size_t end,
+            std::vector<uint64_t> &histogram) {
+        const uint16_t *chunkCodes = unormValues + start;
+        float *chunkValues = values + start;
+        const size_t chunkSize = end - start;
+        if (statistics) {
+            // Fused: The minimum and maximum code give the range of the chunk.
+            uint16_t minCode = 0xFFFFu, maxCode = 0u;
+            #pragma omp simd reduction(min:minCode) reduction(max:maxCode)
+            for (size_t i = 0; i < chunkSize; i++) {
+                // float division by 65535 is correctly rounded like the division in double precision.
+                chunkValues[i] = float(chunkCodes[i]) / 65535.0f;
+                minCode = chunkCodes[i] < minCode ? chunkCodes[i] : minCode;
+                maxCode = chunkCodes[i] > maxCode ? chunkCodes[i] : maxCode;
+            }
+            chunkMin[chunkIndex] = float(minCode) / 65535.0f;
+            chunkMax[chunkIndex] = float(maxCode) / 65535.0f;
+            addCodesToHistogram(chunkCodes, chunkSize, histogram);
+        } else {
+            #pragma omp simd
+            for (size_t i = 0; i < chunkSize; i++) {
+                chunkValues[i] = float(chunkCodes[i]) / 65535.0f;
+            }
+        }
+    });
+
+    if (statistics) {
+        reduceChunkRanges(chunkMin, chunkMax, statistics->minValue, statistics->maxValue);
+    }
+}
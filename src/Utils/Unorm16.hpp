@@ -0,0 +1,57 @@
+#ifndef PIXELSYNCOIT_UNORM16_HPP
+#define PIXELSYNCOIT_UNORM16_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Conversion between float arrays and 16-bit unsigned normalized integers (unorm16), which are used for storing the
+ * importance criteria in .binmesh files. The kernels process the data in chunks in parallel; the loops over the
+ * chunks are branchless and vectorized (OpenMP simd). Statistics about the values (range, histogram) are computed in
+ * the same pass, such that the data doesn't need to be read twice.
+ * See https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/packUnorm.xhtml for the conversion rules.
+ */
+
+enum Unorm16Rounding {
+    /// Round half away from zero, like glm::round (used by packUnorm16Array).
+    UNORM16_ROUND_NEAREST = 0,
+    /// Round half to even, like the default rounding mode of the FPU.
+    UNORM16_ROUND_NEAREST_EVEN,
+    /// Round towards zero.
+    UNORM16_ROUND_TRUNCATE
+};
+
+struct Unorm16Statistics
+{
+    /// Range of the float values (the input of pack, the output of unpack). NaN values are ignored.
+    float minValue = 0.0f;
+    float maxValue = 0.0f;
+    /// If not empty when passed to a kernel: Number of codes falling into each of histogram.size() equally sized bins
+    /// over [0, 65535], i.e., code c is counted in bin (c * histogram.size()) / 65536.
+    std::vector<uint64_t> histogram;
+};
+
+/// Computes the minimum and maximum of the passed values (NaN values are ignored). Both are zero if there are none.
+void computeValueRange(const float *values, size_t numValues, float &minValue, float &maxValue);
+
+/**
+ * Maps [minValue, maxValue] to [0, 65535]. Values outside of the range are clamped, NaN values are mapped to zero.
+ * If the range is empty, all values are mapped to zero.
+ * @param statistics If not nullptr, receives the passed range and the histogram of the codes.
+ */
+void packUnorm16(const float *values, size_t numValues, float minValue, float maxValue, uint16_t *unormValues,
+        Unorm16Rounding rounding = UNORM16_ROUND_NEAREST, Unorm16Statistics *statistics = nullptr);
+
+/// Maps the range of the values (see computeValueRange) to [0, 65535].
+void packUnorm16(const float *values, size_t numValues, uint16_t *unormValues,
+        Unorm16Rounding rounding = UNORM16_ROUND_NEAREST, Unorm16Statistics *statistics = nullptr);
+
+/**
+ * Maps [0, 65535] to [0, 1]. The results are bitwise identical to float(code / 65535.0).
+ * @param statistics If not nullptr, receives the range of the unpacked values and the histogram of the codes.
+ */
+void unpackUnorm16(const uint16_t *unormValues, size_t numValues, float *values,
+        Unorm16Statistics *statistics = nullptr);
+
+#endif //PIXELSYNCOIT_UNORM16_HPP
@@ -15,6 +15,7 @@
 #include <ImGui/ImGuiWrapper.hpp>
 
 #include "../Performance/InternalState.hpp"
+#include "../Utils/ConversionCache.hpp"
 #include "VoxelCurveDiscretizer.hpp"
 #include "OIT_VoxelRaytracing.hpp"
 #include "../OIT/BufferSizeWatch.hpp"
@@ -113,12 +114,9 @@ void OIT_VoxelRaytracing::setNewState(const InternalState &newState)
 void OIT_VoxelRaytracing::fromFile(const std::string &filename, TrajectoryType trajectoryType,
         std::vector<float> &attributes, float &maxVorticity)
 {
-    // Check if voxel grid is already created
-    // Pure filename without extension (to create compressed .voxel filename)
+    // Pure filename without extension (to find the .hair or .obj file)
     std::string modelFilenamePure = sgl::FileUtils::get()->removeExtension(filename);
 
-    std::string modelFilenameVoxelGrid = modelFilenamePure + ".voxel";
-
     // Can be either hair dataset or trajectory dataset
     isHairDataset = boost::starts_with(modelFilenamePure, "Data/Hair");
     bool isRings = boost::starts_with(modelFilenamePure, "Data/Rings");
@@ -164,17 +162,30 @@ void OIT_VoxelRaytracing::fromFile(const std::string &filename, TrajectoryType t
         maxNumLinesPerVoxel = 64;
     }*/
 
-    if (!sgl::FileUtils::get()->exists(modelFilenameVoxelGrid)) {
+    // Check if the voxel grid was already created with the same source file and parameters
+    std::string modelFilenameSource = modelFilenamePure + (isHairDataset ? ".hair" : ".obj");
+    ConversionCacheKey conversionKey(isHairDataset ? "hair_voxel_grid" : "trajectories_voxel_grid", ".voxel");
+    conversionKey.addSourceFile(modelFilenameSource);
+    conversionKey.addParameter("voxelResolution", int(voxelRes));
+    conversionKey.addParameter("quantizationResolution", int(quantizationRes));
+    conversionKey.addParameter("maxNumLinesPerVoxel", maxNumLinesPerVoxel);
+    conversionKey.addParameter("useGPU", int(useGPU));
+    if (!isHairDataset) {
+        conversionKey.addParameter("trajectoryType", int(trajectoryType));
+    }
+
+    bool isCacheHit = true;
+    std::string modelFilenameVoxelGrid = ConversionCache::get()->getArtifact(conversionKey,
+            [&](const std::string &outputFilename) {
+        isCacheHit = false;
         VoxelCurveDiscretizer discretizer(glm::ivec3(voxelRes),
                 glm::ivec3(quantizationRes, quantizationRes, quantizationRes));
 
         if (isHairDataset) {
-            std::string modelFilenameHair = modelFilenamePure + ".hair";
-            compressedData = discretizer.createFromHairDataset(modelFilenameHair, lineRadius, hairStrandColor,
+            compressedData = discretizer.createFromHairDataset(modelFilenameSource, lineRadius, hairStrandColor,
                     maxNumLinesPerVoxel);
         } else {
-            std::string modelFilenameObj = modelFilenamePure + ".obj";
-            compressedData = discretizer.createFromTrajectoryDataset(modelFilenameObj, trajectoryType, attributes,
+            compressedData = discretizer.createFromTrajectoryDataset(modelFilenameSource, trajectoryType, attributes,
                     maxVorticity, maxNumLinesPerVoxel, useGPU);
         }
 
@@ -200,8 +211,10 @@ void OIT_VoxelRaytracing::fromFile(const std::string &filename, TrajectoryType t
         sgl::Logfile::get()->writeInfo(std::string() + "Computational time to create voxel grid: "
                                        + std::to_string(elapsed.count()));
 
-        saveToFile(modelFilenameVoxelGrid, compressedData);
-    } else {
+        saveToFile(outputFilename, compressedData);
+        return true;
+    });
+    if (isCacheHit && !modelFilenameVoxelGrid.empty()) {
         loadFromFile(modelFilenameVoxelGrid, compressedData);
         if (isHairDataset) {
             lineRadius = compressedData.hairThickness;
@@ -9,19 +9,13 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/split.hpp>
 
-#include <GL/glew.h>
-
 #include <Utils/Convert.hpp>
 #include <Utils/File/Logfile.hpp>
 #include <Math/Math.hpp>
-#include <Graphics/Renderer.hpp>
-#include <Graphics/Shader/ShaderManager.hpp>
-#include <Graphics/Texture/TextureManager.hpp>
-#include <Graphics/OpenGL/GeometryBuffer.hpp>
-#include <Graphics/OpenGL/Texture.hpp>
 
 #include "Utils/HairLoader.hpp"
 #include "Utils/TrajectoryFile.hpp"
+#include "Utils/ParallelAlgorithms.hpp"
 #include "VoxelCurveDiscretizer.hpp"
 
 #define BIAS 0.001
@@ -91,70 +85,28 @@ bool rayBoxIntersection(glm::vec3 rayOrigin, glm::vec3 rayDirection, glm::vec3 l
 
 
 
-bool VoxelDiscretizer::addPossibleIntersections(const glm::vec3 &v1, const glm::vec3 &v2, float a1, float a2)
-{
-    float tNear, tFar;
-    glm::vec3 voxelLower = glm::vec3(index);
-    glm::vec3 voxelUpper = glm::vec3(index + glm::ivec3(1,1,1));
-    if (rayBoxIntersection(v1, (v2 - v1), voxelLower, voxelUpper, tNear, tFar)) {
-        bool intersectionNear = 0.0f <= tNear && tNear <= 1.0f;
-        bool intersectionFar = 0.0f <= tFar && tFar <= 1.0f;
-        if (intersectionNear) {
-            glm::vec3 entrancePoint = v1 + tNear * (v2 - v1);
-            float interpolatedAttribute = a1 + tNear * (a2 - a1);
-            currentCurveIntersections.push_back(AttributePoint(entrancePoint, interpolatedAttribute));
-        }
-        if (intersectionFar) {
-            glm::vec3 exitPoint = v1 + tFar * (v2 - v1);
-            float interpolatedAttribute = a1 + tFar * (a2 - a1);
-            currentCurveIntersections.push_back(AttributePoint(exitPoint, interpolatedAttribute));
-        }
-        if (intersectionNear || intersectionFar) {
-            return true; // Intersection found
-        }
-    }
-
-    return false;
-}
-
-void VoxelDiscretizer::setIndex(glm::ivec3 index)
-{
-    this->index = index;
-}
-
-float VoxelDiscretizer::computeDensity(float maxVorticity)
-{
-    float density = 0.0f;
-    for (LineSegment &line : lines) {
-        density += line.length() * line.avgOpacity(maxVorticity);
-    }
-    return density;
-}
-
-float VoxelDiscretizer::computeDensityHair(float opacity)
+/**
+ * @return The number of intersections (0, 1 or 2) of the line segment startPoint + t * rayDirection, t in [0, 1],
+ * with the boundary of the box.
+ */
+static int lineSegmentBoxIntersection(const glm::vec3 &startPoint, const glm::vec3 &rayDirection,
+        const glm::vec3 &lower, const glm::vec3 &upper, float &tNear, float &tFar)
 {
-    float density = 0.0f;
-    for (LineSegment &line : lines) {
-        density += line.length() * opacity;
+    if (!rayBoxIntersection(startPoint, rayDirection, lower, upper, tNear, tFar)) {
+        return 0;
     }
-    return density;
+    return (tNear >= 0.0f && tNear <= 1.0f ? 1 : 0) + (tFar >= 0.0f && tFar <= 1.0f ? 1 : 0);
 }
 
 
 
-
-
-
-
 VoxelCurveDiscretizer::VoxelCurveDiscretizer(const glm::ivec3 &gridResolution, const glm::ivec3 &quantizationResolution)
         : gridResolution(gridResolution), quantizationResolution(quantizationResolution)
 {
-    voxels = nullptr;
 }
 
 VoxelCurveDiscretizer::~VoxelCurveDiscretizer()
 {
-    delete[] voxels;
 }
 
 void VoxelCurveDiscretizer::setVoxelGrid(const sgl::AABB3 &aabb)
@@ -170,16 +122,23 @@ void VoxelCurveDiscretizer::setVoxelGrid(const sgl::AABB3 &aabb)
         float sideLengthFactor = gridDimensions[i] / maxDimensionLength;
         gridResolution[i] = (int)std::ceil(gridResolution[i] * sideLengthFactor);
     }
+}
 
-    voxels = new VoxelDiscretizer[gridResolution.x * gridResolution.y * gridResolution.z];
-    for (int z = 0; z < gridResolution.z; z++) {
-        for (int y = 0; y < gridResolution.y; y++) {
-            for (int x = 0; x < gridResolution.x; x++) {
-                int index = x + y*gridResolution.x + z*gridResolution.x*gridResolution.y;
-                voxels[index].setIndex(glm::ivec3(x, y, z));
-            }
-        }
+VoxelGridDataCompressed VoxelCurveDiscretizer::createVoxelGrid(
+        std::vector<Curve> &curves, unsigned int maxNumLinesPerVoxel, bool useGPU)
+{
+#ifdef NO_OPENGL
+    if (useGPU) {
+        sgl::Logfile::get()->writeInfo("VoxelCurveDiscretizer: Built without OpenGL, using the CPU voxelization.");
     }
+    return createVoxelGridCPU(curves, maxNumLinesPerVoxel);
+#else
+    if (!useGPU) {
+        return createVoxelGridCPU(curves, maxNumLinesPerVoxel);
+    } else {
+        return createVoxelGridGPU(curves, maxNumLinesPerVoxel);
+    }
+#endif
 }
 
 
@@ -262,20 +221,7 @@ VoxelGridDataCompressed VoxelCurveDiscretizer::createFromTrajectoryDataset(const
         }
     }
 
-    if (!useGPU) {
-        // Insert lines into voxel representation
-        //int lineNum = 0;
-        for (const Curve &curve : curves) {
-            /*if (lineNum == 1000) {
-                break;
-            }*/
-            nextStreamline(curve);
-            //lineNum++;
-        }
-        return compressData();
-    } else {
-        return createVoxelGridGPU(curves, maxNumLinesPerVoxel);
-    }
+    return createVoxelGrid(curves, maxNumLinesPerVoxel, useGPU);
 }
 
 
@@ -333,169 +279,9 @@ VoxelGridDataCompressed VoxelCurveDiscretizer::createFromHairDataset(const std::
         }
     }
 
-    if (!useGPU) {
-        // Insert lines into voxel representation
-        for (const Curve &curve : curves) {
-            nextStreamline(curve);
-        }
-        return compressData();
-    } else {
-        return createVoxelGridGPU(curves, maxNumLinesPerVoxel);
-    }
-}
-
-
-VoxelGridDataCompressed VoxelCurveDiscretizer::compressData()
-{
-    VoxelGridDataCompressed dataCompressed;
-    dataCompressed.gridResolution = gridResolution;
-    dataCompressed.quantizationResolution = quantizationResolution;
-    dataCompressed.worldToVoxelGridMatrix = this->getWorldToVoxelGridMatrix();
-    dataCompressed.dataType = isHairDataset ? 1u : 0u;
-
-    if (isHairDataset) {
-        dataCompressed.hairStrandColor = hairStrandColor;
-        dataCompressed.hairThickness = hairThickness;
-    } else {
-        dataCompressed.attributes = attributes;
-        dataCompressed.maxVorticity = maxVorticity;
-    }
-
-    int n = gridResolution.x * gridResolution.y * gridResolution.z;
-    std::vector<float> voxelDensities;
-    std::vector<uint32_t> usedVoxels;
-    voxelDensities.reserve(n);
-    usedVoxels.reserve(n);
-
-    size_t lineOffset = 0;
-    dataCompressed.voxelLineListOffsets.reserve(n);
-    dataCompressed.numLinesInVoxel.reserve(n);
-    dataCompressed.lineSegments.clear();
-
-    for (int i = 0; i < n; i++) {
-        dataCompressed.voxelLineListOffsets.push_back(lineOffset);
-        size_t numLines = voxels[i].lines.size();
-        dataCompressed.numLinesInVoxel.push_back(numLines);
-        if (isHairDataset) {
-            voxelDensities.push_back(voxels[i].computeDensityHair(hairOpacity));
-        } else {
-            voxelDensities.push_back(voxels[i].computeDensity(maxVorticity));
-        }
-        usedVoxels.push_back(numLines > 0 ? 1 : 0);
-
-#ifdef PACK_LINES
-        std::vector<LineSegmentCompressed> lineSegments;
-        lineSegments.resize(voxels[i].lines.size());
-        for (size_t j = 0; j < voxels[i].lines.size(); j++) {
-            compressLine(voxels[i].getIndex(), voxels[i].lines[j], lineSegments[j]);
-
-            // Test
-            /*LineSegment originalLine = voxels[i].lines[j];
-            LineSegment decompressedLine;
-            decompressLine(glm::vec3(voxels[i].getIndex()), lineSegments[j], decompressedLine);
-            if (!checkLinesEqual(originalLine, decompressedLine)) {
-                compressLine(voxels[i].getIndex(), voxels[i].lines[j], lineSegments[j]);
-                decompressLine(glm::vec3(voxels[i].getIndex()), lineSegments[j], decompressedLine);
-            }*/
-        }
-        dataCompressed.lineSegments.insert(dataCompressed.lineSegments.end(),
-                lineSegments.begin(), lineSegments.end());
-#else
-        dataCompressed.lineSegments.insert(dataCompressed.lineSegments.end(),
-                voxels[i].lines.begin(), voxels[i].lines.end());
-#endif
-
-        lineOffset += numLines;
-    }
-
-    std::vector<float> voxelAOFactors;
-    voxelAOFactors.resize(n);
-    generateVoxelAOFactorsFromDensity(voxelDensities, voxelAOFactors, gridResolution, isHairDataset);
-
-    dataCompressed.voxelDensities = voxelDensities;
-    dataCompressed.voxelAOFactors = voxelAOFactors;
-    return dataCompressed;
-}
-
-
-
-std::vector<VoxelDiscretizer*> VoxelCurveDiscretizer::getVoxelsInAABB(const sgl::AABB3 &aabb)
-{
-    std::vector<VoxelDiscretizer*> voxelsInAABB;
-    glm::vec3 minimum = aabb.getMinimum();
-    glm::vec3 maximum = aabb.getMaximum();
-
-    glm::ivec3 lower = glm::ivec3(minimum); // Round down
-    glm::ivec3 upper = glm::ivec3(ceil(maximum.x), ceil(maximum.y), ceil(maximum.z)); // Round up
-    lower = glm::max(lower, glm::ivec3(0));
-    upper = glm::min(upper, gridResolution - glm::ivec3(1));
-
-    for (int z = lower.z; z <= upper.z; z++) {
-        for (int y = lower.y; y <= upper.y; y++) {
-            for (int x = lower.x; x <= upper.x; x++) {
-                int index = x + y*gridResolution.x + z*gridResolution.x*gridResolution.y;
-                voxelsInAABB.push_back(voxels + index);
-            }
-        }
-    }
-    return voxelsInAABB;
+    return createVoxelGrid(curves, maxNumLinesPerVoxel, useGPU);
 }
 
-void VoxelCurveDiscretizer::nextStreamline(const Curve &line)
-{
-    int N = line.points.size();
-
-    // Add intersections to voxels
-    std::set<VoxelDiscretizer*> usedVoxels;
-    for (int i = 0; i < N-1; i++) {
-        // Get line segment
-        glm::vec3 v1 = line.points.at(i);
-        glm::vec3 v2 = line.points.at(i+1);
-        float a1 = line.attributes.at(i);
-        float a2 = line.attributes.at(i+1);
-
-        // Remove invalid line points (used in many scientific datasets to indicate invalid lines).
-        const float MAX_VAL = 1e10;
-        if (std::fabs(v1.x) > MAX_VAL || std::fabs(v1.y) > MAX_VAL || std::fabs(v1.z) > MAX_VAL
-                || std::fabs(v2.x) > MAX_VAL || std::fabs(v2.y) > MAX_VAL || std::fabs(v2.z) > MAX_VAL) {
-            continue;
-        }
-
-        // Compute AABB of current segment
-        sgl::AABB3 segmentAABB = sgl::AABB3();
-        segmentAABB.combine(v1);
-        segmentAABB.combine(v2);
-
-        // Iterate over all voxels with possible intersections
-        std::vector<VoxelDiscretizer*> voxelsInAABB = getVoxelsInAABB(segmentAABB);
-
-        for (VoxelDiscretizer *voxel : voxelsInAABB) {
-            // Line-voxel intersection
-            if (voxel->addPossibleIntersections(v1, v2, a1, a2)) {
-                // Intersection(s) added to "currentLineIntersections", voxel used
-                usedVoxels.insert(voxel);
-            }
-        }
-    }
-
-    // Convert intersections to clipped line segments
-    for (VoxelDiscretizer *voxel : usedVoxels) {
-        if (voxel->currentCurveIntersections.size() < 2) {
-            voxel->currentCurveIntersections.clear();
-            continue;
-        }
-        auto it1 = voxel->currentCurveIntersections.begin();
-        auto it2 = voxel->currentCurveIntersections.begin();
-        it2++;
-        while (it2 != voxel->currentCurveIntersections.end()) {
-            voxel->lines.push_back(LineSegment(it1->v, it1->a, it2->v, it2->a, line.lineID));
-            it1++; it1++;
-            if (it1 == voxel->currentCurveIntersections.end()) break;
-            it2++; it2++;
-        }
-        voxel->currentCurveIntersections.clear();
-    }
-}
 
 template<typename T>
 T clamp(T x, T a, T b) {
@@ -541,8 +327,8 @@ void VoxelCurveDiscretizer::compressLine(const glm::ivec3 &voxelIndex, const Lin
     int faceIndex2 = computeFaceIndex(line.v2, voxelIndex);
     quantizeLine(glm::vec3(voxelIndex), line, lineQuantized, faceIndex1, faceIndex2);
 
-    uint8_t attr1Unorm = std::round(lineQuantized.a1*255.0f);
-    uint8_t attr2Unorm = std::round(lineQuantized.a2*255.0f);
+    uint32_t attr1Unorm = uint32_t(glm::clamp(std::round(lineQuantized.a1*255.0f), 0.0f, 255.0f));
+    uint32_t attr2Unorm = uint32_t(glm::clamp(std::round(lineQuantized.a2*255.0f), 0.0f, 255.0f));
 
     int c = round(2*intlog2(quantizationResolution.x));
     lineCompressed.linePosition = lineQuantized.faceIndex1;
@@ -677,218 +463,204 @@ bool VoxelCurveDiscretizer::checkLinesEqual(const LineSegment &originalLine, con
 }
 
 
-struct LinePoint {
-    LinePoint(glm::vec3 linePoint, float lineAttribute) : linePoint(linePoint), lineAttribute(lineAttribute) {}
-    glm::vec3 linePoint;
-    float lineAttribute;
-};
-
-std::string ivec3ToString(const glm::ivec3 &v) {
-    return std::string() + "ivec3(" + sgl::toString(v.x) + ", " + sgl::toString(v.y) + ", " + sgl::toString(v.z) + ")";
-}
 
-void VoxelCurveDiscretizer::recreateDensityAndAOFactors(VoxelGridDataCompressed &dataCompressed,
-        VoxelGridDataGPU &dataGPU, unsigned int maxNumLinesPerVoxel)
+/**
+ * CPU implementation of the voxelization in DiscretizeLines.glsl.
+ * Code inspired by "A Fast Voxel Traversal Algorithm for Ray Tracing" written by John Amanatides, Andrew Woo.
+ * http://citeseerx.ist.psu.edu/viewdoc/download?doi=10.1.1.42.3443&rep=rep1&type=pdf
+ *
+ * Traverses the voxel grid from "startPoint" until "endPoint" and appends the clipped line segments to "records".
+ */
+void VoxelCurveDiscretizer::traverseVoxelGrid(uint32_t lineID, const glm::vec3 &startPoint, float startAttribute,
+        const glm::vec3 &endPoint, float endAttribute, LineVoxelizationState &state,
+        std::vector<VoxelLineSegmentRecord> &records)
 {
-    glm::ivec3 numWorkGroupsVoxel = glm::ivec3(sgl::iceil(gridResolution.x, 64), sgl::iceil(gridResolution.y, 4),
-                                               gridResolution.z);
-    uint32_t gridSize1D = gridResolution.x *gridResolution.y *gridResolution.z;
-    uint32_t zeroData = 0u;
-    void *bufferMemory;
-
-    // Set preprocessor defines for the shaders.
-    sgl::ShaderManager->addPreprocessorDefine("MAX_NUM_LINES_PER_VOXEL", maxNumLinesPerVoxel);
-    sgl::ShaderManager->addPreprocessorDefine("gridResolution", ivec3ToString(gridResolution));
-    sgl::ShaderManager->addPreprocessorDefine(
-            "GRID_RESOLUTION_LOG2", sgl::toString(sgl::intlog2(gridResolution.x)));
-    sgl::ShaderManager->addPreprocessorDefine("GRID_RESOLUTION", gridResolution.x);
-    sgl::ShaderManager->addPreprocessorDefine("quantizationResolution", ivec3ToString(quantizationResolution));
-    sgl::ShaderManager->addPreprocessorDefine("QUANTIZATION_RESOLUTION", sgl::toString(quantizationResolution.x));
-    sgl::ShaderManager->addPreprocessorDefine(
-            "QUANTIZATION_RESOLUTION_LOG2", sgl::toString(sgl::intlog2(quantizationResolution.x)));
-
-
-    // PART 3: Compute the densities
-    auto startDensity = std::chrono::system_clock::now();
+    glm::ivec3 endVoxel = glm::ivec3(endPoint);
+
+    glm::ivec3 step, voxelIndex;
+    glm::vec3 tMax, tDelta;
+    for (int i = 0; i < 3; i++) {
+        step[i] = int(glm::sign(endPoint[i] - startPoint[i]));
+        if (step[i] != 0) {
+            tDelta[i] = std::min(float(step[i]) / (endPoint[i] - startPoint[i]), 1e7f);
+        } else {
+            tDelta[i] = 1e7f; // inf
+        }
+        if (step[i] > 0) {
+            tMax[i] = tDelta[i] * (1.0f - glm::fract(startPoint[i]));
+        } else {
+            tMax[i] = tDelta[i] * glm::fract(startPoint[i]);
+        }
+        voxelIndex[i] = int(startPoint[i]);
+    }
+    if (step.x == 0 && step.y == 0 && step.z == 0) {
+        return;
+    }
 
-    sgl::ShaderProgramPtr computeDensityShader = sgl::ShaderManager->getShaderProgram({"RecomputeDensity.Compute"});
-    computeDensityShader->setUniformImageTexture(0, dataGPU.densityTexture, GL_R32F, GL_READ_WRITE, 0, true, 0);
-    computeDensityShader->dispatchCompute(numWorkGroupsVoxel.x, numWorkGroupsVoxel.y, numWorkGroupsVoxel.z);
-    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    glm::vec3 rayDirection = endPoint - startPoint; // Not normalized -> t needs to be in [0.0, 1.0].
+    LineSegment lineSegment;
+    VoxelLineSegmentRecord record;
 
-    auto endDensity = std::chrono::system_clock::now();
-    auto elapsedDensity = std::chrono::duration_cast<std::chrono::milliseconds>(endDensity - startDensity);
-    sgl::Logfile::get()->writeInfo(std::string() + "Computational time to compute the densities: "
-                                   + std::to_string(elapsedDensity.count()));
+    while (glm::all(glm::greaterThanEqual(voxelIndex, glm::ivec3(0)))
+            && glm::all(glm::lessThan(voxelIndex, gridResolution))) {
+        float tNear, tFar;
+        int numIntersectionsNew = lineSegmentBoxIntersection(startPoint, rayDirection,
+                glm::vec3(voxelIndex), glm::vec3(voxelIndex) + glm::vec3(1.0f), tNear, tFar);
+
+        if (numIntersectionsNew > 0 && state.noIntersectionForLineYet) {
+            // Skip segment until first intersection
+            state.noIntersectionForLineYet = false;
+            continue;
+        }
+
+        if (numIntersectionsNew == 2 || (numIntersectionsNew == 1 && state.currentVoxelNumIntersections == 1
+                && state.currentVoxel == voxelIndex)) {
+            lineSegment.lineID = lineID;
+            if (numIntersectionsNew == 2) {
+                lineSegment.v1 = startPoint + tNear * (endPoint - startPoint);
+                lineSegment.a1 = startAttribute + tNear * (endAttribute - startAttribute);
+            } else {
+                lineSegment.v1 = state.currentVoxelIntersection;
+                lineSegment.a1 = state.currentVoxelIntersectionAttribute;
+            }
+            lineSegment.v2 = startPoint + tFar * (endPoint - startPoint);
+            lineSegment.a2 = startAttribute + tFar * (endAttribute - startAttribute);
+
+            record.voxelIndex1D = uint32_t(voxelIndex.x + voxelIndex.y*gridResolution.x
+                    + voxelIndex.z*gridResolution.x*gridResolution.y);
+            compressLine(voxelIndex, lineSegment, record.lineSegment);
+            records.push_back(record);
+            state.currentVoxelNumIntersections = 0;
+        } else if (numIntersectionsNew == 1) {
+            state.currentVoxel = voxelIndex;
+            state.currentVoxelIntersection = startPoint + tNear * (endPoint - startPoint);
+            state.currentVoxelIntersectionAttribute = startAttribute + tNear * (endAttribute - startAttribute);
+            state.currentVoxelNumIntersections = 1;
+        }
 
+        if (voxelIndex == endVoxel) {
+            // Break on last voxel
+            break;
+        }
 
-    // PART 5: Compute the ambient occlusion factors on the GPU using the density texture.
-    auto startAO_GPU = std::chrono::system_clock::now();
+        if (tMax.x < tMax.y) {
+            if (tMax.x < tMax.z) {
+                voxelIndex.x += step.x;
+                tMax.x += tDelta.x;
+            } else {
+                voxelIndex.z += step.z;
+                tMax.z += tDelta.z;
+            }
+        } else {
+            if (tMax.y < tMax.z) {
+                voxelIndex.y += step.y;
+                tMax.y += tDelta.y;
+            } else {
+                voxelIndex.z += step.z;
+                tMax.z += tDelta.z;
+            }
+        }
+    }
+}
 
-    const int FILTER_SIZE = 7;
-    const int FILTER_EXTENT = (FILTER_SIZE - 1) / 2;
-    const int FILTER_NUM_FIELDS = FILTER_SIZE*FILTER_SIZE*FILTER_SIZE;
-    float blurKernel[FILTER_NUM_FIELDS];
-    generateGaussianBlurKernel(blurKernel, FILTER_SIZE, FILTER_EXTENT);
-    sgl::GeometryBufferPtr gaussianKernelBuffer = sgl::Renderer->createGeometryBuffer(
-            FILTER_NUM_FIELDS * sizeof(float), &blurKernel,
-            sgl::UNIFORM_BUFFER, sgl::BUFFER_STATIC);
+void VoxelCurveDiscretizer::voxelizeLine(
+        uint32_t lineID, const Curve &curve, std::vector<VoxelLineSegmentRecord> &records)
+{
+    LineVoxelizationState state;
+    size_t numLinePoints = curve.points.size();
+    for (size_t i = 0; i + 1 < numLinePoints; i++) {
+        const glm::vec3 &p1 = curve.points[i];
+        const glm::vec3 &p2 = curve.points[i+1];
 
-    sgl::ShaderProgramPtr computeAOShader = sgl::ShaderManager->getShaderProgram({"ComputeAO.Compute"});
-    computeAOShader->setUniformImageTexture(0, dataGPU.densityTexture, GL_R32F, GL_READ_WRITE, 0, true, 0);
-    computeAOShader->setUniform("densityTexture", dataGPU.densityTexture, 0);
-    sgl::ShaderManager->bindShaderStorageBuffer(6, gaussianKernelBuffer);
-    computeAOShader->dispatchCompute(numWorkGroupsVoxel.x, numWorkGroupsVoxel.y, numWorkGroupsVoxel.z);
-    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        // Remove invalid line points (used in many scientific datasets to indicate invalid lines).
+        const float MAX_VAL = 1e10;
+        if (std::fabs(p1.x) > MAX_VAL || std::fabs(p1.y) > MAX_VAL || std::fabs(p1.z) > MAX_VAL
+                || std::fabs(p2.x) > MAX_VAL || std::fabs(p2.y) > MAX_VAL || std::fabs(p2.z) > MAX_VAL) {
+            continue;
+        }
 
-    auto endAO_GPU = std::chrono::system_clock::now();
-    auto elapsedAO_GPU = std::chrono::duration_cast<std::chrono::milliseconds>(endAO_GPU - startAO_GPU);
-    sgl::Logfile::get()->writeInfo(std::string() + "Computational time to compute the ambient occlusion factors (GPU): "
-                                   + std::to_string(elapsedAO_GPU.count()));
+        if (glm::length(p2 - p1) < 0.0001f) {
+            // In case the two vertices are almost identical, just skip this path line segment.
+            continue;
+        }
 
-    glUseProgram(0); // For ImGui to stop complaining when binding last_program...
+        // DDA algorithm
+        traverseVoxelGrid(lineID, p1, curve.attributes[i], p2, curve.attributes[i+1], state, records);
+    }
 }
 
-VoxelGridDataCompressed VoxelCurveDiscretizer::createVoxelGridGPU(
+VoxelGridDataCompressed VoxelCurveDiscretizer::createVoxelGridCPU(
         std::vector<Curve> &curves, unsigned int maxNumLinesPerVoxel)
 {
-    glm::ivec3 numWorkGroupsVoxel = glm::ivec3(sgl::iceil(gridResolution.x, 64), sgl::iceil(gridResolution.y, 4),
-            gridResolution.z);
-    uint32_t gridSize1D = gridResolution.x *gridResolution.y *gridResolution.z;
-    uint32_t zeroData = 0u;
-    void *bufferMemory;
-
-
-    // Set preprocessor defines for the shaders.
-    sgl::ShaderManager->addPreprocessorDefine("MAX_NUM_LINES_PER_VOXEL", maxNumLinesPerVoxel);
-    sgl::ShaderManager->addPreprocessorDefine("gridResolution", ivec3ToString(gridResolution));
-    sgl::ShaderManager->addPreprocessorDefine(
-            "GRID_RESOLUTION_LOG2", sgl::toString(sgl::intlog2(gridResolution.x)));
-    sgl::ShaderManager->addPreprocessorDefine("GRID_RESOLUTION", gridResolution.x);
-    sgl::ShaderManager->addPreprocessorDefine("quantizationResolution", ivec3ToString(quantizationResolution));
-    sgl::ShaderManager->addPreprocessorDefine("QUANTIZATION_RESOLUTION", sgl::toString(quantizationResolution.x));
-    sgl::ShaderManager->addPreprocessorDefine(
-            "QUANTIZATION_RESOLUTION_LOG2", sgl::toString(sgl::intlog2(quantizationResolution.x)));
-    if (isHairDataset) {
-        sgl::ShaderManager->addPreprocessorDefine("HAIR_RENDERING", maxNumLinesPerVoxel);
-    } else {
-        sgl::ShaderManager->removePreprocessorDefine("HAIR_RENDERING");
-    }
+    const uint32_t gridSize1D = gridResolution.x * gridResolution.y * gridResolution.z;
 
-    // PART 1: Create the LinePointBuffer, LineOffsetBuffer, NumSegmentsBuffer (empty) and LineSegmentsBuffer.
-    auto startBuffers = std::chrono::system_clock::now();
-    std::vector<LinePoint> linePoints;
-    std::vector<uint32_t> lineOffsets;
-    lineOffsets.push_back(0);
-    uint32_t offsetCounter = 0;
-    for (Curve &curve : curves) {
-        size_t curveNumPoints = curve.points.size();
-        for (size_t i = 0; i < curveNumPoints; i++) {
-            linePoints.push_back(LinePoint(curve.points.at(i), curve.attributes.at(i)));
-        }
-        offsetCounter += curveNumPoints;
-        lineOffsets.push_back(offsetCounter);
-    }
-    sgl::GeometryBufferPtr linePointBuffer = sgl::Renderer->createGeometryBuffer(
-            (linePoints.size()+1) * sizeof(LinePoint), &linePoints.front(),
-            sgl::SHADER_STORAGE_BUFFER, sgl::BUFFER_STATIC);
-    sgl::GeometryBufferPtr lineOffsetBuffer = sgl::Renderer->createGeometryBuffer(
-            (curves.size()+1) * sizeof(uint32_t), &lineOffsets.front(),
-            sgl::SHADER_STORAGE_BUFFER, sgl::BUFFER_STATIC);
-    sgl::GeometryBufferPtr numSegmentsBuffer = sgl::Renderer->createGeometryBuffer(
-            gridSize1D * sizeof(uint32_t),
-            sgl::SHADER_STORAGE_BUFFER, sgl::BUFFER_STATIC);
-    GLuint bufferID = ((sgl::GeometryBufferGL*)numSegmentsBuffer.get())->getBuffer();
-    glClearNamedBufferData(bufferID, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, (const void*)&zeroData);
-    sgl::GeometryBufferPtr lineSegmentsBuffer = sgl::Renderer->createGeometryBuffer(
-            maxNumLinesPerVoxel * gridSize1D * sizeof(LineSegmentCompressed),
-            sgl::SHADER_STORAGE_BUFFER, sgl::BUFFER_STATIC);
-
-    auto endBuffers = std::chrono::system_clock::now();
-    auto elapsedBuffers = std::chrono::duration_cast<std::chrono::milliseconds>(endBuffers - startBuffers);
-    sgl::Logfile::get()->writeInfo(std::string() + "Computational time to create the buffers: "
-                                   + std::to_string(elapsedBuffers.count()));
-
-
-    // PART 2: Discretize, quantize and voxelize the lines.
+    // PART 1: Discretize, quantize and voxelize the lines.
+    // The lines are processed in chunks. Concatenating the records of the chunks in order yields the records sorted
+    // by line (and by traversal order within a line) independently of the thread scheduling.
     auto startVoxelize = std::chrono::system_clock::now();
-    unsigned int numWorkGroupsLines = sgl::iceil(curves.size(), 256);
-    sgl::ShaderProgramPtr discretizeLinesShader = sgl::ShaderManager->getShaderProgram({"DiscretizeLines.Compute"});
-    sgl::ShaderManager->bindShaderStorageBuffer(2, linePointBuffer);
-    sgl::ShaderManager->bindShaderStorageBuffer(3, lineOffsetBuffer);
-    sgl::ShaderManager->bindShaderStorageBuffer(4, numSegmentsBuffer);
-    sgl::ShaderManager->bindShaderStorageBuffer(5, lineSegmentsBuffer);
-    discretizeLinesShader->setUniform("numLines", (unsigned int)curves.size());
-    discretizeLinesShader->dispatchCompute(numWorkGroupsLines);
-    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
-    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
-
-    // End of PART 2: Read the line segment buffer & number of line segments per voxel buffer back from the GPU.
-    std::vector<LineSegmentCompressed> compressedLineSegments;
-    bufferMemory = lineSegmentsBuffer->mapBuffer(sgl::BUFFER_MAP_READ_ONLY);
-    compressedLineSegments.resize(maxNumLinesPerVoxel * gridSize1D);
-    memcpy(&compressedLineSegments.front(), bufferMemory, compressedLineSegments.size() * sizeof(LineSegmentCompressed));
-    lineSegmentsBuffer->unmapBuffer();
-
-    std::vector<uint32_t> numSegmentsPerVoxel;
-    bufferMemory = numSegmentsBuffer->mapBuffer(sgl::BUFFER_MAP_READ_ONLY);
-    numSegmentsPerVoxel.resize(gridSize1D);
-    memcpy(&numSegmentsPerVoxel.front(), bufferMemory, numSegmentsPerVoxel.size() * sizeof(uint32_t));
-    numSegmentsBuffer->unmapBuffer();
+    const size_t LINES_PER_CHUNK = 256;
+    const size_t numChunks = (curves.size() + LINES_PER_CHUNK - 1) / LINES_PER_CHUNK;
+    std::vector<std::vector<VoxelLineSegmentRecord>> chunkRecords(numChunks);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t chunkIdx = 0; chunkIdx < numChunks; chunkIdx++) {
+        size_t lineEnd = std::min((chunkIdx + 1) * LINES_PER_CHUNK, curves.size());
+        for (size_t lineIdx = chunkIdx * LINES_PER_CHUNK; lineIdx < lineEnd; lineIdx++) {
+            voxelizeLine(uint32_t(lineIdx), curves.at(lineIdx), chunkRecords.at(chunkIdx));
+        }
+    }
+
+    std::vector<size_t> chunkOffsets(numChunks + 1);
+    for (size_t chunkIdx = 0; chunkIdx < numChunks; chunkIdx++) {
+        chunkOffsets.at(chunkIdx) = chunkRecords.at(chunkIdx).size();
+    }
+    chunkOffsets.back() = parallelExclusivePrefixSum(chunkOffsets.data(), chunkOffsets.data(), numChunks);
+    std::vector<VoxelLineSegmentRecord> records(chunkOffsets.back());
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t chunkIdx = 0; chunkIdx < numChunks; chunkIdx++) {
+        std::vector<VoxelLineSegmentRecord> &currentChunkRecords = chunkRecords.at(chunkIdx);
+        std::copy(currentChunkRecords.begin(), currentChunkRecords.end(), records.begin() + chunkOffsets.at(chunkIdx));
+        currentChunkRecords.clear();
+        currentChunkRecords.shrink_to_fit();
+    }
+
+    // Group the records by voxel (stable, i.e., the line order within the voxels is kept).
+    parallelRadixSort(records, [](const VoxelLineSegmentRecord &record) { return record.voxelIndex1D; },
+            gridSize1D - 1);
 
     auto endVoxelize = std::chrono::system_clock::now();
     auto elapsedVoxelize = std::chrono::duration_cast<std::chrono::milliseconds>(endVoxelize - startVoxelize);
-    sgl::Logfile::get()->writeInfo(std::string() + "Computational time to voxelize the lines: "
+    sgl::Logfile::get()->writeInfo(std::string() + "Computational time to voxelize the lines (CPU): "
                                    + std::to_string(elapsedVoxelize.count()));
 
 
-    // PART 3: Compute the densities
-    auto startDensity = std::chrono::system_clock::now();
-
-    sgl::TextureSettings densityTextureSettings = sgl::TextureSettings();
-    densityTextureSettings.type = sgl::TEXTURE_3D;
-    densityTextureSettings.pixelType = GL_FLOAT;
-    densityTextureSettings.pixelFormat = GL_RED;
-    densityTextureSettings.internalFormat = GL_R32F;
-    sgl::TexturePtr densityTexture = sgl::TextureManager->createEmptyTexture(
-            gridResolution.x, gridResolution.y, gridResolution.z, densityTextureSettings);
-    sgl::ShaderProgramPtr computeDensityShader = sgl::ShaderManager->getShaderProgram({"ComputeDensity.Compute"});
-    computeDensityShader->setUniformImageTexture(0, densityTexture, GL_R32F, GL_READ_WRITE, 0, true, 0);
-    computeDensityShader->dispatchCompute(numWorkGroupsVoxel.x, numWorkGroupsVoxel.y, numWorkGroupsVoxel.z);
-    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
-
-    // End of PART 3: Read the density values back from the GPU.
-    std::vector<float> voxelDensities;
-    voxelDensities.resize(gridSize1D);
-    sgl::TextureGL *densityTextureGL = (sgl::TextureGL*)densityTexture.get();
-    glGetTextureImage(densityTextureGL->getTexture(), 0, GL_RED, GL_FLOAT,
-            sizeof(float) * gridSize1D, (void*)&voxelDensities.front());
-
-    auto endDensity = std::chrono::system_clock::now();
-    auto elapsedDensity = std::chrono::duration_cast<std::chrono::milliseconds>(endDensity - startDensity);
-    sgl::Logfile::get()->writeInfo(std::string() + "Computational time to compute the densities: "
-                                   + std::to_string(elapsedDensity.count()));
-
-
-    // PART 4: Reduce the size of the buffer using a prefix sum (on the CPU for now).
+    // PART 2: Reduce the size of the buffer. Like on the GPU, at most maxNumLinesPerVoxel segments are stored per voxel.
     auto startPrefixSum = std::chrono::system_clock::now();
 
-    uint32_t lineSegmentOffset = 0;
-    std::vector<uint32_t> lineSegmentOffsets;
-    std::vector<LineSegmentCompressed> reducedLineSegmentBuffer;
-    for (size_t i = 0; i < numSegmentsPerVoxel.size(); i++) {
-        lineSegmentOffsets.push_back(lineSegmentOffset);
-        size_t numSegmentsCurrentVoxel = numSegmentsPerVoxel.at(i);
-        for (size_t j = 0; j < numSegmentsCurrentVoxel; j++) {
-            reducedLineSegmentBuffer.push_back(compressedLineSegments.at(i*maxNumLinesPerVoxel+j));
+    std::vector<uint32_t> recordOffsets(gridSize1D + 1, 0);
+    #pragma omp parallel for
+    for (size_t i = 0; i < records.size(); i++) {
+        #pragma omp atomic
+        recordOffsets[records[i].voxelIndex1D]++;
+    }
+    std::vector<uint32_t> numSegmentsPerVoxel(gridSize1D);
+    #pragma omp parallel for
+    for (uint32_t i = 0; i < gridSize1D; i++) {
+        numSegmentsPerVoxel[i] = std::min(recordOffsets[i], uint32_t(maxNumLinesPerVoxel));
+    }
+    parallelExclusivePrefixSum(recordOffsets.data(), recordOffsets.data(), gridSize1D);
+    std::vector<uint32_t> lineSegmentOffsets(gridSize1D);
+    uint32_t numLineSegments = parallelExclusivePrefixSum(
+            numSegmentsPerVoxel.data(), lineSegmentOffsets.data(), gridSize1D);
+
+    std::vector<LineSegmentCompressed> reducedLineSegmentBuffer(numLineSegments);
+    #pragma omp parallel for schedule(dynamic, 4096)
+    for (uint32_t i = 0; i < gridSize1D; i++) {
+        for (uint32_t j = 0; j < numSegmentsPerVoxel[i]; j++) {
+            reducedLineSegmentBuffer[lineSegmentOffsets[i] + j] = records[recordOffsets[i] + j].lineSegment;
         }
-        lineSegmentOffset += numSegmentsCurrentVoxel;
     }
-
-    uint32_t offsetTest = lineSegmentOffsets.back();
-    LineSegmentCompressed lineSegmentTest = reducedLineSegmentBuffer.back();
-    std::vector<LineSegmentCompressed> testArray = reducedLineSegmentBuffer;
-    std::reverse(testArray.begin(), testArray.end());
+    records.clear();
+    records.shrink_to_fit();
 
     auto endPrefixSum = std::chrono::system_clock::now();
     auto elapsedPrefixSum = std::chrono::duration_cast<std::chrono::milliseconds>(endPrefixSum - startPrefixSum);
@@ -896,8 +668,36 @@ VoxelGridDataCompressed VoxelCurveDiscretizer::createVoxelGridGPU(
                                    + std::to_string(elapsedPrefixSum.count()));
 
 
-    // PART 5: Compute the ambient occlusion factors. For now, do this on CPU (legacy).
-    /*auto startAO_CPU = std::chrono::system_clock::now();
+    // PART 3: Compute the densities (see ComputeDensity.glsl).
+    auto startDensity = std::chrono::system_clock::now();
+
+    std::vector<float> voxelDensities(gridSize1D);
+    #pragma omp parallel for schedule(dynamic, 4096)
+    for (uint32_t i = 0; i < gridSize1D; i++) {
+        glm::vec3 voxelPosition = glm::vec3(
+                i % gridResolution.x, (i / gridResolution.x) % gridResolution.y,
+                i / (gridResolution.x * gridResolution.y));
+        float density = 0.0f;
+        LineSegment lineSegment;
+        for (uint32_t j = 0; j < numSegmentsPerVoxel[i]; j++) {
+            decompressLine(voxelPosition, reducedLineSegmentBuffer[lineSegmentOffsets[i] + j], lineSegment);
+            if (isHairDataset) {
+                density += lineSegment.length() * hairOpacity;
+            } else {
+                density += lineSegment.length() * lineSegment.avgOpacity(1.0f);
+            }
+        }
+        voxelDensities[i] = density;
+    }
+
+    auto endDensity = std::chrono::system_clock::now();
+    auto elapsedDensity = std::chrono::duration_cast<std::chrono::milliseconds>(endDensity - startDensity);
+    sgl::Logfile::get()->writeInfo(std::string() + "Computational time to compute the densities (CPU): "
+                                   + std::to_string(elapsedDensity.count()));
+
+
+    // PART 4: Compute the ambient occlusion factors.
+    auto startAO_CPU = std::chrono::system_clock::now();
 
     std::vector<float> voxelAOFactors;
     voxelAOFactors.resize(gridSize1D);
@@ -906,50 +706,9 @@ VoxelGridDataCompressed VoxelCurveDiscretizer::createVoxelGridGPU(
     auto endAO_CPU = std::chrono::system_clock::now();
     auto elapsedAO_CPU = std::chrono::duration_cast<std::chrono::milliseconds>(endAO_CPU - startAO_CPU);
     sgl::Logfile::get()->writeInfo(std::string() + "Computational time to compute the ambient occlusion factors (CPU): "
-                                   + std::to_string(elapsedAO_CPU.count()));*/
-
-
-    // PART 5: Compute the ambient occlusion factors on the GPU using the density texture.
-    auto startAO_GPU = std::chrono::system_clock::now();
-    const int FILTER_SIZE = 7;
-    const int FILTER_EXTENT = (FILTER_SIZE - 1) / 2;
-    const int FILTER_NUM_FIELDS = FILTER_SIZE*FILTER_SIZE*FILTER_SIZE;
-    float blurKernel[FILTER_NUM_FIELDS];
-    generateGaussianBlurKernel(blurKernel, FILTER_SIZE, FILTER_EXTENT);
-    sgl::GeometryBufferPtr gaussianKernelBuffer = sgl::Renderer->createGeometryBuffer(
-            FILTER_NUM_FIELDS * sizeof(float), &blurKernel,
-            sgl::SHADER_STORAGE_BUFFER, sgl::BUFFER_STATIC);
-
-    sgl::TextureSettings aoTextureSettings = sgl::TextureSettings();
-    aoTextureSettings.type = sgl::TEXTURE_3D;
-    aoTextureSettings.pixelType = GL_FLOAT;
-    aoTextureSettings.pixelFormat = GL_RED;
-    aoTextureSettings.internalFormat = GL_R32F;
-    sgl::TexturePtr aoTexture = sgl::TextureManager->createEmptyTexture(
-            gridResolution.x, gridResolution.y, gridResolution.z, aoTextureSettings);
-    sgl::ShaderProgramPtr computeAOShader = sgl::ShaderManager->getShaderProgram({"ComputeAO.Compute"});
-    computeAOShader->setUniformImageTexture(0, aoTexture, GL_R32F, GL_READ_WRITE, 0, true, 0);
-    computeAOShader->setUniform("densityTexture", densityTexture, 0);
-    sgl::ShaderManager->bindShaderStorageBuffer(6, gaussianKernelBuffer);
-    computeAOShader->dispatchCompute(numWorkGroupsVoxel.x, numWorkGroupsVoxel.y, numWorkGroupsVoxel.z);
-    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
-
-    // End of PART 5: Read the AO factors back from the GPU.
-    std::vector<float> voxelAOFactors;
-    voxelAOFactors.resize(gridSize1D);
-    sgl::TextureGL *aoTextureGL = (sgl::TextureGL*)aoTexture.get();
-    glGetTextureImage(aoTextureGL->getTexture(), 0, GL_RED, GL_FLOAT,
-                      sizeof(float) * gridSize1D, (void*)&voxelAOFactors.front());
-    normalizeVoxelAOFactors(voxelAOFactors, gridResolution, isHairDataset);
-
-    auto endAO_GPU = std::chrono::system_clock::now();
-    auto elapsedAO_GPU = std::chrono::duration_cast<std::chrono::milliseconds>(endAO_GPU - startAO_GPU);
-    sgl::Logfile::get()->writeInfo(std::string() + "Computational time to compute the ambient occlusion factors (GPU): "
-                                   + std::to_string(elapsedAO_GPU.count()));
+                                   + std::to_string(elapsedAO_CPU.count()));
 
 
-    glUseProgram(0); // For ImGui to stop complaining when binding last_program...
-
     // FINAL STEP: Now, write the data to the struct.
     VoxelGridDataCompressed dataCompressed;
     dataCompressed.gridResolution = gridResolution;
@@ -972,4 +731,4 @@ VoxelGridDataCompressed VoxelCurveDiscretizer::createVoxelGridGPU(
     dataCompressed.voxelDensities = voxelDensities;
     dataCompressed.voxelAOFactors = voxelAOFactors;
     return dataCompressed;
-}
\ No newline at end of file
+}
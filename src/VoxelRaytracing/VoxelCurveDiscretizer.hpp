@@ -6,8 +6,6 @@
 #define PIXELSYNCOIT_VOXELCURVEDISCRETIZER_HPP
 
 #include <vector>
-#include <list>
-#include <set>
 
 #include <glm/glm.hpp>
 
@@ -20,32 +18,24 @@
 #include "Utils/ImportanceCriteria.hpp"
 #include "VoxelData.hpp"
 
-struct AttributePoint
+/// A compressed line segment and the voxel it belongs to (created by the CPU voxelizer).
+struct VoxelLineSegmentRecord
 {
-    AttributePoint(const glm::vec3 &v, float a) : v(v), a(a) {}
-    glm::vec3 v;
-    float a;
+    uint32_t voxelIndex1D;
+    LineSegmentCompressed lineSegment;
 };
 
-class VoxelDiscretizer
+/// State carried over between the segments of one line during the voxelization.
+struct LineVoxelizationState
 {
-public:
-    // Returns true if the passed line intersects the voxel boundaries
-    bool addPossibleIntersections(const glm::vec3 &v1, const glm::vec3 &v2, float a1, float a2);
-    void setIndex(glm::ivec3 index);
-    const glm::ivec3 &getIndex() const { return index; }
-    float computeDensity(float maxVorticity);
-    float computeDensityHair(float opacity);
-
-    glm::ivec3 index;
-    std::vector<LineSegment> lines;
-
-    // For clipping lines to voxel
-    std::vector<AttributePoint> currentCurveIntersections;
+    /// Voxel for which we save intersections that do not yet form a full line segment.
+    glm::ivec3 currentVoxel = glm::ivec3(-1, -1, -1);
+    int currentVoxelNumIntersections = 0;
+    glm::vec3 currentVoxelIntersection = glm::vec3(1e6f, 1e6f, 1e6f);
+    float currentVoxelIntersectionAttribute = 0.0f;
+    bool noIntersectionForLineYet = true;
 };
 
-
-
 class VoxelCurveDiscretizer
 {
 public:
@@ -66,7 +56,6 @@ public:
 private:
     bool isHairDataset = false;
     glm::ivec3 gridResolution, quantizationResolution;
-    VoxelDiscretizer *voxels;
 
     // Trajectory dataset
     float maxVorticity;
@@ -79,10 +68,15 @@ private:
 
     // Grid generation
     void setVoxelGrid(const sgl::AABB3 &aabb);
+    /// Uses createVoxelGridCPU if useGPU is false or the program was built without OpenGL (NO_OPENGL).
+    VoxelGridDataCompressed createVoxelGrid(std::vector<Curve> &curves, unsigned int maxNumLinesPerVoxel, bool useGPU);
 
     // On CPU
-    VoxelGridDataCompressed compressData();
-    void nextStreamline(const Curve &line);
+    VoxelGridDataCompressed createVoxelGridCPU(std::vector<Curve> &curves, unsigned int maxNumLinesPerVoxel);
+    void voxelizeLine(uint32_t lineID, const Curve &curve, std::vector<VoxelLineSegmentRecord> &records);
+    void traverseVoxelGrid(uint32_t lineID, const glm::vec3 &startPoint, float startAttribute,
+            const glm::vec3 &endPoint, float endAttribute, LineVoxelizationState &state,
+            std::vector<VoxelLineSegmentRecord> &records);
     // On GPU
     VoxelGridDataCompressed createVoxelGridGPU(std::vector<Curve> &curves, unsigned int maxNumLinesPerVoxel);
 
@@ -99,7 +93,6 @@ private:
             LineSegment &decompressedLine);
     bool checkLinesEqual(const LineSegment &originalLine, const LineSegment &decompressedLine);
 
-    std::vector<VoxelDiscretizer*> getVoxelsInAABB(const sgl::AABB3 &aabb);
     sgl::AABB3 linesBoundingBox;
     glm::mat4 linesToVoxel, voxelToLines;
 };
@@ -0,0 +1,315 @@
+#include <iostream>
+#include <chrono>
+#include <cstring>
+
+#include <GL/glew.h>
+
+#include <Utils/Convert.hpp>
+#include <Utils/File/Logfile.hpp>
+#include <Math/Math.hpp>
+#include <Graphics/Renderer.hpp>
+#include <Graphics/Shader/ShaderManager.hpp>
+#include <Graphics/Texture/TextureManager.hpp>
+#include <Graphics/OpenGL/GeometryBuffer.hpp>
+#include <Graphics/OpenGL/Texture.hpp>
+
+#include "VoxelCurveDiscretizer.hpp"
+
+// The OpenGL compute shader voxelization. The CPU voxelization in VoxelCurveDiscretizer.cpp does not need a context.
+
+struct LinePoint {
+    LinePoint(glm::vec3 linePoint, float lineAttribute) : linePoint(linePoint), lineAttribute(lineAttribute) {}
+    glm::vec3 linePoint;
+    float lineAttribute;
+};
+
+std::string ivec3ToString(const glm::ivec3 &v) {
+    return std::string() + "ivec3(" + sgl::toString(v.x) + ", " + sgl::toString(v.y) + ", " + sgl::toString(v.z) + ")";
+}
+
+void VoxelCurveDiscretizer::recreateDensityAndAOFactors(VoxelGridDataCompressed &dataCompressed,
+        VoxelGridDataGPU &dataGPU, unsigned int maxNumLinesPerVoxel)
+{
+    glm::ivec3 numWorkGroupsVoxel = glm::ivec3(sgl::iceil(gridResolution.x, 64), sgl::iceil(gridResolution.y, 4),
+                                               gridResolution.z);
+    uint32_t gridSize1D = gridResolution.x *gridResolution.y *gridResolution.z;
+    uint32_t zeroData = 0u;
+    void *bufferMemory;
+
+    // Set preprocessor defines for the shaders.
+    sgl::ShaderManager->addPreprocessorDefine("MAX_NUM_LINES_PER_VOXEL", maxNumLinesPerVoxel);
+    sgl::ShaderManager->addPreprocessorDefine("gridResolution", ivec3ToString(gridResolution));
+    sgl::ShaderManager->addPreprocessorDefine(
+            "GRID_RESOLUTION_LOG2", sgl::toString(sgl::intlog2(gridResolution.x)));
+    sgl::ShaderManager->addPreprocessorDefine("GRID_RESOLUTION", gridResolution.x);
+    sgl::ShaderManager->addPreprocessorDefine("quantizationResolution", ivec3ToString(quantizationResolution));
+    sgl::ShaderManager->addPreprocessorDefine("QUANTIZATION_RESOLUTION", sgl::toString(quantizationResolution.x));
+    sgl::ShaderManager->addPreprocessorDefine(
+            "QUANTIZATION_RESOLUTION_LOG2", sgl::toString(sgl::intlog2(quantizationResolution.x)));
+
+
+    // PART 3: Compute the densities
+    auto startDensity = std::chrono::system_clock::now();
+
+    sgl::ShaderProgramPtr computeDensityShader = sgl::ShaderManager->getShaderProgram({"RecomputeDensity.Compute"});
+    computeDensityShader->setUniformImageTexture(0, dataGPU.densityTexture, GL_R32F, GL_READ_WRITE, 0, true, 0);
+    computeDensityShader->dispatchCompute(numWorkGroupsVoxel.x, numWorkGroupsVoxel.y, numWorkGroupsVoxel.z);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+    auto endDensity = std::chrono::system_clock::now();
+    auto elapsedDensity = std::chrono::duration_cast<std::chrono::milliseconds>(endDensity - startDensity);
+    sgl::Logfile::get()->writeInfo(std::string() + "Computational time to compute the densities: "
+                                   + std::to_string(elapsedDensity.count()));
+
+
+    // PART 5: Compute the ambient occlusion factors on the GPU using the density texture.
+    auto startAO_GPU = std::chrono::system_clock::now();
+
+    const int FILTER_SIZE = 7;
+    const int FILTER_EXTENT = (FILTER_SIZE - 1) / 2;
+    const int FILTER_NUM_FIELDS = FILTER_SIZE*FILTER_SIZE*FILTER_SIZE;
+    float blurKernel[FILTER_NUM_FIELDS];
+    generateGaussianBlurKernel(blurKernel, FILTER_SIZE, FILTER_EXTENT);
+    sgl::GeometryBufferPtr gaussianKernelBuffer = sgl::Renderer->createGeometryBuffer(
+            FILTER_NUM_FIELDS * sizeof(float), &blurKernel,
+            sgl::UNIFORM_BUFFER, sgl::BUFFER_STATIC);
+
+    sgl::ShaderProgramPtr computeAOShader = sgl::ShaderManager->getShaderProgram({"ComputeAO.Compute"});
+    computeAOShader->setUniformImageTexture(0, dataGPU.densityTexture, GL_R32F, GL_READ_WRITE, 0, true, 0);
+    computeAOShader->setUniform("densityTexture", dataGPU.densityTexture, 0);
+    sgl::ShaderManager->bindShaderStorageBuffer(6, gaussianKernelBuffer);
+    computeAOShader->dispatchCompute(numWorkGroupsVoxel.x, numWorkGroupsVoxel.y, numWorkGroupsVoxel.z);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+    auto endAO_GPU = std::chrono::system_clock::now();
+    auto elapsedAO_GPU = std::chrono::duration_cast<std::chrono::milliseconds>(endAO_GPU - startAO_GPU);
+    sgl::Logfile::get()->writeInfo(std::string() + "Computational time to compute the ambient occlusion factors (GPU): "
+                                   + std::to_string(elapsedAO_GPU.count()));
+
+    glUseProgram(0); // For ImGui to stop complaining when binding last_program...
+}
+
+VoxelGridDataCompressed VoxelCurveDiscretizer::createVoxelGridGPU(
+        std::vector<Curve> &curves, unsigned int maxNumLinesPerVoxel)
+{
+    glm::ivec3 numWorkGroupsVoxel = glm::ivec3(sgl::iceil(gridResolution.x, 64), sgl::iceil(gridResolution.y, 4),
+            gridResolution.z);
+    uint32_t gridSize1D = gridResolution.x *gridResolution.y *gridResolution.z;
+    uint32_t zeroData = 0u;
+    void *bufferMemory;
+
+
+    // Set preprocessor defines for the shaders.
+    sgl::ShaderManager->addPreprocessorDefine("MAX_NUM_LINES_PER_VOXEL", maxNumLinesPerVoxel);
+    sgl::ShaderManager->addPreprocessorDefine("gridResolution", ivec3ToString(gridResolution));
+    sgl::ShaderManager->addPreprocessorDefine(
+            "GRID_RESOLUTION_LOG2", sgl::toString(sgl::intlog2(gridResolution.x)));
+    sgl::ShaderManager->addPreprocessorDefine("GRID_RESOLUTION", gridResolution.x);
+    sgl::ShaderManager->addPreprocessorDefine("quantizationResolution", ivec3ToString(quantizationResolution));
+    sgl::ShaderManager->addPreprocessorDefine("QUANTIZATION_RESOLUTION", sgl::toString(quantizationResolution.x));
+    sgl::ShaderManager->addPreprocessorDefine(
+            "QUANTIZATION_RESOLUTION_LOG2", sgl::toString(sgl::intlog2(quantizationResolution.x)));
+    if (isHairDataset) {
+        sgl::ShaderManager->addPreprocessorDefine("HAIR_RENDERING", maxNumLinesPerVoxel);
+    } else {
+        sgl::ShaderManager->removePreprocessorDefine("HAIR_RENDERING");
+    }
+
+    // PART 1: Create the LinePointBuffer, LineOffsetBuffer, NumSegmentsBuffer (empty) and LineSegmentsBuffer.
+    auto startBuffers = std::chrono::system_clock::now();
+    std::vector<LinePoint> linePoints;
+    std::vector<uint32_t> lineOffsets;
+    lineOffsets.push_back(0);
+    uint32_t offsetCounter = 0;
+    for (Curve &curve : curves) {
+        size_t curveNumPoints = curve.points.size();
+        for (size_t i = 0; i < curveNumPoints; i++) {
+            linePoints.push_back(LinePoint(curve.points.at(i), curve.attributes.at(i)));
+        }
+        offsetCounter += curveNumPoints;
+        lineOffsets.push_back(offsetCounter);
+    }
+    sgl::GeometryBufferPtr linePointBuffer = sgl::Renderer->createGeometryBuffer(
+            (linePoints.size()+1) * sizeof(LinePoint), &linePoints.front(),
+            sgl::SHADER_STORAGE_BUFFER, sgl::BUFFER_STATIC);
+    sgl::GeometryBufferPtr lineOffsetBuffer = sgl::Renderer->createGeometryBuffer(
+            (curves.size()+1) * sizeof(uint32_t), &lineOffsets.front(),
+            sgl::SHADER_STORAGE_BUFFER, sgl::BUFFER_STATIC);
+    sgl::GeometryBufferPtr numSegmentsBuffer = sgl::Renderer->createGeometryBuffer(
+            gridSize1D * sizeof(uint32_t),
+            sgl::SHADER_STORAGE_BUFFER, sgl::BUFFER_STATIC);
+    GLuint bufferID = ((sgl::GeometryBufferGL*)numSegmentsBuffer.get())->getBuffer();
+    glClearNamedBufferData(bufferID, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, (const void*)&zeroData);
+    sgl::GeometryBufferPtr lineSegmentsBuffer = sgl::Renderer->createGeometryBuffer(
+            maxNumLinesPerVoxel * gridSize1D * sizeof(LineSegmentCompressed),
+            sgl::SHADER_STORAGE_BUFFER, sgl::BUFFER_STATIC);
+
+    auto endBuffers = std::chrono::system_clock::now();
+    auto elapsedBuffers = std::chrono::duration_cast<std::chrono::milliseconds>(endBuffers - startBuffers);
+    sgl::Logfile::get()->writeInfo(std::string() + "Computational time to create the buffers: "
+                                   + std::to_string(elapsedBuffers.count()));
+
+
+    // PART 2: Discretize, quantize and voxelize the lines.
+    auto startVoxelize = std::chrono::system_clock::now();
+    unsigned int numWorkGroupsLines = sgl::iceil(curves.size(), 256);
+    sgl::ShaderProgramPtr discretizeLinesShader = sgl::ShaderManager->getShaderProgram({"DiscretizeLines.Compute"});
+    sgl::ShaderManager->bindShaderStorageBuffer(2, linePointBuffer);
+    sgl::ShaderManager->bindShaderStorageBuffer(3, lineOffsetBuffer);
+    sgl::ShaderManager->bindShaderStorageBuffer(4, numSegmentsBuffer);
+    sgl::ShaderManager->bindShaderStorageBuffer(5, lineSegmentsBuffer);
+    discretizeLinesShader->setUniform("numLines", (unsigned int)curves.size());
+    discretizeLinesShader->dispatchCompute(numWorkGroupsLines);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+    // End of PART 2: Read the line segment buffer & number of line segments per voxel buffer back from the GPU.
+    std::vector<LineSegmentCompressed> compressedLineSegments;
+    bufferMemory = lineSegmentsBuffer->mapBuffer(sgl::BUFFER_MAP_READ_ONLY);
+    compressedLineSegments.resize(maxNumLinesPerVoxel * gridSize1D);
+    memcpy(&compressedLineSegments.front(), bufferMemory, compressedLineSegments.size() * sizeof(LineSegmentCompressed));
+    lineSegmentsBuffer->unmapBuffer();
+
+    std::vector<uint32_t> numSegmentsPerVoxel;
+    bufferMemory = numSegmentsBuffer->mapBuffer(sgl::BUFFER_MAP_READ_ONLY);
+    numSegmentsPerVoxel.resize(gridSize1D);
+    memcpy(&numSegmentsPerVoxel.front(), bufferMemory, numSegmentsPerVoxel.size() * sizeof(uint32_t));
+    numSegmentsBuffer->unmapBuffer();
+
+    auto endVoxelize = std::chrono::system_clock::now();
+    auto elapsedVoxelize = std::chrono::duration_cast<std::chrono::milliseconds>(endVoxelize - startVoxelize);
+    sgl::Logfile::get()->writeInfo(std::string() + "Computational time to voxelize the lines: "
+                                   + std::to_string(elapsedVoxelize.count()));
+
+
+    // PART 3: Compute the densities
+    auto startDensity = std::chrono::system_clock::now();
+
+    sgl::TextureSettings densityTextureSettings = sgl::TextureSettings();
+    densityTextureSettings.type = sgl::TEXTURE_3D;
+    densityTextureSettings.pixelType = GL_FLOAT;
+    densityTextureSettings.pixelFormat = GL_RED;
+    densityTextureSettings.internalFormat = GL_R32F;
+    sgl::TexturePtr densityTexture = sgl::TextureManager->createEmptyTexture(
+            gridResolution.x, gridResolution.y, gridResolution.z, densityTextureSettings);
+    sgl::ShaderProgramPtr computeDensityShader = sgl::ShaderManager->getShaderProgram({"ComputeDensity.Compute"});
+    computeDensityShader->setUniformImageTexture(0, densityTexture, GL_R32F, GL_READ_WRITE, 0, true, 0);
+    computeDensityShader->dispatchCompute(numWorkGroupsVoxel.x, numWorkGroupsVoxel.y, numWorkGroupsVoxel.z);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+    // End of PART 3: Read the density values back from the GPU.
+    std::vector<float> voxelDensities;
+    voxelDensities.resize(gridSize1D);
+    sgl::TextureGL *densityTextureGL = (sgl::TextureGL*)densityTexture.get();
+    glGetTextureImage(densityTextureGL->getTexture(), 0, GL_RED, GL_FLOAT,
+            sizeof(float) * gridSize1D, (void*)&voxelDensities.front());
+
+    auto endDensity = std::chrono::system_clock::now();
+    auto elapsedDensity = std::chrono::duration_cast<std::chrono::milliseconds>(endDensity - startDensity);
+    sgl::Logfile::get()->writeInfo(std::string() + "Computational time to compute the densities: "
+                                   + std::to_string(elapsedDensity.count()));
+
+
+    // PART 4: Reduce the size of the buffer using a prefix sum (on the CPU for now).
+    auto startPrefixSum = std::chrono::system_clock::now();
+
+    uint32_t lineSegmentOffset = 0;
+    std::vector<uint32_t> lineSegmentOffsets;
+    std::vector<LineSegmentCompressed> reducedLineSegmentBuffer;
+    for (size_t i = 0; i < numSegmentsPerVoxel.size(); i++) {
+        lineSegmentOffsets.push_back(lineSegmentOffset);
+        size_t numSegmentsCurrentVoxel = numSegmentsPerVoxel.at(i);
+        for (size_t j = 0; j < numSegmentsCurrentVoxel; j++) {
+            reducedLineSegmentBuffer.push_back(compressedLineSegments.at(i*maxNumLinesPerVoxel+j));
+        }
+        lineSegmentOffset += numSegmentsCurrentVoxel;
+    }
+
+    uint32_t offsetTest = lineSegmentOffsets.back();
+    LineSegmentCompressed lineSegmentTest = reducedLineSegmentBuffer.back();
+    std::vector<LineSegmentCompressed> testArray = reducedLineSegmentBuffer;
+    std::reverse(testArray.begin(), testArray.end());
+
+    auto endPrefixSum = std::chrono::system_clock::now();
+    auto elapsedPrefixSum = std::chrono::duration_cast<std::chrono::milliseconds>(endPrefixSum - startPrefixSum);
+    sgl::Logfile::get()->writeInfo(std::string() + "Computational time to reduce the buffers: "
+                                   + std::to_string(elapsedPrefixSum.count()));
+
+
+    // PART 5: Compute the ambient occlusion factors. For now, do this on CPU (legacy).
+    /*auto startAO_CPU = std::chrono::system_clock::now();
+
+    std::vector<float> voxelAOFactors;
+    voxelAOFactors.resize(gridSize1D);
+    generateVoxelAOFactorsFromDensity(voxelDensities, voxelAOFactors, gridResolution, isHairDataset);
+
+    auto endAO_CPU = std::chrono::system_clock::now();
+    auto elapsedAO_CPU = std::chrono::duration_cast<std::chrono::milliseconds>(endAO_CPU - startAO_CPU);
+    sgl::Logfile::get()->writeInfo(std::string() + "Computational time to compute the ambient occlusion factors (CPU): "
+                                   + std::to_string(elapsedAO_CPU.count()));*/
+
+
+    // PART 5: Compute the ambient occlusion factors on the GPU using the density texture.
+    auto startAO_GPU = std::chrono::system_clock::now();
+    const int FILTER_SIZE = 7;
+    const int FILTER_EXTENT = (FILTER_SIZE - 1) / 2;
+    const int FILTER_NUM_FIELDS = FILTER_SIZE*FILTER_SIZE*FILTER_SIZE;
+    float blurKernel[FILTER_NUM_FIELDS];
+    generateGaussianBlurKernel(blurKernel, FILTER_SIZE, FILTER_EXTENT);
+    sgl::GeometryBufferPtr gaussianKernelBuffer = sgl::Renderer->createGeometryBuffer(
+            FILTER_NUM_FIELDS * sizeof(float), &blurKernel,
+            sgl::SHADER_STORAGE_BUFFER, sgl::BUFFER_STATIC);
+
+    sgl::TextureSettings aoTextureSettings = sgl::TextureSettings();
+    aoTextureSettings.type = sgl::TEXTURE_3D;
+    aoTextureSettings.pixelType = GL_FLOAT;
+    aoTextureSettings.pixelFormat = GL_RED;
+    aoTextureSettings.internalFormat = GL_R32F;
+    sgl::TexturePtr aoTexture = sgl::TextureManager->createEmptyTexture(
+            gridResolution.x, gridResolution.y, gridResolution.z, aoTextureSettings);
+    sgl::ShaderProgramPtr computeAOShader = sgl::ShaderManager->getShaderProgram({"ComputeAO.Compute"});
+    computeAOShader->setUniformImageTexture(0, aoTexture, GL_R32F, GL_READ_WRITE, 0, true, 0);
+    computeAOShader->setUniform("densityTexture", densityTexture, 0);
+    sgl::ShaderManager->bindShaderStorageBuffer(6, gaussianKernelBuffer);
+    computeAOShader->dispatchCompute(numWorkGroupsVoxel.x, numWorkGroupsVoxel.y, numWorkGroupsVoxel.z);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+    // End of PART 5: Read the AO factors back from the GPU.
+    std::vector<float> voxelAOFactors;
+    voxelAOFactors.resize(gridSize1D);
+    sgl::TextureGL *aoTextureGL = (sgl::TextureGL*)aoTexture.get();
+    glGetTextureImage(aoTextureGL->getTexture(), 0, GL_RED, GL_FLOAT,
+                      sizeof(float) * gridSize1D, (void*)&voxelAOFactors.front());
+    normalizeVoxelAOFactors(voxelAOFactors, gridResolution, isHairDataset);
+
+    auto endAO_GPU = std::chrono::system_clock::now();
+    auto elapsedAO_GPU = std::chrono::duration_cast<std::chrono::milliseconds>(endAO_GPU - startAO_GPU);
+    sgl::Logfile::get()->writeInfo(std::string() + "Computational time to compute the ambient occlusion factors (GPU): "
+                                   + std::to_string(elapsedAO_GPU.count()));
+
+
+    glUseProgram(0); // For ImGui to stop complaining when binding last_program...
+
+    // FINAL STEP: Now, write the data to the struct.
+    VoxelGridDataCompressed dataCompressed;
+    dataCompressed.gridResolution = gridResolution;
+    dataCompressed.quantizationResolution = quantizationResolution;
+    dataCompressed.worldToVoxelGridMatrix = this->getWorldToVoxelGridMatrix();
+    dataCompressed.dataType = isHairDataset ? 1u : 0u;
+
+    if (isHairDataset) {
+        dataCompressed.hairStrandColor = hairStrandColor;
+        dataCompressed.hairThickness = hairThickness;
+    } else {
+        dataCompressed.attributes = attributes;
+        dataCompressed.maxVorticity = maxVorticity;
+    }
+
+    dataCompressed.voxelLineListOffsets = lineSegmentOffsets;
+    dataCompressed.numLinesInVoxel = numSegmentsPerVoxel;
+    dataCompressed.lineSegments = reducedLineSegmentBuffer;
+
+    dataCompressed.voxelDensities = voxelDensities;
+    dataCompressed.voxelAOFactors = voxelAOFactors;
+    return dataCompressed;
+}
@@ -3,21 +3,20 @@
 //
 
 #include <cstring>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 #include <iostream>
 
-#include <GL/glew.h>
 #include <glm/glm.hpp>
 
 #include <Utils/Events/Stream/Stream.hpp>
 #include <Utils/File/Logfile.hpp>
 #include <Utils/Convert.hpp>
 #include <Math/Math.hpp>
-#include <Graphics/Renderer.hpp>
-#include <Graphics/OpenGL/Texture.hpp>
 
-#include "../TransferFunctionWindow.hpp"
 #include "VoxelData.hpp"
 
 /**
@@ -227,58 +226,6 @@ std::vector<uint32_t> generateMipmapsForOctree(uint32_t *numLines, glm::ivec3 si
 }
 
 
-sgl::TexturePtr generateDensityTexture(const std::vector<float> &lods, glm::ivec3 size)
-{
-    GLuint textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_3D, textureID);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-    glTexImage3D(GL_TEXTURE_3D, 0, GL_R32F, size.x, size.y, size.z, 0, GL_RED, GL_FLOAT, &lods.front());
-
-    sgl::TextureSettings textureSettings;
-    textureSettings.type = sgl::TEXTURE_3D;
-    return sgl::TexturePtr(new sgl::TextureGL(textureID, size.x, size.y, size.z, textureSettings));
-}
-
-
-
-void compressedToGPUData(const VoxelGridDataCompressed &compressedData, VoxelGridDataGPU &gpuData)
-{
-    gpuData.gridResolution = compressedData.gridResolution;
-    gpuData.quantizationResolution = compressedData.quantizationResolution;
-    gpuData.worldToVoxelGridMatrix = compressedData.worldToVoxelGridMatrix;
-
-    gpuData.voxelLineListOffsets = sgl::Renderer->createGeometryBuffer(
-            sizeof(uint32_t)*compressedData.voxelLineListOffsets.size(),
-            (void*)&compressedData.voxelLineListOffsets.front());
-    gpuData.numLinesInVoxel = sgl::Renderer->createGeometryBuffer(
-            sizeof(uint32_t)*compressedData.numLinesInVoxel.size(),
-            (void*)&compressedData.numLinesInVoxel.front());
-
-    /*auto octreeLODs = compressedData.octreeLODs;
-    for (uint32_t &value : octreeLODs) {
-        value = 1;
-    }*/
-
-    gpuData.densityTexture = generateDensityTexture(compressedData.voxelDensities, gpuData.gridResolution);
-    gpuData.aoTexture = generateDensityTexture(compressedData.voxelAOFactors, gpuData.gridResolution);
-
-#ifdef PACK_LINES
-    int baseSize = sizeof(LineSegmentCompressed);
-#else
-    int baseSize = sizeof(LineSegment);
-#endif
-
-    gpuData.lineSegments = sgl::Renderer->createGeometryBuffer(
-            baseSize*compressedData.lineSegments.size(),
-            (void*)&compressedData.lineSegments.front());
-}
-
-
 void generateBoxBlurKernel(float *filterKernel, int filterSize)
 {
     const float FILTER_NUM_FIELDS = filterSize*filterSize*filterSize;
@@ -287,7 +234,8 @@ void generateBoxBlurKernel(float *filterKernel, int filterSize)
     for (int offsetZ = -FILTER_EXTENT; offsetZ <= FILTER_EXTENT; offsetZ++) {
         for (int offsetY = -FILTER_EXTENT; offsetY <= FILTER_EXTENT; offsetY++) {
             for (int offsetX = -FILTER_EXTENT; offsetX <= FILTER_EXTENT; offsetX++) {
-                int filterIdx = offsetZ*filterSize*filterSize + offsetY*filterSize + offsetX;
+                int filterIdx = (offsetZ+FILTER_EXTENT)*filterSize*filterSize + (offsetY+FILTER_EXTENT)*filterSize
+                        + (offsetX+FILTER_EXTENT);
                 filterKernel[filterIdx] = 1.0f / FILTER_NUM_FIELDS;
             }
         }
@@ -342,51 +290,194 @@ void normalizeVoxelAOFactors(std::vector<float> &voxelAOFactors, glm::ivec3 size
     }
 }
 
-void generateVoxelAOFactorsFromDensity(const std::vector<float> &voxelDensities, std::vector<float> &voxelAOFactors,
-                                       glm::ivec3 size, bool isHairDataset)
+/**
+ * Convolves the rows of the grid (x direction) with the passed 1D kernel. Values outside of the grid are zero.
+ */
+static void convolveVoxelGridX(const float *input, float *output, glm::ivec3 size, const std::vector<float> &weights)
 {
-    const int FILTER_SIZE = 7;
-    const int FILTER_EXTENT = (FILTER_SIZE - 1) / 2;
-    const int FILTER_NUM_FIELDS = FILTER_SIZE*FILTER_SIZE*FILTER_SIZE;
-    float blurKernel[FILTER_NUM_FIELDS];
-    generateGaussianBlurKernel(blurKernel, FILTER_SIZE, FILTER_EXTENT);
+    const int radius = int(weights.size() - 1) / 2;
+    const size_t numRows = size_t(size.y) * size_t(size.z);
 
-    // 1. Filter the densities
     #pragma omp parallel for
-    for (int gz = 0; gz < size.z; gz++) {
-        for (int gy = 0; gy < size.y; gy++) {
-            for (int gx = 0; gx < size.x; gx++) {
-                int writeIdx = gz*size.y*size.x + gy*size.x + gx;
-                voxelAOFactors[writeIdx] = 0.0f;
-                // 3x3 box filter
-                for (int offsetZ = -FILTER_EXTENT; offsetZ <= FILTER_EXTENT; offsetZ++) {
-                    for (int offsetY = -FILTER_EXTENT; offsetY <= FILTER_EXTENT; offsetY++) {
-                        for (int offsetX = -FILTER_EXTENT; offsetX <= FILTER_EXTENT; offsetX++) {
-                            int readX = gx + offsetX;
-                            int readY = gy + offsetY;
-                            int readZ = gz + offsetZ;
-                            if (readX >= 0 && readY >= 0 && readZ >= 0 && readX < size.x
-                                    && readY < size.y && readZ < size.z) {
-                                int filterIdx = (offsetZ+FILTER_EXTENT)*FILTER_SIZE*FILTER_SIZE
-                                        + (offsetY+FILTER_EXTENT)*FILTER_SIZE + (offsetX+FILTER_EXTENT);
-                                int readIdx = readZ*size.y*size.x + readY*size.y + readX;
-                                voxelAOFactors[writeIdx] += voxelDensities[readIdx] * blurKernel[filterIdx];
-                            }
-                        }
+    for (size_t row = 0; row < numRows; row++) {
+        const float *inputRow = input + row * size.x;
+        float *outputRow = output + row * size.x;
+        for (int x = 0; x < size.x; x++) {
+            int kernelStart = std::max(-radius, -x);
+            int kernelEnd = std::min(radius, size.x - 1 - x);
+            float value = 0.0f;
+            for (int k = kernelStart; k <= kernelEnd; k++) {
+                value += inputRow[x + k] * weights[k + radius];
+            }
+            outputRow[x] = value;
+        }
+    }
+}
+
+/**
+ * Convolves the grid in y (axis = 1) or z (axis = 2) direction with the passed 1D kernel. Whole rows of contiguous
+ * x values are combined, such that the innermost loop can be vectorized.
+ */
+static void convolveVoxelGridYZ(const float *input, float *output, glm::ivec3 size, int axis,
+        const std::vector<float> &weights)
+{
+    const int radius = int(weights.size() - 1) / 2;
+    const size_t axisStride = axis == 1 ? size_t(size.x) : size_t(size.x) * size_t(size.y);
+
+    #pragma omp parallel for
+    for (int z = 0; z < size.z; z++) {
+        for (int y = 0; y < size.y; y++) {
+            const int i = axis == 1 ? y : z;
+            const size_t rowOffset = (size_t(z) * size_t(size.y) + size_t(y)) * size_t(size.x);
+            float *outputRow = output + rowOffset;
+            for (int x = 0; x < size.x; x++) {
+                outputRow[x] = 0.0f;
+            }
+            int kernelStart = std::max(-radius, -i);
+            int kernelEnd = std::min(radius, size[axis] - 1 - i);
+            for (int k = kernelStart; k <= kernelEnd; k++) {
+                const float *inputRow = input + rowOffset + k * ptrdiff_t(axisStride);
+                const float weight = weights[k + radius];
+                for (int x = 0; x < size.x; x++) {
+                    outputRow[x] += inputRow[x] * weight;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Box filter (sum over [i - radius, i + radius]) in x direction using running sums, i.e., with constant cost per voxel.
+ */
+static void boxFilterVoxelGridX(const float *input, float *output, glm::ivec3 size, int radius)
+{
+    const size_t numRows = size_t(size.y) * size_t(size.z);
+
+    #pragma omp parallel for
+    for (size_t row = 0; row < numRows; row++) {
+        const float *inputRow = input + row * size.x;
+        float *outputRow = output + row * size.x;
+        double windowSum = 0.0;
+        for (int x = 0; x < std::min(radius, size.x); x++) {
+            windowSum += inputRow[x];
+        }
+        for (int x = 0; x < size.x; x++) {
+            if (x + radius < size.x) {
+                windowSum += inputRow[x + radius];
+            }
+            outputRow[x] = float(windowSum);
+            if (x - radius >= 0) {
+                windowSum -= inputRow[x - radius];
+            }
+        }
+    }
+}
+
+/**
+ * Box filter in y (axis = 1) or z (axis = 2) direction using running sums of whole rows.
+ */
+static void boxFilterVoxelGridYZ(const float *input, float *output, glm::ivec3 size, int axis, int radius)
+{
+    const int n = size[axis];
+    const int numOther = axis == 1 ? size.z : size.y;
+    const size_t axisStride = axis == 1 ? size_t(size.x) : size_t(size.x) * size_t(size.y);
+    const size_t otherStride = axis == 1 ? size_t(size.x) * size_t(size.y) : size_t(size.x);
+
+    #pragma omp parallel
+    {
+        std::vector<double> windowSums(size.x);
+
+        #pragma omp for
+        for (int o = 0; o < numOther; o++) {
+            const float *inputBase = input + o * otherStride;
+            float *outputBase = output + o * otherStride;
+            std::fill(windowSums.begin(), windowSums.end(), 0.0);
+            for (int i = 0; i < std::min(radius, n); i++) {
+                const float *inputRow = inputBase + i * axisStride;
+                for (int x = 0; x < size.x; x++) {
+                    windowSums[x] += inputRow[x];
+                }
+            }
+            for (int i = 0; i < n; i++) {
+                if (i + radius < n) {
+                    const float *inputRow = inputBase + (i + radius) * axisStride;
+                    for (int x = 0; x < size.x; x++) {
+                        windowSums[x] += inputRow[x];
+                    }
+                }
+                float *outputRow = outputBase + i * axisStride;
+                for (int x = 0; x < size.x; x++) {
+                    outputRow[x] = float(windowSums[x]);
+                }
+                if (i - radius >= 0) {
+                    const float *inputRow = inputBase + (i - radius) * axisStride;
+                    for (int x = 0; x < size.x; x++) {
+                        windowSums[x] -= inputRow[x];
                     }
                 }
             }
         }
     }
+}
+
+void filterVoxelDensities(const std::vector<float> &voxelDensities, std::vector<float> &filteredDensities,
+        glm::ivec3 size, int filterRadius, AOFilterType filterType)
+{
+    const size_t gridSize1D = size_t(size.x) * size_t(size.y) * size_t(size.z);
+    filteredDensities.resize(gridSize1D);
+    std::vector<float> tmpDensities(gridSize1D);
+
+    if (filterType == AO_FILTER_BOX) {
+        boxFilterVoxelGridX(voxelDensities.data(), filteredDensities.data(), size, filterRadius);
+        boxFilterVoxelGridYZ(filteredDensities.data(), tmpDensities.data(), size, 1, filterRadius);
+        boxFilterVoxelGridYZ(tmpDensities.data(), filteredDensities.data(), size, 2, filterRadius);
+
+        // Same weights as generateBoxBlurKernel.
+        const int filterSize = 2 * filterRadius + 1;
+        const float weight = 1.0f / float(filterSize * filterSize * filterSize);
+        #pragma omp parallel for
+        for (size_t i = 0; i < gridSize1D; i++) {
+            filteredDensities[i] *= weight;
+        }
+    } else {
+        // The kernel of generateGaussianBlurKernel with sigma = filterRadius is the product of three 1D Gaussians
+        // (times the constant 1/(2*pi*sigma^2), which is multiplied into the first pass).
+        const float sigma = float(std::max(filterRadius, 1));
+        std::vector<float> weights(2 * filterRadius + 1);
+        for (int k = -filterRadius; k <= filterRadius; k++) {
+            weights[k + filterRadius] = std::exp(-float(k * k) / (2.0f * sigma * sigma));
+        }
+        std::vector<float> weightsX = weights;
+        for (float &weight : weightsX) {
+            weight *= 1.0f / (sgl::TWO_PI * sigma * sigma);
+        }
+
+        convolveVoxelGridX(voxelDensities.data(), filteredDensities.data(), size, weightsX);
+        convolveVoxelGridYZ(filteredDensities.data(), tmpDensities.data(), size, 1, weights);
+        convolveVoxelGridYZ(tmpDensities.data(), filteredDensities.data(), size, 2, weights);
+    }
+}
 
+void generateVoxelAOFactorsFromDensity(const std::vector<float> &voxelDensities, std::vector<float> &voxelAOFactors,
+                                       glm::ivec3 size, bool isHairDataset, int filterRadius, AOFilterType filterType)
+{
+    // 1. Filter the densities
+    filterVoxelDensities(voxelDensities, voxelAOFactors, size, filterRadius, filterType);
+
+    // 2. Normalize
     normalizeVoxelAOFactors(voxelAOFactors, size, isHairDataset);
 }
 
 
 
-// Uses global transfer function window handle to get transfer function.
+// The identity corresponds to the default opacity points of the transfer function window ((0, 0) and (1, 1)).
+static OpacityMappingFunction opacityMappingFunction = [](float attr) { return attr; };
+
+void setOpacityMappingFunction(const OpacityMappingFunction &mappingFunction) {
+    opacityMappingFunction = mappingFunction;
+}
+
 float opacityMapping(float attr, float maxAttr) {
-    assert(g_TransferFunctionWindowHandle);
     attr = glm::clamp(attr/maxAttr, 0.0f, 1.0f);
-    return g_TransferFunctionWindowHandle->getOpacityAtAttribute(attr);
+    return opacityMappingFunction(attr);
 }
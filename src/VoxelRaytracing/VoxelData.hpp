@@ -7,6 +7,7 @@
 
 #include <string>
 #include <vector>
+#include <functional>
 
 #include <glm/glm.hpp>
 
@@ -15,6 +16,13 @@
 
 #define PACK_LINES
 
+/// Maps an attribute normalized to [0, 1] to an opacity.
+typedef std::function<float(float)> OpacityMappingFunction;
+/**
+ * Sets the function used by opacityMapping. The transfer function window registers its opacity mapping when it is
+ * created. Without a transfer function window (e.g. in PixelSyncOITBenchmark), the identity is used.
+ */
+void setOpacityMappingFunction(const OpacityMappingFunction &mappingFunction);
 float opacityMapping(float attr, float maxAttr);
 
 struct Curve
@@ -113,8 +121,19 @@ void compressedToGPUData(const VoxelGridDataCompressed &compressedData, VoxelGri
 std::vector<float> generateMipmapsForDensity(float *density, glm::ivec3 size);
 std::vector<uint32_t> generateMipmapsForOctree(uint32_t *numLines, glm::ivec3 size);
 sgl::TexturePtr generateDensityTexture(const std::vector<float> &lods, glm::ivec3 size);
+enum AOFilterType {
+    AO_FILTER_GAUSSIAN, ///< Gaussian with sigma = filter radius (see generateGaussianBlurKernel).
+    AO_FILTER_BOX ///< Box filter approximation, constant cost per voxel independent of the radius.
+};
+/**
+ * Blurs the voxel densities with a (2*filterRadius+1)^3 kernel. Values outside of the grid are treated as zero.
+ * Both filters are separable and are computed in three 1D passes (x, y, z).
+ */
+void filterVoxelDensities(const std::vector<float> &voxelDensities, std::vector<float> &filteredDensities,
+        glm::ivec3 size, int filterRadius = 3, AOFilterType filterType = AO_FILTER_GAUSSIAN);
 void generateVoxelAOFactorsFromDensity(const std::vector<float> &voxelDensities, std::vector<float> &voxelAOFactors,
-                                       glm::ivec3 size, bool isHairDataset);
+                                       glm::ivec3 size, bool isHairDataset, int filterRadius = 3,
+                                       AOFilterType filterType = AO_FILTER_GAUSSIAN);
 
 // Called automatically by generateVoxelAOFactorsFromDensity, but necessary for GPU implementation.
 void normalizeVoxelAOFactors(std::vector<float> &voxelAOFactors, glm::ivec3 size, bool isHairDataset);
@@ -0,0 +1,58 @@
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <Graphics/Renderer.hpp>
+#include <Graphics/OpenGL/Texture.hpp>
+
+#include "VoxelData.hpp"
+
+sgl::TexturePtr generateDensityTexture(const std::vector<float> &lods, glm::ivec3 size)
+{
+    GLuint textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_3D, textureID);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_R32F, size.x, size.y, size.z, 0, GL_RED, GL_FLOAT, &lods.front());
+
+    sgl::TextureSettings textureSettings;
+    textureSettings.type = sgl::TEXTURE_3D;
+    return sgl::TexturePtr(new sgl::TextureGL(textureID, size.x, size.y, size.z, textureSettings));
+}
+
+
+
+void compressedToGPUData(const VoxelGridDataCompressed &compressedData, VoxelGridDataGPU &gpuData)
+{
+    gpuData.gridResolution = compressedData.gridResolution;
+    gpuData.quantizationResolution = compressedData.quantizationResolution;
+    gpuData.worldToVoxelGridMatrix = compressedData.worldToVoxelGridMatrix;
+
+    gpuData.voxelLineListOffsets = sgl::Renderer->createGeometryBuffer(
+            sizeof(uint32_t)*compressedData.voxelLineListOffsets.size(),
+            (void*)&compressedData.voxelLineListOffsets.front());
+    gpuData.numLinesInVoxel = sgl::Renderer->createGeometryBuffer(
+            sizeof(uint32_t)*compressedData.numLinesInVoxel.size(),
+            (void*)&compressedData.numLinesInVoxel.front());
+
+    /*auto octreeLODs = compressedData.octreeLODs;
+    for (uint32_t &value : octreeLODs) {
+        value = 1;
+    }*/
+
+    gpuData.densityTexture = generateDensityTexture(compressedData.voxelDensities, gpuData.gridResolution);
+    gpuData.aoTexture = generateDensityTexture(compressedData.voxelAOFactors, gpuData.gridResolution);
+
+#ifdef PACK_LINES
+    int baseSize = sizeof(LineSegmentCompressed);
+#else
+    int baseSize = sizeof(LineSegment);
+#endif
+
+    gpuData.lineSegments = sgl::Renderer->createGeometryBuffer(
+            baseSize*compressedData.lineSegments.size(),
+            (void*)&compressedData.lineSegments.front());
+}